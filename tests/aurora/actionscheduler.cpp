@@ -0,0 +1,223 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our ActionScheduler class.
+ */
+
+#include <vector>
+
+#include <boost/bind.hpp>
+
+#include <SDL_timer.h>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/ustring.h"
+#include "src/common/strutil.h"
+
+#include "src/aurora/nwscript/actionscheduler.h"
+
+typedef std::vector<Common::UString> ScriptList;
+
+static void collect(ScriptList *scripts, const Aurora::NWScript::Action &action) {
+	scripts->push_back(action.script);
+}
+
+static void stall(ScriptList *scripts, const Aurora::NWScript::Action &action) {
+	scripts->push_back(action.script);
+
+	const uint32 start = SDL_GetTicks();
+	while ((SDL_GetTicks() - start) < 2)
+		;
+}
+
+static void schedule(Aurora::NWScript::ActionScheduler &scheduler, uint32 now, uint32 delay,
+                     const Common::UString &script) {
+
+	scheduler.schedule(now, delay, script, Aurora::NWScript::ScriptState(), 0, 0);
+}
+
+GTEST_TEST(ActionScheduler, order) {
+	Aurora::NWScript::ActionScheduler scheduler;
+	ScriptList scripts;
+
+	schedule(scheduler, 1000, 30, "c");
+	schedule(scheduler, 1000, 10, "a");
+	schedule(scheduler, 1000, 20, "b1");
+	schedule(scheduler, 1000, 20, "b2");
+
+	scheduler.run(1050, boost::bind(&collect, &scripts, _1));
+
+	ASSERT_EQ(scripts.size(), 4);
+
+	EXPECT_STREQ(scripts[0].c_str(), "a");
+	EXPECT_STREQ(scripts[1].c_str(), "b1");
+	EXPECT_STREQ(scripts[2].c_str(), "b2");
+	EXPECT_STREQ(scripts[3].c_str(), "c");
+
+	EXPECT_EQ(scheduler.getPendingCount(), 0);
+}
+
+GTEST_TEST(ActionScheduler, notDue) {
+	Aurora::NWScript::ActionScheduler scheduler;
+	ScriptList scripts;
+
+	schedule(scheduler, 1000, 100, "a");
+
+	scheduler.run(1099, boost::bind(&collect, &scripts, _1));
+	EXPECT_TRUE(scripts.empty());
+	EXPECT_EQ(scheduler.getPendingCount(), 1);
+
+	scheduler.run(1100, boost::bind(&collect, &scripts, _1));
+	ASSERT_EQ(scripts.size(), 1);
+	EXPECT_STREQ(scripts[0].c_str(), "a");
+
+	EXPECT_EQ(scheduler.getPendingCount(), 0);
+}
+
+GTEST_TEST(ActionScheduler, immediate) {
+	Aurora::NWScript::ActionScheduler scheduler;
+	ScriptList scripts;
+
+	schedule(scheduler, 1000, 0, "a");
+
+	scheduler.run(1000, boost::bind(&collect, &scripts, _1));
+	ASSERT_EQ(scripts.size(), 1);
+	EXPECT_STREQ(scripts[0].c_str(), "a");
+}
+
+GTEST_TEST(ActionScheduler, cascade) {
+	static const uint32 kDelays[] = { 5, 63, 64, 65, 4095, 4096, 5000, 262144, 300000, 16777215, 16777216, 20000000 };
+
+	Aurora::NWScript::ActionScheduler scheduler;
+	ScriptList scripts;
+
+	// Schedule them backwards, starting in an odd place of the wheel
+	for (int i = ARRAYSIZE(kDelays) - 1; i >= 0; i--)
+		schedule(scheduler, 4000000037U, kDelays[i], Common::composeString(kDelays[i]));
+
+	// Step through the time in uneven jumps, making sure nothing runs early or late
+	uint32 now = 4000000037U;
+	for (size_t i = 0; i < ARRAYSIZE(kDelays); i++) {
+		const uint32 due = 4000000037U + kDelays[i];
+
+		while ((int32) (due - 1 - now) > 0) {
+			now += MIN<uint32>(due - 1 - now, 1777);
+
+			scheduler.run(now, boost::bind(&collect, &scripts, _1));
+			ASSERT_EQ(scripts.size(), i) << "At " << now << ", waiting for " << kDelays[i];
+		}
+
+		now = due;
+		scheduler.run(now, boost::bind(&collect, &scripts, _1));
+
+		ASSERT_EQ(scripts.size(), i + 1) << "At " << now;
+		EXPECT_STREQ(scripts[i].c_str(), Common::composeString(kDelays[i]).c_str());
+	}
+
+	EXPECT_EQ(scheduler.getPendingCount(), 0);
+	EXPECT_EQ(scheduler.getStats().maxLatency, 0);
+}
+
+GTEST_TEST(ActionScheduler, cascadeOrder) {
+	Aurora::NWScript::ActionScheduler scheduler;
+	ScriptList scripts;
+
+	// "a" is too far away for the lowest level
+	schedule(scheduler, 0, 100, "a");
+
+	scheduler.run(60, boost::bind(&collect, &scripts, _1));
+	EXPECT_TRUE(scripts.empty());
+
+	// "b" lands in the lowest level directly, before "a" cascades down into the same slot
+	schedule(scheduler, 61, 39, "b");
+
+	scheduler.run(100, boost::bind(&collect, &scripts, _1));
+
+	ASSERT_EQ(scripts.size(), 2);
+
+	EXPECT_STREQ(scripts[0].c_str(), "a");
+	EXPECT_STREQ(scripts[1].c_str(), "b");
+}
+
+GTEST_TEST(ActionScheduler, budget) {
+	Aurora::NWScript::ActionScheduler scheduler;
+	ScriptList scripts;
+
+	schedule(scheduler, 1000, 10, "a");
+	schedule(scheduler, 1000, 10, "b");
+	schedule(scheduler, 1000, 10, "c");
+
+	scheduler.run(1010, boost::bind(&stall, &scripts, _1), 1);
+	ASSERT_EQ(scripts.size(), 1);
+	EXPECT_STREQ(scripts[0].c_str(), "a");
+
+	scheduler.run(1015, boost::bind(&stall, &scripts, _1), 1);
+	ASSERT_EQ(scripts.size(), 2);
+	EXPECT_STREQ(scripts[1].c_str(), "b");
+
+	scheduler.run(1020, boost::bind(&collect, &scripts, _1), 1);
+	ASSERT_EQ(scripts.size(), 3);
+	EXPECT_STREQ(scripts[2].c_str(), "c");
+
+	const Aurora::NWScript::ActionScheduler::Stats &stats = scheduler.getStats();
+
+	EXPECT_EQ(stats.deferrals, 2);
+	EXPECT_EQ(stats.maxLatency, 10);
+	EXPECT_DOUBLE_EQ(stats.getAverageLatency(), 5.0);
+}
+
+GTEST_TEST(ActionScheduler, stats) {
+	Aurora::NWScript::ActionScheduler scheduler;
+	ScriptList scripts;
+
+	for (uint32 i = 0; i < 100; i++)
+		schedule(scheduler, 1000, i, "a");
+
+	EXPECT_EQ(scheduler.getStats().pending    , 100);
+	EXPECT_EQ(scheduler.getStats().peakPending, 100);
+	EXPECT_EQ(scheduler.getStats().scheduled  , 100);
+
+	scheduler.run(1049, boost::bind(&collect, &scripts, _1));
+
+	EXPECT_EQ(scripts.size(), 50);
+	EXPECT_EQ(scheduler.getStats().pending , 50);
+	EXPECT_EQ(scheduler.getStats().executed, 50);
+
+	scheduler.clear();
+
+	EXPECT_EQ(scheduler.getPendingCount(), 0);
+	EXPECT_EQ(scheduler.getStats().pending, 0);
+	EXPECT_EQ(scheduler.getStats().peakPending, 100);
+
+	// Nothing left to run after clearing
+	scheduler.run(5000, boost::bind(&collect, &scripts, _1));
+	EXPECT_EQ(scripts.size(), 50);
+
+	// Scheduling again reuses the released records
+	for (uint32 i = 0; i < 10; i++)
+		schedule(scheduler, 6000, 0, "b");
+
+	scheduler.run(6000, boost::bind(&collect, &scripts, _1));
+	EXPECT_EQ(scripts.size(), 60);
+	EXPECT_EQ(scheduler.getStats().scheduled, 110);
+}
@@ -22,10 +22,22 @@
  *  Unit tests for our BIF file archive class.
  */
 
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
 #include "gtest/gtest.h"
 
+#include "src/common/util.h"
 #include "src/common/error.h"
+#include "src/common/scopedptr.h"
 #include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+#include "src/common/readfile.h"
+#include "src/common/platform.h"
+#include "src/common/thread.h"
+#include "src/common/mutex.h"
 
 #include "src/aurora/biffile.h"
 #include "src/aurora/keyfile.h"
@@ -308,3 +320,166 @@ GTEST_TEST(BIFFile11, mergeKEY) {
 	EXPECT_EQ(resource.hash, 0);
 	EXPECT_EQ(resource.index, 0);
 }
+
+// --- Concurrent access ---
+
+static const size_t kStressResourceCount = 64;
+static const size_t kStressThreadCount   =  8;
+static const size_t kStressIterations    = 2000;
+
+static byte getStressByte(size_t resource, size_t offset) {
+	return (byte) ((resource * 31 + offset * 7 + (offset >> 8)) & 0xFF);
+}
+
+static size_t getStressSize(size_t resource) {
+	return 1 + ((resource * 977) % 8191);
+}
+
+/** Build a BIF V1.0 with kStressResourceCount resources of varying sizes. */
+static void createStressBIF(Common::MemoryWriteStreamDynamic &bif) {
+	const uint32 offVarResTable = 20;
+	const uint32 offData        = offVarResTable + kStressResourceCount * 16;
+
+	bif.writeUint32BE(MKTAG('B', 'I', 'F', 'F'));
+	bif.writeUint32BE(MKTAG('V', '1', ' ', ' '));
+	bif.writeUint32LE(kStressResourceCount);
+	bif.writeUint32LE(0);
+	bif.writeUint32LE(offVarResTable);
+
+	uint32 offset = offData;
+	for (size_t i = 0; i < kStressResourceCount; i++) {
+		bif.writeUint32LE(i);
+		bif.writeUint32LE(offset);
+		bif.writeUint32LE(getStressSize(i));
+		bif.writeUint32LE(Aurora::kFileTypeTXT);
+
+		offset += getStressSize(i);
+	}
+
+	for (size_t i = 0; i < kStressResourceCount; i++)
+		for (size_t j = 0; j < getStressSize(i); j++)
+			bif.writeByte(getStressByte(i, j));
+}
+
+class BIFStressThread : public Common::Thread {
+public:
+	BIFStressThread(const Aurora::BIFFile &bif, size_t seed, Common::Semaphore &done) :
+		_bif(&bif), _seed(seed), _done(&done), _mismatches(0), _exceptions(0) {
+	}
+
+	~BIFStressThread() {
+		destroyThread();
+	}
+
+	size_t getMismatches() const {
+		return _mismatches;
+	}
+
+	size_t getExceptions() const {
+		return _exceptions;
+	}
+
+private:
+	const Aurora::BIFFile *_bif;
+
+	size_t _seed;
+	Common::Semaphore *_done;
+
+	size_t _mismatches;
+	size_t _exceptions;
+
+	void threadMethod() {
+		size_t state = _seed;
+
+		for (size_t i = 0; i < kStressIterations; i++) {
+			state = state * 1103515245 + 12345;
+			const size_t index = (state >> 16) % kStressResourceCount;
+
+			try {
+				Common::ScopedPtr<Common::SeekableReadStream> res(_bif->getResource(index));
+
+				if (res->size() != getStressSize(index)) {
+					_mismatches++;
+					continue;
+				}
+
+				for (size_t j = 0; j < res->size(); j++) {
+					if (res->readByte() != getStressByte(index, j)) {
+						_mismatches++;
+						break;
+					}
+				}
+
+			} catch (...) {
+				_exceptions++;
+			}
+		}
+
+		_done->unlock();
+	}
+};
+
+static void stressBIF(const Aurora::BIFFile &bif) {
+	Common::Semaphore done(0);
+
+	std::vector<BIFStressThread *> threads;
+	for (size_t i = 0; i < kStressThreadCount; i++)
+		threads.push_back(new BIFStressThread(bif, i, done));
+
+	for (size_t i = 0; i < kStressThreadCount; i++)
+		ASSERT_TRUE(threads[i]->createThread("BIFStressThread"));
+
+	for (size_t i = 0; i < kStressThreadCount; i++)
+		done.lock();
+
+	for (size_t i = 0; i < kStressThreadCount; i++) {
+		EXPECT_EQ(threads[i]->getMismatches(), 0) << "In thread " << i;
+		EXPECT_EQ(threads[i]->getExceptions(), 0) << "In thread " << i;
+
+		delete threads[i];
+	}
+}
+
+GTEST_TEST(BIFFileConcurrent, getResourceMemory) {
+	Common::MemoryWriteStreamDynamic data(true);
+	createStressBIF(data);
+
+	data.setDisposable(false);
+	const Aurora::BIFFile bif(new Common::MemoryReadStream(data.getData(), data.size(), true));
+
+	stressBIF(bif);
+}
+
+static void stressBIFFile(bool mapped) {
+	Common::Platform::init();
+
+	const boost::filesystem::path filePath = boost::filesystem::temp_directory_path() /
+		boost::filesystem::unique_path("%%%%_%%%%_%%%%_%%%%.xoreos");
+
+	Common::MemoryWriteStreamDynamic data(true);
+	createStressBIF(data);
+
+	boost::filesystem::ofstream bifFile(filePath, std::ofstream::binary);
+	bifFile.write(reinterpret_cast<const char *>(data.getData()), data.size());
+	bifFile.close();
+	ASSERT_FALSE(bifFile.fail());
+
+	{
+		Common::ReadFile *file = new Common::ReadFile(filePath.generic_string(), mapped);
+		EXPECT_EQ(file->isMapped(), mapped);
+
+		const Aurora::BIFFile bif(file);
+
+		stressBIF(bif);
+	}
+
+	boost::filesystem::remove(filePath);
+}
+
+GTEST_TEST(BIFFileConcurrent, getResourceFile) {
+	stressBIFFile(false);
+}
+
+GTEST_TEST(BIFFileConcurrent, getResourceMappedFile) {
+	stressBIFFile(true);
+}
@@ -29,6 +29,7 @@
 #include "src/common/util.h"
 #include "src/common/error.h"
 #include "src/common/memreadstream.h"
+#include "src/common/readstream.h"
 
 #include "src/aurora/locstring.h"
 #include "src/aurora/language.h"
@@ -654,3 +655,34 @@ GTEST_TEST(GFF3File, GFF3V33) {
 	EXPECT_EQ(strct.getID(), 23);
 	EXPECT_EQ(strct.getUint("FieldUint32"), 32);
 }
+
+// --- GFF3, loading ---
+
+GTEST_TEST(GFF3File, notInMemory) {
+	Common::MemoryReadStream stream(kGFF3SingleStruct);
+
+	Aurora::GFF3File gff3(new Common::SeekableSubReadStream(&stream, 0, stream.size()));
+	const Aurora::GFF3Struct &strct = gff3.getTopLevel();
+
+	EXPECT_EQ(strct.getFieldCount(), ARRAYSIZE(kFieldNamesSingle));
+
+	EXPECT_EQ(strct.getUint("FieldUint64"), 42);
+	EXPECT_STREQ(strct.getString("FieldExoString").c_str(), "Foobar");
+}
+
+GTEST_TEST(GFF3Struct, brokenFieldsOnAccess) {
+	std::vector<byte> data(kGFF3SingleStruct, kGFF3SingleStruct + sizeof(kGFF3SingleStruct));
+
+	// Let the top-level struct's field indices point outside the file
+	data[0x3C] = 0xFF;
+	data[0x3D] = 0xFF;
+
+	// The fields of a struct are only read on first access
+	Aurora::GFF3File gff3(new Common::MemoryReadStream(&data[0], data.size()));
+	const Aurora::GFF3Struct &strct = gff3.getTopLevel();
+
+	EXPECT_EQ(strct.getID(), 23);
+
+	EXPECT_THROW(strct.getFieldCount(), Common::Exception);
+	EXPECT_THROW(strct.getUint("FieldUint32"), Common::Exception);
+}
@@ -41,6 +41,7 @@
 #include "src/common/error.h"
 #include "src/common/encoding.h"
 #include "src/common/matrix4x4.h"
+#include "src/common/readstream.h"
 #include "src/common/memreadstream.h"
 
 #include "src/aurora/gff4file.h"
@@ -131,6 +132,18 @@ GTEST_TEST(GFF4File, getPlatform) {
 	EXPECT_EQ(gff4.getPlatform(), MKTAG('P', 'C', ' ', ' '));
 }
 
+GTEST_TEST(GFF4File, notInMemory) {
+	Common::MemoryReadStream stream(kGFF4SingleValues);
+
+	Aurora::GFF4File gff4(new Common::SeekableSubReadStream(&stream, 0, stream.size()));
+	const Aurora::GFF4Struct &strct = gff4.getTopLevel();
+
+	EXPECT_EQ(strct.getFieldCount(), ARRAYSIZE(kFieldLabelsSingle));
+
+	EXPECT_EQ(strct.getUint(256), 23);
+	EXPECT_STREQ(strct.getString(1024).c_str(), "Barfoo");
+}
+
 GTEST_TEST(GFF4Struct, getRefCount) {
 	Aurora::GFF4File gff4(new Common::MemoryReadStream(kGFF4SingleValues));
 	const Aurora::GFF4Struct &strct = gff4.getTopLevel();
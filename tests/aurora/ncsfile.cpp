@@ -0,0 +1,389 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our NCSFile, NCSProgram, NCSValueStack and NCSProfiler classes.
+ */
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+
+#include "src/aurora/nwscript/ncsprogram.h"
+#include "src/aurora/nwscript/ncsfile.h"
+#include "src/aurora/nwscript/profiler.h"
+
+// (2 + 3) * 4
+static const byte kNCSArithmetic[] = {
+	0x4E, 0x43, 0x53, 0x20, 0x56, 0x31, 0x2E, 0x30, 0x42, 0x00, 0x00, 0x00, 0x25,
+	0x04, 0x03, 0x00, 0x00, 0x00, 0x02,                         // 13: CONST 2
+	0x04, 0x03, 0x00, 0x00, 0x00, 0x03,                         // 19: CONST 3
+	0x14, 0x20,                                                 // 25: ADD
+	0x04, 0x03, 0x00, 0x00, 0x00, 0x04,                         // 27: CONST 4
+	0x16, 0x20,                                                 // 33: MUL
+	0x20, 0x00                                                  // 35: RETN
+};
+
+// Sum of 1 to 10, in a subroutine
+static const byte kNCSLoop[] = {
+	0x4E, 0x43, 0x53, 0x20, 0x56, 0x31, 0x2E, 0x30, 0x42, 0x00, 0x00, 0x00, 0x6B,
+	0x1E, 0x00, 0x00, 0x00, 0x00, 0x08,                         //  13: JSR 21
+	0x20, 0x00,                                                 //  19: RETN
+	0x04, 0x03, 0x00, 0x00, 0x00, 0x00,                         //  21: CONST 0
+	0x04, 0x03, 0x00, 0x00, 0x00, 0x01,                         //  27: CONST 1
+	0x03, 0x01, 0xFF, 0xFF, 0xFF, 0xFC, 0x00, 0x04,             //  33: CPTOPSP -4, 4
+	0x04, 0x03, 0x00, 0x00, 0x00, 0x0B,                         //  41: CONST 11
+	0x0F, 0x20,                                                 //  47: LT
+	0x1F, 0x00, 0x00, 0x00, 0x00, 0x32,                         //  49: JZ 99
+	0x03, 0x01, 0xFF, 0xFF, 0xFF, 0xF8, 0x00, 0x04,             //  55: CPTOPSP -8, 4
+	0x03, 0x01, 0xFF, 0xFF, 0xFF, 0xF8, 0x00, 0x04,             //  63: CPTOPSP -8, 4
+	0x14, 0x20,                                                 //  71: ADD
+	0x01, 0x01, 0xFF, 0xFF, 0xFF, 0xF4, 0x00, 0x04,             //  73: CPDOWNSP -12, 4
+	0x1B, 0x00, 0xFF, 0xFF, 0xFF, 0xFC,                         //  81: MOVSP -4
+	0x24, 0x03, 0xFF, 0xFF, 0xFF, 0xFC,                         //  87: INCSP -4
+	0x1D, 0x00, 0xFF, 0xFF, 0xFF, 0xC4,                         //  93: JMP 33
+	0x1B, 0x00, 0xFF, 0xFF, 0xFF, 0xFC,                         //  99: MOVSP -4
+	0x20, 0x00                                                  // 105: RETN
+};
+
+// "foo"
+static const byte kNCSString[] = {
+	0x4E, 0x43, 0x53, 0x20, 0x56, 0x31, 0x2E, 0x30, 0x42, 0x00, 0x00, 0x00, 0x16,
+	0x04, 0x05, 0x00, 0x03, 0x66, 0x6F, 0x6F,                   // 13: CONST "foo"
+	0x20, 0x00                                                  // 20: RETN
+};
+
+// "Hello, " + "world!"
+static const byte kNCSConcat[] = {
+	0x4E, 0x43, 0x53, 0x20, 0x56, 0x31, 0x2E, 0x30, 0x42, 0x00, 0x00, 0x00, 0x26,
+	0x04, 0x05, 0x00, 0x07, 0x48, 0x65, 0x6C, 0x6C, 0x6F, 0x2C, 0x20, // 13: CONST "Hello, "
+	0x04, 0x05, 0x00, 0x06, 0x77, 0x6F, 0x72, 0x6C, 0x64, 0x21,       // 24: CONST "world!"
+	0x14, 0x23,                                                 // 34: ADD
+	0x20, 0x00                                                  // 36: RETN
+};
+
+// 42, followed by an illegal instruction that's never reached
+static const byte kNCSUnreachedIllegal[] = {
+	0x4E, 0x43, 0x53, 0x20, 0x56, 0x31, 0x2E, 0x30, 0x42, 0x00, 0x00, 0x00, 0x17,
+	0x04, 0x03, 0x00, 0x00, 0x00, 0x2A,                         // 13: CONST 42
+	0x20, 0x00,                                                 // 19: RETN
+	0x3F, 0x00                                                  // 21: ???
+};
+
+// 42, jumping over an illegal instruction
+static const byte kNCSSkippedIllegal[] = {
+	0x4E, 0x43, 0x53, 0x20, 0x56, 0x31, 0x2E, 0x30, 0x42, 0x00, 0x00, 0x00, 0x1D,
+	0x1D, 0x00, 0x00, 0x00, 0x00, 0x08,                         // 13: JMP 21
+	0x3F, 0x00,                                                 // 19: ???
+	0x04, 0x03, 0x00, 0x00, 0x00, 0x2A,                         // 21: CONST 42
+	0x20, 0x00                                                  // 27: RETN
+};
+
+// Just an illegal instruction
+static const byte kNCSIllegal[] = {
+	0x4E, 0x43, 0x53, 0x20, 0x56, 0x31, 0x2E, 0x30, 0x42, 0x00, 0x00, 0x00, 0x0F,
+	0x3F, 0x00                                                  // 13: ???
+};
+
+GTEST_TEST(NCSProgram, decode) {
+	Common::MemoryReadStream stream(kNCSArithmetic);
+	const Aurora::NWScript::NCSProgram program(stream);
+
+	ASSERT_EQ(program.getInstructionCount(), 6);
+	EXPECT_TRUE(program.getError().empty());
+
+	static const uint32 kAddresses[] = { 13, 19, 25, 27, 33, 35 };
+	static const uint8  kOpcodes  [] = {
+		Aurora::NWScript::kOpcodeCONST, Aurora::NWScript::kOpcodeCONST, Aurora::NWScript::kOpcodeADD,
+		Aurora::NWScript::kOpcodeCONST, Aurora::NWScript::kOpcodeMUL  , Aurora::NWScript::kOpcodeRETN
+	};
+
+	for (size_t i = 0; i < ARRAYSIZE(kAddresses); i++) {
+		EXPECT_EQ(program.getInstruction(i).address, kAddresses[i]) << "At index " << i;
+		EXPECT_EQ(program.getInstruction(i).opcode , kOpcodes  [i]) << "At index " << i;
+	}
+
+	EXPECT_EQ(program.getInstruction(0).args[0], 2);
+	EXPECT_EQ(program.getInstruction(1).args[0], 3);
+	EXPECT_EQ(program.getInstruction(3).args[0], 4);
+}
+
+GTEST_TEST(NCSProgram, jumpTargets) {
+	Common::MemoryReadStream stream(kNCSLoop);
+	const Aurora::NWScript::NCSProgram program(stream);
+
+	ASSERT_EQ(program.getInstructionCount(), 17);
+
+	EXPECT_EQ(program.getInstruction( 0).target, program.findInstruction(21));
+	EXPECT_EQ(program.getInstruction( 7).target, program.findInstruction(99));
+	EXPECT_EQ(program.getInstruction(14).target, program.findInstruction(33));
+
+	EXPECT_EQ(program.findInstruction(107), program.getInstructionCount());
+	EXPECT_THROW(program.findInstruction(14), Common::Exception);
+}
+
+GTEST_TEST(NCSProgram, strings) {
+	Common::MemoryReadStream stream(kNCSString);
+	const Aurora::NWScript::NCSProgram program(stream);
+
+	ASSERT_EQ(program.getInstructionCount(), 2);
+	EXPECT_STREQ(program.getString(program.getInstruction(0).args[0]).c_str(), "foo");
+}
+
+GTEST_TEST(NCSProgram, illegal) {
+	Common::MemoryReadStream stream(kNCSUnreachedIllegal);
+	const Aurora::NWScript::NCSProgram program(stream);
+
+	ASSERT_EQ(program.getInstructionCount(), 3);
+	EXPECT_EQ(program.getInstruction(2).opcode, Aurora::NWScript::kOpcodeError);
+	EXPECT_FALSE(program.getError().empty());
+}
+
+GTEST_TEST(NCSProgram, illegalSkipped) {
+	Common::MemoryReadStream stream(kNCSSkippedIllegal);
+	const Aurora::NWScript::NCSProgram program(stream);
+
+	ASSERT_EQ(program.getInstructionCount(), 4);
+	EXPECT_EQ(program.getInstruction(1).opcode, Aurora::NWScript::kOpcodeError);
+	EXPECT_EQ(program.getInstruction(2).opcode, Aurora::NWScript::kOpcodeCONST);
+	EXPECT_EQ(program.getInstruction(3).opcode, Aurora::NWScript::kOpcodeRETN);
+
+	EXPECT_EQ(program.getInstruction(0).target, program.findInstruction(21));
+	EXPECT_EQ(program.getInstruction(0).target, 2);
+}
+
+GTEST_TEST(NCSFile, runArithmetic) {
+	Aurora::NWScript::NCSFile ncs(new Common::MemoryReadStream(kNCSArithmetic));
+
+	// Run it twice, to make sure everything is properly reset
+	for (size_t i = 0; i < 2; i++) {
+		const Aurora::NWScript::Variable &result = ncs.run();
+
+		ASSERT_EQ(result.getType(), Aurora::NWScript::kTypeInt);
+		EXPECT_EQ(result.getInt(), 20);
+	}
+}
+
+GTEST_TEST(NCSFile, runLoop) {
+	Aurora::NWScript::NCSFile ncs(new Common::MemoryReadStream(kNCSLoop));
+
+	const Aurora::NWScript::Variable &result = ncs.run();
+
+	ASSERT_EQ(result.getType(), Aurora::NWScript::kTypeInt);
+	EXPECT_EQ(result.getInt(), 55);
+}
+
+GTEST_TEST(NCSFile, runString) {
+	Aurora::NWScript::NCSFile ncs(new Common::MemoryReadStream(kNCSString));
+
+	const Aurora::NWScript::Variable &result = ncs.run();
+
+	ASSERT_EQ(result.getType(), Aurora::NWScript::kTypeString);
+	EXPECT_STREQ(result.getString().c_str(), "foo");
+}
+
+GTEST_TEST(NCSFile, runIllegal) {
+	Aurora::NWScript::NCSFile ncs1(new Common::MemoryReadStream(kNCSUnreachedIllegal));
+
+	const Aurora::NWScript::Variable &result = ncs1.run();
+
+	ASSERT_EQ(result.getType(), Aurora::NWScript::kTypeInt);
+	EXPECT_EQ(result.getInt(), 42);
+
+	Aurora::NWScript::NCSFile ncs2(new Common::MemoryReadStream(kNCSIllegal));
+
+	EXPECT_THROW(ncs2.run(), Common::Exception);
+
+	Aurora::NWScript::NCSFile ncs3(new Common::MemoryReadStream(kNCSSkippedIllegal));
+
+	const Aurora::NWScript::Variable &result3 = ncs3.run();
+
+	ASSERT_EQ(result3.getType(), Aurora::NWScript::kTypeInt);
+	EXPECT_EQ(result3.getInt(), 42);
+}
+
+GTEST_TEST(NCSFile, runConcat) {
+	Aurora::NWScript::NCSFile ncs(new Common::MemoryReadStream(kNCSConcat));
+
+	const Aurora::NWScript::Variable &result = ncs.run();
+
+	ASSERT_EQ(result.getType(), Aurora::NWScript::kTypeString);
+	EXPECT_STREQ(result.getString().c_str(), "Hello, world!");
+}
+
+static Aurora::NWScript::Variable runWith(const byte *data, size_t size,
+                                          Aurora::NWScript::NCSFile::Interpreter interpreter) {
+
+	Aurora::NWScript::NCSFile ncs(new Common::MemoryReadStream(data, size));
+	ncs.setInterpreter(interpreter);
+
+	return ncs.run();
+}
+
+GTEST_TEST(NCSFile, interpreters) {
+	static const byte * const kScripts[] = {
+		kNCSArithmetic, kNCSLoop, kNCSString, kNCSConcat, kNCSUnreachedIllegal
+	};
+	static const size_t kSizes[] = {
+		sizeof(kNCSArithmetic), sizeof(kNCSLoop), sizeof(kNCSString), sizeof(kNCSConcat), sizeof(kNCSUnreachedIllegal)
+	};
+
+	for (size_t i = 0; i < ARRAYSIZE(kScripts); i++) {
+		const Aurora::NWScript::Variable step =
+			runWith(kScripts[i], kSizes[i], Aurora::NWScript::NCSFile::kInterpreterStep);
+		const Aurora::NWScript::Variable fast =
+			runWith(kScripts[i], kSizes[i], Aurora::NWScript::NCSFile::kInterpreterFast);
+
+		EXPECT_NE(step.getType(), Aurora::NWScript::kTypeVoid) << "At index " << i;
+		EXPECT_TRUE(step == fast) << "At index " << i;
+	}
+
+	EXPECT_THROW(runWith(kNCSIllegal, sizeof(kNCSIllegal), Aurora::NWScript::NCSFile::kInterpreterStep),
+	             Common::Exception);
+	EXPECT_THROW(runWith(kNCSIllegal, sizeof(kNCSIllegal), Aurora::NWScript::NCSFile::kInterpreterFast),
+	             Common::Exception);
+}
+
+static const char kLongString[] = "0123456789abcdef0123456789abcdef";
+static const size_t kLongStringLength = sizeof(kLongString) - 1;
+
+/** Fill the stack's string arena and boxes with garbage, and collect it again. */
+static void churn(Aurora::NWScript::NCSValueStack &stack, size_t count) {
+	for (size_t i = 0; i < count; i++) {
+		stack.pushString(kLongString, kLongStringLength);
+		stack.pushString(kLongString, kLongStringLength);
+
+		const Aurora::NWScript::NCSValue op2 = stack.pop();
+		const Aurora::NWScript::NCSValue op1 = stack.pop();
+		stack.push(stack.concat(op1, op2));
+
+		stack.pushVariable(Aurora::NWScript::Variable(Aurora::NWScript::kTypeEngineType));
+
+		stack.pop();
+		stack.pop();
+
+		stack.collect();
+	}
+}
+
+GTEST_TEST(NCSValueStack, collect) {
+	Aurora::NWScript::NCSValueStack stack;
+	stack.reset(0);
+
+	stack.pushString(kLongString, kLongStringLength);
+
+	churn(stack, 10000);
+
+	// Without reclaiming, this would be 10000 strings and boxes' worth
+	EXPECT_LT(stack.getStringArenaSize(), 128 * 1024);
+	EXPECT_LE(stack.getBoxCount(), 2048);
+	EXPECT_GE(stack.getAllocationCount(), 30000);
+
+	// The string still on the stack survived the compaction
+	const char *data;
+	size_t length;
+	stack.getString(stack.top(), data, length);
+
+	ASSERT_EQ(length, kLongStringLength);
+	EXPECT_EQ(std::memcmp(data, kLongString, length), 0);
+}
+
+GTEST_TEST(NCSValueStack, referenceAfterRepush) {
+	Aurora::NWScript::NCSValueStack stack;
+	stack.reset(0);
+
+	stack.pushInt(1);
+	stack.pushInt(2);
+
+	Aurora::NWScript::Variable &reference = stack.pinRelSP(-8);
+	EXPECT_EQ(reference.getInt(), 1);
+
+	stack.pop();
+	stack.pop();
+
+	churn(stack, 10000);
+
+	// The reference refers to the stack position, so it sees the value pushed there again
+	stack.pushInt(3);
+	EXPECT_EQ(reference.getInt(), 3);
+
+	// And writing through the reference changes the value on the stack
+	reference = 4;
+	EXPECT_EQ(stack.getInt(stack.getRelSP(-4)), 4);
+
+	stack.setRelSP(-4, stack.getRelSP(-4));
+	stack.pushInt(5);
+	stack.setRelSP(-8, stack.getRelSP(-4));
+	EXPECT_EQ(reference.getInt(), 5);
+
+	// A copy of the element is independent of the reference
+	stack.push(stack.copy(stack.getRelSP(-8)));
+	reference = 6;
+	EXPECT_EQ(stack.getInt(stack.top()), 5);
+	EXPECT_EQ(stack.getInt(stack.getRelSP(-12)), 6);
+}
+
+GTEST_TEST(NCSProfiler, loop) {
+	static const Aurora::NWScript::NCSFile::Interpreter kInterpreters[] = {
+		Aurora::NWScript::NCSFile::kInterpreterStep, Aurora::NWScript::NCSFile::kInterpreterFast
+	};
+
+	for (size_t i = 0; i < ARRAYSIZE(kInterpreters); i++) {
+		NCSProfile.clear();
+		NCSProfile.setEnabled(true);
+
+		runWith(kNCSLoop, sizeof(kNCSLoop), kInterpreters[i]);
+
+		NCSProfile.setEnabled(false);
+
+		std::vector<Aurora::NWScript::NCSProfiler::Entry> scripts, subroutines, functions;
+		NCSProfile.getEntries(Aurora::NWScript::NCSProfiler::kCategoryScript    , scripts);
+		NCSProfile.getEntries(Aurora::NWScript::NCSProfiler::kCategorySubroutine, subroutines);
+		NCSProfile.getEntries(Aurora::NWScript::NCSProfiler::kCategoryFunction  , functions);
+
+		ASSERT_EQ(scripts.size(), 1) << "At index " << i;
+		ASSERT_EQ(subroutines.size(), 1) << "At index " << i;
+		EXPECT_TRUE(functions.empty()) << "At index " << i;
+
+		// JSR and the final RETN in the script, everything else in the subroutine
+		EXPECT_EQ(scripts[0].calls, 1) << "At index " << i;
+		EXPECT_EQ(scripts[0].instructions, 2) << "At index " << i;
+
+		EXPECT_EQ(subroutines[0].calls, 1) << "At index " << i;
+		EXPECT_EQ(subroutines[0].instructions, 118) << "At index " << i;
+
+		EXPECT_GE(scripts[0].totalTime, subroutines[0].totalTime) << "At index " << i;
+
+		Common::MemoryWriteStreamDynamic stacks(true);
+		NCSProfile.writeFoldedStacks(stacks);
+
+		const Common::UString folded((const char *) stacks.getData(), stacks.size());
+
+		EXPECT_TRUE(folded.beginsWith(scripts[0].name + " ")) << "At index " << i;
+		EXPECT_TRUE(folded.contains(Common::UString(";") + subroutines[0].name + " ")) << "At index " << i;
+	}
+
+	NCSProfile.clear();
+}
@@ -0,0 +1,185 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our ObjectContainer class.
+ */
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/ustring.h"
+#include "src/common/strutil.h"
+#include "src/common/scopedptr.h"
+
+#include "src/aurora/nwscript/object.h"
+#include "src/aurora/nwscript/objectcontainer.h"
+
+class TestObject : public Aurora::NWScript::Object {
+public:
+	TestObject(uint32 id, const Common::UString &tag) {
+		_id  = id;
+		_tag = tag;
+	}
+};
+
+GTEST_TEST(ObjectContainer, getObjectByID) {
+	Aurora::NWScript::ObjectContainer container;
+	TestObject a(1, "a"), b(2, "b"), c(1000, "c");
+
+	container.addObject(a);
+	container.addObject(b);
+	container.addObject(c);
+
+	EXPECT_EQ(container.getObjectCount(), 3);
+
+	EXPECT_EQ(container.getObjectByID(   1), &a);
+	EXPECT_EQ(container.getObjectByID(   2), &b);
+	EXPECT_EQ(container.getObjectByID(1000), &c);
+	EXPECT_EQ(container.getObjectByID(   3), (Aurora::NWScript::Object *) 0);
+
+	container.removeObject(b);
+
+	EXPECT_EQ(container.getObjectCount(), 2);
+
+	EXPECT_EQ(container.getObjectByID(   1), &a);
+	EXPECT_EQ(container.getObjectByID(   2), (Aurora::NWScript::Object *) 0);
+	EXPECT_EQ(container.getObjectByID(1000), &c);
+}
+
+GTEST_TEST(ObjectContainer, getObjectByTag) {
+	Aurora::NWScript::ObjectContainer container;
+	TestObject a(1, "Foo"), b(2, "Bar"), c(3, "Foo"), d(4, "foo"), e(5, "Foo");
+
+	container.addObject(a);
+	container.addObject(b);
+	container.addObject(c);
+	container.addObject(d);
+	container.addObject(e);
+
+	// Tags are still compared case-sensitively
+	EXPECT_EQ(container.getFirstObjectByTag("Foo"), &a);
+	EXPECT_EQ(container.getFirstObjectByTag("foo"), &d);
+	EXPECT_EQ(container.getFirstObjectByTag("FOO"), (Aurora::NWScript::Object *) 0);
+
+	EXPECT_EQ(container.getObjectByTag("Foo", 0), &a);
+	EXPECT_EQ(container.getObjectByTag("Foo", 1), &c);
+	EXPECT_EQ(container.getObjectByTag("Foo", 2), &e);
+	EXPECT_EQ(container.getObjectByTag("Foo", 3), (Aurora::NWScript::Object *) 0);
+
+	// Removing an object keeps the others in order
+	container.removeObject(c);
+
+	EXPECT_EQ(container.getObjectByTag("Foo", 0), &a);
+	EXPECT_EQ(container.getObjectByTag("Foo", 1), &e);
+	EXPECT_EQ(container.getObjectByTag("Foo", 2), (Aurora::NWScript::Object *) 0);
+
+	container.clearObjects();
+
+	EXPECT_EQ(container.getObjectCount(), 0);
+	EXPECT_EQ(container.getFirstObjectByTag("Foo"), (Aurora::NWScript::Object *) 0);
+	EXPECT_EQ(container.getObjectByID(1), (Aurora::NWScript::Object *) 0);
+}
+
+GTEST_TEST(ObjectContainer, hashTag) {
+	EXPECT_EQ(Aurora::NWScript::ObjectContainer::hashTag("Foobar"),
+	          Aurora::NWScript::ObjectContainer::hashTag("fOOBAR"));
+	EXPECT_NE(Aurora::NWScript::ObjectContainer::hashTag("Foobar"),
+	          Aurora::NWScript::ObjectContainer::hashTag("Foobaz"));
+}
+
+GTEST_TEST(ObjectContainer, searchTag) {
+	Aurora::NWScript::ObjectContainer container;
+	TestObject a(1, "Foo"), b(2, "Bar"), c(3, "Foo"), d(4, "Foo");
+
+	container.addObject(a);
+	container.addObject(b);
+	container.addObject(c);
+
+	const Common::UString tag = "Foo";
+	Aurora::NWScript::SearchTag search(container, tag);
+
+	EXPECT_EQ(search.get() , &a);
+	EXPECT_EQ(search.next(), &a);
+	EXPECT_EQ(search.get() , &c);
+
+	// Changing the container while searching continues after the objects already found
+	container.addObject(d);
+
+	EXPECT_EQ(search.next(), &c);
+	EXPECT_EQ(search.next(), &d);
+	EXPECT_EQ(search.next(), (Aurora::NWScript::Object *) 0);
+	EXPECT_EQ(search.get() , (Aurora::NWScript::Object *) 0);
+
+	Common::ScopedPtr<Aurora::NWScript::ObjectSearch> heapSearch(container.findObjectsByTag("Foo"));
+
+	EXPECT_EQ(heapSearch->next(), &a);
+	EXPECT_EQ(heapSearch->next(), &c);
+	EXPECT_EQ(heapSearch->next(), &d);
+	EXPECT_EQ(heapSearch->next(), (Aurora::NWScript::Object *) 0);
+}
+
+GTEST_TEST(ObjectContainer, many) {
+	static const size_t kObjectCount = 5000;
+	static const size_t kTagCount    =  100;
+
+	Aurora::NWScript::ObjectContainer container;
+
+	std::vector<TestObject *> objects;
+	objects.reserve(kObjectCount);
+
+	for (size_t i = 0; i < kObjectCount; i++) {
+		objects.push_back(new TestObject(i * 7, "Tag" + Common::composeString(i % kTagCount)));
+		container.addObject(*objects.back());
+	}
+
+	// Remove every third object, to exercise moving objects around in the index
+	for (size_t i = 0; i < kObjectCount; i += 3)
+		container.removeObject(*objects[i]);
+
+	EXPECT_EQ(container.getObjectCount(), kObjectCount - (kObjectCount + 2) / 3);
+
+	for (size_t i = 0; i < kObjectCount; i++) {
+		Aurora::NWScript::Object *expected = ((i % 3) == 0) ? 0 : objects[i];
+
+		ASSERT_EQ(container.getObjectByID(i * 7), expected) << i;
+	}
+
+	for (size_t t = 0; t < kTagCount; t++) {
+		const Common::UString tag = "Tag" + Common::composeString(t);
+
+		size_t nth = 0;
+		for (size_t i = t; i < kObjectCount; i += kTagCount) {
+			if ((i % 3) == 0)
+				continue;
+
+			ASSERT_EQ(container.getObjectByTag(tag, nth++), objects[i]) << tag.c_str() << ", " << i;
+		}
+
+		ASSERT_EQ(container.getObjectByTag(tag, nth), (Aurora::NWScript::Object *) 0) << tag.c_str();
+	}
+
+	container.clearObjects();
+
+	for (std::vector<TestObject *>::iterator o = objects.begin(); o != objects.end(); ++o)
+		delete *o;
+}
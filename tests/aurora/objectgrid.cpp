@@ -0,0 +1,196 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our ObjectGrid class.
+ */
+
+#include <vector>
+#include <algorithm>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/ustring.h"
+
+#include "src/aurora/nwscript/object.h"
+#include "src/aurora/nwscript/objectgrid.h"
+
+class TestObject : public Aurora::NWScript::Object {
+public:
+	TestObject(const Common::UString &tag = "") {
+		_tag = tag;
+	}
+
+	float x, y, z;
+	uint32 index;
+};
+
+struct DistanceSort {
+	float x, y, z;
+
+	DistanceSort(float xx, float yy, float zz) : x(xx), y(yy), z(zz) { }
+
+	bool operator()(const TestObject *a, const TestObject *b) const {
+		const float distA = ABS(a->x - x) + ABS(a->y - y) + ABS(a->z - z);
+		const float distB = ABS(b->x - x) + ABS(b->y - y) + ABS(b->z - z);
+
+		if (distA != distB)
+			return distA < distB;
+
+		return a->index < b->index;
+	}
+};
+
+static void place(Aurora::NWScript::ObjectGrid &grid, TestObject &object, float x, float y, float z,
+                  uint32 type = 1) {
+
+	object.x = x;
+	object.y = y;
+	object.z = z;
+
+	grid.setObject(object, x, y, z, type);
+}
+
+GTEST_TEST(ObjectGrid, nearest) {
+	Aurora::NWScript::ObjectGrid grid;
+	TestObject a, b, c, d;
+
+	place(grid, a,   5.0f,  5.0f, 0.0f);
+	place(grid, b,  -3.0f, 25.0f, 0.0f);
+	place(grid, c, 200.0f,  1.0f, 0.0f);
+	place(grid, d,   1.0f,  1.0f, 0.0f);
+
+	std::vector<Aurora::NWScript::Object *> objects;
+	grid.findNearest(0.0f, 0.0f, 0.0f, 10, objects);
+
+	ASSERT_EQ(objects.size(), 4);
+	EXPECT_EQ(objects[0], &d);
+	EXPECT_EQ(objects[1], &a);
+	EXPECT_EQ(objects[2], &b);
+	EXPECT_EQ(objects[3], &c);
+
+	EXPECT_EQ(grid.getNearest(0.0f, 0.0f, 0.0f, 0), &d);
+	EXPECT_EQ(grid.getNearest(0.0f, 0.0f, 0.0f, 3), &c);
+	EXPECT_EQ(grid.getNearest(0.0f, 0.0f, 0.0f, 4), (Aurora::NWScript::Object *) 0);
+
+	// From far outside all filled cells
+	EXPECT_EQ(grid.getNearest(5000.0f, -5000.0f, 0.0f, 0), &c);
+}
+
+GTEST_TEST(ObjectGrid, filter) {
+	Aurora::NWScript::ObjectGrid grid;
+	TestObject a("Foo"), b("Bar"), c("Foo"), d("Bar");
+
+	place(grid, a, 1.0f, 0.0f, 0.0f, 1);
+	place(grid, b, 2.0f, 0.0f, 0.0f, 2);
+	place(grid, c, 3.0f, 0.0f, 0.0f, 4);
+	place(grid, d, 4.0f, 0.0f, 0.0f, 4);
+
+	EXPECT_EQ(grid.getNearest(0.0f, 0.0f, 0.0f, 0, 4), &c);
+	EXPECT_EQ(grid.getNearest(0.0f, 0.0f, 0.0f, 1, 4), &d);
+	EXPECT_EQ(grid.getNearest(0.0f, 0.0f, 0.0f, 0, 6), &b);
+	EXPECT_EQ(grid.getNearest(0.0f, 0.0f, 0.0f, 0, 8), (Aurora::NWScript::Object *) 0);
+
+	EXPECT_EQ(grid.getNearest(0.0f, 0.0f, 0.0f, 0, Aurora::NWScript::ObjectGrid::kTypeAny, "Bar"), &b);
+	EXPECT_EQ(grid.getNearest(0.0f, 0.0f, 0.0f, 1, Aurora::NWScript::ObjectGrid::kTypeAny, "Foo"), &c);
+	EXPECT_EQ(grid.getNearest(0.0f, 0.0f, 0.0f, 0, Aurora::NWScript::ObjectGrid::kTypeAny, "Bar", &b), &d);
+	EXPECT_EQ(grid.getNearest(0.0f, 0.0f, 0.0f, 0, 1, "Bar"), (Aurora::NWScript::Object *) 0);
+}
+
+GTEST_TEST(ObjectGrid, move) {
+	Aurora::NWScript::ObjectGrid grid;
+	TestObject a, b;
+
+	place(grid, a, 1.0f, 1.0f, 0.0f);
+	place(grid, b, 2.0f, 2.0f, 0.0f);
+
+	EXPECT_EQ(grid.getNearest(0.0f, 0.0f, 0.0f, 0), &a);
+
+	// Move within the same cell
+	place(grid, a, 3.0f, 3.0f, 0.0f);
+	EXPECT_EQ(grid.getNearest(0.0f, 0.0f, 0.0f, 0), &b);
+
+	// Move into another cell
+	place(grid, b, 100.0f, 100.0f, 0.0f);
+	EXPECT_EQ(grid.getNearest(0.0f, 0.0f, 0.0f, 0), &a);
+	EXPECT_EQ(grid.getNearest(90.0f, 90.0f, 0.0f, 0), &b);
+
+	EXPECT_EQ(grid.getObjectCount(), 2);
+
+	std::vector<Aurora::NWScript::Object *> objects;
+	grid.getObjects(objects);
+
+	ASSERT_EQ(objects.size(), 2);
+	EXPECT_TRUE(std::find(objects.begin(), objects.end(), &a) != objects.end());
+	EXPECT_TRUE(std::find(objects.begin(), objects.end(), &b) != objects.end());
+
+	grid.removeObject(a);
+	EXPECT_FALSE(grid.hasObject(a));
+	EXPECT_TRUE(grid.hasObject(b));
+	EXPECT_EQ(grid.getNearest(0.0f, 0.0f, 0.0f, 0), &b);
+
+	grid.clear();
+	EXPECT_EQ(grid.getObjectCount(), 0);
+	EXPECT_EQ(grid.getNearest(0.0f, 0.0f, 0.0f, 0), (Aurora::NWScript::Object *) 0);
+}
+
+GTEST_TEST(ObjectGrid, bruteForce) {
+	static const size_t kObjectCount = 500;
+
+	Aurora::NWScript::ObjectGrid grid(8.0f);
+	std::vector<TestObject> objects(kObjectCount);
+
+	// Integer coordinates, to get plenty of equidistant objects
+	uint32 random = 12345;
+	for (size_t i = 0; i < kObjectCount; i++) {
+		random = random * 1103515245 + 12345;
+		const float x = (float) ((int32) ((random >> 8) % 201) - 100);
+		random = random * 1103515245 + 12345;
+		const float y = (float) ((int32) ((random >> 8) % 201) - 100);
+		random = random * 1103515245 + 12345;
+		const float z = (float) ((int32) ((random >> 8) % 5));
+
+		objects[i].index = i;
+		place(grid, objects[i], x, y, z, 1 << (i % 3));
+	}
+
+	std::vector<TestObject *> expected;
+	std::vector<Aurora::NWScript::Object *> found;
+
+	for (int32 qx = -130; qx <= 130; qx += 13) {
+		for (int32 qy = -130; qy <= 130; qy += 17) {
+			for (uint32 types = 1; types <= 7; types += 3) {
+				expected.clear();
+				for (size_t i = 0; i < kObjectCount; i++)
+					if ((1U << (i % 3)) & types)
+						expected.push_back(&objects[i]);
+
+				std::sort(expected.begin(), expected.end(), DistanceSort(qx, qy, 0.0f));
+
+				grid.findNearest(qx, qy, 0.0f, 12, found, types);
+
+				ASSERT_EQ(found.size(), 12);
+				for (size_t i = 0; i < found.size(); i++)
+					ASSERT_EQ(found[i], expected[i]) << "At " << qx << ", " << qy << ": " << i;
+			}
+		}
+	}
+}
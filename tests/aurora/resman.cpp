@@ -0,0 +1,758 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our resource manager.
+ */
+
+#include <vector>
+#include <ctime>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/scopedptr.h"
+#include "src/common/readstream.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+#include "src/common/platform.h"
+#include "src/common/strutil.h"
+#include "src/common/changeid.h"
+
+#include "src/aurora/resman.h"
+#include "src/aurora/smallfile.h"
+
+boost::filesystem::path kDirPath;
+
+static const size_t kSmallFileSize = 200;
+static const size_t kBigFileSize   = 600;
+
+static const char * const kSmallFiles[] = { "a", "b", "c", "d", "e", "f" };
+
+static void writeTestFile(const Common::UString &name, size_t size, byte value) {
+	boost::filesystem::ofstream file(kDirPath / (name + ".txt").c_str(), std::ofstream::binary);
+
+	for (size_t i = 0; i < size; i++)
+		file.put((char) (value + i));
+
+	file.close();
+}
+
+/** Write a test file compressed into a "small" file, so that reading it needs decoding. */
+static void writeSmallTestFile(const Common::UString &name, size_t size, byte value) {
+	std::vector<byte> data(size);
+	for (size_t i = 0; i < size; i++)
+		data[i] = value + i;
+
+	Common::MemoryReadStream in(&data[0], data.size());
+	Common::MemoryWriteStreamDynamic small(true);
+
+	Aurora::Small::compress10(in, small);
+
+	boost::filesystem::ofstream file(kDirPath / (name + ".txt.small").c_str(), std::ofstream::binary);
+	file.write(reinterpret_cast<const char *>(small.getData()), small.size());
+	file.close();
+}
+
+/** A resource within a test RIM file. */
+struct RIMResource {
+	Common::UString name;
+	Aurora::FileType type;
+	std::vector<byte> data;
+
+	RIMResource(const Common::UString &n, Aurora::FileType t, const Common::UString &d) :
+		name(n), type(t), data(d.c_str(), d.c_str() + d.size()) {
+	}
+
+	RIMResource(const Common::UString &n, Aurora::FileType t, const std::vector<byte> &d) :
+		name(n), type(t), data(d) {
+	}
+};
+
+static void writeUint16LE(std::vector<byte> &data, uint16 value) {
+	for (size_t i = 0; i < 2; i++)
+		data.push_back((value >> (8 * i)) & 0xFF);
+}
+
+static void writeUint32LE(std::vector<byte> &data, uint32 value) {
+	for (size_t i = 0; i < 4; i++)
+		data.push_back((value >> (8 * i)) & 0xFF);
+}
+
+static std::vector<byte> createRIM(const std::vector<RIMResource> &resources) {
+	static const size_t kHeaderSize = 20;
+	static const size_t kEntrySize  = 32;
+
+	std::vector<byte> rim;
+	rim.reserve(kHeaderSize);
+
+	const char *id = "RIM V1.0";
+	rim.insert(rim.end(), id, id + 8);
+
+	writeUint32LE(rim, 0);
+	writeUint32LE(rim, resources.size());
+	writeUint32LE(rim, kHeaderSize);
+
+	uint32 offset = kHeaderSize + resources.size() * kEntrySize;
+	for (std::vector<RIMResource>::const_iterator r = resources.begin(); r != resources.end(); ++r) {
+		std::vector<byte> name(16, 0);
+		std::copy(r->name.c_str(), r->name.c_str() + MIN<size_t>(r->name.size(), 16), name.begin());
+
+		rim.insert(rim.end(), name.begin(), name.end());
+		writeUint32LE(rim, (uint32) r->type);
+		writeUint32LE(rim, 0);
+		writeUint32LE(rim, offset);
+		writeUint32LE(rim, r->data.size());
+
+		offset += r->data.size();
+	}
+
+	for (std::vector<RIMResource>::const_iterator r = resources.begin(); r != resources.end(); ++r)
+		rim.insert(rim.end(), r->data.begin(), r->data.end());
+
+	return rim;
+}
+
+static void writeRIMFile(const Common::UString &name, const std::vector<RIMResource> &resources) {
+	const std::vector<byte> rim = createRIM(resources);
+
+	boost::filesystem::ofstream file(kDirPath / (name + ".rim").c_str(), std::ofstream::binary);
+	file.write(reinterpret_cast<const char *>(&rim[0]), rim.size());
+	file.close();
+}
+
+/** Write a ZIP file with one deflated file, so that reading it needs decoding. */
+static void writeZIPFile(const Common::UString &name, const Common::UString &fileName, const Common::UString &data) {
+	/* A single, final deflate block of stored data. It's not actually any
+	 * smaller, but it has to go through the decompressor all the same. */
+	std::vector<byte> deflated;
+	deflated.push_back(0x01);
+	writeUint16LE(deflated,  (uint16) data.size());
+	writeUint16LE(deflated, ~(uint16) data.size());
+	deflated.insert(deflated.end(), data.c_str(), data.c_str() + data.size());
+
+	std::vector<byte> zip;
+
+	// Local file header
+	writeUint32LE(zip, 0x04034B50);
+	writeUint16LE(zip, 20); // Version needed
+	writeUint16LE(zip, 0);  // Flags
+	writeUint16LE(zip, 8);  // Compression method: deflate
+	writeUint32LE(zip, 0);  // Modification time and date
+	writeUint32LE(zip, 0);  // CRC32
+	writeUint32LE(zip, deflated.size());
+	writeUint32LE(zip, data.size());
+	writeUint16LE(zip, fileName.size());
+	writeUint16LE(zip, 0);  // Extra field length
+	zip.insert(zip.end(), fileName.c_str(), fileName.c_str() + fileName.size());
+	zip.insert(zip.end(), deflated.begin(), deflated.end());
+
+	// Central directory
+	const size_t centralDirOffset = zip.size();
+
+	writeUint32LE(zip, 0x02014B50);
+	writeUint16LE(zip, 20); // Version made by
+	writeUint16LE(zip, 20); // Version needed
+	writeUint16LE(zip, 0);  // Flags
+	writeUint16LE(zip, 8);  // Compression method: deflate
+	writeUint32LE(zip, 0);  // Modification time and date
+	writeUint32LE(zip, 0);  // CRC32
+	writeUint32LE(zip, deflated.size());
+	writeUint32LE(zip, data.size());
+	writeUint16LE(zip, fileName.size());
+	writeUint16LE(zip, 0);  // Extra field length
+	writeUint16LE(zip, 0);  // Comment length
+	writeUint16LE(zip, 0);  // Disk number
+	writeUint16LE(zip, 0);  // Internal attributes
+	writeUint32LE(zip, 0);  // External attributes
+	writeUint32LE(zip, 0);  // Offset of the local file header
+	zip.insert(zip.end(), fileName.c_str(), fileName.c_str() + fileName.size());
+
+	const size_t centralDirSize = zip.size() - centralDirOffset;
+
+	// End of central directory
+	writeUint32LE(zip, 0x06054B50);
+	writeUint16LE(zip, 0); // Current disk
+	writeUint16LE(zip, 0); // Disk with the central directory
+	writeUint16LE(zip, 1); // Entries on this disk
+	writeUint16LE(zip, 1); // Entries in total
+	writeUint32LE(zip, centralDirSize);
+	writeUint32LE(zip, centralDirOffset);
+	writeUint16LE(zip, 0); // Comment length
+
+	boost::filesystem::ofstream file(kDirPath / (name + ".zip").c_str(), std::ofstream::binary);
+	file.write(reinterpret_cast<const char *>(&zip[0]), zip.size());
+	file.close();
+}
+
+static const size_t kKEYBIFCount = 8;
+
+static Common::UString getKEYBIF(size_t bif) {
+	return "keyed" + Common::composeString(bif);
+}
+
+static Common::UString getKEYResource(size_t bif) {
+	return "keyedres" + Common::composeString(bif);
+}
+
+/** Write a KEY with several BIFs, each containing one resource. */
+static void writeKEYFiles() {
+	static const size_t kKEYHeaderSize = 64;
+	static const size_t kKEYBIFSize    = 12;
+
+	std::vector<byte> key;
+
+	const char *keyID = "KEY V1  ";
+	key.insert(key.end(), keyID, keyID + 8);
+
+	writeUint32LE(key, kKEYBIFCount);
+	writeUint32LE(key, kKEYBIFCount);
+	writeUint32LE(key, kKEYHeaderSize);
+	writeUint32LE(key, 0); // Offset of the resource table, filled in below
+	writeUint32LE(key, 0); // Build year
+	writeUint32LE(key, 0); // Build day
+	key.resize(kKEYHeaderSize, 0);
+
+	uint32 nameOffset = kKEYHeaderSize + kKEYBIFCount * kKEYBIFSize;
+	for (size_t i = 0; i < kKEYBIFCount; i++) {
+		const Common::UString bifName = getKEYBIF(i) + ".bif";
+
+		writeUint32LE(key, 0); // File size
+		writeUint32LE(key, nameOffset);
+		writeUint16LE(key, bifName.size());
+		writeUint16LE(key, 0); // Drives
+
+		nameOffset += bifName.size();
+	}
+
+	for (size_t i = 0; i < kKEYBIFCount; i++) {
+		const Common::UString bifName = getKEYBIF(i) + ".bif";
+
+		key.insert(key.end(), bifName.c_str(), bifName.c_str() + bifName.size());
+	}
+
+	const uint32 resTableOffset = key.size();
+	for (size_t i = 0; i < 4; i++)
+		key[20 + i] = (resTableOffset >> (8 * i)) & 0xFF;
+
+	for (size_t i = 0; i < kKEYBIFCount; i++) {
+		const Common::UString resName = getKEYResource(i);
+
+		std::vector<byte> name(16, 0);
+		std::copy(resName.c_str(), resName.c_str() + MIN<size_t>(resName.size(), 16), name.begin());
+
+		key.insert(key.end(), name.begin(), name.end());
+		writeUint16LE(key, Aurora::kFileTypeTXT);
+		writeUint32LE(key, i << 20); // BIF index and resource index within the BIF
+	}
+
+	boost::filesystem::ofstream keyFile(kDirPath / "keyed.key", std::ofstream::binary);
+	keyFile.write(reinterpret_cast<const char *>(&key[0]), key.size());
+	keyFile.close();
+
+	for (size_t i = 0; i < kKEYBIFCount; i++) {
+		static const size_t kBIFHeaderSize = 20;
+		static const size_t kBIFResSize    = 16;
+
+		const Common::UString data = getKEYBIF(i) + "/" + getKEYResource(i);
+
+		std::vector<byte> bif;
+
+		const char *bifID = "BIFFV1  ";
+		bif.insert(bif.end(), bifID, bifID + 8);
+
+		writeUint32LE(bif, 1); // Variable resources
+		writeUint32LE(bif, 0); // Fixed resources
+		writeUint32LE(bif, kBIFHeaderSize);
+
+		writeUint32LE(bif, 0); // ID
+		writeUint32LE(bif, kBIFHeaderSize + kBIFResSize);
+		writeUint32LE(bif, data.size());
+		writeUint32LE(bif, Aurora::kFileTypeTXT);
+
+		bif.insert(bif.end(), data.c_str(), data.c_str() + data.size());
+
+		boost::filesystem::ofstream bifFile(kDirPath / (getKEYBIF(i) + ".bif").c_str(), std::ofstream::binary);
+		bifFile.write(reinterpret_cast<const char *>(&bif[0]), bif.size());
+		bifFile.close();
+	}
+}
+
+static const size_t kBatchArchiveCount  = 16;
+static const size_t kBatchResourceCount = 24;
+
+static Common::UString getBatchArchive(size_t archive) {
+	return "batch" + Common::composeString(archive);
+}
+
+static Common::UString getBatchResource(size_t resource) {
+	return "batchres" + Common::composeString(resource);
+}
+
+static void writeBatchFiles() {
+	/* Every archive contains a different, overlapping subset of the resources,
+	 * so that the priorities of the archives decide which one we get. */
+	for (size_t i = 0; i < kBatchArchiveCount; i++) {
+		std::vector<RIMResource> resources;
+
+		for (size_t j = 0; j < kBatchResourceCount; j++)
+			if (((j + i) % 3) != 0)
+				resources.push_back(RIMResource(getBatchResource(j), Aurora::kFileTypeTXT,
+				                                getBatchArchive(i) + "/" + getBatchResource(j)));
+
+		writeRIMFile(getBatchArchive(i), resources);
+	}
+
+	// An archive within an archive
+	std::vector<RIMResource> inner;
+	inner.push_back(RIMResource("innerres", Aurora::kFileTypeTXT, "inner"));
+
+	std::vector<RIMResource> outer;
+	outer.push_back(RIMResource("inner", Aurora::kFileTypeRIM, createRIM(inner)));
+
+	writeRIMFile("outer", outer);
+}
+
+static void writeCachedFile(const Common::UString &name, const Common::UString &data) {
+	std::vector<RIMResource> resources;
+	resources.push_back(RIMResource(name, Aurora::kFileTypeTXT, data));
+
+	writeRIMFile("cached", resources);
+}
+
+static Common::UString readResource(const Common::UString &name) {
+	Common::ScopedPtr<Common::SeekableReadStream> stream(ResMan.getResource(name, Aurora::kFileTypeTXT));
+	if (!stream)
+		return "";
+
+	std::vector<char> data(stream->size());
+	if (data.empty())
+		return "";
+
+	stream->read(&data[0], data.size());
+
+	return Common::UString(&data[0], data.size());
+}
+
+class ResourceManager : public ::testing::Test {
+protected:
+	static void SetUpTestCase() {
+		Common::Platform::init();
+
+		boost::filesystem::path tmpPath    = boost::filesystem::temp_directory_path();
+		boost::filesystem::path uniquePath = boost::filesystem::unique_path("%%%%_%%%%_%%%%_%%%%.xoreos");
+
+		kDirPath = tmpPath / uniquePath;
+		boost::filesystem::create_directory(kDirPath);
+
+		for (size_t i = 0; i < ARRAYSIZE(kSmallFiles); i++)
+			writeSmallTestFile(kSmallFiles[i], kSmallFileSize, i);
+
+		writeSmallTestFile("big", kBigFileSize, 0);
+
+		writeTestFile("raw", kSmallFileSize, 0);
+
+		writeBatchFiles();
+		writeCachedFile("cachedres", "old");
+		writeZIPFile("deflated", "deflatedres.txt", "deflated");
+		writeKEYFiles();
+	}
+
+	static void TearDownTestCase() {
+		if (!kDirPath.empty())
+			boost::filesystem::remove_all(kDirPath);
+	}
+
+	void SetUp() {
+		ResMan.registerDataBase(kDirPath.generic_string());
+		ResMan.setHasSmall(true);
+
+		for (size_t i = 0; i < ARRAYSIZE(kSmallFiles); i++)
+			ResMan.indexResourceFile(Common::UString(kSmallFiles[i]) + ".txt.small", 1);
+
+		ResMan.indexResourceFile("big.txt.small", 1);
+		ResMan.indexResourceFile("raw.txt", 1);
+	}
+
+	void TearDown() {
+		ResMan.setCacheSize(0);
+		ResMan.clearCache();
+		ResMan.clear();
+	}
+};
+
+static void checkResource(const Common::UString &name, size_t size, byte value) {
+	Common::ScopedPtr<Common::SeekableReadStream> stream(ResMan.getResource(name, Aurora::kFileTypeTXT));
+	ASSERT_TRUE(stream);
+
+	ASSERT_EQ(stream->size(), size);
+	for (size_t i = 0; i < size; i++)
+		EXPECT_EQ(stream->readByte(), (byte) (value + i)) << "At index " << i;
+}
+
+GTEST_TEST_F(ResourceManager, cacheDisabled) {
+	checkResource("a", kSmallFileSize, 0);
+	checkResource("a", kSmallFileSize, 0);
+
+	Aurora::ResourceManager::CacheStats stats;
+	ResMan.getCacheStats(stats);
+
+	EXPECT_EQ(stats.budget, 0);
+	EXPECT_EQ(stats.count, 0);
+	EXPECT_EQ(stats.hits, 0);
+	EXPECT_EQ(stats.misses, 0);
+}
+
+GTEST_TEST_F(ResourceManager, cacheHit) {
+	ResMan.setCacheSize(1024);
+
+	checkResource("a", kSmallFileSize, 0);
+	checkResource("a", kSmallFileSize, 0);
+	checkResource("b", kSmallFileSize, 1);
+
+	Aurora::ResourceManager::CacheStats stats;
+	ResMan.getCacheStats(stats);
+
+	EXPECT_EQ(stats.budget, 1024);
+	EXPECT_EQ(stats.size, 2 * kSmallFileSize);
+	EXPECT_EQ(stats.count, 2);
+	EXPECT_EQ(stats.hits, 1);
+	EXPECT_EQ(stats.misses, 2);
+	EXPECT_EQ(stats.evictions, 0);
+}
+
+GTEST_TEST_F(ResourceManager, cacheTooBig) {
+	ResMan.setCacheSize(1024);
+
+	checkResource("big", kBigFileSize, 0);
+	checkResource("big", kBigFileSize, 0);
+
+	Aurora::ResourceManager::CacheStats stats;
+	ResMan.getCacheStats(stats);
+
+	EXPECT_EQ(stats.size, 0);
+	EXPECT_EQ(stats.count, 0);
+	EXPECT_EQ(stats.hits, 0);
+	EXPECT_EQ(stats.misses, 2);
+}
+
+GTEST_TEST_F(ResourceManager, cacheRaw) {
+	ResMan.setCacheSize(1024);
+
+	// Resources that don't need decoding are never cached
+	checkResource("raw", kSmallFileSize, 0);
+	checkResource("raw", kSmallFileSize, 0);
+
+	Aurora::ResourceManager::CacheStats stats;
+	ResMan.getCacheStats(stats);
+
+	EXPECT_EQ(stats.size, 0);
+	EXPECT_EQ(stats.count, 0);
+	EXPECT_EQ(stats.hits, 0);
+	EXPECT_EQ(stats.misses, 0);
+}
+
+GTEST_TEST_F(ResourceManager, cacheEvict) {
+	ResMan.setCacheSize(1024);
+
+	// Five resources fit, the sixth evicts the least recently used one
+	for (size_t i = 0; i < ARRAYSIZE(kSmallFiles); i++) {
+		checkResource(kSmallFiles[i], kSmallFileSize, i);
+
+		// Keep "a" fresh
+		checkResource("a", kSmallFileSize, 0);
+	}
+
+	Aurora::ResourceManager::CacheStats stats;
+	ResMan.getCacheStats(stats);
+
+	EXPECT_EQ(stats.size, 5 * kSmallFileSize);
+	EXPECT_EQ(stats.count, 5);
+	EXPECT_EQ(stats.evictions, 1);
+
+	// "b" was evicted, "a" is still there
+	const uint64 hits = stats.hits;
+
+	checkResource("a", kSmallFileSize, 0);
+	ResMan.getCacheStats(stats);
+	EXPECT_EQ(stats.hits, hits + 1);
+
+	checkResource("b", kSmallFileSize, 1);
+	ResMan.getCacheStats(stats);
+	EXPECT_EQ(stats.hits, hits + 1);
+
+	// Shrinking the cache evicts immediately
+	ResMan.setCacheSize(kSmallFileSize);
+	ResMan.getCacheStats(stats);
+
+	EXPECT_EQ(stats.count, 1);
+	EXPECT_EQ(stats.size, kSmallFileSize);
+}
+
+GTEST_TEST_F(ResourceManager, cacheClear) {
+	ResMan.setCacheSize(1024);
+
+	checkResource("a", kSmallFileSize, 0);
+	checkResource("a", kSmallFileSize, 0);
+
+	ResMan.clearCache();
+
+	Aurora::ResourceManager::CacheStats stats;
+	ResMan.getCacheStats(stats);
+
+	EXPECT_EQ(stats.budget, 1024);
+	EXPECT_EQ(stats.size, 0);
+	EXPECT_EQ(stats.count, 0);
+	EXPECT_EQ(stats.hits, 0);
+	EXPECT_EQ(stats.misses, 0);
+}
+
+GTEST_TEST_F(ResourceManager, cacheInvalidate) {
+	ResMan.setCacheSize(1024);
+
+	checkResource("a", kSmallFileSize, 0);
+
+	// Blacklisting a resource has to remove it from the cache
+	ResMan.blacklist("a", Aurora::kFileTypeTXT);
+
+	Common::ScopedPtr<Common::SeekableReadStream> stream(ResMan.getResource("a", Aurora::kFileTypeTXT));
+	EXPECT_FALSE(stream);
+
+	Aurora::ResourceManager::CacheStats stats;
+	ResMan.getCacheStats(stats);
+
+	EXPECT_EQ(stats.count, 0);
+}
+
+GTEST_TEST_F(ResourceManager, indexArchives) {
+	std::list<Common::ChangeID> changes;
+
+	std::vector<Aurora::ResourceManager::BatchArchive> archives;
+	for (size_t i = 0; i < kBatchArchiveCount; i++) {
+		changes.push_back(Common::ChangeID());
+		archives.push_back(Aurora::ResourceManager::BatchArchive(getBatchArchive(i) + ".rim", 100 + i, &changes.back()));
+	}
+
+	// Index all archives one by one, and remember what we found
+
+	for (size_t i = 0; i < archives.size(); i++)
+		ResMan.indexArchive(archives[i].file, archives[i].priority, archives[i].changeID);
+
+	std::vector<Common::UString> serial;
+	for (size_t j = 0; j < kBatchResourceCount; j++)
+		serial.push_back(readResource(getBatchResource(j)));
+
+	for (std::list<Common::ChangeID>::reverse_iterator c = changes.rbegin(); c != changes.rend(); ++c)
+		ResMan.undo(*c);
+
+	for (size_t j = 0; j < kBatchResourceCount; j++)
+		EXPECT_TRUE(readResource(getBatchResource(j)).empty()) << "At index " << j;
+
+	// Index them all in one batch, and compare
+
+	ResMan.indexArchives(archives);
+
+	for (size_t j = 0; j < kBatchResourceCount; j++) {
+		// The last archive containing the resource has the highest priority
+		size_t archive = kBatchArchiveCount - 1;
+		while (((j + archive) % 3) == 0)
+			archive--;
+
+		EXPECT_EQ(serial[j], getBatchArchive(archive) + "/" + getBatchResource(j)) << "At index " << j;
+		EXPECT_EQ(readResource(getBatchResource(j)), serial[j]) << "At index " << j;
+	}
+
+	// The batch has to be undoable just like the single archives
+
+	for (std::list<Common::ChangeID>::reverse_iterator c = changes.rbegin(); c != changes.rend(); ++c)
+		ResMan.undo(*c);
+
+	for (size_t j = 0; j < kBatchResourceCount; j++)
+		EXPECT_TRUE(readResource(getBatchResource(j)).empty()) << "At index " << j;
+}
+
+GTEST_TEST_F(ResourceManager, indexArchivesNested) {
+	std::vector<Aurora::ResourceManager::BatchArchive> archives;
+	archives.push_back(Aurora::ResourceManager::BatchArchive("batch0.rim", 100));
+	archives.push_back(Aurora::ResourceManager::BatchArchive("outer.rim" , 101));
+	archives.push_back(Aurora::ResourceManager::BatchArchive("inner.rim" , 102));
+	archives.push_back(Aurora::ResourceManager::BatchArchive("batch1.rim", 103));
+
+	ResMan.indexArchives(archives);
+
+	EXPECT_EQ(readResource("innerres"), "inner");
+	EXPECT_EQ(readResource(getBatchResource(1)), "batch1/" + getBatchResource(1));
+}
+
+GTEST_TEST_F(ResourceManager, indexArchivesMissing) {
+	std::vector<Aurora::ResourceManager::BatchArchive> archives;
+	archives.push_back(Aurora::ResourceManager::BatchArchive("batch0.rim"    , 100));
+	archives.push_back(Aurora::ResourceManager::BatchArchive("nonexistent.rim", 101));
+	archives.push_back(Aurora::ResourceManager::BatchArchive("batch1.rim"    , 102));
+
+	EXPECT_THROW(ResMan.indexArchives(archives), Common::Exception);
+
+	// The archives in front of the missing one are still indexed
+	EXPECT_EQ(readResource(getBatchResource(1)), "batch0/" + getBatchResource(1));
+	EXPECT_EQ(readResource(getBatchResource(2)), "batch0/" + getBatchResource(2));
+}
+
+GTEST_TEST_F(ResourceManager, indexKEY) {
+	Common::ChangeID change;
+	ResMan.indexArchive("keyed.key", 100, &change);
+
+	// The BIFs are read in parallel, but have to end up the same
+	for (size_t i = 0; i < kKEYBIFCount; i++)
+		EXPECT_EQ(readResource(getKEYResource(i)), getKEYBIF(i) + "/" + getKEYResource(i)) << "At index " << i;
+
+	ResMan.undo(change);
+
+	for (size_t i = 0; i < kKEYBIFCount; i++)
+		EXPECT_TRUE(readResource(getKEYResource(i)).empty()) << "At index " << i;
+}
+
+GTEST_TEST_F(ResourceManager, indexCache) {
+	const Common::UString cacheFile = (kDirPath / "index.cache").generic_string();
+
+	Common::ChangeID change;
+
+	// Fill the cache
+
+	ResMan.openIndexCache(cacheFile);
+
+	for (size_t i = 0; i < kBatchArchiveCount; i++)
+		ResMan.indexArchive(getBatchArchive(i) + ".rim", 100 + i, &change);
+
+	std::vector<Common::UString> serial;
+	for (size_t j = 0; j < kBatchResourceCount; j++)
+		serial.push_back(readResource(getBatchResource(j)));
+
+	ResMan.undo(change);
+	ResMan.closeIndexCache();
+
+	ASSERT_TRUE(boost::filesystem::exists(kDirPath / "index.cache"));
+
+	// Index the archives again, with their resource tables taken out of the cache
+
+	ResMan.openIndexCache(cacheFile);
+
+	std::vector<Aurora::ResourceManager::BatchArchive> archives;
+	for (size_t i = 0; i < kBatchArchiveCount; i++)
+		archives.push_back(Aurora::ResourceManager::BatchArchive(getBatchArchive(i) + ".rim", 100 + i, &change));
+
+	ResMan.indexArchives(archives);
+
+	for (size_t j = 0; j < kBatchResourceCount; j++)
+		EXPECT_EQ(readResource(getBatchResource(j)), serial[j]) << "At index " << j;
+
+	ResMan.undo(change);
+	ResMan.closeIndexCache();
+
+	boost::filesystem::remove(kDirPath / "index.cache");
+}
+
+GTEST_TEST_F(ResourceManager, indexCacheDecoded) {
+	const Common::UString cacheFile = (kDirPath / "index.cache").generic_string();
+
+	ResMan.setCacheSize(1024);
+
+	Common::ChangeID change;
+
+	ResMan.openIndexCache(cacheFile);
+	ResMan.indexArchive("deflated.zip", 100, &change);
+	ResMan.undo(change);
+	ResMan.closeIndexCache();
+
+	/* Index the archive again, with its resource table taken out of the index cache.
+	 * Its deflated resource still needs decoding, so it has to be kept in the cache. */
+
+	ResMan.openIndexCache(cacheFile);
+	ResMan.indexArchive("deflated.zip", 100, &change);
+
+	EXPECT_EQ(readResource("deflatedres"), "deflated");
+	EXPECT_EQ(readResource("deflatedres"), "deflated");
+
+	Aurora::ResourceManager::CacheStats stats;
+	ResMan.getCacheStats(stats);
+
+	EXPECT_EQ(stats.count, 1);
+	EXPECT_EQ(stats.hits, 1);
+	EXPECT_EQ(stats.misses, 1);
+
+	ResMan.undo(change);
+	ResMan.closeIndexCache();
+
+	boost::filesystem::remove(kDirPath / "index.cache");
+}
+
+GTEST_TEST_F(ResourceManager, indexCacheChanged) {
+	const Common::UString cacheFile = (kDirPath / "index.cache").generic_string();
+	const boost::filesystem::path archive = kDirPath / "cached.rim";
+
+	/* The cache compares modification times with sub-second precision. Round the
+	 * time down to whole seconds, so that we can restore it exactly further down. */
+	const std::time_t time = boost::filesystem::last_write_time(archive);
+	boost::filesystem::last_write_time(archive, time);
+
+	Common::ChangeID change;
+
+	ResMan.openIndexCache(cacheFile);
+	ResMan.indexArchive("cached.rim", 100, &change);
+	ResMan.undo(change);
+	ResMan.closeIndexCache();
+
+	/* Sneakily change the contents of the archive, without changing its size and
+	 * modification time. The cache can't notice, so we'll still see the old table. */
+	writeCachedFile("cachedrez", "new");
+	boost::filesystem::last_write_time(archive, time);
+
+	ResMan.openIndexCache(cacheFile);
+	ResMan.indexArchive("cached.rim", 100, &change);
+
+	EXPECT_TRUE(ResMan.hasResource("cachedres", Aurora::kFileTypeTXT));
+	EXPECT_FALSE(ResMan.hasResource("cachedrez", Aurora::kFileTypeTXT));
+
+	// The data itself is read out of the real archive
+	EXPECT_EQ(readResource("cachedres"), "new");
+
+	ResMan.undo(change);
+
+	// Now touch the archive, which has to invalidate the cached table
+
+	boost::filesystem::last_write_time(archive, time + 10);
+
+	ResMan.indexArchive("cached.rim", 100, &change);
+
+	EXPECT_FALSE(ResMan.hasResource("cachedres", Aurora::kFileTypeTXT));
+	EXPECT_TRUE(ResMan.hasResource("cachedrez", Aurora::kFileTypeTXT));
+
+	EXPECT_EQ(readResource("cachedrez"), "new");
+
+	ResMan.undo(change);
+	ResMan.closeIndexCache();
+
+	boost::filesystem::remove(kDirPath / "index.cache");
+
+	writeCachedFile("cachedres", "old");
+}
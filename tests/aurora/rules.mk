@@ -145,3 +145,28 @@ check_PROGRAMS                    += tests/aurora/test_nfofile
 tests_aurora_test_nfofile_SOURCES  = tests/aurora/nfofile.cpp
 tests_aurora_test_nfofile_LDADD    = $(aurora_LIBS)
 tests_aurora_test_nfofile_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                   += tests/aurora/test_resman
+tests_aurora_test_resman_SOURCES  = tests/aurora/resman.cpp
+tests_aurora_test_resman_LDADD    = $(aurora_LIBS)
+tests_aurora_test_resman_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                    += tests/aurora/test_ncsfile
+tests_aurora_test_ncsfile_SOURCES  = tests/aurora/ncsfile.cpp
+tests_aurora_test_ncsfile_LDADD    = $(aurora_LIBS)
+tests_aurora_test_ncsfile_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                            += tests/aurora/test_actionscheduler
+tests_aurora_test_actionscheduler_SOURCES  = tests/aurora/actionscheduler.cpp
+tests_aurora_test_actionscheduler_LDADD    = $(aurora_LIBS)
+tests_aurora_test_actionscheduler_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                       += tests/aurora/test_objectgrid
+tests_aurora_test_objectgrid_SOURCES  = tests/aurora/objectgrid.cpp
+tests_aurora_test_objectgrid_LDADD    = $(aurora_LIBS)
+tests_aurora_test_objectgrid_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                            += tests/aurora/test_objectcontainer
+tests_aurora_test_objectcontainer_SOURCES  = tests/aurora/objectcontainer.cpp
+tests_aurora_test_objectcontainer_LDADD    = $(aurora_LIBS)
+tests_aurora_test_objectcontainer_CXXFLAGS = $(test_CXXFLAGS)
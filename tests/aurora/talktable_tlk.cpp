@@ -107,6 +107,40 @@ GTEST_TEST(TalkTable_TLK30, getSoundID) {
 	EXPECT_EQ(tlk.getSoundID(5000), Aurora::kFieldIDInvalid);
 }
 
+GTEST_TEST(TalkTable_TLK30, preDecode) {
+	Common::MemoryReadStream *stream = new Common::MemoryReadStream(kTLKV30);
+	Aurora::TalkTable_TLK tlk(stream, Common::kEncodingUTF8);
+
+	EXPECT_FALSE(tlk.isPreDecoded());
+
+	// Mix in a string that was already decoded lazily
+	EXPECT_STREQ(tlk.getString(2).c_str(), "Barfoo");
+
+	tlk.preDecode();
+	EXPECT_TRUE(tlk.isPreDecoded());
+
+	EXPECT_STREQ(tlk.getString(0).c_str(), "Foobar");
+	EXPECT_STREQ(tlk.getString(1).c_str(), "");
+	EXPECT_STREQ(tlk.getString(2).c_str(), "Barfoo");
+
+	EXPECT_STREQ(tlk.getString(3).c_str(), "");
+	EXPECT_STREQ(tlk.getString(5000).c_str(), "");
+}
+
+GTEST_TEST(TalkTable_TLK30, preDecodeBackground) {
+	Common::MemoryReadStream *stream = new Common::MemoryReadStream(kTLKV30);
+	Aurora::TalkTable_TLK tlk(stream, Common::kEncodingUTF8);
+
+	tlk.preDecode(true);
+
+	// Lookups still work while the strings are being decoded
+	EXPECT_STREQ(tlk.getString(0).c_str(), "Foobar");
+	EXPECT_STREQ(tlk.getString(1).c_str(), "");
+	EXPECT_STREQ(tlk.getString(2).c_str(), "Barfoo");
+
+	EXPECT_STREQ(tlk.getSoundResRef(1).c_str(), "quux_snd");
+}
+
 GTEST_TEST(TalkTable_TLK30, fromGeneric) {
 	Common::MemoryReadStream *stream = new Common::MemoryReadStream(kTLKV30);
 
@@ -186,6 +220,20 @@ GTEST_TEST(TalkTable_TLK40, getSoundID) {
 	EXPECT_EQ(tlk.getSoundID(5000), Aurora::kFieldIDInvalid);
 }
 
+GTEST_TEST(TalkTable_TLK40, preDecode) {
+	Common::MemoryReadStream *stream = new Common::MemoryReadStream(kTLKV40);
+	Aurora::TalkTable_TLK tlk(stream, Common::kEncodingUTF8);
+
+	tlk.preDecode();
+	EXPECT_TRUE(tlk.isPreDecoded());
+
+	EXPECT_STREQ(tlk.getString(0).c_str(), "Foobar");
+	EXPECT_STREQ(tlk.getString(1).c_str(), "");
+	EXPECT_STREQ(tlk.getString(2).c_str(), "Barfoo");
+
+	EXPECT_STREQ(tlk.getString(3).c_str(), "");
+}
+
 GTEST_TEST(TalkTable_TLK40, fromGeneric) {
 	Common::MemoryReadStream *stream = new Common::MemoryReadStream(kTLKV40);
 
@@ -0,0 +1,315 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Micro-benchmark of our 2DA and GDA table readers.
+ */
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/ustring.h"
+#include "src/common/strutil.h"
+#include "src/common/hash.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+
+#include "src/aurora/2dafile.h"
+#include "src/aurora/gdafile.h"
+#include "src/aurora/gff4file.h"
+#include "src/aurora/gff4fields.h"
+
+#include "tests/benchmark/benchmark.h"
+#include "tests/benchmark/heap.h"
+#include "tests/benchmark/gff4builder.h"
+
+/** Number of rows in the tables, like a big rules table (feat.2da, spells.2da, ...). */
+static const size_t kRows    = 1200;
+/** Number of columns in the tables. */
+static const size_t kColumns =   40;
+
+/** Number of files loaded, per benchmark scale. */
+static const size_t kLoads   = 2;
+/** Number of passes over all rows, per benchmark scale. */
+static const size_t kPasses  = 20;
+
+static Common::UString getHeader(size_t column) {
+	if (column == 0)
+		return "ID";
+
+	return "Column" + Common::composeString((uint64) column);
+}
+
+/** The cell contents, in a mix of strings, ints, floats and empty cells. */
+static Common::UString getCell(size_t row, size_t column) {
+	if (column == 0)
+		return Common::composeString((uint64) row);
+
+	switch (column % 4) {
+		case 0:
+			return "Name" + Common::composeString((uint64) (row % 500));
+
+		case 1:
+			return Common::composeString((uint64) ((row * column) % 100));
+
+		case 2:
+			return Common::UString::format("%u.%u", (uint) (row % 10), (uint) (column % 10));
+
+		default:
+			break;
+	}
+
+	return ((row + column) % 3) ? Common::composeString((uint64) (row % 7)) : "****";
+}
+
+static void create2DAASCII(std::vector<byte> &file) {
+	Common::UString twoda = "2DA V2.0\n\n";
+
+	for (size_t i = 0; i < kColumns; i++)
+		twoda += " " + getHeader(i);
+	twoda += "\n";
+
+	for (size_t i = 0; i < kRows; i++) {
+		twoda += Common::composeString((uint64) i);
+
+		for (size_t j = 0; j < kColumns; j++)
+			twoda += " " + getCell(i, j);
+
+		twoda += "\n";
+	}
+
+	file.assign(twoda.c_str(), twoda.c_str() + twoda.size());
+}
+
+static void create2DABinary(const std::vector<byte> &ascii, std::vector<byte> &file) {
+	Common::MemoryReadStream stream(&ascii[0], ascii.size());
+	Aurora::TwoDAFile twoda(stream);
+
+	Common::MemoryWriteStreamDynamic binary(true);
+	twoda.writeBinary(binary);
+
+	file.assign(binary.getData(), binary.getData() + binary.size());
+}
+
+/** A GDA with the same cells, typed by column. */
+static void createGDA(std::vector<byte> &file) {
+	GFF4Builder gff;
+
+	const uint32 top    = gff.addTemplate(MKTAG('g', 't', 'o', 'p'));
+	const uint32 column = gff.addTemplate(MKTAG('c', 'o', 'l', 'm'));
+	const uint32 row    = gff.addTemplate(MKTAG('r', 'o', 'w', 's'));
+
+	static const uint16 kListOfStructs = GFF4Builder::kFlagList | GFF4Builder::kFlagStruct;
+
+	gff.addField(top, Aurora::kGFF4G2DAColumnList, column, kListOfStructs, 4);
+	gff.addField(top, Aurora::kGFF4G2DARowList   , row   , kListOfStructs, 4);
+
+	gff.addField(column, Aurora::kGFF4G2DAColumnHash, Aurora::GFF4Struct::kFieldTypeUint32, 0, 4);
+
+	std::vector<Aurora::GFF4Struct::FieldType> types;
+	for (size_t i = 0; i < kColumns; i++) {
+		Aurora::GFF4Struct::FieldType type = Aurora::GFF4Struct::kFieldTypeSint32;
+		if      ((i != 0) && ((i % 4) == 0))
+			type = Aurora::GFF4Struct::kFieldTypeString;
+		else if ((i % 4) == 2)
+			type = Aurora::GFF4Struct::kFieldTypeFloat32;
+
+		types.push_back(type);
+		gff.addField(row, Aurora::kGFF4G2DAColumn1 + i, type, 0, 4);
+	}
+
+	std::vector<byte> &data = gff.getData();
+
+	data.resize(gff.getSize(top));
+
+	GFF4Builder::patchUint32(data, 0, data.size());
+	GFF4Builder::writeUint32(data, kColumns);
+
+	for (size_t i = 0; i < kColumns; i++)
+		GFF4Builder::writeUint32(data, Common::hashStringCRC32(getHeader(i).toLower(), Common::kEncodingUTF16LE));
+
+	GFF4Builder::patchUint32(data, 4, data.size());
+	GFF4Builder::writeUint32(data, kRows);
+
+	const uint32 rowStart = data.size();
+	data.resize(rowStart + kRows * gff.getSize(row), 0);
+
+	for (size_t i = 0; i < kRows; i++) {
+		for (size_t j = 0; j < kColumns; j++) {
+			const uint32 offset = rowStart + i * gff.getSize(row) + j * 4;
+			const Common::UString cell = getCell(i, j);
+
+			uint32 value = 0;
+			if        (types[j] == Aurora::GFF4Struct::kFieldTypeString) {
+				value = gff.addString(cell);
+			} else if (types[j] == Aurora::GFF4Struct::kFieldTypeFloat32) {
+				float f = 0.0f;
+				Common::parseString(cell, f);
+
+				value = convertIEEEFloat(f);
+			} else if (cell != "****") {
+				uint32 i32 = 0;
+				Common::parseString(cell, i32);
+
+				value = i32;
+			}
+
+			GFF4Builder::patchUint32(data, offset, value);
+		}
+	}
+
+	gff.write(MKTAG('G', '2', 'D', 'A'), file);
+}
+
+static size_t load2DA(const std::vector<byte> &data) {
+	Common::MemoryReadStream stream(&data[0], data.size());
+	Aurora::TwoDAFile twoda(stream);
+
+	return twoda.getRowCount();
+}
+
+/** Read a few cells of each row by their column headers, like the rules code does. */
+static size_t read2DA(const Aurora::TwoDAFile &twoda) {
+	size_t count = 0;
+
+	for (size_t i = 0; i < twoda.getRowCount(); i++) {
+		const Aurora::TwoDARow &row = twoda.getRow(i);
+
+		count += row.getInt("ID") + row.getInt("Column1") + row.getInt("Column3");
+		count += (size_t) row.getFloat("Column2") + row.getString("Column4").size();
+	}
+
+	return count;
+}
+
+/** Read a few cells of each row by their column names. */
+static size_t readGDA(const Aurora::GDAFile &gda) {
+	size_t count = 0;
+
+	for (size_t i = 0; i < gda.getRowCount(); i++) {
+		count += gda.getInt(i, "ID") + gda.getInt(i, "Column1") + gda.getInt(i, "Column3");
+		count += (size_t) gda.getFloat(i, "Column2") + gda.getString(i, "Column4").size();
+	}
+
+	return count;
+}
+
+/** Look up rows by their ID, like the Dragon Age engines do. */
+static size_t findGDARows(const Aurora::GDAFile &gda) {
+	size_t count = 0;
+
+	for (size_t i = 0; i < kRows; i += 10)
+		count += gda.findRow(i);
+
+	return count;
+}
+
+static void benchmarkLoad(const char *name, const std::vector<byte> &data) {
+	const size_t count = getBenchmarkScale() * kLoads;
+
+	double start = getBenchmarkTime();
+
+	size_t rows = 0;
+	for (size_t i = 0; i < count; i++)
+		rows += load2DA(data);
+
+	printBenchmark(name, "files", (double) count, getBenchmarkTime() - start);
+
+	EXPECT_EQ(rows, count * kRows);
+}
+
+template<typename T>
+static void benchmarkRead(const char *name, const char *items, size_t itemsPerPass,
+                          const T &table, size_t (*reader)(const T &)) {
+
+	const size_t count = getBenchmarkScale() * kPasses;
+
+	const size_t expected = reader(table);
+
+	double start = getBenchmarkTime();
+
+	size_t matched = 0;
+	for (size_t i = 0; i < count; i++)
+		if (reader(table) == expected)
+			matched++;
+
+	printBenchmark(name, items, (double) (count * itemsPerPass), getBenchmarkTime() - start);
+
+	EXPECT_EQ(matched, count);
+}
+
+static void benchmark2DAMemory(const char *name, const std::vector<byte> &data) {
+	const size_t before = getHeapAllocated();
+
+	Common::MemoryReadStream stream(&data[0], data.size());
+	Aurora::TwoDAFile twoda(stream);
+
+	printBenchmarkMemory(name, getHeapAllocated() - before);
+}
+
+/** The memory of a GDA, including everything cached by reading a few columns. */
+static void benchmarkGDAMemory(const char *name, const std::vector<byte> &data) {
+	const size_t before = getHeapAllocated();
+
+	Aurora::GDAFile gda(new Common::MemoryReadStream(&data[0], data.size()));
+	readGDA(gda);
+	findGDARows(gda);
+
+	printBenchmarkMemory(name, getHeapAllocated() - before);
+}
+
+GTEST_TEST(TwoDABenchmark, ASCII) {
+	std::vector<byte> data;
+	create2DAASCII(data);
+
+	benchmarkLoad("2DA ASCII, load", data);
+
+	Common::MemoryReadStream stream(&data[0], data.size());
+	Aurora::TwoDAFile twoda(stream);
+
+	benchmarkRead("2DA, read cells by header", "cells", kRows * 5, twoda, &read2DA);
+
+	benchmark2DAMemory("2DA ASCII, memory", data);
+}
+
+GTEST_TEST(TwoDABenchmark, binary) {
+	std::vector<byte> ascii, data;
+	create2DAASCII(ascii);
+	create2DABinary(ascii, data);
+
+	benchmarkLoad("2DA binary, load", data);
+}
+
+GTEST_TEST(TwoDABenchmark, GDA) {
+	std::vector<byte> data;
+	createGDA(data);
+
+	Aurora::GDAFile gda(new Common::MemoryReadStream(&data[0], data.size()));
+
+	EXPECT_EQ(gda.getInt(23, "Column1"), 23);
+	EXPECT_EQ(gda.findRow(42), 42);
+
+	benchmarkRead("GDA, read cells by name", "cells", kRows * 5, gda, &readGDA);
+	benchmarkRead("GDA, find rows by ID", "rows", kRows / 10, gda, &findGDARows);
+
+	benchmarkGDAMemory("GDA, memory", data);
+}
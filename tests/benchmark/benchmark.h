@@ -0,0 +1,64 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Utility functions for our micro-benchmarks.
+ */
+
+#ifndef TESTS_BENCHMARK_BENCHMARK_H
+#define TESTS_BENCHMARK_BENCHMARK_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+#include "src/common/types.h"
+
+/** Return the factor by which to scale the workload of a benchmark.
+ *
+ *  The benchmarks are run together with the unit tests, with a tiny
+ *  workload, just to make sure they still work. For meaningful numbers,
+ *  set the environment variable XOREOS_BENCHMARK_SCALE to something like
+ *  100 and run the benchmark program directly.
+ */
+static inline size_t getBenchmarkScale() {
+	const char *scale = std::getenv("XOREOS_BENCHMARK_SCALE");
+	if (!scale)
+		return 1;
+
+	const long value = std::strtol(scale, 0, 10);
+
+	return (value > 0) ? ((size_t) value) : 1;
+}
+
+/** Return the processor time used so far, in seconds. */
+static inline double getBenchmarkTime() {
+	return ((double) std::clock()) / CLOCKS_PER_SEC;
+}
+
+/** Print the result of a benchmark, as the number of items processed per second. */
+static inline void printBenchmark(const char *name, const char *items, double count, double seconds) {
+	if (seconds <= 0.0)
+		std::printf("[ BENCHMARK] %-32s %12.0f %s in less than a clock tick\n", name, count, items);
+	else
+		std::printf("[ BENCHMARK] %-32s %12.0f %s/s\n", name, count / seconds, items);
+}
+
+#endif // TESTS_BENCHMARK_BENCHMARK_H
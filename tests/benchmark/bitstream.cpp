@@ -0,0 +1,105 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Micro-benchmark of our bit streams.
+ */
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/ustring.h"
+#include "src/common/memreadstream.h"
+#include "src/common/bitstream.h"
+
+#include "tests/benchmark/benchmark.h"
+
+/** Size of the data to read per benchmark scale. */
+static const size_t kDataSize = 256 * 1024;
+
+/** Read the whole bit stream in a repeating pattern of value widths, the way a codec would. */
+template<class BitStreamType>
+static uint32 readValues(BitStreamType &bits, size_t &count) {
+	static const size_t kWidths[] = { 1, 4, 1, 1, 7, 2, 1, 13, 3, 1, 5, 24 };
+
+	uint32 sum = 0;
+	for (size_t i = 0; (bits.size() - bits.pos()) >= 32; i++, count++)
+		sum += bits.getBits(kWidths[i % ARRAYSIZE(kWidths)]) + bits.getBit();
+
+	return sum;
+}
+
+template<class BitStreamType, class MemoryBitStreamType>
+static void benchmarkBitStream(const char *name) {
+	const size_t repeat = getBenchmarkScale();
+
+	std::vector<byte> data(kDataSize);
+	for (size_t i = 0; i < data.size(); i++)
+		data[i] = (byte) (i * 0x9D + (i >> 8));
+
+	Common::MemoryReadStream stream(&data[0], data.size());
+
+	// Codecs used to get the bit stream through the virtual interface
+	BitStreamType bitStream(stream);
+	Common::BitStream &bits = bitStream;
+
+	MemoryBitStreamType memBits(&data[0], data.size());
+
+	size_t oldCount = 0, newCount = 0;
+	uint32 oldSum   = 0, newSum   = 0;
+
+	double start = getBenchmarkTime();
+
+	for (size_t r = 0; r < repeat; r++) {
+		bits.rewind();
+		oldSum += readValues(bits, oldCount);
+	}
+
+	const double oldTime = getBenchmarkTime() - start;
+
+	start = getBenchmarkTime();
+
+	for (size_t r = 0; r < repeat; r++) {
+		memBits.rewind();
+		newSum += readValues(memBits, newCount);
+	}
+
+	const double newTime = getBenchmarkTime() - start;
+
+	EXPECT_EQ(newCount, oldCount);
+	EXPECT_EQ(newSum, oldSum);
+
+	printBenchmark((Common::UString(name) + ", virtual").c_str(), "reads", oldCount, oldTime);
+	printBenchmark((Common::UString(name) + ", memory").c_str(), "reads", newCount, newTime);
+}
+
+GTEST_TEST(BitStreamBenchmark, bitStream8MSB) {
+	benchmarkBitStream<Common::BitStream8MSB, Common::MemoryBitStream8MSB>("8-bit, MSB first");
+}
+
+GTEST_TEST(BitStreamBenchmark, bitStream32LELSB) {
+	benchmarkBitStream<Common::BitStream32LELSB, Common::MemoryBitStream32LELSB>("32-bit LE, LSB first");
+}
+
+GTEST_TEST(BitStreamBenchmark, bitStream32LEMSB) {
+	benchmarkBitStream<Common::BitStream32LEMSB, Common::MemoryBitStream32LEMSB>("32-bit LE, MSB first");
+}
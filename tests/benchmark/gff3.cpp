@@ -0,0 +1,437 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Micro-benchmark of our GFF3 file reader.
+ */
+
+#include <cstring>
+
+#include <vector>
+#include <map>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/ustring.h"
+#include "src/common/strutil.h"
+#include "src/common/memreadstream.h"
+
+#include "src/aurora/gff3file.h"
+
+#include "tests/benchmark/benchmark.h"
+
+/** Number of object instances in the GIT, like in a big area. */
+static const size_t kGITInstances  = 2000;
+/** Number of feats in the UTC, like a high-level creature. */
+static const size_t kUTCFeats      =  300;
+/** Number of entries and replies in the DLG, like in a long conversation. */
+static const size_t kDLGEntries    = 1500;
+
+/** Number of files loaded, per benchmark scale. */
+static const size_t kLoads = 4;
+
+/** Writes a synthetic GFF3 file into memory. */
+class GFF3Builder {
+public:
+	GFF3Builder() {
+	}
+
+	uint32 addStruct(uint32 id) {
+		_structs.push_back(Struct());
+		_structs.back().id = id;
+
+		return _structs.size() - 1;
+	}
+
+	void addUint(uint32 strct, const Common::UString &label, uint32 value) {
+		addField(strct, Aurora::GFF3Struct::kFieldTypeUint32, label, value);
+	}
+
+	void addFloat(uint32 strct, const Common::UString &label, float value) {
+		uint32 data;
+		std::memcpy(&data, &value, 4);
+
+		addField(strct, Aurora::GFF3Struct::kFieldTypeFloat, label, data);
+	}
+
+	void addString(uint32 strct, const Common::UString &label, const Common::UString &value) {
+		const uint32 offset = _fieldData.size();
+
+		writeUint32(_fieldData, value.size());
+		_fieldData.insert(_fieldData.end(), value.c_str(), value.c_str() + value.size());
+
+		addField(strct, Aurora::GFF3Struct::kFieldTypeExoString, label, offset);
+	}
+
+	void addList(uint32 strct, const Common::UString &label, const std::vector<uint32> &structs) {
+		const uint32 offset = _listIndices.size() * 4;
+
+		_listIndices.push_back(structs.size());
+		_listIndices.insert(_listIndices.end(), structs.begin(), structs.end());
+
+		addField(strct, Aurora::GFF3Struct::kFieldTypeList, label, offset);
+	}
+
+	void write(uint32 type, std::vector<byte> &data) const {
+		std::vector<uint32> fieldIndices;
+
+		data.clear();
+		writeTag(data, type);
+		writeTag(data, MKTAG('V', '3', '.', '2'));
+
+		const uint32 structOffset       = 56;
+		const uint32 fieldOffset        = structOffset + _structs.size() * 12;
+		const uint32 labelOffset        = fieldOffset  + _fields.size()  * 12;
+		const uint32 fieldDataOffset    = labelOffset  + _labels.size()  * 16;
+		const uint32 fieldIndicesOffset = fieldDataOffset + _fieldData.size();
+
+		for (std::vector<Struct>::const_iterator s = _structs.begin(); s != _structs.end(); ++s)
+			if (s->fields.size() > 1)
+				fieldIndices.insert(fieldIndices.end(), s->fields.begin(), s->fields.end());
+
+		const uint32 listIndicesOffset  = fieldIndicesOffset + fieldIndices.size() * 4;
+
+		writeUint32(data, structOffset);
+		writeUint32(data, _structs.size());
+		writeUint32(data, fieldOffset);
+		writeUint32(data, _fields.size());
+		writeUint32(data, labelOffset);
+		writeUint32(data, _labels.size());
+		writeUint32(data, fieldDataOffset);
+		writeUint32(data, _fieldData.size());
+		writeUint32(data, fieldIndicesOffset);
+		writeUint32(data, fieldIndices.size() * 4);
+		writeUint32(data, listIndicesOffset);
+		writeUint32(data, _listIndices.size() * 4);
+
+		uint32 fieldIndex = 0;
+		for (std::vector<Struct>::const_iterator s = _structs.begin(); s != _structs.end(); ++s) {
+			writeUint32(data, s->id);
+
+			if (s->fields.size() == 1) {
+				writeUint32(data, s->fields[0]);
+			} else {
+				writeUint32(data, fieldIndex * 4);
+				fieldIndex += s->fields.size();
+			}
+
+			writeUint32(data, s->fields.size());
+		}
+
+		for (std::vector<Field>::const_iterator f = _fields.begin(); f != _fields.end(); ++f) {
+			writeUint32(data, f->type);
+			writeUint32(data, f->label);
+			writeUint32(data, f->data);
+		}
+
+		for (std::vector<Common::UString>::const_iterator l = _labels.begin(); l != _labels.end(); ++l) {
+			data.insert(data.end(), l->c_str(), l->c_str() + l->size());
+			data.insert(data.end(), 16 - l->size(), 0);
+		}
+
+		data.insert(data.end(), _fieldData.begin(), _fieldData.end());
+
+		for (std::vector<uint32>::const_iterator i = fieldIndices.begin(); i != fieldIndices.end(); ++i)
+			writeUint32(data, *i);
+		for (std::vector<uint32>::const_iterator i = _listIndices.begin(); i != _listIndices.end(); ++i)
+			writeUint32(data, *i);
+	}
+
+private:
+	struct Struct {
+		uint32 id;
+		std::vector<uint32> fields;
+	};
+
+	struct Field {
+		uint32 type;
+		uint32 label;
+		uint32 data;
+	};
+
+	typedef std::map<Common::UString, uint32> LabelMap;
+
+	std::vector<Struct> _structs;
+	std::vector<Field>  _fields;
+
+	std::vector<Common::UString> _labels;
+	LabelMap _labelMap;
+
+	std::vector<byte>   _fieldData;
+	std::vector<uint32> _listIndices;
+
+	void addField(uint32 strct, uint32 type, const Common::UString &label, uint32 data) {
+		LabelMap::const_iterator l = _labelMap.find(label);
+		if (l == _labelMap.end()) {
+			l = _labelMap.insert(std::make_pair(label, (uint32) _labels.size())).first;
+			_labels.push_back(label);
+		}
+
+		Field field;
+		field.type  = type;
+		field.label = l->second;
+		field.data  = data;
+
+		_structs[strct].fields.push_back(_fields.size());
+		_fields.push_back(field);
+	}
+
+	static void writeTag(std::vector<byte> &data, uint32 tag) {
+		data.push_back((tag >> 24) & 0xFF);
+		data.push_back((tag >> 16) & 0xFF);
+		data.push_back((tag >>  8) & 0xFF);
+		data.push_back( tag        & 0xFF);
+	}
+
+	static void writeUint32(std::vector<byte> &data, uint32 value) {
+		data.push_back( value        & 0xFF);
+		data.push_back((value >>  8) & 0xFF);
+		data.push_back((value >> 16) & 0xFF);
+		data.push_back((value >> 24) & 0xFF);
+	}
+};
+
+/** An area instance file, with lists of placed creatures, doors and placeables. */
+static void createGIT(std::vector<byte> &data) {
+	static const char * const kLists[] = { "Creature List", "Door List", "Placeable List", "WaypointList" };
+
+	GFF3Builder gff;
+
+	const uint32 top = gff.addStruct(0xFFFFFFFF);
+
+	for (size_t l = 0; l < ARRAYSIZE(kLists); l++) {
+		std::vector<uint32> instances;
+
+		for (size_t i = 0; i < (kGITInstances / ARRAYSIZE(kLists)); i++) {
+			const uint32 instance = gff.addStruct(l + 4);
+			instances.push_back(instance);
+
+			gff.addString(instance, "TemplateResRef", "template_" + Common::composeString(i));
+			gff.addString(instance, "Tag"           , "tag_"      + Common::composeString(i));
+			gff.addFloat (instance, "XPosition"     , i * 1.5f);
+			gff.addFloat (instance, "YPosition"     , i * 2.5f);
+			gff.addFloat (instance, "ZPosition"     , 0.0f);
+			gff.addFloat (instance, "XOrientation"  , 0.0f);
+			gff.addFloat (instance, "YOrientation"  , 1.0f);
+			gff.addFloat (instance, "ZOrientation"  , 0.0f);
+			gff.addUint  (instance, "Appearance"    , i % 200);
+			gff.addUint  (instance, "Faction"       , i % 5);
+			gff.addUint  (instance, "HP"            , 10 + i % 90);
+			gff.addUint  (instance, "CurrentHP"     , 10 + i % 90);
+			gff.addUint  (instance, "Plot"          , 0);
+			gff.addUint  (instance, "Static"        , i & 1);
+			gff.addString(instance, "OnUsed"        , "on_used");
+			gff.addString(instance, "OnDeath"       , "on_death");
+		}
+
+		gff.addList(top, kLists[l], instances);
+	}
+
+	gff.write(MKTAG('G', 'I', 'T', ' '), data);
+}
+
+/** A creature template, with a lot of top-level properties and a long feat list. */
+static void createUTC(std::vector<byte> &data) {
+	GFF3Builder gff;
+
+	const uint32 top = gff.addStruct(0xFFFFFFFF);
+
+	for (size_t i = 0; i < 100; i++)
+		gff.addUint(top, "Property" + Common::composeString(i), i);
+
+	gff.addString(top, "Tag", "creature");
+
+	std::vector<uint32> feats;
+	for (size_t i = 0; i < kUTCFeats; i++) {
+		feats.push_back(gff.addStruct(1));
+
+		gff.addUint(feats.back(), "Feat", i);
+	}
+
+	gff.addList(top, "FeatList", feats);
+
+	std::vector<uint32> items;
+	for (size_t i = 0; i < 20; i++) {
+		items.push_back(gff.addStruct(i));
+
+		gff.addString(items.back(), "InventoryRes", "item_" + Common::composeString(i));
+		gff.addUint  (items.back(), "Repos_PosX"  , i % 10);
+		gff.addUint  (items.back(), "Repos_PosY"  , i / 10);
+	}
+
+	gff.addList(top, "ItemList", items);
+
+	gff.write(MKTAG('U', 'T', 'C', ' '), data);
+}
+
+/** A conversation, with entries and replies that link to each other. */
+static void createDLG(std::vector<byte> &data) {
+	static const char * const kLists[][2] = {
+		{ "EntryList", "RepliesList" }, { "ReplyList", "EntriesList" }
+	};
+
+	GFF3Builder gff;
+
+	const uint32 top = gff.addStruct(0xFFFFFFFF);
+
+	gff.addUint(top, "DelayEntry", 0);
+	gff.addUint(top, "DelayReply", 0);
+
+	for (size_t l = 0; l < ARRAYSIZE(kLists); l++) {
+		std::vector<uint32> lines;
+
+		for (size_t i = 0; i < kDLGEntries; i++) {
+			std::vector<uint32> links;
+			for (size_t j = 0; j < 2; j++) {
+				links.push_back(gff.addStruct(j));
+
+				gff.addUint  (links.back(), "Index" , (i + j + 1) % kDLGEntries);
+				gff.addString(links.back(), "Active", "");
+			}
+
+			lines.push_back(gff.addStruct(i));
+
+			gff.addString(lines.back(), "Speaker"   , "");
+			gff.addString(lines.back(), "Text"      , "Line " + Common::composeString(i));
+			gff.addString(lines.back(), "Script"    , "");
+			gff.addString(lines.back(), "Sound"     , "");
+			gff.addUint  (lines.back(), "Animation" , 0);
+			gff.addUint  (lines.back(), "Delay"     , 0xFFFFFFFF);
+			gff.addString(lines.back(), "Quest"     , "");
+			gff.addList  (lines.back(), kLists[l][1], links);
+		}
+
+		gff.addList(top, kLists[l][0], lines);
+	}
+
+	gff.write(MKTAG('D', 'L', 'G', ' '), data);
+}
+
+/** Load the GIT and read the properties of every instance, like an area does. */
+static size_t readGIT(const std::vector<byte> &data) {
+	static const char * const kLists[] = { "Creature List", "Door List", "Placeable List", "WaypointList" };
+
+	Aurora::GFF3File gff(new Common::MemoryReadStream(&data[0], data.size()));
+
+	size_t count = 0;
+	for (size_t l = 0; l < ARRAYSIZE(kLists); l++) {
+		const Aurora::GFF3List &instances = gff.getTopLevel().getList(kLists[l]);
+
+		for (Aurora::GFF3List::const_iterator i = instances.begin(); i != instances.end(); ++i) {
+			float x = (*i)->getDouble("XPosition");
+			float y = (*i)->getDouble("YPosition");
+			float z = (*i)->getDouble("ZPosition");
+
+			if (!(*i)->getString("Tag").empty() && !(*i)->getString("TemplateResRef").empty())
+				count++;
+
+			count += (*i)->getUint("Appearance") + (*i)->getUint("Faction") + (*i)->getBool("Static");
+			count += (*i)->getUint("NotThere", 0) + (size_t) (x + y + z);
+		}
+	}
+
+	return count;
+}
+
+/** Load the UTC and read the properties, feats and inventory, like a creature does. */
+static size_t readUTC(const std::vector<byte> &data) {
+	Aurora::GFF3File gff(new Common::MemoryReadStream(&data[0], data.size()));
+
+	const Aurora::GFF3Struct &utc = gff.getTopLevel();
+
+	size_t count = utc.getString("Tag").size();
+	for (size_t i = 0; i < 100; i += 3)
+		count += utc.getUint("Property" + Common::composeString(i));
+
+	const Aurora::GFF3List &feats = utc.getList("FeatList");
+	for (Aurora::GFF3List::const_iterator f = feats.begin(); f != feats.end(); ++f)
+		count += (*f)->getUint("Feat");
+
+	const Aurora::GFF3List &items = utc.getList("ItemList");
+	for (Aurora::GFF3List::const_iterator i = items.begin(); i != items.end(); ++i)
+		count += (*i)->getString("InventoryRes").size() + (*i)->getUint("Repos_PosX");
+
+	return count;
+}
+
+/** Load the DLG and walk the links of every entry, like a conversation does. */
+static size_t readDLG(const std::vector<byte> &data) {
+	Aurora::GFF3File gff(new Common::MemoryReadStream(&data[0], data.size()));
+
+	const Aurora::GFF3List &entries = gff.getTopLevel().getList("EntryList");
+
+	size_t count = 0;
+	for (Aurora::GFF3List::const_iterator e = entries.begin(); e != entries.end(); ++e) {
+		count += (*e)->getString("Text").size() + (*e)->getUint("Delay");
+
+		const Aurora::GFF3List &replies = (*e)->getList("RepliesList");
+		for (Aurora::GFF3List::const_iterator r = replies.begin(); r != replies.end(); ++r)
+			count += (*r)->getUint("Index");
+	}
+
+	return count;
+}
+
+/** Load the GIT, but only look at the sizes of its lists. */
+static size_t peekGIT(const std::vector<byte> &data) {
+	Aurora::GFF3File gff(new Common::MemoryReadStream(&data[0], data.size()));
+
+	return gff.getTopLevel().getList("Creature List").size() + gff.getTopLevel().getList("Door List").size();
+}
+
+static void benchmarkGFF3(const char *name, const std::vector<byte> &data, size_t (*reader)(const std::vector<byte> &)) {
+	const size_t count = getBenchmarkScale() * kLoads;
+
+	const size_t expected = reader(data);
+
+	double start = getBenchmarkTime();
+
+	size_t matched = 0;
+	for (size_t i = 0; i < count; i++)
+		if (reader(data) == expected)
+			matched++;
+
+	printBenchmark(name, "files", (double) count, getBenchmarkTime() - start);
+
+	EXPECT_EQ(matched, count);
+}
+
+GTEST_TEST(GFF3Benchmark, GIT) {
+	std::vector<byte> data;
+	createGIT(data);
+
+	benchmarkGFF3("GFF3 GIT, all instances", data, &readGIT);
+	benchmarkGFF3("GFF3 GIT, list sizes only", data, &peekGIT);
+}
+
+GTEST_TEST(GFF3Benchmark, UTC) {
+	std::vector<byte> data;
+	createUTC(data);
+
+	benchmarkGFF3("GFF3 UTC", data, &readUTC);
+}
+
+GTEST_TEST(GFF3Benchmark, DLG) {
+	std::vector<byte> data;
+	createDLG(data);
+
+	benchmarkGFF3("GFF3 DLG", data, &readDLG);
+}
@@ -0,0 +1,235 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Micro-benchmark of our GFF4 file reader.
+ */
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/ustring.h"
+#include "src/common/strutil.h"
+#include "src/common/memreadstream.h"
+
+#include "src/aurora/gff4file.h"
+
+#include "tests/benchmark/benchmark.h"
+#include "tests/benchmark/heap.h"
+#include "tests/benchmark/gff4builder.h"
+
+/** Number of rows in the GDA, like a big 2DA table. */
+static const size_t kGDARows    = 2000;
+/** Number of columns in the GDA. */
+static const size_t kGDAColumns =   24;
+/** Number of strings in the talk table. */
+static const size_t kTLKStrings = 20000;
+
+/** Number of files loaded, per benchmark scale. */
+static const size_t kLoads = 4;
+
+static const uint32 kFieldColumns    = 10000;
+static const uint32 kFieldRows       = 10001;
+static const uint32 kFieldColumnHash = 10002;
+static const uint32 kFieldColumnType = 10003;
+static const uint32 kFieldStrRef     = 19001;
+static const uint32 kFieldString     = 19002;
+
+/** A GDA table: one struct per column and per row, all rows sharing the same template. */
+static void createGDA(std::vector<byte> &file) {
+	GFF4Builder gff;
+
+	const uint32 top    = gff.addTemplate(MKTAG('G', '2', 'D', 'A'));
+	const uint32 column = gff.addTemplate(MKTAG('G', 'C', 'O', 'L'));
+	const uint32 row    = gff.addTemplate(MKTAG('G', 'R', 'O', 'W'));
+
+	gff.addField(top, kFieldColumns, column, GFF4Builder::kFlagList | GFF4Builder::kFlagStruct, 4);
+	gff.addField(top, kFieldRows   , row   , GFF4Builder::kFlagList | GFF4Builder::kFlagStruct, 4);
+
+	gff.addField(column, kFieldColumnHash, Aurora::GFF4Struct::kFieldTypeUint32, 0, 4);
+	gff.addField(column, kFieldColumnType, Aurora::GFF4Struct::kFieldTypeUint8 , 0, 1);
+
+	static const Aurora::GFF4Struct::FieldType kTypes[] = {
+		Aurora::GFF4Struct::kFieldTypeUint32 , Aurora::GFF4Struct::kFieldTypeFloat32,
+		Aurora::GFF4Struct::kFieldTypeString , Aurora::GFF4Struct::kFieldTypeSint32 ,
+		Aurora::GFF4Struct::kFieldTypeUint8  , Aurora::GFF4Struct::kFieldTypeVector3f
+	};
+	static const uint32 kSizes[] = { 4, 4, 4, 4, 1, 12 };
+
+	for (size_t i = 0; i < kGDAColumns; i++)
+		gff.addField(row, i, kTypes[i % ARRAYSIZE(kTypes)], 0, kSizes[i % ARRAYSIZE(kTypes)]);
+
+	std::vector<byte> &data = gff.getData();
+
+	// Top-level struct, followed by the column list and the row list
+	data.resize(gff.getSize(top));
+
+	GFF4Builder::patchUint32(data, 0, data.size());
+	GFF4Builder::writeUint32(data, kGDAColumns);
+
+	const uint32 columnStart = data.size();
+	data.resize(columnStart + kGDAColumns * gff.getSize(column), 0);
+
+	for (size_t i = 0; i < kGDAColumns; i++) {
+		GFF4Builder::patchUint32(data, columnStart + i * gff.getSize(column), i);
+		data[columnStart + i * gff.getSize(column) + 4] = i % ARRAYSIZE(kTypes);
+	}
+
+	GFF4Builder::patchUint32(data, 4, data.size());
+	GFF4Builder::writeUint32(data, kGDARows);
+
+	const uint32 rowStart = data.size();
+	data.resize(rowStart + kGDARows * gff.getSize(row), 0);
+
+	for (size_t i = 0; i < kGDARows; i++) {
+		uint32 offset = rowStart + i * gff.getSize(row);
+
+		for (size_t j = 0; j < kGDAColumns; j++) {
+			const size_t type = j % ARRAYSIZE(kTypes);
+
+			if (kTypes[type] == Aurora::GFF4Struct::kFieldTypeString)
+				GFF4Builder::patchUint32(data, offset, gff.addString("row" + Common::composeString((uint64) i)));
+			else if (kTypes[type] == Aurora::GFF4Struct::kFieldTypeUint8)
+				data[offset] = i & 0xFF;
+			else
+				GFF4Builder::patchUint32(data, offset, i);
+
+			offset += kSizes[type];
+		}
+	}
+
+	gff.write(MKTAG('G', '2', 'D', 'A'), file);
+}
+
+/** A talk table: one struct per string, all sharing the same template. */
+static void createTLK(std::vector<byte> &file) {
+	GFF4Builder gff;
+
+	const uint32 top    = gff.addTemplate(MKTAG('T', 'L', 'K', ' '));
+	const uint32 string = gff.addTemplate(MKTAG('S', 'T', 'R', 'N'));
+
+	gff.addField(top, kFieldRows, string, GFF4Builder::kFlagList | GFF4Builder::kFlagStruct, 4);
+
+	gff.addField(string, kFieldStrRef, Aurora::GFF4Struct::kFieldTypeUint32, 0, 4);
+	gff.addField(string, kFieldString, Aurora::GFF4Struct::kFieldTypeString, 0, 4);
+
+	std::vector<byte> &data = gff.getData();
+
+	data.resize(gff.getSize(top));
+
+	GFF4Builder::patchUint32(data, 0, data.size());
+	GFF4Builder::writeUint32(data, kTLKStrings);
+
+	const uint32 stringStart = data.size();
+	data.resize(stringStart + kTLKStrings * gff.getSize(string), 0);
+
+	for (size_t i = 0; i < kTLKStrings; i++) {
+		const uint32 offset = stringStart + i * gff.getSize(string);
+
+		GFF4Builder::patchUint32(data, offset    , i);
+		GFF4Builder::patchUint32(data, offset + 4, gff.addString("String " + Common::composeString((uint64) i)));
+	}
+
+	gff.write(MKTAG('T', 'L', 'K', ' '), file);
+}
+
+/** Load the GDA, without looking at the data. */
+static size_t loadGDA(const std::vector<byte> &data) {
+	Aurora::GFF4File gff(new Common::MemoryReadStream(&data[0], data.size()));
+
+	return gff.getTopLevel().getList(kFieldRows).size();
+}
+
+/** Load the GDA and read a few cells from every row, like a game does. */
+static size_t readGDA(const std::vector<byte> &data) {
+	Aurora::GFF4File gff(new Common::MemoryReadStream(&data[0], data.size()));
+
+	const Aurora::GFF4List &rows = gff.getTopLevel().getList(kFieldRows);
+
+	size_t count = 0;
+	for (Aurora::GFF4List::const_iterator r = rows.begin(); r != rows.end(); ++r) {
+		float x = 0.0f, y = 0.0f, z = 0.0f;
+		(*r)->getVector3(5, x, y, z);
+
+		count += (*r)->getUint(0) + (*r)->getSint(3) + (size_t) (*r)->getFloat(1) + (size_t) x;
+		count += (*r)->getString(2).size();
+	}
+
+	return count;
+}
+
+/** Load the talk table and read all strings. */
+static size_t readTLK(const std::vector<byte> &data) {
+	Aurora::GFF4File gff(new Common::MemoryReadStream(&data[0], data.size()));
+
+	const Aurora::GFF4List &strings = gff.getTopLevel().getList(kFieldRows);
+
+	size_t count = 0;
+	for (Aurora::GFF4List::const_iterator s = strings.begin(); s != strings.end(); ++s)
+		count += (*s)->getUint(kFieldStrRef) + (*s)->getString(kFieldString).size();
+
+	return count;
+}
+
+static void benchmarkGFF4(const char *name, const std::vector<byte> &data, size_t (*reader)(const std::vector<byte> &)) {
+	const size_t count = getBenchmarkScale() * kLoads;
+
+	const size_t expected = reader(data);
+
+	double start = getBenchmarkTime();
+
+	size_t matched = 0;
+	for (size_t i = 0; i < count; i++)
+		if (reader(data) == expected)
+			matched++;
+
+	printBenchmark(name, "files", (double) count, getBenchmarkTime() - start);
+
+	EXPECT_EQ(matched, count);
+}
+
+static void benchmarkGFF4Memory(const char *name, const std::vector<byte> &data) {
+	const size_t before = getHeapAllocated();
+
+	Aurora::GFF4File gff(new Common::MemoryReadStream(&data[0], data.size()));
+
+	printBenchmarkMemory(name, getHeapAllocated() - before);
+}
+
+GTEST_TEST(GFF4Benchmark, GDA) {
+	std::vector<byte> data;
+	createGDA(data);
+
+	benchmarkGFF4("GFF4 GDA, load", data, &loadGDA);
+	benchmarkGFF4("GFF4 GDA, load and read", data, &readGDA);
+
+	benchmarkGFF4Memory("GFF4 GDA, memory", data);
+}
+
+GTEST_TEST(GFF4Benchmark, TLK) {
+	std::vector<byte> data;
+	createTLK(data);
+
+	benchmarkGFF4("GFF4 TLK, load and read", data, &readTLK);
+
+	benchmarkGFF4Memory("GFF4 TLK, memory", data);
+}
@@ -0,0 +1,172 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Writing synthetic GFF4 files for our micro-benchmarks.
+ */
+
+#ifndef TESTS_BENCHMARK_GFF4BUILDER_H
+#define TESTS_BENCHMARK_GFF4BUILDER_H
+
+#include <algorithm>
+#include <vector>
+
+#include "src/common/types.h"
+#include "src/common/util.h"
+#include "src/common/ustring.h"
+
+/** Writes a synthetic GFF4 file into memory. */
+class GFF4Builder {
+public:
+	static const uint16 kFlagList   = 0x8000;
+	static const uint16 kFlagStruct = 0x4000;
+
+	GFF4Builder() {
+	}
+
+	/** Add a struct template. Its fields need to be added in order. */
+	uint32 addTemplate(uint32 label) {
+		_templates.push_back(Template());
+		_templates.back().label = label;
+		_templates.back().size  = 0;
+
+		return _templates.size() - 1;
+	}
+
+	/** Add a field to a struct template, returning the offset of the field within the struct. */
+	uint32 addField(uint32 tmplt, uint32 label, uint16 type, uint16 flags, uint32 size) {
+		Field field;
+
+		field.label  = label;
+		field.type   = type;
+		field.flags  = flags;
+		field.offset = _templates[tmplt].size;
+
+		_templates[tmplt].fields.push_back(field);
+		_templates[tmplt].size += size;
+
+		return field.offset;
+	}
+
+	uint32 getSize(uint32 tmplt) const {
+		return _templates[tmplt].size;
+	}
+
+	/** The data section, starting with the top-level struct. */
+	std::vector<byte> &getData() {
+		return _data;
+	}
+
+	/** Append a UTF-16LE string to the data section, returning its offset. */
+	uint32 addString(const Common::UString &str) {
+		const uint32 offset = _data.size();
+
+		writeUint32(_data, str.size());
+		for (Common::UString::iterator c = str.begin(); c != str.end(); ++c) {
+			_data.push_back(*c & 0xFF);
+			_data.push_back(0);
+		}
+
+		return offset;
+	}
+
+	void write(uint32 type, std::vector<byte> &data) const {
+		data.clear();
+
+		writeTag(data, MKTAG('G', 'F', 'F', ' '));
+		writeTag(data, MKTAG('V', '4', '.', '0'));
+		writeTag(data, MKTAG('P', 'C', ' ', ' '));
+		writeTag(data, type);
+		writeTag(data, MKTAG('V', '0', '.', '1'));
+
+		uint32 fieldOffset = 28 + _templates.size() * 16;
+		uint32 dataOffset  = fieldOffset;
+		for (std::vector<Template>::const_iterator t = _templates.begin(); t != _templates.end(); ++t)
+			dataOffset += t->fields.size() * 12;
+
+		writeUint32(data, _templates.size());
+		writeUint32(data, dataOffset);
+
+		for (std::vector<Template>::const_iterator t = _templates.begin(); t != _templates.end(); ++t) {
+			writeTag   (data, t->label);
+			writeUint32(data, t->fields.size());
+			writeUint32(data, fieldOffset);
+			writeUint32(data, t->size);
+
+			fieldOffset += t->fields.size() * 12;
+		}
+
+		for (std::vector<Template>::const_iterator t = _templates.begin(); t != _templates.end(); ++t) {
+			for (std::vector<Field>::const_iterator f = t->fields.begin(); f != t->fields.end(); ++f) {
+				writeUint32(data, f->label);
+				writeUint16(data, f->type);
+				writeUint16(data, f->flags);
+				writeUint32(data, f->offset);
+			}
+		}
+
+		data.insert(data.end(), _data.begin(), _data.end());
+	}
+
+	static void writeUint16(std::vector<byte> &data, uint16 value) {
+		data.push_back( value       & 0xFF);
+		data.push_back((value >> 8) & 0xFF);
+	}
+
+	static void writeUint32(std::vector<byte> &data, uint32 value) {
+		writeUint16(data,  value        & 0xFFFF);
+		writeUint16(data, (value >> 16) & 0xFFFF);
+	}
+
+	/** Patch a 32-bit value into already written data. */
+	static void patchUint32(std::vector<byte> &data, uint32 offset, uint32 value) {
+		std::vector<byte> bytes;
+		writeUint32(bytes, value);
+
+		std::copy(bytes.begin(), bytes.end(), data.begin() + offset);
+	}
+
+	static void writeTag(std::vector<byte> &data, uint32 tag) {
+		data.push_back((tag >> 24) & 0xFF);
+		data.push_back((tag >> 16) & 0xFF);
+		data.push_back((tag >>  8) & 0xFF);
+		data.push_back( tag        & 0xFF);
+	}
+
+private:
+	struct Field {
+		uint32 label;
+		uint16 type;
+		uint16 flags;
+		uint32 offset;
+	};
+
+	struct Template {
+		uint32 label;
+		uint32 size;
+
+		std::vector<Field> fields;
+	};
+
+	std::vector<Template> _templates;
+	std::vector<byte> _data;
+};
+
+#endif // TESTS_BENCHMARK_GFF4BUILDER_H
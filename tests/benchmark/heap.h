@@ -0,0 +1,77 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Counting the bytes allocated on the heap, for our memory micro-benchmarks.
+ *
+ *  This replaces the global operator new and delete, so it may only be
+ *  included by one source file of each benchmark binary.
+ */
+
+#ifndef TESTS_BENCHMARK_HEAP_H
+#define TESTS_BENCHMARK_HEAP_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "src/common/types.h"
+#include "src/common/system.h"
+
+static size_t kHeapAllocated = 0;
+
+/** Keep the size in front of each block, aligned for any type. */
+static const size_t kHeapHeader = 16;
+
+void *operator new(size_t size) {
+	byte *block = static_cast<byte *>(std::malloc(size + kHeapHeader));
+	if (!block)
+		throw std::bad_alloc();
+
+	*reinterpret_cast<size_t *>(block) = size;
+	kHeapAllocated += size;
+
+	return block + kHeapHeader;
+}
+
+void operator delete(void *ptr) throw() {
+	if (!ptr)
+		return;
+
+	byte *block = static_cast<byte *>(ptr) - kHeapHeader;
+
+	kHeapAllocated -= *reinterpret_cast<size_t *>(block);
+	std::free(block);
+}
+
+void operator delete(void *ptr, size_t UNUSED(size)) throw() {
+	operator delete(ptr);
+}
+
+/** Return the number of bytes currently allocated on the heap. */
+static inline size_t getHeapAllocated() {
+	return kHeapAllocated;
+}
+
+static inline void printBenchmarkMemory(const char *name, size_t bytes) {
+	std::printf("[ BENCHMARK] %-32s %12u bytes on the heap\n", name, (uint) bytes);
+}
+
+#endif // TESTS_BENCHMARK_HEAP_H
@@ -0,0 +1,227 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Micro-benchmark of our Huffman decoder, against the old list-based decoder.
+ */
+
+#include <vector>
+#include <list>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/ustring.h"
+#include "src/common/error.h"
+#include "src/common/scopedptr.h"
+#include "src/common/memreadstream.h"
+#include "src/common/bitstream.h"
+#include "src/common/huffman.h"
+
+#include "src/video/binkdata.h"
+#include "src/sound/decoders/wmadata.h"
+
+#include "tests/benchmark/benchmark.h"
+
+/** The old Huffman decoder, walking through lists of codes bit by bit. */
+class ListHuffman {
+public:
+	ListHuffman(size_t codeCount, const uint32 *codes, const uint8 *lengths) {
+		uint8 maxLength = 0;
+		for (size_t i = 0; i < codeCount; i++)
+			maxLength = MAX(maxLength, lengths[i]);
+
+		_codes.resize(maxLength);
+
+		for (size_t i = 0; i < codeCount; i++)
+			_codes[lengths[i] - 1].push_back(Symbol(codes[i], i));
+	}
+
+	uint32 getSymbol(Common::BitStream &bits) const {
+		uint32 code = 0;
+
+		for (size_t i = 0; i < _codes.size(); i++) {
+			bits.addBit(code, i);
+
+			for (CodeList::const_iterator cCode = _codes[i].begin(); cCode != _codes[i].end(); ++cCode)
+				if (code == cCode->code)
+					return cCode->symbol;
+		}
+
+		throw Common::Exception("Unknown Huffman code");
+	}
+
+private:
+	struct Symbol {
+		uint32 code;
+		uint32 symbol;
+
+		Symbol(uint32 c, uint32 s) : code(c), symbol(s) {
+		}
+	};
+
+	typedef std::list<Symbol>     CodeList;
+	typedef std::vector<CodeList> CodeLists;
+
+	CodeLists _codes;
+};
+
+/** A set of Huffman codes to benchmark. */
+struct CodeTable {
+	const char *name;
+
+	size_t codeCount;
+	const uint32 *codes;
+	const uint8  *lengths;
+};
+
+/** Number of symbols to decode per table and benchmark scale. */
+static const size_t kSymbolCount = 50000;
+
+/** Encode random symbols, with a roughly realistic distribution, into a bitstream. */
+static std::vector<byte> encodeSymbols(const CodeTable &table, bool msbFirst, std::vector<uint32> &symbols) {
+	std::vector<byte> data;
+
+	// Simple deterministic LCG, so that every run decodes the same data
+	uint32 random = 0x12345678;
+
+	size_t bitCount = 0;
+	for (size_t i = 0; i < kSymbolCount; i++) {
+		random = random * 1664525 + 1013904223;
+
+		/* Shorter codes are more likely. Picking a random code and then throwing
+		 * out long ones a few times gets us close enough to a real stream. */
+		uint32 symbol = (random >> 8) % table.codeCount;
+		for (int j = 0; (j < 4) && (table.lengths[symbol] > 8); j++) {
+			random = random * 1664525 + 1013904223;
+			symbol = (random >> 8) % table.codeCount;
+		}
+
+		symbols.push_back(symbol);
+
+		const uint32 code   = table.codes[symbol];
+		const uint8  length = table.lengths[symbol];
+
+		for (uint8 j = 0; j < length; j++, bitCount++) {
+			if ((bitCount % 8) == 0)
+				data.push_back(0);
+
+			// MSB first: the code's MSB is the first bit. LSB first: the code's LSB is
+			const uint32 bit = msbFirst ? ((code >> (length - 1 - j)) & 1) : ((code >> j) & 1);
+			if (bit)
+				data.back() |= msbFirst ? (0x80 >> (bitCount % 8)) : (1 << (bitCount % 8));
+		}
+	}
+
+	// Pad to full 32-bit values
+	data.resize(((data.size() + 3) / 4) * 4 + 4, 0);
+
+	return data;
+}
+
+template<class BitStreamType, class HuffmanType>
+static double decodeSymbols(const HuffmanType &huffman, const std::vector<byte> &data,
+                            const std::vector<uint32> &symbols, size_t repeat, bool &correct) {
+
+	Common::MemoryReadStream stream(&data[0], data.size());
+	BitStreamType bits(stream);
+
+	correct = true;
+
+	const double start = getBenchmarkTime();
+
+	for (size_t r = 0; r < repeat; r++) {
+		bits.rewind();
+
+		for (size_t i = 0; i < symbols.size(); i++)
+			if (huffman.getSymbol(bits) != symbols[i])
+				correct = false;
+	}
+
+	return getBenchmarkTime() - start;
+}
+
+template<class BitStreamType, class MemoryBitStreamType>
+static void benchmarkTables(const char *name, const CodeTable *tables, size_t tableCount, bool msbFirst) {
+	const size_t repeat = getBenchmarkScale();
+
+	double oldTime = 0.0, newTime = 0.0, memTime = 0.0;
+	size_t count = 0;
+
+	for (size_t t = 0; t < tableCount; t++) {
+		std::vector<uint32> symbols;
+		const std::vector<byte> data = encodeSymbols(tables[t], msbFirst, symbols);
+
+		ListHuffman     oldHuffman(tables[t].codeCount, tables[t].codes, tables[t].lengths);
+		Common::Huffman newHuffman(0, tables[t].codeCount, tables[t].codes, tables[t].lengths);
+
+		bool oldCorrect = false, newCorrect = false, memCorrect = false;
+
+		oldTime += decodeSymbols<BitStreamType>(oldHuffman, data, symbols, repeat, oldCorrect);
+		newTime += decodeSymbols<BitStreamType>(newHuffman, data, symbols, repeat, newCorrect);
+		memTime += decodeSymbols<MemoryBitStreamType>(newHuffman, data, symbols, repeat, memCorrect);
+
+		EXPECT_TRUE(oldCorrect) << tables[t].name;
+		EXPECT_TRUE(newCorrect) << tables[t].name;
+		EXPECT_TRUE(memCorrect) << tables[t].name;
+
+		count += symbols.size() * repeat;
+	}
+
+	printBenchmark((Common::UString(name) + ", list-based").c_str(), "symbols", count, oldTime);
+	printBenchmark((Common::UString(name) + ", table-driven").c_str(), "symbols", count, newTime);
+	printBenchmark((Common::UString(name) + ", table-driven, memory").c_str(), "symbols", count, memTime);
+}
+
+GTEST_TEST(HuffmanBenchmark, bink) {
+	CodeTable tables[16];
+	for (size_t i = 0; i < ARRAYSIZE(tables); i++) {
+		tables[i].name      = "Bink";
+		tables[i].codeCount = 16;
+		tables[i].codes     = binkHuffmanCodes[i];
+		tables[i].lengths   = binkHuffmanLengths[i];
+	}
+
+	// Bink reads 32-bit little-endian values, LSB to MSB
+	benchmarkTables<Common::BitStream32LELSB, Common::MemoryBitStream32LELSB>("Bink", tables, ARRAYSIZE(tables), false);
+}
+
+GTEST_TEST(HuffmanBenchmark, wma) {
+	CodeTable tables[8];
+	for (size_t i = 0; i < 6; i++) {
+		tables[i].name      = "WMA coefficients";
+		tables[i].codeCount = Sound::coefHuffmanParam[i].n;
+		tables[i].codes     = Sound::coefHuffmanParam[i].huffCodes;
+		tables[i].lengths   = Sound::coefHuffmanParam[i].huffBits;
+	}
+
+	tables[6].name      = "WMA high gain";
+	tables[6].codeCount = ARRAYSIZE(Sound::hgainHuffCodes);
+	tables[6].codes     = Sound::hgainHuffCodes;
+	tables[6].lengths   = Sound::hgainHuffBits;
+
+	tables[7].name      = "WMA scale";
+	tables[7].codeCount = ARRAYSIZE(Sound::scaleHuffCodes);
+	tables[7].codes     = Sound::scaleHuffCodes;
+	tables[7].lengths   = Sound::scaleHuffBits;
+
+	// WMA reads bytes, MSB to LSB
+	benchmarkTables<Common::BitStream8MSB, Common::MemoryBitStream8MSB>("WMA", tables, ARRAYSIZE(tables), true);
+}
@@ -0,0 +1,95 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Micro-benchmark of our NWScript interpreters.
+ */
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/endianness.h"
+#include "src/common/ustring.h"
+#include "src/common/memreadstream.h"
+
+#include "src/aurora/nwscript/ncsfile.h"
+
+#include "tests/benchmark/benchmark.h"
+
+/** Number of loop iterations in the script, per benchmark scale. */
+static const uint32 kIterations = 20000;
+
+/** Number of instructions executed per loop iteration. */
+static const size_t kInstructionsPerIteration = 11;
+
+// Sum of 1 to kIterations, in a subroutine
+static const byte kNCSLoop[] = {
+	0x4E, 0x43, 0x53, 0x20, 0x56, 0x31, 0x2E, 0x30, 0x42, 0x00, 0x00, 0x00, 0x6B,
+	0x1E, 0x00, 0x00, 0x00, 0x00, 0x08,                         //  13: JSR 21
+	0x20, 0x00,                                                 //  19: RETN
+	0x04, 0x03, 0x00, 0x00, 0x00, 0x00,                         //  21: CONST 0
+	0x04, 0x03, 0x00, 0x00, 0x00, 0x01,                         //  27: CONST 1
+	0x03, 0x01, 0xFF, 0xFF, 0xFF, 0xFC, 0x00, 0x04,             //  33: CPTOPSP -4, 4
+	0x04, 0x03, 0x00, 0x00, 0x00, 0x00,                         //  41: CONST kIterations + 1
+	0x0F, 0x20,                                                 //  47: LT
+	0x1F, 0x00, 0x00, 0x00, 0x00, 0x32,                         //  49: JZ 99
+	0x03, 0x01, 0xFF, 0xFF, 0xFF, 0xF8, 0x00, 0x04,             //  55: CPTOPSP -8, 4
+	0x03, 0x01, 0xFF, 0xFF, 0xFF, 0xF8, 0x00, 0x04,             //  63: CPTOPSP -8, 4
+	0x14, 0x20,                                                 //  71: ADD
+	0x01, 0x01, 0xFF, 0xFF, 0xFF, 0xF4, 0x00, 0x04,             //  73: CPDOWNSP -12, 4
+	0x1B, 0x00, 0xFF, 0xFF, 0xFF, 0xFC,                         //  81: MOVSP -4
+	0x24, 0x03, 0xFF, 0xFF, 0xFF, 0xFC,                         //  87: INCSP -4
+	0x1D, 0x00, 0xFF, 0xFF, 0xFF, 0xC4,                         //  93: JMP 33
+	0x1B, 0x00, 0xFF, 0xFF, 0xFF, 0xFC,                         //  99: MOVSP -4
+	0x20, 0x00                                                  // 105: RETN
+};
+
+static void benchmarkInterpreter(Aurora::NWScript::NCSFile::Interpreter interpreter, const char *name,
+                                 int32 &result) {
+
+	const size_t repeat = getBenchmarkScale();
+
+	std::vector<byte> data(kNCSLoop, kNCSLoop + sizeof(kNCSLoop));
+	WRITE_BE_UINT32(&data[43], kIterations + 1);
+
+	Aurora::NWScript::NCSFile ncs(new Common::MemoryReadStream(&data[0], data.size()));
+	ncs.setInterpreter(interpreter);
+
+	const double start = getBenchmarkTime();
+
+	for (size_t r = 0; r < repeat; r++)
+		result = ncs.run().getInt();
+
+	const double time = getBenchmarkTime() - start;
+
+	printBenchmark(name, "instructions", (double) repeat * kIterations * kInstructionsPerIteration, time);
+}
+
+GTEST_TEST(NWScriptBenchmark, loop) {
+	int32 stepResult = 0, fastResult = 0;
+
+	benchmarkInterpreter(Aurora::NWScript::NCSFile::kInterpreterStep, "NWScript loop, step-wise", stepResult);
+	benchmarkInterpreter(Aurora::NWScript::NCSFile::kInterpreterFast, "NWScript loop, fast", fastResult);
+
+	EXPECT_EQ(stepResult, (int32) ((kIterations * (kIterations + 1)) / 2));
+	EXPECT_EQ(fastResult, stepResult);
+}
@@ -0,0 +1,150 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Micro-benchmark of our NWScript object container lookups.
+ */
+
+#include <map>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/ustring.h"
+#include "src/common/strutil.h"
+#include "src/common/scopedptr.h"
+
+#include "src/aurora/nwscript/object.h"
+#include "src/aurora/nwscript/objectcontainer.h"
+
+#include "tests/benchmark/benchmark.h"
+
+/** Number of objects in the container, like in a big module. */
+static const size_t kObjectCount = 12000;
+/** Number of different tags. Several objects share each tag. */
+static const size_t kTagCount    =  3000;
+
+/** Number of lookups, per benchmark scale. */
+static const size_t kLookups = 50000;
+
+class BenchmarkObject : public Aurora::NWScript::Object {
+public:
+	BenchmarkObject(uint32 id, const Common::UString &tag) {
+		_id  = id;
+		_tag = tag;
+	}
+};
+
+/** The lookups a GetObjectByTag-heavy script would do: a tag and which of the objects with that tag. */
+struct Lookup {
+	Common::UString tag;
+	size_t nth;
+};
+
+static void createLookups(std::vector<Lookup> &lookups) {
+	lookups.resize(kLookups);
+
+	uint32 random = 1;
+	for (size_t i = 0; i < kLookups; i++) {
+		random = random * 1103515245 + 12345;
+
+		lookups[i].tag = "npc_" + Common::composeString((random >> 8) % kTagCount);
+		lookups[i].nth = (random >> 4) & 3;
+	}
+}
+
+/** Return the nth object with this tag the way all engines used to: through a search context on the heap. */
+static Aurora::NWScript::Object *searchByTag(const Aurora::NWScript::ObjectContainer &container,
+                                             const Common::UString &tag, size_t nth) {
+
+	Common::ScopedPtr<Aurora::NWScript::ObjectSearch> search(container.findObjectsByTag(tag));
+	while (nth-- > 0)
+		search->next();
+
+	return search->get();
+}
+
+GTEST_TEST(ObjectContainerBenchmark, getObjectByTag) {
+	const size_t repeat = getBenchmarkScale();
+
+	std::vector<BenchmarkObject *> objects;
+	objects.reserve(kObjectCount);
+
+	Aurora::NWScript::ObjectContainer container;
+
+	// The tree of tags, like the container used to have, to compare against
+	typedef std::multimap<Common::UString, Aurora::NWScript::Object *> TagMap;
+	TagMap tagMap;
+
+	for (size_t i = 0; i < kObjectCount; i++) {
+		objects.push_back(new BenchmarkObject(i, "npc_" + Common::composeString(i % kTagCount)));
+
+		container.addObject(*objects.back());
+		tagMap.insert(std::make_pair(objects.back()->getTag(), objects.back()));
+	}
+
+	std::vector<Lookup> lookups;
+	createLookups(lookups);
+
+	size_t foundTree = 0, foundSearch = 0, foundDirect = 0;
+
+	double start = getBenchmarkTime();
+
+	for (size_t r = 0; r < repeat; r++) {
+		for (std::vector<Lookup>::const_iterator l = lookups.begin(); l != lookups.end(); ++l) {
+			std::pair<TagMap::const_iterator, TagMap::const_iterator> range = tagMap.equal_range(l->tag);
+
+			for (size_t n = 0; (n < l->nth) && (range.first != range.second); n++)
+				++range.first;
+
+			if (range.first != range.second)
+				foundTree++;
+		}
+	}
+
+	printBenchmark("GetObjectByTag, tag tree", "lookups", (double) repeat * kLookups, getBenchmarkTime() - start);
+
+	start = getBenchmarkTime();
+
+	for (size_t r = 0; r < repeat; r++)
+		for (std::vector<Lookup>::const_iterator l = lookups.begin(); l != lookups.end(); ++l)
+			if (searchByTag(container, l->tag, l->nth))
+				foundSearch++;
+
+	printBenchmark("GetObjectByTag, search context", "lookups", (double) repeat * kLookups, getBenchmarkTime() - start);
+
+	start = getBenchmarkTime();
+
+	for (size_t r = 0; r < repeat; r++)
+		for (std::vector<Lookup>::const_iterator l = lookups.begin(); l != lookups.end(); ++l)
+			if (container.getObjectByTag(l->tag, l->nth))
+				foundDirect++;
+
+	printBenchmark("GetObjectByTag, hash index", "lookups", (double) repeat * kLookups, getBenchmarkTime() - start);
+
+	EXPECT_EQ(foundSearch, foundTree);
+	EXPECT_EQ(foundDirect, foundTree);
+
+	container.clearObjects();
+
+	for (std::vector<BenchmarkObject *>::iterator o = objects.begin(); o != objects.end(); ++o)
+		delete *o;
+}
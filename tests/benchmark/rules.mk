@@ -0,0 +1,107 @@
+# xoreos - A reimplementation of BioWare's Aurora engine
+#
+# xoreos is the legal property of its developers, whose names
+# can be found in the AUTHORS file distributed with this source
+# distribution.
+#
+# xoreos is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 3
+# of the License, or (at your option) any later version.
+#
+# xoreos is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+
+# Micro-benchmarks.
+#
+# These are run together with the unit tests, with a tiny workload, to make
+# sure they still work. For meaningful numbers, run them directly with the
+# environment variable XOREOS_BENCHMARK_SCALE set to something like 100.
+
+benchmark_LIBS = \
+    $(test_LIBS) \
+    src/common/libcommon.la \
+    tests/version/libversion.la \
+    $(LDADD)
+
+benchmark_aurora_LIBS = \
+    $(test_LIBS) \
+    src/aurora/libaurora.la \
+    src/common/libcommon.la \
+    tests/version/libversion.la \
+    $(LDADD)
+
+benchmark_sound_LIBS = \
+    $(test_LIBS) \
+    src/sound/libsound.la \
+    src/common/libcommon.la \
+    tests/version/libversion.la \
+    $(LDADD)
+
+benchmark_images_LIBS = \
+    $(test_LIBS) \
+    src/graphics/libgraphics.la \
+    src/aurora/libaurora.la \
+    src/common/libcommon.la \
+    tests/version/libversion.la \
+    $(LDADD)
+
+check_PROGRAMS                        += tests/benchmark/bench_huffman
+tests_benchmark_bench_huffman_SOURCES  = tests/benchmark/huffman.cpp
+tests_benchmark_bench_huffman_LDADD    = $(benchmark_LIBS)
+tests_benchmark_bench_huffman_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                          += tests/benchmark/bench_bitstream
+tests_benchmark_bench_bitstream_SOURCES  = tests/benchmark/bitstream.cpp
+tests_benchmark_bench_bitstream_LDADD    = $(benchmark_LIBS)
+tests_benchmark_bench_bitstream_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                     += tests/benchmark/bench_s3tc
+tests_benchmark_bench_s3tc_SOURCES  = tests/benchmark/s3tc.cpp
+tests_benchmark_bench_s3tc_LDADD    = $(benchmark_images_LIBS)
+tests_benchmark_bench_s3tc_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                         += tests/benchmark/bench_skinning
+tests_benchmark_bench_skinning_SOURCES  = tests/benchmark/skinning.cpp
+tests_benchmark_bench_skinning_LDADD    = $(benchmark_images_LIBS)
+tests_benchmark_bench_skinning_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                         += tests/benchmark/bench_nwscript
+tests_benchmark_bench_nwscript_SOURCES  = tests/benchmark/nwscript.cpp
+tests_benchmark_bench_nwscript_LDADD    = $(benchmark_aurora_LIBS)
+tests_benchmark_bench_nwscript_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                                += tests/benchmark/bench_objectcontainer
+tests_benchmark_bench_objectcontainer_SOURCES  = tests/benchmark/objectcontainer.cpp
+tests_benchmark_bench_objectcontainer_LDADD    = $(benchmark_aurora_LIBS)
+tests_benchmark_bench_objectcontainer_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                     += tests/benchmark/bench_gff3
+tests_benchmark_bench_gff3_SOURCES  = tests/benchmark/gff3.cpp
+tests_benchmark_bench_gff3_LDADD    = $(benchmark_aurora_LIBS)
+tests_benchmark_bench_gff3_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                     += tests/benchmark/bench_gff4
+tests_benchmark_bench_gff4_SOURCES  = tests/benchmark/gff4.cpp
+tests_benchmark_bench_gff4_LDADD    = $(benchmark_aurora_LIBS)
+tests_benchmark_bench_gff4_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                    += tests/benchmark/bench_2da
+tests_benchmark_bench_2da_SOURCES  = tests/benchmark/2da.cpp
+tests_benchmark_bench_2da_LDADD    = $(benchmark_aurora_LIBS)
+tests_benchmark_bench_2da_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                    += tests/benchmark/bench_tlk
+tests_benchmark_bench_tlk_SOURCES  = tests/benchmark/tlk.cpp
+tests_benchmark_bench_tlk_LDADD    = $(benchmark_aurora_LIBS)
+tests_benchmark_bench_tlk_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                       += tests/benchmark/bench_sound
+tests_benchmark_bench_sound_SOURCES  = tests/benchmark/sound.cpp
+tests_benchmark_bench_sound_LDADD    = $(benchmark_sound_LIBS)
+tests_benchmark_bench_sound_CXXFLAGS = $(test_CXXFLAGS)
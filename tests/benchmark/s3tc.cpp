@@ -0,0 +1,265 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Micro-benchmark of our S3TC DXTn decompression, against the old stream-based decompression.
+ */
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/ustring.h"
+#include "src/common/scopedptr.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+
+#include "src/graphics/images/dds.h"
+#include "src/graphics/images/s3tc.h"
+
+#include "tests/benchmark/benchmark.h"
+
+/** The old decompression: reading through a stream, interpolating with doubles. */
+namespace OldS3TC {
+
+static inline uint32 convert565To8888(uint16 color) {
+	return ((color & 0x1F) << 11) | ((color & 0x7E0) << 13) | ((color & 0xF800) << 16) | 0xFF;
+}
+
+static inline uint32 interpolate32(double weight, uint32 color_0, uint32 color_1) {
+	byte r[3], g[3], b[3], a[3];
+	r[0] = color_0 >> 24;
+	r[1] = color_1 >> 24;
+	r[2] = (byte)((1.0f - weight) * (double)r[0] + weight * (double)r[1]);
+	g[0] = (color_0 >> 16) & 0xFF;
+	g[1] = (color_1 >> 16) & 0xFF;
+	g[2] = (byte)((1.0f - weight) * (double)g[0] + weight * (double)g[1]);
+	b[0] = (color_0 >> 8) & 0xFF;
+	b[1] = (color_1 >> 8) & 0xFF;
+	b[2] = (byte)((1.0f - weight) * (double)b[0] + weight * (double)b[1]);
+	a[0] = color_0 & 0xFF;
+	a[1] = color_1 & 0xFF;
+	a[2] = (byte)((1.0f - weight) * (double)a[0] + weight * (double)a[1]);
+	return r[2] << 24 | g[2] << 16 | b[2] << 8 | a[2];
+}
+
+static void decompressDXT1(byte *dest, Common::SeekableReadStream &src, uint32 width, uint32 height, uint32 pitch) {
+	for (int32 ty = height; ty > 0; ty -= 4) {
+		for (uint32 tx = 0; tx < width; tx += 4) {
+			const uint16 color_0 = src.readUint16LE();
+			const uint16 color_1 = src.readUint16LE();
+			uint32 cpx = src.readUint32BE();
+
+			uint32 blended[4];
+
+			blended[0] = convert565To8888(color_0);
+			blended[1] = convert565To8888(color_1);
+
+			if (color_0 > color_1) {
+				blended[2] = interpolate32(0.333333f, blended[0], blended[1]);
+				blended[3] = interpolate32(0.666666f, blended[0], blended[1]);
+			} else {
+				blended[2] = interpolate32(0.5f, blended[0], blended[1]);
+				blended[3] = 0;
+			}
+
+			uint32 blockWidth = MIN<uint32>(width, 4);
+			uint32 blockHeight = MIN<uint32>(height, 4);
+
+			for (byte y = 0; y < blockHeight; ++y) {
+				for (byte x = 0; x < blockWidth; ++x) {
+					const uint32 destX = tx + x;
+					const uint32 destY = height - 1 - (ty - blockHeight + y);
+
+					const uint32 pixel = blended[cpx & 3];
+
+					cpx >>= 2;
+
+					if ((destX < width) && (destY < height))
+						WRITE_BE_UINT32(dest + destY * pitch + destX * 4, pixel);
+				}
+			}
+		}
+	}
+}
+
+static void decompressDXT5(byte *dest, Common::SeekableReadStream &src, uint32 width, uint32 height, uint32 pitch) {
+	for (int32 ty = height; ty > 0; ty -= 4) {
+		for (uint32 tx = 0; tx < width; tx += 4) {
+			byte alphab[8];
+
+			alphab[0] = src.readByte();
+			alphab[1] = src.readByte();
+
+			uint64 alphabl = src.readUint32LE();
+			alphabl |= ((uint64) src.readUint16LE()) << 32;
+
+			const uint16 color_0 = src.readUint16LE();
+			const uint16 color_1 = src.readUint16LE();
+			uint32 cpx = src.readUint32BE();
+
+			if (alphab[0] > alphab[1]) {
+				alphab[2] = (byte)((6.0f * (double)alphab[0] + 1.0f * (double)alphab[1] + 3.0f) / 7.0f);
+				alphab[3] = (byte)((5.0f * (double)alphab[0] + 2.0f * (double)alphab[1] + 3.0f) / 7.0f);
+				alphab[4] = (byte)((4.0f * (double)alphab[0] + 3.0f * (double)alphab[1] + 3.0f) / 7.0f);
+				alphab[5] = (byte)((3.0f * (double)alphab[0] + 4.0f * (double)alphab[1] + 3.0f) / 7.0f);
+				alphab[6] = (byte)((2.0f * (double)alphab[0] + 5.0f * (double)alphab[1] + 3.0f) / 7.0f);
+				alphab[7] = (byte)((1.0f * (double)alphab[0] + 6.0f * (double)alphab[1] + 3.0f) / 7.0f);
+			} else {
+				alphab[2] = (byte)((4.0f * (double)alphab[0] + 1.0f * (double)alphab[1] + 2.0f) / 5.0f);
+				alphab[3] = (byte)((3.0f * (double)alphab[0] + 2.0f * (double)alphab[1] + 2.0f) / 5.0f);
+				alphab[4] = (byte)((2.0f * (double)alphab[0] + 3.0f * (double)alphab[1] + 2.0f) / 5.0f);
+				alphab[5] = (byte)((1.0f * (double)alphab[0] + 4.0f * (double)alphab[1] + 2.0f) / 5.0f);
+				alphab[6] = 0;
+				alphab[7] = 255;
+			}
+
+			uint32 blended[4];
+
+			blended[0] = convert565To8888(color_0) & 0xFFFFFF00;
+			blended[1] = convert565To8888(color_1) & 0xFFFFFF00;
+			blended[2] = interpolate32(0.333333f, blended[0], blended[1]);
+			blended[3] = interpolate32(0.666666f, blended[0], blended[1]);
+
+			uint32 blockWidth = MIN<uint32>(width, 4);
+			uint32 blockHeight = MIN<uint32>(height, 4);
+
+			for (byte y = 0; y < blockHeight; ++y) {
+				for (byte x = 0; x < blockWidth; ++x) {
+					const uint32 destX = tx + x;
+					const uint32 destY = height - 1 - (ty - blockHeight + y);
+
+					const uint32 alpha = alphab[(alphabl >> (3 * (4 * (3 - y) + x))) & 7];
+					const uint32 pixel = blended[cpx & 3] | alpha;
+
+					cpx >>= 2;
+
+					if ((destX < width) && (destY < height))
+						WRITE_BE_UINT32(dest + destY * pitch + destX * 4, pixel);
+				}
+			}
+		}
+	}
+}
+
+} // End of namespace OldS3TC
+
+/** Width and height of the benchmarked textures. */
+static const uint32 kTextureSize = 512;
+
+/** Create a DDS file with a full mip map chain of random DXTn blocks. */
+static Common::SeekableReadStream *createDDS(bool dxt5) {
+	Common::MemoryWriteStreamDynamic dds(false);
+
+	size_t mipMapCount = 0;
+	for (uint32 size = kTextureSize; size > 0; size >>= 1)
+		mipMapCount++;
+
+	dds.writeUint32BE(MKTAG('D', 'D', 'S', ' '));
+	dds.writeUint32LE(124);                     // Header size
+	dds.writeUint32LE(0x00021007);              // Flags: caps, height, width, pixel format, mip maps
+	dds.writeUint32LE(kTextureSize);            // Height
+	dds.writeUint32LE(kTextureSize);            // Width
+	dds.writeUint32LE(0);                       // Pitch
+	dds.writeUint32LE(0);                       // Depth
+	dds.writeUint32LE(mipMapCount);
+	for (size_t i = 0; i < 11; i++)
+		dds.writeUint32LE(0);                     // Reserved
+
+	dds.writeUint32LE(32);                      // Pixel format size
+	dds.writeUint32LE(0x00000004);              // Pixel format flags: FourCC
+	dds.writeUint32BE(dxt5 ? MKTAG('D', 'X', 'T', '5') : MKTAG('D', 'X', 'T', '1'));
+	for (size_t i = 0; i < 5; i++)
+		dds.writeUint32LE(0);                     // Bit count and masks
+
+	for (size_t i = 0; i < 5; i++)
+		dds.writeUint32LE(0);                     // Caps and reserved
+
+	// Simple deterministic LCG, so that every run decodes the same data
+	uint32 random = 0x12345678;
+
+	for (uint32 size = kTextureSize; size > 0; size >>= 1) {
+		const size_t blocks = ((size + 3) / 4) * ((size + 3) / 4);
+
+		for (size_t i = 0; i < blocks * (dxt5 ? 16 : 8); i++) {
+			random = random * 1664525 + 1013904223;
+			dds.writeByte(random >> 24);
+		}
+	}
+
+	const size_t size = dds.size();
+	return new Common::MemoryReadStream(dds.getData(), size, true);
+}
+
+static void benchmarkDDS(const char *name, bool dxt5) {
+	const size_t repeat = getBenchmarkScale();
+
+	Common::ScopedPtr<Common::SeekableReadStream> ddsFile(createDDS(dxt5));
+
+	double oldTime = 0.0, newTime = 0.0;
+	size_t pixels = 0;
+
+	for (size_t r = 0; r < repeat; r++) {
+		ddsFile->seek(0);
+		Graphics::DDS dds(*ddsFile);
+
+		ASSERT_TRUE(dds.isCompressed());
+
+		// The old decompression, mip map by mip map
+		for (size_t i = 0; i < dds.getMipMapCount(); i++) {
+			const Graphics::ImageDecoder::MipMap &mipMap = dds.getMipMap(i);
+
+			std::vector<byte> decompressed(mipMap.width * mipMap.height * 4);
+			Common::MemoryReadStream stream(mipMap.data.get(), mipMap.size);
+
+			const double start = getBenchmarkTime();
+
+			if (dxt5)
+				OldS3TC::decompressDXT5(&decompressed[0], stream, mipMap.width, mipMap.height, mipMap.width * 4);
+			else
+				OldS3TC::decompressDXT1(&decompressed[0], stream, mipMap.width, mipMap.height, mipMap.width * 4);
+
+			oldTime += getBenchmarkTime() - start;
+
+			pixels += mipMap.width * mipMap.height;
+		}
+
+		// The whole mip map chain, the way the texture code does it
+		const double start = getBenchmarkTime();
+
+		dds.decompress();
+
+		newTime += getBenchmarkTime() - start;
+
+		EXPECT_FALSE(dds.isCompressed());
+	}
+
+	printBenchmark((Common::UString(name) + ", stream-based").c_str(), "pixels", pixels, oldTime);
+	printBenchmark((Common::UString(name) + ", block-based").c_str(), "pixels", pixels, newTime);
+}
+
+GTEST_TEST(S3TCBenchmark, dxt1) {
+	benchmarkDDS("DDS DXT1", false);
+}
+
+GTEST_TEST(S3TCBenchmark, dxt5) {
+	benchmarkDDS("DDS DXT5", true);
+}
@@ -0,0 +1,203 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Micro-benchmark of our CPU skinning, against the old per-influence skinning.
+ */
+
+#include <cstring>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/matrix4x4.h"
+
+#include "src/graphics/skinning.h"
+
+#include "tests/benchmark/benchmark.h"
+
+/* A mesh shaped like the body of a KotOR creature: a couple thousand vertices,
+ * with up to 4 bones each, out of a model with several dozen nodes. */
+static const uint32 kVertexCount = 2048;
+static const uint32 kBoneCount   =   64;
+static const uint32 kStride      =    8; // Position, normal, texture coordinates
+
+/** The frames to skin, per benchmark scale. */
+static const size_t kFrameCount = 20;
+
+static uint32 kRandom = 0x12345678;
+
+static float getRandom(float min, float max) {
+	kRandom = kRandom * 1664525 + 1013904223;
+
+	return min + (max - min) * ((kRandom >> 8) / 16777216.0f);
+}
+
+static Common::Matrix4x4 getRandomTransform() {
+	Common::Matrix4x4 m;
+
+	m.translate(getRandom(-2.0f, 2.0f), getRandom(-2.0f, 2.0f), getRandom(-2.0f, 2.0f));
+	m.rotate(getRandom(-180.0f, 180.0f), getRandom(-1.0f, 1.0f), getRandom(-1.0f, 1.0f), getRandom(0.1f, 1.0f));
+
+	return m;
+}
+
+struct BenchmarkSkin {
+	Common::Matrix4x4 transform;
+
+	std::vector<float> invBindPoses;
+	std::vector<float> boneTransforms;
+
+	std::vector<float> boneIDs;
+	std::vector<float> boneWeights;
+
+	std::vector<float> positions;
+	std::vector<float> normals;
+
+	BenchmarkSkin() : invBindPoses(16 * kBoneCount), boneTransforms(16 * kBoneCount) {
+		transform = getRandomTransform();
+
+		for (uint32 i = 0; i < kBoneCount; i++) {
+			std::memcpy(&invBindPoses  [16 * i], getRandomTransform().getInverse().get(), 16 * sizeof(float));
+			std::memcpy(&boneTransforms[16 * i], getRandomTransform().get(), 16 * sizeof(float));
+		}
+
+		for (uint32 i = 0; i < kVertexCount; i++) {
+			const uint32 count = 1 + (i % 4);
+
+			for (uint32 j = 0; j < 4; j++) {
+				boneIDs.push_back((j < count) ? (int)getRandom(0.0f, kBoneCount - 1) : -1.0f);
+				boneWeights.push_back((j < count) ? (1.0f / count) : 0.0f);
+			}
+
+			for (uint32 j = 0; j < 3; j++)
+				positions.push_back(getRandom(-1.0f, 1.0f));
+
+			normals.push_back(0.0f);
+			normals.push_back(0.0f);
+			normals.push_back(1.0f);
+		}
+	}
+};
+
+/** The old skinning: through all four transformations for every influence of every vertex. */
+static void skinOld(const BenchmarkSkin &skin, float *v) {
+	Common::Matrix4x4 invTransform = skin.transform.getInverse();
+
+	const float *iv            = &skin.positions[0];
+	const float *boneWeights   = &skin.boneWeights[0];
+	const float *boneMappingId = &skin.boneIDs[0];
+
+	Common::Matrix4x4 invBindPose;
+	Common::Matrix4x4 boneTransform;
+
+	for (uint32 i = 0; i < kVertexCount; ++i) {
+		v[0] = 0;
+		v[1] = 0;
+		v[2] = 0;
+		for (uint8 j = 0; j < 4; ++j) {
+			int index = static_cast<int>(boneMappingId[j]);
+			if (index != -1) {
+				uint32 off = index * 16;
+				float rv[3];
+				float tv[3];
+
+				skin.transform.multiply(iv, rv);
+
+				invBindPose = &skin.invBindPoses[off];
+				invBindPose.multiply(rv, tv);
+
+				boneTransform = &skin.boneTransforms[off];
+				boneTransform.multiply(tv, rv);
+
+				invTransform.multiply(rv, tv);
+
+				v[0] += tv[0] * boneWeights[j];
+				v[1] += tv[1] * boneWeights[j];
+				v[2] += tv[2] * boneWeights[j];
+			}
+		}
+		v += kStride;
+		iv += 3;
+		boneWeights += 4;
+		boneMappingId += 4;
+	}
+}
+
+/** The new skinning: combine the bone palette once, then blend the bones per vertex. */
+static void skinNew(const BenchmarkSkin &skin, const Graphics::SkinInfluences &influences,
+                    std::vector<float> &palette, float *v, bool withNormals) {
+
+	const Common::Matrix4x4 invTransform = skin.transform.getInverse();
+
+	palette.resize(16 * kBoneCount);
+	for (uint32 i = 0; i < kBoneCount; i++) {
+		Common::Matrix4x4 bone(invTransform);
+		bone *= Common::Matrix4x4(&skin.boneTransforms[16 * i]);
+		bone *= Common::Matrix4x4(&skin.invBindPoses[16 * i]);
+		bone *= skin.transform;
+
+		std::memcpy(&palette[16 * i], bone.get(), 16 * sizeof(float));
+	}
+
+	Graphics::skinVertices(influences, &palette[0], &skin.positions[0],
+	                       withNormals ? &skin.normals[0] : 0, v, kStride);
+}
+
+GTEST_TEST(SkinningBenchmark, skin) {
+	const size_t frames = kFrameCount * getBenchmarkScale();
+
+	const BenchmarkSkin skin;
+
+	Graphics::SkinInfluences influences;
+	influences.set(&skin.boneIDs[0], &skin.boneWeights[0], kVertexCount, kBoneCount);
+
+	std::vector<float> oldVertices(kStride * kVertexCount, 0.0f);
+	std::vector<float> newVertices(kStride * kVertexCount, 0.0f);
+	std::vector<float> palette;
+
+	double start = getBenchmarkTime();
+	for (size_t i = 0; i < frames; i++)
+		skinOld(skin, &oldVertices[0]);
+	const double oldTime = getBenchmarkTime() - start;
+
+	start = getBenchmarkTime();
+	for (size_t i = 0; i < frames; i++)
+		skinNew(skin, influences, palette, &newVertices[0], false);
+	const double newTime = getBenchmarkTime() - start;
+
+	start = getBenchmarkTime();
+	for (size_t i = 0; i < frames; i++)
+		skinNew(skin, influences, palette, &newVertices[0], true);
+	const double normalsTime = getBenchmarkTime() - start;
+
+	// Make sure we actually benchmarked the same thing
+	for (uint32 i = 0; i < kVertexCount; i++)
+		for (uint32 j = 0; j < 3; j++)
+			ASSERT_NEAR(newVertices[kStride * i + j], oldVertices[kStride * i + j], 1e-3f) << "At vertex " << i;
+
+	const double vertices = (double) frames * kVertexCount;
+
+	printBenchmark("Skinning, per influence", "vertices", vertices, oldTime);
+	printBenchmark("Skinning, bone palette", "vertices", vertices, newTime);
+	printBenchmark("Skinning, palette with normals", "vertices", vertices, normalsTime);
+}
@@ -0,0 +1,368 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Micro-benchmark of our sound decoders and the sound manager pipeline.
+ *
+ *  The PCM and ADPCM streams are generated here. Decoding the compressed
+ *  formats (MP3, Ogg Vorbis, WMA) needs real sound files, so these are
+ *  only benchmarked if the environment variable XOREOS_BENCHMARK_SOUNDS
+ *  points to a directory containing some.
+ */
+
+#include <cstring>
+#include <cstdlib>
+
+#include <vector>
+
+#include <SDL_timer.h>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/scopedptr.h"
+#include "src/common/ustring.h"
+#include "src/common/error.h"
+#include "src/common/memreadstream.h"
+#include "src/common/readfile.h"
+#include "src/common/filelist.h"
+#include "src/common/filepath.h"
+
+#include "src/sound/sound.h"
+#include "src/sound/audiostream.h"
+#include "src/sound/nullbackend.h"
+#include "src/sound/samplecache.h"
+#include "src/sound/decoders/pcm.h"
+#include "src/sound/decoders/adpcm.h"
+#include "src/sound/decoders/wave.h"
+#include "src/sound/decoders/wave_types.h"
+
+#include "tests/benchmark/benchmark.h"
+
+static const int kRate     = 44100;
+static const int kChannels = 2;
+
+/** Seconds of sound in every generated stream. */
+static const size_t kSeconds = 10;
+
+/** Size of a block of ADPCM data. */
+static const size_t kBlockAlign = 1024;
+
+static uint32 kRandom = 0;
+
+static byte getRandomByte() {
+	kRandom = kRandom * 1664525 + 1013904223;
+
+	return kRandom >> 24;
+}
+
+static void writeUint16(std::vector<byte> &data, uint16 value) {
+	data.push_back(value & 0xFF);
+	data.push_back(value >> 8);
+}
+
+static void writeUint32(std::vector<byte> &data, uint32 value) {
+	writeUint16(data, value & 0xFFFF);
+	writeUint16(data, value >> 16);
+}
+
+static void writeTag(std::vector<byte> &data, const char *tag) {
+	data.insert(data.end(), tag, tag + 4);
+}
+
+/** Create a 16-bit triangle wave. */
+static void createPCM16(std::vector<byte> &data) {
+	const size_t samples = kSeconds * kRate * kChannels;
+
+	data.clear();
+	data.reserve(samples * 2);
+
+	for (size_t i = 0; i < samples; i++)
+		writeUint16(data, (uint16) ((((i / kChannels) * 64) & 0xFFFF) - 0x8000));
+}
+
+/** Create 8-bit noise. */
+static void createPCM8(std::vector<byte> &data) {
+	data.resize(kSeconds * kRate * kChannels);
+
+	for (size_t i = 0; i < data.size(); i++)
+		data[i] = getRandomByte();
+}
+
+/** Create noise in MS IMA ADPCM blocks, with valid block headers. */
+static void createMSIMA(std::vector<byte> &data) {
+	// Every block has a 4 byte header per channel, and two samples per byte
+	const size_t blocks = (kSeconds * kRate * kChannels) / ((kBlockAlign - 4 * kChannels) * 2) + 1;
+
+	data.clear();
+	data.reserve(blocks * kBlockAlign);
+
+	for (size_t i = 0; i < blocks; i++) {
+		for (int j = 0; j < kChannels; j++) {
+			writeUint16(data, 0);
+			writeUint16(data, getRandomByte() % 89);
+		}
+
+		for (size_t j = 4 * kChannels; j < kBlockAlign; j++)
+			data.push_back(getRandomByte());
+	}
+}
+
+/** Create noise in MS ADPCM blocks. */
+static void createMSADPCM(std::vector<byte> &data) {
+	// Every block has a 7 byte header per channel, and two samples per byte
+	const size_t blocks = (kSeconds * kRate * kChannels) / ((kBlockAlign - 7 * kChannels) * 2) + 1;
+
+	data.resize(blocks * kBlockAlign);
+
+	for (size_t i = 0; i < data.size(); i++)
+		data[i] = getRandomByte();
+}
+
+/** Wrap sound data into a WAVE file. */
+static void createWAVE(std::vector<byte> &file, const std::vector<byte> &data,
+                       uint16 compression, uint16 bitsPerSample, uint16 blockAlign) {
+
+	file.clear();
+	file.reserve(data.size() + 44);
+
+	writeTag(file, "RIFF");
+	writeUint32(file, data.size() + 36);
+	writeTag(file, "WAVE");
+
+	writeTag(file, "fmt ");
+	writeUint32(file, 16);
+	writeUint16(file, compression);
+	writeUint16(file, kChannels);
+	writeUint32(file, kRate);
+	writeUint32(file, kRate * blockAlign);
+	writeUint16(file, blockAlign);
+	writeUint16(file, bitsPerSample);
+
+	writeTag(file, "data");
+	writeUint32(file, data.size());
+
+	file.insert(file.end(), data.begin(), data.end());
+}
+
+static Common::SeekableReadStream *makeStream(const std::vector<byte> &data) {
+	return new Common::MemoryReadStream(&data[0], data.size());
+}
+
+/** Decode a whole audio stream, returning the number of samples. */
+static size_t decodeStream(Sound::AudioStream &stream) {
+	int16 buffer[4096];
+
+	size_t samples = 0;
+	while (!stream.endOfStream()) {
+		const size_t count = stream.readBuffer(buffer, ARRAYSIZE(buffer));
+		if (count == Sound::AudioStream::kSizeInvalid)
+			throw Common::Exception("Failed decoding audio stream");
+
+		if (count == 0)
+			break;
+
+		samples += count;
+	}
+
+	return samples;
+}
+
+typedef Sound::RewindableAudioStream *(*StreamCreator)(const std::vector<byte> &data);
+
+static Sound::RewindableAudioStream *createPCM16Stream(const std::vector<byte> &data) {
+	return Sound::makePCMStream(makeStream(data), kRate, Sound::FLAG_16BITS | Sound::FLAG_LITTLE_ENDIAN, kChannels);
+}
+
+static Sound::RewindableAudioStream *createPCM8Stream(const std::vector<byte> &data) {
+	return Sound::makePCMStream(makeStream(data), kRate, Sound::FLAG_UNSIGNED, kChannels);
+}
+
+static Sound::RewindableAudioStream *createAppleIMAStream(const std::vector<byte> &data) {
+	return Sound::makeADPCMStream(makeStream(data), true, data.size(), Sound::kADPCMApple, kRate, kChannels, 34);
+}
+
+static Sound::RewindableAudioStream *createWAVEStream(const std::vector<byte> &data) {
+	return Sound::makeWAVStream(makeStream(data), true);
+}
+
+static void benchmarkDecode(const char *name, const std::vector<byte> &data, StreamCreator creator) {
+	const size_t passes = getBenchmarkScale();
+
+	size_t samples = 0;
+
+	double start = getBenchmarkTime();
+
+	for (size_t i = 0; i < passes; i++) {
+		Common::ScopedPtr<Sound::RewindableAudioStream> stream(creator(data));
+
+		samples += decodeStream(*stream);
+	}
+
+	printBenchmark(name, "samples", (double) samples, getBenchmarkTime() - start);
+
+	EXPECT_GT(samples, 0U);
+}
+
+GTEST_TEST(SoundBenchmark, pcm) {
+	std::vector<byte> pcm16, pcm8;
+	createPCM16(pcm16);
+	createPCM8(pcm8);
+
+	benchmarkDecode("PCM, 16-bit", pcm16, &createPCM16Stream);
+	benchmarkDecode("PCM, 8-bit" , pcm8 , &createPCM8Stream);
+}
+
+GTEST_TEST(SoundBenchmark, adpcm) {
+	std::vector<byte> apple;
+	createPCM8(apple);
+
+	benchmarkDecode("ADPCM, Apple IMA", apple, &createAppleIMAStream);
+}
+
+GTEST_TEST(SoundBenchmark, wave) {
+	std::vector<byte> data, file;
+
+	createPCM16(data);
+	createWAVE(file, data, Sound::kWavePCM, 16, 2 * kChannels);
+	benchmarkDecode("WAVE, PCM", file, &createWAVEStream);
+
+	createMSIMA(data);
+	createWAVE(file, data, Sound::kWaveMSIMAADPCM, 4, kBlockAlign);
+	benchmarkDecode("WAVE, MS IMA ADPCM", file, &createWAVEStream);
+
+	createMSADPCM(data);
+	createWAVE(file, data, Sound::kWaveMSADPCM, 4, kBlockAlign);
+	benchmarkDecode("WAVE, MS ADPCM", file, &createWAVEStream);
+}
+
+GTEST_TEST(SoundBenchmark, files) {
+	const char *directory = std::getenv("XOREOS_BENCHMARK_SOUNDS");
+	if (!directory) {
+		std::printf("[ BENCHMARK] Set XOREOS_BENCHMARK_SOUNDS to a directory of sound files to benchmark them\n");
+		return;
+	}
+
+	Common::FileList files;
+	files.addDirectory(directory);
+
+	for (Common::FileList::const_iterator f = files.begin(); f != files.end(); ++f) {
+		const size_t passes = getBenchmarkScale();
+
+		size_t samples = 0;
+
+		try {
+			double start = getBenchmarkTime();
+
+			for (size_t i = 0; i < passes; i++) {
+				Common::ScopedPtr<Sound::AudioStream> stream(Sound::SoundManager::makeAudioStream(new Common::ReadFile(*f)));
+
+				samples += decodeStream(*stream);
+			}
+
+			printBenchmark(Common::FilePath::getFile(*f).c_str(), "samples", (double) samples, getBenchmarkTime() - start);
+
+		} catch (...) {
+			Common::exceptionDispatcherWarning("Failed decoding \"%s\"", f->c_str());
+		}
+	}
+}
+
+/** Play streams through the sound manager, with a null backend playing as fast as possible. */
+GTEST_TEST(SoundBenchmark, soundManager) {
+	static const size_t kStreams = 4;
+
+	std::vector<byte> data, file;
+	createMSIMA(data);
+	createWAVE(file, data, Sound::kWaveMSIMAADPCM, 4, kBlockAlign);
+
+	Sound::NullBackend *backend = new Sound::NullBackend(Sound::NullBackend::kModeFast);
+	SoundMan.init(backend);
+
+	const size_t passes = getBenchmarkScale();
+
+	double start = getBenchmarkTime();
+
+	for (size_t i = 0; i < passes; i++) {
+		std::vector<Sound::ChannelHandle> channels;
+
+		for (size_t j = 0; j < kStreams; j++) {
+			channels.push_back(SoundMan.playAudioStream(createWAVEStream(file), Sound::kSoundTypeSFX));
+			SoundMan.startChannel(channels.back());
+		}
+
+		for (size_t j = 0; j < kStreams; j++)
+			while (SoundMan.isPlaying(channels[j]))
+				SDL_Delay(1);
+	}
+
+	const uint64 samples = backend->getSamplesPlayed();
+	printBenchmark("SoundManager, 4 WAVE channels", "samples", (double) samples, getBenchmarkTime() - start);
+
+	SoundMan.deinit();
+	Sound::SoundManager::destroy();
+
+	EXPECT_GT(samples, 0U);
+}
+
+/** Play the same sound over and over, decoding it every time or reading it out of the sample cache. */
+GTEST_TEST(SoundBenchmark, sampleCache) {
+	std::vector<byte> data, file;
+	createMSADPCM(data);
+	createWAVE(file, data, Sound::kWaveMSADPCM, 4, kBlockAlign);
+
+	Sound::SampleCache cache;
+	cache.setSize(64 * 1024 * 1024);
+	cache.setMaxDuration((kSeconds + 1) * 1000);
+
+	const size_t passes = getBenchmarkScale();
+
+	size_t samples = 0;
+
+	double start = getBenchmarkTime();
+
+	for (size_t i = 0; i < passes; i++) {
+		Common::ScopedPtr<Sound::AudioStream> stream(createWAVEStream(file));
+
+		samples += decodeStream(*stream);
+	}
+
+	printBenchmark("Repeated sound, decoded", "samples", (double) samples, getBenchmarkTime() - start);
+
+	samples = 0;
+
+	start = getBenchmarkTime();
+
+	for (size_t i = 0; i < passes; i++) {
+		Common::ScopedPtr<Sound::AudioStream> stream(cache.get("sound"));
+		if (!stream)
+			stream.reset(cache.add("sound", createWAVEStream(file)));
+
+		samples += decodeStream(*stream);
+	}
+
+	printBenchmark("Repeated sound, sample cache", "samples", (double) samples, getBenchmarkTime() - start);
+
+	Sound::SampleCache::Stats stats;
+	cache.getStats(stats);
+
+	EXPECT_EQ(stats.count, 1U);
+	EXPECT_EQ(stats.hits, passes - 1);
+}
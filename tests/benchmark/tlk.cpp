@@ -0,0 +1,209 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Micro-benchmark of our TLK talk table reader.
+ */
+
+#include <cstring>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/scopedptr.h"
+#include "src/common/ustring.h"
+#include "src/common/strutil.h"
+#include "src/common/encoding.h"
+#include "src/common/memreadstream.h"
+
+#include "src/aurora/talktable_tlk.h"
+
+#include "tests/benchmark/benchmark.h"
+#include "tests/benchmark/heap.h"
+
+/** Number of strings in the talk table, like a big dialog.tlk. */
+static const size_t kStrings = 20000;
+
+/** Number of lookups of every string, per benchmark scale. */
+static const size_t kPasses  = 5;
+
+static const size_t kEntrySize = 40;
+
+static void writeUint32(std::vector<byte> &data, size_t offset, uint32 value) {
+	WRITE_LE_UINT32(&data[offset], value);
+}
+
+static Common::UString getText(size_t i) {
+	return "Entry " + Common::composeString((uint64) i) +
+	       ": Greetings, traveller. The roads north of the city are not safe these days.";
+}
+
+/** Write a V3.0 TLK with a text in every entry, and a sound in every third one. */
+static void createTLK(std::vector<byte> &file) {
+	const size_t stringsOffset = 20 + kStrings * kEntrySize;
+
+	file.resize(stringsOffset, 0);
+
+	std::memcpy(&file[0], "TLK V3.0", 8);
+	writeUint32(file,  8, 0);
+	writeUint32(file, 12, kStrings);
+	writeUint32(file, 16, stringsOffset);
+
+	for (size_t i = 0; i < kStrings; i++) {
+		const Common::UString text = getText(i);
+		const size_t length = std::strlen(text.c_str());
+
+		const size_t entry = 20 + i * kEntrySize;
+
+		writeUint32(file, entry, ((i % 3) == 0) ? 3 : 1);
+		if ((i % 3) == 0)
+			std::memcpy(&file[entry + 4], "vo_greeting", 11);
+
+		writeUint32(file, entry + 28, file.size() - stringsOffset);
+		writeUint32(file, entry + 32, length);
+
+		file.insert(file.end(), text.c_str(), text.c_str() + length);
+	}
+}
+
+static Aurora::TalkTable_TLK *loadTLK(const std::vector<byte> &data) {
+	return new Aurora::TalkTable_TLK(new Common::MemoryReadStream(&data[0], data.size()),
+	                                 Common::kEncodingCP1252);
+}
+
+/** Look up every string once, in the scattered order a game's UI does. */
+static size_t lookupStrings(const Aurora::TalkTable_TLK &tlk) {
+	size_t count = 0;
+
+	for (size_t i = 0; i < kStrings; i++)
+		count += tlk.getString((i * 7919) % kStrings).size();
+
+	return count;
+}
+
+/** Load fresh talk tables and look up all strings, decoding them on first access. */
+static void benchmarkLazy(const char *name, const std::vector<byte> &data) {
+	const size_t count = getBenchmarkScale();
+
+	double start = getBenchmarkTime();
+
+	for (size_t i = 0; i < count; i++) {
+		Common::ScopedPtr<Aurora::TalkTable_TLK> tlk(loadTLK(data));
+
+		lookupStrings(*tlk);
+	}
+
+	printBenchmark(name, "strings", (double) (count * kStrings), getBenchmarkTime() - start);
+}
+
+/** Load fresh talk tables and decode all strings up front. */
+static void benchmarkPreDecode(const char *name, const std::vector<byte> &data) {
+	const size_t count = getBenchmarkScale();
+
+	double start = getBenchmarkTime();
+
+	for (size_t i = 0; i < count; i++) {
+		Common::ScopedPtr<Aurora::TalkTable_TLK> tlk(loadTLK(data));
+
+		tlk->preDecode();
+	}
+
+	printBenchmark(name, "strings", (double) (count * kStrings), getBenchmarkTime() - start);
+}
+
+/** Look up strings that have all been decoded already. */
+static void benchmarkLookups(const char *name, const Aurora::TalkTable_TLK &tlk) {
+	const size_t count = getBenchmarkScale() * kPasses;
+
+	const size_t expected = lookupStrings(tlk);
+
+	double start = getBenchmarkTime();
+
+	size_t matched = 0;
+	for (size_t i = 0; i < count; i++)
+		if (lookupStrings(tlk) == expected)
+			matched++;
+
+	printBenchmark(name, "lookups", (double) (count * kStrings), getBenchmarkTime() - start);
+
+	EXPECT_EQ(matched, count);
+}
+
+GTEST_TEST(TLKBenchmark, decode) {
+	std::vector<byte> data;
+	createTLK(data);
+
+	benchmarkLazy     ("TLK, lazy decode", data);
+	benchmarkPreDecode("TLK, pre-decode" , data);
+}
+
+GTEST_TEST(TLKBenchmark, lookups) {
+	std::vector<byte> data;
+	createTLK(data);
+
+	Common::ScopedPtr<Aurora::TalkTable_TLK> lazy(loadTLK(data));
+	lookupStrings(*lazy);
+
+	Common::ScopedPtr<Aurora::TalkTable_TLK> decoded(loadTLK(data));
+	decoded->preDecode();
+
+	ASSERT_TRUE(decoded->isPreDecoded());
+	EXPECT_EQ(lookupStrings(*lazy), lookupStrings(*decoded));
+
+	benchmarkLookups("TLK, lazy lookups"       , *lazy);
+	benchmarkLookups("TLK, pre-decoded lookups", *decoded);
+}
+
+GTEST_TEST(TLKBenchmark, background) {
+	std::vector<byte> data;
+	createTLK(data);
+
+	double start = getBenchmarkTime();
+
+	Common::ScopedPtr<Aurora::TalkTable_TLK> tlk(loadTLK(data));
+	tlk->preDecode(true);
+
+	// The UI keeps looking up strings while they're being decoded
+	while (!tlk->isPreDecoded())
+		lookupStrings(*tlk);
+
+	printBenchmark("TLK, background pre-decode", "strings", (double) kStrings, getBenchmarkTime() - start);
+	EXPECT_GT(lookupStrings(*tlk), 0U);
+}
+
+GTEST_TEST(TLKBenchmark, memory) {
+	std::vector<byte> data;
+	createTLK(data);
+
+	const size_t before = getHeapAllocated();
+
+	Common::ScopedPtr<Aurora::TalkTable_TLK> tlk(loadTLK(data));
+	printBenchmarkMemory("TLK, lazy, loaded", getHeapAllocated() - before);
+
+	// A game only ever shows a fraction of its strings
+	for (size_t i = 0; i < kStrings; i += 10)
+		tlk->getString(i);
+	printBenchmarkMemory("TLK, lazy, 10% looked up", getHeapAllocated() - before);
+
+	tlk->preDecode();
+	printBenchmarkMemory("TLK, pre-decoded", getHeapAllocated() - before);
+}
@@ -192,3 +192,148 @@ GTEST_TEST(BitStream, BitStream64BELSB) {
 
 	testBitStream(bitStream, compValues);
 }
+
+template<class T>
+static void testPeekBits() {
+	static const byte data[16] = {
+		0x12, 0x34, 0x56, 0x78, 0x90, 0xAB, 0xCD, 0xEF,
+		0xFE, 0xDC, 0xBA, 0x09, 0x87, 0x65, 0x43, 0x21
+	};
+
+	Common::MemoryReadStream stream(data);
+	T bitStream(stream);
+
+	for (size_t start = 0; start < bitStream.size(); start++) {
+		for (size_t n = 1; n <= 32; n++) {
+			bitStream.rewind();
+			bitStream.skip(start);
+
+			const uint32 peeked = bitStream.peekBits(n);
+			EXPECT_EQ(bitStream.pos(), start) << "At " << start << ", " << n;
+
+			// Bits beyond the end read as 0
+			const size_t available = MIN<size_t>(n, bitStream.size() - start);
+
+			uint32 read = bitStream.getBits(available);
+			if (bitStream.isMSBFirst())
+				read <<= n - available;
+
+			EXPECT_EQ(peeked, read) << "At " << start << ", " << n;
+		}
+	}
+}
+
+GTEST_TEST(BitStream, peekBits) {
+	testPeekBits<Common::BitStream8MSB>();
+	testPeekBits<Common::BitStream8LSB>();
+	testPeekBits<Common::BitStream16LEMSB>();
+	testPeekBits<Common::BitStream16LELSB>();
+	testPeekBits<Common::BitStream16BEMSB>();
+	testPeekBits<Common::BitStream16BELSB>();
+	testPeekBits<Common::BitStream32LEMSB>();
+	testPeekBits<Common::BitStream32LELSB>();
+	testPeekBits<Common::BitStream32BEMSB>();
+	testPeekBits<Common::BitStream32BELSB>();
+	testPeekBits<Common::BitStream64LEMSB>();
+	testPeekBits<Common::BitStream64LELSB>();
+	testPeekBits<Common::BitStream64BEMSB>();
+	testPeekBits<Common::BitStream64BELSB>();
+}
+
+GTEST_TEST(BitStream, peekBitsMemory) {
+	testPeekBits<Common::MemoryBitStream8MSB>();
+	testPeekBits<Common::MemoryBitStream8LSB>();
+	testPeekBits<Common::MemoryBitStream16LEMSB>();
+	testPeekBits<Common::MemoryBitStream16LELSB>();
+	testPeekBits<Common::MemoryBitStream16BEMSB>();
+	testPeekBits<Common::MemoryBitStream16BELSB>();
+	testPeekBits<Common::MemoryBitStream32LEMSB>();
+	testPeekBits<Common::MemoryBitStream32LELSB>();
+	testPeekBits<Common::MemoryBitStream32BEMSB>();
+	testPeekBits<Common::MemoryBitStream32BELSB>();
+	testPeekBits<Common::MemoryBitStream64LEMSB>();
+	testPeekBits<Common::MemoryBitStream64LELSB>();
+	testPeekBits<Common::MemoryBitStream64BEMSB>();
+	testPeekBits<Common::MemoryBitStream64BELSB>();
+}
+
+/** Read through the data with a mix of operations, and compare the memory bit stream against the generic one. */
+template<class T, class M>
+static void testMemoryBitStream() {
+	byte data[67];
+	for (size_t i = 0; i < ARRAYSIZE(data); i++)
+		data[i] = (byte) (i * 0x9D + 0x3B);
+
+	Common::MemoryReadStream stream(data);
+
+	T bitStream(stream);
+	M memStream(data, sizeof(data));
+
+	EXPECT_EQ(memStream.size(), bitStream.size());
+	EXPECT_EQ(memStream.isMSBFirst(), bitStream.isMSBFirst());
+
+	uint32 seed = 0x1234;
+	for (size_t step = 0; ; step++) {
+		seed = seed * 1103515245 + 12345;
+
+		const size_t op = (seed >> 16) % 5;
+		const size_t n  = (seed >> 8) % 33;
+
+		const size_t remaining = bitStream.size() - bitStream.pos();
+		if (remaining == 0)
+			break;
+
+		if (op == 0) {
+			EXPECT_EQ(memStream.getBit(), bitStream.getBit()) << "At step " << step;
+		} else if (op == 1) {
+			const size_t count = MIN(n, remaining);
+			EXPECT_EQ(memStream.getBits(count), bitStream.getBits(count)) << "At step " << step;
+		} else if (op == 2) {
+			EXPECT_EQ(memStream.peekBits(n), bitStream.peekBits(n)) << "At step " << step;
+		} else if (op == 3) {
+			const size_t count = MIN(n * 3, remaining);
+			memStream.skip(count);
+			bitStream.skip(count);
+		} else {
+			uint32 x1 = n, x2 = n;
+			memStream.addBit(x1, 5);
+			bitStream.addBit(x2, 5);
+
+			EXPECT_EQ(x1, x2) << "At step " << step;
+		}
+
+		ASSERT_EQ(memStream.pos(), bitStream.pos()) << "At step " << step;
+	}
+
+	EXPECT_TRUE(memStream.eos());
+
+	EXPECT_THROW(memStream.getBit(), Common::Exception);
+	EXPECT_THROW(memStream.getBits(1), Common::Exception);
+	EXPECT_THROW(memStream.skip(1), Common::Exception);
+
+	EXPECT_EQ(memStream.getBits(0), 0);
+	EXPECT_EQ(memStream.peekBits(8), 0);
+
+	memStream.rewind();
+	bitStream.rewind();
+
+	EXPECT_EQ(memStream.pos(), 0);
+	EXPECT_EQ(memStream.getBits(32), bitStream.getBits(32));
+}
+
+GTEST_TEST(BitStream, MemoryBitStream) {
+	testMemoryBitStream<Common::BitStream8MSB   , Common::MemoryBitStream8MSB   >();
+	testMemoryBitStream<Common::BitStream8LSB   , Common::MemoryBitStream8LSB   >();
+	testMemoryBitStream<Common::BitStream16LEMSB, Common::MemoryBitStream16LEMSB>();
+	testMemoryBitStream<Common::BitStream16LELSB, Common::MemoryBitStream16LELSB>();
+	testMemoryBitStream<Common::BitStream16BEMSB, Common::MemoryBitStream16BEMSB>();
+	testMemoryBitStream<Common::BitStream16BELSB, Common::MemoryBitStream16BELSB>();
+	testMemoryBitStream<Common::BitStream32LEMSB, Common::MemoryBitStream32LEMSB>();
+	testMemoryBitStream<Common::BitStream32LELSB, Common::MemoryBitStream32LELSB>();
+	testMemoryBitStream<Common::BitStream32BEMSB, Common::MemoryBitStream32BEMSB>();
+	testMemoryBitStream<Common::BitStream32BELSB, Common::MemoryBitStream32BELSB>();
+	testMemoryBitStream<Common::BitStream64LEMSB, Common::MemoryBitStream64LEMSB>();
+	testMemoryBitStream<Common::BitStream64LELSB, Common::MemoryBitStream64LELSB>();
+	testMemoryBitStream<Common::BitStream64BEMSB, Common::MemoryBitStream64BEMSB>();
+	testMemoryBitStream<Common::BitStream64BELSB, Common::MemoryBitStream64BELSB>();
+}
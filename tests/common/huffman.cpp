@@ -22,11 +22,14 @@
  *  Unit tests for our Huffman decoder.
  */
 
+#include <vector>
+
 #include "gtest/gtest.h"
 
 #include "src/common/huffman.h"
 #include "src/common/error.h"
 #include "src/common/util.h"
+#include "src/common/scopedptr.h"
 #include "src/common/memreadstream.h"
 #include "src/common/bitstream.h"
 
@@ -120,3 +123,85 @@ GTEST_TEST(Huffman, invalidSymbol) {
 
 	EXPECT_THROW(huffman.getSymbol(bitStream), Common::Exception);
 }
+
+/* A code long enough to need sub-tables: "0", "10", "110", ..., 15 ones and a
+ * zero, and 16 ones. Symbol i has the length i + 1, except for the last one. */
+static const size_t kLongCodeCount = 17;
+
+static uint8 getLongCodeLength(size_t i) {
+	return MIN<size_t>(i + 1, kLongCodeCount - 1);
+}
+
+/** Return the long code i, in the order its bits are read. */
+static uint32 getLongCode(size_t i) {
+	const uint8 length = getLongCodeLength(i);
+	const uint32 ones = (1 << length) - 1;
+
+	return (i == (kLongCodeCount - 1)) ? ones : (ones & ~1);
+}
+
+/** Write the long codes for these symbols into a bitstream of 8-bit values. */
+static std::vector<byte> writeLongCodes(const std::vector<size_t> &symbols, bool msbFirst) {
+	std::vector<byte> data;
+
+	size_t bitCount = 0;
+	for (std::vector<size_t>::const_iterator s = symbols.begin(); s != symbols.end(); ++s) {
+		const uint8  length = getLongCodeLength(*s);
+		const uint32 code   = getLongCode(*s);
+
+		for (int i = length - 1; i >= 0; i--, bitCount++) {
+			if ((bitCount % 8) == 0)
+				data.push_back(0);
+
+			if ((code >> i) & 1)
+				data.back() |= msbFirst ? (0x80 >> (bitCount % 8)) : (1 << (bitCount % 8));
+		}
+	}
+
+	return data;
+}
+
+static void testLongCodes(bool msbFirst) {
+	uint32 codes[kLongCodeCount];
+	uint8  lengths[kLongCodeCount];
+
+	for (size_t i = 0; i < kLongCodeCount; i++) {
+		lengths[i] = getLongCodeLength(i);
+		codes  [i] = getLongCode(i);
+
+		// When reading LSB to MSB, the first bit read ends up as the code's LSB
+		if (!msbFirst) {
+			uint32 reversed = 0;
+			for (uint8 j = 0; j < lengths[i]; j++)
+				reversed |= ((codes[i] >> j) & 1) << (lengths[i] - 1 - j);
+
+			codes[i] = reversed;
+		}
+	}
+
+	std::vector<size_t> symbols;
+	for (size_t i = 0; i < 4 * kLongCodeCount; i++)
+		symbols.push_back((i * 7) % kLongCodeCount);
+
+	const std::vector<byte> data = writeLongCodes(symbols, msbFirst);
+
+	Common::MemoryReadStream byteStream(&data[0], data.size());
+	Common::ScopedPtr<Common::BitStream> bitStream;
+	if (msbFirst)
+		bitStream.reset(new Common::BitStream8MSB(byteStream));
+	else
+		bitStream.reset(new Common::BitStream8LSB(byteStream));
+
+	Common::Huffman huffman(0, kLongCodeCount, codes, lengths);
+
+	for (size_t i = 0; i < symbols.size(); i++)
+		EXPECT_EQ(huffman.getSymbol(*bitStream), symbols[i]) << "At index " << i;
+}
+
+GTEST_TEST(Huffman, longCodesMSB) {
+	testLongCodes(true);
+}
+
+GTEST_TEST(Huffman, longCodesLSB) {
+	testLongCodes(false);
+}
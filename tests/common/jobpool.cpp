@@ -0,0 +1,176 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our job pool.
+ */
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/jobpool.h"
+#include "src/common/mutex.h"
+#include "src/common/error.h"
+
+class CountingJobSet : public Common::JobSet {
+public:
+	std::vector<unsigned int> counts;
+
+	size_t workerJobs;
+
+	CountingJobSet(Common::JobPool &pool, size_t count) : counts(count, 0), workerJobs(0), _pool(&pool) {
+	}
+
+	void runJob(size_t index) {
+		// Make the jobs a bit uneven, to give the threads something to steal
+		volatile unsigned int x = 0;
+		for (size_t i = 0; i < (index % 7) * 1000; i++)
+			x = x + i;
+
+		Common::StackLock lock(_mutex);
+
+		counts[index]++;
+		if (_pool->isWorkerThread())
+			workerJobs++;
+	}
+
+private:
+	Common::JobPool *_pool;
+	Common::Mutex _mutex;
+};
+
+class OrderJobSet : public Common::JobSet {
+public:
+	std::vector<size_t> order;
+
+	void runJob(size_t index) {
+		order.push_back(index);
+	}
+};
+
+class ThrowingJobSet : public Common::JobSet {
+public:
+	unsigned int count;
+
+	ThrowingJobSet() : count(0) {
+	}
+
+	void runJob(size_t index) {
+		{
+			Common::StackLock lock(_mutex);
+			count++;
+		}
+
+		if (index == 23)
+			throw Common::Exception("Job %u", (uint)index);
+	}
+
+private:
+	Common::Mutex _mutex;
+};
+
+GTEST_TEST(JobPool, noThreads) {
+	Common::JobPool pool;
+	EXPECT_EQ(pool.getThreadCount(), 0);
+	EXPECT_FALSE(pool.isWorkerThread());
+
+	OrderJobSet jobs;
+	pool.run(jobs, 10);
+
+	ASSERT_EQ(jobs.order.size(), 10);
+	for (size_t i = 0; i < jobs.order.size(); i++)
+		EXPECT_EQ(jobs.order[i], i) << "At index " << i;
+}
+
+GTEST_TEST(JobPool, noJobs) {
+	Common::JobPool pool;
+	pool.init(3);
+
+	CountingJobSet jobs(pool, 0);
+	pool.run(jobs, 0);
+
+	EXPECT_EQ(jobs.workerJobs, 0);
+}
+
+GTEST_TEST(JobPool, allJobsOnce) {
+	Common::JobPool pool;
+	pool.init(3);
+
+	EXPECT_EQ(pool.getThreadCount(), 3);
+	EXPECT_FALSE(pool.isWorkerThread());
+
+	static const size_t kCounts[] = { 1, 2, 3, 4, 5, 17, 1000 };
+
+	for (size_t n = 0; n < ARRAYSIZE(kCounts); n++) {
+		for (int r = 0; r < 20; r++) {
+			CountingJobSet jobs(pool, kCounts[n]);
+			pool.run(jobs, kCounts[n]);
+
+			for (size_t i = 0; i < jobs.counts.size(); i++)
+				ASSERT_EQ(jobs.counts[i], 1) << "At count " << kCounts[n] << ", index " << i;
+		}
+	}
+}
+
+GTEST_TEST(JobPool, reinit) {
+	Common::JobPool pool;
+
+	pool.init(2);
+	EXPECT_EQ(pool.getThreadCount(), 2);
+
+	pool.init(4);
+	EXPECT_EQ(pool.getThreadCount(), 4);
+
+	CountingJobSet jobs1(pool, 100);
+	pool.run(jobs1, 100);
+
+	for (size_t i = 0; i < jobs1.counts.size(); i++)
+		EXPECT_EQ(jobs1.counts[i], 1) << "At index " << i;
+
+	pool.deinit();
+	EXPECT_EQ(pool.getThreadCount(), 0);
+
+	CountingJobSet jobs2(pool, 100);
+	pool.run(jobs2, 100);
+
+	EXPECT_EQ(jobs2.workerJobs, 0);
+	for (size_t i = 0; i < jobs2.counts.size(); i++)
+		EXPECT_EQ(jobs2.counts[i], 1) << "At index " << i;
+}
+
+GTEST_TEST(JobPool, exception) {
+	Common::JobPool pool;
+	pool.init(3);
+
+	ThrowingJobSet jobs;
+	EXPECT_THROW(pool.run(jobs, 100), Common::Exception);
+
+	// All the other jobs still ran
+	EXPECT_EQ(jobs.count, 100);
+
+	// And the pool is still usable
+	CountingJobSet jobs2(pool, 100);
+	pool.run(jobs2, 100);
+
+	for (size_t i = 0; i < jobs2.counts.size(); i++)
+		EXPECT_EQ(jobs2.counts[i], 1) << "At index " << i;
+}
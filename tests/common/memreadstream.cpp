@@ -28,6 +28,7 @@
 #include "src/common/error.h"
 #include "src/common/readstream.h"
 #include "src/common/memreadstream.h"
+#include "src/common/scopedptr.h"
 
 GTEST_TEST(MemoryReadStream, size) {
 	static const byte data[3] = { 0 };
@@ -105,6 +106,51 @@ GTEST_TEST(MemoryReadStream, readStream) {
 	EXPECT_THROW(stream.readStream(ARRAYSIZE(data) + 1), Common::Exception);
 }
 
+GTEST_TEST(MemoryReadStream, readAt) {
+	static const byte data[5] = { 0x12, 0x34, 0x56, 0x78, 0x90 };
+	Common::MemoryReadStream stream(data);
+
+	stream.seek(1);
+
+	byte readData[4] = { 0 };
+	size_t readCount;
+
+	readCount = stream.readAt(2, readData, 2);
+
+	EXPECT_EQ(readCount, 2);
+	EXPECT_EQ(readData[0], data[2]);
+	EXPECT_EQ(readData[1], data[3]);
+
+	readCount = stream.readAt(3, readData, 4);
+
+	EXPECT_EQ(readCount, 2);
+	EXPECT_EQ(readData[0], data[3]);
+	EXPECT_EQ(readData[1], data[4]);
+
+	readCount = stream.readAt(5, readData, 1);
+	EXPECT_EQ(readCount, 0);
+
+	EXPECT_EQ(stream.pos(), 1);
+	EXPECT_FALSE(stream.eos());
+}
+
+GTEST_TEST(MemoryReadStream, readStreamAt) {
+	static const byte data[3] = { 0x12, 0x34, 0x56 };
+	Common::MemoryReadStream stream(data);
+
+	Common::MemoryReadStream *streamRead = stream.readStreamAt(1, 2);
+
+	EXPECT_EQ(streamRead->size(), 2);
+	EXPECT_EQ(streamRead->readByte(), data[1]);
+	EXPECT_EQ(streamRead->readByte(), data[2]);
+
+	delete streamRead;
+
+	EXPECT_EQ(stream.pos(), 0);
+
+	EXPECT_THROW(stream.readStreamAt(1, ARRAYSIZE(data)), Common::Exception);
+}
+
 GTEST_TEST(MemoryReadStream, readChar) {
 	static const byte data[3] = { 0x12, 0x34, 0x56 };
 	Common::MemoryReadStream stream(data);
@@ -315,6 +361,46 @@ GTEST_TEST(SeekableSubReadStream, fromMem) {
 	EXPECT_FALSE(subStream.eos());
 }
 
+GTEST_TEST(SeekableSubReadStream, readAt) {
+	static const byte data[5] = { 0x12, 0x34, 0x56, 0x78, 0x90 };
+	Common::MemoryReadStream stream(data);
+
+	Common::SeekableSubReadStream subStream(&stream, 1, 4);
+
+	byte readData[4] = { 0 };
+	const size_t readCount = subStream.readAt(1, readData, 4);
+
+	EXPECT_EQ(readCount, 2);
+	EXPECT_EQ(readData[0], data[2]);
+	EXPECT_EQ(readData[1], data[3]);
+
+	EXPECT_EQ(subStream.readAt(3, readData, 1), 0);
+
+	EXPECT_EQ(subStream.pos(), 0);
+	EXPECT_FALSE(subStream.eos());
+}
+
+GTEST_TEST(SharedMemoryReadStream, shared) {
+	byte *data = new byte[4];
+	data[0] = 0x12; data[1] = 0x34; data[2] = 0x56; data[3] = 0x78;
+
+	boost::shared_array<const byte> shared(data);
+
+	Common::ScopedPtr<Common::SeekableReadStream> stream1(new Common::SharedMemoryReadStream(shared, 4));
+	Common::ScopedPtr<Common::SeekableReadStream> stream2(new Common::SharedMemoryReadStream(shared, 4));
+
+	// Dropping our own reference must keep the data alive for the streams
+	shared.reset();
+
+	EXPECT_EQ(stream1->readUint32BE(), 0x12345678);
+
+	stream1.reset();
+
+	EXPECT_EQ(stream2->readUint16BE(), 0x1234);
+	EXPECT_EQ(stream2->readUint16BE(), 0x5678);
+	EXPECT_THROW(stream2->readByte(), Common::Exception);
+}
+
 GTEST_TEST(SeekableSubReadStreamEndian, streamEndianLE) {
 	static const byte data[4] = { 0x78, 0x56, 0x34, 0x12 };
 	Common::MemoryReadStream stream(data);
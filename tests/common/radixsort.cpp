@@ -0,0 +1,101 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our radix sort.
+ */
+
+#include <cstdlib>
+
+#include <vector>
+#include <algorithm>
+
+#include "gtest/gtest.h"
+
+#include "src/common/radixsort.h"
+
+static bool compareKeys(const Common::RadixSortKey &a, const Common::RadixSortKey &b) {
+	return a.key < b.key;
+}
+
+GTEST_TEST(RadixSort, empty) {
+	std::vector<Common::RadixSortKey> keys, scratch;
+
+	Common::radixSort(keys, scratch);
+	EXPECT_TRUE(keys.empty());
+}
+
+GTEST_TEST(RadixSort, sorted) {
+	std::vector<Common::RadixSortKey> keys, scratch;
+
+	std::srand(23);
+	for (uint32 i = 0; i < 1000; i++) {
+		const uint64 key = (((uint64) std::rand()) << 40) ^ (((uint64) std::rand()) << 16) ^ std::rand();
+
+		keys.push_back(Common::RadixSortKey(key, i));
+	}
+
+	std::vector<Common::RadixSortKey> expected = keys;
+	std::stable_sort(expected.begin(), expected.end(), compareKeys);
+
+	Common::radixSort(keys, scratch);
+
+	ASSERT_EQ(keys.size(), expected.size());
+	for (size_t i = 0; i < keys.size(); i++) {
+		EXPECT_EQ(keys[i].key  , expected[i].key  ) << "At index " << i;
+		EXPECT_EQ(keys[i].index, expected[i].index) << "At index " << i;
+	}
+}
+
+GTEST_TEST(RadixSort, stable) {
+	std::vector<Common::RadixSortKey> keys, scratch;
+
+	// Few distinct values, with only one digit differing
+	for (uint32 i = 0; i < 100; i++)
+		keys.push_back(Common::RadixSortKey(0x4200000000000000ULL | ((i * 7) % 3), i));
+
+	Common::radixSort(keys, scratch);
+
+	for (size_t i = 1; i < keys.size(); i++) {
+		ASSERT_LE(keys[i - 1].key, keys[i].key) << "At index " << i;
+
+		if (keys[i - 1].key == keys[i].key) {
+			EXPECT_LT(keys[i - 1].index, keys[i].index) << "At index " << i;
+		}
+	}
+}
+
+GTEST_TEST(RadixSort, reuseScratch) {
+	std::vector<Common::RadixSortKey> keys, scratch;
+
+	for (uint32 i = 0; i < 10; i++)
+		keys.push_back(Common::RadixSortKey(10 - i, i));
+
+	Common::radixSort(keys, scratch);
+
+	keys.resize(3);
+	keys[0].key = 0x0300; keys[1].key = 0x0100; keys[2].key = 0x0200;
+
+	Common::radixSort(keys, scratch);
+
+	EXPECT_EQ(keys[0].key, 0x0100U);
+	EXPECT_EQ(keys[1].key, 0x0200U);
+	EXPECT_EQ(keys[2].key, 0x0300U);
+}
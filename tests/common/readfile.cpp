@@ -33,6 +33,8 @@
 #include "src/common/util.h"
 #include "src/common/platform.h"
 #include "src/common/readfile.h"
+#include "src/common/memreadstream.h"
+#include "src/common/scopedptr.h"
 
 boost::filesystem::path kFilePath;
 
@@ -87,3 +89,91 @@ GTEST_TEST_F(ReadFile, write) {
 	for (size_t i = 0; i < ARRAYSIZE(data); i++)
 		EXPECT_EQ(readData[i], data[i]) << "At index " << i;
 }
+
+GTEST_TEST_F(ReadFile, readAt) {
+	ASSERT_FALSE(kFilePath.empty());
+
+	static const byte data[5] = { 0x12, 0x34, 0x56, 0x78, 0x90 };
+
+	// Create the input file
+
+	boost::filesystem::ofstream testFile(kFilePath, std::ofstream::binary);
+
+	testFile.write(reinterpret_cast<const char *>(data), ARRAYSIZE(data));
+	testFile.flush();
+	ASSERT_FALSE(testFile.fail());
+
+	testFile.close();
+
+	// Read the file with positional reads, interleaved with normal reads
+
+	Common::ReadFile file(kFilePath.generic_string());
+	ASSERT_TRUE(file.isOpen());
+
+	EXPECT_EQ(file.readByte(), data[0]);
+
+	byte readData[4] = { 0 };
+	size_t readCount;
+
+	readCount = file.readAt(3, readData, 4);
+	EXPECT_EQ(readCount, 2);
+
+	EXPECT_EQ(readData[0], data[3]);
+	EXPECT_EQ(readData[1], data[4]);
+
+	EXPECT_EQ(file.readAt(5, readData, 1), 0);
+
+	EXPECT_EQ(file.pos(), 1);
+	EXPECT_EQ(file.readByte(), data[1]);
+}
+
+GTEST_TEST_F(ReadFile, mapped) {
+	ASSERT_FALSE(kFilePath.empty());
+
+	static const byte data[5] = { 0x12, 0x34, 0x56, 0x78, 0x90 };
+
+	// Create the input file
+
+	boost::filesystem::ofstream testFile(kFilePath, std::ofstream::binary);
+
+	testFile.write(reinterpret_cast<const char *>(data), ARRAYSIZE(data));
+	testFile.flush();
+	ASSERT_FALSE(testFile.fail());
+
+	testFile.close();
+
+	// Map the file with our ReadFile class
+
+	Common::ScopedPtr<Common::ReadFile> file(new Common::ReadFile(kFilePath.generic_string(), true));
+	ASSERT_TRUE(file->isOpen());
+	ASSERT_TRUE(file->isMapped());
+
+	EXPECT_EQ(file->size(), ARRAYSIZE(data));
+
+	byte readData[ARRAYSIZE(data)];
+	EXPECT_EQ(file->read(readData, sizeof(readData)), ARRAYSIZE(readData));
+
+	for (size_t i = 0; i < ARRAYSIZE(data); i++)
+		EXPECT_EQ(readData[i], data[i]) << "At index " << i;
+
+	EXPECT_EQ(file->read(readData, 1), 0);
+	EXPECT_TRUE(file->eos());
+
+	file->seek(-2, Common::SeekableReadStream::kOriginEnd);
+	EXPECT_EQ(file->pos(), 3);
+	EXPECT_FALSE(file->eos());
+	EXPECT_EQ(file->readByte(), data[3]);
+
+	EXPECT_THROW(file->seek(6), Common::Exception);
+
+	// A view into the mapping stays valid after the file is gone
+
+	Common::ScopedPtr<Common::MemoryReadStream> view(file->readStreamAt(1, 3));
+	EXPECT_THROW(file->readStreamAt(3, 3), Common::Exception);
+
+	file.reset();
+
+	ASSERT_EQ(view->size(), 3);
+	for (size_t i = 0; i < 3; i++)
+		EXPECT_EQ(view->readByte(), data[1 + i]) << "At index " << i;
+}
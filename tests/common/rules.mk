@@ -244,3 +244,13 @@ check_PROGRAMS                        += tests/common/test_boundingbox
 tests_common_test_boundingbox_SOURCES  = tests/common/boundingbox.cpp
 tests_common_test_boundingbox_LDADD    = $(common_LIBS)
 tests_common_test_boundingbox_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                    += tests/common/test_jobpool
+tests_common_test_jobpool_SOURCES  = tests/common/jobpool.cpp
+tests_common_test_jobpool_LDADD    = $(common_LIBS)
+tests_common_test_jobpool_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                      += tests/common/test_radixsort
+tests_common_test_radixsort_SOURCES  = tests/common/radixsort.cpp
+tests_common_test_radixsort_LDADD    = $(common_LIBS)
+tests_common_test_radixsort_CXXFLAGS = $(test_CXXFLAGS)
@@ -0,0 +1,225 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our bounding volume hierarchy.
+ */
+
+#include <algorithm>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/matrix4x4.h"
+#include "src/common/boundingbox.h"
+#include "src/common/ptrvector.h"
+
+#include "src/graphics/bvh.h"
+#include "src/graphics/frustum.h"
+
+static const size_t kItemCount = 500;
+
+static uint32 kRandom = 0;
+
+static float getRandom(float min, float max) {
+	kRandom = kRandom * 1664525 + 1013904223;
+
+	return min + (max - min) * ((kRandom >> 8) / 16777216.0f);
+}
+
+/** Random boxes. Every tenth item doesn't have any. */
+static void createBoxes(Common::PtrVector<Common::BoundingBox> &boxes,
+                        std::vector<const Common::BoundingBox *> &bounds) {
+
+	boxes.clear();
+	bounds.clear();
+
+	for (size_t i = 0; i < kItemCount; i++) {
+		if ((i % 10) == 9) {
+			bounds.push_back(0);
+			continue;
+		}
+
+		const float x = getRandom(-100.0f, 100.0f), y = getRandom(-100.0f, 100.0f), z = getRandom(-100.0f, 100.0f);
+
+		boxes.push_back(new Common::BoundingBox);
+		boxes.back()->add(x, y, z);
+		boxes.back()->add(x + getRandom(0.1f, 5.0f), y + getRandom(0.1f, 5.0f), z + getRandom(0.1f, 5.0f));
+
+		bounds.push_back(boxes.back());
+	}
+}
+
+static void moveBoxes(Common::PtrVector<Common::BoundingBox> &boxes) {
+	for (Common::PtrVector<Common::BoundingBox>::iterator b = boxes.begin(); b != boxes.end(); ++b) {
+		(*b)->translate(getRandom(-20.0f, 20.0f), getRandom(-20.0f, 20.0f), getRandom(-20.0f, 20.0f));
+		(*b)->absolutize();
+	}
+}
+
+static Graphics::Frustum createFrustum() {
+	Common::Matrix4x4 projection;
+	projection.perspective(60.0f, 4.0f / 3.0f, 1.0f, 150.0f);
+
+	Common::Matrix4x4 modelview;
+	modelview.rotate(30.0f, 0.0f, 1.0f, 0.0f);
+	modelview.translate(10.0f, -5.0f, 20.0f);
+
+	Graphics::Frustum frustum;
+	frustum.set(projection * modelview);
+
+	return frustum;
+}
+
+static void checkCull(const Graphics::BoundingVolumeHierarchy &bvh,
+                      const std::vector<const Common::BoundingBox *> &bounds) {
+
+	const Graphics::Frustum frustum = createFrustum();
+
+	std::vector<bool> visible;
+	bvh.cull(frustum, visible);
+
+	ASSERT_EQ(visible.size(), bounds.size());
+
+	size_t visibleCount = 0;
+	for (size_t i = 0; i < bounds.size(); i++) {
+		bool expected = true;
+
+		if (bounds[i]) {
+			float min[3], max[3];
+			bounds[i]->getMin(min[0], min[1], min[2]);
+			bounds[i]->getMax(max[0], max[1], max[2]);
+
+			expected = frustum.contains(min, max) != Graphics::Frustum::kContainmentOutside;
+		}
+
+		EXPECT_EQ(visible[i], expected) << "At item " << i;
+
+		visibleCount += visible[i] ? 1 : 0;
+	}
+
+	// Make sure we actually culled something, and something remained
+	EXPECT_GT(visibleCount, kItemCount / 10);
+	EXPECT_LT(visibleCount, kItemCount);
+}
+
+static void checkIntersect(const Graphics::BoundingVolumeHierarchy &bvh,
+                           const std::vector<const Common::BoundingBox *> &bounds) {
+
+	size_t hits = 0;
+
+	for (int n = 0; n < 100; n++) {
+		const float x1 = getRandom(-100.0f, 100.0f), y1 = getRandom(-100.0f, 100.0f), z1 = -200.0f;
+		const float x2 = getRandom(-100.0f, 100.0f), y2 = getRandom(-100.0f, 100.0f), z2 =  200.0f;
+
+		std::vector<size_t> items;
+		bvh.intersect(x1, y1, z1, x2, y2, z2, items);
+
+		std::sort(items.begin(), items.end());
+
+		for (size_t i = 0; i < bounds.size(); i++) {
+			const bool found = std::binary_search(items.begin(), items.end(), i);
+
+			if (!bounds[i]) {
+				EXPECT_TRUE(found) << "At item " << i;
+				continue;
+			}
+
+			if (bounds[i]->isIn(x1, y1, z1, x2, y2, z2)) {
+				EXPECT_TRUE(found) << "At item " << i;
+				hits++;
+			}
+		}
+
+		// Not much more than the actual hits
+		EXPECT_LT(items.size(), kItemCount / 4);
+	}
+
+	EXPECT_GT(hits, 0);
+}
+
+GTEST_TEST(BoundingVolumeHierarchy, empty) {
+	Graphics::BoundingVolumeHierarchy bvh;
+
+	std::vector<const Common::BoundingBox *> bounds;
+	bvh.build(bounds);
+
+	EXPECT_EQ(bvh.getItemCount(), 0);
+
+	std::vector<bool> visible;
+	bvh.cull(createFrustum(), visible);
+	EXPECT_TRUE(visible.empty());
+
+	std::vector<size_t> items;
+	bvh.intersect(0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, items);
+	EXPECT_TRUE(items.empty());
+}
+
+GTEST_TEST(BoundingVolumeHierarchy, cull) {
+	kRandom = 0;
+
+	Common::PtrVector<Common::BoundingBox> boxes;
+	std::vector<const Common::BoundingBox *> bounds;
+	createBoxes(boxes, bounds);
+
+	Graphics::BoundingVolumeHierarchy bvh;
+	bvh.build(bounds);
+
+	EXPECT_EQ(bvh.getItemCount(), kItemCount);
+
+	checkCull(bvh, bounds);
+}
+
+GTEST_TEST(BoundingVolumeHierarchy, intersect) {
+	kRandom = 0;
+
+	Common::PtrVector<Common::BoundingBox> boxes;
+	std::vector<const Common::BoundingBox *> bounds;
+	createBoxes(boxes, bounds);
+
+	Graphics::BoundingVolumeHierarchy bvh;
+	bvh.build(bounds);
+
+	checkIntersect(bvh, bounds);
+}
+
+GTEST_TEST(BoundingVolumeHierarchy, refit) {
+	kRandom = 0;
+
+	Common::PtrVector<Common::BoundingBox> boxes;
+	std::vector<const Common::BoundingBox *> bounds;
+	createBoxes(boxes, bounds);
+
+	Graphics::BoundingVolumeHierarchy bvh;
+	bvh.build(bounds);
+
+	moveBoxes(boxes);
+	ASSERT_TRUE(bvh.refit(bounds));
+
+	checkCull(bvh, bounds);
+	checkIntersect(bvh, bounds);
+
+	// Items losing their bounds need a rebuild
+	bounds[0] = 0;
+	EXPECT_FALSE(bvh.refit(bounds));
+
+	bounds.pop_back();
+	EXPECT_FALSE(bvh.refit(bounds));
+}
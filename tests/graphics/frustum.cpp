@@ -0,0 +1,97 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our view frustum.
+ */
+
+#include "gtest/gtest.h"
+
+#include "src/common/matrix4x4.h"
+
+#include "src/graphics/frustum.h"
+
+static Graphics::Frustum::Containment contains(const Graphics::Frustum &frustum,
+                                               float x1, float y1, float z1, float x2, float y2, float z2) {
+
+	const float min[3] = { x1, y1, z1 };
+	const float max[3] = { x2, y2, z2 };
+
+	return frustum.contains(min, max);
+}
+
+GTEST_TEST(Frustum, empty) {
+	const Graphics::Frustum frustum;
+
+	EXPECT_EQ(contains(frustum, -1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f), Graphics::Frustum::kContainmentInside);
+	EXPECT_EQ(contains(frustum, 1000.0f, 1000.0f, 1000.0f, 1001.0f, 1001.0f, 1001.0f), Graphics::Frustum::kContainmentInside);
+}
+
+GTEST_TEST(Frustum, perspective) {
+	Common::Matrix4x4 projection;
+	projection.perspective(90.0f, 1.0f, 1.0f, 100.0f);
+
+	Graphics::Frustum frustum;
+	frustum.set(projection);
+
+	// Looking down the negative z axis
+	EXPECT_EQ(contains(frustum, -1.0f, -1.0f, -11.0f, 1.0f, 1.0f, -9.0f), Graphics::Frustum::kContainmentInside);
+	EXPECT_EQ(contains(frustum, -1.0f, -1.0f,   9.0f, 1.0f, 1.0f, 11.0f), Graphics::Frustum::kContainmentOutside);
+
+	// Closer than the near plane, farther than the far plane
+	EXPECT_EQ(contains(frustum, -0.1f, -0.1f,  -0.8f, 0.1f, 0.1f,  -0.5f), Graphics::Frustum::kContainmentOutside);
+	EXPECT_EQ(contains(frustum, -1.0f, -1.0f, -120.0f, 1.0f, 1.0f, -110.0f), Graphics::Frustum::kContainmentOutside);
+	EXPECT_EQ(contains(frustum, -1.0f, -1.0f, -110.0f, 1.0f, 1.0f, -90.0f), Graphics::Frustum::kContainmentIntersect);
+
+	// To the sides of the 90 degree field of view
+	EXPECT_EQ(contains(frustum,  12.0f, -1.0f, -11.0f,  14.0f, 1.0f, -9.0f), Graphics::Frustum::kContainmentOutside);
+	EXPECT_EQ(contains(frustum, -14.0f, -1.0f, -11.0f, -12.0f, 1.0f, -9.0f), Graphics::Frustum::kContainmentOutside);
+	EXPECT_EQ(contains(frustum,   9.0f, -1.0f, -11.0f,  11.0f, 1.0f, -9.0f), Graphics::Frustum::kContainmentIntersect);
+	EXPECT_EQ(contains(frustum, -1.0f,  12.0f, -11.0f, 1.0f,  14.0f, -9.0f), Graphics::Frustum::kContainmentOutside);
+	EXPECT_EQ(contains(frustum, -1.0f, -14.0f, -11.0f, 1.0f, -12.0f, -9.0f), Graphics::Frustum::kContainmentOutside);
+}
+
+GTEST_TEST(Frustum, modelview) {
+	Common::Matrix4x4 projection;
+	projection.perspective(90.0f, 1.0f, 1.0f, 100.0f);
+
+	// Turned around and moved, now looking down the positive z axis from z = 50
+	Common::Matrix4x4 modelview;
+	modelview.rotate(180.0f, 0.0f, 1.0f, 0.0f);
+	modelview.translate(0.0f, 0.0f, -50.0f);
+
+	Graphics::Frustum frustum;
+	frustum.set(projection * modelview);
+
+	EXPECT_EQ(contains(frustum, -1.0f, -1.0f, 59.0f, 1.0f, 1.0f, 61.0f), Graphics::Frustum::kContainmentInside);
+	EXPECT_EQ(contains(frustum, -1.0f, -1.0f, 39.0f, 1.0f, 1.0f, 41.0f), Graphics::Frustum::kContainmentOutside);
+}
+
+GTEST_TEST(Frustum, ortho) {
+	Common::Matrix4x4 projection;
+	projection.ortho(-10.0f, 10.0f, -10.0f, 10.0f, 0.0f, 100.0f);
+
+	Graphics::Frustum frustum;
+	frustum.set(projection);
+
+	EXPECT_EQ(contains(frustum, -9.0f, -9.0f, -99.0f, 9.0f, 9.0f, -1.0f), Graphics::Frustum::kContainmentInside);
+	EXPECT_EQ(contains(frustum, 11.0f, -9.0f, -50.0f, 12.0f, 9.0f, -40.0f), Graphics::Frustum::kContainmentOutside);
+	EXPECT_EQ(contains(frustum,  9.0f, -9.0f, -50.0f, 12.0f, 9.0f, -40.0f), Graphics::Frustum::kContainmentIntersect);
+}
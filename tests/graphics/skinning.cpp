@@ -0,0 +1,235 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our CPU skinning.
+ */
+
+#include <cmath>
+#include <cstring>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/matrix4x4.h"
+
+#include "src/graphics/skinning.h"
+
+static const uint32 kVertexCount = 257;
+static const uint32 kBoneCount   =  17;
+
+static uint32 kRandom = 0;
+
+static float getRandom(float min, float max) {
+	kRandom = kRandom * 1664525 + 1013904223;
+
+	return min + (max - min) * ((kRandom >> 8) / 16777216.0f);
+}
+
+static Common::Matrix4x4 getRandomTransform() {
+	Common::Matrix4x4 m;
+
+	m.translate(getRandom(-2.0f, 2.0f), getRandom(-2.0f, 2.0f), getRandom(-2.0f, 2.0f));
+	m.rotate(getRandom(-180.0f, 180.0f), getRandom(-1.0f, 1.0f), getRandom(-1.0f, 1.0f), getRandom(0.1f, 1.0f));
+
+	return m;
+}
+
+/** A skinned mesh, with the separate transformations the model code starts out with. */
+struct TestSkin {
+	Common::Matrix4x4 transform;
+
+	std::vector<Common::Matrix4x4> invBindPoses;
+	std::vector<Common::Matrix4x4> boneTransforms;
+
+	std::vector<float> boneIDs;
+	std::vector<float> boneWeights;
+
+	std::vector<float> positions;
+	std::vector<float> normals;
+
+	TestSkin() {
+		kRandom = 0;
+
+		transform = getRandomTransform();
+
+		for (uint32 i = 0; i < kBoneCount; i++) {
+			invBindPoses.push_back(getRandomTransform().getInverse());
+			boneTransforms.push_back(getRandomTransform());
+		}
+
+		for (uint32 i = 0; i < kVertexCount; i++) {
+			// Between 1 and 4 bones, the rest of the slots unused
+			const uint32 count = 1 + (i % 4);
+
+			float weightSum = 0.0f;
+			for (uint32 j = 0; j < 4; j++) {
+				boneIDs.push_back((j < count) ? (int)((i * 7 + j * 5) % kBoneCount) : -1.0f);
+				boneWeights.push_back((j < count) ? getRandom(0.1f, 1.0f) : 0.5f);
+
+				if (j < count)
+					weightSum += boneWeights.back();
+			}
+
+			for (uint32 j = 0; j < count; j++)
+				boneWeights[4 * i + j] /= weightSum;
+
+			for (uint32 j = 0; j < 3; j++)
+				positions.push_back(getRandom(-1.0f, 1.0f));
+
+			float n[3] = { getRandom(-1.0f, 1.0f), getRandom(-1.0f, 1.0f), getRandom(0.1f, 1.0f) };
+			const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+			for (uint32 j = 0; j < 3; j++)
+				normals.push_back(n[j] / length);
+		}
+	}
+
+	/** Combine the transformations into the bone palette. */
+	void getPalette(std::vector<float> &palette) const {
+		const Common::Matrix4x4 invTransform = transform.getInverse();
+
+		palette.resize(16 * kBoneCount);
+		for (uint32 i = 0; i < kBoneCount; i++) {
+			Common::Matrix4x4 bone(invTransform);
+			bone *= boneTransforms[i];
+			bone *= invBindPoses[i];
+			bone *= transform;
+
+			std::memcpy(&palette[16 * i], bone.get(), 16 * sizeof(float));
+		}
+	}
+
+	/** Skin the vertex positions one influence at a time, like the model code used to. */
+	void skinReference(std::vector<float> &out) const {
+		const Common::Matrix4x4 invTransform = transform.getInverse();
+
+		out.resize(3 * kVertexCount);
+		for (uint32 i = 0; i < kVertexCount; i++) {
+			float *v = &out[3 * i];
+			v[0] = v[1] = v[2] = 0.0f;
+
+			for (uint32 j = 0; j < 4; j++) {
+				const int index = (int)boneIDs[4 * i + j];
+				if (index == -1)
+					continue;
+
+				float rv[3], tv[3];
+
+				transform.multiply(&positions[3 * i], rv);
+				invBindPoses[index].multiply(rv, tv);
+				boneTransforms[index].multiply(tv, rv);
+				invTransform.multiply(rv, tv);
+
+				v[0] += tv[0] * boneWeights[4 * i + j];
+				v[1] += tv[1] * boneWeights[4 * i + j];
+				v[2] += tv[2] * boneWeights[4 * i + j];
+			}
+		}
+	}
+};
+
+GTEST_TEST(Skinning, influences) {
+	static const float kBoneIDs[]     = { 0.0f, 2.0f, -1.0f, 3.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+	static const float kBoneWeights[] = { 0.5f, 0.5f,  0.5f, 0.5f, 0.1f, 0.2f, 0.3f, 0.4f };
+
+	Graphics::SkinInfluences influences;
+	influences.set(kBoneIDs, kBoneWeights, 2, 3);
+
+	EXPECT_EQ(influences.vertexCount, 2);
+	EXPECT_EQ(influences.boneCount, 3);
+
+	static const uint16 kBones[]   = { 0, 2, 0, 0, 1, 1, 1, 1 };
+	static const float  kWeights[] = { 0.5f, 0.5f, 0.0f, 0.0f, 0.1f, 0.2f, 0.3f, 0.4f };
+
+	ASSERT_EQ(influences.bones.size(), ARRAYSIZE(kBones));
+	ASSERT_EQ(influences.weights.size(), ARRAYSIZE(kWeights));
+
+	for (size_t i = 0; i < ARRAYSIZE(kBones); i++) {
+		EXPECT_EQ(influences.bones[i], kBones[i]) << "At index " << i;
+		EXPECT_EQ(influences.weights[i], kWeights[i]) << "At index " << i;
+	}
+}
+
+GTEST_TEST(Skinning, positions) {
+	const TestSkin skin;
+
+	std::vector<float> reference;
+	skin.skinReference(reference);
+
+	std::vector<float> palette;
+	skin.getPalette(palette);
+
+	Graphics::SkinInfluences influences;
+	influences.set(&skin.boneIDs[0], &skin.boneWeights[0], kVertexCount, kBoneCount);
+
+	// Interleaved with other vertex data, which needs to stay untouched
+	std::vector<float> out(5 * kVertexCount, 23.0f);
+	Graphics::skinVertices(influences, &palette[0], &skin.positions[0], 0, &out[0], 5);
+
+	for (uint32 i = 0; i < kVertexCount; i++) {
+		for (uint32 j = 0; j < 3; j++)
+			EXPECT_NEAR(out[5 * i + j], reference[3 * i + j], 1e-4f) << "At vertex " << i << ", " << j;
+
+		EXPECT_EQ(out[5 * i + 3], 23.0f) << "At vertex " << i;
+		EXPECT_EQ(out[5 * i + 4], 23.0f) << "At vertex " << i;
+	}
+}
+
+GTEST_TEST(Skinning, normals) {
+	const TestSkin skin;
+
+	std::vector<float> reference;
+	skin.skinReference(reference);
+
+	std::vector<float> palette;
+	skin.getPalette(palette);
+
+	Graphics::SkinInfluences influences;
+	influences.set(&skin.boneIDs[0], &skin.boneWeights[0], kVertexCount, kBoneCount);
+
+	std::vector<float> out(8 * kVertexCount, 23.0f);
+	Graphics::skinVertices(influences, &palette[0], &skin.positions[0], &skin.normals[0], &out[0], 8);
+
+	for (uint32 i = 0; i < kVertexCount; i++) {
+		for (uint32 j = 0; j < 3; j++)
+			EXPECT_NEAR(out[8 * i + j], reference[3 * i + j], 1e-4f) << "At vertex " << i << ", " << j;
+
+		const float *n = &out[8 * i + 3];
+		EXPECT_NEAR(n[0] * n[0] + n[1] * n[1] + n[2] * n[2], 1.0f, 1e-4f) << "At vertex " << i;
+
+		// A single bone just rotates the normal
+		if (skin.boneIDs[4 * i + 1] == -1.0f) {
+			const Common::Matrix4x4 bone(&palette[16 * (int)skin.boneIDs[4 * i]]);
+
+			const Common::Vector3 normal(skin.normals[3 * i + 0], skin.normals[3 * i + 1], skin.normals[3 * i + 2]);
+			const Common::Vector3 rotated = bone.vectorRotate(normal);
+
+			EXPECT_NEAR(n[0], rotated._x, 1e-4f) << "At vertex " << i;
+			EXPECT_NEAR(n[1], rotated._y, 1e-4f) << "At vertex " << i;
+			EXPECT_NEAR(n[2], rotated._z, 1e-4f) << "At vertex " << i;
+		}
+
+		EXPECT_EQ(out[8 * i + 6], 23.0f) << "At vertex " << i;
+		EXPECT_EQ(out[8 * i + 7], 23.0f) << "At vertex " << i;
+	}
+}
@@ -0,0 +1,192 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our S3TC DXTn decompression.
+ */
+
+#include <cstring>
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+
+#include "src/graphics/images/s3tc.h"
+
+/** A straight-forward, pixel by pixel decoder, to check the block-based one against. */
+static void decodeReference(std::vector<byte> &dest, const std::vector<byte> &src,
+                            int format, uint32 width, uint32 height, uint32 pitch) {
+
+	const size_t blockSize = (format == 1) ? 8 : 16;
+	const uint32 blocksX   = (width + 3) / 4;
+
+	for (uint32 y = 0; y < height; y++) {
+		for (uint32 x = 0; x < width; x++) {
+			const byte *block = &src[((y / 4) * blocksX + (x / 4)) * blockSize];
+			const byte *color = (format == 1) ? block : (block + 8);
+
+			const uint32 n = (y % 4) * 4 + (x % 4);
+
+			const uint16 c[2] = { READ_LE_UINT16(color), READ_LE_UINT16(color + 2) };
+
+			uint32 rgba[4][4];
+			for (int i = 0; i < 2; i++) {
+				rgba[i][0] = ((c[i] >> 11) & 0x1F) << 3;
+				rgba[i][1] = ((c[i] >>  5) & 0x3F) << 2;
+				rgba[i][2] = ( c[i]        & 0x1F) << 3;
+				rgba[i][3] = (format == 1) ? 255 : 0;
+			}
+
+			for (int i = 0; i < 4; i++) {
+				if ((format != 1) || (c[0] > c[1])) {
+					rgba[2][i] = (2 * rgba[0][i] + rgba[1][i]) / 3;
+					rgba[3][i] = (rgba[0][i] + 2 * rgba[1][i]) / 3;
+				} else {
+					rgba[2][i] = (rgba[0][i] + rgba[1][i]) / 2;
+					rgba[3][i] = 0;
+				}
+			}
+
+			byte *pixel = &dest[y * pitch + x * 4];
+
+			const uint32 index = (color[4 + n / 4] >> (2 * (n % 4))) & 3;
+			for (int i = 0; i < 4; i++)
+				pixel[i] = rgba[index][i];
+
+			if (format == 3) {
+				pixel[3] = ((block[n / 2] >> (4 * (n % 2))) & 0x0F) << 4;
+			} else if (format == 5) {
+				uint64 bits = 0;
+				for (int i = 0; i < 6; i++)
+					bits |= ((uint64) block[2 + i]) << (8 * i);
+
+				const uint32 alphaIndex = (bits >> (3 * n)) & 7;
+
+				const uint32 a0 = block[0], a1 = block[1];
+				if      (alphaIndex == 0)
+					pixel[3] = a0;
+				else if (alphaIndex == 1)
+					pixel[3] = a1;
+				else if (a0 > a1)
+					pixel[3] = ((8 - alphaIndex) * a0 + (alphaIndex - 1) * a1 + 3) / 7;
+				else if (alphaIndex < 6)
+					pixel[3] = ((6 - alphaIndex) * a0 + (alphaIndex - 1) * a1 + 2) / 5;
+				else
+					pixel[3] = (alphaIndex == 6) ? 0 : 255;
+			}
+		}
+	}
+}
+
+static void decode(std::vector<byte> &dest, const std::vector<byte> &src,
+                   int format, uint32 width, uint32 height, uint32 pitch) {
+
+	if      (format == 1)
+		Graphics::decompressDXT1(&dest[0], &src[0], src.size(), width, height, pitch);
+	else if (format == 3)
+		Graphics::decompressDXT3(&dest[0], &src[0], src.size(), width, height, pitch);
+	else if (format == 5)
+		Graphics::decompressDXT5(&dest[0], &src[0], src.size(), width, height, pitch);
+}
+
+static void testFormat(int format) {
+	static const uint32 kSizes[][2] = {
+		{ 1, 1 }, { 2, 2 }, { 3, 5 }, { 4, 4 }, { 8, 4 }, { 5, 9 }, { 16, 16 }, { 12, 20 }, { 64, 32 }
+	};
+
+	uint32 random = 0x8BADF00D;
+
+	for (size_t s = 0; s < ARRAYSIZE(kSizes); s++) {
+		const uint32 width  = kSizes[s][0];
+		const uint32 height = kSizes[s][1];
+
+		// Leave some room at the end of each row, to see that it's not written to
+		const uint32 pitch = width * 4 + 8;
+
+		const size_t blockSize = (format == 1) ? 8 : 16;
+		std::vector<byte> src(((width + 3) / 4) * ((height + 3) / 4) * blockSize);
+
+		for (size_t i = 0; i < src.size(); i++) {
+			random = random * 1664525 + 1013904223;
+			src[i] = random >> 24;
+		}
+
+		// Make sure we see both orderings of the endpoints, and equal endpoints
+		if (src.size() >= 3 * blockSize) {
+			std::memcpy(&src[blockSize - 8 + 2], &src[blockSize - 8], 2);
+			src[blockSize] = src[blockSize + 1] = 0x80;
+			src[2 * blockSize + 0] = 0x10;
+			src[2 * blockSize + 1] = 0xF0;
+		}
+
+		std::vector<byte> reference(pitch * height, 0xCD);
+		std::vector<byte> decoded  (pitch * height, 0xCD);
+
+		decodeReference(reference, src, format, width, height, pitch);
+		decode(decoded, src, format, width, height, pitch);
+
+		for (size_t i = 0; i < decoded.size(); i++)
+			EXPECT_EQ(decoded[i], reference[i]) << "DXT" << format << ", " << width << "x" << height << ", index " << i;
+	}
+}
+
+GTEST_TEST(S3TC, decompressDXT1) {
+	testFormat(1);
+}
+
+GTEST_TEST(S3TC, decompressDXT3) {
+	testFormat(3);
+}
+
+GTEST_TEST(S3TC, decompressDXT5) {
+	testFormat(5);
+}
+
+GTEST_TEST(S3TC, decompressDXT1Values) {
+	// Pure red and pure blue, interpolated in thirds; one row of each palette entry
+	static const byte data[8] = { 0x00, 0xF8, 0x1F, 0x00, 0x00, 0x55, 0xAA, 0xFF };
+	static const byte pixels[4][4] = {
+		{ 0xF8, 0x00, 0x00, 0xFF }, { 0x00, 0x00, 0xF8, 0xFF }, { 0xA5, 0x00, 0x52, 0xFF }, { 0x52, 0x00, 0xA5, 0xFF }
+	};
+
+	byte decoded[4 * 4 * 4];
+	Graphics::decompressDXT1(decoded, data, sizeof(data), 4, 4, 16);
+
+	for (size_t y = 0; y < 4; y++)
+		for (size_t x = 0; x < 4; x++)
+			for (size_t i = 0; i < 4; i++)
+				EXPECT_EQ(decoded[y * 16 + x * 4 + i], pixels[y][i]) << "At " << x << ", " << y << ", " << i;
+}
+
+GTEST_TEST(S3TC, decompressTooSmall) {
+	static const byte data[16] = { 0 };
+
+	byte decoded[12 * 4 * 4];
+
+	EXPECT_THROW(Graphics::decompressDXT1(decoded, data, sizeof(data), 12, 4, 48), Common::Exception);
+	EXPECT_THROW(Graphics::decompressDXT3(decoded, data, sizeof(data),  8, 4, 32), Common::Exception);
+	EXPECT_THROW(Graphics::decompressDXT5(decoded, data, sizeof(data),  8, 4, 32), Common::Exception);
+
+	EXPECT_NO_THROW(Graphics::decompressDXT1(decoded, data, sizeof(data), 8, 4, 32));
+	EXPECT_NO_THROW(Graphics::decompressDXT5(decoded, data, sizeof(data), 4, 4, 16));
+}
@@ -33,11 +33,17 @@ test_CXXFLAGS = $(GTEST_FLAGS) $(AM_CXXFLAGS)
 
 noinst_HEADERS += \
     tests/skip.h \
+    tests/benchmark/benchmark.h \
+    tests/benchmark/gff4builder.h \
+    tests/benchmark/heap.h \
     $(EMPTY)
 
 include tests/version/rules.mk
 include tests/common/rules.mk
 include tests/aurora/rules.mk
+include tests/graphics/rules.mk
 include tests/images/rules.mk
+include tests/sound/rules.mk
+include tests/benchmark/rules.mk
 
 TESTS += $(check_PROGRAMS)
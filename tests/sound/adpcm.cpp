@@ -0,0 +1,70 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our ADPCM decoders.
+ */
+
+#include "gtest/gtest.h"
+
+#include "src/common/scopedptr.h"
+#include "src/common/memreadstream.h"
+
+#include "src/sound/audiostream.h"
+#include "src/sound/decoders/adpcm.h"
+
+static const size_t kBlockAlign = 64;
+static const size_t kBlocks     = 4;
+
+static const int16 kSentinel = 0x7EEF;
+
+GTEST_TEST(ADPCM, msNoOverrun) {
+	static const int    kChannels = 2;
+	static const size_t kRead     = 5;
+
+	byte data[kBlockAlign * kBlocks];
+	for (size_t i = 0; i < sizeof(data); i++)
+		data[i] = (byte) (i * 7);
+
+	Common::ScopedPtr<Sound::RewindableAudioStream>
+		stream(Sound::makeADPCMStream(new Common::MemoryReadStream(data, sizeof(data)), true, sizeof(data),
+		                              Sound::kADPCMMS, 22050, kChannels, kBlockAlign));
+	ASSERT_TRUE(stream);
+
+	// Read in odd steps, so that the block headers don't line up with the reads
+	size_t total = 0;
+	while (!stream->endOfData()) {
+		int16 buffer[kRead + 4];
+		for (size_t i = 0; i < ARRAYSIZE(buffer); i++)
+			buffer[i] = kSentinel;
+
+		const size_t count = stream->readBuffer(buffer, kRead);
+		ASSERT_LE(count, kRead);
+		ASSERT_GT(count, 0U);
+
+		for (size_t i = kRead; i < ARRAYSIZE(buffer); i++)
+			EXPECT_EQ(buffer[i], kSentinel) << "At index " << i;
+
+		total += count;
+	}
+
+	// Each block has a header with two samples per channel, then two samples per byte
+	EXPECT_EQ(total, kBlocks * (2 * kChannels + (kBlockAlign - 7 * kChannels) * 2));
+}
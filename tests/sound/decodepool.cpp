@@ -0,0 +1,226 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our audio decoding thread pool.
+ */
+
+#include <SDL_timer.h>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/ptrvector.h"
+
+#include "src/sound/audiostream.h"
+#include "src/sound/decodepool.h"
+
+/** An audio stream producing an increasing sequence of samples. */
+class SequenceStream : public Sound::AudioStream {
+public:
+	SequenceStream(size_t length, int channels = 1, size_t failAt = SIZE_MAX, size_t maxRead = SIZE_MAX) :
+		_length(length), _channels(channels), _failAt(failAt), _maxRead(maxRead), _pos(0) {
+	}
+
+	size_t readBuffer(int16 *buffer, const size_t numSamples) {
+		if ((_pos + numSamples) > _failAt)
+			return kSizeInvalid;
+
+		const size_t count = MIN(MIN(numSamples, _maxRead), _length - _pos);
+		for (size_t i = 0; i < count; i++)
+			buffer[i] = (int16) (_pos + i);
+
+		_pos += count;
+		return count;
+	}
+
+	int getChannels() const {
+		return _channels;
+	}
+
+	int getRate() const {
+		return 22050;
+	}
+
+	bool endOfData() const {
+		return _pos >= _length;
+	}
+
+private:
+	size_t _length;
+	int    _channels;
+	size_t _failAt;
+	size_t _maxRead;
+	size_t _pos;
+};
+
+/** Read the whole decoded stream, checking that the sequence is intact. */
+static bool readSequence(Sound::DecodedStream &stream, Sound::DecodePool &pool, size_t &read) {
+	bool ordered = true;
+
+	read = 0;
+	while (!stream.endOfStream()) {
+		int16 buffer[1000];
+
+		const size_t n = stream.read(buffer, 1000);
+		for (size_t i = 0; i < n; i++)
+			ordered = ordered && (buffer[i] == (int16) (read + i));
+
+		read += n;
+		if (n > 0)
+			pool.wake();
+		else
+			SDL_Delay(1);
+	}
+
+	return ordered;
+}
+
+GTEST_TEST(DecodePool, prime) {
+	Sound::DecodePool pool;
+
+	SequenceStream audio(100000);
+	Sound::DecodedStream *stream = pool.add(audio, 8192);
+	ASSERT_NE(stream, static_cast<Sound::DecodedStream *>(0));
+
+	// Without workers, only the first ring buffer's worth is decoded
+	EXPECT_EQ(stream->getAvailable(), 8192);
+	EXPECT_FALSE(stream->endOfStream());
+
+	pool.remove(stream);
+}
+
+GTEST_TEST(DecodePool, primeShortReads) {
+	Sound::DecodePool pool;
+
+	// Reads returning less than requested don't mean the stream ran dry
+	SequenceStream audio(100000, 1, SIZE_MAX, 100);
+	Sound::DecodedStream *stream = pool.add(audio, 8192);
+	ASSERT_NE(stream, static_cast<Sound::DecodedStream *>(0));
+
+	// Priming goes on until there's less than a chunk free
+	EXPECT_GT(stream->getAvailable(), 8192 - 4096);
+
+	pool.remove(stream);
+}
+
+GTEST_TEST(DecodePool, shortStream) {
+	Sound::DecodePool pool;
+
+	SequenceStream audio(1000);
+	Sound::DecodedStream *stream = pool.add(audio, 8192);
+
+	size_t read = 0;
+	EXPECT_TRUE(readSequence(*stream, pool, read));
+	EXPECT_EQ(read, 1000);
+
+	EXPECT_FALSE(stream->hasFailed());
+
+	pool.remove(stream);
+}
+
+GTEST_TEST(DecodePool, decode) {
+	Sound::DecodePool pool;
+	pool.init(2);
+
+	EXPECT_EQ(pool.getThreadCount(), 2);
+
+	SequenceStream audio(200000);
+	Sound::DecodedStream *stream = pool.add(audio, 4096);
+
+	size_t read = 0;
+	EXPECT_TRUE(readSequence(*stream, pool, read));
+	EXPECT_EQ(read, 200000);
+
+	pool.remove(stream);
+}
+
+GTEST_TEST(DecodePool, frames) {
+	Sound::DecodePool pool;
+	pool.init(1);
+
+	// Only whole 5.1 sample frames may ever end up in the ring buffer
+	SequenceStream audio(6 * 10000, 6);
+	Sound::DecodedStream *stream = pool.add(audio, 1000);
+
+	EXPECT_EQ(stream->getAvailable() % 6, 0);
+
+	size_t read = 0;
+	EXPECT_TRUE(readSequence(*stream, pool, read));
+	EXPECT_EQ(read, 6 * 10000);
+
+	pool.remove(stream);
+}
+
+GTEST_TEST(DecodePool, multipleStreams) {
+	Sound::DecodePool pool;
+	pool.init(3);
+
+	static const size_t kStreamCount = 8;
+
+	Common::PtrVector<SequenceStream> audio;
+	std::vector<Sound::DecodedStream *> streams;
+
+	for (size_t i = 0; i < kStreamCount; i++) {
+		audio.push_back(new SequenceStream(50000 + i * 1000));
+		streams.push_back(pool.add(*audio.back(), 2048));
+	}
+
+	for (size_t i = 0; i < kStreamCount; i++) {
+		size_t read = 0;
+		EXPECT_TRUE(readSequence(*streams[i], pool, read)) << "At stream " << i;
+		EXPECT_EQ(read, 50000 + i * 1000) << "At stream " << i;
+
+		pool.remove(streams[i]);
+	}
+}
+
+GTEST_TEST(DecodePool, failure) {
+	Sound::DecodePool pool;
+	pool.init(1);
+
+	SequenceStream audio(100000, 1, 10000);
+	Sound::DecodedStream *stream = pool.add(audio, 4096);
+
+	size_t read = 0;
+	EXPECT_TRUE(readSequence(*stream, pool, read));
+	EXPECT_GT(read, 0);
+	EXPECT_LE(read, 10000);
+
+	EXPECT_TRUE(stream->hasFailed());
+
+	pool.remove(stream);
+}
+
+GTEST_TEST(DecodePool, removeWhileDecoding) {
+	Sound::DecodePool pool;
+	pool.init(2);
+
+	for (size_t i = 0; i < 50; i++) {
+		SequenceStream audio(1000000);
+		Sound::DecodedStream *stream = pool.add(audio, 4096);
+
+		int16 buffer[1000];
+		stream->read(buffer, 1000);
+		pool.wake();
+
+		pool.remove(stream);
+	}
+}
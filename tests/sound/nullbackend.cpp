@@ -0,0 +1,132 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our headless audio output backend.
+ */
+
+#include "gtest/gtest.h"
+
+#include "src/common/error.h"
+
+#include "src/sound/nullbackend.h"
+
+static const int16 kSamples[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+
+GTEST_TEST(NullBackend, manual) {
+	Sound::NullBackend backend(Sound::NullBackend::kModeManual);
+	backend.init();
+
+	const Sound::AudioBackend::Source source = backend.createSource();
+	const Sound::AudioBackend::Buffer buffer1 = backend.createBuffer();
+	const Sound::AudioBackend::Buffer buffer2 = backend.createBuffer();
+
+	// 1000 mono samples per second => 8 samples take 8ms
+	backend.bufferData(buffer1, kSamples, sizeof(kSamples), 1, 1000);
+	backend.bufferData(buffer2, kSamples, sizeof(kSamples), 1, 1000);
+
+	backend.queueBuffer(source, buffer1);
+	backend.queueBuffer(source, buffer2);
+
+	EXPECT_EQ(backend.getSourceState(source), Sound::AudioBackend::kSourceInitial);
+	EXPECT_EQ(backend.getQueuedBuffers(source), 2);
+	EXPECT_EQ(backend.getProcessedBuffers(source), 0);
+
+	// Not playing yet
+	backend.advance(100.0);
+	EXPECT_EQ(backend.getSamplesPlayed(), 0);
+
+	backend.playSource(source);
+	EXPECT_EQ(backend.getSourceState(source), Sound::AudioBackend::kSourcePlaying);
+
+	backend.advance(4.0);
+	EXPECT_EQ(backend.getSamplesPlayed(), 4);
+	EXPECT_EQ(backend.getSourceOffset(source), 8);
+	EXPECT_EQ(backend.getProcessedBuffers(source), 0);
+
+	backend.advance(6.0);
+	EXPECT_EQ(backend.getSamplesPlayed(), 10);
+	EXPECT_EQ(backend.getSourceOffset(source), 4);
+	EXPECT_EQ(backend.getProcessedBuffers(source), 1);
+
+	backend.pauseSource(source);
+	backend.advance(100.0);
+	EXPECT_EQ(backend.getSamplesPlayed(), 10);
+	EXPECT_EQ(backend.getSourceState(source), Sound::AudioBackend::kSourcePaused);
+
+	Sound::AudioBackend::Buffer unqueued[2] = { 0, 0 };
+	EXPECT_EQ(backend.unqueueBuffers(source, unqueued, 2), 1);
+	EXPECT_EQ(unqueued[0], buffer1);
+	EXPECT_EQ(backend.getQueuedBuffers(source), 1);
+
+	backend.playSource(source);
+	backend.advance(100.0);
+	EXPECT_EQ(backend.getSamplesPlayed(), 16);
+	EXPECT_EQ(backend.getSourceState(source), Sound::AudioBackend::kSourceStopped);
+	EXPECT_EQ(backend.getProcessedBuffers(source), 1);
+
+	backend.deinit();
+}
+
+GTEST_TEST(NullBackend, fast) {
+	Sound::NullBackend backend(Sound::NullBackend::kModeFast);
+	backend.init();
+
+	const Sound::AudioBackend::Source source = backend.createSource();
+	const Sound::AudioBackend::Buffer buffer = backend.createBuffer();
+
+	backend.bufferData(buffer, kSamples, sizeof(kSamples), 2, 44100);
+	backend.queueBuffer(source, buffer);
+	backend.playSource(source);
+
+	// Everything is played right away
+	EXPECT_EQ(backend.getSourceState(source), Sound::AudioBackend::kSourceStopped);
+	EXPECT_EQ(backend.getProcessedBuffers(source), 1);
+	EXPECT_EQ(backend.getSamplesPlayed(), 8);
+
+	backend.deinit();
+}
+
+GTEST_TEST(NullBackend, properties) {
+	Sound::NullBackend backend;
+	backend.init();
+
+	EXPECT_TRUE(backend.hasChannelCount(1));
+	EXPECT_TRUE(backend.hasChannelCount(2));
+	EXPECT_TRUE(backend.hasChannelCount(6));
+	EXPECT_FALSE(backend.hasChannelCount(3));
+
+	const Sound::AudioBackend::Source source = backend.createSource();
+
+	backend.setSourcePosition(source, 1.0f, 2.0f, 3.0f);
+
+	float x = 0.0f, y = 0.0f, z = 0.0f;
+	backend.getSourcePosition(source, x, y, z);
+
+	EXPECT_FLOAT_EQ(x, 1.0f);
+	EXPECT_FLOAT_EQ(y, 2.0f);
+	EXPECT_FLOAT_EQ(z, 3.0f);
+
+	backend.deleteSource(source);
+
+	EXPECT_THROW(backend.getSourceState(source), Common::Exception);
+
+	backend.deinit();
+}
@@ -0,0 +1,160 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our lock-free PCM ring buffer.
+ */
+
+#include <SDL_timer.h>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/thread.h"
+
+#include "src/sound/ringbuffer.h"
+
+GTEST_TEST(RingBuffer, capacity) {
+	Sound::RingBuffer ring1(1000);
+	EXPECT_EQ(ring1.getCapacity(), 1024);
+
+	Sound::RingBuffer ring2(1024);
+	EXPECT_EQ(ring2.getCapacity(), 1024);
+
+	EXPECT_EQ(ring2.getAvailable(), 0);
+	EXPECT_EQ(ring2.getFree(), 1024);
+}
+
+GTEST_TEST(RingBuffer, readWrite) {
+	Sound::RingBuffer ring(8);
+
+	const int16 in[] = { 1, 2, 3, 4, 5, 6 };
+	EXPECT_EQ(ring.write(in, 6), 6);
+
+	EXPECT_EQ(ring.getAvailable(), 6);
+	EXPECT_EQ(ring.getFree(), 2);
+
+	int16 out[8] = { 0 };
+	EXPECT_EQ(ring.read(out, 4), 4);
+
+	for (size_t i = 0; i < 4; i++)
+		EXPECT_EQ(out[i], in[i]) << "At index " << i;
+
+	EXPECT_EQ(ring.getAvailable(), 2);
+	EXPECT_EQ(ring.getFree(), 6);
+}
+
+GTEST_TEST(RingBuffer, wrapAround) {
+	Sound::RingBuffer ring(8);
+
+	const int16 in[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+	int16 out[8] = { 0 };
+
+	EXPECT_EQ(ring.write(in, 6), 6);
+	EXPECT_EQ(ring.read(out, 6), 6);
+
+	// These wrap around the end of the sample memory
+	EXPECT_EQ(ring.write(in, 7), 7);
+	EXPECT_EQ(ring.read(out, 8), 7);
+
+	for (size_t i = 0; i < 7; i++)
+		EXPECT_EQ(out[i], in[i]) << "At index " << i;
+}
+
+GTEST_TEST(RingBuffer, full) {
+	Sound::RingBuffer ring(8);
+
+	const int16 in[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+	int16 out[10] = { 0 };
+
+	EXPECT_EQ(ring.write(in, 10), 8);
+	EXPECT_EQ(ring.write(in, 10), 0);
+	EXPECT_EQ(ring.getFree(), 0);
+
+	EXPECT_EQ(ring.read(out, 10), 8);
+	EXPECT_EQ(ring.read(out, 10), 0);
+
+	for (size_t i = 0; i < 8; i++)
+		EXPECT_EQ(out[i], in[i]) << "At index " << i;
+}
+
+static const size_t kThreadSampleCount = 100000;
+
+/** Writes an increasing sequence of samples into a ring buffer. */
+class RingWriter : public Common::Thread {
+public:
+	RingWriter(Sound::RingBuffer &ring) : _ring(&ring) {
+	}
+
+	~RingWriter() {
+		destroyThread();
+	}
+
+private:
+	Sound::RingBuffer *_ring;
+
+	void threadMethod() {
+		int16 buffer[100];
+
+		size_t written = 0;
+		while ((written < kThreadSampleCount) && !_killThread) {
+			const size_t count = MIN<size_t>(100, kThreadSampleCount - written);
+			for (size_t i = 0; i < count; i++)
+				buffer[i] = (int16) (written + i);
+
+			size_t n = 0;
+			while ((n < count) && !_killThread) {
+				const size_t w = _ring->write(buffer + n, count - n);
+				if (w == 0)
+					SDL_Delay(1);
+
+				n += w;
+			}
+
+			written += count;
+		}
+	}
+};
+
+GTEST_TEST(RingBuffer, threaded) {
+	Sound::RingBuffer ring(1024);
+
+	RingWriter writer(ring);
+	ASSERT_TRUE(writer.createThread("RingWriter"));
+
+	bool ordered = true;
+
+	size_t read = 0;
+	while (read < kThreadSampleCount) {
+		int16 buffer[77];
+
+		const size_t n = ring.read(buffer, 77);
+		if (n == 0)
+			SDL_Delay(1);
+
+		for (size_t i = 0; i < n; i++)
+			ordered = ordered && (buffer[i] == (int16) (read + i));
+
+		read += n;
+	}
+
+	EXPECT_TRUE(ordered);
+	EXPECT_EQ(ring.getAvailable(), 0);
+}
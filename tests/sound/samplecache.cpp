@@ -0,0 +1,331 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our cache of short, fully decoded sounds.
+ */
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/scopedptr.h"
+
+#include "src/sound/audiostream.h"
+#include "src/sound/samplecache.h"
+
+/** A rewindable mono audio stream at 1000Hz, producing an increasing sequence of samples. */
+class SequenceStream : public Sound::RewindableAudioStream {
+public:
+	SequenceStream(size_t length, bool knownLength = true) :
+		_length(length), _knownLength(knownLength), _pos(0), _readCalls(0) {
+	}
+
+	size_t readBuffer(int16 *buffer, const size_t numSamples) {
+		_readCalls++;
+
+		const size_t count = MIN(numSamples, _length - _pos);
+		for (size_t i = 0; i < count; i++)
+			buffer[i] = (int16) (_pos + i);
+
+		_pos += count;
+		return count;
+	}
+
+	int getChannels() const {
+		return 1;
+	}
+
+	int getRate() const {
+		return 1000;
+	}
+
+	bool endOfData() const {
+		return _pos >= _length;
+	}
+
+	bool rewind() {
+		_pos = 0;
+		return true;
+	}
+
+	uint64 getLength() const {
+		return _knownLength ? _length : kInvalidLength;
+	}
+
+	/** Return the number of times readBuffer() was called. */
+	size_t getReadCalls() const {
+		return _readCalls;
+	}
+
+private:
+	size_t _length;
+	bool   _knownLength;
+	size_t _pos;
+	size_t _readCalls;
+};
+
+/** Read the whole stream, checking that it's the sequence of this length. */
+static bool isSequence(Sound::AudioStream &stream, size_t length) {
+	size_t read = 0;
+	bool ordered = true;
+
+	while (!stream.endOfStream()) {
+		int16 buffer[100];
+
+		const size_t n = stream.readBuffer(buffer, 100);
+		if ((n == 0) || (n == Sound::AudioStream::kSizeInvalid))
+			return false;
+
+		for (size_t i = 0; i < n; i++)
+			ordered = ordered && (buffer[i] == (int16) (read + i));
+
+		read += n;
+	}
+
+	return ordered && (read == length);
+}
+
+GTEST_TEST(SampleCache, disabled) {
+	Sound::SampleCache cache;
+	cache.setMaxDuration(1000);
+
+	Sound::AudioStream *stream = new SequenceStream(100);
+	Common::ScopedPtr<Sound::AudioStream> played(cache.add("foo", stream));
+
+	EXPECT_EQ(played.get(), stream);
+	EXPECT_EQ(cache.get("foo"), static_cast<Sound::RewindableAudioStream *>(0));
+
+	Sound::SampleCache::Stats stats;
+	cache.getStats(stats);
+
+	EXPECT_EQ(stats.count, 0);
+	EXPECT_EQ(stats.misses, 0);
+}
+
+GTEST_TEST(SampleCache, hitAndMiss) {
+	Sound::SampleCache cache;
+	cache.setSize(1024 * 1024);
+	cache.setMaxDuration(1000);
+
+	EXPECT_EQ(cache.get("foo"), static_cast<Sound::RewindableAudioStream *>(0));
+
+	Common::ScopedPtr<Sound::AudioStream> played(cache.add("foo", new SequenceStream(500)));
+	ASSERT_TRUE(played);
+	EXPECT_TRUE(isSequence(*played, 500));
+
+	Common::ScopedPtr<Sound::RewindableAudioStream> cached(cache.get("foo"));
+	ASSERT_TRUE(cached);
+
+	EXPECT_EQ(cached->getChannels(), 1);
+	EXPECT_EQ(cached->getRate(), 1000);
+	EXPECT_EQ(cached->getLength(), 500);
+	EXPECT_EQ(cached->getDuration(), 500);
+	EXPECT_TRUE(isSequence(*cached, 500));
+
+	EXPECT_TRUE(cached->rewind());
+	EXPECT_TRUE(isSequence(*cached, 500));
+
+	Sound::SampleCache::Stats stats;
+	cache.getStats(stats);
+
+	EXPECT_EQ(stats.count, 1);
+	EXPECT_EQ(stats.size, 500 * sizeof(int16));
+	EXPECT_EQ(stats.hits, 1);
+	EXPECT_EQ(stats.misses, 1);
+	EXPECT_EQ(stats.evictions, 0);
+}
+
+GTEST_TEST(SampleCache, tooLong) {
+	Sound::SampleCache cache;
+	cache.setSize(1024 * 1024);
+	cache.setMaxDuration(1000);
+
+	// Known to be too long without decoding
+	Sound::AudioStream *stream1 = new SequenceStream(2000);
+	Common::ScopedPtr<Sound::AudioStream> played1(cache.add("foo", stream1));
+
+	EXPECT_EQ(played1.get(), stream1);
+	EXPECT_TRUE(isSequence(*played1, 2000));
+
+	// Found to be too long while decoding, and rewound
+	Sound::AudioStream *stream2 = new SequenceStream(2000, false);
+	Common::ScopedPtr<Sound::AudioStream> played2(cache.add("bar", stream2));
+
+	EXPECT_EQ(played2.get(), stream2);
+	EXPECT_TRUE(isSequence(*played2, 2000));
+
+	// Exactly as long as allowed
+	Common::ScopedPtr<Sound::AudioStream> played3(cache.add("quux", new SequenceStream(1000, false)));
+	EXPECT_TRUE(isSequence(*played3, 1000));
+
+	EXPECT_EQ(cache.get("foo"), static_cast<Sound::RewindableAudioStream *>(0));
+	EXPECT_EQ(cache.get("bar"), static_cast<Sound::RewindableAudioStream *>(0));
+
+	Common::ScopedPtr<Sound::RewindableAudioStream> cached(cache.get("quux"));
+	EXPECT_TRUE(cached);
+
+	Sound::SampleCache::Stats stats;
+	cache.getStats(stats);
+
+	EXPECT_EQ(stats.count, 1);
+}
+
+GTEST_TEST(SampleCache, tooLongRemembered) {
+	Sound::SampleCache cache;
+	cache.setSize(1024 * 1024);
+	cache.setMaxDuration(1000);
+
+	// The first time, the sound has to be decoded to find out it's too long
+	SequenceStream *stream1 = new SequenceStream(2000, false);
+	Common::ScopedPtr<Sound::AudioStream> played1(cache.add("foo", stream1));
+
+	EXPECT_EQ(played1.get(), stream1);
+	EXPECT_GT(stream1->getReadCalls(), 0U);
+
+	Sound::SampleCache::Stats stats;
+	cache.getStats(stats);
+
+	EXPECT_EQ(stats.count, 0);
+	EXPECT_EQ(stats.tooLong, 1);
+
+	// The second time, it's not decoded at all
+	SequenceStream *stream2 = new SequenceStream(2000, false);
+	Common::ScopedPtr<Sound::AudioStream> played2(cache.add("foo", stream2));
+
+	EXPECT_EQ(played2.get(), stream2);
+	EXPECT_EQ(stream2->getReadCalls(), 0U);
+	EXPECT_TRUE(isSequence(*played2, 2000));
+
+	// A new limit might make it fit
+	cache.setMaxDuration(3000);
+
+	cache.getStats(stats);
+	EXPECT_EQ(stats.tooLong, 0);
+
+	delete cache.add("foo", new SequenceStream(2000, false));
+
+	Common::ScopedPtr<Sound::RewindableAudioStream> cached(cache.get("foo"));
+	EXPECT_TRUE(cached);
+}
+
+GTEST_TEST(SampleCache, validate) {
+	Sound::SampleCache cache;
+	cache.setSize(1024 * 1024);
+	cache.setMaxDuration(1000);
+
+	cache.validate(1);
+
+	delete cache.add("foo", new SequenceStream(500));
+
+	// Same change count, the sound stays
+	cache.validate(1);
+
+	Common::ScopedPtr<Sound::RewindableAudioStream> cached1(cache.get("foo"));
+	EXPECT_TRUE(cached1);
+
+	// The sources changed, the sound is dropped
+	cache.validate(2);
+
+	Common::ScopedPtr<Sound::RewindableAudioStream> cached2(cache.get("foo"));
+	EXPECT_FALSE(cached2);
+
+	Sound::SampleCache::Stats stats;
+	cache.getStats(stats);
+
+	EXPECT_EQ(stats.count, 0);
+	EXPECT_EQ(stats.size, 0);
+	EXPECT_EQ(stats.evictions, 0);
+	EXPECT_EQ(stats.hits, 1);
+
+	// Streams still playing the dropped sound keep working
+	EXPECT_TRUE(isSequence(*cached1, 500));
+}
+
+GTEST_TEST(SampleCache, evict) {
+	// A budget for 4 sounds of 250 samples each
+	Sound::SampleCache cache;
+	cache.setSize(4 * 250 * sizeof(int16));
+	cache.setMaxDuration(1000);
+
+	const char *kNames[] = { "a", "b", "c", "d", "e" };
+	for (size_t i = 0; i < 4; i++)
+		delete cache.add(kNames[i], new SequenceStream(250));
+
+	// Make "a" the most recently used sound, so that "b" is dropped next
+	delete cache.get("a");
+
+	delete cache.add(kNames[4], new SequenceStream(250));
+
+	Common::ScopedPtr<Sound::RewindableAudioStream> a(cache.get("a"));
+	Common::ScopedPtr<Sound::RewindableAudioStream> b(cache.get("b"));
+	Common::ScopedPtr<Sound::RewindableAudioStream> e(cache.get("e"));
+
+	EXPECT_TRUE(a);
+	EXPECT_FALSE(b);
+	EXPECT_TRUE(e);
+
+	Sound::SampleCache::Stats stats;
+	cache.getStats(stats);
+
+	EXPECT_EQ(stats.count, 4);
+	EXPECT_EQ(stats.size, 4 * 250 * sizeof(int16));
+	EXPECT_EQ(stats.evictions, 1);
+
+	// Sounds larger than a quarter of the budget are never cached
+	delete cache.add("big", new SequenceStream(251));
+
+	Common::ScopedPtr<Sound::RewindableAudioStream> big(cache.get("big"));
+	EXPECT_FALSE(big);
+}
+
+GTEST_TEST(SampleCache, sharedSamples) {
+	Sound::SampleCache cache;
+	cache.setSize(1024 * 1024);
+	cache.setMaxDuration(1000);
+
+	delete cache.add("foo", new SequenceStream(500));
+
+	Common::ScopedPtr<Sound::RewindableAudioStream> cached1(cache.get("foo"));
+	Common::ScopedPtr<Sound::RewindableAudioStream> cached2(cache.get("foo"));
+	ASSERT_TRUE(cached1);
+	ASSERT_TRUE(cached2);
+
+	// Each stream has its own position
+	int16 buffer[100];
+	EXPECT_EQ(cached1->readBuffer(buffer, 100), 100);
+
+	EXPECT_TRUE(isSequence(*cached2, 500));
+
+	// The samples outlive the cache entry
+	cache.clear();
+
+	EXPECT_EQ(cache.get("foo"), static_cast<Sound::RewindableAudioStream *>(0));
+
+	EXPECT_TRUE(cached1->rewind());
+	EXPECT_TRUE(isSequence(*cached1, 500));
+
+	Sound::SampleCache::Stats stats;
+	cache.getStats(stats);
+
+	EXPECT_EQ(stats.count, 0);
+	EXPECT_EQ(stats.size, 0);
+	EXPECT_EQ(stats.hits, 0);
+	EXPECT_EQ(stats.misses, 1);
+}
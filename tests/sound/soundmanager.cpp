@@ -0,0 +1,136 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for the sound manager, playing through the headless backend.
+ */
+
+#include <SDL_timer.h>
+
+#include "gtest/gtest.h"
+
+#include "src/common/memreadstream.h"
+
+#include "src/sound/sound.h"
+#include "src/sound/audiostream.h"
+#include "src/sound/nullbackend.h"
+#include "src/sound/decoders/pcm.h"
+
+/** Create a stream of 16-bit PCM samples. */
+static Sound::RewindableAudioStream *makeStream(size_t samples, int channels, int rate = 22050) {
+	byte *data = new byte[samples * 2];
+	for (size_t i = 0; i < samples; i++) {
+		data[i * 2 + 0] = (byte) (i & 0xFF);
+		data[i * 2 + 1] = (byte) ((i >> 8) & 0x7F);
+	}
+
+	return Sound::makePCMStream(new Common::MemoryReadStream(data, samples * 2, true), rate,
+	                            Sound::FLAG_16BITS | Sound::FLAG_LITTLE_ENDIAN, channels);
+}
+
+/** Wait until the sound manager finished playing a channel. */
+static bool waitForChannel(Sound::ChannelHandle &channel) {
+	const uint32 start = SDL_GetTicks();
+
+	while (SoundMan.isPlaying(channel)) {
+		if ((SDL_GetTicks() - start) > 10000)
+			return false;
+
+		SDL_Delay(1);
+	}
+
+	return true;
+}
+
+/** Play an audio stream through a fast null backend, returning the number of samples played. */
+static uint64 play(Sound::AudioStream *stream, bool &finished) {
+	Sound::NullBackend *backend = new Sound::NullBackend(Sound::NullBackend::kModeFast);
+
+	SoundMan.init(backend);
+	EXPECT_EQ(SoundMan.getBackend(), backend);
+
+	Sound::ChannelHandle channel = SoundMan.playAudioStream(stream, Sound::kSoundTypeSFX);
+	SoundMan.startChannel(channel);
+
+	finished = waitForChannel(channel);
+
+	const uint64 samples = backend->getSamplesPlayed();
+
+	SoundMan.deinit();
+	Sound::SoundManager::destroy();
+
+	return samples;
+}
+
+GTEST_TEST(SoundManager, playMono) {
+	bool finished = false;
+	EXPECT_EQ(play(makeStream(100000, 1), finished), 100000);
+
+	EXPECT_TRUE(finished);
+}
+
+GTEST_TEST(SoundManager, playStereo) {
+	bool finished = false;
+	EXPECT_EQ(play(makeStream(2 * 50000, 2), finished), 2 * 50000);
+
+	EXPECT_TRUE(finished);
+}
+
+GTEST_TEST(SoundManager, playLooping) {
+	bool finished = false;
+	EXPECT_EQ(play(Sound::makeLoopingAudioStream(makeStream(30000, 1), 3), finished), 3 * 30000);
+
+	EXPECT_TRUE(finished);
+}
+
+GTEST_TEST(SoundManager, playQueuing) {
+	Sound::QueuingAudioStream *queue = Sound::makeQueuingAudioStream(22050, 1);
+
+	queue->queueAudioStream(makeStream(20000, 1));
+	queue->queueAudioStream(makeStream(40000, 1));
+	queue->finish();
+
+	bool finished = false;
+	EXPECT_EQ(play(queue, finished), 60000);
+
+	EXPECT_TRUE(finished);
+}
+
+GTEST_TEST(SoundManager, channelStatus) {
+	Sound::NullBackend *backend = new Sound::NullBackend(Sound::NullBackend::kModeManual);
+	SoundMan.init(backend);
+
+	Sound::ChannelHandle channel = SoundMan.playAudioStream(makeStream(22050, 1), Sound::kSoundTypeSFX);
+	EXPECT_TRUE(SoundMan.isValidChannel(channel));
+	EXPECT_TRUE(SoundMan.isPaused(channel));
+
+	SoundMan.startChannel(channel);
+	EXPECT_FALSE(SoundMan.isPaused(channel));
+	EXPECT_TRUE(SoundMan.isPlaying(channel));
+
+	EXPECT_EQ(SoundMan.getChannelSamplesPlayed(channel), 0);
+	EXPECT_EQ(SoundMan.getChannelUnderruns(channel), 0);
+
+	SoundMan.stopChannel(channel);
+	EXPECT_FALSE(SoundMan.isValidChannel(channel));
+
+	SoundMan.deinit();
+	Sound::SoundManager::destroy();
+}
@@ -27,6 +27,10 @@
  */
 
 #include <cassert>
+#include <cctype>
+#include <cstring>
+
+#include <algorithm>
 
 #include "src/common/util.h"
 #include "src/common/error.h"
@@ -50,89 +54,60 @@ static const uint32 kVersion2b = MKTAG('V', '2', '.', 'b');
 
 namespace Aurora {
 
-TwoDARow::TwoDARow(TwoDAFile &parent) : _parent(&parent) {
+TwoDARow::TwoDARow(TwoDAFile &parent, size_t row) : _parent(&parent), _row(row) {
 }
 
 TwoDARow::~TwoDARow() {
 }
 
 const Common::UString &TwoDARow::getString(size_t column) const {
-	const Common::UString &cell = getCell(column);
-	if (cell.empty() || (cell == "****"))
+	const uint32 cell = _parent->getStringIndex(_row, column);
+	if (cell <= TwoDAFile::kStringStars)
 		return _parent->_defaultString;
 
-	return cell;
+	return _parent->_strings[cell];
 }
 
 const Common::UString &TwoDARow::getString(const Common::UString &column) const {
-	const Common::UString &cell = getCell(_parent->headerToColumn(column));
-	if (cell.empty() || (cell == "****"))
-		return _parent->_defaultString;
-
-	return cell;
+	return getString(_parent->headerToColumn(column));
 }
 
 int32 TwoDARow::getInt(size_t column) const {
-	const Common::UString &cell = getCell(column);
-	if (cell.empty() || (cell == "****"))
-		return _parent->_defaultInt;
-
-	return _parent->parseInt(cell);
+	return _parent->getInt(_row, column);
 }
 
 int32 TwoDARow::getInt(const Common::UString &column) const {
-	const Common::UString &cell = getCell(_parent->headerToColumn(column));
-	if (cell.empty() || (cell == "****"))
-		return _parent->_defaultInt;
-
-	return _parent->parseInt(cell);
+	return _parent->getInt(_row, _parent->headerToColumn(column));
 }
 
 float TwoDARow::getFloat(size_t column) const {
-	const Common::UString &cell = getCell(column);
-	if (cell.empty() || (cell == "****"))
-		return _parent->_defaultFloat;
-
-	return _parent->parseFloat(cell);
+	return _parent->getFloat(_row, column);
 }
 
 float TwoDARow::getFloat(const Common::UString &column) const {
-	const Common::UString &cell = getCell(_parent->headerToColumn(column));
-	if (cell.empty() || (cell == "****"))
-		return _parent->_defaultFloat;
-
-	return _parent->parseFloat(cell);
+	return _parent->getFloat(_row, _parent->headerToColumn(column));
 }
 
 bool TwoDARow::empty(size_t column) const {
-	const Common::UString &cell = getCell(column);
-	if (cell.empty() || (cell == "****"))
-		return true;
-
-	return false;
+	return _parent->getStringIndex(_row, column) <= TwoDAFile::kStringStars;
 }
 
 bool TwoDARow::empty(const Common::UString &column) const {
 	return empty(_parent->headerToColumn(column));
 }
 
-static const Common::UString kEmpty;
-const Common::UString &TwoDARow::getCell(size_t n) const {
-	if (n >= _data.size())
-		return kEmpty;
-
-	return _data[n];
-}
 
+const uint32 TwoDAFile::kStringEmpty;
+const uint32 TwoDAFile::kStringStars;
 
 TwoDAFile::TwoDAFile(Common::SeekableReadStream &twoda) :
-	_defaultInt(0), _defaultFloat(0.0f), _emptyRow(*this) {
+	_defaultInt(0), _defaultFloat(0.0f), _emptyRow(*this, SIZE_MAX) {
 
 	load(twoda);
 }
 
 TwoDAFile::TwoDAFile(const GDAFile &gda) :
-	_defaultInt(0), _defaultFloat(0.0f), _emptyRow(*this) {
+	_defaultInt(0), _defaultFloat(0.0f), _emptyRow(*this, SIZE_MAX) {
 
 	load(gda);
 }
@@ -159,7 +134,7 @@ void TwoDAFile::load(Common::SeekableReadStream &twoda) {
 		else if (_version == kVersion2b)
 			read2b(twoda); // Binary
 
-		// Create the map to quickly translate headers to column indices
+		// Create the index to quickly translate headers to column indices
 		createHeaderMap();
 
 	} catch (Common::Exception &e) {
@@ -231,9 +206,12 @@ void TwoDAFile::readRows2a(Common::SeekableReadStream &twoda,
 
 	const size_t columnCount = _headers.size();
 
-	while (!twoda.eos()) {
-		Common::ScopedPtr<TwoDARow> row(new TwoDARow(*this));
+	StringMap stringMap;
+	initColumns(stringMap);
+
+	std::vector<Common::UString> cells;
 
+	while (!twoda.eos()) {
 		/* Skip the first token, which is the row index, possibly indented.
 		 * The row index is implicit in the data and its use in the 2DA
 		 * file is only meant as a guideline for people editing the file by
@@ -242,7 +220,7 @@ void TwoDAFile::readRows2a(Common::SeekableReadStream &twoda,
 		tokenize.skipToken(twoda);
 
 		// Read all the cells in the row
-		size_t count = tokenize.getTokens(twoda, row->_data, columnCount, columnCount, "****");
+		size_t count = tokenize.getTokens(twoda, cells, columnCount, columnCount, "****");
 
 		// And move to the next line
 		tokenize.nextChunk(twoda);
@@ -251,7 +229,10 @@ void TwoDAFile::readRows2a(Common::SeekableReadStream &twoda,
 		if (count == 0)
 			continue;
 
-		_rows.push_back(row.release());
+		for (size_t i = 0; i < columnCount; i++)
+			addCell(stringMap, i, cells[i]);
+
+		addRow();
 	}
 }
 
@@ -280,7 +261,7 @@ void TwoDAFile::skipRowNames2b(Common::SeekableReadStream &twoda) {
 	 */
 
 	const uint32 rowCount = twoda.readUint32LE();
-	_rows.resize(rowCount, 0);
+	_rows.reserve(rowCount);
 
 	Common::StreamTokenizer tokenize(Common::StreamTokenizer::kRuleHeed);
 
@@ -289,6 +270,9 @@ void TwoDAFile::skipRowNames2b(Common::SeekableReadStream &twoda) {
 	tokenize.addSeparator('\0');
 
 	tokenize.skipToken(twoda, rowCount);
+
+	for (uint32 i = 0; i < rowCount; i++)
+		addRow();
 }
 
 void TwoDAFile::readRows2b(Common::SeekableReadStream &twoda) {
@@ -296,7 +280,7 @@ void TwoDAFile::readRows2b(Common::SeekableReadStream &twoda) {
 	 * stores a single 16-bit number, the offset into the data segment
 	 * where the data for this cell can be found. Moreover, a single
 	 * data offset can be used by several cells, deduplicating the
-	 * cell data.
+	 * cell data. We only read the data of each offset once.
 	 */
 
 	const size_t columnCount = _headers.size();
@@ -316,26 +300,113 @@ void TwoDAFile::readRows2b(Common::SeekableReadStream &twoda) {
 
 	const size_t dataOffset = twoda.pos();
 
-	for (size_t i = 0; i < rowCount; i++) {
-		_rows[i] = new TwoDARow(*this);
+	StringMap stringMap;
+	initColumns(stringMap);
 
-		_rows[i]->_data.resize(columnCount);
+	// Map from data offsets to strings in the string pool
+	typedef boost::unordered_map<uint32, uint32> OffsetMap;
+	OffsetMap offsetMap;
 
+	for (size_t i = 0; i < rowCount; i++) {
 		for (size_t j = 0; j < columnCount; j++) {
-			const size_t offset = dataOffset + offsets[i * columnCount + j];
+			const uint32 offset = offsets[i * columnCount + j];
 
-			twoda.seek(offset);
+			OffsetMap::const_iterator o = offsetMap.find(offset);
+			if (o != offsetMap.end()) {
+				_columns[j]->cells.push_back(o->second);
+				continue;
+			}
 
-			_rows[i]->_data[j] = tokenize.getToken(twoda);
-			if (_rows[i]->_data[j].empty())
-				_rows[i]->_data[j] = "****";
+			twoda.seek(dataOffset + offset);
+
+			Common::UString cell = tokenize.getToken(twoda);
+			if (cell.empty())
+				cell = "****";
+
+			addCell(stringMap, j, cell);
+
+			offsetMap.insert(std::make_pair(offset, _columns[j]->cells.back()));
 		}
 	}
 }
 
+/** Compare two column headers case-insensitively.
+ *
+ *  Column headers are plain ASCII identifiers, so we fold and compare the
+ *  raw bytes instead of decoding them as UTF-8 codepoints. This is the
+ *  ordering used for the sorted header index.
+ */
+static int compareHeaders(const Common::UString &a, const Common::UString &b) {
+	const byte *s1 = reinterpret_cast<const byte *>(a.c_str());
+	const byte *s2 = reinterpret_cast<const byte *>(b.c_str());
+
+	for (;; s1++, s2++) {
+		const int c1 = std::tolower(*s1);
+		const int c2 = std::tolower(*s2);
+
+		if ((c1 != c2) || (c1 == 0))
+			return c1 - c2;
+	}
+}
+
+/** Compare column header indices by their header string only. */
+static bool headerIndexLess(const std::pair<Common::UString, size_t> &a,
+                            const std::pair<Common::UString, size_t> &b) {
+
+	return compareHeaders(a.first, b.first) < 0;
+}
+
 void TwoDAFile::createHeaderMap() {
+	_headerIndices.clear();
+	_headerIndices.reserve(_headers.size());
+
+	for (size_t i = 0; i < _headers.size(); i++)
+		_headerIndices.push_back(std::make_pair(_headers[i], i));
+
+	/* Sort the headers, keeping the original order of equal headers. When
+	 * looking up a header, we find the first column with that header. */
+	std::stable_sort(_headerIndices.begin(), _headerIndices.end(), headerIndexLess);
+}
+
+void TwoDAFile::initColumns(StringMap &stringMap) {
+	_strings.clear();
+	_strings.push_back("");
+	_strings.push_back("****");
+
+	stringMap.clear();
+	stringMap.insert(std::make_pair(_strings[kStringEmpty], kStringEmpty));
+	stringMap.insert(std::make_pair(_strings[kStringStars], kStringStars));
+
+	_columns.clear();
+	_columns.reserve(_headers.size());
+
 	for (size_t i = 0; i < _headers.size(); i++)
-		_headerMap.insert(std::make_pair(_headers[i], i));
+		_columns.push_back(new Column);
+}
+
+void TwoDAFile::addCell(StringMap &stringMap, size_t column, const Common::UString &str) {
+	assert(column < _columns.size());
+
+	std::vector<uint32> &cells = _columns[column]->cells;
+
+	// Most cells in real tables are empty, so check for that before hashing
+	if (std::strcmp(str.c_str(), "****") == 0) {
+		cells.push_back(kStringStars);
+		return;
+	}
+
+	StringMap::const_iterator s = stringMap.find(str);
+	if (s == stringMap.end()) {
+		s = stringMap.insert(std::make_pair(str, (uint32) _strings.size())).first;
+
+		_strings.push_back(str);
+	}
+
+	cells.push_back(s->second);
+}
+
+void TwoDAFile::addRow() {
+	_rows.push_back(new TwoDARow(*this, _rows.size()));
 }
 
 void TwoDAFile::load(const GDAFile &gda) {
@@ -351,31 +422,32 @@ void TwoDAFile::load(const GDAFile &gda) {
 			_headers[i] = headerString ? headerString : Common::UString::format("[%u]", headers[i].hash);
 		}
 
-		_rows.resize(gda.getRowCount(), 0);
+		StringMap stringMap;
+		initColumns(stringMap);
+
 		for (size_t i = 0; i < gda.getRowCount(); i++) {
 			const GFF4Struct *row = gda.getRow(i);
 
-			_rows[i] = new TwoDARow(*this);
-			_rows[i]->_data.resize(gda.getColumnCount());
-
 			for (size_t j = 0; j < gda.getColumnCount(); j++) {
+				Common::UString cell;
+
 				if (row) {
 					switch (headers[j].type) {
 						case GDAFile::kTypeString:
 						case GDAFile::kTypeResource:
-							_rows[i]->_data[j] = row->getString(headers[j].field);
+							cell = row->getString(headers[j].field);
 							break;
 
 						case GDAFile::kTypeInt:
-							_rows[i]->_data[j] = Common::UString::format("%d", (int) row->getSint(headers[j].field));
+							cell = Common::UString::format("%d", (int) row->getSint(headers[j].field));
 							break;
 
 						case GDAFile::kTypeFloat:
-							_rows[i]->_data[j] = Common::UString::format("%f", row->getDouble(headers[j].field));
+							cell = Common::UString::format("%f", row->getDouble(headers[j].field));
 							break;
 
 						case GDAFile::kTypeBool:
-							_rows[i]->_data[j] = Common::UString::format("%u", (uint) row->getUint(headers[j].field));
+							cell = Common::UString::format("%u", (uint) row->getUint(headers[j].field));
 							break;
 
 						default:
@@ -383,10 +455,13 @@ void TwoDAFile::load(const GDAFile &gda) {
 					}
 				}
 
-				if (_rows[i]->_data[j].empty())
-					_rows[i]->_data[j] = "****";
+				if (cell.empty())
+					cell = "****";
 
+				addCell(stringMap, j, cell);
 			}
+
+			addRow();
 		}
 
 	} catch (Common::Exception &e) {
@@ -410,8 +485,12 @@ const std::vector<Common::UString> &TwoDAFile::getHeaders() const {
 }
 
 size_t TwoDAFile::headerToColumn(const Common::UString &header) const {
-	HeaderMap::const_iterator column = _headerMap.find(header);
-	if (column == _headerMap.end())
+	const HeaderIndex key(header, 0);
+
+	HeaderIndices::const_iterator column =
+		std::lower_bound(_headerIndices.begin(), _headerIndices.end(), key, headerIndexLess);
+
+	if ((column == _headerIndices.end()) || (compareHeaders(column->first, header) != 0))
 		// No such header
 		return kFieldIDInvalid;
 
@@ -431,15 +510,78 @@ const TwoDARow &TwoDAFile::getRow(const Common::UString &header, const Common::U
 	if (columnIndex == kFieldIDInvalid)
 		return _emptyRow;
 
-	for (std::vector<TwoDARow *>::const_iterator row = _rows.begin(); row != _rows.end(); ++row) {
-		if ((*row)->getString(columnIndex).equalsIgnoreCase(value))
-			return **row;
+	for (size_t i = 0; i < _rows.size(); i++) {
+		if (_rows[i]->getString(columnIndex).equalsIgnoreCase(value))
+			return *_rows[i];
 	}
 
 	// No such row
 	return _emptyRow;
 }
 
+uint32 TwoDAFile::getStringIndex(size_t row, size_t column) const {
+	if ((column >= _columns.size()) || (row >= _columns[column]->cells.size()))
+		return kStringEmpty;
+
+	return _columns[column]->cells[row];
+}
+
+const Common::UString &TwoDAFile::getCell(size_t row, size_t column) const {
+	return _strings[getStringIndex(row, column)];
+}
+
+int32 TwoDAFile::getInt(size_t row, size_t column) const {
+	if ((column >= _columns.size()) || (row >= _columns[column]->cells.size()))
+		return _defaultInt;
+
+	const Column &c = *_columns[column];
+
+	// Parse the whole column once, on the first request
+	if (!c.hasInts.load(boost::memory_order_acquire)) {
+		Common::StackLock lock(_mutex);
+
+		if (!c.hasInts.load(boost::memory_order_relaxed)) {
+			c.ints.resize(c.cells.size());
+
+			for (size_t i = 0; i < c.cells.size(); i++) {
+				const uint32 cell = c.cells[i];
+
+				c.ints[i] = (cell <= kStringStars) ? _defaultInt : parseInt(_strings[cell]);
+			}
+
+			c.hasInts.store(true, boost::memory_order_release);
+		}
+	}
+
+	return c.ints[row];
+}
+
+float TwoDAFile::getFloat(size_t row, size_t column) const {
+	if ((column >= _columns.size()) || (row >= _columns[column]->cells.size()))
+		return _defaultFloat;
+
+	const Column &c = *_columns[column];
+
+	// Parse the whole column once, on the first request
+	if (!c.hasFloats.load(boost::memory_order_acquire)) {
+		Common::StackLock lock(_mutex);
+
+		if (!c.hasFloats.load(boost::memory_order_relaxed)) {
+			c.floats.resize(c.cells.size());
+
+			for (size_t i = 0; i < c.cells.size(); i++) {
+				const uint32 cell = c.cells[i];
+
+				c.floats[i] = (cell <= kStringStars) ? _defaultFloat : parseFloat(_strings[cell]);
+			}
+
+			c.hasFloats.store(true, boost::memory_order_release);
+		}
+	}
+
+	return c.floats[row];
+}
+
 void TwoDAFile::writeASCII(Common::WriteStream &out) const {
 	// Write header
 
@@ -460,9 +602,11 @@ void TwoDAFile::writeASCII(Common::WriteStream &out) const {
 		colLength[i + 1] = _headers[i].size();
 
 	for (size_t i = 0; i < _rows.size(); i++) {
-		for (size_t j = 0; j < _rows[i]->_data.size(); j++) {
-			const bool   needQuote = _rows[i]->_data[j].contains(' ');
-			const size_t length    = needQuote ? _rows[i]->_data[j].size() + 2 : _rows[i]->_data[j].size();
+		for (size_t j = 0; j < _columns.size(); j++) {
+			const Common::UString &cell = getCell(i, j);
+
+			const bool   needQuote = cell.contains(' ');
+			const size_t length    = needQuote ? cell.size() + 2 : cell.size();
 
 			colLength[j + 1] = MAX<size_t>(colLength[j + 1], length);
 		}
@@ -482,14 +626,16 @@ void TwoDAFile::writeASCII(Common::WriteStream &out) const {
 	for (size_t i = 0; i < _rows.size(); i++) {
 		out.writeString(Common::UString::format("%*u", (int)colLength[0], (uint)i));
 
-		for (size_t j = 0; j < _rows[i]->_data.size(); j++) {
-			const bool needQuote = _rows[i]->_data[j].contains(' ');
+		for (size_t j = 0; j < _columns.size(); j++) {
+			const Common::UString &cell = getCell(i, j);
+
+			const bool needQuote = cell.contains(' ');
 
 			Common::UString cellString;
 			if (needQuote)
-				cellString = Common::UString::format("\"%s\"", _rows[i]->_data[j].c_str());
+				cellString = Common::UString::format("\"%s\"", cell.c_str());
 			else
-				cellString = _rows[i]->_data[j];
+				cellString = cell;
 
 			out.writeString(Common::UString::format(" %-*s", (int)colLength[j + 1], cellString.c_str()));
 
@@ -641,19 +787,21 @@ void TwoDAFile::writeCSV(Common::WriteStream &out) const {
 	// Write array
 
 	for (size_t i = 0; i < _rows.size(); i++) {
-		for (size_t j = 0; j < _rows[i]->_data.size(); j++) {
-			const bool needQuote = _rows[i]->_data[j].contains(',');
+		for (size_t j = 0; j < _columns.size(); j++) {
+			const Common::UString &cell = getCell(i, j);
+
+			const bool needQuote = cell.contains(',');
 
 			if (needQuote)
 				out.writeByte('"');
 
-			if (_rows[i]->_data[j] != "****")
-				out.writeString(_rows[i]->_data[j]);
+			if (getStringIndex(i, j) != kStringStars)
+				out.writeString(cell);
 
 			if (needQuote)
 				out.writeByte('"');
 
-			if (j < (_rows[i]->_data.size() - 1))
+			if (j < (_columns.size() - 1))
 				out.writeByte(',');
 		}
 
@@ -26,13 +26,15 @@
 #define AURORA_2DAFILE_H
 
 #include <vector>
-#include <map>
 
 #include <boost/noncopyable.hpp>
+#include <boost/unordered_map.hpp>
 
 #include "src/common/types.h"
 #include "src/common/ustring.h"
 #include "src/common/ptrvector.h"
+#include "src/common/mutex.h"
+#include "src/common/atomic.h"
 
 #include "src/aurora/aurorafile.h"
 
@@ -83,13 +85,11 @@ public:
 private:
 	TwoDAFile *_parent; ///< The parent 2DA.
 
-	std::vector<Common::UString> _data;
+	size_t _row; ///< The index of this row within the parent 2DA.
 
-	TwoDARow(TwoDAFile &parent);
+	TwoDARow(TwoDAFile &parent, size_t row);
 	~TwoDARow();
 
-	const Common::UString &getCell(size_t n) const;
-
 	friend class TwoDAFile;
 
 	template<typename T>
@@ -119,6 +119,10 @@ private:
  *  be read and modified with a simple text editor. The binary
  *  version cannot.
  *
+ *  Internally, the cells are stored column by column, as indices into
+ *  a pool of unique cell strings. The integer and floating point values
+ *  of a column are parsed once, when first requested, and then cached.
+ *
  *  See also classes TwoDARow and TwoDARegistry.
  */
 class TwoDAFile : boost::noncopyable, public AuroraFile {
@@ -163,14 +167,48 @@ public:
 	// '---
 
 private:
-	typedef std::map<Common::UString, size_t, Common::UString::iless> HeaderMap;
+	/** A column of cells. */
+	struct Column : boost::noncopyable {
+		/** The cells of this column, as indices into the string pool. */
+		std::vector<uint32> cells;
+
+		mutable boost::atomic<bool> hasInts;   ///< Have the int values been parsed yet?
+		mutable boost::atomic<bool> hasFloats; ///< Have the float values been parsed yet?
+
+		mutable std::vector<int32> ints;   ///< The cells parsed as ints.
+		mutable std::vector<float> floats; ///< The cells parsed as floats.
+
+		Column() : hasInts(false), hasFloats(false) { }
+	};
+
+	/** A column header and its column index, for looking up columns by header. */
+	typedef std::pair<Common::UString, size_t> HeaderIndex;
+
+	typedef Common::PtrVector<Column> Columns;
+	typedef std::vector<HeaderIndex> HeaderIndices;
+
+	typedef boost::unordered_map<Common::UString, uint32, Common::hashUStringCaseSensitive> StringMap;
+
+	/** Index of the empty string in the string pool. */
+	static const uint32 kStringEmpty = 0;
+	/** Index of the "****" string, marking an empty cell, in the string pool. */
+	static const uint32 kStringStars = 1;
 
 	Common::UString _defaultString; ///< The default string to return should a cell not exist.
 	int32           _defaultInt;    ///< The default int to return should a cell not exist.
 	float           _defaultFloat;  ///< The default float to return should a cell not exist.
 
 	std::vector<Common::UString> _headers;
-	HeaderMap _headerMap;
+	/** All column headers, sorted case-insensitively. */
+	HeaderIndices _headerIndices;
+
+	/** The pool of all unique cell strings. */
+	std::vector<Common::UString> _strings;
+	/** All columns of cells. */
+	Columns _columns;
+
+	/** Guards the int and float values the columns parse on first access. */
+	mutable Common::Mutex _mutex;
 
 	TwoDARow _emptyRow;
 	Common::PtrVector<TwoDARow> _rows;
@@ -195,6 +233,17 @@ private:
 
 	void createHeaderMap();
 
+	// Cell helpers
+	void initColumns(StringMap &stringMap);
+	void addCell(StringMap &stringMap, size_t column, const Common::UString &str);
+	void addRow();
+
+	uint32 getStringIndex(size_t row, size_t column) const;
+	const Common::UString &getCell(size_t row, size_t column) const;
+
+	int32 getInt(size_t row, size_t column) const;
+	float getFloat(size_t row, size_t column) const;
+
 	static int32 parseInt(const Common::UString &str);
 	static float parseFloat(const Common::UString &str);
 
@@ -41,6 +41,10 @@ uint32 Archive::getResourceSize(uint32 UNUSED(index)) const {
 	return 0xFFFFFFFF;
 }
 
+bool Archive::isResourceDecoded(uint32 UNUSED(index)) const {
+	return false;
+}
+
 Common::HashAlgo Archive::getNameHashAlgo() const {
 	return Common::kHashNone;
 }
@@ -65,7 +65,16 @@ public:
 	/** Return the size of a resource. */
 	virtual uint32 getResourceSize(uint32 index) const;
 
+	/** Does reading this resource decode it, i.e. decompress, decrypt or convert its data? */
+	virtual bool isResourceDecoded(uint32 index) const;
+
 	/** Return a stream of the resource's contents.
+	 *
+	 *  When tryNoCopy is false, archives should read the resource using positional
+	 *  reads (SeekableReadStream::readAt()), so that several threads can request
+	 *  resources from the same archive at the same time. The SeekableSubReadStream
+	 *  returned for tryNoCopy is tied to the archive stream's position, and must
+	 *  not be used concurrently with other requests.
 	 *
 	 *  @param  index The index of the resource we want.
 	 *  @param  tryNoCopy Try to return a SeekableSubReadStream of the archive instead of copying.
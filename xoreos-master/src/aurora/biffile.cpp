@@ -144,9 +144,7 @@ Common::SeekableReadStream *BIFFile::getResource(uint32 index, bool tryNoCopy) c
 	if (tryNoCopy)
 		return new Common::SeekableSubReadStream(_bif.get(), res.offset, res.offset + res.size);
 
-	_bif->seek(res.offset);
-
-	return _bif->readStream(res.size);
+	return _bif->readStreamAt(res.offset, res.size);
 }
 
 } // End of namespace Aurora
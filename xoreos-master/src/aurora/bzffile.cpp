@@ -31,6 +31,7 @@
 #include <lzma.h>
 
 #include "src/common/util.h"
+#include "src/common/scopedptr.h"
 #include "src/common/strutil.h"
 #include "src/common/error.h"
 #include "src/common/memreadstream.h"
@@ -143,12 +144,21 @@ uint32 BZFFile::getResourceSize(uint32 index) const {
 	return getIResource(index).size;
 }
 
+bool BZFFile::isResourceDecoded(uint32 UNUSED(index)) const {
+	// All BZF resources are LZMA-compressed
+	return true;
+}
+
 Common::SeekableReadStream *BZFFile::getResource(uint32 index, bool UNUSED(tryNoCopy)) const {
 	const IResource &res = getIResource(index);
 
-	_bzf->seek(res.offset);
+	Common::ScopedArray<byte> packedData(new byte[res.packedSize]);
+	if (_bzf->readAt(res.offset, packedData.get(), res.packedSize) != res.packedSize)
+		throw Common::Exception(Common::kReadError);
+
+	const byte *data = Common::decompressLZMA1(packedData.get(), res.packedSize, res.size);
 
-	return Common::decompressLZMA1(*_bzf, res.packedSize, res.size);
+	return new Common::MemoryReadStream(data, res.size, true);
 }
 
 } // End of namespace Aurora
@@ -659,16 +659,18 @@ uint32 ERFFile::getResourceSize(uint32 index) const {
 	return getIResource(index).unpackedSize;
 }
 
+bool ERFFile::isResourceDecoded(uint32 UNUSED(index)) const {
+	return (_header.encryption != kEncryptionNone) || (_header.compression != kCompressionNone);
+}
+
 Common::SeekableReadStream *ERFFile::getResource(uint32 index, bool tryNoCopy) const {
 	const IResource &res = getIResource(index);
 
 	if (tryNoCopy && (_header.encryption == kEncryptionNone) && (_header.compression == kCompressionNone))
 		return new Common::SeekableSubReadStream(_erf.get(), res.offset, res.offset + res.packedSize);
 
-	_erf->seek(res.offset);
-
 	// Read
-	Common::MemoryReadStream *stream = _erf->readStream(res.packedSize);
+	Common::MemoryReadStream *stream = _erf->readStreamAt(res.offset, res.packedSize);
 
 	// Decrypt
 	if (_header.encryption != kEncryptionNone)
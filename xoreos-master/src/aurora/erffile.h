@@ -121,6 +121,9 @@ public:
 	/** Return the size of a resource. */
 	uint32 getResourceSize(uint32 index) const;
 
+	/** Does reading this resource decode it? */
+	bool isResourceDecoded(uint32 index) const;
+
 	/** Return a stream of the resource's contents. */
 	Common::SeekableReadStream *getResource(uint32 index, bool tryNoCopy = false) const;
 
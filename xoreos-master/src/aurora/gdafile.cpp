@@ -28,6 +28,8 @@
 
 #include <cassert>
 
+#include <algorithm>
+
 #include "src/common/error.h"
 #include "src/common/readstream.h"
 #include "src/common/hash.h"
@@ -42,6 +44,11 @@ static const uint32 kVersion02 = MKTAG('V', '0', '.', '2');
 
 namespace Aurora {
 
+/** Compare column hashes by the hash only. */
+static bool columnHashLess(const std::pair<uint32, size_t> &a, const std::pair<uint32, size_t> &b) {
+	return a.first < b.first;
+}
+
 const size_t GDAFile::kInvalidColumn;
 const size_t GDAFile::kInvalidRow;
 
@@ -93,29 +100,25 @@ const GFF4Struct *GDAFile::getRow(size_t row) const {
 }
 
 size_t GDAFile::findRow(uint32 id) const {
+	Common::StackLock lock(_mutex);
+
 	size_t idColumn = findColumn("ID");
 	if (idColumn == kInvalidColumn)
 		return kInvalidRow;
 
-	// Go through all rows of all GFF4s, and look for the ID
-
-	size_t gff4 = 0;
-	for (size_t i = 0, j = 0; i < _rowCount; i++, j++) {
-		if (j >= _rows[gff4]->size()) {
-			if (++gff4 >= _rows.size())
-				break;
-
-			j = 0;
-		}
+	// Go through the cached ID values of all rows, and look for the ID
 
-		if ((*_rows[gff4])[j] && ((*_rows[gff4])[j]->getUint(idColumn) == id))
+	const Column &column = getColumn(idColumn, kTypeInt);
+	for (size_t i = 0; i < _rowCount; i++)
+		if (column.cells[i] && ((uint32) column.ints[i] == id))
 			return i;
-	}
 
 	return kInvalidRow;
 }
 
 size_t GDAFile::findColumn(const Common::UString &name) const {
+	Common::StackLock lock(_mutex);
+
 	ColumnNameMap::const_iterator c = _columnNameMap.find(name);
 	if (c != _columnNameMap.end())
 		return c->second;
@@ -127,94 +130,175 @@ size_t GDAFile::findColumn(const Common::UString &name) const {
 }
 
 size_t GDAFile::findColumn(uint32 hash) const {
-	ColumnHashMap::const_iterator c = _columnHashMap.find(hash);
-	if (c != _columnHashMap.end())
-		return c->second;
+	ColumnHashes::const_iterator c =
+		std::lower_bound(_columnHashes.begin(), _columnHashes.end(), ColumnHash(hash, 0), columnHashLess);
 
-	for (size_t i = 0; i < _columns->size(); i++) {
-		if (!(*_columns)[i])
-			continue;
+	if ((c == _columnHashes.end()) || (c->first != hash))
+		return kInvalidColumn;
 
-		if ((*_columns)[i]->getUint(kGFF4G2DAColumnHash) == hash) {
-			_columnHashMap[hash] = kGFF4G2DAColumn1 + i;
+	return c->second;
+}
 
-			return kGFF4G2DAColumn1 + i;
-		}
+const GDAFile::Column &GDAFile::getColumn(size_t column, Type type) const {
+	assert((column >= kGFF4G2DAColumn1) && ((column - kGFF4G2DAColumn1) < _columnCache.size()));
+
+	/* Read the values of the whole column out of all the rows, and
+	 * cache them. Each type of values is only read once. */
+
+	Column &cache = _columnCache[column - kGFF4G2DAColumn1];
+
+	if (!cache.hasCells) {
+		cache.cells.resize(_rowCount, false);
+
+		size_t i = 0;
+		for (Rows::const_iterator r = _rows.begin(); r != _rows.end(); ++r)
+			for (GFF4List::const_iterator row = (*r)->begin(); row != (*r)->end(); ++row, i++)
+				cache.cells[i] = *row && (*row)->hasField(column);
+
+		cache.hasCells = true;
 	}
 
-	_columnHashMap[hash] = kInvalidColumn;
-	return kInvalidColumn;
-}
+	if (((type == kTypeInt) && cache.hasInts) || ((type == kTypeFloat) && cache.hasFloats) ||
+	    ((type == kTypeString) && cache.hasStrings))
+		return cache;
+
+	std::vector<int32>  ints;
+	std::vector<float>  floats;
+	std::vector<uint32> strings;
+
+	if (type == kTypeInt)
+		ints.resize(_rowCount, 0);
+	else if (type == kTypeFloat)
+		floats.resize(_rowCount, 0.0f);
+	else if (type == kTypeString)
+		strings.resize(_rowCount, 0);
+
+	// Strings are deduplicated into the string pool
+	typedef boost::unordered_map<Common::UString, uint32, Common::hashUStringCaseSensitive> StringMap;
+	StringMap stringMap;
+
+	size_t i = 0;
+	for (Rows::const_iterator r = _rows.begin(); r != _rows.end(); ++r) {
+		for (GFF4List::const_iterator row = (*r)->begin(); row != (*r)->end(); ++row, i++) {
+			if (!cache.cells[i])
+				continue;
 
-const GFF4Struct *GDAFile::getRowColumn(size_t row, uint32 hash, size_t &column) const {
-	const GFF4Struct *gdaRow = getRow(row);
-	if (!gdaRow || ((column = findColumn(hash)) == kInvalidColumn))
-		return 0;
+			if (type == kTypeInt) {
+				ints[i] = (int32) (*row)->getSint(column);
+			} else if (type == kTypeFloat) {
+				floats[i] = (float) (*row)->getDouble(column);
+			} else if (type == kTypeString) {
+				const Common::UString str = (*row)->getString(column);
 
-	return gdaRow;
-}
+				std::pair<StringMap::iterator, bool> result;
 
-const GFF4Struct *GDAFile::getRowColumn(size_t row, const Common::UString &name, size_t &column) const {
-	const GFF4Struct *gdaRow = getRow(row);
-	if (!gdaRow || ((column = findColumn(name)) == kInvalidColumn))
-		return 0;
+				result = stringMap.insert(std::make_pair(str, (uint32) _strings.size()));
+				if (result.second)
+					_strings.push_back(str);
 
-	return gdaRow;
+				strings[i] = result.first->second;
+			}
+		}
+	}
+
+	if (type == kTypeInt) {
+		cache.ints.swap(ints);
+		cache.hasInts = true;
+	} else if (type == kTypeFloat) {
+		cache.floats.swap(floats);
+		cache.hasFloats = true;
+	} else if (type == kTypeString) {
+		cache.strings.swap(strings);
+		cache.hasStrings = true;
+	}
+
+	return cache;
 }
 
 Common::UString GDAFile::getString(size_t row, uint32 columnHash, const Common::UString &def) const {
-	size_t gdaColumn;
-	const GFF4Struct *gdaRow = getRowColumn(row, columnHash, gdaColumn);
-	if (!gdaRow)
+	Common::StackLock lock(_mutex);
+
+	const size_t column = findColumn(columnHash);
+	if ((row >= _rowCount) || (column == kInvalidColumn))
 		return def;
 
-	return gdaRow->getString(gdaColumn, def);
+	const Column &cache = getColumn(column, kTypeString);
+	if (!cache.cells[row])
+		return def;
+
+	return _strings[cache.strings[row]];
 }
 
 Common::UString GDAFile::getString(size_t row, const Common::UString &columnName,
                                    const Common::UString &def) const {
-	size_t gdaColumn;
-	const GFF4Struct *gdaRow = getRowColumn(row, columnName, gdaColumn);
-	if (!gdaRow)
+
+	Common::StackLock lock(_mutex);
+
+	const size_t column = findColumn(columnName);
+	if ((row >= _rowCount) || (column == kInvalidColumn))
 		return def;
 
-	return gdaRow->getString(gdaColumn, def);
+	const Column &cache = getColumn(column, kTypeString);
+	if (!cache.cells[row])
+		return def;
+
+	return _strings[cache.strings[row]];
 }
 
 int32 GDAFile::getInt(size_t row, uint32 columnHash, int32 def) const {
-	size_t gdaColumn;
-	const GFF4Struct *gdaRow = getRowColumn(row, columnHash, gdaColumn);
-	if (!gdaRow)
+	Common::StackLock lock(_mutex);
+
+	const size_t column = findColumn(columnHash);
+	if ((row >= _rowCount) || (column == kInvalidColumn))
 		return def;
 
-	return gdaRow->getSint(gdaColumn, def);
+	const Column &cache = getColumn(column, kTypeInt);
+	if (!cache.cells[row])
+		return def;
+
+	return cache.ints[row];
 }
 
 int32 GDAFile::getInt(size_t row, const Common::UString &columnName, int32 def) const {
-	size_t gdaColumn;
-	const GFF4Struct *gdaRow = getRowColumn(row, columnName, gdaColumn);
-	if (!gdaRow)
+	Common::StackLock lock(_mutex);
+
+	const size_t column = findColumn(columnName);
+	if ((row >= _rowCount) || (column == kInvalidColumn))
 		return def;
 
-	return gdaRow->getSint(gdaColumn, def);
+	const Column &cache = getColumn(column, kTypeInt);
+	if (!cache.cells[row])
+		return def;
+
+	return cache.ints[row];
 }
 
 float GDAFile::getFloat(size_t row, uint32 columnHash, float def) const {
-	size_t gdaColumn;
-	const GFF4Struct *gdaRow = getRowColumn(row, columnHash, gdaColumn);
-	if (!gdaRow)
+	Common::StackLock lock(_mutex);
+
+	const size_t column = findColumn(columnHash);
+	if ((row >= _rowCount) || (column == kInvalidColumn))
 		return def;
 
-	return gdaRow->getDouble(gdaColumn, def);
+	const Column &cache = getColumn(column, kTypeFloat);
+	if (!cache.cells[row])
+		return def;
+
+	return cache.floats[row];
 }
 
 float GDAFile::getFloat(size_t row, const Common::UString &columnName, float def) const {
-	size_t gdaColumn;
-	const GFF4Struct *gdaRow = getRowColumn(row, columnName, gdaColumn);
-	if (!gdaRow)
+	Common::StackLock lock(_mutex);
+
+	const size_t column = findColumn(columnName);
+	if ((row >= _rowCount) || (column == kInvalidColumn))
 		return def;
 
-	return gdaRow->getDouble(gdaColumn, def);
+	const Column &cache = getColumn(column, kTypeFloat);
+	if (!cache.cells[row])
+		return def;
+
+	return cache.floats[row];
 }
 
 GDAFile::Type GDAFile::identifyType(const Columns &columns, const Row &rows, size_t column) const {
@@ -297,12 +381,29 @@ void GDAFile::load(Common::SeekableReadStream *gda) {
 			_headers[i].field = (uint32) kGFF4G2DAColumn1 + i;
 		}
 
+		createColumnHashes();
+
+		_columnCache.resize(_columns->size());
+
 	} catch (Common::Exception &e) {
 		e.add("Failed reading GDA file");
 		throw;
 	}
 }
 
+void GDAFile::createColumnHashes() {
+	_columnHashes.clear();
+	_columnHashes.reserve(_columns->size());
+
+	for (size_t i = 0; i < _columns->size(); i++)
+		if ((*_columns)[i])
+			_columnHashes.push_back(ColumnHash(_headers[i].hash, kGFF4G2DAColumn1 + i));
+
+	/* Sort the hashes, keeping the original order of equal hashes. When
+	 * looking up a hash, we find the first column with that hash. */
+	std::stable_sort(_columnHashes.begin(), _columnHashes.end(), columnHashLess);
+}
+
 void GDAFile::add(Common::SeekableReadStream *gda) {
 	try {
 		_gff4s.push_back(new GFF4File(gda, kG2DAID));
@@ -335,6 +436,12 @@ void GDAFile::add(Common::SeekableReadStream *gda) {
 				                        hash1, (int)type1, hash2, (int)type2);
 		}
 
+		// We have more rows now, so all cached column values are outdated
+		_columnCache.clear();
+		_columnCache.resize(_columns->size());
+
+		_strings.clear();
+
 	} catch (Common::Exception &e) {
 		e.add("Failed adding GDA file");
 		throw;
@@ -26,12 +26,13 @@
 #define AURORA_GDAFILE_H
 
 #include <vector>
-#include <map>
 
 #include <boost/noncopyable.hpp>
+#include <boost/unordered_map.hpp>
 
 #include "src/common/ustring.h"
 #include "src/common/ptrvector.h"
+#include "src/common/mutex.h"
 
 #include "src/aurora/types.h"
 
@@ -58,6 +59,12 @@ namespace Aurora {
  *  by the Dragon Age games. Within these MGDAs, rows are not anymore
  *  identified by raw row index (since this index is now meaningless),
  *  but by an "ID" column.
+ *
+ *  The values read through getString(), getInt() and getFloat() are
+ *  read out of all rows of a column at once, on the first request,
+ *  and then cached. Strings are kept in a pool shared by all columns.
+ *  Since reading a column can grow that pool, these lookups hold a lock
+ *  on the whole file.
  */
 class GDAFile : boost::noncopyable {
 public:
@@ -139,8 +146,29 @@ private:
 	typedef std::vector<Row> Rows;
 	typedef std::vector<size_t> RowStarts;
 
-	typedef std::map<uint32, size_t> ColumnHashMap;
-	typedef std::map<Common::UString, size_t> ColumnNameMap;
+	/** A column hash and the column's field ID, for looking up columns by hash. */
+	typedef std::pair<uint32, size_t> ColumnHash;
+	typedef std::vector<ColumnHash> ColumnHashes;
+
+	typedef boost::unordered_map<Common::UString, size_t, Common::hashUStringCaseSensitive> ColumnNameMap;
+
+	/** The cached values of a column. */
+	struct Column {
+		bool hasCells;   ///< Do we know yet which cells exist?
+		bool hasInts;    ///< Have the int values been read yet?
+		bool hasFloats;  ///< Have the float values been read yet?
+		bool hasStrings; ///< Have the string values been read yet?
+
+		std::vector<bool> cells; ///< Does the cell in this row exist?
+
+		std::vector<int32>  ints;    ///< The cells read as ints.
+		std::vector<float>  floats;  ///< The cells read as floats.
+		std::vector<uint32> strings; ///< The cells read as strings, as indices into the string pool.
+
+		Column() : hasCells(false), hasInts(false), hasFloats(false), hasStrings(false) { }
+	};
+
+	typedef std::vector<Column> ColumnCache;
 
 
 	GFF4s _gff4s;
@@ -154,16 +182,31 @@ private:
 
 	RowStarts _rowStarts;
 
-	mutable ColumnHashMap _columnHashMap;
+	/** The hashes of all columns, sorted. */
+	ColumnHashes _columnHashes;
+
 	mutable ColumnNameMap _columnNameMap;
 
+	/** The cached values of all columns. */
+	mutable ColumnCache _columnCache;
+	/** The pool of all cached strings. */
+	mutable std::vector<Common::UString> _strings;
+
+	/** Guards the column name map, the column cache and the string pool. */
+	mutable Common::Mutex _mutex;
+
 
 	void load(Common::SeekableReadStream *gda);
 
 	Type identifyType(const Columns &columns, const Row &rows, size_t column) const;
 
-	const GFF4Struct *getRowColumn(size_t row, uint32 hash, size_t &column) const;
-	const GFF4Struct *getRowColumn(size_t row, const Common::UString &name, size_t &column) const;
+	void createColumnHashes();
+
+	/** Return the cached values of this column (by field ID), reading them if necessary.
+	 *
+	 *  Must be called with _mutex held.
+	 */
+	const Column &getColumn(size_t column, Type type) const;
 };
 
 } // End of namespace Aurora
@@ -27,8 +27,12 @@
  */
 
 #include <cassert>
+#include <cstring>
+
+#include <algorithm>
 
 #include "src/common/error.h"
+#include "src/common/endianness.h"
 #include "src/common/memreadstream.h"
 #include "src/common/encoding.h"
 #include "src/common/ustring.h"
@@ -44,6 +48,8 @@ static const uint32 kVersion33 = MKTAG('V', '3', '.', '3'); // Found in The Witc
 
 namespace Aurora {
 
+const uint32 GFF3File::kLabelNone;
+
 GFF3File::Header::Header() {
 }
 
@@ -64,7 +70,7 @@ void GFF3File::Header::read(Common::SeekableReadStream &gff3) {
 
 
 GFF3File::GFF3File(Common::SeekableReadStream *gff3, uint32 id, bool repairNWNPremium) :
-	_stream(gff3), _repairNWNPremium(repairNWNPremium), _offsetCorrection(0) {
+	_stream(gff3), _data(0), _dataSize(0), _repairNWNPremium(repairNWNPremium), _offsetCorrection(0) {
 
 	assert(_stream);
 
@@ -72,7 +78,7 @@ GFF3File::GFF3File(Common::SeekableReadStream *gff3, uint32 id, bool repairNWNPr
 }
 
 GFF3File::GFF3File(const Common::UString &gff3, FileType type, uint32 id, bool repairNWNPremium) :
-	_repairNWNPremium(repairNWNPremium), _offsetCorrection(0) {
+	_data(0), _dataSize(0), _repairNWNPremium(repairNWNPremium), _offsetCorrection(0) {
 
 	_stream.reset(ResMan.getResource(gff3, type));
 	if (!_stream)
@@ -97,7 +103,9 @@ const GFF3Struct &GFF3File::getTopLevel() const {
 void GFF3File::load(uint32 id) {
 	try {
 
+		loadData();
 		loadHeader(id);
+		loadLabels();
 		loadStructs();
 		loadLists();
 
@@ -107,6 +115,27 @@ void GFF3File::load(uint32 id) {
 	}
 }
 
+void GFF3File::loadData() {
+	/* We want the whole GFF3 in one contiguous block of memory. If the stream
+	 * already is in memory (which it is when it comes from the ResourceManager's
+	 * cache or a decompressed archive), we use its data directly. Otherwise, we
+	 * read the whole stream into memory once. */
+
+	const size_t pos = _stream->pos();
+
+	Common::MemoryReadStream *memory = dynamic_cast<Common::MemoryReadStream *>(_stream.get());
+	if (!memory) {
+		memory = _stream->readStreamAt(0, _stream->size());
+
+		_stream.reset(memory);
+	}
+
+	_data     = memory->getData();
+	_dataSize = memory->size();
+
+	_stream->seek(pos);
+}
+
 void GFF3File::loadHeader(uint32 id) {
 	if (_repairNWNPremium) {
 		/* The GFF3 files in the encrypted premium module archive for Neverwinter
@@ -180,9 +209,56 @@ void GFF3File::loadHeader(uint32 id) {
 		throw Common::Exception("GFF3 header broken: section offset points outside stream");
 }
 
+void GFF3File::loadLabels() {
+	/* Labels are stored in a table of 16-byte strings, shared by all fields in
+	 * the file. We read them all once, and put them into a small open-addressing
+	 * hash table, so that a field lookup by name only needs to find the label
+	 * index once, instead of comparing strings against every field. */
+
+	static const uint32 kLabelSize = 16;
+
+	if (_header.labelCount > ((_dataSize - _header.labelOffset) / kLabelSize))
+		throw Common::Exception("GFF3: Label table points outside stream");
+
+	Common::MemoryReadStream labels(getData(_header.labelOffset, _header.labelCount * kLabelSize),
+	                                _header.labelCount * kLabelSize);
+
+	size_t tableSize = 16;
+	while (tableSize < (2 * _header.labelCount))
+		tableSize <<= 1;
+
+	_labels.reserve(_header.labelCount);
+	_labelIndices.resize(_header.labelCount, kLabelNone);
+	_labelTable.resize(tableSize, kLabelNone);
+
+	for (uint32 i = 0; i < _header.labelCount; i++) {
+		_labels.push_back(Common::readStringFixed(labels, Common::kEncodingASCII, kLabelSize));
+
+		const char  *name = _labels.back().c_str();
+		const uint32 hash = hashLabel(name);
+
+		// Several labels with the same name are all identified by the first one
+		const uint32 existing = findLabel(name, hash);
+		if (existing != kLabelNone) {
+			_labelIndices[i] = existing;
+			continue;
+		}
+
+		size_t slot = hash & (_labelTable.size() - 1);
+		while (_labelTable[slot] != kLabelNone)
+			slot = (slot + 1) & (_labelTable.size() - 1);
+
+		_labelTable[slot] = i;
+		_labelIndices[i]  = i;
+	}
+}
+
 void GFF3File::loadStructs() {
 	static const uint32 kStructSize = 12;
 
+	if (_header.structCount > ((_dataSize - _header.structOffset) / kStructSize))
+		throw Common::Exception("GFF3: Struct definitions point outside stream");
+
 	_structs.reserve(_header.structCount);
 	for (uint32 i = 0; i < _header.structCount; i++)
 		_structs.push_back(new GFF3Struct(*this, _header.structOffset + i * kStructSize));
@@ -204,13 +280,16 @@ void GFF3File::loadLists() {
 	 * list of lists into a list index.
 	 */
 
-	_stream->seek(_header.listIndicesOffset);
+	if (_header.listIndicesCount > (_dataSize - _header.listIndicesOffset))
+		throw Common::Exception("GFF3: List indices point outside stream");
+
+	const byte *listData = getData(_header.listIndicesOffset, _header.listIndicesCount);
 
 	// Read list array
 	std::vector<uint32> rawLists;
 	rawLists.resize(_header.listIndicesCount / 4);
-	for (std::vector<uint32>::iterator it = rawLists.begin(); it != rawLists.end(); ++it)
-		*it = _stream->readUint32LE();
+	for (size_t i = 0; i < rawLists.size(); i++)
+		rawLists[i] = READ_LE_UINT32(listData + i * 4);
 
 	// Counting the actual amount of lists
 	uint32 listCount = 0;
@@ -248,8 +327,57 @@ void GFF3File::loadLists() {
 	}
 }
 
+uint32 GFF3File::hashLabel(const char *name) {
+	// FNV-1a, over the raw bytes of the label
+	uint32 hash = 2166136261U;
+	while (*name)
+		hash = (hash ^ ((byte) *name++)) * 16777619U;
+
+	return hash;
+}
+
+uint32 GFF3File::findLabel(const char *name, uint32 hash) const {
+	for (size_t slot = hash & (_labelTable.size() - 1); _labelTable[slot] != kLabelNone;
+	     slot = (slot + 1) & (_labelTable.size() - 1)) {
+
+		if (std::strcmp(_labels[_labelTable[slot]].c_str(), name) == 0)
+			return _labelTable[slot];
+	}
+
+	return kLabelNone;
+}
+
 // --- Helpers for GFF3Struct ---
 
+const byte *GFF3File::getData(size_t offset, size_t size) const {
+	if ((offset > _dataSize) || (size > (_dataSize - offset)))
+		throw Common::Exception("GFF3: Data out of range (%u + %u > %u)",
+		                        (uint) offset, (uint) size, (uint) _dataSize);
+
+	return _data + offset;
+}
+
+uint32 GFF3File::findLabel(const Common::UString &name) const {
+	if (_labelTable.empty())
+		return kLabelNone;
+
+	return findLabel(name.c_str(), hashLabel(name.c_str()));
+}
+
+uint32 GFF3File::getLabelIndex(uint32 label) const {
+	if (label >= _labelIndices.size())
+		throw Common::Exception("GFF3: Label index out of range (%u >= %u)", label, (uint) _labelIndices.size());
+
+	return _labelIndices[label];
+}
+
+const Common::UString &GFF3File::getLabel(uint32 label) const {
+	if (label >= _labels.size())
+		throw Common::Exception("GFF3: Label index out of range (%u >= %u)", label, (uint) _labels.size());
+
+	return _labels[label];
+}
+
 const GFF3Struct &GFF3File::getStruct(uint32 i) const {
 	if (i >= _structs.size())
 		throw Common::Exception("GFF3: Struct index out of range (%u >= %u)", i, (uint) _structs.size());
@@ -283,10 +411,10 @@ Common::SeekableReadStream &GFF3File::getFieldData() const {
 }
 
 
-GFF3Struct::Field::Field() : type(kFieldTypeNone), data(0), extended(false) {
+GFF3Struct::Field::Field() : type(kFieldTypeNone), data(0), label(GFF3File::kLabelNone), extended(false) {
 }
 
-GFF3Struct::Field::Field(FieldType t, uint32 d) : type(t), data(d) {
+GFF3Struct::Field::Field(FieldType t, uint32 d, uint32 l) : type(t), data(d), label(l) {
 	// These field types need extended field data
 	extended = (type == kFieldTypeUint64     ) ||
 	           (type == kFieldTypeSint64     ) ||
@@ -300,8 +428,12 @@ GFF3Struct::Field::Field(FieldType t, uint32 d) : type(t), data(d) {
 	           (type == kFieldTypeStrRef     );
 }
 
+bool GFF3Struct::Field::operator<(const Field &right) const {
+	return label < right.label;
+}
 
-GFF3Struct::GFF3Struct(const GFF3File &parent, uint32 offset) : _parent(&parent) {
+
+GFF3Struct::GFF3Struct(const GFF3File &parent, uint32 offset) : _parent(&parent), _loadedFields(false) {
 	load(offset);
 }
 
@@ -315,71 +447,75 @@ uint32 GFF3Struct::getID() const {
 // --- Loader ---
 
 void GFF3Struct::load(uint32 offset) {
-	Common::SeekableReadStream &data = _parent->getStream(offset);
-
-	_id         = data.readUint32LE();
-	_fieldIndex = data.readUint32LE();
-	_fieldCount = data.readUint32LE();
+	// Only read the struct definition. The fields are read on first access
+	const byte *data = _parent->getData(offset, 12);
 
-	// Read the field(s)
-	if      (_fieldCount == 1)
-		readField (data, _fieldIndex);
-	else if (_fieldCount > 1)
-		readFields(data, _fieldIndex, _fieldCount);
+	_id         = READ_LE_UINT32(data + 0);
+	_fieldIndex = READ_LE_UINT32(data + 4);
+	_fieldCount = READ_LE_UINT32(data + 8);
 }
 
-void GFF3Struct::readField(Common::SeekableReadStream &data, uint32 index) {
-	// Sanity check
-	if (index > _parent->_header.fieldCount)
-		throw Common::Exception("GFF3: Field index out of range (%d/%d)",
-				index, _parent->_header.fieldCount);
+void GFF3Struct::loadFields() const {
+	if (_loadedFields.load(boost::memory_order_acquire))
+		return;
 
-	// Seek
-	data.seek(_parent->_header.fieldOffset + index * 12);
+	Common::StackLock lock(_parent->_mutex);
 
-	// Read the field data
-	const uint32 fieldType  = data.readUint32LE();
-	const uint32 fieldLabel = data.readUint32LE();
-	const uint32 fieldData  = data.readUint32LE();
+	// Another thread might have read the fields while we were waiting for the lock
+	if (_loadedFields.load(boost::memory_order_relaxed))
+		return;
 
-	// Read the name
-	Common::UString fieldName = readLabel(data, fieldLabel);
+	const byte *indices = readIndices();
 
-	// And add the field to the map and name list
-	_fields[fieldName] = Field((FieldType) fieldType, fieldData);
+	FieldArray fields;
+	fields.reserve(_fieldCount);
 
-	_fieldNames.push_back(fieldName);
-}
+	for (uint32 i = 0; i < _fieldCount; i++)
+		fields.push_back(readField(indices, i));
 
-void GFF3Struct::readFields(Common::SeekableReadStream &data, uint32 index, uint32 count) {
-	// Sanity check
-	if (index > _parent->_header.fieldIndicesCount)
-		throw Common::Exception("GFF3: Field indices index out of range (%d/%d)",
-		                        index , _parent->_header.fieldIndicesCount);
+	std::stable_sort(fields.begin(), fields.end());
 
-	// Seek
-	data.seek(_parent->_header.fieldIndicesOffset + index);
+	// Should a label appear several times, the last field with that label wins
+	_fields.clear();
+	_fields.reserve(fields.size());
 
-	// Read the field indices
-	std::vector<uint32> indices;
-	readIndices(data, indices, count);
+	for (size_t i = 0; i < fields.size(); i++)
+		if (((i + 1) == fields.size()) || (fields[i].label != fields[i + 1].label))
+			_fields.push_back(fields[i]);
 
-	// Read the fields
-	for (std::vector<uint32>::const_iterator i = indices.begin(); i != indices.end(); ++i)
-		readField(data, *i);
+	_loadedFields.store(true, boost::memory_order_release);
 }
 
-void GFF3Struct::readIndices(Common::SeekableReadStream &data,
-                             std::vector<uint32> &indices, uint32 count) const {
-	indices.reserve(count);
-	while (count-- > 0)
-		indices.push_back(data.readUint32LE());
+const byte *GFF3Struct::readIndices() const {
+	// A struct with only one field directly references that field
+	if (_fieldCount <= 1)
+		return 0;
+
+	const uint32 indicesCount = _parent->_header.fieldIndicesCount;
+
+	// Sanity check
+	if ((_fieldIndex > indicesCount) || (_fieldCount > ((indicesCount - _fieldIndex) / 4)))
+		throw Common::Exception("GFF3: Field indices index out of range (%u+%u/%u)",
+		                        _fieldIndex, _fieldCount, indicesCount);
+
+	return _parent->getData(_parent->_header.fieldIndicesOffset + (size_t) _fieldIndex, _fieldCount * 4);
 }
 
-Common::UString GFF3Struct::readLabel(Common::SeekableReadStream &data, uint32 index) const {
-	data.seek(_parent->_header.labelOffset + index * 16);
+GFF3Struct::Field GFF3Struct::readField(const byte *indices, uint32 n) const {
+	const uint32 index = indices ? READ_LE_UINT32(indices + n * 4) : _fieldIndex;
+
+	// Sanity check
+	if (index >= _parent->_header.fieldCount)
+		throw Common::Exception("GFF3: Field index out of range (%u/%u)",
+		                        index, _parent->_header.fieldCount);
 
-	return Common::readStringFixed(data, Common::kEncodingASCII, 16);
+	const byte *field = _parent->getData(_parent->_header.fieldOffset + index * (size_t) 12, 12);
+
+	const uint32 fieldType  = READ_LE_UINT32(field + 0);
+	const uint32 fieldLabel = READ_LE_UINT32(field + 4);
+	const uint32 fieldData  = READ_LE_UINT32(field + 8);
+
+	return Field((FieldType) fieldType, fieldData, _parent->getLabelIndex(fieldLabel));
 }
 
 Common::SeekableReadStream &GFF3Struct::getData(const Field &field) const {
@@ -394,6 +530,8 @@ Common::SeekableReadStream &GFF3Struct::getData(const Field &field) const {
 // --- Field properties ---
 
 size_t GFF3Struct::getFieldCount() const {
+	loadFields();
+
 	return _fields.size();
 }
 
@@ -402,6 +540,20 @@ bool GFF3Struct::hasField(const Common::UString &field) const {
 }
 
 const std::vector<Common::UString> &GFF3Struct::getFieldNames() const {
+	Common::StackLock lock(_parent->_mutex);
+
+	if (_fieldNames.empty() && (_fieldCount > 0)) {
+		const byte *indices = readIndices();
+
+		std::vector<Common::UString> fieldNames;
+		fieldNames.reserve(_fieldCount);
+
+		for (uint32 i = 0; i < _fieldCount; i++)
+			fieldNames.push_back(_parent->getLabel(readField(indices, i).label));
+
+		_fieldNames.swap(fieldNames);
+	}
+
 	return _fieldNames;
 }
 
@@ -416,11 +568,19 @@ GFF3Struct::FieldType GFF3Struct::getFieldType(const Common::UString &field) con
 // --- Field value reader helpers ---
 
 const GFF3Struct::Field *GFF3Struct::getField(const Common::UString &name) const {
-	FieldMap::const_iterator field = _fields.find(name);
-	if (field == _fields.end())
+	const uint32 label = _parent->findLabel(name);
+	if (label == GFF3File::kLabelNone)
+		return 0;
+
+	loadFields();
+
+	const Field key(kFieldTypeNone, 0, label);
+
+	FieldArray::const_iterator field = std::lower_bound(_fields.begin(), _fields.end(), key);
+	if ((field == _fields.end()) || (field->label != label))
 		return 0;
 
-	return &field->second;
+	return &*field;
 }
 
 char GFF3Struct::getChar(const Common::UString &field, char def) const {
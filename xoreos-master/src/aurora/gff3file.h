@@ -26,7 +26,6 @@
 #define AURORA_GFF3FILE_H
 
 #include <vector>
-#include <map>
 
 #include <boost/noncopyable.hpp>
 
@@ -34,6 +33,8 @@
 #include "src/common/scopedptr.h"
 #include "src/common/ptrvector.h"
 #include "src/common/ustring.h"
+#include "src/common/mutex.h"
+#include "src/common/atomic.h"
 
 #include "src/aurora/types.h"
 #include "src/aurora/aurorafile.h"
@@ -79,6 +80,13 @@ class GFF3Struct;
  *  LocStrings is different. Since xoreos has more flexible handling of
  *  language IDs anyway, this doesn't concern us.
  *
+ *  The whole file is kept in memory as one contiguous block, and the field
+ *  labels are interned once, when the file is loaded. The fields of a struct
+ *  are only read the first time the struct is accessed, into a small index
+ *  sorted by label, so that big files with lots of structs that are never
+ *  touched are cheap to load. Reading them is guarded by a mutex, so the
+ *  fields of the same struct can be looked up from several threads.
+ *
  *  See also: GFF4File in gff4file.h for the later V4.0/V4.1 versions of
  *  the GFF format.
  */
@@ -121,9 +129,15 @@ private:
 	typedef Common::PtrVector<GFF3Struct> StructArray;
 	typedef std::vector<GFF3List> ListArray;
 
+	/** Label index of a label that doesn't exist in the GFF3. */
+	static const uint32 kLabelNone = 0xFFFFFFFF;
+
 
 	Common::ScopedPtr<Common::SeekableReadStream> _stream;
 
+	const byte *_data;     ///< The whole GFF3, in memory.
+	size_t      _dataSize; ///< The size of the whole GFF3.
+
 	Header _header; ///< The GFF3's header.
 
 	/** Should we try to read GFF3 files found in Neverwinter Nights premium modules? */
@@ -137,12 +151,28 @@ private:
 	/** To convert list offsets found in GFF3 to real indices. */
 	std::vector<uint32> _listOffsetToIndex;
 
+	/** All field labels, interned once for the whole file. */
+	std::vector<Common::UString> _labels;
+	/** For each label, the index of the first label with the same name. */
+	std::vector<uint32> _labelIndices;
+	/** Open-addressing hash table of label indices, for finding labels by name. */
+	std::vector<uint32> _labelTable;
+
+	/** Guards the fields the structs read on first access. */
+	mutable Common::Mutex _mutex;
+
 
 	// .--- Loading helpers
 	void load(uint32 id);
+	void loadData();
 	void loadHeader(uint32 id);
+	void loadLabels();
 	void loadStructs();
 	void loadLists();
+
+	uint32 findLabel(const char *name, uint32 hash) const;
+
+	static uint32 hashLabel(const char *name);
 	// '---
 
 	// .--- Helper methods called by GFF3Struct
@@ -151,6 +181,16 @@ private:
 	/** Return the GFF3 stream seeked to the start of the field data. */
 	Common::SeekableReadStream &getFieldData() const;
 
+	/** Return a pointer to this area of the GFF3, throwing if it's out of bounds. */
+	const byte *getData(size_t offset, size_t size) const;
+
+	/** Return the index of the label with this name, or kLabelNone if there's none. */
+	uint32 findLabel(const Common::UString &name) const;
+	/** Return the index that identifies all labels with the same name as this one. */
+	uint32 getLabelIndex(uint32 label) const;
+	/** Return the name of this label. */
+	const Common::UString &getLabel(uint32 label) const;
+
 	/** Return a struct within the GFF3. */
 	const GFF3Struct &getStruct(uint32 i) const;
 	/** Return a list within the GFF3. */
@@ -246,13 +286,17 @@ private:
 	struct Field {
 		FieldType type;     ///< Type of the field.
 		uint32    data;     ///< Data of the field.
+		uint32    label;    ///< Index of the field's label.
 		bool      extended; ///< Does this field need extended data?
 
 		Field();
-		Field(FieldType t, uint32 d);
+		Field(FieldType t, uint32 d, uint32 l);
+
+		bool operator<(const Field &right) const;
 	};
 
-	typedef std::map<Common::UString, Field> FieldMap;
+	/** The fields of a struct, sorted by their label index. */
+	typedef std::vector<Field> FieldArray;
 
 
 	const GFF3File *_parent; ///< The parent GFF3.
@@ -261,10 +305,14 @@ private:
 	uint32 _fieldIndex; ///< Field / Field indices index.
 	uint32 _fieldCount; ///< Field count.
 
-	FieldMap _fields; ///< The fields, indexed by their label.
+	/** Have the fields been read yet? */
+	mutable boost::atomic<bool> _loadedFields;
+
+	/** The fields, read on first access. */
+	mutable FieldArray _fields;
 
-	/** The names of all fields in this struct. */
-	std::vector<Common::UString> _fieldNames;
+	/** The names of all fields in this struct, collected on first request. */
+	mutable std::vector<Common::UString> _fieldNames;
 
 
 	// .--- Loader
@@ -273,12 +321,13 @@ private:
 
 	void load(uint32 offset);
 
-	void readField  (Common::SeekableReadStream &data, uint32 index);
-	void readFields (Common::SeekableReadStream &data, uint32 index, uint32 count);
-	void readIndices(Common::SeekableReadStream &data,
-	                 std::vector<uint32> &indices, uint32 count) const;
+	/** Read the fields of this struct, if that hasn't been done yet. */
+	void loadFields() const;
 
-	Common::UString readLabel(Common::SeekableReadStream &data, uint32 index) const;
+	/** Read the field indices of this struct. */
+	const byte *readIndices() const;
+	/** Read the nth field of this struct. */
+	Field readField(const byte *indices, uint32 n) const;
 	// '---
 
 	// .--- Field and field data accessors
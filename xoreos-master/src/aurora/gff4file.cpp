@@ -28,8 +28,13 @@
 
 #include <cassert>
 
+#include <algorithm>
+
 #include "src/common/error.h"
+#include "src/common/endianness.h"
 #include "src/common/readstream.h"
+#include "src/common/memreadstream.h"
+#include "src/common/util.h"
 #include "src/common/encoding.h"
 #include "src/common/strutil.h"
 #include "src/common/matrix4x4.h"
@@ -44,6 +49,8 @@ static const uint32 kVersion41 = MKTAG('V', '4', '.', '1');
 
 namespace Aurora {
 
+const uint32 GFF4File::kNoStructs;
+
 void GFF4File::Header::read(Common::SeekableReadStream &gff4, uint32 version) {
 	platformID   = gff4.readUint32BE();
 	type         = gff4.readUint32BE();
@@ -66,7 +73,7 @@ void GFF4File::Header::read(Common::SeekableReadStream &gff4, uint32 version) {
 
 
 GFF4File::GFF4File(Common::SeekableReadStream *gff4, uint32 type) :
-	_stream(gff4), _topLevelStruct(0) {
+	_stream(gff4), _data(0), _dataSize(0), _topLevelStruct(0) {
 
 	assert(_stream);
 
@@ -74,7 +81,7 @@ GFF4File::GFF4File(Common::SeekableReadStream *gff4, uint32 type) :
 }
 
 GFF4File::GFF4File(const Common::UString &gff4, FileType fileType, uint32 type) :
-	_topLevelStruct(0) {
+	_data(0), _dataSize(0), _topLevelStruct(0) {
 
 	_stream.reset(ResMan.getResource(gff4, fileType));
 	if (!_stream)
@@ -88,13 +95,16 @@ GFF4File::~GFF4File() {
 }
 
 void GFF4File::clear() {
-	_stream.reset();
-
 	for (StructMap::iterator s = _structs.begin(); s != _structs.end(); ++s)
 		delete s->second;
 
 	_structs.clear();
 	_topLevelStruct = 0;
+
+	_stream.reset();
+
+	_data     = 0;
+	_dataSize = 0;
 }
 
 uint32 GFF4File::getType() const {
@@ -120,6 +130,7 @@ const GFF4Struct &GFF4File::getTopLevel() const {
 void GFF4File::load(uint32 type) {
 	try {
 
+		loadData();
 		loadHeader(type);
 		loadStructs();
 		loadStrings();
@@ -132,6 +143,26 @@ void GFF4File::load(uint32 type) {
 	}
 }
 
+void GFF4File::loadData() {
+	/* We want the whole GFF4 in one contiguous block of memory, so that field
+	 * values can be read directly. If the stream already is in memory, we use
+	 * its data as is. Otherwise, we read the whole stream into memory once. */
+
+	const size_t pos = _stream->pos();
+
+	Common::MemoryReadStream *memory = dynamic_cast<Common::MemoryReadStream *>(_stream.get());
+	if (!memory) {
+		memory = _stream->readStreamAt(0, _stream->size());
+
+		_stream.reset(memory);
+	}
+
+	_data     = memory->getData();
+	_dataSize = memory->size();
+
+	_stream->seek(pos);
+}
+
 void GFF4File::loadHeader(uint32 type) {
 	readHeader(*_stream);
 
@@ -161,7 +192,9 @@ void GFF4File::loadStructs() {
 	 * both reference the same struct template.
 	 *
 	 * So while in a GFF3, each individual struct said how its fields
-	 * looked, in a GFF4 this has been sourced out into these templates. */
+	 * looked, in a GFF4 this has been sourced out into these templates.
+	 * We keep it that way: the field layout, and the index to find a field
+	 * by its label, only exist once per template. */
 
 	static const uint32 kStructTemplateSize = 16;
 	const uint32 structTemplateStart = _stream->pos();
@@ -182,6 +215,9 @@ void GFF4File::loadStructs() {
 
 		strct.size = _stream->readUint32LE();
 
+		strct.fieldCount       = 0;
+		strct.structFieldCount = 0;
+
 		// Check if we need to read fields
 		if (fieldOffset == 0xFFFFFFFF) {
 			if (fieldCount != 0)
@@ -195,6 +231,9 @@ void GFF4File::loadStructs() {
 		// Read the field declarations
 
 		strct.fields.resize(fieldCount);
+		strct.fieldLabels.resize(fieldCount);
+		strct.fieldIndices.resize(fieldCount);
+
 		for (uint32 j = 0; j < fieldCount; j++) {
 			StructTemplate::Field &field = strct.fields[j];
 
@@ -202,7 +241,22 @@ void GFF4File::loadStructs() {
 			field.type   = _stream->readUint16LE();
 			field.flags  = _stream->readUint16LE();
 			field.offset = _stream->readUint32LE();
+
+			// Struct and generic fields get a list of structs in each struct instance
+			const bool isStruct  = (field.flags & 0x4000) != 0;
+			const bool isGeneric = !isStruct && (field.type == GFF4Struct::kFieldTypeGeneric);
+
+			field.structs = (isStruct || isGeneric) ? strct.structFieldCount++ : kNoStructs;
+
+			strct.fieldLabels[j]  = field.label;
+			strct.fieldIndices[j] = std::make_pair(field.label, j);
 		}
+
+		std::sort(strct.fieldIndices.begin(), strct.fieldIndices.end());
+
+		for (uint32 j = 0; j < fieldCount; j++)
+			if ((j == 0) || (strct.fieldIndices[j].first != strct.fieldIndices[j - 1].first))
+				strct.fieldCount++;
 	}
 
 	/* And load the top level struct, which itself recurses into field structs.
@@ -260,14 +314,22 @@ GFF4Struct *GFF4File::findStruct(uint64 id) {
 	return s->second;
 }
 
-Common::SeekableReadStream &GFF4File::getStream(uint32 offset) const {
-	_stream->seek(offset);
+uint32 GFF4File::getDataOffset() const {
+	return _header.dataOffset;
+}
+
+const byte *GFF4File::getData(size_t offset, size_t size) const {
+	if ((offset > _dataSize) || (size > (_dataSize - offset)))
+		throw Common::Exception("GFF4: Data out of range (%u + %u > %u)",
+		                        (uint) offset, (uint) size, (uint) _dataSize);
 
-	return *_stream;
+	return _data + offset;
 }
 
-uint32 GFF4File::getDataOffset() const {
-	return _header.dataOffset;
+size_t GFF4File::getOffset(const byte *data) const {
+	assert((data >= _data) && (data <= (_data + _dataSize)));
+
+	return data - _data;
 }
 
 const GFF4File::StructTemplate &GFF4File::getStructTemplate(uint32 i) const {
@@ -295,12 +357,12 @@ Common::UString GFF4File::getSharedString(uint32 i) const {
 
 
 GFF4Struct::Field::Field() : label(0), type(kFieldTypeNone), offset(0xFFFFFFFF),
-	isList(false), isReference(false), isGeneric(false), structIndex(0) {
+	isList(false), isReference(false), isGeneric(false), structIndex(0), structs(GFF4File::kNoStructs) {
 
 }
 
 GFF4Struct::Field::Field(uint32 l, uint16 t, uint16 f, uint32 o, bool g) :
-	label(l), offset(o), isGeneric(g) {
+	label(l), offset(o), isGeneric(g), structs(GFF4File::kNoStructs) {
 
 	isList      = (f & 0x8000) != 0;
 	isReference = (f & 0x2000) != 0;
@@ -339,9 +401,13 @@ GFF4Struct::Field::Field(uint32 l, uint16 t, uint16 f, uint32 o, bool g) :
 GFF4Struct::Field::~Field() {
 }
 
+bool GFF4Struct::Field::operator<(const Field &right) const {
+	return label < right.label;
+}
+
 
 GFF4Struct::GFF4Struct(GFF4File &parent, uint32 offset, const GFF4File::StructTemplate &tmplt) :
-	_parent(&parent), _label(tmplt.label), _refCount(0), _fieldCount(0) {
+	_parent(&parent), _template(&tmplt), _offset(offset), _label(tmplt.label), _refCount(0), _fieldCount(0) {
 
 	// Constructor for a real struct, from a template
 
@@ -357,7 +423,7 @@ GFF4Struct::GFF4Struct(GFF4File &parent, uint32 offset, const GFF4File::StructTe
 }
 
 GFF4Struct::GFF4Struct(GFF4File &parent, const Field &genericParent) :
-	_parent(&parent), _label(0), _refCount(0), _fieldCount(0) {
+	_parent(&parent), _template(0), _offset(genericParent.offset), _label(0), _refCount(0), _fieldCount(0) {
 
 	// Constructor for a generic, converted into a struct
 
@@ -392,23 +458,24 @@ uint32 GFF4Struct::getLabel() const {
 void GFF4Struct::load(GFF4File &parent, uint32 offset, const GFF4File::StructTemplate &tmplt) {
 	/* Loader for a real struct, from a template.
 	 *
-	 * Go through all the fields in the template and create field
-	 * instances within this struct instance. If the field is itself
-	 * a struct, recursively create a new struct instance for it. If
-	 * the field is a generic, create a struct for it as well. */
+	 * The field layout is shared with all other structs from the same
+	 * template, so we only need to check the fields, and recursively
+	 * create the struct instances of fields that are structs or generics. */
+
+	_structs.resize(tmplt.structFieldCount);
 
 	for (size_t i = 0; i < tmplt.fields.size(); i++) {
 		const GFF4File::StructTemplate::Field &field = tmplt.fields[i];
 
-		_fieldLabels.push_back(field.label);
-
 		// Calculate the offset for the field data, but guard against NULL pointers
 		uint32 fieldOffset = offset + field.offset;
 		if ((offset == 0xFFFFFFFF) || (field.offset == 0xFFFFFFFF))
 			fieldOffset = 0xFFFFFFFF;
 
-		// Load the field and its struct(s), if any
-		Field &f = _fields[field.label] = Field(field.label, field.type, field.flags, fieldOffset);
+		// Load the field's struct(s), if any
+		Field f(field.label, field.type, field.flags, fieldOffset);
+		f.structs = field.structs;
+
 		if (f.type == kFieldTypeStruct)
 			loadStructs(parent, f);
 		if (f.type == kFieldTypeGeneric)
@@ -418,7 +485,7 @@ void GFF4Struct::load(GFF4File &parent, uint32 offset, const GFF4File::StructTem
 			throw Common::Exception("GFF4: TODO: ASCII string field in a file with shared strings");
 	}
 
-	_fieldCount = _fields.size();
+	_fieldCount = tmplt.fieldCount;
 }
 
 void GFF4Struct::loadStructs(GFF4File &parent, Field &field) {
@@ -442,13 +509,25 @@ void GFF4Struct::loadStructs(GFF4File &parent, Field &field) {
 
 	const GFF4File::StructTemplate &tmplt = parent.getStructTemplate(field.structIndex);
 
-	Common::SeekableReadStream &data = parent.getStream(field.offset);
+	size_t structStart = field.offset;
 
-	const uint32 structCount = getListCount(data, field);
-	const uint32 structSize  = field.isReference ? 4 : tmplt.size;
-	const uint32 structStart = data.pos();
+	uint32 structCount = 1;
+	if (field.isList) {
+		const uint32 listOffset = READ_LE_UINT32(parent.getData(field.offset, 4));
+
+		structCount = 0;
+		if (listOffset != 0xFFFFFFFF) {
+			structStart = (size_t) parent.getDataOffset() + listOffset;
+			structCount = READ_LE_UINT32(parent.getData(structStart, 4));
+			structStart += 4;
+		}
+	}
 
-	field.structs.resize(structCount, 0);
+	const uint32 structSize = field.isReference ? 4 : tmplt.size;
+
+	GFF4List &structs = _structs[field.structs];
+
+	structs.resize(structCount, 0);
 	for (uint32 i = 0; i < structCount; i++) {
 		const uint32 offset = getDataOffset(field.isReference, structStart + i * structSize);
 		if (offset == 0xFFFFFFFF)
@@ -460,7 +539,7 @@ void GFF4Struct::loadStructs(GFF4File &parent, Field &field) {
 
 		strct->_refCount++;
 
-		field.structs[i] = strct;
+		structs[i] = strct;
 	}
 }
 
@@ -477,7 +556,7 @@ void GFF4Struct::loadGeneric(GFF4File &parent, Field &field) {
 
 	strct->_refCount++;
 
-	field.structs.push_back(strct);
+	_structs[field.structs].push_back(strct);
 }
 
 void GFF4Struct::load(GFF4File &parent, const Field &genericParent) {
@@ -489,28 +568,38 @@ void GFF4Struct::load(GFF4File &parent, const Field &genericParent) {
 
 	static const uint32 kGenericSize = 8;
 
-	Common::SeekableReadStream &data = parent.getStream(genericParent.offset);
+	size_t genericStart = genericParent.offset;
 
-	const uint32 genericCount = genericParent.isList ? data.readUint32LE() : 1;
-	const uint32 genericStart = data.pos();
+	uint32 genericCount = 1;
+	if (genericParent.isList) {
+		genericCount  = READ_LE_UINT32(parent.getData(genericStart, 4));
+		genericStart += 4;
+	}
 
 	for (uint32 i = 0; i < genericCount; i++) {
-		data.seek(genericStart + i * kGenericSize);
+		const byte *generic = parent.getData(genericStart + i * kGenericSize, kGenericSize);
 
-		const uint16 fieldType   = data.readUint16LE();
-		const uint16 fieldFlags  = data.readUint16LE();
+		const uint16 fieldType   = READ_LE_UINT16(generic + 0);
+		const uint16 fieldFlags  = READ_LE_UINT16(generic + 2);
 
-		const uint32 fieldOffset = getDataOffset(genericParent.isReference, data.pos());
+		const uint32 fieldOffset = getDataOffset(genericParent.isReference, genericStart + i * kGenericSize + 4);
 
 		if (fieldOffset == 0xFFFFFFFF)
 			continue;
 
-		_fieldLabels.push_back(i);
+		_genericLabels.push_back(i);
 
 		// Load the field and its struct(s), if any
-		Field &f = _fields[i] = Field(i, fieldType, fieldFlags, fieldOffset, true);
-		if (f.type == kFieldTypeStruct)
+		_genericFields.push_back(Field(i, fieldType, fieldFlags, fieldOffset, true));
+
+		Field &f = _genericFields.back();
+		if (f.type == kFieldTypeStruct) {
+			f.structs = _structs.size();
+			_structs.push_back(GFF4List());
+
 			loadStructs(parent, f);
+		}
+
 		if (f.type == kFieldTypeGeneric)
 			throw Common::Exception("GFF4: Found a generic with type generic?");
 
@@ -539,11 +628,15 @@ size_t GFF4Struct::getFieldCount() const {
 }
 
 bool GFF4Struct::hasField(uint32 field) const {
-	return getField(field) != 0;
+	Field f;
+	return findField(field, f);
 }
 
 const std::vector<uint32> &GFF4Struct::getFieldLabels() const {
-	return _fieldLabels;
+	if (_template)
+		return _template->fieldLabels;
+
+	return _genericLabels;
 }
 
 GFF4Struct::FieldType GFF4Struct::getFieldType(uint32 field) const {
@@ -552,44 +645,75 @@ GFF4Struct::FieldType GFF4Struct::getFieldType(uint32 field) const {
 }
 
 GFF4Struct::FieldType GFF4Struct::getFieldType(uint32 field, bool &isList) const {
-	const Field *f = getField(field);
-	if (!f)
+	Field f;
+	if (!findField(field, f))
 		return kFieldTypeNone;
 
-	isList = f->isList;
+	isList = f.isList;
 
-	return f->type;
+	return f.type;
 }
 
 bool GFF4Struct::getFieldProperties(uint32 field, FieldType &type, uint32 &label, bool &isList) const {
-	const Field *f = getField(field);
-	if (!f)
+	Field f;
+	if (!findField(field, f))
 		return false;
 
-	type   = f->type;
-	label  = f->label;
-	isList = f->isList;
+	type   = f.type;
+	label  = f.label;
+	isList = f.isList;
 
 	return true;
 }
 
 // --- Field value reader helpers ---
 
-const GFF4Struct::Field *GFF4Struct::getField(uint32 field) const {
-	FieldMap::const_iterator f = _fields.find(field);
-	if (f == _fields.end())
-		return 0;
+bool GFF4Struct::findField(uint32 fieldID, Field &field) const {
+	if (!_template) {
+		// A mapped generic, which has its own fields, sorted by label
+		const Field key(fieldID, kFieldTypeUint8, 0, 0xFFFFFFFF, true);
+
+		FieldArray::const_iterator f = std::upper_bound(_genericFields.begin(), _genericFields.end(), key);
+		if ((f == _genericFields.begin()) || ((--f)->label != fieldID))
+			return false;
+
+		field = *f;
+		return true;
+	}
+
+	/* Look up the field in the template's shared layout. Should a label appear
+	 * several times, the last field with that label wins. */
+
+	typedef GFF4File::StructTemplate::FieldIndex FieldIndex;
+	const std::vector<FieldIndex> &indices = _template->fieldIndices;
+
+	std::vector<FieldIndex>::const_iterator i =
+		std::upper_bound(indices.begin(), indices.end(), std::make_pair(fieldID, (uint32) 0xFFFFFFFF));
+	if ((i == indices.begin()) || ((--i)->first != fieldID))
+		return false;
+
+	const GFF4File::StructTemplate::Field &f = _template->fields[i->second];
+
+	// Calculate the offset for the field data, but guard against NULL pointers
+	uint32 fieldOffset = _offset + f.offset;
+	if ((_offset == 0xFFFFFFFF) || (f.offset == 0xFFFFFFFF))
+		fieldOffset = 0xFFFFFFFF;
 
-	return &f->second;
+	field = Field(f.label, f.type, f.flags, fieldOffset);
+	field.structs = f.structs;
+
+	// The data of a generic field is the generic itself
+	if (field.type == kFieldTypeGeneric)
+		field.offset = getDataOffset(field.isList, field.offset);
+
+	return true;
 }
 
 uint32 GFF4Struct::getDataOffset(bool isReference, uint32 offset) const {
 	if (!isReference || (offset == 0xFFFFFFFF))
 		return offset;
 
-	Common::SeekableReadStream &data = _parent->getStream(offset);
-
-	offset = data.readUint32LE();
+	offset = READ_LE_UINT32(_parent->getData(offset, 4));
 	if (offset == 0xFFFFFFFF)
 		return offset;
 
@@ -603,19 +727,45 @@ uint32 GFF4Struct::getDataOffset(const Field &field) const {
 	return getDataOffset(field.isReference, field.offset);
 }
 
-Common::SeekableReadStream *GFF4Struct::getData(const Field &field) const {
+const byte *GFF4Struct::getField(uint32 fieldID, Field &field) const {
+	if (!findField(fieldID, field))
+		return 0;
+
 	const uint32 offset = getDataOffset(field);
 	if (offset == 0xFFFFFFFF)
 		return 0;
 
-	return &_parent->getStream(offset);
+	// A list field only holds the offset to the list
+	return _parent->getData(offset, field.isList ? 4 : getFieldSize(field.type));
 }
 
-Common::SeekableReadStream *GFF4Struct::getField(uint32 fieldID, const Field *&field) const {
-	if (!(field = getField(fieldID)))
+const byte *GFF4Struct::getListField(uint32 fieldID, Field &field, uint32 &count) const {
+	count = 0;
+
+	if (!findField(fieldID, field))
+		return 0;
+
+	size_t offset = getDataOffset(field);
+	if (offset == 0xFFFFFFFF)
 		return 0;
 
-	return getData(*field);
+	const uint32 size = getFieldSize(field.type);
+
+	if (!field.isList) {
+		count = 1;
+
+		return _parent->getData(offset, size);
+	}
+
+	const uint32 listOffset = READ_LE_UINT32(_parent->getData(offset, 4));
+	if (listOffset == 0xFFFFFFFF)
+		return _parent->getData(offset, 0);
+
+	offset = (size_t) _parent->getDataOffset() + listOffset;
+
+	count = READ_LE_UINT32(_parent->getData(offset, 4));
+
+	return _parent->getData(offset + 4, (size_t) count * size);
 }
 
 uint32 GFF4Struct::getVectorMatrixLength(const Field &field, uint32 minLength, uint32 maxLength) const {
@@ -639,20 +789,7 @@ uint32 GFF4Struct::getVectorMatrixLength(const Field &field, uint32 minLength, u
 	return length;
 }
 
-uint32 GFF4Struct::getListCount(Common::SeekableReadStream &data, const Field &field) const {
-	if (!field.isList)
-		return 1;
-
-	const uint32 listOffset = data.readUint32LE();
-	if (listOffset == 0xFFFFFFFF)
-		return 0;
-
-	data.seek(_parent->getDataOffset() + listOffset);
-
-	return data.readUint32LE();
-}
-
-uint32 GFF4Struct::getFieldSize(FieldType type) const {
+uint32 GFF4Struct::getFieldSize(FieldType type) {
 	switch (type) {
 		case kFieldTypeUint8:
 		case kFieldTypeSint8:
@@ -665,6 +802,7 @@ uint32 GFF4Struct::getFieldSize(FieldType type) const {
 		case kFieldTypeUint32:
 		case kFieldTypeSint32:
 		case kFieldTypeFloat32:
+		case kFieldTypeNDSFixed:
 			return 4;
 
 		case kFieldTypeUint64:
@@ -703,31 +841,31 @@ uint32 GFF4Struct::getFieldSize(FieldType type) const {
 
 // --- Low-level value readers ---
 
-uint64 GFF4Struct::getUint(Common::SeekableReadStream &data, FieldType type) const {
+uint64 GFF4Struct::getUint(const byte *data, FieldType type) {
 	switch (type) {
 		case kFieldTypeUint8:
-			return (uint64) data.readByte();
+			return (uint64) *data;
 
 		case kFieldTypeSint8:
-			return (uint64) ((int64) data.readSByte());
+			return (uint64) ((int64) ((int8) *data));
 
 		case kFieldTypeUint16:
-			return (uint64) data.readUint16LE();
+			return (uint64) READ_LE_UINT16(data);
 
 		case kFieldTypeSint16:
-			return (uint64) ((int64) data.readSint16LE());
+			return (uint64) ((int64) ((int16) READ_LE_UINT16(data)));
 
 		case kFieldTypeUint32:
-			return (uint64) data.readUint32LE();
+			return (uint64) READ_LE_UINT32(data);
 
 		case kFieldTypeSint32:
-			return (uint64) ((int64) data.readSint32LE());
+			return (uint64) ((int64) ((int32) READ_LE_UINT32(data)));
 
 		case kFieldTypeUint64:
-			return (uint64) data.readUint64LE();
+			return (uint64) READ_LE_UINT64(data);
 
 		case kFieldTypeSint64:
-			return (uint64) ((int64) data.readSint64LE());
+			return (uint64) ((int64) READ_LE_UINT64(data));
 
 		default:
 			break;
@@ -736,31 +874,31 @@ uint64 GFF4Struct::getUint(Common::SeekableReadStream &data, FieldType type) con
 	throw Common::Exception("GFF4: Field is not an int type");
 }
 
-int64 GFF4Struct::getSint(Common::SeekableReadStream &data, FieldType type) const {
+int64 GFF4Struct::getSint(const byte *data, FieldType type) {
 	switch (type) {
 		case kFieldTypeUint8:
-			return (int64) ((uint64) data.readByte());
+			return (int64) ((uint64) *data);
 
 		case kFieldTypeSint8:
-			return (int64) data.readSByte();
+			return (int64) ((int8) *data);
 
 		case kFieldTypeUint16:
-			return (int64) ((uint64) data.readUint16LE());
+			return (int64) ((uint64) READ_LE_UINT16(data));
 
 		case kFieldTypeSint16:
-			return (int64) data.readSint16LE();
+			return (int64) ((int16) READ_LE_UINT16(data));
 
 		case kFieldTypeUint32:
-			return (int64) ((uint64) data.readUint32LE());
+			return (int64) ((uint64) READ_LE_UINT32(data));
 
 		case kFieldTypeSint32:
-			return (int64) data.readSint32LE();
+			return (int64) ((int32) READ_LE_UINT32(data));
 
 		case kFieldTypeUint64:
-			return (int64) ((uint64) data.readUint64LE());
+			return (int64) READ_LE_UINT64(data);
 
 		case kFieldTypeSint64:
-			return (int64) data.readSint64LE();
+			return (int64) READ_LE_UINT64(data);
 
 		default:
 			break;
@@ -769,16 +907,16 @@ int64 GFF4Struct::getSint(Common::SeekableReadStream &data, FieldType type) cons
 	throw Common::Exception("GFF4: Field is not an int type");
 }
 
-double GFF4Struct::getDouble(Common::SeekableReadStream &data, FieldType type) const {
+double GFF4Struct::getDouble(const byte *data, FieldType type) {
 	switch (type) {
 		case kFieldTypeFloat32:
-			return (double) data.readIEEEFloatLE();
+			return (double) convertIEEEFloat(READ_LE_UINT32(data));
 
 		case kFieldTypeFloat64:
-			return (double) data.readIEEEDoubleLE();
+			return (double) convertIEEEDouble(READ_LE_UINT64(data));
 
 		case kFieldTypeNDSFixed:
-			return readNintendoFixedPoint(data.readUint32LE(), true, 19, 12);
+			return readNintendoFixedPoint(READ_LE_UINT32(data), true, 19, 12);
 
 		default:
 			break;
@@ -787,16 +925,16 @@ double GFF4Struct::getDouble(Common::SeekableReadStream &data, FieldType type) c
 	throw Common::Exception("GFF4: Field is not a float type");
 }
 
-float GFF4Struct::getFloat(Common::SeekableReadStream &data, FieldType type) const {
+float GFF4Struct::getFloat(const byte *data, FieldType type) {
 	switch (type) {
 		case kFieldTypeFloat32:
-			return (float) data.readIEEEFloatLE();
+			return (float) convertIEEEFloat(READ_LE_UINT32(data));
 
 		case kFieldTypeFloat64:
-			return (float) data.readIEEEDoubleLE();
+			return (float) convertIEEEDouble(READ_LE_UINT64(data));
 
 		case kFieldTypeNDSFixed:
-			return (float) readNintendoFixedPoint(data.readUint32LE(), true, 19, 12);
+			return (float) readNintendoFixedPoint(READ_LE_UINT32(data), true, 19, 12);
 
 		default:
 			break;
@@ -805,17 +943,17 @@ float GFF4Struct::getFloat(Common::SeekableReadStream &data, FieldType type) con
 	throw Common::Exception("GFF4: Field is not a float type");
 }
 
-Common::UString GFF4Struct::getString(Common::SeekableReadStream &data, Common::Encoding encoding) const {
+Common::UString GFF4Struct::readString(size_t offset, Common::Encoding encoding) const {
 	/* When the string is encoded in UTF-8, then length field specifies the length in bytes.
 	 * Otherwise, it's the length in characters. */
 	const size_t lengthMult = encoding == Common::kEncodingUTF8 ? 1 : Common::getBytesPerCodepoint(encoding);
 
-	const size_t offset = data.pos();
-
-	const uint32 length = data.readUint32LE();
+	const uint32 length = READ_LE_UINT32(_parent->getData(offset, 4));
 	const size_t size   = length * lengthMult;
 
 	try {
+		Common::MemoryReadStream data(_parent->getData(offset + 4, size), size);
+
 		return Common::readStringFixed(data, encoding, size);
 	} catch (...) {
 	}
@@ -823,39 +961,27 @@ Common::UString GFF4Struct::getString(Common::SeekableReadStream &data, Common::
 	return Common::UString::format("GFF4: Invalid string encoding (0x%08X)", (uint) offset);
 }
 
-Common::UString GFF4Struct::getString(Common::SeekableReadStream &data, Common::Encoding encoding,
-                                      uint32 offset) const {
-
-	const uint32 pos = data.seek(offset);
-
-	Common::UString str = getString(data, encoding);
-
-	data.seek(pos);
-
-	return str;
-}
-
-Common::UString GFF4Struct::getString(Common::SeekableReadStream &data, const Field &field,
-                                      Common::Encoding encoding) const {
+Common::UString GFF4Struct::readString(const byte *data, const Field &field,
+                                       Common::Encoding encoding) const {
 
 	if (field.type == kFieldTypeString) {
 		if (_parent->hasSharedStrings())
-			return _parent->getSharedString(data.readUint32LE());
+			return _parent->getSharedString(READ_LE_UINT32(data));
 
-		uint32 offset = data.pos();
+		size_t offset = _parent->getOffset(data);
 		if (!field.isGeneric) {
-			offset = data.readUint32LE();
+			offset = READ_LE_UINT32(data);
 			if (offset == 0xFFFFFFFF)
 				return "";
 
 			offset += _parent->getDataOffset();
 		}
 
-		return getString(data, encoding, offset);
+		return readString(offset, encoding);
 	}
 
 	if (field.type == kFieldTypeASCIIString)
-		return getString(data, Common::kEncodingASCII, data.pos());
+		return readString(_parent->getOffset(data), Common::kEncodingASCII);
 
 	throw Common::Exception("GFF4: Field is not a string type");
 }
@@ -863,27 +989,27 @@ Common::UString GFF4Struct::getString(Common::SeekableReadStream &data, const Fi
 // --- Single value readers ---
 
 uint64 GFF4Struct::getUint(uint32 field, uint64 def) const {
-	const Field *f;
-	Common::SeekableReadStream *data = getField(field, f);
+	Field f;
+	const byte *data = getField(field, f);
 	if (!data)
 		return def;
 
-	if (f->isList)
+	if (f.isList)
 		throw Common::Exception("GFF4: Tried reading list as singular value");
 
-	return getUint(*data, f->type);
+	return getUint(data, f.type);
 }
 
 int64 GFF4Struct::getSint(uint32 field, int64 def) const {
-	const Field *f;
-	Common::SeekableReadStream *data = getField(field, f);
+	Field f;
+	const byte *data = getField(field, f);
 	if (!data)
 		return def;
 
-	if (f->isList)
+	if (f.isList)
 		throw Common::Exception("GFF4: Tried reading list as singular value");
 
-	return getSint(*data, f->type);
+	return getSint(data, f.type);
 }
 
 bool GFF4Struct::getBool(uint32 field, bool def) const {
@@ -891,41 +1017,41 @@ bool GFF4Struct::getBool(uint32 field, bool def) const {
 }
 
 double GFF4Struct::getDouble(uint32 field, double def) const {
-	const Field *f;
-	Common::SeekableReadStream *data = getField(field, f);
+	Field f;
+	const byte *data = getField(field, f);
 	if (!data)
 		return def;
 
-	if (f->isList)
+	if (f.isList)
 		throw Common::Exception("GFF4: Tried reading list as singular value");
 
-	return getDouble(*data, f->type);
+	return getDouble(data, f.type);
 }
 
 float GFF4Struct::getFloat(uint32 field, float def) const {
-	const Field *f;
-	Common::SeekableReadStream *data = getField(field, f);
+	Field f;
+	const byte *data = getField(field, f);
 	if (!data)
 		return def;
 
-	if (f->isList)
+	if (f.isList)
 		throw Common::Exception("GFF4: Tried reading list as singular value");
 
-	return getFloat(*data, f->type);
+	return getFloat(data, f.type);
 }
 
 Common::UString GFF4Struct::getString(uint32 field, Common::Encoding encoding,
                                       const Common::UString &def) const {
 
-	const Field *f;
-	Common::SeekableReadStream *data = getField(field, f);
+	Field f;
+	const byte *data = getField(field, f);
 	if (!data)
 		return def;
 
-	if (f->isList)
+	if (f.isList)
 		throw Common::Exception("GFF4: Tried reading list as singular value");
 
-	return getString(*data, *f, encoding);
+	return readString(data, f, encoding);
 }
 
 Common::UString GFF4Struct::getString(uint32 field, const Common::UString &def) const {
@@ -935,26 +1061,26 @@ Common::UString GFF4Struct::getString(uint32 field, const Common::UString &def)
 bool GFF4Struct::getTalkString(uint32 field, Common::Encoding encoding,
                                uint32 &strRef, Common::UString &str) const {
 
-	const Field *f;
-	Common::SeekableReadStream *data = getField(field, f);
+	Field f;
+	const byte *data = getField(field, f);
 	if (!data)
 		return false;
 
-	if (f->type != kFieldTypeTlkString)
+	if (f.type != kFieldTypeTlkString)
 		throw Common::Exception("GFF4: Field is not of TalkString type");
-	if (f->isList)
+	if (f.isList)
 		throw Common::Exception("GFF4: Tried reading list as singular value");
 
-	strRef = getUint(*data, kFieldTypeUint32);
+	strRef = READ_LE_UINT32(data);
 
-	const uint32 offset = getUint(*data, kFieldTypeUint32);
+	const uint32 offset = READ_LE_UINT32(data + 4);
 
 	str.clear();
 	if (offset != 0xFFFFFFFF) {
 		if (_parent->hasSharedStrings())
 			str = _parent->getSharedString(offset);
 		else if (offset != 0)
-			str = getString(*data, encoding, _parent->getDataOffset() + offset);
+			str = readString((size_t) _parent->getDataOffset() + offset, encoding);
 	}
 
 	return true;
@@ -965,107 +1091,107 @@ bool GFF4Struct::getTalkString(uint32 field, uint32 &strRef, Common::UString &st
 }
 
 bool GFF4Struct::getVector3(uint32 field, double &v1, double &v2, double &v3) const {
-	const Field *f;
-	Common::SeekableReadStream *data = getField(field, f);
+	Field f;
+	const byte *data = getField(field, f);
 	if (!data)
 		return false;
 
-	if (f->isList)
+	if (f.isList)
 		throw Common::Exception("GFF4: Tried reading list as singular value");
 
-	getVectorMatrixLength(*f, 3, 3);
+	getVectorMatrixLength(f, 3, 3);
 
-	v1 = getDouble(*data, kFieldTypeFloat32);
-	v2 = getDouble(*data, kFieldTypeFloat32);
-	v3 = getDouble(*data, kFieldTypeFloat32);
+	v1 = getDouble(data + 0, kFieldTypeFloat32);
+	v2 = getDouble(data + 4, kFieldTypeFloat32);
+	v3 = getDouble(data + 8, kFieldTypeFloat32);
 
 	return true;
 }
 
 bool GFF4Struct::getVector3(uint32 field, float &v1, float &v2, float &v3) const {
-	const Field *f;
-	Common::SeekableReadStream *data = getField(field, f);
+	Field f;
+	const byte *data = getField(field, f);
 	if (!data)
 		return false;
 
-	if (f->isList)
+	if (f.isList)
 		throw Common::Exception("GFF4: Tried reading list as singular value");
 
-	getVectorMatrixLength(*f, 3, 3);
+	getVectorMatrixLength(f, 3, 3);
 
-	v1 = getFloat(*data, kFieldTypeFloat32);
-	v2 = getFloat(*data, kFieldTypeFloat32);
-	v3 = getFloat(*data, kFieldTypeFloat32);
+	v1 = getFloat(data + 0, kFieldTypeFloat32);
+	v2 = getFloat(data + 4, kFieldTypeFloat32);
+	v3 = getFloat(data + 8, kFieldTypeFloat32);
 
 	return true;
 }
 
 bool GFF4Struct::getVector4(uint32 field, double &v1, double &v2, double &v3, double &v4) const {
-	const Field *f;
-	Common::SeekableReadStream *data = getField(field, f);
+	Field f;
+	const byte *data = getField(field, f);
 	if (!data)
 		return false;
 
-	if (f->isList)
+	if (f.isList)
 		throw Common::Exception("GFF4: Tried reading list as singular value");
 
-	getVectorMatrixLength(*f, 4, 4);
+	getVectorMatrixLength(f, 4, 4);
 
-	v1 = getDouble(*data, kFieldTypeFloat32);
-	v2 = getDouble(*data, kFieldTypeFloat32);
-	v3 = getDouble(*data, kFieldTypeFloat32);
-	v4 = getDouble(*data, kFieldTypeFloat32);
+	v1 = getDouble(data +  0, kFieldTypeFloat32);
+	v2 = getDouble(data +  4, kFieldTypeFloat32);
+	v3 = getDouble(data +  8, kFieldTypeFloat32);
+	v4 = getDouble(data + 12, kFieldTypeFloat32);
 
 	return true;
 }
 
 bool GFF4Struct::getVector4(uint32 field, float &v1, float &v2, float &v3, float &v4) const {
-	const Field *f;
-	Common::SeekableReadStream *data = getField(field, f);
+	Field f;
+	const byte *data = getField(field, f);
 	if (!data)
 		return false;
 
-	if (f->isList)
+	if (f.isList)
 		throw Common::Exception("GFF4: Tried reading list as singular value");
 
-	getVectorMatrixLength(*f, 4, 4);
+	getVectorMatrixLength(f, 4, 4);
 
-	v1 = getFloat(*data, kFieldTypeFloat32);
-	v2 = getFloat(*data, kFieldTypeFloat32);
-	v3 = getFloat(*data, kFieldTypeFloat32);
-	v4 = getFloat(*data, kFieldTypeFloat32);
+	v1 = getFloat(data +  0, kFieldTypeFloat32);
+	v2 = getFloat(data +  4, kFieldTypeFloat32);
+	v3 = getFloat(data +  8, kFieldTypeFloat32);
+	v4 = getFloat(data + 12, kFieldTypeFloat32);
 
 	return true;
 }
 
 bool GFF4Struct::getMatrix4x4(uint32 field, double (&m)[16]) const {
-	const Field *f;
-	Common::SeekableReadStream *data = getField(field, f);
+	Field f;
+	const byte *data = getField(field, f);
 	if (!data)
 		return false;
 
-	if (f->isList)
+	if (f.isList)
 		throw Common::Exception("GFF4: Tried reading list as singular value");
 
-	const uint32 length = getVectorMatrixLength(*f, 16, 16);
+	const uint32 length = getVectorMatrixLength(f, 16, 16);
 	for (uint32 i = 0; i < length; i++)
-		m[i] = getDouble(*data, kFieldTypeFloat32);
+		m[i] = getDouble(data + i * 4, kFieldTypeFloat32);
 
 	return true;
 }
 
 bool GFF4Struct::getMatrix4x4(uint32 field, float (&m)[16]) const {
-	const Field *f;
-	Common::SeekableReadStream *data = getField(field, f);
+	Field f;
+	const byte *data = getField(field, f);
 	if (!data)
 		return false;
 
-	if (f->isList)
+	if (f.isList)
 		throw Common::Exception("GFF4: Tried reading list as singular value");
 
-	const uint32 length = getVectorMatrixLength(*f, 16, 16);
+	const uint32 length = getVectorMatrixLength(f, 16, 16);
 	for (uint32 i = 0; i < length; i++)
-		m[i] = getFloat(*data, kFieldTypeFloat32);
+		m[i] = getFloat(data + i * 4, kFieldTypeFloat32);
 
 	return true;
 }
@@ -1080,37 +1206,37 @@ bool GFF4Struct::getMatrix4x4(uint32 field, Common::Matrix4x4 &m) const {
 }
 
 bool GFF4Struct::getVectorMatrix(uint32 field, std::vector<double> &vectorMatrix) const {
-	const Field *f;
-	Common::SeekableReadStream *data = getField(field, f);
+	Field f;
+	const byte *data = getField(field, f);
 	if (!data)
 		return false;
 
-	if (f->isList)
+	if (f.isList)
 		throw Common::Exception("GFF4: Tried reading list as singular value");
 
-	const uint32 length = getVectorMatrixLength(*f, 0, 16);
+	const uint32 length = getVectorMatrixLength(f, 0, 16);
 
 	vectorMatrix.resize(length);
 	for (uint32 i = 0; i < length; i++)
-		vectorMatrix[i] = getDouble(*data, kFieldTypeFloat32);
+		vectorMatrix[i] = getDouble(data + i * 4, kFieldTypeFloat32);
 
 	return true;
 }
 
 bool GFF4Struct::getVectorMatrix(uint32 field, std::vector<float> &vectorMatrix) const {
-	const Field *f;
-	Common::SeekableReadStream *data = getField(field, f);
+	Field f;
+	const byte *data = getField(field, f);
 	if (!data)
 		return false;
 
-	if (f->isList)
+	if (f.isList)
 		throw Common::Exception("GFF4: Tried reading list as singular value");
 
-	const uint32 length = getVectorMatrixLength(*f, 0, 16);
+	const uint32 length = getVectorMatrixLength(f, 0, 16);
 
 	vectorMatrix.resize(length);
 	for (uint32 i = 0; i < length; i++)
-		vectorMatrix[i] = getFloat(*data, kFieldTypeFloat32);
+		vectorMatrix[i] = getFloat(data + i * 4, kFieldTypeFloat32);
 
 	return true;
 }
@@ -1118,76 +1244,81 @@ bool GFF4Struct::getVectorMatrix(uint32 field, std::vector<float> &vectorMatrix)
 // --- List value readers ---
 
 bool GFF4Struct::getUint(uint32 field, std::vector<uint64> &list) const {
-	const Field *f;
-	Common::SeekableReadStream *data = getField(field, f);
+	Field f;
+	uint32 count;
+	const byte *data = getListField(field, f, count);
 	if (!data)
 		return false;
 
-	const uint32 count = getListCount(*data, *f);
+	const uint32 size = getFieldSize(f.type);
 
 	list.resize(count);
 	for (uint32 i = 0; i < count; i++)
-		list[i] = getUint(*data, f->type);
+		list[i] = getUint(data + i * size, f.type);
 
 	return true;
 }
 
 bool GFF4Struct::getSint(uint32 field, std::vector<int64> &list) const {
-	const Field *f;
-	Common::SeekableReadStream *data = getField(field, f);
+	Field f;
+	uint32 count;
+	const byte *data = getListField(field, f, count);
 	if (!data)
 		return false;
 
-	const uint32 count = getListCount(*data, *f);
+	const uint32 size = getFieldSize(f.type);
 
 	list.resize(count);
 	for (uint32 i = 0; i < count; i++)
-		list[i] = getSint(*data, f->type);
+		list[i] = getSint(data + i * size, f.type);
 
 	return true;
 }
 
 bool GFF4Struct::getBool(uint32 field, std::vector<bool> &list) const {
-	const Field *f;
-	Common::SeekableReadStream *data = getField(field, f);
+	Field f;
+	uint32 count;
+	const byte *data = getListField(field, f, count);
 	if (!data)
 		return false;
 
-	const uint32 count = getListCount(*data, *f);
+	const uint32 size = getFieldSize(f.type);
 
 	list.resize(count);
 	for (uint32 i = 0; i < count; i++)
-		list[i] = getUint(*data, f->type) != 0;
+		list[i] = getUint(data + i * size, f.type) != 0;
 
 	return true;
 }
 
 bool GFF4Struct::getDouble(uint32 field, std::vector<double> &list) const {
-	const Field *f;
-	Common::SeekableReadStream *data = getField(field, f);
+	Field f;
+	uint32 count;
+	const byte *data = getListField(field, f, count);
 	if (!data)
 		return false;
 
-	const uint32 count = getListCount(*data, *f);
+	const uint32 size = getFieldSize(f.type);
 
 	list.resize(count);
 	for (uint32 i = 0; i < count; i++)
-		list[i] = getDouble(*data, f->type);
+		list[i] = getDouble(data + i * size, f.type);
 
 	return true;
 }
 
 bool GFF4Struct::getFloat(uint32 field, std::vector<float> &list) const {
-	const Field *f;
-	Common::SeekableReadStream *data = getField(field, f);
+	Field f;
+	uint32 count;
+	const byte *data = getListField(field, f, count);
 	if (!data)
 		return false;
 
-	const uint32 count = getListCount(*data, *f);
+	const uint32 size = getFieldSize(f.type);
 
 	list.resize(count);
 	for (uint32 i = 0; i < count; i++)
-		list[i] = getFloat(*data, f->type);
+		list[i] = getFloat(data + i * size, f.type);
 
 	return true;
 }
@@ -1195,10 +1326,11 @@ bool GFF4Struct::getFloat(uint32 field, std::vector<float> &list) const {
 bool GFF4Struct::getString(uint32 field, Common::Encoding encoding,
                            std::vector<Common::UString> &list) const {
 
-	const Field *f;
-	Common::SeekableReadStream *data = getField(field, f);
+	Field f;
+	uint32 count;
+	const byte *data = getListField(field, f, count);
 	if (!data) {
-		if (f && !f->isList) {
+		if ((f.type != kFieldTypeNone) && !f.isList) {
 			list.push_back("");
 			return true;
 		}
@@ -1206,11 +1338,11 @@ bool GFF4Struct::getString(uint32 field, Common::Encoding encoding,
 		return false;
 	}
 
-	const uint32 count = getListCount(*data, *f);
+	const uint32 size = getFieldSize(f.type);
 
 	list.resize(count);
 	for (uint32 i = 0; i < count; i++)
-		list[i] = getString(*data, *f, encoding);
+		list[i] = readString(data + i * size, f, encoding);
 
 	return true;
 }
@@ -1222,33 +1354,28 @@ bool GFF4Struct::getString(uint32 field, std::vector<Common::UString> &list) con
 bool GFF4Struct::getTalkString(uint32 field, Common::Encoding encoding,
                                std::vector<uint32> &strRefs, std::vector<Common::UString> &strs) const {
 
-
-	const Field *f;
-	Common::SeekableReadStream *data = getField(field, f);
+	Field f;
+	uint32 count;
+	const byte *data = getListField(field, f, count);
 	if (!data)
 		return false;
 
-	if (f->type != kFieldTypeTlkString)
+	if (f.type != kFieldTypeTlkString)
 		throw Common::Exception("GFF4: Field is not of TalkString type");
 
-	const uint32 count = getListCount(*data, *f);
-
 	strRefs.resize(count);
 	strs.resize(count);
 
-	std::vector<uint32> offsets;
-	offsets.resize(count);
-
-	for (uint32 i = 0; i < count; i++) {
-		strRefs[i] = getUint(*data, kFieldTypeUint32);
+	for (uint32 i = 0; i < count; i++, data += 8) {
+		strRefs[i] = READ_LE_UINT32(data);
 
-		const uint32 offset = getUint(*data, kFieldTypeUint32);
+		const uint32 offset = READ_LE_UINT32(data + 4);
 
 		if (offset != 0xFFFFFFFF) {
 			if (_parent->hasSharedStrings())
 				strs[i] = _parent->getSharedString(offset);
 			else if (offset != 0)
-				strs[i] = getString(*data, encoding, _parent->getDataOffset() + offset);
+				strs[i] = readString((size_t) _parent->getDataOffset() + offset, encoding);
 		}
 	}
 
@@ -1262,60 +1389,66 @@ bool GFF4Struct::getTalkString(uint32 field,
 }
 
 bool GFF4Struct::getVectorMatrix(uint32 field, std::vector< std::vector<double> > &list) const {
-	const Field *f;
-	Common::SeekableReadStream *data = getField(field, f);
+	Field f;
+	uint32 count;
+	const byte *data = getListField(field, f, count);
 	if (!data)
 		return false;
 
-	const uint32 length = getVectorMatrixLength(*f, 0, 16);
-	const uint32 count  = getListCount(*data, *f);
+	const uint32 length = getVectorMatrixLength(f, 0, 16);
+	const uint32 size   = getFieldSize(f.type);
 
 	list.resize(count);
 	for (uint32 i = 0; i < count; i++) {
+		const byte *element = data + i * size;
 
 		list[i].resize(length);
 		for (uint32 j = 0; j < length; j++)
-			list[i][j] = getDouble(*data, kFieldTypeFloat32);
+			list[i][j] = getDouble(element + j * 4, kFieldTypeFloat32);
 	}
 
 	return true;
 }
 
 bool GFF4Struct::getVectorMatrix(uint32 field, std::vector< std::vector<float> > &list) const {
-	const Field *f;
-	Common::SeekableReadStream *data = getField(field, f);
+	Field f;
+	uint32 count;
+	const byte *data = getListField(field, f, count);
 	if (!data)
 		return false;
 
-	const uint32 length = getVectorMatrixLength(*f, 0, 16);
-	const uint32 count  = getListCount(*data, *f);
+	const uint32 length = getVectorMatrixLength(f, 0, 16);
+	const uint32 size   = getFieldSize(f.type);
 
 	list.resize(count);
 	for (uint32 i = 0; i < count; i++) {
+		const byte *element = data + i * size;
 
 		list[i].resize(length);
 		for (uint32 j = 0; j < length; j++)
-			list[i][j] = getFloat(*data, kFieldTypeFloat32);
+			list[i][j] = getFloat(element + j * 4, kFieldTypeFloat32);
 	}
 
 	return true;
 }
 
 bool GFF4Struct::getMatrix4x4(uint32 field, std::vector<Common::Matrix4x4> &list) const {
-	const Field *f;
-	Common::SeekableReadStream *data = getField(field, f);
+	Field f;
+	uint32 count;
+	const byte *data = getListField(field, f, count);
 	if (!data)
 		return false;
 
-	const uint32 length = getVectorMatrixLength(*f, 0, 16);
-	const uint32 count  = getListCount(*data, *f);
+	const uint32 length = getVectorMatrixLength(f, 0, 16);
+	const uint32 size   = getFieldSize(f.type);
 
 	list.resize(count);
 	for (uint32 i = 0; i < count; i++) {
-		float m[16];
+		const byte *element = data + i * size;
 
+		float m[16];
 		for (uint32 j = 0; j < length; j++)
-			m[j] = getFloat(*data, kFieldTypeFloat32);
+			m[j] = getFloat(element + j * 4, kFieldTypeFloat32);
 
 		list[i] = m;
 	}
@@ -1326,17 +1459,18 @@ bool GFF4Struct::getMatrix4x4(uint32 field, std::vector<Common::Matrix4x4> &list
 // --- Struct reader ---
 
 const GFF4Struct *GFF4Struct::getStruct(uint32 field) const {
-	const Field *f = getField(field);
-	if (!f)
+	Field f;
+	if (!findField(field, f))
 		return 0;
 
-	if (f->type != kFieldTypeStruct)
+	if (f.type != kFieldTypeStruct)
 		throw Common::Exception("GFF4: Field is not of struct type");
-	if (f->isList)
+	if (f.isList)
 		throw Common::Exception("GFF4: Tried reading list as singular value");
 
-	if (!f->structs.empty())
-		return f->structs[0];
+	const GFF4List &structs = _structs[f.structs];
+	if (!structs.empty())
+		return structs[0];
 
 	return 0;
 }
@@ -1344,15 +1478,16 @@ const GFF4Struct *GFF4Struct::getStruct(uint32 field) const {
 // --- Generic reader ---
 
 const GFF4Struct *GFF4Struct::getGeneric(uint32 field) const {
-	const Field *f = getField(field);
-	if (!f)
+	Field f;
+	if (!findField(field, f))
 		return 0;
 
-	if (f->type != kFieldTypeGeneric)
+	if (f.type != kFieldTypeGeneric)
 		throw Common::Exception("GFF4: Field is not of generic type");
 
-	if (!f->structs.empty())
-		return f->structs[0];
+	const GFF4List &structs = _structs[f.structs];
+	if (!structs.empty())
+		return structs[0];
 
 	return 0;
 }
@@ -1360,39 +1495,30 @@ const GFF4Struct *GFF4Struct::getGeneric(uint32 field) const {
 // --- Struct list reader ---
 
 const GFF4List &GFF4Struct::getList(uint32 field) const {
-	const Field *f = getField(field);
-	if (!f)
+	Field f;
+	if (!findField(field, f))
 		throw Common::Exception("GFF4: No such field");
 
-	if (f->type != kFieldTypeStruct)
+	if (f.type != kFieldTypeStruct)
 		throw Common::Exception("GFF4: Field is not of struct type");
 
-	return f->structs;
+	return _structs[f.structs];
 }
 
 // --- Struct data reader ---
 
 Common::SeekableReadStream *GFF4Struct::getData(uint32 field) const {
-	const Field *f;
-	Common::SeekableReadStream *data = getField(field, f);
+	Field f;
+	uint32 count;
+	const byte *data = getListField(field, f, count);
 	if (!data)
 		return 0;
 
-	const uint32 count = getListCount(*data, *f);
-	const uint32 size  = getFieldSize(f->type);
-
+	const uint32 size = getFieldSize(f.type);
 	if ((size == 0) || (count == 0))
 		return 0;
 
-	const size_t dataSize  = count * size;
-	const size_t dataBegin = data->pos();
-	const size_t dataEnd   = data->pos() + dataSize;
-
-	if ((dataBegin >= data->size()) || ((data->size() - dataBegin) < dataSize))
-		throw Common::Exception("Invalid data offset (%u, %u, %u)",
-		                        (uint) dataBegin, (uint) dataSize, (uint) data->size());
-
-	return new Common::SeekableSubReadStream(data, dataBegin, dataEnd);
+	return new Common::MemoryReadStream(data, count * size);
 }
 
 } // End of namespace Aurora
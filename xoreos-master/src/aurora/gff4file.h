@@ -26,9 +26,9 @@
 #define AURORA_GFF4FILE_H
 
 #include <vector>
-#include <map>
 
 #include <boost/noncopyable.hpp>
+#include <boost/unordered_map.hpp>
 
 #include "src/common/types.h"
 #include "src/common/scopedptr.h"
@@ -83,6 +83,10 @@ class GFF4Struct;
  *    the English, French, Italian, German and Spanish (EFIGS) versions have
  *    the strings in TLK files encoded in Windows CP-1252.
  *
+ *  The whole file is kept in memory as one contiguous block. All structs
+ *  created from the same struct template share that template's field
+ *  layout, and field values are read directly out of the file data.
+ *
  *  See also: GFF3File in gff3file.h for the earlier V3.2/V3.3 versions of
  *  the GFF format.
  */
@@ -121,30 +125,55 @@ private:
 		void read(Common::SeekableReadStream &gff4, uint32 version);
 	};
 
-	/** A template of a struct, used when loading a struct. */
+	/** A template of a struct, used when loading a struct.
+	 *
+	 *  All structs created from the same template share its field layout.
+	 */
 	struct StructTemplate {
 		struct Field {
 			uint32 label;
 			uint16 type;
 			uint16 flags;
 			uint32 offset;
+
+			/** Index of this field's list of structs within a struct instance.
+			 *  Only struct and generic fields have one, all others are kNoStructs. */
+			uint32 structs;
 		};
 
+		/** A field label and the index of its field, for looking up fields by label. */
+		typedef std::pair<uint32, uint32> FieldIndex;
+
 		uint32 index;
 		uint32 label;
 		uint32 size;
 
 		std::vector<Field> fields;
+
+		/** The labels of all fields, in the order of the fields. */
+		std::vector<uint32> fieldLabels;
+		/** All fields, sorted by their label. */
+		std::vector<FieldIndex> fieldIndices;
+
+		/** Number of distinct field labels. */
+		uint32 fieldCount;
+		/** Number of fields that have a list of structs. */
+		uint32 structFieldCount;
 	};
 
 	typedef std::vector<StructTemplate> StructTemplates;
 	typedef std::vector<Common::UString> SharedStrings;
-	typedef std::map<uint64, GFF4Struct *> StructMap;
+	typedef boost::unordered_map<uint64, GFF4Struct *> StructMap;
 
+	/** A field without any structs. */
+	static const uint32 kNoStructs = 0xFFFFFFFF;
 
 
 	Common::ScopedPtr<Common::SeekableReadStream> _stream;
 
+	const byte *_data;     ///< The whole GFF4, in memory.
+	size_t      _dataSize; ///< The size of the whole GFF4.
+
 	/** This GFF4's header. */
 	Header          _header;
 	/** All struct templates in this GFF4. */
@@ -161,6 +190,7 @@ private:
 
 	// .--- Loading helpers
 	void load(uint32 type);
+	void loadData();
 	void loadHeader(uint32 type);
 	void loadStructs();
 	void loadStrings();
@@ -173,10 +203,14 @@ private:
 	void unregisterStruct(uint64 id);
 	GFF4Struct *findStruct(uint64 id);
 
-	Common::SeekableReadStream &getStream(uint32 offset) const;
 	const StructTemplate &getStructTemplate(uint32 i) const;
 	uint32 getDataOffset() const;
 
+	/** Return a pointer to this area of the GFF4, throwing if it's out of bounds. */
+	const byte *getData(size_t offset, size_t size) const;
+	/** Return the offset of this pointer into the GFF4. */
+	size_t getOffset(const byte *data) const;
+
 	bool hasSharedStrings() const;
 	Common::UString getSharedString(uint32 i) const;
 	// '---
@@ -342,19 +376,25 @@ private:
 		bool isReference; ///< Is this field a reference (pointer) to another field?
 		bool isGeneric;   ///< Is this field found in a generic?
 
-		uint16   structIndex; ///< Index of the field's struct type (if kFieldTypeStruct).
-		GFF4List structs;     ///< List of GFF4Struct (if kFieldTypeStruct).
+		uint16 structIndex; ///< Index of the field's struct type (if kFieldTypeStruct).
+		uint32 structs;     ///< Index of the field's list of GFF4Struct (if kFieldTypeStruct/kFieldTypeGeneric).
 
 		Field();
 		Field(uint32 l, uint16 t, uint16 f, uint32 o, bool g = false);
 		~Field();
+
+		bool operator<(const Field &right) const;
 	};
 
-	typedef std::map<uint32, Field> FieldMap;
+	typedef std::vector<Field> FieldArray;
 
 
 	const GFF4File *_parent;
 
+	/** The template this struct was created from, or 0 if it's a mapped generic. */
+	const GFF4File::StructTemplate *_template;
+
+	uint32 _offset; ///< Offset of the struct data into the GFF4.
 	uint32 _label;
 
 	uint64 _id;
@@ -362,10 +402,13 @@ private:
 
 	size_t _fieldCount;
 
-	FieldMap _fields;
+	/** The lists of structs of all struct and generic fields. */
+	std::vector<GFF4List> _structs;
 
-	/** The labels of all fields in this struct. */
-	std::vector<uint32> _fieldLabels;
+	/** The fields of a mapped generic. Structs from a template use the template's fields. */
+	FieldArray _genericFields;
+	/** The labels of all fields in a mapped generic. */
+	std::vector<uint32> _genericLabels;
 
 
 	// .--- Loader
@@ -385,30 +428,29 @@ private:
 	// '---
 
 	// .--- Field and field data accessors
-	const Field *getField(uint32 field) const;
+	/** Find a field by its label. Returns false if there's no such field. */
+	bool findField(uint32 fieldID, Field &field) const;
 
 	uint32 getDataOffset(bool isReference, uint32 offset) const;
 	uint32 getDataOffset(const Field &field) const;
 
-	Common::SeekableReadStream *getData(const Field &field) const;
-	Common::SeekableReadStream *getField(uint32 fieldID, const Field *&field) const;
+	/** Return the data of a singular field, or 0 if the field or its data doesn't exist. */
+	const byte *getField(uint32 fieldID, Field &field) const;
+	/** Return the data of a field's list elements (a singular field has 1), or 0 if there's no data. */
+	const byte *getListField(uint32 fieldID, Field &field, uint32 &count) const;
 	// '---
 
 	// .--- Field reader helpers
-	uint32 getListCount(Common::SeekableReadStream &data, const Field &field) const;
-	uint32 getFieldSize(FieldType type) const;
+	static uint32 getFieldSize(FieldType type);
 
-	uint64 getUint(Common::SeekableReadStream &data, FieldType type) const;
-	 int64 getSint(Common::SeekableReadStream &data, FieldType type) const;
+	static uint64 getUint(const byte *data, FieldType type);
+	static  int64 getSint(const byte *data, FieldType type);
 
-	double getDouble(Common::SeekableReadStream &data, FieldType type) const;
-	float  getFloat (Common::SeekableReadStream &data, FieldType type) const;
+	static double getDouble(const byte *data, FieldType type);
+	static float  getFloat (const byte *data, FieldType type);
 
-	Common::UString getString(Common::SeekableReadStream &data, Common::Encoding encoding) const;
-	Common::UString getString(Common::SeekableReadStream &data, Common::Encoding encoding,
-	                          uint32 offset) const;
-	Common::UString getString(Common::SeekableReadStream &data, const Field &field,
-	                          Common::Encoding encoding) const;
+	Common::UString readString(size_t offset, Common::Encoding encoding) const;
+	Common::UString readString(const byte *data, const Field &field, Common::Encoding encoding) const;
 
 	uint32 getVectorMatrixLength(const Field &field, uint32 minLength, uint32 maxLength) const;
 	// '---
@@ -166,14 +166,10 @@ uint32 NDSFile::getResourceSize(uint32 index) const {
 Common::SeekableReadStream *NDSFile::getResource(uint32 index, bool tryNoCopy) const {
 	const IResource &res = getIResource(index);
 
-	_nds->seek(res.offset);
-
 	if (tryNoCopy)
 		return new Common::SeekableSubReadStream(_nds.get(), res.offset, res.offset + res.size);
 
-	_nds->seek(res.offset);
-
-	return _nds->readStream(res.size);
+	return _nds->readStreamAt(res.offset, res.size);
 }
 
 } // End of namespace Aurora
@@ -107,6 +107,11 @@ uint32 NSBTXFile::getResourceSize(uint32 index) const {
 	return getITEXSize(_textures[index]);
 }
 
+bool NSBTXFile::isResourceDecoded(uint32 UNUSED(index)) const {
+	// Textures are converted into the XEOSITEX format on the fly
+	return true;
+}
+
 void NSBTXFile::writeITEXHeader(const ReadContext &ctx) {
 	ctx.stream->writeUint32BE(kXEOSID);
 	ctx.stream->writeUint32BE(kITEXID);
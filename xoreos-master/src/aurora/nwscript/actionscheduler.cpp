@@ -0,0 +1,344 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A scheduler for delayed script actions.
+ */
+
+#include <cassert>
+
+#include <vector>
+#include <algorithm>
+
+#include <SDL_timer.h>
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+
+#include "src/aurora/nwscript/actionscheduler.h"
+#include "src/aurora/nwscript/ncsfile.h"
+
+namespace Aurora {
+
+namespace NWScript {
+
+ActionScheduler::Stats::Stats() : pending(0), peakPending(0), scheduled(0), executed(0), deferrals(0),
+	totalLatency(0), maxLatency(0) {
+
+}
+
+double ActionScheduler::Stats::getAverageLatency() const {
+	if (executed == 0)
+		return 0.0;
+
+	return ((double) totalLatency) / executed;
+}
+
+
+bool ActionScheduler::Record::compareSequence(const Record *a, const Record *b) {
+	return a->sequence < b->sequence;
+}
+
+
+ActionScheduler::List::List() : head(0), tail(0), size(0), sorted(true) {
+}
+
+bool ActionScheduler::List::empty() const {
+	return head == 0;
+}
+
+void ActionScheduler::List::push(Record *record) {
+	record->next = 0;
+
+	if (tail) {
+		if (record->sequence < tail->sequence)
+			sorted = false;
+
+		tail->next = record;
+	} else
+		head = record;
+
+	tail = record;
+	size++;
+}
+
+ActionScheduler::Record *ActionScheduler::List::pop() {
+	Record *record = head;
+	if (!record)
+		return 0;
+
+	head = record->next;
+	if (!head) {
+		tail   = 0;
+		sorted = true;
+	}
+
+	record->next = 0;
+	size--;
+
+	return record;
+}
+
+void ActionScheduler::List::splice(List &list) {
+	if (list.empty())
+		return;
+
+	if (tail) {
+		if (!list.sorted || (list.head->sequence < tail->sequence))
+			sorted = false;
+
+		tail->next = list.head;
+	} else {
+		head   = list.head;
+		sorted = list.sorted;
+	}
+
+	tail  = list.tail;
+	size += list.size;
+
+	list.head   = 0;
+	list.tail   = 0;
+	list.size   = 0;
+	list.sorted = true;
+}
+
+void ActionScheduler::List::sort() {
+	if (sorted)
+		return;
+
+	std::vector<Record *> records;
+	records.reserve(size);
+
+	for (Record *record = head; record; record = record->next)
+		records.push_back(record);
+
+	std::sort(records.begin(), records.end(), Record::compareSequence);
+
+	for (size_t i = 1; i < records.size(); i++)
+		records[i - 1]->next = records[i];
+
+	head = records.front();
+	tail = records.back();
+
+	tail->next = 0;
+	sorted     = true;
+}
+
+
+ActionScheduler::ActionScheduler() : _next(0), _sequence(0), _wheelCount(0) {
+}
+
+ActionScheduler::~ActionScheduler() {
+}
+
+void ActionScheduler::clear() {
+	for (uint32 level = 0; level < kLevelCount; level++)
+		for (uint32 slot = 0; slot < kSlotCount; slot++)
+			while (!_wheel[level][slot].empty())
+				release(_wheel[level][slot].pop());
+
+	while (!_ready.empty())
+		release(_ready.pop());
+
+	_wheelCount = 0;
+
+	_stats.pending = 0;
+}
+
+size_t ActionScheduler::getPendingCount() const {
+	return _wheelCount + _ready.size;
+}
+
+const ActionScheduler::Stats &ActionScheduler::getStats() const {
+	return _stats;
+}
+
+ActionScheduler::Record *ActionScheduler::allocate() {
+	if (!_free.empty())
+		return _free.pop();
+
+	_records.push_back(Record());
+
+	Record *record = &_records.back();
+	record->next     = 0;
+	record->sequence = 0;
+
+	return record;
+}
+
+void ActionScheduler::release(Record *record) {
+	// Let go of the variables, but keep the memory around for the next action
+	record->action.script.clear();
+	record->action.state.globals.clear();
+	record->action.state.locals.clear();
+
+	record->action.owner     = 0;
+	record->action.triggerer = 0;
+
+	_free.push(record);
+}
+
+void ActionScheduler::schedule(uint32 now, uint32 delay, const Common::UString &script,
+                               const ScriptState &state, Object *owner, Object *triggerer) {
+
+	// Nothing in the wheel, so we can move it to the present without walking over empty slots
+	if (_wheelCount == 0)
+		_next = now;
+
+	Record *record = allocate();
+
+	record->action.script    = script;
+	record->action.state     = state;
+	record->action.owner     = owner;
+	record->action.triggerer = triggerer;
+	record->action.timestamp = now + delay;
+
+	record->sequence = _sequence++;
+
+	insert(record);
+
+	_stats.scheduled++;
+	_stats.pending     = getPendingCount();
+	_stats.peakPending = MAX(_stats.peakPending, _stats.pending);
+}
+
+void ActionScheduler::insert(Record *record) {
+	const uint32 timestamp = record->action.timestamp;
+
+	// Already due
+	if ((int32) (timestamp - _next) < 0) {
+		_ready.push(record);
+		return;
+	}
+
+	const uint32 delta = timestamp - _next;
+
+	_wheelCount++;
+
+	for (uint32 level = 0; level < kLevelCount; level++) {
+		if (delta < (1U << (kLevelBits * (level + 1)))) {
+			_wheel[level][(timestamp >> (kLevelBits * level)) & kSlotMask].push(record);
+			return;
+		}
+	}
+
+	// Too far into the future. Park it in the last slot the top level reaches
+	const uint32 topShift = kLevelBits * (kLevelCount - 1);
+	const uint32 parked   = _next + (1U << (kLevelBits * kLevelCount)) - 1;
+
+	_wheel[kLevelCount - 1][(parked >> topShift) & kSlotMask].push(record);
+}
+
+void ActionScheduler::cascade(uint32 level) {
+	List &slot = _wheel[level][(_next >> (kLevelBits * level)) & kSlotMask];
+
+	List list;
+	list.splice(slot);
+
+	_wheelCount -= list.size;
+
+	while (!list.empty())
+		insert(list.pop());
+}
+
+void ActionScheduler::advance(uint32 now) {
+	while ((_wheelCount > 0) && ((int32) (now - _next) >= 0)) {
+		const uint32 index = _next & kSlotMask;
+
+		// Wrapped around the lowest level, so sort the next slots of the higher levels down
+		if (index == 0) {
+			for (uint32 level = 1; level < kLevelCount; level++) {
+				cascade(level);
+
+				if (((_next >> (kLevelBits * level)) & kSlotMask) != 0)
+					break;
+			}
+		}
+
+		List &slot = _wheel[0][index];
+
+		slot.sort();
+
+		_wheelCount -= slot.size;
+		_ready.splice(slot);
+
+		_next++;
+	}
+
+	// Nothing left in the wheel, so skip ahead
+	if ((_wheelCount == 0) && ((int32) (now - _next) >= 0))
+		_next = now + 1;
+}
+
+void ActionScheduler::run(uint32 now, const Handler &handler, uint32 budget) {
+	advance(now);
+
+	const uint32 start = SDL_GetTicks();
+
+	bool ranAction = false;
+	while (!_ready.empty()) {
+		if (ranAction && (budget > 0) && ((SDL_GetTicks() - start) >= budget)) {
+			_stats.deferrals++;
+			break;
+		}
+
+		Record *record = _ready.pop();
+
+		const uint32 latency = ((int32) (now - record->action.timestamp) > 0) ? (now - record->action.timestamp) : 0;
+
+		_stats.executed++;
+		_stats.totalLatency += latency;
+		_stats.maxLatency    = MAX(_stats.maxLatency, latency);
+
+		try {
+			handler(record->action);
+		} catch (...) {
+			release(record);
+			_stats.pending = getPendingCount();
+			throw;
+		}
+
+		release(record);
+		ranAction = true;
+	}
+
+	_stats.pending = getPendingCount();
+}
+
+void ActionScheduler::run(uint32 now) {
+	run(now, &runScript, kDefaultBudget);
+}
+
+void ActionScheduler::runScript(const Action &action) {
+	if (action.script.empty())
+		return;
+
+	try {
+		NCSFile ncs(action.script);
+
+		ncs.run(action.state, action.owner, action.triggerer);
+	} catch (...) {
+		Common::exceptionDispatcherWarning("Failed running script \"%s\"", action.script.c_str());
+	}
+}
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
@@ -0,0 +1,210 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A scheduler for delayed script actions.
+ */
+
+#ifndef AURORA_NWSCRIPT_ACTIONSCHEDULER_H
+#define AURORA_NWSCRIPT_ACTIONSCHEDULER_H
+
+#include <deque>
+
+#include <boost/noncopyable.hpp>
+#include <boost/function.hpp>
+
+#include "src/common/types.h"
+#include "src/common/ustring.h"
+
+#include "src/aurora/nwscript/variable.h"
+
+namespace Aurora {
+
+namespace NWScript {
+
+class Object;
+
+/** A script action, to be run at a specific point in time. */
+struct Action {
+	Common::UString script;
+
+	ScriptState state;
+	Object *owner;
+	Object *triggerer;
+
+	uint32 timestamp; ///< When to run the action, in milliseconds.
+};
+
+/** A scheduler for delayed script actions, like those created by DelayCommand().
+ *
+ *  The pending actions are sorted into a hierarchical timer wheel with a
+ *  resolution of one millisecond: four levels of 64 slots each, with each
+ *  level covering 64 times the time span of the level below it. Scheduling
+ *  an action and expiring it are both constant-time operations. Actions that
+ *  lie further in the future than the top level reaches are parked in its
+ *  last slot, and sorted in again whenever they come around.
+ *
+ *  Expired actions are run in the order of their timestamps, and actions
+ *  with the same timestamp in the order they were scheduled in. When running
+ *  the actions of a frame takes longer than a given time budget, the rest is
+ *  deferred to the next call of run().
+ *
+ *  The action records are pooled and reused.
+ */
+class ActionScheduler : boost::noncopyable {
+public:
+	/** Statistics about the scheduled actions. */
+	struct Stats {
+		size_t pending;     ///< Number of actions currently waiting.
+		size_t peakPending; ///< Highest number of actions ever waiting at the same time.
+
+		uint64 scheduled; ///< Total number of actions scheduled.
+		uint64 executed;  ///< Total number of actions run.
+		uint64 deferrals; ///< Number of times running due actions was cut short by the budget.
+
+		uint64 totalLatency; ///< Sum of the time between due and run, in milliseconds.
+		uint32 maxLatency;   ///< Longest time between due and run, in milliseconds.
+
+		Stats();
+
+		/** Return the average time between due and run, in milliseconds. */
+		double getAverageLatency() const;
+	};
+
+	/** A function running an action. */
+	typedef boost::function<void (const Action &)> Handler;
+
+	/** Time budget for running delayed actions each frame, in milliseconds. */
+	static const uint32 kDefaultBudget = 10;
+
+	ActionScheduler();
+	~ActionScheduler();
+
+	/** Drop all pending actions. */
+	void clear();
+
+	/** Schedule running a script delay milliseconds after now. */
+	void schedule(uint32 now, uint32 delay, const Common::UString &script, const ScriptState &state,
+	              Object *owner, Object *triggerer);
+
+	/** Run all actions that are due at now.
+	 *
+	 *  @param now     The current time, in milliseconds.
+	 *  @param handler The function running the actions.
+	 *  @param budget  After this many milliseconds of wall time, defer the
+	 *                 remaining actions to the next call. 0 means no limit.
+	 *                 At least one due action is always run.
+	 */
+	void run(uint32 now, const Handler &handler, uint32 budget = 0);
+
+	/** Run the scripts of all actions that are due at now, within the default budget. */
+	void run(uint32 now);
+
+	/** Run the script of an action. Failing scripts are only warned about. */
+	static void runScript(const Action &action);
+
+	/** Return the number of actions currently waiting. */
+	size_t getPendingCount() const;
+
+	const Stats &getStats() const;
+
+private:
+	static const uint32 kLevelBits  = 6;
+	static const uint32 kLevelCount = 4;
+	static const uint32 kSlotCount  = 1 << kLevelBits;
+	static const uint32 kSlotMask   = kSlotCount - 1;
+
+	/** A pooled action record, part of a singly linked list. */
+	struct Record {
+		Action action;
+		Record *next;
+
+		uint64 sequence; ///< Increasing with every scheduled action, to keep them in order.
+
+		/** Was a scheduled before b? */
+		static bool compareSequence(const Record *a, const Record *b);
+	};
+
+	/** A list of action records, in order. */
+	struct List {
+		Record *head;
+		Record *tail;
+
+		size_t size;
+
+		/** Are the records in the order they were scheduled in? */
+		bool sorted;
+
+		List();
+
+		bool empty() const;
+
+		void push(Record *record);
+		Record *pop();
+
+		/** Move all records of another list to the end of this list. */
+		void splice(List &list);
+
+		/** Sort the records into the order they were scheduled in. */
+		void sort();
+	};
+
+	/** The time of the next slot of the lowest level to expire. */
+	uint32 _next;
+
+	/** The sequence number of the next scheduled action. */
+	uint64 _sequence;
+
+	List _wheel[kLevelCount][kSlotCount];
+
+	/** Actions that are due, in the order they need to run in. */
+	List _ready;
+
+	/** Number of actions in the wheel, not counting the ready list. */
+	size_t _wheelCount;
+
+	/** All action records ever allocated. A deque, so that they don't move. */
+	std::deque<Record> _records;
+	/** Action records not currently in use. */
+	List _free;
+
+	Stats _stats;
+
+	Record *allocate();
+	void release(Record *record);
+
+	/** Sort an action into the wheel, or into the ready list if it's already due. */
+	void insert(Record *record);
+
+	/** Advance the wheel up to and including now, moving all expired actions to the ready list.
+	 *
+	 *  Actions cascading down from a higher level can end up behind actions with the
+	 *  same timestamp that were scheduled later, so the slots are sorted on expiry.
+	 */
+	void advance(uint32 now);
+	/** Sort all actions of a slot into the levels below. */
+	void cascade(uint32 level);
+};
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
+
+#endif // AURORA_NWSCRIPT_ACTIONSCHEDULER_H
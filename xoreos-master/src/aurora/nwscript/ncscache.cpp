@@ -0,0 +1,85 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A cache of decoded NWScript bytecode.
+ */
+
+#include "src/common/scopedptr.h"
+#include "src/common/error.h"
+#include "src/common/readstream.h"
+
+#include "src/aurora/resman.h"
+
+#include "src/aurora/nwscript/ncscache.h"
+#include "src/aurora/nwscript/ncsprogram.h"
+
+DECLARE_SINGLETON(Aurora::NWScript::NCSProgramCache)
+
+namespace Aurora {
+
+namespace NWScript {
+
+NCSProgramCache::NCSProgramCache() : _resourceChanges(0) {
+}
+
+NCSProgramCache::~NCSProgramCache() {
+}
+
+void NCSProgramCache::clear() {
+	Common::StackLock lock(_mutex);
+
+	_programs.clear();
+}
+
+boost::shared_ptr<const NCSProgram> NCSProgramCache::getProgram(const Common::UString &name) {
+	Common::StackLock lock(_mutex);
+
+	// The cached programs might have been overridden or removed
+	const uint32 resourceChanges = ResMan.getChangeCount();
+	if (resourceChanges != _resourceChanges) {
+		_programs.clear();
+
+		_resourceChanges = resourceChanges;
+	}
+
+	ProgramMap::const_iterator cached = _programs.find(name);
+	if (cached != _programs.end())
+		return cached->second;
+
+	Common::ScopedPtr<Common::SeekableReadStream> ncs(ResMan.getResource(name, kFileTypeNCS));
+	if (!ncs)
+		throw Common::Exception("No such NCS \"%s\"", name.c_str());
+
+	boost::shared_ptr<const NCSProgram> program(new NCSProgram(*ncs, name));
+	_programs.insert(std::make_pair(name, program));
+
+	return program;
+}
+
+size_t NCSProgramCache::getProgramCount() const {
+	Common::StackLock lock(_mutex);
+
+	return _programs.size();
+}
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
@@ -0,0 +1,83 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A cache of decoded NWScript bytecode.
+ */
+
+#ifndef AURORA_NWSCRIPT_NCSCACHE_H
+#define AURORA_NWSCRIPT_NCSCACHE_H
+
+#include <map>
+
+#include <boost/shared_ptr.hpp>
+
+#include "src/common/types.h"
+#include "src/common/ustring.h"
+#include "src/common/singleton.h"
+#include "src/common/mutex.h"
+
+namespace Aurora {
+
+namespace NWScript {
+
+class NCSProgram;
+
+/** A cache of decoded NWScript bytecode.
+ *
+ *  Every NCS is only read out of the resource manager and decoded once,
+ *  and the decoded program is then shared by all instances of the script.
+ *
+ *  Whenever the resources available in the resource manager change, for
+ *  example when a new module is loaded, all cached programs are dropped.
+ */
+class NCSProgramCache : public Common::Singleton<NCSProgramCache> {
+public:
+	NCSProgramCache();
+	~NCSProgramCache();
+
+	/** Drop all cached programs. */
+	void clear();
+
+	/** Return the decoded program of this NCS, reading and decoding it if necessary. */
+	boost::shared_ptr<const NCSProgram> getProgram(const Common::UString &name);
+
+	/** Return the number of cached programs. */
+	size_t getProgramCount() const;
+
+private:
+	typedef std::map<Common::UString, boost::shared_ptr<const NCSProgram>, Common::UString::iless> ProgramMap;
+
+	ProgramMap _programs;
+
+	/** The resource manager's change count the cached programs are valid for. */
+	uint32 _resourceChanges;
+
+	mutable Common::Mutex _mutex;
+};
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
+
+/** Shortcut for accessing the NCS program cache. */
+#define NCSCache Aurora::NWScript::NCSProgramCache::instance()
+
+#endif // AURORA_NWSCRIPT_NCSCACHE_H
@@ -35,20 +35,17 @@
 #include "src/common/maths.h"
 #include "src/common/ustring.h"
 #include "src/common/readstream.h"
-#include "src/common/encoding.h"
+#include "src/common/scopedptr.h"
 #include "src/common/debug.h"
 
-#include "src/aurora/resman.h"
-
 #include "src/aurora/nwscript/ncsfile.h"
+#include "src/aurora/nwscript/ncscache.h"
 #include "src/aurora/nwscript/object.h"
 #include "src/aurora/nwscript/functionman.h"
+#include "src/aurora/nwscript/profiler.h"
 
 using Common::kDebugScripts;
 
-static const uint32 kNCSTag    = MKTAG('N', 'C', 'S', ' ');
-static const uint32 kVersion10 = MKTAG('V', '1', '.', '0');
-
 static const uint32 kScriptObjectSelf        = 0x00000000;
 static const uint32 kScriptObjectInvalid     = 0x00000001;
 static const uint32 kScriptObjectInvalid2    = 0xFFFFFFFF;
@@ -58,133 +55,12 @@ namespace Aurora {
 
 namespace NWScript {
 
-NCSStack::NCSStack() {
-	reset();
-}
-
-NCSStack::~NCSStack() {
-}
-
-void NCSStack::reset() {
-	clear();
-
-	_stackPtr = -1;
-	_basePtr  = -1;
-}
-
-bool NCSStack::empty() const {
-	return _stackPtr < 0;
-}
-
-Variable &NCSStack::top() {
-	if (_stackPtr == -1)
-		throw Common::Exception("NCSStack: Stack underflow");
-
-	return at(_stackPtr);
-}
-
-Variable NCSStack::pop() {
-	if (_stackPtr == -1)
-		throw Common::Exception("NCSStack: Stack underflow");
-
-	return at(_stackPtr--);
-}
-
-void NCSStack::push(const Variable &obj) {
-	if (_stackPtr == 0x7FFFFFFF) // Like this will ever happen :P
-		throw Common::Exception("NCSStack: Stack overflow");
+static inline NCSValue makeInt(int32 value) {
+	NCSValue v;
+	v.kind     = NCSValue::kKindInt;
+	v.intValue = value;
 
-	if (_stackPtr == (int32)size() - 1)
-		push_back(obj);
-	else
-		at(_stackPtr + 1) = obj;
-
-	_stackPtr++;
-}
-
-Variable &NCSStack::getRelSP(int32 pos) {
-	if ((pos > -4) || ((pos % 4) != 0))
-		throw Common::Exception("NCSStack::get(): Illegal position %d", pos);
-
-	int32 stackPos = _stackPtr - ((pos / -4) - 1);
-	if (stackPos < 0)
-		throw Common::Exception("NCSStack::get(): Position %d below the bottom", pos);
-
-	return at(stackPos);
-}
-
-void NCSStack::setRelSP(int32 pos, const Variable &obj) {
-	if ((pos > -4) || ((pos % 4) != 0))
-		throw Common::Exception("NCSStack::set(): Illegal position %d", pos);
-
-	int32 stackPos = _stackPtr - ((pos / -4) - 1);
-	if (stackPos < 0)
-		throw Common::Exception("NCSStack::set(): Position %d below the bottom", pos);
-
-	at(stackPos) = obj;
-}
-
-Variable &NCSStack::getRelBP(int32 pos) {
-	if ((pos > -4) || ((pos % 4) != 0))
-		throw Common::Exception("NCSStack::get(): Illegal position %d", pos);
-
-	int32 stackPos = _basePtr - ((pos / -4) - 1);
-	if (stackPos < 0)
-		throw Common::Exception("NCSStack::get(): Position %d below the bottom", pos);
-
-	return at(stackPos);
-}
-
-void NCSStack::setRelBP(int32 pos, const Variable &obj) {
-	if ((pos > -4) || ((pos % 4) != 0))
-		throw Common::Exception("NCSStack::set(): Illegal position %d", pos);
-
-	int32 stackPos = _basePtr - ((pos / -4) - 1);
-	if (stackPos < 0)
-		throw Common::Exception("NCSStack::set(): Position %d below the bottom", pos);
-
-	at(stackPos) = obj;
-}
-
-int32 NCSStack::getStackPtr() {
-	return (_stackPtr + 1) * -4;
-}
-
-void NCSStack::setStackPtr(int32 pos) {
-	if ((pos > 0) || ((pos % 4) != 0))
-		throw Common::Exception("NCSStack::setStackPtr(): Illegal position %d", pos);
-
-	_stackPtr = (pos / -4) - 1;
-
-	if ((int32)size() < (_stackPtr + 1))
-		resize(_stackPtr + 1);
-}
-
-int32 NCSStack::getBasePtr() {
-	return (_basePtr + 1) * -4;
-}
-
-void NCSStack::setBasePtr(int32 pos) {
-	if ((pos > 0) || ((pos % 4) != 0))
-		throw Common::Exception("NCSStack::setBasePtr(): Illegal position %d", pos);
-
-	_basePtr = (pos / -4) - 1;
-}
-
-void NCSStack::print() const {
-	if (!DebugMan.isEnabled(kDebugScripts, 3))
-		return;
-
-	debugC(kDebugScripts, 3, ".--- %d ---.", _stackPtr);
-	for (int32 i = _stackPtr; i >= 0; i--) {
-		const Variable &var = at(i);
-
-		Common::UString str;
-		formatVariable(str, var);
-
-		debugC(kDebugScripts, 3, "| %04d: %02d - %s", i, var.getType(), str.c_str());
-	}
-	debugC(kDebugScripts, 3, "'--- ---'");
+	return v;
 }
 
 
@@ -274,16 +150,19 @@ void NCSFile::setupOpcodes() {
 
 #undef OPCODE
 
-NCSFile::NCSFile(Common::SeekableReadStream *ncs) : _script(ncs), _owner(0), _triggerer(0) {
-	assert(_script);
+NCSFile::NCSFile(Common::SeekableReadStream *ncs) : _interpreter(kInterpreterAuto), _pc(0), _instruction(0), _owner(0), _triggerer(0),
+	_profiling(false), _instructionCount(0), _reportedAllocations(0) {
+	assert(ncs);
+
+	Common::ScopedPtr<Common::SeekableReadStream> script(ncs);
+	_program.reset(new NCSProgram(*script));
 
 	load();
 }
 
-NCSFile::NCSFile(const Common::UString &ncs) : _name(ncs), _owner(0), _triggerer(0) {
-	_script.reset(ResMan.getResource(ncs, kFileTypeNCS));
-	if (!_script)
-		throw Common::Exception("No such NCS \"%s\"", ncs.c_str());
+NCSFile::NCSFile(const Common::UString &ncs) : _name(ncs), _interpreter(kInterpreterAuto), _pc(0), _instruction(0), _owner(0), _triggerer(0),
+	_profiling(false), _instructionCount(0), _reportedAllocations(0) {
+	_program = NCSCache.getProgram(ncs);
 
 	load();
 }
@@ -303,6 +182,10 @@ void NCSFile::setEnvironment(const VariableContainer &env) {
 	_env = env;
 }
 
+void NCSFile::setInterpreter(Interpreter interpreter) {
+	_interpreter = interpreter;
+}
+
 ScriptState NCSFile::getEmptyState() {
 	ScriptState state;
 
@@ -312,23 +195,8 @@ ScriptState NCSFile::getEmptyState() {
 }
 
 void NCSFile::load() {
-	readHeader(*_script);
-
-	if (_id != kNCSTag)
-		throw Common::Exception("Try to load non-NCS file");
-
-	if (_version != kVersion10)
-		throw Common::Exception("Unsupported NCS file version %08X", _version);
-
-	byte lengthOpcode = _script->readByte();
-	if (lengthOpcode != 0x42)
-		throw Common::Exception("Script size opcode != 0x42 (0x%02X)", lengthOpcode);
-
-	uint32 length = _script->readUint32BE();
-	if (length > ((uint32) _script->size()))
-		throw Common::Exception("Script size %u > stream size %u", length, (uint)_script->size());
-	if (length < ((uint32) _script->size()))
-		warning("TODO: NCSFile::load(): Script size %u < stream size %u", length, (uint)_script->size());
+	_id      = _program->getID();
+	_version = _program->getVersion();
 
 	setupOpcodes();
 
@@ -336,7 +204,7 @@ void NCSFile::load() {
 }
 
 void NCSFile::reset() {
-	_stack.reset();
+	_values.reset(_program.get());
 
 	while (!_returnOffsets.empty())
 		_returnOffsets.pop();
@@ -344,7 +212,11 @@ void NCSFile::reset() {
 	_storedState.setType(kTypeVoid);
 	_return.setType(kTypeVoid);
 
-	_script->seek(13); // 8 byte header + 5 byte program size dummy op
+	_pc = _program->findInstruction(getEmptyState().offset);
+	_instruction = 0;
+
+	_instructionCount    = 0;
+	_reportedAllocations = 0;
 }
 
 const Variable &NCSFile::run(Object *owner, Object *triggerer) {
@@ -357,35 +229,64 @@ const Variable &NCSFile::run(const ScriptState &state, Object *owner, Object *tr
 
 	reset();
 
-	_script->seek(state.offset);
+	_pc = _program->findInstruction(state.offset);
 
 	// Push global variables
 	std::vector<class Variable>::const_reverse_iterator var;
 	for (var = state.globals.rbegin(); var != state.globals.rend(); ++var)
-		_stack.push(*var);
+		_values.pushVariable(*var);
 
-	_stack.setBasePtr(_stack.getStackPtr());
+	_values.setBasePtr(_values.getStackPtr());
 
 	// Push local variables
 	for (var = state.locals.rbegin(); var != state.locals.rend(); ++var)
-		_stack.push(*var);
+		_values.pushVariable(*var);
 
-	return execute(owner, triggerer);
+	return execute(useFastInterpreter(), owner, triggerer);
 }
 
-const Variable &NCSFile::execute(Object *owner, Object *triggerer) {
+bool NCSFile::useFastInterpreter() const {
+	if (_interpreter == kInterpreterAuto)
+		return !DebugMan.isEnabled(kDebugScripts, 1);
+
+	return _interpreter == kInterpreterFast;
+}
+
+const Variable &NCSFile::execute(bool fast, Object *owner, Object *triggerer) {
 	_owner     = owner;
 	_triggerer = triggerer;
 
-	while (executeStep())
-		;
+	_profiling = NCSProfile.isEnabled();
+	if (_profiling)
+		NCSProfile.enterScript(_name.empty() ? "<unnamed>" : _name);
+
+	try {
+		if (fast)
+			executeFast();
+		else
+			while (executeStep())
+				;
+
+		if (!_values.empty())
+			_return = _values.toVariable(_values.top());
 
-	if (!_stack.empty())
-		_return = _stack.top();
+	} catch (...) {
+		if (_profiling) {
+			reportCounts();
+			NCSProfile.leaveScript();
+		}
 
-	if (!_stack.empty() && (_stack.top().getType() == kTypeInt))
+		throw;
+	}
+
+	if (_profiling) {
+		reportCounts();
+		NCSProfile.leaveScript();
+	}
+
+	if (_return.getType() == kTypeInt)
 		debugC(kDebugScripts, 1, "=> Script\"%s\" returns: %d",
-		       _name.c_str(), _stack.top().getInt());
+		       _name.c_str(), _return.getInt());
 
 	_owner     = 0;
 	_triggerer = 0;
@@ -394,36 +295,104 @@ const Variable &NCSFile::execute(Object *owner, Object *triggerer) {
 }
 
 bool NCSFile::executeStep() {
-	byte opcode, type;
-
-	try {
-		opcode = _script->readByte();
-		type   = _script->readByte();
-	} catch (...) {
+	if (_pc >= _program->getInstructionCount())
 		return false;
-	}
+
+	_instruction = &_program->getInstruction(_pc++);
+
+	const uint8 opcode = _instruction->opcode;
+	if (opcode == kOpcodeError)
+		throw Common::Exception("%s", _program->getError(*_instruction).c_str());
 
 	if ((opcode >= _opcodeListSize) || (!_opcodes[opcode].proc))
 		throw Common::Exception("NCSFile::executeStep(): Illegal instruction 0x%02x", opcode);
 
 	debugC(kDebugScripts, 1, "NWScript opcode %s [0x%02X]", _opcodes[opcode].desc, opcode);
 
-	(this->*(_opcodes[opcode].proc))((InstructionType)type);
+	_instructionCount++;
+
+	(this->*(_opcodes[opcode].proc))((InstructionType)_instruction->type);
 
-	_stack.print();
+	_values.print();
 	debugC(kDebugScripts, 2, "[RETURN: %d]",
-	       _returnOffsets.empty() ? -1 : _returnOffsets.top());
+	       _returnOffsets.empty() ? -1 : (int) _program->getInstruction(_returnOffsets.top() - 1).address);
 
 	return true;
 }
 
-void NCSFile::decompile() {
-	uint32 oldScriptPos = _script->pos();
-	_script->seek(13); // 8 byte header + 5 byte program size dummy op
+void NCSFile::executeFast() {
+	const size_t count = _program->getInstructionCount();
+	if (count == 0)
+		return;
 
-	// TODO
+	const NCSInstruction * const code = &_program->getInstruction(0);
+
+	while (_pc < count) {
+		_instruction = &code[_pc++];
+		_instructionCount++;
+
+		const InstructionType type = (InstructionType) _instruction->type;
+
+		// Calling the opcode handlers directly, instead of through the table, lets them be inlined
+		switch (_instruction->opcode) {
+			case kOpcodeNOP:
+			case kOpcodeNOP2:          o_nop(type);           break;
+			case kOpcodeCPDOWNSP:      o_cpdownsp(type);      break;
+			case kOpcodeRSADD:         o_rsadd(type);         break;
+			case kOpcodeCPTOPSP:       o_cptopsp(type);       break;
+			case kOpcodeCONST:         o_const(type);         break;
+			case kOpcodeACTION:        o_action(type);        break;
+			case kOpcodeLOGAND:        o_logand(type);        break;
+			case kOpcodeLOGOR:         o_logor(type);         break;
+			case kOpcodeINCOR:         o_incor(type);         break;
+			case kOpcodeEXCOR:         o_excor(type);         break;
+			case kOpcodeBOOLAND:       o_booland(type);       break;
+			case kOpcodeEQ:            o_eq(type);            break;
+			case kOpcodeNEQ:           o_neq(type);           break;
+			case kOpcodeGEQ:           o_geq(type);           break;
+			case kOpcodeGT:            o_gt(type);            break;
+			case kOpcodeLT:            o_lt(type);            break;
+			case kOpcodeLEQ:           o_leq(type);           break;
+			case kOpcodeSHLEFT:        o_shleft(type);        break;
+			case kOpcodeSHRIGHT:       o_shright(type);       break;
+			case kOpcodeUSHRIGHT:      o_ushright(type);      break;
+			case kOpcodeADD:           o_add(type);           break;
+			case kOpcodeSUB:           o_sub(type);           break;
+			case kOpcodeMUL:           o_mul(type);           break;
+			case kOpcodeDIV:           o_div(type);           break;
+			case kOpcodeMOD:           o_mod(type);           break;
+			case kOpcodeNEG:           o_neg(type);           break;
+			case kOpcodeCOMP:          o_comp(type);          break;
+			case kOpcodeMOVSP:         o_movsp(type);         break;
+			case kOpcodeSTORESTATEALL: o_storestateall(type); break;
+			case kOpcodeJMP:           o_jmp(type);           break;
+			case kOpcodeJSR:           o_jsr(type);           break;
+			case kOpcodeJZ:            o_jz(type);            break;
+			case kOpcodeRETN:          o_retn(type);          break;
+			case kOpcodeDESTRUCT:      o_destruct(type);      break;
+			case kOpcodeNOT:           o_not(type);           break;
+			case kOpcodeDECSP:         o_decsp(type);         break;
+			case kOpcodeINCSP:         o_incsp(type);         break;
+			case kOpcodeJNZ:           o_jnz(type);           break;
+			case kOpcodeCPDOWNBP:      o_cpdownbp(type);      break;
+			case kOpcodeCPTOPBP:       o_cptopbp(type);       break;
+			case kOpcodeDECBP:         o_decbp(type);         break;
+			case kOpcodeINCBP:         o_incbp(type);         break;
+			case kOpcodeSAVEBP:        o_savebp(type);        break;
+			case kOpcodeRESTOREBP:     o_restorebp(type);     break;
+			case kOpcodeSTORESTATE:    o_storestate(type);    break;
+			case kOpcodeWRITEARRAY:    o_writearray(type);    break;
+			case kOpcodeREADARRAY:     o_readarray(type);     break;
+			case kOpcodeGETREF:        o_getref(type);        break;
+			case kOpcodeGETREFARRAY:   o_getrefarray(type);   break;
+
+			case kOpcodeError:
+				throw Common::Exception("%s", _program->getError(*_instruction).c_str());
 
-	_script->seek(oldScriptPos);
+			default:
+				throw Common::Exception("NCSFile::executeStep(): Illegal instruction 0x%02x", _instruction->opcode);
+		}
+	}
 }
 
 // OPCODES!
@@ -432,17 +401,17 @@ void NCSFile::decompile() {
 void NCSFile::o_rsadd(InstructionType type) {
 	switch (type) {
 		case kInstTypeInt:
-			_stack.push(kTypeInt);
+			_values.pushInt(0);
 			break;
 		case kInstTypeFloat:
-			_stack.push(kTypeFloat);
+			_values.pushFloat(0.0f);
 			break;
 		case kInstTypeString:
 		case kInstTypeResource:
-			_stack.push(kTypeString);
+			_values.pushString("", 0);
 			break;
 		case kInstTypeObject:
-			_stack.push(kTypeObject);
+			_values.pushObject(0);
 			break;
 		case kInstTypeEngineType0:
 		case kInstTypeEngineType1:
@@ -450,7 +419,7 @@ void NCSFile::o_rsadd(InstructionType type) {
 		case kInstTypeEngineType3:
 		case kInstTypeEngineType4:
 		case kInstTypeEngineType5:
-			_stack.push(kTypeEngineType);
+			_values.pushVariable(Variable(kTypeEngineType));
 			break;
 		case kInstTypeIntArray:
 		case kInstTypeFloatArray:
@@ -463,7 +432,7 @@ void NCSFile::o_rsadd(InstructionType type) {
 		case kInstTypeEngineType3Array:
 		case kInstTypeEngineType4Array:
 		case kInstTypeEngineType5Array:
-			_stack.push(kTypeArray);
+			_values.pushVariable(Variable(kTypeArray));
 			break;
 		default:
 			throw Common::Exception("NCSFile::o_rsadd(): Illegal type %d", type);
@@ -474,16 +443,16 @@ void NCSFile::o_rsadd(InstructionType type) {
 void NCSFile::o_const(InstructionType type) {
 	switch (type) {
 		case kInstTypeInt:
-			_stack.push(_script->readSint32BE());
+			_values.pushInt(_instruction->args[0]);
 			break;
 
 		case kInstTypeFloat:
-			_stack.push(_script->readIEEEFloatBE());
+			_values.pushFloat(_instruction->floatArg);
 			break;
 
 		case kInstTypeString:
 		case kInstTypeResource: {
-			_stack.push(Common::readStringFixed(*_script, Common::kEncodingASCII, _script->readUint16BE()));
+			_values.pushConstString(_instruction->args[0]);
 			break;
 		}
 
@@ -496,16 +465,16 @@ void NCSFile::o_const(InstructionType type) {
 			 * magic values. They *should* all have the same effect, though.
 			 */
 
-			uint32 objectID = _script->readUint32BE();
+			uint32 objectID = (uint32) _instruction->args[0];
 
 			if      (objectID == kScriptObjectSelf)
-				_stack.push(_owner);
+				_values.pushObject(_owner);
 			else if (objectID == kScriptObjectInvalid)
-				_stack.push((Object *) 0);
+				_values.pushObject(0);
 			else if (objectID == kScriptObjectInvalid2)
-				_stack.push((Object *) 0);
+				_values.pushObject(0);
 			else if (objectID == kScriptObjectTypeInvalid)
-				_stack.push((Object *) 0);
+				_values.pushObject(0);
 			else
 				throw Common::Exception("NCSFile::o_const(): Illegal object ID %d", objectID);
 
@@ -517,6 +486,27 @@ void NCSFile::o_const(InstructionType type) {
 	}
 }
 
+/** Continue the execution at this instruction index. */
+void NCSFile::jump(uint32 target) {
+	if (target == NCSProgram::kInvalidTarget)
+		throw Common::Exception("NCSFile::jump(): Illegal jump by %d from offset %u",
+		                        _instruction->args[0], _instruction->address);
+
+	_pc = target;
+
+	// Scripts can only loop by jumping, so this is where strings and boxes pile up
+	_values.collect();
+}
+
+void NCSFile::reportCounts() {
+	const size_t allocations = _values.getAllocationCount();
+
+	NCSProfile.count(_instructionCount, allocations - _reportedAllocations);
+
+	_instructionCount    = 0;
+	_reportedAllocations = allocations;
+}
+
 /** Helper function for o_action(), doing the actual engine function calling. */
 void NCSFile::callEngine(Aurora::NWScript::FunctionContext &ctx,
                          uint32 function, uint8 argCount) {
@@ -536,7 +526,7 @@ void NCSFile::callEngine(Aurora::NWScript::FunctionContext &ctx,
 
 		Type type = param.getType();
 		if (type == kTypeAny)
-			type = _stack.top().getType();
+			type = _values.getType(_values.top());
 
 		switch (type) {
 			case kTypeInt:
@@ -546,15 +536,15 @@ void NCSFile::callEngine(Aurora::NWScript::FunctionContext &ctx,
 			case kTypeEngineType:
 			case kTypeReference:
 			case kTypeArray:
-				param = _stack.pop();
+				param = _values.toVariable(_values.pop());
 				break;
 
 			case kTypeVector: {
 				// A vector is held as three floats on the stack
 
-				float z = _stack.pop().getFloat();
-				float y = _stack.pop().getFloat();
-				float x = _stack.pop().getFloat();
+				float z = _values.popFloat();
+				float y = _values.popFloat();
+				float x = _values.popFloat();
 
 				param.setVector(x, y, z);
 				break;
@@ -577,8 +567,19 @@ void NCSFile::callEngine(Aurora::NWScript::FunctionContext &ctx,
 
 	// Call the engine function
 	debugC(kDebugScripts, 1, "NWScript engine function %s (%d)", ctx.getName().c_str(), function);
+
+	if (_profiling) {
+		reportCounts();
+		NCSProfile.enterFunction(function, ctx.getName());
+	}
+
 	FunctionMan.call(function, ctx);
 
+	if (_profiling) {
+		reportCounts();
+		NCSProfile.leaveFunction();
+	}
+
 	// Push return values
 	Variable &retVal = ctx.getReturn();
 	switch (retVal.getType()) {
@@ -591,7 +592,7 @@ void NCSFile::callEngine(Aurora::NWScript::FunctionContext &ctx,
 		case kTypeObject:
 		case kTypeEngineType:
 		case kTypeArray:
-			_stack.push(retVal);
+			_values.pushVariable(retVal);
 			break;
 
 		case kTypeVector: {
@@ -600,9 +601,9 @@ void NCSFile::callEngine(Aurora::NWScript::FunctionContext &ctx,
 			float x, y, z;
 			retVal.getVector(x, y, z);
 
-			_stack.push(x);
-			_stack.push(y);
-			_stack.push(z);
+			_values.pushFloat(x);
+			_values.pushFloat(y);
+			_values.pushFloat(z);
 			break;
 		}
 
@@ -618,8 +619,8 @@ void NCSFile::o_action(InstructionType type) {
 	if (type != kInstTypeNone)
 		throw Common::Exception("NCSFile::o_action(): Illegal type %d", type);
 
-	uint16 routineNumber = _script->readUint16BE();
-	uint8  argCount      = _script->readByte();
+	uint16 routineNumber = _instruction->args[0];
+	uint8  argCount      = _instruction->args[1];
 
 	Aurora::NWScript::FunctionContext ctx = FunctionMan.createContext(routineNumber);
 
@@ -637,9 +638,9 @@ void NCSFile::o_logand(InstructionType type) {
 	if (type != kInstTypeIntInt)
 		throw Common::Exception("NCSFile::o_logand(): Illegal type %d", type);
 
-	int32 arg1 = _stack.pop().getInt();
-	int32 arg2 = _stack.pop().getInt();
-	_stack.push(arg1 && arg2);
+	int32 arg1 = _values.popInt();
+	int32 arg2 = _values.popInt();
+	_values.pushInt(arg1 && arg2);
 }
 
 /** LOGOR: perform a logical boolean OR (||). */
@@ -647,9 +648,9 @@ void NCSFile::o_logor(InstructionType type) {
 	if (type != kInstTypeIntInt)
 		throw Common::Exception("NCSFile::o_logor(): Illegal type %d", type);
 
-	int32 arg1 = _stack.pop().getInt();
-	int32 arg2 = _stack.pop().getInt();
-	_stack.push(arg1 || arg2);
+	int32 arg1 = _values.popInt();
+	int32 arg2 = _values.popInt();
+	_values.pushInt(arg1 || arg2);
 }
 
 /** INCOR: perform a bit-wise inclusive OR (|). */
@@ -657,9 +658,9 @@ void NCSFile::o_incor(InstructionType type) {
 	if (type != kInstTypeIntInt)
 		throw Common::Exception("NCSFile::o_incor(): Illegal type %d", type);
 
-	int32 arg1 = _stack.pop().getInt();
-	int32 arg2 = _stack.pop().getInt();
-	_stack.push(arg1 | arg2);
+	int32 arg1 = _values.popInt();
+	int32 arg2 = _values.popInt();
+	_values.pushInt(arg1 | arg2);
 }
 
 /** EXCOR: perform a bit-wise exclusive OR (^). */
@@ -667,9 +668,9 @@ void NCSFile::o_excor(InstructionType type) {
 	if (type != kInstTypeIntInt)
 		throw Common::Exception("NCSFile::o_excor(): Illegal type %d", type);
 
-	int32 arg1 = _stack.pop().getInt();
-	int32 arg2 = _stack.pop().getInt();
-	_stack.push(arg1 ^ arg2);
+	int32 arg1 = _values.popInt();
+	int32 arg2 = _values.popInt();
+	_values.pushInt(arg1 ^ arg2);
 }
 
 /** BOOLAND: perform a bit-wise AND (&). */
@@ -677,67 +678,59 @@ void NCSFile::o_booland(InstructionType type) {
 	if (type != kInstTypeIntInt)
 		throw Common::Exception("NCSFile::o_booland(): Illegal type %d", type);
 
-	int32 arg1 = _stack.pop().getInt();
-	int32 arg2 = _stack.pop().getInt();
-	_stack.push(arg1 & arg2);
+	int32 arg1 = _values.popInt();
+	int32 arg2 = _values.popInt();
+	_values.pushInt(arg1 & arg2);
 }
 
-/** EQ: compare the top-most stack elements for equality (==). */
-void NCSFile::o_eq(InstructionType type) {
+/** Helper function for o_eq() and o_neq(), popping and comparing the top-most stack elements. */
+bool NCSFile::popEqual(InstructionType type, const char *op) {
 	size_t n = 1;
 
 	if (type == kInstTypeStructStruct) {
 		// Comparisons between two structs (or two vectors) come with the size of the type
 
-		const size_t size = _script->readUint16BE();
+		const size_t size = _instruction->args[0];
 
 		if ((size % 4) != 0)
-			throw Common::Exception("NCSFile::o_eq(): size %% 4 != 0");
+			throw Common::Exception("NCSFile::%s(): size %% 4 != 0", op);
 
 		n = size / 4;
 	}
 
-	std::vector<Variable> args1, args2;
+	if (n == 1) {
+		const NCSValue arg1 = _values.pop();
+		const NCSValue arg2 = _values.pop();
+
+		return _values.equals(arg1, arg2);
+	}
+
+	std::vector<NCSValue> args1, args2;
 
 	args1.reserve(n);
 	args2.reserve(n);
 
 	for (size_t i = 0; i < n; i++)
-		args1.push_back(_stack.pop());
+		args1.push_back(_values.pop());
+
+	for (size_t i = 0; i < n; i++)
+		args2.push_back(_values.pop());
 
 	for (size_t i = 0; i < n; i++)
-		args2.push_back(_stack.pop());
+		if (!_values.equals(args1[i], args2[i]))
+			return false;
 
-	_stack.push(args1 == args2);
+	return true;
+}
+
+/** EQ: compare the top-most stack elements for equality (==). */
+void NCSFile::o_eq(InstructionType type) {
+	_values.pushInt(popEqual(type, "o_eq"));
 }
 
 /** NEQ: compare the top-most stack elements for inequality (!=). */
 void NCSFile::o_neq(InstructionType type) {
-	size_t n = 1;
-
-	if (type == kInstTypeStructStruct) {
-		// Comparisons between two structs (or two vectors) come with the size of the type
-
-		const size_t size = _script->readUint16BE();
-
-		if ((size % 4) != 0)
-			throw Common::Exception("NCSFile::o_neq(): size %% 4 != 0");
-
-		n = size / 4;
-	}
-
-	std::vector<Variable> args1, args2;
-
-	args1.reserve(n);
-	args2.reserve(n);
-
-	for (size_t i = 0; i < n; i++)
-		args1.push_back(_stack.pop());
-
-	for (size_t i = 0; i < n; i++)
-		args2.push_back(_stack.pop());
-
-	_stack.push(args1 != args2);
+	_values.pushInt(!popEqual(type, "o_neq"));
 }
 
 /** GEQ: compare the top-most stack elements, greater-or-equal (>=). */
@@ -745,17 +738,17 @@ void NCSFile::o_geq(InstructionType type) {
 	switch (type) {
 		case kInstTypeIntInt:
 			{
-				int32 arg1 = _stack.pop().getInt();
-				int32 arg2 = _stack.pop().getInt();
-				_stack.push(arg2 >= arg1);
+				int32 arg1 = _values.popInt();
+				int32 arg2 = _values.popInt();
+				_values.pushInt(arg2 >= arg1);
 			}
 			break;
 
 		case kInstTypeFloatFloat:
 			{
-				float arg1 = _stack.pop().getFloat();
-				float arg2 = _stack.pop().getFloat();
-				_stack.push(arg2 >= arg1);
+				float arg1 = _values.popFloat();
+				float arg2 = _values.popFloat();
+				_values.pushInt(arg2 >= arg1);
 			}
 			break;
 
@@ -769,17 +762,17 @@ void NCSFile::o_gt(InstructionType type) {
 	switch (type) {
 		case kInstTypeIntInt:
 			{
-				int32 arg1 = _stack.pop().getInt();
-				int32 arg2 = _stack.pop().getInt();
-				_stack.push(arg2 > arg1);
+				int32 arg1 = _values.popInt();
+				int32 arg2 = _values.popInt();
+				_values.pushInt(arg2 > arg1);
 			}
 			break;
 
 		case kInstTypeFloatFloat:
 			{
-				float arg1 = _stack.pop().getFloat();
-				float arg2 = _stack.pop().getFloat();
-				_stack.push(arg2 > arg1);
+				float arg1 = _values.popFloat();
+				float arg2 = _values.popFloat();
+				_values.pushInt(arg2 > arg1);
 			}
 			break;
 
@@ -793,17 +786,17 @@ void NCSFile::o_lt(InstructionType type) {
 	switch (type) {
 		case kInstTypeIntInt:
 			{
-				int32 arg1 = _stack.pop().getInt();
-				int32 arg2 = _stack.pop().getInt();
-				_stack.push(arg2 < arg1);
+				int32 arg1 = _values.popInt();
+				int32 arg2 = _values.popInt();
+				_values.pushInt(arg2 < arg1);
 			}
 			break;
 
 		case kInstTypeFloatFloat:
 			{
-				float arg1 = _stack.pop().getFloat();
-				float arg2 = _stack.pop().getFloat();
-				_stack.push(arg2 < arg1);
+				float arg1 = _values.popFloat();
+				float arg2 = _values.popFloat();
+				_values.pushInt(arg2 < arg1);
 			}
 			break;
 
@@ -817,17 +810,17 @@ void NCSFile::o_leq(InstructionType type) {
 	switch (type) {
 		case kInstTypeIntInt:
 			{
-				int32 arg1 = _stack.pop().getInt();
-				int32 arg2 = _stack.pop().getInt();
-				_stack.push(arg2 <= arg1);
+				int32 arg1 = _values.popInt();
+				int32 arg2 = _values.popInt();
+				_values.pushInt(arg2 <= arg1);
 			}
 			break;
 
 		case kInstTypeFloatFloat:
 			{
-				float arg1 = _stack.pop().getFloat();
-				float arg2 = _stack.pop().getFloat();
-				_stack.push(arg2 <= arg1);
+				float arg1 = _values.popFloat();
+				float arg2 = _values.popFloat();
+				_values.pushInt(arg2 <= arg1);
 			}
 			break;
 
@@ -841,9 +834,9 @@ void NCSFile::o_shleft(InstructionType type) {
 	if (type != kInstTypeIntInt)
 		throw Common::Exception("NCSFile::o_shleft(): Illegal type %d", type);
 
-	int32 arg1 = _stack.pop().getInt();
-	int32 arg2 = _stack.pop().getInt();
-	_stack.push(arg2 << arg1);
+	int32 arg1 = _values.popInt();
+	int32 arg2 = _values.popInt();
+	_values.pushInt(arg2 << arg1);
 }
 
 /** SHRIGHT: signed-shift the top-most stack element to the right (>>>). */
@@ -857,14 +850,14 @@ void NCSFile::o_shright(InstructionType type) {
 	if (type != kInstTypeIntInt)
 		throw Common::Exception("NCSFile::o_shright(): Illegal type %d", type);
 
-	int32 arg1 = _stack.pop().getInt();
-	int32 arg2 = _stack.pop().getInt();
+	int32 arg1 = _values.popInt();
+	int32 arg2 = _values.popInt();
 
 	if (arg2 < 0) {
 		arg2 = -arg2;
-		_stack.push(-(arg2 >> arg1));
+		_values.pushInt(-(arg2 >> arg1));
 	} else
-		_stack.push(arg2 >> arg1);
+		_values.pushInt(arg2 >> arg1);
 }
 
 /** USHRIGHT: shift the top-most stack element to the right (>>). */
@@ -877,9 +870,9 @@ void NCSFile::o_ushright(InstructionType type) {
 	if (type != kInstTypeIntInt)
 		throw Common::Exception("NCSFile::o_ushright(): Illegal type %d", type);
 
-	int32 arg1 = _stack.pop().getInt();
-	int32 arg2 = _stack.pop().getInt();
-	_stack.push(arg2 >> arg1);
+	int32 arg1 = _values.popInt();
+	int32 arg2 = _values.popInt();
+	_values.pushInt(arg2 >> arg1);
 }
 
 /** MOD: calculate the remainder (modulo) of an integer division (%). */
@@ -887,26 +880,26 @@ void NCSFile::o_mod(InstructionType type) {
 	if (type != kInstTypeIntInt)
 		throw Common::Exception("NCSFile::o_mod(): Illegal type %d", type);
 
-	int32 arg1 = _stack.pop().getInt();
-	int32 arg2 = _stack.pop().getInt();
+	int32 arg1 = _values.popInt();
+	int32 arg2 = _values.popInt();
 
 	if (arg1 == 0)
 		throw Common::Exception("NCSFile::o_mod(): Modulus by zero");
 	else if (arg1 < 0 || arg2 < 0)
 		throw Common::Exception("NCSFile::o_mod(): Modulus by negative number (%d %% %d)", arg2, arg1);
 
-	_stack.push(arg2 % arg1);
+	_values.pushInt(arg2 % arg1);
 }
 
 /** NEQ: negate the top-most stack element (unary -). */
 void NCSFile::o_neg(InstructionType type) {
 	switch (type) {
 		case kInstTypeInt:
-			_stack.push(-_stack.pop().getInt());
+			_values.pushInt(-_values.popInt());
 			break;
 
 		case kInstTypeFloat:
-			_stack.push(-_stack.pop().getFloat());
+			_values.pushFloat(-_values.popFloat());
 			break;
 
 		default:
@@ -919,7 +912,7 @@ void NCSFile::o_comp(InstructionType type) {
 	if (type != kInstTypeInt)
 		throw Common::Exception("NCSFile::o_comp(): Illegal type %d", type);
 
-	_stack.push(~_stack.pop().getInt());
+	_values.pushInt(~_values.popInt());
 }
 
 /** MOVSP: pop elements off the stack. */
@@ -927,7 +920,7 @@ void NCSFile::o_movsp(InstructionType type) {
 	if (type != kInstTypeNone)
 		throw Common::Exception("NCSFile::o_movsp(): Illegal type %d", type);
 
-	_stack.setStackPtr(_stack.getStackPtr() - _script->readSint32BE());
+	_values.setStackPtr(_values.getStackPtr() - _instruction->args[0]);
 }
 
 /** JMP: jump directly to a different script offset. */
@@ -935,8 +928,7 @@ void NCSFile::o_jmp(InstructionType type) {
 	if (type != kInstTypeNone)
 		throw Common::Exception("NCSFile::o_jmp(): Illegal type %d", type);
 
-	int32 offset = _script->readSint32BE();
-	_script->skip(offset - 6);
+	jump(_instruction->target);
 }
 
 /** JZ: jump conditionally if the top-most stack element is 0. */
@@ -944,10 +936,8 @@ void NCSFile::o_jz(InstructionType type) {
 	if (type != kInstTypeNone)
 		throw Common::Exception("NCSFile::o_jz(): Illegal type %d", type);
 
-	int32 offset = _script->readSint32BE();
-
-	if (!_stack.pop().getInt())
-		_script->skip(offset - 6);
+	if (!_values.popInt())
+		jump(_instruction->target);
 }
 
 /** NOT: boolean-negate the top-most stack element (!). */
@@ -955,7 +945,7 @@ void NCSFile::o_not(InstructionType type) {
 	if (type != kInstTypeInt)
 		throw Common::Exception("NCSFile::o_not(): Illegal type %d", type);
 
-	_stack.push(!_stack.pop().getInt());
+	_values.pushInt(!_values.popInt());
 }
 
 /** DECSP: decrement the value of a stack element (--). */
@@ -963,9 +953,13 @@ void NCSFile::o_decsp(InstructionType type) {
 	if (type != kInstTypeInt)
 		throw Common::Exception("NCSFile::o_decsp(): Illegal type %d", type);
 
-	int32 offset = _script->readSint32BE();
+	int32 offset = _instruction->args[0];
 
-	_stack.setRelSP(offset, _stack.getRelSP(offset).getInt() - 1);
+	NCSValue &value = _values.getRelSP(offset);
+	if (value.kind == NCSValue::kKindInt)
+		value.intValue--;
+	else
+		_values.setRelSP(offset, makeInt(_values.getInt(value) - 1));
 }
 
 /** INCSP: increment the value of a stack element (++). */
@@ -973,9 +967,13 @@ void NCSFile::o_incsp(InstructionType type) {
 	if (type != kInstTypeInt)
 		throw Common::Exception("NCSFile::o_incsp(): Illegal type %d", type);
 
-	int32 offset = _script->readSint32BE();
+	int32 offset = _instruction->args[0];
 
-	_stack.setRelSP(offset, _stack.getRelSP(offset).getInt() + 1);
+	NCSValue &value = _values.getRelSP(offset);
+	if (value.kind == NCSValue::kKindInt)
+		value.intValue++;
+	else
+		_values.setRelSP(offset, makeInt(_values.getInt(value) + 1));
 }
 
 /** JNZ: jump conditionally if the top-most stack element is not 0. */
@@ -983,10 +981,8 @@ void NCSFile::o_jnz(InstructionType type) {
 	if (type != kInstTypeNone)
 		throw Common::Exception("NCSFile::o_jnz(): Illegal type %d", type);
 
-	int32 offset = _script->readSint32BE();
-
-	if (_stack.pop().getInt())
-		_script->skip(offset - 6);
+	if (_values.popInt())
+		jump(_instruction->target);
 }
 
 /** DECBP: decrement the value of a base-pointer stack element (--). */
@@ -994,9 +990,13 @@ void NCSFile::o_decbp(InstructionType type) {
 	if (type != kInstTypeInt)
 		throw Common::Exception("NCSFile::o_decbp(): Illegal type %d", type);
 
-	int32 offset = _script->readSint32BE();
+	int32 offset = _instruction->args[0];
 
-	_stack.setRelBP(offset, _stack.getRelBP(offset).getInt() - 1);
+	NCSValue &value = _values.getRelBP(offset);
+	if (value.kind == NCSValue::kKindInt)
+		value.intValue--;
+	else
+		_values.setRelBP(offset, makeInt(_values.getInt(value) - 1));
 }
 
 /** INCBP: increment the value of a base-pointer stack element (++). */
@@ -1004,9 +1004,13 @@ void NCSFile::o_incbp(InstructionType type) {
 	if (type != kInstTypeInt)
 		throw Common::Exception("NCSFile::o_incbp(): Illegal type %d", type);
 
-	int32 offset = _script->readSint32BE();
+	int32 offset = _instruction->args[0];
 
-	_stack.setRelBP(offset, _stack.getRelBP(offset).getInt() + 1);
+	NCSValue &value = _values.getRelBP(offset);
+	if (value.kind == NCSValue::kKindInt)
+		value.intValue++;
+	else
+		_values.setRelBP(offset, makeInt(_values.getInt(value) + 1));
 }
 
 /** SAVEBP: set the value of the base-pointer.
@@ -1017,8 +1021,8 @@ void NCSFile::o_savebp(InstructionType type) {
 	if (type != kInstTypeNone)
 		throw Common::Exception("NCSFile::o_savebp(): Illegal type %d", type);
 
-	_stack.push(_stack.getBasePtr());
-	_stack.setBasePtr(_stack.getStackPtr());
+	_values.pushInt(_values.getBasePtr());
+	_values.setBasePtr(_values.getStackPtr());
 }
 
 /** RESTOREBP: restore the value of the base-pointer to a prior value.
@@ -1029,7 +1033,7 @@ void NCSFile::o_restorebp(InstructionType type) {
 	if (type != kInstTypeNone)
 		throw Common::Exception("NCSFile::o_restorebp(): Illegal type %d", type);
 
-	_stack.setBasePtr(_stack.pop().getInt());
+	_values.setBasePtr(_values.popInt());
 }
 
 /** NOP: no operation. */
@@ -1042,15 +1046,15 @@ void NCSFile::o_cpdownsp(InstructionType type) {
 	if (type != kInstTypeDirect)
 		throw Common::Exception("NCSFile::o_cpdownsp(): Illegal type %d", type);
 
-	int32 offset = _script->readSint32BE();
-	int16 size   = _script->readSint16BE();
+	int32 offset = _instruction->args[0];
+	int16 size   = _instruction->args[1];
 
 	if ((size % 4) != 0)
 		throw Common::Exception("NCSFile::o_cpdownsp(): Illegal size %d", size);
 
 	int32 startPos = -size;
 	while (size > 0) {
-		_stack.setRelSP(offset, _stack.getRelSP(startPos));
+		_values.setRelSP(offset, _values.getRelSP(startPos));
 
 		startPos += 4;
 		offset   += 4;
@@ -1063,14 +1067,15 @@ void NCSFile::o_cptopsp(InstructionType type) {
 	if (type != kInstTypeDirect)
 		throw Common::Exception("NCSFile::o_cptopsp(): Illegal type %d", type);
 
-	int32 offset = _script->readSint32BE();
-	int16 size   = _script->readSint16BE();
+	int32 offset = _instruction->args[0];
+	int16 size   = _instruction->args[1];
 
 	if ((size % 4) != 0)
 		throw Common::Exception("NCSFile::o_cptopsp(): Illegal size %d", size);
 
 	while (size > 0) {
-		_stack.push(_stack.getRelSP(offset));
+		// The stack pointer moves with each push, so the offset stays the same
+		_values.push(_values.copy(_values.getRelSP(offset)));
 
 		size -= 4;
 	}
@@ -1080,56 +1085,56 @@ void NCSFile::o_cptopsp(InstructionType type) {
 void NCSFile::o_add(InstructionType type) {
 	switch (type) {
 		case kInstTypeIntInt: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			int32 op2 = _values.popInt();
+			int32 op1 = _values.popInt();
 
-			_stack.push((int32) (op1.getInt() + op2.getInt()));
+			_values.pushInt((int32) (op1 + op2));
 			break;
 		}
 
 		case kInstTypeFloatFloat: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			float op2 = _values.popFloat();
+			float op1 = _values.popFloat();
 
-			_stack.push(op1.getFloat() + op2.getFloat());
+			_values.pushFloat(op1 + op2);
 			break;
 		}
 
 		case kInstTypeIntFloat: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			float op2 = _values.popFloat();
+			int32 op1 = _values.popInt();
 
-			_stack.push(((float) op1.getInt()) + op2.getFloat());
+			_values.pushFloat(((float) op1) + op2);
 			break;
 		}
 
 		case kInstTypeFloatInt: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			int32 op2 = _values.popInt();
+			float op1 = _values.popFloat();
 
-			_stack.push(op1.getFloat() + ((float) op2.getInt()));
+			_values.pushFloat(op1 + ((float) op2));
 			break;
 		}
 
 		case kInstTypeStringString: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			NCSValue op2 = _values.pop();
+			NCSValue op1 = _values.pop();
 
-			_stack.push(op1.getString() + op2.getString());
+			_values.push(_values.concat(op1, op2));
 			break;
 		}
 
 		case kInstTypeVectorVector: {
-			Variable op2z = _stack.pop();
-			Variable op2y = _stack.pop();
-			Variable op2x = _stack.pop();
-			Variable op1z = _stack.pop();
-			Variable op1y = _stack.pop();
-			Variable op1x = _stack.pop();
-
-			_stack.push(op1z.getFloat() + op2z.getFloat());
-			_stack.push(op1y.getFloat() + op2y.getFloat());
-			_stack.push(op1x.getFloat() + op2x.getFloat());
+			float op2z = _values.popFloat();
+			float op2y = _values.popFloat();
+			float op2x = _values.popFloat();
+			float op1z = _values.popFloat();
+			float op1y = _values.popFloat();
+			float op1x = _values.popFloat();
+
+			_values.pushFloat(op1z + op2z);
+			_values.pushFloat(op1y + op2y);
+			_values.pushFloat(op1x + op2x);
 			break;
 		}
 
@@ -1142,48 +1147,48 @@ void NCSFile::o_add(InstructionType type) {
 void NCSFile::o_sub(InstructionType type) {
 	switch (type) {
 		case kInstTypeIntInt: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			int32 op2 = _values.popInt();
+			int32 op1 = _values.popInt();
 
-			_stack.push((int32) (op1.getInt() - op2.getInt()));
+			_values.pushInt((int32) (op1 - op2));
 			break;
 		}
 
 		case kInstTypeFloatFloat: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			float op2 = _values.popFloat();
+			float op1 = _values.popFloat();
 
-			_stack.push(op1.getFloat() - op2.getFloat());
+			_values.pushFloat(op1 - op2);
 			break;
 		}
 
 		case kInstTypeIntFloat: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			float op2 = _values.popFloat();
+			int32 op1 = _values.popInt();
 
-			_stack.push(((float) op1.getInt()) - op2.getFloat());
+			_values.pushFloat(((float) op1) - op2);
 			break;
 		}
 
 		case kInstTypeFloatInt: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			int32 op2 = _values.popInt();
+			float op1 = _values.popFloat();
 
-			_stack.push(op1.getFloat() - ((float) op2.getInt()));
+			_values.pushFloat(op1 - ((float) op2));
 			break;
 		}
 
 		case kInstTypeVectorVector: {
-			Variable op2z = _stack.pop();
-			Variable op2y = _stack.pop();
-			Variable op2x = _stack.pop();
-			Variable op1z = _stack.pop();
-			Variable op1y = _stack.pop();
-			Variable op1x = _stack.pop();
-
-			_stack.push(op1z.getFloat() - op2z.getFloat());
-			_stack.push(op1y.getFloat() - op2y.getFloat());
-			_stack.push(op1x.getFloat() - op2x.getFloat());
+			float op2z = _values.popFloat();
+			float op2y = _values.popFloat();
+			float op2x = _values.popFloat();
+			float op1z = _values.popFloat();
+			float op1y = _values.popFloat();
+			float op1x = _values.popFloat();
+
+			_values.pushFloat(op1z - op2z);
+			_values.pushFloat(op1y - op2y);
+			_values.pushFloat(op1x - op2x);
 			break;
 		}
 
@@ -1196,58 +1201,58 @@ void NCSFile::o_sub(InstructionType type) {
 void NCSFile::o_mul(InstructionType type) {
 	switch (type) {
 		case kInstTypeIntInt: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			int32 op2 = _values.popInt();
+			int32 op1 = _values.popInt();
 
-			_stack.push((int32) (op1.getInt() * op2.getInt()));
+			_values.pushInt((int32) (op1 * op2));
 			break;
 		}
 
 		case kInstTypeFloatFloat: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			float op2 = _values.popFloat();
+			float op1 = _values.popFloat();
 
-			_stack.push(op1.getFloat() * op2.getFloat());
+			_values.pushFloat(op1 * op2);
 			break;
 		}
 
 		case kInstTypeIntFloat: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			float op2 = _values.popFloat();
+			int32 op1 = _values.popInt();
 
-			_stack.push(((float) op1.getInt()) * op2.getFloat());
+			_values.pushFloat(((float) op1) * op2);
 			break;
 		}
 
 		case kInstTypeFloatInt: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			int32 op2 = _values.popInt();
+			float op1 = _values.popFloat();
 
-			_stack.push(op1.getFloat() * ((float) op2.getInt()));
+			_values.pushFloat(op1 * ((float) op2));
 			break;
 		}
 
 		case kInstTypeVectorFloat: {
-			Variable op2  = _stack.pop();
-			Variable op1z = _stack.pop();
-			Variable op1y = _stack.pop();
-			Variable op1x = _stack.pop();
-
-			_stack.push(op1z.getFloat() * op2.getFloat());
-			_stack.push(op1y.getFloat() * op2.getFloat());
-			_stack.push(op1x.getFloat() * op2.getFloat());
+			float op2  = _values.popFloat();
+			float op1z = _values.popFloat();
+			float op1y = _values.popFloat();
+			float op1x = _values.popFloat();
+
+			_values.pushFloat(op1z * op2);
+			_values.pushFloat(op1y * op2);
+			_values.pushFloat(op1x * op2);
 			break;
 		}
 
 		case kInstTypeFloatVector: {
-			Variable op2z = _stack.pop();
-			Variable op2y = _stack.pop();
-			Variable op2x = _stack.pop();
-			Variable op1  = _stack.pop();
-
-			_stack.push(op1.getFloat() * op2z.getFloat());
-			_stack.push(op1.getFloat() * op2y.getFloat());
-			_stack.push(op1.getFloat() * op2x.getFloat());
+			float op2z = _values.popFloat();
+			float op2y = _values.popFloat();
+			float op2x = _values.popFloat();
+			float op1  = _values.popFloat();
+
+			_values.pushFloat(op1 * op2z);
+			_values.pushFloat(op1 * op2y);
+			_values.pushFloat(op1 * op2x);
 			break;
 		}
 
@@ -1260,79 +1265,79 @@ void NCSFile::o_mul(InstructionType type) {
 void NCSFile::o_div(InstructionType type) {
 	switch (type) {
 		case kInstTypeIntInt: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			int32 op2 = _values.popInt();
+			int32 op1 = _values.popInt();
 
-			if (op2.getInt() == 0)
+			if (op2 == 0)
 				throw Common::Exception("NCSFile::o_div(): Divide by zero");
 
-			if (op1.getInt() == INT32_MIN && op2.getInt() == -1)
+			if (op1 == INT32_MIN && op2 == -1)
 				throw Common::Exception("NCSFile::o_div: Quotient overflow");
 
-			_stack.push((int32) (op1.getInt() / op2.getInt()));
+			_values.pushInt((int32) (op1 / op2));
 			break;
 		}
 
 		case kInstTypeFloatFloat: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			float op2 = _values.popFloat();
+			float op1 = _values.popFloat();
 
-			if (op2.getFloat() == 0.0f)
+			if (op2 == 0.0f)
 				throw Common::Exception("NCSFile::o_div(): Divide by zero");
 
-			_stack.push(op1.getFloat() / op2.getFloat());
+			_values.pushFloat(op1 / op2);
 			break;
 		}
 
 		case kInstTypeIntFloat: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			float op2 = _values.popFloat();
+			int32 op1 = _values.popInt();
 
-			if (op2.getFloat() == 0.0f)
+			if (op2 == 0.0f)
 				throw Common::Exception("NCSFile::o_div(): Divide by zero");
 
-			_stack.push(((float) op1.getInt()) / op2.getFloat());
+			_values.pushFloat(((float) op1) / op2);
 			break;
 		}
 
 		case kInstTypeFloatInt: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			int32 op2 = _values.popInt();
+			float op1 = _values.popFloat();
 
-			if (op2.getInt() == 0)
+			if (op2 == 0)
 				throw Common::Exception("NCSFile::o_div(): Divide by zero");
 
-			_stack.push(op1.getFloat() / ((float) op2.getInt()));
+			_values.pushFloat(op1 / ((float) op2));
 			break;
 		}
 
 		case kInstTypeVectorFloat: {
-			Variable op2  = _stack.pop();
-			Variable op1z = _stack.pop();
-			Variable op1y = _stack.pop();
-			Variable op1x = _stack.pop();
+			float op2  = _values.popFloat();
+			float op1z = _values.popFloat();
+			float op1y = _values.popFloat();
+			float op1x = _values.popFloat();
 
-			if (op2.getFloat() == 0.0f)
+			if (op2 == 0.0f)
 				throw Common::Exception("NCSFile::o_div(): Divide by zero");
 
-			_stack.push(op1z.getFloat() / op2.getFloat());
-			_stack.push(op1y.getFloat() / op2.getFloat());
-			_stack.push(op1x.getFloat() / op2.getFloat());
+			_values.pushFloat(op1z / op2);
+			_values.pushFloat(op1y / op2);
+			_values.pushFloat(op1x / op2);
 			break;
 		}
 
 		case kInstTypeFloatVector: {
-			Variable op2z = _stack.pop();
-			Variable op2y = _stack.pop();
-			Variable op2x = _stack.pop();
-			Variable op1  = _stack.pop();
+			float op2z = _values.popFloat();
+			float op2y = _values.popFloat();
+			float op2x = _values.popFloat();
+			float op1  = _values.popFloat();
 
-			if (op2x.getFloat() == 0.0f || op2y.getFloat() == 0.0f || op2z.getFloat() == 0.0f)
+			if (op2x == 0.0f || op2y == 0.0f || op2z == 0.0f)
 				throw Common::Exception("NCSFile::o_div(): Divide by zero");
 
-			_stack.push(op1.getFloat() / op2z.getFloat());
-			_stack.push(op1.getFloat() / op2y.getFloat());
-			_stack.push(op1.getFloat() / op2x.getFloat());
+			_values.pushFloat(op1 / op2z);
+			_values.pushFloat(op1 / op2y);
+			_values.pushFloat(op1 / op2x);
 			break;
 		}
 
@@ -1355,23 +1360,34 @@ void NCSFile::o_jsr(InstructionType type) {
 	if (type != kInstTypeNone)
 		throw Common::Exception("NCSFile::o_jsr(): Illegal type %d", type);
 
-	int32 offset = _script->readSint32BE();
+	// Push the index of the next instruction
+	_returnOffsets.push(_pc);
 
-	// Push the current script position
-	_returnOffsets.push(_script->pos());
+	jump(_instruction->target);
 
-	_script->skip(offset - 6);
+	if (_profiling) {
+		reportCounts();
+		NCSProfile.enterSubroutine(_instruction->address + _instruction->args[0]);
+	}
 }
 
 /** RETN: return from a subroutine call. */
 void NCSFile::o_retn(InstructionType UNUSED(type)) {
-	uint32 returnAddress = _script->size();
+	size_t returnAddress = _program->getInstructionCount();
 	if (!_returnOffsets.empty()) {
 		returnAddress = _returnOffsets.top();
 		_returnOffsets.pop();
+
+		if (_profiling) {
+			reportCounts();
+			NCSProfile.leaveSubroutine();
+		}
+
+		// The subroutine's strings and boxes are garbage now
+		_values.collect();
 	}
 
-	_script->seek(returnAddress);
+	_pc = returnAddress;
 }
 
 /** DESTRUCT: remove elements from the stack.
@@ -1379,9 +1395,9 @@ void NCSFile::o_retn(InstructionType UNUSED(type)) {
  *  Used to isolate struct elements.
  */
 void NCSFile::o_destruct(InstructionType UNUSED(type)) {
-	int16 stackSize        = _script->readSint16BE();
-	int16 dontRemoveOffset = _script->readSint16BE();
-	int16 dontRemoveSize   = _script->readSint16BE();
+	int16 stackSize        = _instruction->args[0];
+	int16 dontRemoveOffset = _instruction->args[1];
+	int16 dontRemoveSize   = _instruction->args[2];
 
 	if ((stackSize % 4) != 0)
 		throw Common::Exception("NCSFile::o_destruct(): Illegal stack size %d", stackSize);
@@ -1390,22 +1406,23 @@ void NCSFile::o_destruct(InstructionType UNUSED(type)) {
 	if ((dontRemoveSize % 4) != 0)
 		throw Common::Exception("NCSFile::o_destruct(): Illegal size %d", dontRemoveSize);
 
-	std::vector<Variable> tmp;
+	std::vector<NCSValue> tmp;
 	tmp.reserve(dontRemoveSize / 4);
 
 	while (stackSize > 0) {
 
+		// Copy, so that the kept elements don't share the box of a pinned element
 		if ((stackSize <= (dontRemoveOffset + dontRemoveSize)) &&
 		    (stackSize >   dontRemoveOffset))
-			tmp.push_back(_stack.top());
+			tmp.push_back(_values.copy(_values.top()));
 
-		_stack.pop();
+		_values.pop();
 
 		stackSize -= 4;
 	}
 
-	for (std::vector<Variable>::reverse_iterator t = tmp.rbegin(); t != tmp.rend(); ++t)
-		_stack.push(*t);
+	for (std::vector<NCSValue>::reverse_iterator t = tmp.rbegin(); t != tmp.rend(); ++t)
+		_values.push(*t);
 }
 
 /** CPDOWNBP: copy a value into an existing base-pointer stack element.
@@ -1416,15 +1433,15 @@ void NCSFile::o_cpdownbp(InstructionType type) {
 	if (type != kInstTypeDirect)
 		throw Common::Exception("NCSFile::o_cpdownbp(): Illegal type %d", type);
 
-	int32 offset = _script->readSint32BE() - 4;
-	int16 size   = _script->readSint16BE();
+	int32 offset = _instruction->args[0] - 4;
+	int16 size   = _instruction->args[1];
 
 	if ((size % 4) != 0)
 		throw Common::Exception("NCSFile::o_cpdownbp(): Illegal size %d", size);
 
 	int32 startPos = -size;
 	while (size > 0) {
-		_stack.setRelBP(offset, _stack.getRelSP(startPos));
+		_values.setRelBP(offset, _values.getRelSP(startPos));
 
 		startPos += 4;
 		offset   += 4;
@@ -1440,14 +1457,14 @@ void NCSFile::o_cptopbp(InstructionType type) {
 	if (type != kInstTypeDirect)
 		throw Common::Exception("NCSFile::o_cptopbp(): Illegal type %d", type);
 
-	int32 offset = _script->readSint32BE() - 4;
-	int16 size   = _script->readSint16BE();
+	int32 offset = _instruction->args[0] - 4;
+	int16 size   = _instruction->args[1];
 
 	if ((size % 4) != 0)
 		throw Common::Exception("NCSFile::o_cptopbp(): Illegal size %d", size);
 
 	while (size > 0) {
-		_stack.push(_stack.getRelBP(offset));
+		_values.push(_values.copy(_values.getRelBP(offset)));
 
 		size   -= 4;
 		offset += 4;
@@ -1461,8 +1478,8 @@ void NCSFile::o_cptopbp(InstructionType type) {
  */
 void NCSFile::o_storestate(InstructionType type) {
 	uint8  offset = (uint8) type;
-	uint32 sizeBP = _script->readUint32BE();
-	uint32 sizeSP = _script->readUint32BE();
+	uint32 sizeBP = (uint32) _instruction->args[0];
+	uint32 sizeSP = (uint32) _instruction->args[1];
 
 	if ((sizeBP % 4) != 0)
 		throw Common::Exception("NCSFile::o_storestate(): Illegal BP size %d", sizeBP);
@@ -1472,16 +1489,16 @@ void NCSFile::o_storestate(InstructionType type) {
 	_storedState.setType(kTypeScriptState);
 	ScriptState &state = _storedState.getScriptState();
 
-	state.offset = _script->pos() - 10 + offset;
+	state.offset = _instruction->address + offset;
 
 	sizeBP /= 4;
 	sizeSP /= 4;
 
 	for (int32 posBP = -4; sizeBP > 0; sizeBP--, posBP -= 4)
-		state.globals.push_back(_stack.getRelBP(posBP));
+		state.globals.push_back(_values.toVariable(_values.getRelBP(posBP)));
 
 	for (int32 posSP = -4; sizeSP > 0; sizeSP--, posSP -= 4)
-		state.locals.push_back(_stack.getRelSP(posSP));
+		state.locals.push_back(_values.toVariable(_values.getRelSP(posSP)));
 }
 
 /** WRITEARRAY: write the value of an array element on the stack.
@@ -1499,23 +1516,22 @@ void NCSFile::o_writearray(InstructionType type) {
 	if (type != kInstTypeDirect)
 		throw Common::Exception("NCSFile::o_writearray(): Illegal type %d", type);
 
-	int32 offset = _script->readSint32BE();
-	int16 size   = _script->readSint16BE();
+	int32 offset = _instruction->args[0];
+	int16 size   = _instruction->args[1];
 
 	if (size != 4)
 		throw Common::Exception("NCSFile::o_writearray(): Invalid size %d", size);
 
-	Variable &arrayVar = _stack.getRelSP(offset);
+	Variable &arrayVar = _values.box(_values.getRelSP(offset));
 
-	Variable  indexVar = _stack.pop();
-	Variable &valueVar = _stack.top();
+	const int32 index = _values.popInt();
+	const Variable valueVar = _values.toVariable(_values.top());
 
-	const int32 index = indexVar.getInt();
 	if (index < 0)
 		throw Common::Exception("NCSFile::o_writearray(): Invalid index %d", index);
 
 	arrayVar.growArray(valueVar.getType(), index + 1);
-	arrayVar.getArray()[index] = boost::make_shared<Variable>(Variable(valueVar));
+	arrayVar.getArray()[index] = boost::make_shared<Variable>(valueVar);
 }
 
 /** READARRAY: push the value of an array element onto of the stack.
@@ -1534,22 +1550,21 @@ void NCSFile::o_readarray(InstructionType type) {
 	if (type != kInstTypeDirect)
 		throw Common::Exception("NCSFile::o_readarray(): Illegal type %d", type);
 
-	int32 offset = _script->readSint32BE();
-	int16 size   = _script->readSint16BE();
+	int32 offset = _instruction->args[0];
+	int16 size   = _instruction->args[1];
 
 	if (size != 4)
 		throw Common::Exception("NCSFile::o_readarray(): Invalid size %d", size);
 
-	Variable::Array &array = _stack.getRelSP(offset).getArray();
+	Variable::Array &array = _values.box(_values.getRelSP(offset)).getArray();
 
-	Variable indexVar  = _stack.pop();
-	const int32 index = indexVar.getInt();
+	const int32 index = _values.popInt();
 
 	if ((index < 0) || ((uint)index >= array.size()))
 		throw Common::Exception("NCSFile::o_readarray(): Index out of range (%d, %u)",
 		                        index, (uint) array.size());
 
-	_stack.push(*array[index]);
+	_values.pushVariable(*array[index]);
 }
 
 /** GETREF: push the reference to a stack element onto the stack.
@@ -1566,16 +1581,17 @@ void NCSFile::o_getref(InstructionType type) {
 	if (type != kInstTypeDirect)
 		throw Common::Exception("NCSFile::o_getref(): Illegal type %d", type);
 
-	int32 offset = _script->readSint32BE();
-	int16 size   = _script->readSint16BE();
+	int32 offset = _instruction->args[0];
+	int16 size   = _instruction->args[1];
 
 	if (size != 4)
 		throw Common::Exception("NCSFile::o_getref(): Invalid size %d", size);
 
-	Variable &var = _stack.getRelSP(offset);
+	// The reference refers to the stack position, even after it has been popped and pushed again
+	Variable reference(kTypeReference);
+	reference.setReference(&_values.pinRelSP(offset));
 
-	_stack.push(Variable(kTypeReference));
-	_stack.top().setReference(&var);
+	_values.pushVariable(reference);
 }
 
 /** GETREFARRAY: push the reference to an array element onto the stack.
@@ -1597,23 +1613,24 @@ void NCSFile::o_getrefarray(InstructionType type) {
 	if (type != kInstTypeDirect)
 		throw Common::Exception("NCSFile::o_getrefarray(): Illegal type %d", type);
 
-	int32 offset = _script->readSint32BE();
-	int16 size   = _script->readSint16BE();
+	int32 offset = _instruction->args[0];
+	int16 size   = _instruction->args[1];
 
 	if (size != 4)
 		throw Common::Exception("NCSFile::o_getrefarray(): Invalid size %d", size);
 
-	Variable::Array &array = _stack.getRelSP(offset).getArray();
+	Variable::Array &array = _values.box(_values.getRelSP(offset)).getArray();
 
-	Variable indexVar  = _stack.pop();
-	const int32 index = indexVar.getInt();
+	const int32 index = _values.popInt();
 
 	if ((index < 0) || ((uint)index >= array.size()))
 		throw Common::Exception("NCSFile::o_getrefarray(): Index out of range (%d, %u)",
 		                        index, (uint) array.size());
 
-	_stack.push(Variable(kTypeReference));
-	_stack.top().setReference(&*array[index]);
+	Variable reference(kTypeReference);
+	reference.setReference(&*array[index]);
+
+	_values.pushVariable(reference);
 }
 
 } // End of namespace NWScript
@@ -28,13 +28,16 @@
 #include <vector>
 #include <stack>
 
+#include <boost/shared_ptr.hpp>
+
 #include "src/common/types.h"
-#include "src/common/scopedptr.h"
 
 #include "src/aurora/types.h"
 #include "src/aurora/aurorafile.h"
 
 #include "src/aurora/nwscript/types.h"
+#include "src/aurora/nwscript/ncsprogram.h"
+#include "src/aurora/nwscript/ncsvalue.h"
 #include "src/aurora/nwscript/variable.h"
 #include "src/aurora/nwscript/variablecontainer.h"
 
@@ -47,43 +50,18 @@ namespace Aurora {
 
 namespace NWScript {
 
-class NCSStack : public std::vector<Variable> {
-public:
-	NCSStack();
-	~NCSStack();
-
-	void reset();
-
-	bool empty() const;
-
-	Variable &top();
-	Variable pop();
-	void push(const Variable &obj);
-
-	Variable &getRelSP(int32 pos);
-	void setRelSP(int32 pos, const Variable &obj);
-
-	Variable &getRelBP(int32 pos);
-	void setRelBP(int32 pos, const Variable &obj);
-
-	int32 getStackPtr();
-	void  setStackPtr(int32 pos);
-
-	int32 getBasePtr();
-	void  setBasePtr(int32 pos);
-
-	void print() const;
-
-private:
-	int32 _stackPtr;
-	int32 _basePtr;
-};
-
 #define DECLARE_OPCODE(x) void x(InstructionType type)
 
 /** An NCS, BioWare's NWN Compile Script. */
 class NCSFile : public AuroraFile {
 public:
+	/** The interpreter executing the script. */
+	enum Interpreter {
+		kInterpreterAuto, ///< Fast, unless script debugging is enabled.
+		kInterpreterFast, ///< A tight loop over the opcode handlers, without any debug output.
+		kInterpreterStep  ///< One opcode handler call per instruction, with debug output.
+	};
+
 	NCSFile(Common::SeekableReadStream *ncs);
 	NCSFile(const Common::UString &ncs);
 	~NCSFile();
@@ -107,61 +85,23 @@ public:
 	/** Run the current script, from this state to finish. */
 	const Variable &run(const ScriptState &state, Object *owner = 0, Object *triggerer = 0);
 
+	/** Select the interpreter to use for the following runs. */
+	void setInterpreter(Interpreter interpreter);
+
 	static ScriptState getEmptyState();
 
 private:
-	enum InstructionType {
-		// Unary
-		kInstTypeNone        =  0,
-		kInstTypeDirect      =  1,
-		kInstTypeInt         =  3,
-		kInstTypeFloat       =  4,
-		kInstTypeString      =  5,
-		kInstTypeObject      =  6,
-		kInstTypeResource    = 96,
-		kInstTypeEngineType0 = 16, // NWN:     effect        DA: event
-		kInstTypeEngineType1 = 17, // NWN:     event         DA: location
-		kInstTypeEngineType2 = 18, // NWN:     location      DA: command
-		kInstTypeEngineType3 = 19, // NWN:     talent        DA: effect
-		kInstTypeEngineType4 = 20, // NWN:     itemproperty  DA: itemproperty
-		kInstTypeEngineType5 = 21, // Witcher: mod           DA: player
-
-		// Arrays
-		kInstTypeIntArray          = 64,
-		kInstTypeFloatArray        = 65,
-		kInstTypeStringArray       = 66,
-		kInstTypeObjectArray       = 67,
-		kInstTypeResourceArray     = 68,
-		kInstTypeEngineType0Array  = 80,
-		kInstTypeEngineType1Array  = 81,
-		kInstTypeEngineType2Array  = 82,
-		kInstTypeEngineType3Array  = 83,
-		kInstTypeEngineType4Array  = 84,
-		kInstTypeEngineType5Array  = 85,
-
-		// Binary
-		kInstTypeIntInt                 = 32,
-		kInstTypeFloatFloat             = 33,
-		kInstTypeObjectObject           = 34,
-		kInstTypeStringString           = 35,
-		kInstTypeStructStruct           = 36,
-		kInstTypeIntFloat               = 37,
-		kInstTypeFloatInt               = 38,
-		kInstTypeEngineType0EngineType0 = 48,
-		kInstTypeEngineType1EngineType1 = 49,
-		kInstTypeEngineType2EngineType2 = 50,
-		kInstTypeEngineType3EngineType3 = 51,
-		kInstTypeEngineType4EngineType4 = 52,
-		kInstTypeEngineType5EngineType5 = 53,
-		kInstTypeVectorVector           = 58,
-		kInstTypeVectorFloat            = 59,
-		kInstTypeFloatVector            = 60
-	};
-
 	Common::UString _name;
 
-	NCSStack _stack;
-	Common::ScopedPtr<Common::SeekableReadStream> _script;
+	Interpreter _interpreter;
+
+	NCSValueStack _values; ///< The stack.
+
+	/** The decoded bytecode, shared between all instances of the script. */
+	boost::shared_ptr<const NCSProgram> _program;
+
+	size_t _pc; ///< Index of the next instruction to execute.
+	const NCSInstruction *_instruction; ///< The instruction currently executing.
 
 	Variable _return;
 
@@ -170,10 +110,14 @@ private:
 
 	VariableContainer _env;
 
-	std::stack<uint32> _returnOffsets;
+	std::stack<size_t> _returnOffsets; ///< Indices of the instructions to return to.
 
 	Variable _storedState;
 
+	bool   _profiling;           ///< Is the current run reported to the profiler?
+	uint64 _instructionCount;    ///< Instructions executed since the last report to the profiler.
+	size_t _reportedAllocations; ///< Allocations already reported to the profiler.
+
 	typedef void (NCSFile::*OpcodeProc)(InstructionType type);
 	struct Opcode {
 		OpcodeProc proc;
@@ -188,15 +132,26 @@ private:
 	/** Reset the script for another execution. */
 	void reset();
 
-	const Variable &execute(Object *owner = 0, Object *triggerer = 0);
+	/** Should this run use the fast interpreter? */
+	bool useFastInterpreter() const;
+
+	const Variable &execute(bool fast, Object *owner = 0, Object *triggerer = 0);
 
 	/** Execute one script step. */
 	bool executeStep();
 
-	void decompile(); // TODO
+	/** Execute the whole script with the fast interpreter. */
+	void executeFast();
+
+	void jump(uint32 target);
+
+	/** Report the instructions and allocations since the last report to the profiler. */
+	void reportCounts();
 
 	void callEngine(Aurora::NWScript::FunctionContext &ctx, uint32 function, uint8 argCount);
 
+	bool popEqual(InstructionType type, const char *op);
+
 	// Opcode declarations
 	DECLARE_OPCODE(o_nop);
 	DECLARE_OPCODE(o_cpdownsp);
@@ -0,0 +1,359 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Pre-decoded bytecode of BioWare's NWN Compiled Scripts.
+ */
+
+#include <cstring>
+
+#include <algorithm>
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/readstream.h"
+#include "src/common/encoding.h"
+#include "src/common/debug.h"
+
+#include "src/aurora/nwscript/ncsprogram.h"
+
+static const uint32 kNCSTag    = MKTAG('N', 'C', 'S', ' ');
+static const uint32 kVersion10 = MKTAG('V', '1', '.', '0');
+
+namespace Aurora {
+
+namespace NWScript {
+
+static bool compareAddress(const NCSInstruction &instruction, uint32 address) {
+	return instruction.address < address;
+}
+
+NCSProgram::NCSProgram(Common::SeekableReadStream &ncs, const Common::UString &name) :
+	_name(name), _size(0) {
+
+	load(ncs);
+}
+
+NCSProgram::~NCSProgram() {
+}
+
+const Common::UString &NCSProgram::getName() const {
+	return _name;
+}
+
+size_t NCSProgram::getInstructionCount() const {
+	return _instructions.size();
+}
+
+const NCSInstruction &NCSProgram::getInstruction(size_t index) const {
+	assert(index < _instructions.size());
+
+	return _instructions[index];
+}
+
+const Common::UString &NCSProgram::getString(size_t index) const {
+	assert(index < _strings.size());
+
+	return _strings[index];
+}
+
+const Common::UString &NCSProgram::getError() const {
+	static const Common::UString kNoError;
+
+	return _errors.empty() ? kNoError : _errors.front();
+}
+
+const Common::UString &NCSProgram::getError(const NCSInstruction &instruction) const {
+	assert((instruction.opcode == kOpcodeError) && ((size_t) instruction.args[0] < _errors.size()));
+
+	return _errors[instruction.args[0]];
+}
+
+void NCSProgram::load(Common::SeekableReadStream &ncs) {
+	readHeader(ncs);
+
+	if (_id != kNCSTag)
+		throw Common::Exception("Try to load non-NCS file");
+
+	if (_version != kVersion10)
+		throw Common::Exception("Unsupported NCS file version %08X", _version);
+
+	byte lengthOpcode = ncs.readByte();
+	if (lengthOpcode != 0x42)
+		throw Common::Exception("Script size opcode != 0x42 (0x%02X)", lengthOpcode);
+
+	const uint32 length = ncs.readUint32BE();
+	if (length > ncs.size())
+		throw Common::Exception("Script size %u > stream size %u", length, (uint)ncs.size());
+
+	// Whatever follows the script is not part of it, and is never executed
+	if (length < ncs.size())
+		debugC(Common::kDebugEngineScripts, 1, "Ignoring %u bytes after the end of script \"%s\"",
+		       (uint)(ncs.size() - length), _name.c_str());
+
+	_size = length;
+
+	/* Decode everything that can be reached, linearly from the start and from
+	 * every jump target. This way, bytecode we can't decode only hides what
+	 * follows it up to the next place something jumps to. */
+	InstructionMap instructions;
+
+	std::vector<uint32> starts(1, ncs.pos());
+	while (!starts.empty()) {
+		const uint32 start = starts.back();
+		starts.pop_back();
+
+		decodeFrom(ncs, start, instructions, starts);
+	}
+
+	_instructions.reserve(instructions.size());
+	for (InstructionMap::const_iterator i = instructions.begin(); i != instructions.end(); ++i)
+		_instructions.push_back(i->second.instruction);
+
+	resolveTargets();
+}
+
+static bool isJump(const NCSInstruction &instruction) {
+	return (instruction.opcode == kOpcodeJMP) || (instruction.opcode == kOpcodeJSR) ||
+	       (instruction.opcode == kOpcodeJZ)  || (instruction.opcode == kOpcodeJNZ);
+}
+
+bool NCSProgram::isDecoded(const InstructionMap &instructions, uint32 address, uint32 end) {
+	InstructionMap::const_iterator next = instructions.lower_bound(address);
+	if ((next != instructions.end()) && (next->first < end))
+		return true;
+
+	if (next == instructions.begin())
+		return false;
+
+	--next;
+	return next->second.end > address;
+}
+
+void NCSProgram::decodeFrom(Common::SeekableReadStream &ncs, uint32 address,
+                            InstructionMap &instructions, std::vector<uint32> &starts) {
+
+	// Execution ends when no full opcode and type can be read anymore
+	while (((_size - address) >= 2) && !isDecoded(instructions, address, address + 1)) {
+		DecodedInstruction decoded;
+		std::memset(&decoded.instruction, 0, sizeof(decoded.instruction));
+
+		decoded.instruction.address = address;
+		decoded.instruction.target  = kInvalidTarget;
+
+		ncs.seek(address);
+
+		bool valid = decode(ncs, decoded.instruction);
+		decoded.end = ncs.pos();
+
+		if (valid && (decoded.end > _size)) {
+			_errors.push_back(Common::UString::format("Truncated instruction 0x%02x at offset %u",
+			                                          decoded.instruction.opcode, address));
+			valid = false;
+		}
+
+		/* An instruction overlapping one we already know means that we've been
+		 * led into the middle of an instruction. Neither sequence can be trusted
+		 * to continue into the other, so this is where we stop. */
+		if (valid && isDecoded(instructions, address + 1, decoded.end)) {
+			_errors.push_back(Common::UString::format("Overlapping instruction 0x%02x at offset %u",
+			                                          decoded.instruction.opcode, address));
+			valid = false;
+		}
+
+		if (!valid) {
+			decoded.instruction.opcode  = kOpcodeError;
+			decoded.instruction.args[0] = _errors.size() - 1;
+			decoded.end                 = address + 1;
+		}
+
+		instructions.insert(std::make_pair(address, decoded));
+
+		if (!valid)
+			break;
+
+		if (isJump(decoded.instruction)) {
+			const int64 target = ((int64) address) + decoded.instruction.args[0];
+			if ((target >= 0) && (target < _size))
+				starts.push_back((uint32) target);
+		}
+
+		address = decoded.end;
+	}
+}
+
+bool NCSProgram::decode(Common::SeekableReadStream &ncs, NCSInstruction &instruction) {
+	instruction.opcode = ncs.readByte();
+	instruction.type   = ncs.readByte();
+
+	try {
+		switch (instruction.opcode) {
+			case kOpcodeNOP:
+			case kOpcodeRSADD:
+			case kOpcodeLOGAND:
+			case kOpcodeLOGOR:
+			case kOpcodeINCOR:
+			case kOpcodeEXCOR:
+			case kOpcodeBOOLAND:
+			case kOpcodeGEQ:
+			case kOpcodeGT:
+			case kOpcodeLT:
+			case kOpcodeLEQ:
+			case kOpcodeSHLEFT:
+			case kOpcodeSHRIGHT:
+			case kOpcodeUSHRIGHT:
+			case kOpcodeADD:
+			case kOpcodeSUB:
+			case kOpcodeMUL:
+			case kOpcodeDIV:
+			case kOpcodeMOD:
+			case kOpcodeNEG:
+			case kOpcodeCOMP:
+			case kOpcodeSTORESTATEALL:
+			case kOpcodeRETN:
+			case kOpcodeNOT:
+			case kOpcodeSAVEBP:
+			case kOpcodeRESTOREBP:
+			case kOpcodeNOP2:
+				break;
+
+			case kOpcodeCPDOWNSP:
+			case kOpcodeCPTOPSP:
+			case kOpcodeCPDOWNBP:
+			case kOpcodeCPTOPBP:
+			case kOpcodeWRITEARRAY:
+			case kOpcodeREADARRAY:
+			case kOpcodeGETREF:
+			case kOpcodeGETREFARRAY:
+				instruction.args[0] = ncs.readSint32BE();
+				instruction.args[1] = ncs.readSint16BE();
+				break;
+
+			case kOpcodeMOVSP:
+			case kOpcodeJMP:
+			case kOpcodeJSR:
+			case kOpcodeJZ:
+			case kOpcodeJNZ:
+			case kOpcodeDECSP:
+			case kOpcodeINCSP:
+			case kOpcodeDECBP:
+			case kOpcodeINCBP:
+				instruction.args[0] = ncs.readSint32BE();
+				break;
+
+			case kOpcodeACTION:
+				instruction.args[0] = ncs.readUint16BE();
+				instruction.args[1] = ncs.readByte();
+				break;
+
+			case kOpcodeEQ:
+			case kOpcodeNEQ:
+				// Comparisons between two structs (or two vectors) come with the size of the type
+				if (instruction.type == kInstTypeStructStruct)
+					instruction.args[0] = ncs.readUint16BE();
+				break;
+
+			case kOpcodeDESTRUCT:
+				instruction.args[0] = ncs.readSint16BE();
+				instruction.args[1] = ncs.readSint16BE();
+				instruction.args[2] = ncs.readSint16BE();
+				break;
+
+			case kOpcodeSTORESTATE:
+				instruction.args[0] = (int32) ncs.readUint32BE();
+				instruction.args[1] = (int32) ncs.readUint32BE();
+				break;
+
+			case kOpcodeCONST:
+				switch (instruction.type) {
+					case kInstTypeInt:
+						instruction.args[0] = ncs.readSint32BE();
+						break;
+
+					case kInstTypeFloat:
+						instruction.floatArg = ncs.readIEEEFloatBE();
+						break;
+
+					case kInstTypeString:
+					case kInstTypeResource:
+						instruction.args[0] = _strings.size();
+						_strings.push_back(Common::readStringFixed(ncs, Common::kEncodingASCII, ncs.readUint16BE()));
+						break;
+
+					case kInstTypeObject:
+						instruction.args[0] = (int32) ncs.readUint32BE();
+						break;
+
+					default:
+						_errors.push_back(Common::UString::format("NCSFile::o_const(): Illegal type %d", instruction.type));
+						return false;
+				}
+				break;
+
+			default:
+				_errors.push_back(Common::UString::format("NCSFile::executeStep(): Illegal instruction 0x%02x", instruction.opcode));
+				return false;
+		}
+
+	} catch (Common::Exception &) {
+		_errors.push_back(Common::UString::format("Truncated instruction 0x%02x at offset %u",
+		                                          instruction.opcode, instruction.address));
+		return false;
+	}
+
+	return true;
+}
+
+void NCSProgram::resolveTargets() {
+	for (std::vector<NCSInstruction>::iterator i = _instructions.begin(); i != _instructions.end(); ++i) {
+		if ((i->opcode == kOpcodeJMP) || (i->opcode == kOpcodeJSR) ||
+		    (i->opcode == kOpcodeJZ)  || (i->opcode == kOpcodeJNZ)) {
+
+			const int64 target = ((int64) i->address) + i->args[0];
+
+			i->target = (target < 0) ? kInvalidTarget : findTarget((uint32) target);
+		}
+	}
+}
+
+uint32 NCSProgram::findTarget(uint32 address) const {
+	if (address >= _size)
+		return _instructions.size();
+
+	std::vector<NCSInstruction>::const_iterator instruction =
+		std::lower_bound(_instructions.begin(), _instructions.end(), address, compareAddress);
+
+	if ((instruction == _instructions.end()) || (instruction->address != address))
+		return kInvalidTarget;
+
+	return instruction - _instructions.begin();
+}
+
+size_t NCSProgram::findInstruction(uint32 address) const {
+	const uint32 index = findTarget(address);
+	if (index == kInvalidTarget)
+		throw Common::Exception("NCSProgram::findInstruction(): No instruction at offset %u", address);
+
+	return index;
+}
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
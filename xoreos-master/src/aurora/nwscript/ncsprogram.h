@@ -0,0 +1,256 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Pre-decoded bytecode of BioWare's NWN Compiled Scripts.
+ */
+
+#ifndef AURORA_NWSCRIPT_NCSPROGRAM_H
+#define AURORA_NWSCRIPT_NCSPROGRAM_H
+
+#include <vector>
+#include <map>
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/types.h"
+#include "src/common/ustring.h"
+
+#include "src/aurora/aurorafile.h"
+
+namespace Common {
+	class SeekableReadStream;
+}
+
+namespace Aurora {
+
+namespace NWScript {
+
+/** The opcodes of NCS instructions. */
+enum Opcode {
+	kOpcodeNOP           = 0x00, ///< Doesn't exist.
+	kOpcodeCPDOWNSP      = 0x01,
+	kOpcodeRSADD         = 0x02,
+	kOpcodeCPTOPSP       = 0x03,
+	kOpcodeCONST         = 0x04,
+	kOpcodeACTION        = 0x05,
+	kOpcodeLOGAND        = 0x06,
+	kOpcodeLOGOR         = 0x07,
+	kOpcodeINCOR         = 0x08,
+	kOpcodeEXCOR         = 0x09,
+	kOpcodeBOOLAND       = 0x0A,
+	kOpcodeEQ            = 0x0B,
+	kOpcodeNEQ           = 0x0C,
+	kOpcodeGEQ           = 0x0D,
+	kOpcodeGT            = 0x0E,
+	kOpcodeLT            = 0x0F,
+	kOpcodeLEQ           = 0x10,
+	kOpcodeSHLEFT        = 0x11,
+	kOpcodeSHRIGHT       = 0x12,
+	kOpcodeUSHRIGHT      = 0x13,
+	kOpcodeADD           = 0x14,
+	kOpcodeSUB           = 0x15,
+	kOpcodeMUL           = 0x16,
+	kOpcodeDIV           = 0x17,
+	kOpcodeMOD           = 0x18,
+	kOpcodeNEG           = 0x19,
+	kOpcodeCOMP          = 0x1A,
+	kOpcodeMOVSP         = 0x1B,
+	kOpcodeSTORESTATEALL = 0x1C,
+	kOpcodeJMP           = 0x1D,
+	kOpcodeJSR           = 0x1E,
+	kOpcodeJZ            = 0x1F,
+	kOpcodeRETN          = 0x20,
+	kOpcodeDESTRUCT      = 0x21,
+	kOpcodeNOT           = 0x22,
+	kOpcodeDECSP         = 0x23,
+	kOpcodeINCSP         = 0x24,
+	kOpcodeJNZ           = 0x25,
+	kOpcodeCPDOWNBP      = 0x26,
+	kOpcodeCPTOPBP       = 0x27,
+	kOpcodeDECBP         = 0x28,
+	kOpcodeINCBP         = 0x29,
+	kOpcodeSAVEBP        = 0x2A,
+	kOpcodeRESTOREBP     = 0x2B,
+	kOpcodeSTORESTATE    = 0x2C,
+	kOpcodeNOP2          = 0x2D,
+	kOpcodeWRITEARRAY    = 0x30,
+	kOpcodeREADARRAY     = 0x32,
+	kOpcodeGETREF        = 0x37,
+	kOpcodeGETREFARRAY   = 0x39,
+
+	kOpcodeMAX           = 0x3A,
+
+	/** Not a real opcode. Marks the place where the bytecode couldn't be decoded. */
+	kOpcodeError         = 0xFF
+};
+
+/** The types of NCS instructions. */
+enum InstructionType {
+	// Unary
+	kInstTypeNone        =  0,
+	kInstTypeDirect      =  1,
+	kInstTypeInt         =  3,
+	kInstTypeFloat       =  4,
+	kInstTypeString      =  5,
+	kInstTypeObject      =  6,
+	kInstTypeResource    = 96,
+	kInstTypeEngineType0 = 16, // NWN:     effect        DA: event
+	kInstTypeEngineType1 = 17, // NWN:     event         DA: location
+	kInstTypeEngineType2 = 18, // NWN:     location      DA: command
+	kInstTypeEngineType3 = 19, // NWN:     talent        DA: effect
+	kInstTypeEngineType4 = 20, // NWN:     itemproperty  DA: itemproperty
+	kInstTypeEngineType5 = 21, // Witcher: mod           DA: player
+
+	// Arrays
+	kInstTypeIntArray          = 64,
+	kInstTypeFloatArray        = 65,
+	kInstTypeStringArray       = 66,
+	kInstTypeObjectArray       = 67,
+	kInstTypeResourceArray     = 68,
+	kInstTypeEngineType0Array  = 80,
+	kInstTypeEngineType1Array  = 81,
+	kInstTypeEngineType2Array  = 82,
+	kInstTypeEngineType3Array  = 83,
+	kInstTypeEngineType4Array  = 84,
+	kInstTypeEngineType5Array  = 85,
+
+	// Binary
+	kInstTypeIntInt                 = 32,
+	kInstTypeFloatFloat             = 33,
+	kInstTypeObjectObject           = 34,
+	kInstTypeStringString           = 35,
+	kInstTypeStructStruct           = 36,
+	kInstTypeIntFloat               = 37,
+	kInstTypeFloatInt               = 38,
+	kInstTypeEngineType0EngineType0 = 48,
+	kInstTypeEngineType1EngineType1 = 49,
+	kInstTypeEngineType2EngineType2 = 50,
+	kInstTypeEngineType3EngineType3 = 51,
+	kInstTypeEngineType4EngineType4 = 52,
+	kInstTypeEngineType5EngineType5 = 53,
+	kInstTypeVectorVector           = 58,
+	kInstTypeVectorFloat            = 59,
+	kInstTypeFloatVector            = 60
+};
+
+/** A single, decoded NCS instruction.
+ *
+ *  The direct arguments of the instruction are found in args, in the order
+ *  they appear in the bytecode, sign-extended to 32 bits. Exceptions:
+ *  - CONST with a float stores its value in floatArg
+ *  - CONST with a string stores the index into the program's strings in args[0]
+ *  - JMP, JSR, JZ and JNZ also store the index of the target instruction in target
+ */
+struct NCSInstruction {
+	uint32 address; ///< Byte offset of the instruction within the NCS.
+	uint8  opcode;  ///< The instruction's opcode.
+	uint8  type;    ///< The instruction's type.
+
+	union {
+		int32 args[3];  ///< The direct arguments.
+		float floatArg; ///< The value of a float CONST.
+	};
+
+	uint32 target; ///< Index of the instruction a jump leads to.
+};
+
+/** The decoded, immutable bytecode of an NCS.
+ *
+ *  The whole NCS is decoded in one go, into a flat array of instructions
+ *  whose direct arguments and jump targets are already resolved. This means
+ *  that executing the script doesn't need to touch the original stream, and
+ *  that the same program can be shared by all running instances of the script.
+ */
+class NCSProgram : public AuroraFile, boost::noncopyable {
+public:
+	/** A jump target that doesn't match up with the start of an instruction. */
+	static const uint32 kInvalidTarget = 0xFFFFFFFF;
+
+	NCSProgram(Common::SeekableReadStream &ncs, const Common::UString &name = "");
+	~NCSProgram();
+
+	const Common::UString &getName() const;
+
+	/** Return the number of decoded instructions. */
+	size_t getInstructionCount() const;
+	/** Return a decoded instruction. */
+	const NCSInstruction &getInstruction(size_t index) const;
+
+	/** Return a string constant. */
+	const Common::UString &getString(size_t index) const;
+
+	/** Return the first reason the bytecode couldn't be fully decoded, if any.
+	 *
+	 *  Wherever decoding hit a problem, like an illegal opcode, the program
+	 *  contains an instruction carrying kOpcodeError, so that the script will
+	 *  only fail if it actually reaches it. Decoding picks up again at the
+	 *  next jump target behind it.
+	 */
+	const Common::UString &getError() const;
+	/** Return the reason behind this kOpcodeError instruction. */
+	const Common::UString &getError(const NCSInstruction &instruction) const;
+
+	/** Return the index of the instruction at this byte offset.
+	 *
+	 *  An offset at or behind the end of the script returns the instruction
+	 *  count. Offsets within or between instructions throw an exception.
+	 */
+	size_t findInstruction(uint32 address) const;
+
+private:
+	/** An instruction, together with the offset directly behind it. */
+	struct DecodedInstruction {
+		NCSInstruction instruction;
+		uint32 end;
+	};
+
+	typedef std::map<uint32, DecodedInstruction> InstructionMap;
+
+
+	Common::UString _name;
+
+	std::vector<Common::UString> _errors;
+
+	uint32 _size; ///< Size of the NCS in bytes.
+
+	std::vector<NCSInstruction>  _instructions;
+	std::vector<Common::UString> _strings;
+
+	void load(Common::SeekableReadStream &ncs);
+
+	/** Decode one instruction, returning false if that failed. */
+	bool decode(Common::SeekableReadStream &ncs, NCSInstruction &instruction);
+	/** Decode linearly from this address on, collecting the jump targets found. */
+	void decodeFrom(Common::SeekableReadStream &ncs, uint32 address,
+	                InstructionMap &instructions, std::vector<uint32> &starts);
+
+	/** Does any known instruction cover a byte in [address, end)? */
+	static bool isDecoded(const InstructionMap &instructions, uint32 address, uint32 end);
+
+	void resolveTargets();
+	uint32 findTarget(uint32 address) const;
+};
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
+
+#endif // AURORA_NWSCRIPT_NCSPROGRAM_H
@@ -0,0 +1,581 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  The value stack of the NWScript interpreter.
+ */
+
+#include <cstring>
+
+#include "src/common/util.h"
+#include "src/common/ustring.h"
+#include "src/common/debug.h"
+
+#include "src/aurora/nwscript/ncsvalue.h"
+#include "src/aurora/nwscript/ncsprogram.h"
+#include "src/aurora/nwscript/util.h"
+
+using Common::kDebugScripts;
+
+/** Don't bother compacting string arenas smaller than this many bytes. */
+static const size_t kMinStringArena = 64 * 1024;
+/** Don't bother reclaiming boxes while fewer than this many are in use. */
+static const size_t kMinBoxes       = 1024;
+
+namespace Aurora {
+
+namespace NWScript {
+
+NCSValueStack::NCSValueStack() : _stackPtr(-1), _basePtr(-1), _pinnedEnd(0),
+	_stringLimit(kMinStringArena), _boxLimit(kMinBoxes), _program(0), _allocations(0) {
+}
+
+NCSValueStack::~NCSValueStack() {
+}
+
+void NCSValueStack::reset(const NCSProgram *program) {
+	_values.clear();
+	_strings.clear();
+	_boxes.clear();
+	_freeBoxes.clear();
+	_pinned.clear();
+
+	_stackPtr = -1;
+	_basePtr  = -1;
+
+	_pinnedEnd = 0;
+
+	_stringLimit = kMinStringArena;
+	_boxLimit    = kMinBoxes;
+
+	_program = program;
+
+	_allocations = 0;
+}
+
+bool NCSValueStack::empty() const {
+	return _stackPtr < 0;
+}
+
+size_t NCSValueStack::getAllocationCount() const {
+	return _allocations;
+}
+
+size_t NCSValueStack::getStringArenaSize() const {
+	return _strings.size();
+}
+
+void NCSValueStack::compact() {
+	std::vector<bool> usedBoxes(_boxes.size(), false);
+	size_t stringSize = 0;
+
+	for (size_t i = 0; i < _values.size(); i++) {
+		NCSValue &value = _values[i];
+
+		// Elements above the stack pointer are dead, unless they are pinned
+		if (((int32) i > _stackPtr) && ((i >= _pinned.size()) || !_pinned[i])) {
+			value.kind     = NCSValue::kKindVoid;
+			value.intValue = 0;
+			continue;
+		}
+
+		if      (value.kind == NCSValue::kKindBoxed)
+			usedBoxes[value.index] = true;
+		else if (value.kind == NCSValue::kKindArenaString)
+			stringSize += value.arena.length;
+	}
+
+	// Move all strings still in use into a new arena
+	std::vector<char> strings;
+	strings.reserve(stringSize);
+
+	for (int32 i = 0; i <= _stackPtr; i++) {
+		NCSValue &value = _values[i];
+		if (value.kind != NCSValue::kKindArenaString)
+			continue;
+
+		const char *data = &_strings[value.arena.offset];
+
+		value.arena.offset = strings.size();
+		strings.insert(strings.end(), data, data + value.arena.length);
+	}
+
+	_strings.swap(strings);
+
+	// Drop the unused boxes at the end, and put the other unused boxes up for reuse
+	while (!_boxes.empty() && !usedBoxes[_boxes.size() - 1])
+		_boxes.pop_back();
+
+	_freeBoxes.clear();
+	for (size_t i = 0; i < _boxes.size(); i++) {
+		if (usedBoxes[i])
+			continue;
+
+		_boxes[i].setType(kTypeVoid);
+		_freeBoxes.push_back(i);
+	}
+
+	_stringLimit = MAX<size_t>(kMinStringArena, 2 * _strings.size());
+	_boxLimit    = MAX<size_t>(kMinBoxes, 2 * getBoxCount());
+}
+
+void NCSValueStack::print() const {
+	if (!DebugMan.isEnabled(kDebugScripts, 3))
+		return;
+
+	debugC(kDebugScripts, 3, ".--- %d ---.", _stackPtr);
+	for (int32 i = _stackPtr; i >= 0; i--) {
+		const Variable var = toVariable(_values[i]);
+
+		Common::UString str;
+		formatVariable(str, var);
+
+		debugC(kDebugScripts, 3, "| %04d: %02d - %s", i, var.getType(), str.c_str());
+	}
+	debugC(kDebugScripts, 3, "'--- ---'");
+}
+
+NCSValue &NCSValueStack::top() {
+	if (_stackPtr == -1)
+		throw Common::Exception("NCSValueStack: Stack underflow");
+
+	return _values[_stackPtr];
+}
+
+void NCSValueStack::pushVoid() {
+	NCSValue v;
+	v.kind     = NCSValue::kKindVoid;
+	v.intValue = 0;
+
+	push(v);
+}
+
+void NCSValueStack::pushObject(Object *value) {
+	NCSValue v;
+	v.kind   = NCSValue::kKindObject;
+	v.object = value;
+
+	push(v);
+}
+
+void NCSValueStack::pushString(const char *data, size_t length) {
+	push(makeString(data, length));
+}
+
+void NCSValueStack::pushConstString(uint32 index) {
+	NCSValue v;
+	v.kind  = NCSValue::kKindConstString;
+	v.index = index;
+
+	push(v);
+}
+
+void NCSValueStack::pushVariable(const Variable &value) {
+	push(fromVariable(value));
+}
+
+void NCSValueStack::pushPinned(const NCSValue &value) {
+	const size_t index = _stackPtr + 1;
+
+	if (!_pinned[index]) {
+		_values[index] = value;
+		_stackPtr++;
+		return;
+	}
+
+	// A pinned element keeps its box, so that references to it stay valid
+	_boxes[_pinned[index] - 1] = toVariable(value);
+	_stackPtr++;
+}
+
+size_t NCSValueStack::getIndex(int32 ptr, int32 pos, const char *op) const {
+	if ((pos > -4) || ((pos % 4) != 0))
+		throw Common::Exception("NCSValueStack::%s(): Illegal position %d", op, pos);
+
+	int32 stackPos = ptr - ((pos / -4) - 1);
+	if (stackPos < 0)
+		throw Common::Exception("NCSValueStack::%s(): Position %d below the bottom", op, pos);
+
+	return stackPos;
+}
+
+NCSValue &NCSValueStack::getRelSP(int32 pos) {
+	return _values.at(getIndex(_stackPtr, pos, "get"));
+}
+
+NCSValue &NCSValueStack::getRelBP(int32 pos) {
+	return _values.at(getIndex(_basePtr, pos, "get"));
+}
+
+void NCSValueStack::setRelSP(int32 pos, const NCSValue &value) {
+	assign(_values.at(getIndex(_stackPtr, pos, "set")), value);
+}
+
+void NCSValueStack::setRelBP(int32 pos, const NCSValue &value) {
+	assign(_values.at(getIndex(_basePtr, pos, "set")), value);
+}
+
+void NCSValueStack::assign(NCSValue &element, const NCSValue &value) {
+	// Assign into the box in place, to keep references to a pinned element valid
+	if (element.kind == NCSValue::kKindBoxed)
+		_boxes[element.index] = toVariable(value);
+	else
+		element = copy(value);
+}
+
+Variable &NCSValueStack::pinRelSP(int32 pos) {
+	const size_t index = getIndex(_stackPtr, pos, "get");
+
+	NCSValue &element = _values.at(index);
+	Variable &variable = box(element);
+
+	if (_pinned.size() <= index)
+		_pinned.resize(index + 1, 0);
+
+	_pinned[index] = element.index + 1;
+	_pinnedEnd     = MAX<int32>(_pinnedEnd, index + 1);
+
+	return variable;
+}
+
+int32 NCSValueStack::getStackPtr() const {
+	return (_stackPtr + 1) * -4;
+}
+
+void NCSValueStack::setStackPtr(int32 pos) {
+	if ((pos > 0) || ((pos % 4) != 0))
+		throw Common::Exception("NCSValueStack::setStackPtr(): Illegal position %d", pos);
+
+	_stackPtr = (pos / -4) - 1;
+
+	if ((int32)_values.size() < (_stackPtr + 1)) {
+		NCSValue v;
+		v.kind     = NCSValue::kKindVoid;
+		v.intValue = 0;
+
+		_values.resize(_stackPtr + 1, v);
+	}
+}
+
+int32 NCSValueStack::getBasePtr() const {
+	return (_basePtr + 1) * -4;
+}
+
+void NCSValueStack::setBasePtr(int32 pos) {
+	if ((pos > 0) || ((pos % 4) != 0))
+		throw Common::Exception("NCSValueStack::setBasePtr(): Illegal position %d", pos);
+
+	_basePtr = (pos / -4) - 1;
+}
+
+Type NCSValueStack::getType(const NCSValue &value) const {
+	switch (value.kind) {
+		case NCSValue::kKindInt:
+			return kTypeInt;
+
+		case NCSValue::kKindFloat:
+			return kTypeFloat;
+
+		case NCSValue::kKindObject:
+			return kTypeObject;
+
+		case NCSValue::kKindSmallString:
+		case NCSValue::kKindArenaString:
+		case NCSValue::kKindConstString:
+			return kTypeString;
+
+		case NCSValue::kKindBoxed:
+			return _boxes[value.index].getType();
+
+		default:
+			break;
+	}
+
+	return kTypeVoid;
+}
+
+int32 NCSValueStack::getIntSlow(const NCSValue &value) const {
+	if (value.kind == NCSValue::kKindBoxed)
+		return _boxes[value.index].getInt();
+
+	throw Common::Exception("Can't get an int value from a non-int variable");
+}
+
+float NCSValueStack::getFloatSlow(const NCSValue &value) const {
+	if (value.kind == NCSValue::kKindBoxed)
+		return _boxes[value.index].getFloat();
+
+	throw Common::Exception("Can't get a float value from a non-float variable");
+}
+
+Object *NCSValueStack::getObject(const NCSValue &value) const {
+	if (value.kind == NCSValue::kKindObject)
+		return value.object;
+
+	if (value.kind == NCSValue::kKindBoxed)
+		return _boxes[value.index].getObject();
+
+	throw Common::Exception("Can't get an object value from a non-object variable");
+}
+
+void NCSValueStack::getString(const NCSValue &value, const char *&data, size_t &length) const {
+	switch (value.kind) {
+		case NCSValue::kKindSmallString:
+			data   = value.string;
+			length = value.length;
+			break;
+
+		case NCSValue::kKindArenaString:
+			data   = &_strings[value.arena.offset];
+			length = value.arena.length;
+			break;
+
+		case NCSValue::kKindConstString:
+			assert(_program);
+
+			data   = _program->getString(value.index).c_str();
+			length = std::strlen(data);
+			break;
+
+		case NCSValue::kKindBoxed:
+			data   = _boxes[value.index].getString().c_str();
+			length = std::strlen(data);
+			break;
+
+		default:
+			throw Common::Exception("Can't get a string value from a non-string variable");
+	}
+}
+
+bool NCSValueStack::equals(const NCSValue &value1, const NCSValue &value2) const {
+	if ((value1.kind == NCSValue::kKindBoxed) && (value2.kind == NCSValue::kKindBoxed))
+		return _boxes[value1.index] == _boxes[value2.index];
+
+	const Type type = getType(value1);
+	if (type != getType(value2))
+		return false;
+
+	switch (type) {
+		case kTypeVoid:
+			return true;
+
+		case kTypeInt:
+			return getInt(value1) == getInt(value2);
+
+		case kTypeFloat:
+			return getFloat(value1) == getFloat(value2);
+
+		case kTypeObject:
+			return getObject(value1) == getObject(value2);
+
+		case kTypeString: {
+				const char *data1, *data2;
+				size_t length1, length2;
+
+				getString(value1, data1, length1);
+				getString(value2, data2, length2);
+
+				return (length1 == length2) && !std::memcmp(data1, data2, length1);
+			}
+
+		default:
+			break;
+	}
+
+	// Engine types, arrays and references only ever compare equal among boxed values
+	return false;
+}
+
+NCSValue NCSValueStack::copy(const NCSValue &value) {
+	if (value.kind != NCSValue::kKindBoxed)
+		return value;
+
+	return fromVariable(Variable(_boxes[value.index]));
+}
+
+NCSValue NCSValueStack::makeBox(const Variable &variable) {
+	NCSValue v;
+	v.kind = NCSValue::kKindBoxed;
+
+	if (!_freeBoxes.empty()) {
+		v.index = _freeBoxes.back();
+		_freeBoxes.pop_back();
+
+		_boxes[v.index] = variable;
+	} else {
+		v.index = _boxes.size();
+		_boxes.push_back(variable);
+	}
+
+	_allocations++;
+
+	return v;
+}
+
+NCSValue NCSValueStack::makeString(const char *data, size_t length) {
+	NCSValue v;
+
+	if (length <= NCSValue::kSmallStringLength) {
+		v.kind   = NCSValue::kKindSmallString;
+		v.length = length;
+
+		std::memcpy(v.string, data, length);
+		return v;
+	}
+
+	const size_t offset = _strings.size();
+
+	if (!_strings.empty() && (data >= &_strings[0]) && (data < (&_strings[0] + _strings.size()))) {
+		// The string is already in the arena, and growing the arena would invalidate it
+
+		const size_t source = data - &_strings[0];
+
+		_strings.resize(offset + length);
+		std::memmove(&_strings[offset], &_strings[source], length);
+
+	} else
+		_strings.insert(_strings.end(), data, data + length);
+
+	_allocations++;
+
+	v.kind         = NCSValue::kKindArenaString;
+	v.arena.offset = offset;
+	v.arena.length = length;
+
+	return v;
+}
+
+NCSValue NCSValueStack::concat(const NCSValue &value1, const NCSValue &value2) {
+	const char *data1, *data2;
+	size_t length1, length2;
+
+	getString(value1, data1, length1);
+	getString(value2, data2, length2);
+
+	if ((length1 + length2) <= NCSValue::kSmallStringLength) {
+		char buffer[NCSValue::kSmallStringLength];
+
+		std::memcpy(buffer, data1, length1);
+		std::memcpy(buffer + length1, data2, length2);
+
+		return makeString(buffer, length1 + length2);
+	}
+
+	const size_t offset = _strings.size();
+	_strings.resize(offset + length1 + length2);
+
+	// Growing the arena might have moved the strings
+	getString(value1, data1, length1);
+	getString(value2, data2, length2);
+
+	std::memcpy(&_strings[offset], data1, length1);
+	std::memcpy(&_strings[offset + length1], data2, length2);
+
+	_allocations++;
+
+	NCSValue v;
+	v.kind         = NCSValue::kKindArenaString;
+	v.arena.offset = offset;
+	v.arena.length = length1 + length2;
+
+	return v;
+}
+
+Variable &NCSValueStack::box(NCSValue &value) {
+	if (value.kind != NCSValue::kKindBoxed)
+		value = makeBox(toVariable(value));
+
+	return _boxes[value.index];
+}
+
+Variable NCSValueStack::toVariable(const NCSValue &value) const {
+	switch (value.kind) {
+		case NCSValue::kKindInt:
+			return Variable(value.intValue);
+
+		case NCSValue::kKindFloat:
+			return Variable(value.floatValue);
+
+		case NCSValue::kKindObject:
+			return Variable(value.object);
+
+		case NCSValue::kKindSmallString:
+		case NCSValue::kKindArenaString:
+		case NCSValue::kKindConstString: {
+				const char *data;
+				size_t length;
+
+				getString(value, data, length);
+
+				return Variable(Common::UString(data, length));
+			}
+
+		case NCSValue::kKindBoxed:
+			return _boxes[value.index];
+
+		default:
+			break;
+	}
+
+	return Variable(kTypeVoid);
+}
+
+NCSValue NCSValueStack::fromVariable(const Variable &variable) {
+	NCSValue v;
+
+	switch (variable.getType()) {
+		case kTypeVoid:
+			v.kind     = NCSValue::kKindVoid;
+			v.intValue = 0;
+			break;
+
+		case kTypeInt:
+			v.kind     = NCSValue::kKindInt;
+			v.intValue = variable.getInt();
+			break;
+
+		case kTypeFloat:
+			v.kind       = NCSValue::kKindFloat;
+			v.floatValue = variable.getFloat();
+			break;
+
+		case kTypeObject:
+			v.kind   = NCSValue::kKindObject;
+			v.object = variable.getObject();
+			break;
+
+		case kTypeString: {
+				const Common::UString &str = variable.getString();
+
+				v = makeString(str.c_str(), std::strlen(str.c_str()));
+				break;
+			}
+
+		default:
+			v = makeBox(variable);
+			break;
+	}
+
+	return v;
+}
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
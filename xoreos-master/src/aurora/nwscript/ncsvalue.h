@@ -0,0 +1,315 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  The value stack of the NWScript interpreter.
+ */
+
+#ifndef AURORA_NWSCRIPT_NCSVALUE_H
+#define AURORA_NWSCRIPT_NCSVALUE_H
+
+#include <vector>
+#include <deque>
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/types.h"
+#include "src/common/error.h"
+
+#include "src/aurora/nwscript/types.h"
+#include "src/aurora/nwscript/variable.h"
+
+namespace Aurora {
+
+namespace NWScript {
+
+class Object;
+class NCSProgram;
+
+/** A value on the stack of the NWScript interpreter.
+ *
+ *  Unlike a Variable, this is a small, trivially copyable tagged union.
+ *  Ints, floats, objects and short strings are held directly. Longer strings
+ *  live in the stack's string arena, or, for string constants, in the program.
+ *  Everything else (engine types, arrays, references) is boxed into a Variable
+ *  owned by the stack.
+ */
+struct NCSValue {
+	enum Kind {
+		kKindVoid,        ///< An empty value.
+		kKindInt,         ///< An int, in intValue.
+		kKindFloat,       ///< A float, in floatValue.
+		kKindObject,      ///< An object, in object.
+		kKindSmallString, ///< A string of up to kSmallStringLength bytes, in string.
+		kKindArenaString, ///< A string in the stack's string arena.
+		kKindConstString, ///< A string constant of the program.
+		kKindBoxed        ///< A Variable owned by the stack.
+	};
+
+	static const size_t kSmallStringLength = 8;
+
+	union {
+		int32   intValue;
+		float   floatValue;
+		Object *object;
+		char    string[kSmallStringLength];
+
+		struct {
+			uint32 offset;
+			uint32 length;
+		} arena;
+
+		uint32 index; ///< Index of a string constant or a boxed Variable.
+	};
+
+	uint8 kind;   ///< The Kind of value.
+	uint8 length; ///< The length of a small string.
+};
+
+/** The value stack of the NWScript interpreter.
+ *
+ *  Stack positions and pointers are given in bytes, relative to the stack
+ *  or base pointer, with each stack element taking up 4 bytes.
+ *
+ *  Values popped off the stack remain valid until the next collect(). Boxes
+ *  and strings no longer held by any stack element are reclaimed there.
+ *
+ *  A stack element can be pinned into a box, to create a reference to it.
+ *  A reference always refers to the stack position, not to the value: when
+ *  the element is popped and the position gets pushed again, the reference
+ *  sees the new value.
+ */
+class NCSValueStack : boost::noncopyable {
+public:
+	NCSValueStack();
+	~NCSValueStack();
+
+	/** Clear the stack, and all strings and boxes. */
+	void reset(const NCSProgram *program);
+
+	bool empty() const;
+
+	/** Return the number of strings and boxes allocated since the last reset. */
+	size_t getAllocationCount() const;
+
+	/** Return the size of the string arena, in bytes. */
+	size_t getStringArenaSize() const;
+	/** Return the number of boxes currently in use. */
+	size_t getBoxCount() const;
+
+	/** Reclaim strings and boxes not held by any stack element, if enough of them piled up.
+	 *
+	 *  This invalidates all values popped off the stack. It must only be
+	 *  called between two instructions.
+	 */
+	void collect();
+
+	/** Print the stack contents to the script debug channel. */
+	void print() const;
+
+	// .--- Pushing and popping
+	NCSValue &top();
+	NCSValue pop();
+	void push(const NCSValue &value);
+
+	int32 popInt();
+	float popFloat();
+
+	void pushVoid();
+	void pushInt(int32 value);
+	void pushFloat(float value);
+	void pushObject(Object *value);
+	void pushString(const char *data, size_t length);
+	void pushConstString(uint32 index);
+	void pushVariable(const Variable &value);
+	// '---
+
+	// .--- Relative access
+	NCSValue &getRelSP(int32 pos);
+	NCSValue &getRelBP(int32 pos);
+
+	/** Assign a copy of a value to a stack element. */
+	void setRelSP(int32 pos, const NCSValue &value);
+	/** Assign a copy of a value to a base-pointer stack element. */
+	void setRelBP(int32 pos, const NCSValue &value);
+
+	/** Pin a stack element into a box, and return that box.
+	 *
+	 *  Until the next reset, the stack position keeps using this box, even
+	 *  after it has been popped and pushed again. References to the box
+	 *  stay valid.
+	 */
+	Variable &pinRelSP(int32 pos);
+	// '---
+
+	// .--- Stack and base pointer
+	int32 getStackPtr() const;
+	void  setStackPtr(int32 pos);
+
+	int32 getBasePtr() const;
+	void  setBasePtr(int32 pos);
+	// '---
+
+	// .--- Value access
+	Type getType(const NCSValue &value) const;
+
+	int32   getInt   (const NCSValue &value) const;
+	float   getFloat (const NCSValue &value) const;
+	Object *getObject(const NCSValue &value) const;
+
+	void getString(const NCSValue &value, const char *&data, size_t &length) const;
+
+	/** Compare two values the same way two Variables compare. */
+	bool equals(const NCSValue &value1, const NCSValue &value2) const;
+
+	/** Create a copy of this value. Boxed values are copied into a new box. */
+	NCSValue copy(const NCSValue &value);
+
+	/** Concatenate two string values into a new one. */
+	NCSValue concat(const NCSValue &value1, const NCSValue &value2);
+
+	/** Move this value into a box, if it isn't boxed already, and return that box. */
+	Variable &box(NCSValue &value);
+
+	Variable toVariable(const NCSValue &value) const;
+	NCSValue fromVariable(const Variable &variable);
+	// '---
+
+private:
+	std::vector<NCSValue> _values;
+
+	int32 _stackPtr;
+	int32 _basePtr;
+
+	/** Strings too long to be held directly in a value. */
+	std::vector<char> _strings;
+
+	/** Boxed values. A deque, so that references to boxes stay valid. */
+	std::deque<Variable> _boxes;
+	/** Indices of reclaimed boxes, ready for reuse. */
+	std::vector<uint32> _freeBoxes;
+
+	/** For each stack position, the index of its pinned box plus 1, or 0. */
+	std::vector<uint32> _pinned;
+	/** All stack positions at or above this one are unpinned. */
+	int32 _pinnedEnd;
+
+	size_t _stringLimit; ///< Reclaim strings once the arena grows over this size.
+	size_t _boxLimit;    ///< Reclaim boxes once more than this many are in use.
+
+	const NCSProgram *_program;
+
+	size_t _allocations;
+
+	size_t getIndex(int32 ptr, int32 pos, const char *op) const;
+
+	NCSValue makeString(const char *data, size_t length);
+	NCSValue makeBox(const Variable &variable);
+
+	void pushPinned(const NCSValue &value);
+	void assign(NCSValue &element, const NCSValue &value);
+
+	/** Compact the string arena and reclaim unused boxes. */
+	void compact();
+
+	int32 getIntSlow(const NCSValue &value) const;
+	float getFloatSlow(const NCSValue &value) const;
+};
+
+
+inline NCSValue NCSValueStack::pop() {
+	if (_stackPtr == -1)
+		throw Common::Exception("NCSValueStack: Stack underflow");
+
+	return _values[_stackPtr--];
+}
+
+inline void NCSValueStack::push(const NCSValue &value) {
+	if (_stackPtr + 1 < _pinnedEnd) {
+		pushPinned(value);
+		return;
+	}
+
+	if (_stackPtr == (int32)_values.size() - 1)
+		_values.push_back(value);
+	else
+		_values[_stackPtr + 1] = value;
+
+	_stackPtr++;
+}
+
+inline size_t NCSValueStack::getBoxCount() const {
+	return _boxes.size() - _freeBoxes.size();
+}
+
+inline void NCSValueStack::collect() {
+	if ((_strings.size() > _stringLimit) || (getBoxCount() > _boxLimit))
+		compact();
+}
+
+inline int32 NCSValueStack::getInt(const NCSValue &value) const {
+	if (value.kind == NCSValue::kKindInt)
+		return value.intValue;
+
+	return getIntSlow(value);
+}
+
+inline float NCSValueStack::getFloat(const NCSValue &value) const {
+	if (value.kind == NCSValue::kKindFloat)
+		return value.floatValue;
+
+	return getFloatSlow(value);
+}
+
+inline int32 NCSValueStack::popInt() {
+	if (_stackPtr == -1)
+		throw Common::Exception("NCSValueStack: Stack underflow");
+
+	return getInt(_values[_stackPtr--]);
+}
+
+inline float NCSValueStack::popFloat() {
+	if (_stackPtr == -1)
+		throw Common::Exception("NCSValueStack: Stack underflow");
+
+	return getFloat(_values[_stackPtr--]);
+}
+
+inline void NCSValueStack::pushInt(int32 value) {
+	NCSValue v;
+	v.kind     = NCSValue::kKindInt;
+	v.intValue = value;
+
+	push(v);
+}
+
+inline void NCSValueStack::pushFloat(float value) {
+	NCSValue v;
+	v.kind       = NCSValue::kKindFloat;
+	v.floatValue = value;
+
+	push(v);
+}
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
+
+#endif // AURORA_NWSCRIPT_NCSVALUE_H
@@ -22,30 +22,209 @@
  *  An NWScript object container.
  */
 
+#include <cassert>
+#include <cstring>
+
 #include <algorithm>
 
 #include "src/common/error.h"
+#include "src/common/hash.h"
 
 #include "src/aurora/types.h"
 
 #include "src/aurora/nwscript/objectcontainer.h"
 
+/** The smallest number of slots in the indices. */
+static const size_t kMinIndexSize = 64;
+
+/** Marker for "no slot". */
+static const size_t kNoSlot = SIZE_MAX;
+
 namespace Aurora {
 
 namespace NWScript {
 
-ObjectContainer::ObjectContainer() {
+/** Compare two tags exactly, without decoding them. */
+static inline bool equalTags(const Common::UString &a, const Common::UString &b) {
+	return std::strcmp(a.c_str(), b.c_str()) == 0;
+}
+
+/** Return the slot a key would ideally be in. */
+static inline size_t getHome(uint32 key, size_t mask) {
+	key *= 0x9E3779B1;
+	key ^= key >> 16;
+
+	return key & mask;
+}
+
+
+SearchTag::SearchTag(const ObjectContainer &container, const Common::UString &tag) :
+	_container(&container), _tag(&tag), _hash(ObjectContainer::hashTag(tag)), _generation(0),
+	_slot(kNoSlot), _count(0) {
+
+	Common::StackReadLock readLock(_container->_indexLock);
+
+	_generation = _container->_generation;
+	_slot       = _container->findTag(*_tag, _hash, kNoSlot, 0);
+}
+
+SearchTag::~SearchTag() {
+}
+
+void SearchTag::update() {
+	if (_generation == _container->_generation)
+		return;
+
+	_generation = _container->_generation;
+	_slot       = _container->findTag(*_tag, _hash, kNoSlot, _count);
+}
+
+Object *SearchTag::get() {
+	Common::StackReadLock readLock(_container->_indexLock);
+
+	update();
+	if (_slot == kNoSlot)
+		return 0;
+
+	return _container->_objectsByTag[_slot].object;
+}
+
+Object *SearchTag::next() {
+	Common::StackReadLock readLock(_container->_indexLock);
+
+	update();
+	if (_slot == kNoSlot)
+		return 0;
+
+	Object *object = _container->_objectsByTag[_slot].object;
+
+	_count++;
+	_slot = _container->findTag(*_tag, _hash, _slot + 1);
+
+	return object;
+}
+
+
+/** A SearchTag that keeps its own copy of the tag. */
+class SearchTagCopy : public ObjectSearch {
+public:
+	SearchTagCopy(const ObjectContainer &container, const Common::UString &tag) :
+		_tag(tag), _search(container, _tag) {
+	}
+
+	~SearchTagCopy() {
+	}
+
+	Object *get() {
+		return _search.get();
+	}
+
+	Object *next() {
+		return _search.next();
+	}
+
+private:
+	Common::UString _tag;
+
+	SearchTag _search;
+};
+
+
+ObjectContainer::ObjectContainer() : _indexCount(0), _generation(0) {
 }
 
 ObjectContainer::~ObjectContainer() {
 }
 
+uint32 ObjectContainer::hashTag(const Common::UString &tag) {
+	uint32 hash = 0x811C9DC5;
+
+	/* Go over the raw UTF-8 bytes instead of decoding the codepoints. Only
+	 * ASCII characters are folded, just like UString::toLower() does. */
+	for (const byte *c = reinterpret_cast<const byte *>(tag.c_str()); *c; c++)
+		hash = Common::hashFNV32(hash, ((*c >= 'A') && (*c <= 'Z')) ? (*c + ('a' - 'A')) : *c);
+
+	return hash;
+}
+
 void ObjectContainer::clearObjects() {
 	Common::StackLock stackLock(_mutex);
+	Common::StackWriteLock writeLock(_indexLock);
 
 	_objects.clear();
 	_objectsByID.clear();
 	_objectsByTag.clear();
+
+	_indexCount = 0;
+	_generation++;
+}
+
+void ObjectContainer::growIndices() {
+	size_t size = MAX(kMinIndexSize, _objectsByTag.size());
+
+	// Keep the indices at most half full, so that the probe sequences stay short
+	while ((_indexCount + 1) * 2 > size)
+		size *= 2;
+
+	if (size == _objectsByTag.size())
+		return;
+
+	Slot empty;
+	empty.key    = 0;
+	empty.object = 0;
+
+	_objectsByID.assign(size, empty);
+	_objectsByTag.assign(size, empty);
+
+	// Reinsert in the order the objects were added, to keep objects with the same tag in order
+	for (ObjectList::const_iterator o = _objects.begin(); o != _objects.end(); ++o) {
+		insert(_objectsByID , (*o)->getID(), **o, true);
+		insert(_objectsByTag, hashTag((*o)->getTag()), **o, false);
+	}
+}
+
+void ObjectContainer::insert(Index &index, uint32 key, Object &object, bool unique) {
+	const size_t mask = index.size() - 1;
+
+	size_t slot = getHome(key, mask);
+	for (; index[slot].object; slot = (slot + 1) & mask)
+		if (unique && (index[slot].key == key))
+			return;
+
+	index[slot].key    = key;
+	index[slot].object = &object;
+}
+
+void ObjectContainer::erase(Index &index, uint32 key, const Object &object) {
+	if (index.empty())
+		return;
+
+	const size_t mask = index.size() - 1;
+
+	size_t slot = getHome(key, mask);
+	for (; index[slot].object != &object; slot = (slot + 1) & mask)
+		if (!index[slot].object)
+			return;
+
+	/* Shift the following entries of the probe sequence back into the gap,
+	 * unless that would move them in front of their ideal slot. This keeps
+	 * the probe sequences unbroken without needing tombstones, and it
+	 * doesn't change the order of entries with the same key. */
+
+	for (size_t next = (slot + 1) & mask; index[next].object; next = (next + 1) & mask) {
+		const size_t home = getHome(index[next].key, mask);
+
+		// Is the ideal slot of this entry cyclically within (slot, next]? Then it has to stay
+		const bool stays = (slot <= next) ? ((home > slot) && (home <= next)) : ((home > slot) || (home <= next));
+		if (stays)
+			continue;
+
+		index[slot] = index[next];
+		slot = next;
+	}
+
+	index[slot].key    = 0;
+	index[slot].object = 0;
 }
 
 void ObjectContainer::addObject(Object &object) {
@@ -54,31 +233,75 @@ void ObjectContainer::addObject(Object &object) {
 	assert(std::find(_objects.begin(), _objects.end(), &object) == _objects.end());
 
 	_objects.push_back(&object);
-	_objectsByID.insert(std::make_pair(object.getID(), &object));
-	_objectsByTag.insert(std::make_pair(object.getTag(), &object));
+
+	Common::StackWriteLock writeLock(_indexLock);
+
+	if ((_indexCount + 1) * 2 > _objectsByTag.size()) {
+		// growIndices() reinserts everything from _objects, including the new object
+		growIndices();
+	} else {
+		insert(_objectsByID , object.getID(), object, true);
+		insert(_objectsByTag, hashTag(object.getTag()), object, false);
+	}
+
+	_indexCount++;
+	_generation++;
 }
 
 void ObjectContainer::removeObject(Object &object) {
 	Common::StackLock stackLock(_mutex);
 
-	_objects.remove(&object);
-	_objectsByID.erase(object.getID());
+	ObjectList::iterator o = std::find(_objects.begin(), _objects.end(), &object);
+	if (o == _objects.end())
+		return;
 
-	std::pair<ObjectTagMap::iterator, ObjectTagMap::iterator> tag =
-		_objectsByTag.equal_range(object.getTag());
+	_objects.erase(o);
 
-	for (ObjectTagMap::iterator o = tag.first; o != tag.second; ++o) {
-		if (o->second == &object) {
-			_objectsByTag.erase(o);
-			break;
-		}
-	}
+	Common::StackWriteLock writeLock(_indexLock);
+
+	erase(_objectsByID , object.getID(), object);
+	erase(_objectsByTag, hashTag(object.getTag()), object);
+
+	_indexCount--;
+	_generation++;
+}
+
+size_t ObjectContainer::findTag(const Common::UString &tag, uint32 hash, size_t slot) const {
+	if (_objectsByTag.empty())
+		return kNoSlot;
+
+	const size_t mask = _objectsByTag.size() - 1;
+
+	if (slot == kNoSlot)
+		slot = getHome(hash, mask);
+
+	for (slot &= mask; _objectsByTag[slot].object; slot = (slot + 1) & mask)
+		if ((_objectsByTag[slot].key == hash) && equalTags(_objectsByTag[slot].object->getTag(), tag))
+			return slot;
+
+	return kNoSlot;
+}
+
+size_t ObjectContainer::findTag(const Common::UString &tag, uint32 hash, size_t slot, size_t nth) const {
+	slot = findTag(tag, hash, slot);
+
+	while ((slot != kNoSlot) && (nth-- > 0))
+		slot = findTag(tag, hash, slot + 1);
+
+	return slot;
 }
 
 Object *ObjectContainer::getObjectByID(uint32 id) const {
-	ObjectIDMap::const_iterator o = _objectsByID.find(id);
-	if (o != _objectsByID.end())
-		return o->second;
+	Common::StackReadLock readLock(_indexLock);
+
+	if (_objectsByID.empty())
+		return 0;
+
+	const size_t mask = _objectsByID.size() - 1;
+
+	for (size_t slot = getHome(id, mask); _objectsByID[slot].object; slot = (slot + 1) & mask)
+		if (_objectsByID[slot].key == id)
+			return _objectsByID[slot].object;
 
 	return 0;
 }
@@ -90,9 +313,21 @@ Object *ObjectContainer::getFirstObject() const {
 }
 
 Object *ObjectContainer::getFirstObjectByTag(const Common::UString &tag) const {
-	SearchTagMap ctx(_objectsByTag, tag);
+	return getObjectByTag(tag, 0);
+}
 
-	return ctx.get();
+Object *ObjectContainer::getObjectByTag(const Common::UString &tag, size_t nth) const {
+	Common::StackReadLock readLock(_indexLock);
+
+	const size_t slot = findTag(tag, hashTag(tag), kNoSlot, nth);
+	if (slot == kNoSlot)
+		return 0;
+
+	return _objectsByTag[slot].object;
+}
+
+size_t ObjectContainer::getObjectCount() const {
+	return _indexCount;
 }
 
 ObjectSearch *ObjectContainer::findObjects() const {
@@ -100,7 +335,7 @@ ObjectSearch *ObjectContainer::findObjects() const {
 }
 
 ObjectSearch *ObjectContainer::findObjectsByTag(const Common::UString &tag) const {
-	return new SearchTagMap(_objectsByTag, tag);
+	return new SearchTagCopy(*this, tag);
 }
 
 void ObjectContainer::lock() {
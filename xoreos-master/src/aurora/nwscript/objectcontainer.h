@@ -26,7 +26,7 @@
 #define AURORA_NWSCRIPT_OBJECTCONTAINER_H
 
 #include <list>
-#include <map>
+#include <vector>
 
 #include "src/common/mutex.h"
 
@@ -89,12 +89,37 @@ public:
 	Object *getObject(const iterator &t) { return *t; }
 };
 
-class SearchTagMap : public SearchRange< std::multimap<Common::UString, Object *> > {
+class ObjectContainer;
+
+/** A search through the objects with a specific tag.
+ *
+ *  Walks an ObjectContainer's tag index directly and doesn't allocate
+ *  any memory, so it can be used on the stack. The tag has to stay
+ *  valid for as long as the search is used.
+ *
+ *  If objects are added to or removed from the container while
+ *  searching, the search looks up the tag again and skips as many
+ *  objects as it has already returned.
+ */
+class SearchTag : public ObjectSearch {
 public:
-	SearchTagMap(const type &m, const Common::UString &tag) : SearchRange<type>(m.equal_range(tag)) { }
-	~SearchTagMap() { }
+	SearchTag(const ObjectContainer &container, const Common::UString &tag);
+	~SearchTag();
+
+	Object *get();
+	Object *next();
 
-	Object *getObject(const iterator &t) { return t->second; };
+private:
+	const ObjectContainer *_container;
+	const Common::UString *_tag;
+
+	uint32 _hash;
+
+	uint32 _generation; ///< The state of the index _slot belongs to.
+	size_t _slot;       ///< The index slot of the current object.
+	size_t _count;      ///< The number of objects already returned.
+
+	void update();
 };
 
 class ObjectContainer {
@@ -116,12 +141,20 @@ public:
 	Object *getFirstObject() const;
 	/** Return the first object with this tag. */
 	Object *getFirstObjectByTag(const Common::UString &tag) const;
+	/** Return the nth object (0 is the first) with this tag. */
+	Object *getObjectByTag(const Common::UString &tag, size_t nth = 0) const;
+
+	/** Return the number of objects in this container. */
+	size_t getObjectCount() const;
 
 	/** Return a search context to iterate over all objects. */
 	ObjectSearch *findObjects() const;
 	/** Return a search context to iterate over all objects with this tag. */
 	ObjectSearch *findObjectsByTag(const Common::UString &tag) const;
 
+	/** Return the hash objects are indexed by for this tag. Case-insensitive. */
+	static uint32 hashTag(const Common::UString &tag);
+
 
 protected:
 	void lock();
@@ -129,15 +162,41 @@ protected:
 
 
 private:
-	typedef std::map<uint32, Object *> ObjectIDMap;
+	/** A slot in the open-addressing tag and ID indices. */
+	struct Slot {
+		uint32 key; ///< The tag hash or the ID.
+
+		Object *object; ///< The object, or 0 if the slot is empty.
+	};
+
+	typedef std::vector<Slot> Index;
 	typedef SearchList::type ObjectList;
-	typedef SearchTagMap::type ObjectTagMap;
 
-	Common::Mutex _mutex;
+	Common::Mutex _mutex; ///< Serializes changes to the container.
+	/** Keeps lookups away from indices in mid-change. */
+	mutable Common::ReadWriteLock _indexLock;
+
+	ObjectList _objects;
+
+	Index _objectsByID;
+	Index _objectsByTag;
+
+	size_t _indexCount; ///< Number of objects in the indices.
+
+	/** Changes whenever objects move around in the indices. */
+	uint32 _generation;
+
+	void growIndices();
+
+	static void insert(Index &index, uint32 key, Object &object, bool unique);
+	static void erase(Index &index, uint32 key, const Object &object);
+
+	/** Find the next slot holding an object with this tag, starting at slot. */
+	size_t findTag(const Common::UString &tag, uint32 hash, size_t slot) const;
+	/** Find the slot holding the nth object with this tag. */
+	size_t findTag(const Common::UString &tag, uint32 hash, size_t slot, size_t nth) const;
 
-	ObjectList   _objects;
-	ObjectIDMap  _objectsByID;
-	ObjectTagMap _objectsByTag;
+	friend class SearchTag;
 };
 
 } // End of namespace NWScript
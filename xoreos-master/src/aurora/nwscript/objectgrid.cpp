@@ -0,0 +1,282 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A spatial grid over the objects in an area.
+ */
+
+#include <cmath>
+
+#include <algorithm>
+
+#include "src/common/util.h"
+
+#include "src/aurora/nwscript/objectgrid.h"
+#include "src/aurora/nwscript/object.h"
+
+/** Cell coordinates are clamped to this range, to keep far-flung objects from overflowing. */
+static const int32 kMaxCell = 0x100000;
+
+namespace Aurora {
+
+namespace NWScript {
+
+bool ObjectGrid::Candidate::operator<(const Candidate &c) const {
+	if (distance != c.distance)
+		return distance < c.distance;
+
+	return sequence < c.sequence;
+}
+
+
+ObjectGrid::ObjectGrid(float cellSize) : _cellSize(cellSize), _sequence(0) {
+	if (!(_cellSize > 0.0f))
+		_cellSize = 10.0f;
+
+	clear();
+}
+
+ObjectGrid::~ObjectGrid() {
+}
+
+void ObjectGrid::clear() {
+	_entries.clear();
+	_cells.clear();
+
+	_minCellX = _minCellY =  kMaxCell;
+	_maxCellX = _maxCellY = -kMaxCell;
+}
+
+size_t ObjectGrid::getObjectCount() const {
+	return _entries.size();
+}
+
+void ObjectGrid::getObjects(std::vector<Object *> &objects) const {
+	objects.clear();
+	objects.reserve(_entries.size());
+
+	for (EntryMap::const_iterator e = _entries.begin(); e != _entries.end(); ++e)
+		objects.push_back(e->first);
+}
+
+bool ObjectGrid::hasObject(const Object &object) const {
+	return _entries.find(const_cast<Object *>(&object)) != _entries.end();
+}
+
+int32 ObjectGrid::getCell(float coordinate) const {
+	const float cell = floorf(coordinate / _cellSize);
+
+	// Written so that NaNs end up in a valid cell as well
+	if (cell >= kMaxCell)
+		return kMaxCell;
+	if (cell > -kMaxCell)
+		return (int32) cell;
+
+	return -kMaxCell;
+}
+
+uint64 ObjectGrid::getCellKey(int32 cellX, int32 cellY) {
+	return (((uint64) ((uint32) cellX)) << 32) | ((uint64) ((uint32) cellY));
+}
+
+void ObjectGrid::addToCell(EntryMap::value_type &entry) {
+	const int32 cellX = entry.second.cellX;
+	const int32 cellY = entry.second.cellY;
+
+	_cells[getCellKey(cellX, cellY)].push_back(&entry);
+
+	_minCellX = MIN(_minCellX, cellX);
+	_maxCellX = MAX(_maxCellX, cellX);
+	_minCellY = MIN(_minCellY, cellY);
+	_maxCellY = MAX(_maxCellY, cellY);
+}
+
+void ObjectGrid::removeFromCell(EntryMap::value_type &entry) {
+	CellMap::iterator cell = _cells.find(getCellKey(entry.second.cellX, entry.second.cellY));
+	if (cell == _cells.end())
+		return;
+
+	Cell::iterator it = std::find(cell->second.begin(), cell->second.end(), &entry);
+	if (it == cell->second.end())
+		return;
+
+	// The order within a cell doesn't matter
+	*it = cell->second.back();
+	cell->second.pop_back();
+
+	if (cell->second.empty())
+		_cells.erase(cell);
+}
+
+void ObjectGrid::setObject(Object &object, float x, float y, float z, uint32 type) {
+	const int32 cellX = getCell(x);
+	const int32 cellY = getCell(y);
+
+	std::pair<EntryMap::iterator, bool> result = _entries.insert(std::make_pair(&object, Entry()));
+	EntryMap::value_type &entry = *result.first;
+
+	if (result.second) {
+		entry.second.sequence = _sequence++;
+	} else if ((entry.second.cellX != cellX) || (entry.second.cellY != cellY)) {
+		removeFromCell(entry);
+		result.second = true;
+	}
+
+	entry.second.position[0] = x;
+	entry.second.position[1] = y;
+	entry.second.position[2] = z;
+
+	entry.second.type = type;
+
+	entry.second.cellX = cellX;
+	entry.second.cellY = cellY;
+
+	// New object, or it moved into a different cell
+	if (result.second)
+		addToCell(entry);
+}
+
+void ObjectGrid::removeObject(const Object &object) {
+	EntryMap::iterator entry = _entries.find(const_cast<Object *>(&object));
+	if (entry == _entries.end())
+		return;
+
+	removeFromCell(*entry);
+	_entries.erase(entry);
+}
+
+void ObjectGrid::searchCell(int32 cellX, int32 cellY, float x, float y, float z, uint32 types,
+                            const Common::UString &tag, const Object *exclude,
+                            std::vector<Candidate> &candidates) const {
+
+	CellMap::const_iterator cell = _cells.find(getCellKey(cellX, cellY));
+	if (cell == _cells.end())
+		return;
+
+	for (Cell::const_iterator c = cell->second.begin(); c != cell->second.end(); ++c) {
+		Object *object = (*c)->first;
+		const Entry &entry = (*c)->second;
+
+		if (object == exclude)
+			continue;
+		if ((types != kTypeAny) && !(entry.type & types))
+			continue;
+		if (!tag.empty() && (object->getTag() != tag))
+			continue;
+
+		Candidate candidate;
+
+		candidate.distance = ABS(entry.position[0] - x) + ABS(entry.position[1] - y) + ABS(entry.position[2] - z);
+		candidate.sequence = entry.sequence;
+		candidate.object   = object;
+
+		candidates.push_back(candidate);
+	}
+}
+
+void ObjectGrid::findNearest(float x, float y, float z, size_t count, std::vector<Object *> &objects,
+                             uint32 types, const Common::UString &tag, const Object *exclude) const {
+
+	objects.clear();
+	if ((count == 0) || _entries.empty())
+		return;
+
+	const int32 cellX = getCell(x);
+	const int32 cellY = getCell(y);
+
+	std::vector<Candidate> candidates;
+
+	/* Search rings of cells around the position, moving outwards, until we either
+	 * went through all cells that contain objects, or we have enough objects that
+	 * are nearer than anything that could be in the cells we haven't looked at yet.
+	 *
+	 * Rings that lie completely outside the filled cells are skipped. */
+
+	int32 ring = MAX(MAX(_minCellX - cellX, cellX - _maxCellX), MAX(_minCellY - cellY, cellY - _maxCellY));
+	ring = MAX<int32>(ring, 0);
+
+	for (; ; ring++) {
+		const int32 x0 = cellX - ring, x1 = cellX + ring;
+		const int32 y0 = cellY - ring, y1 = cellY + ring;
+
+		if (ring == 0) {
+			searchCell(cellX, cellY, x, y, z, types, tag, exclude, candidates);
+		} else {
+			// Top and bottom row
+			const int32 xStart = MAX(x0, _minCellX), xEnd = MIN(x1, _maxCellX);
+
+			if ((y0 >= _minCellY) && (y0 <= _maxCellY))
+				for (int32 i = xStart; i <= xEnd; i++)
+					searchCell(i, y0, x, y, z, types, tag, exclude, candidates);
+			if ((y1 >= _minCellY) && (y1 <= _maxCellY))
+				for (int32 i = xStart; i <= xEnd; i++)
+					searchCell(i, y1, x, y, z, types, tag, exclude, candidates);
+
+			// Left and right column, without the corners
+			const int32 yStart = MAX(y0 + 1, _minCellY), yEnd = MIN(y1 - 1, _maxCellY);
+
+			if ((x0 >= _minCellX) && (x0 <= _maxCellX))
+				for (int32 i = yStart; i <= yEnd; i++)
+					searchCell(x0, i, x, y, z, types, tag, exclude, candidates);
+			if ((x1 >= _minCellX) && (x1 <= _maxCellX))
+				for (int32 i = yStart; i <= yEnd; i++)
+					searchCell(x1, i, x, y, z, types, tag, exclude, candidates);
+		}
+
+		if ((x0 <= _minCellX) && (x1 >= _maxCellX) && (y0 <= _minCellY) && (y1 >= _maxCellY))
+			break;
+
+		if (candidates.size() >= count) {
+			// Anything outside the ring is at least this far away
+			const float bound = MIN(MIN(x - x0 * _cellSize, (x1 + 1) * _cellSize - x),
+			                        MIN(y - y0 * _cellSize, (y1 + 1) * _cellSize - y));
+
+			std::nth_element(candidates.begin(), candidates.begin() + (count - 1), candidates.end());
+
+			// Strictly nearer, so that an equidistant but older object can't be missed
+			if (candidates[count - 1].distance < bound)
+				break;
+		}
+	}
+
+	count = MIN(count, candidates.size());
+
+	std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end());
+
+	objects.reserve(count);
+	for (size_t i = 0; i < count; i++)
+		objects.push_back(candidates[i].object);
+}
+
+Object *ObjectGrid::getNearest(float x, float y, float z, size_t nth, uint32 types,
+                               const Common::UString &tag, const Object *exclude) const {
+
+	std::vector<Object *> objects;
+	findNearest(x, y, z, nth + 1, objects, types, tag, exclude);
+
+	if (objects.size() <= nth)
+		return 0;
+
+	return objects[nth];
+}
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
@@ -0,0 +1,155 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A spatial grid over the objects in an area.
+ */
+
+#ifndef AURORA_NWSCRIPT_OBJECTGRID_H
+#define AURORA_NWSCRIPT_OBJECTGRID_H
+
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/unordered/unordered_map.hpp>
+
+#include "src/common/types.h"
+#include "src/common/ustring.h"
+
+namespace Aurora {
+
+namespace NWScript {
+
+class Object;
+
+/** A uniform grid over the positions of the objects within one area.
+ *
+ *  The grid only looks at the x and y coordinates to sort objects into
+ *  cells, but the distance between objects is measured as the sum of
+ *  the absolute differences of all three coordinates. Objects at the same distance
+ *  are ordered by when they were first added to the grid.
+ */
+class ObjectGrid : boost::noncopyable {
+public:
+	/** Don't filter the objects by type. */
+	static const uint32 kTypeAny = 0xFFFFFFFF;
+
+	ObjectGrid(float cellSize = 10.0f);
+	~ObjectGrid();
+
+	/** Remove all objects from the grid. */
+	void clear();
+
+	/** Add an object to the grid, or update its position if it's already there.
+	 *
+	 *  @param object The object to add.
+	 *  @param x      The object's x coordinate.
+	 *  @param y      The object's y coordinate.
+	 *  @param z      The object's z coordinate.
+	 *  @param type   The object's type, as a bitfield to check type masks against.
+	 */
+	void setObject(Object &object, float x, float y, float z, uint32 type);
+	/** Remove an object from the grid. */
+	void removeObject(const Object &object);
+
+	/** Is this object in the grid? */
+	bool hasObject(const Object &object) const;
+	/** Return the number of objects in the grid. */
+	size_t getObjectCount() const;
+	/** Return all objects in the grid, in no particular order. */
+	void getObjects(std::vector<Object *> &objects) const;
+
+	/** Find the objects nearest to a position.
+	 *
+	 *  @param x       The x coordinate to look around.
+	 *  @param y       The y coordinate to look around.
+	 *  @param z       The z coordinate to look around.
+	 *  @param count   Find at most this many objects.
+	 *  @param objects The found objects, nearest first.
+	 *  @param types   Only find objects whose type shares a bit with this mask.
+	 *  @param tag     If not empty, only find objects with this tag.
+	 *  @param exclude Never find this object.
+	 */
+	void findNearest(float x, float y, float z, size_t count, std::vector<Object *> &objects,
+	                 uint32 types = kTypeAny, const Common::UString &tag = "",
+	                 const Object *exclude = 0) const;
+
+	/** Return the nth nearest object to a position (0 is the nearest), or 0 if there's none.
+	 *
+	 *  @see findNearest()
+	 */
+	Object *getNearest(float x, float y, float z, size_t nth, uint32 types = kTypeAny,
+	                   const Common::UString &tag = "", const Object *exclude = 0) const;
+
+private:
+	/** An object in the grid. */
+	struct Entry {
+		float position[3];
+
+		uint32 type;
+		uint32 sequence; ///< When the object was added, to keep the order of equidistant objects stable.
+
+		int32 cellX;
+		int32 cellY;
+	};
+
+	/** An object found while searching. */
+	struct Candidate {
+		float distance;
+		uint32 sequence;
+
+		Object *object;
+
+		bool operator<(const Candidate &c) const;
+	};
+
+	typedef boost::unordered_map<Object *, Entry> EntryMap;
+
+	/** The objects in one cell. Elements of an unordered map never move, so we can point to them. */
+	typedef std::vector<EntryMap::value_type *> Cell;
+	typedef boost::unordered_map<uint64, Cell> CellMap;
+
+	float _cellSize;
+
+	EntryMap _entries;
+	CellMap  _cells;
+
+	uint32 _sequence;
+
+	/** The range of cells that ever held objects. */
+	int32 _minCellX, _maxCellX, _minCellY, _maxCellY;
+
+	int32 getCell(float coordinate) const;
+
+	void addToCell(EntryMap::value_type &entry);
+	void removeFromCell(EntryMap::value_type &entry);
+
+	void searchCell(int32 cellX, int32 cellY, float x, float y, float z, uint32 types,
+	                const Common::UString &tag, const Object *exclude,
+	                std::vector<Candidate> &candidates) const;
+
+	static uint64 getCellKey(int32 cellX, int32 cellY);
+};
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
+
+#endif // AURORA_NWSCRIPT_OBJECTGRID_H
@@ -0,0 +1,215 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A profiler for NWScript execution.
+ */
+
+#include <algorithm>
+
+#include <SDL_timer.h>
+
+#include "src/common/util.h"
+#include "src/common/writestream.h"
+
+#include "src/aurora/nwscript/profiler.h"
+
+DECLARE_SINGLETON(Aurora::NWScript::NCSProfiler)
+
+namespace Aurora {
+
+namespace NWScript {
+
+static uint64 ticksToMicroseconds(uint64 ticks) {
+	return (uint64) ((ticks * 1000000.0) / SDL_GetPerformanceFrequency());
+}
+
+static bool compareTotalTime(const NCSProfiler::Entry &a, const NCSProfiler::Entry &b) {
+	return a.totalTime > b.totalTime;
+}
+
+
+NCSProfiler::Entry::Entry() : calls(0), instructions(0), allocations(0), totalTime(0), selfTime(0) {
+}
+
+NCSProfiler::Ticks::Ticks() : total(0), self(0) {
+}
+
+
+NCSProfiler::NCSProfiler() : _enabled(false) {
+}
+
+NCSProfiler::~NCSProfiler() {
+}
+
+void NCSProfiler::setEnabled(bool enabled) {
+	_enabled = enabled;
+}
+
+void NCSProfiler::clear() {
+	clearRecords();
+
+	_stacks.clear();
+}
+
+void NCSProfiler::clearRecords() {
+	if (!_frames.empty()) {
+		// Scripts are still running and hold on to their records. Only reset the numbers
+
+		for (size_t i = 0; i < kCategoryMAX; i++) {
+			for (RecordMap::iterator r = _records[i].begin(); r != _records[i].end(); ++r) {
+				const Common::UString name = r->second.entry.name;
+
+				r->second.entry      = Entry();
+				r->second.entry.name = name;
+				r->second.ticks      = Ticks();
+			}
+		}
+
+		return;
+	}
+
+	for (size_t i = 0; i < kCategoryMAX; i++)
+		_records[i].clear();
+}
+
+void NCSProfiler::getEntries(Category category, std::vector<Entry> &entries) const {
+	assert((size_t)category < kCategoryMAX);
+
+	entries.clear();
+	entries.reserve(_records[category].size());
+
+	for (RecordMap::const_iterator r = _records[category].begin(); r != _records[category].end(); ++r) {
+		entries.push_back(r->second.entry);
+
+		entries.back().totalTime = ticksToMicroseconds(r->second.ticks.total);
+		entries.back().selfTime  = ticksToMicroseconds(r->second.ticks.self);
+	}
+
+	std::stable_sort(entries.begin(), entries.end(), compareTotalTime);
+}
+
+void NCSProfiler::writeFoldedStacks(Common::WriteStream &stream) const {
+	for (StackMap::const_iterator s = _stacks.begin(); s != _stacks.end(); ++s) {
+		const unsigned long long time = ticksToMicroseconds(s->second);
+
+		stream.writeString(Common::UString::format("%s %llu\n", s->first.c_str(), time));
+	}
+}
+
+void NCSProfiler::enterScript(const Common::UString &name) {
+	enter(kCategoryScript, name);
+}
+
+void NCSProfiler::enterSubroutine(uint32 address) {
+	Common::UString script;
+	for (std::vector<Frame>::const_reverse_iterator f = _frames.rbegin(); f != _frames.rend(); ++f) {
+		if (f->category == kCategoryScript) {
+			script = f->record->entry.name;
+			break;
+		}
+	}
+
+	enter(kCategorySubroutine, Common::UString::format("%s@%u", script.c_str(), address));
+}
+
+void NCSProfiler::enterFunction(uint32 function, const Common::UString &name) {
+	enter(kCategoryFunction, Common::UString::format("%s(%u)", name.c_str(), function));
+}
+
+void NCSProfiler::leaveSubroutine() {
+	if (!_frames.empty() && (_frames.back().category == kCategorySubroutine))
+		leave();
+}
+
+void NCSProfiler::leaveFunction() {
+	// Leave anything a failed engine function left behind
+	while (!_frames.empty() && (_frames.back().category != kCategoryFunction))
+		leave();
+
+	if (!_frames.empty())
+		leave();
+}
+
+void NCSProfiler::leaveScript() {
+	while (!_frames.empty() && (_frames.back().category != kCategoryScript))
+		leave();
+
+	if (!_frames.empty())
+		leave();
+}
+
+void NCSProfiler::count(uint64 instructions, uint64 allocations) {
+	if (_frames.empty())
+		return;
+
+	Entry &entry = _frames.back().record->entry;
+
+	entry.instructions += instructions;
+	entry.allocations  += allocations;
+}
+
+void NCSProfiler::enter(Category category, const Common::UString &name) {
+	Record &record = _records[category][name];
+	if (record.entry.name.empty())
+		record.entry.name = name;
+
+	record.entry.calls++;
+
+	Frame frame;
+
+	frame.category    = category;
+	frame.record      = &record;
+	frame.stackLength = _stack.size();
+	frame.children    = 0;
+
+	if (!_stack.empty())
+		_stack += ';';
+	_stack += name.c_str();
+
+	_frames.push_back(frame);
+
+	// Take the time last, to not count the profiler's own bookkeeping
+	_frames.back().start = SDL_GetPerformanceCounter();
+}
+
+void NCSProfiler::leave() {
+	const uint64 now = SDL_GetPerformanceCounter();
+
+	const Frame &frame = _frames.back();
+
+	const uint64 total = now - frame.start;
+	const uint64 self  = (total > frame.children) ? (total - frame.children) : 0;
+
+	frame.record->ticks.total += total;
+	frame.record->ticks.self  += self;
+
+	_stacks[_stack] += self;
+
+	_stack.resize(frame.stackLength);
+	_frames.pop_back();
+
+	if (!_frames.empty())
+		_frames.back().children += total;
+}
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
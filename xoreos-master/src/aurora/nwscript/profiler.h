@@ -0,0 +1,175 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A profiler for NWScript execution.
+ */
+
+#ifndef AURORA_NWSCRIPT_PROFILER_H
+#define AURORA_NWSCRIPT_PROFILER_H
+
+#include <map>
+#include <vector>
+#include <string>
+
+#include "src/common/types.h"
+#include "src/common/ustring.h"
+#include "src/common/singleton.h"
+
+namespace Common {
+	class WriteStream;
+}
+
+namespace Aurora {
+
+namespace NWScript {
+
+/** A profiler for NWScript execution.
+ *
+ *  When enabled, NCSFile reports every script run, every subroutine call
+ *  (JSR) and every engine function call (ACTION) to the profiler. For
+ *  each script, subroutine and engine function, the profiler collects
+ *  the number of calls, the number of instructions executed, the number
+ *  of heap allocations of script values, and the wall time spent.
+ *
+ *  Additionally, the self time of every distinct call stack is collected,
+ *  which can be written out in the folded stack format understood by
+ *  flame graph tools.
+ *
+ *  When disabled, the only overhead is one flag check per script run.
+ *
+ *  The profiler is not thread-safe. It may only be used from the thread
+ *  running the scripts.
+ */
+class NCSProfiler : public Common::Singleton<NCSProfiler> {
+public:
+	/** The different kinds of things profiled. */
+	enum Category {
+		kCategoryScript,     ///< Whole script runs.
+		kCategorySubroutine, ///< Subroutines within a script, by their offset.
+		kCategoryFunction,   ///< Engine functions.
+		kCategoryMAX
+	};
+
+	/** The collected numbers of a script, subroutine or engine function. */
+	struct Entry {
+		Common::UString name;
+
+		uint64 calls;
+
+		uint64 instructions; ///< Instructions executed, without callees.
+		uint64 allocations;  ///< Value allocations, without callees.
+
+		uint64 totalTime; ///< Wall time in microseconds, including callees.
+		uint64 selfTime;  ///< Wall time in microseconds, without callees.
+
+		Entry();
+	};
+
+	NCSProfiler();
+	~NCSProfiler();
+
+	bool isEnabled() const;
+	void setEnabled(bool enabled);
+
+	/** Throw away everything collected so far. */
+	void clear();
+
+	/** Return all collected entries of a category, sorted by descending total time. */
+	void getEntries(Category category, std::vector<Entry> &entries) const;
+
+	/** Write the self times of all collected call stacks, in the folded stack format. */
+	void writeFoldedStacks(Common::WriteStream &stream) const;
+
+	// .--- Reporting, called by NCSFile
+	void enterScript(const Common::UString &name);
+	/** Enter a subroutine of the innermost script, by its byte offset. */
+	void enterSubroutine(uint32 address);
+	void enterFunction(uint32 function, const Common::UString &name);
+
+	/** Leave the innermost subroutine. */
+	void leaveSubroutine();
+	/** Leave the innermost engine function. */
+	void leaveFunction();
+	/** Leave the innermost script, including all its subroutines not left yet. */
+	void leaveScript();
+
+	/** Add instructions and allocations to whatever is currently executing. */
+	void count(uint64 instructions, uint64 allocations);
+	// '---
+
+private:
+	/** Wall time, in ticks of the performance counter. */
+	struct Ticks {
+		uint64 total;
+		uint64 self;
+
+		Ticks();
+	};
+
+	struct Record {
+		Entry entry;
+		Ticks ticks;
+	};
+
+	typedef std::map<Common::UString, Record> RecordMap;
+	typedef std::map<std::string, uint64> StackMap;
+
+	/** A currently executing script, subroutine or function. */
+	struct Frame {
+		Category category;
+		Record *record;
+
+		size_t stackLength; ///< Length of the call stack string before entering this frame.
+
+		uint64 start;    ///< Performance counter when entering this frame.
+		uint64 children; ///< Ticks spent in callees.
+	};
+
+	bool _enabled;
+
+	RecordMap _records[kCategoryMAX];
+
+	/** Self ticks of all call stacks, keyed by the stack in folded format. */
+	StackMap _stacks;
+
+	std::vector<Frame> _frames;
+
+	/** The current call stack, in folded format. */
+	std::string _stack;
+
+	void enter(Category category, const Common::UString &name);
+	void leave();
+
+	void clearRecords();
+};
+
+inline bool NCSProfiler::isEnabled() const {
+	return _enabled;
+}
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
+
+/** Shortcut for accessing the NWScript profiler. */
+#define NCSProfile Aurora::NWScript::NCSProfiler::instance()
+
+#endif // AURORA_NWSCRIPT_PROFILER_H
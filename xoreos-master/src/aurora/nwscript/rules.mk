@@ -31,8 +31,14 @@ src_aurora_nwscript_libnwscript_la_SOURCES += \
     src/aurora/nwscript/enginetype.h \
     src/aurora/nwscript/object.h \
     src/aurora/nwscript/objectcontainer.h \
+    src/aurora/nwscript/objectgrid.h \
     src/aurora/nwscript/functionman.h \
+    src/aurora/nwscript/ncsprogram.h \
+    src/aurora/nwscript/ncsvalue.h \
+    src/aurora/nwscript/ncscache.h \
+    src/aurora/nwscript/profiler.h \
     src/aurora/nwscript/ncsfile.h \
+    src/aurora/nwscript/actionscheduler.h \
     $(EMPTY)
 
 src_aurora_nwscript_libnwscript_la_SOURCES += \
@@ -41,6 +47,12 @@ src_aurora_nwscript_libnwscript_la_SOURCES += \
     src/aurora/nwscript/variablecontainer.cpp \
     src/aurora/nwscript/functioncontext.cpp \
     src/aurora/nwscript/objectcontainer.cpp \
+    src/aurora/nwscript/objectgrid.cpp \
     src/aurora/nwscript/functionman.cpp \
+    src/aurora/nwscript/ncsprogram.cpp \
+    src/aurora/nwscript/ncsvalue.cpp \
+    src/aurora/nwscript/ncscache.cpp \
+    src/aurora/nwscript/profiler.cpp \
     src/aurora/nwscript/ncsfile.cpp \
+    src/aurora/nwscript/actionscheduler.cpp \
     $(EMPTY)
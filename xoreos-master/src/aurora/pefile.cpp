@@ -47,6 +47,11 @@ const Archive::ResourceList &PEFile::getResources() const {
 	return _resources;
 }
 
+bool PEFile::isResourceDecoded(uint32 UNUSED(index)) const {
+	// Cursors are converted into the standalone cursor format on the fly
+	return true;
+}
+
 Common::SeekableReadStream *PEFile::getResource(uint32 index, bool UNUSED(tryNoCopy)) const {
 	// Convert from the PE cursor group/cursor format to the standalone
 	// cursor format.
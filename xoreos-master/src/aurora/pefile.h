@@ -51,6 +51,9 @@ public:
 	/** Return the list of resources. */
 	const ResourceList &getResources() const;
 
+	/** Does reading this resource decode it? */
+	bool isResourceDecoded(uint32 index) const;
+
 	/** Return a stream of the resource's contents. */
 	Common::SeekableReadStream *getResource(uint32 index, bool tryNoCopy = false) const;
 
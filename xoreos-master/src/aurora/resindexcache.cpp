@@ -0,0 +1,388 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A persistent cache of archive resource tables.
+ */
+
+/* The cache file is a simple little-endian binary file:
+ *
+ *  - uint32BE: ID ("XRIC")
+ *  - uint32:   Version
+ *  - uint32:   Number of entries
+ *  - For each entry:
+ *    - string: Path of the archive file
+ *    - uint32: Size of the entry data
+ *    - Entry data:
+ *      - string: Path of the archive file
+ *      - uint64: Size of the archive file
+ *      - uint64: Modification time of the archive file, in nanoseconds
+ *      - uint32: Archive type
+ *      - int32:  Hash algorithm
+ *      - uint32: Number of tables
+ *      - For each table:
+ *        - string: Path of the table's archive file
+ *        - uint64: Size of the table's archive file
+ *        - uint64: Modification time of the table's archive file, in nanoseconds
+ *        - uint32: Number of resources
+ *        - For each resource:
+ *          - string: Name
+ *          - uint32: Type
+ *          - uint64: Hash
+ *          - uint32: Index
+ *
+ * Strings are stored as an uint32 length in bytes, followed by the
+ * UTF-8 encoded string data.
+ */
+
+#include <cstring>
+
+#include <boost/scope_exit.hpp>
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/endianness.h"
+#include "src/common/readstream.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+#include "src/common/readfile.h"
+#include "src/common/writefile.h"
+#include "src/common/filepath.h"
+
+#include "src/aurora/resindexcache.h"
+
+static const uint32 kCacheID      = MKTAG('X', 'R', 'I', 'C');
+static const uint32 kCacheVersion = 2;
+
+static const uint32 kMaxStringLength = 4096;
+
+namespace Aurora {
+
+ResourceIndexCache::ResourceIndexCache() : _changed(false) {
+}
+
+ResourceIndexCache::~ResourceIndexCache() {
+	try {
+		close();
+	} catch (...) {
+	}
+}
+
+void ResourceIndexCache::open(const Common::UString &file) {
+	close();
+
+	_file = file;
+
+	if (!Common::FilePath::isRegularFile(_file))
+		return;
+
+	try {
+		_cache.reset(new Common::ReadFile(_file, true));
+
+		readEntries();
+
+	} catch (Common::Exception &e) {
+		e.add("Failed to read resource index cache \"%s\"", _file.c_str());
+		Common::printException(e, "WARNING: ");
+
+		_cache.reset();
+		_entries.clear();
+
+		// Overwrite the broken cache file
+		_changed = true;
+	}
+}
+
+void ResourceIndexCache::close() {
+	BOOST_SCOPE_EXIT( (&_file) (&_cache) (&_entries) (&_newEntries) (&_changed) ) {
+		_file.clear();
+		_cache.reset();
+		_entries.clear();
+		_newEntries.clear();
+
+		_changed = false;
+	} BOOST_SCOPE_EXIT_END
+
+	if (!_file.empty() && _changed)
+		save();
+}
+
+bool ResourceIndexCache::isOpen() const {
+	return !_file.empty();
+}
+
+void ResourceIndexCache::readEntries() {
+	if (_cache->readUint32BE() != kCacheID)
+		throw Common::Exception("Not a resource index cache file");
+
+	const uint32 version = _cache->readUint32LE();
+	if (version != kCacheVersion)
+		throw Common::Exception("Unsupported resource index cache version %u", version);
+
+	const uint32 count = _cache->readUint32LE();
+	for (uint32 i = 0; i < count; i++) {
+		Common::UString path;
+		readString(*_cache, path);
+
+		Entry entry;
+		entry.size   = _cache->readUint32LE();
+		entry.offset = _cache->pos();
+
+		if ((entry.offset + entry.size) > _cache->size())
+			throw Common::Exception("Resource index cache entry out of range");
+
+		_cache->skip(entry.size);
+
+		_entries[path] = entry;
+	}
+}
+
+void ResourceIndexCache::save() {
+	std::vector<Common::UString> paths;
+	std::vector< std::vector<byte> > data;
+
+	paths.reserve(_entries.size() + _newEntries.size());
+	data.reserve(_entries.size() + _newEntries.size());
+
+	// Copy the still valid old entries out of the mapped file, so that we can overwrite it
+	for (Entries::const_iterator e = _entries.begin(); e != _entries.end(); ++e) {
+		if (_newEntries.find(e->first) != _newEntries.end())
+			continue;
+
+		paths.push_back(e->first);
+		data.push_back(std::vector<byte>(e->second.size));
+
+		if (e->second.size > 0)
+			if (_cache->readAt(e->second.offset, &data.back()[0], e->second.size) != e->second.size)
+				throw Common::Exception(Common::kReadError);
+	}
+
+	for (NewEntries::iterator e = _newEntries.begin(); e != _newEntries.end(); ++e) {
+		paths.push_back(e->first);
+		data.push_back(std::vector<byte>());
+		data.back().swap(e->second);
+	}
+
+	_cache.reset();
+
+	/* Write into a temporary file first and then replace the old cache file with it.
+	 * This way, a crash or a full disk never leaves a truncated cache behind. */
+
+	const Common::UString tmpFile = _file + ".tmp";
+
+	try {
+		Common::WriteFile file(tmpFile);
+
+		file.writeUint32BE(kCacheID);
+		file.writeUint32LE(kCacheVersion);
+		file.writeUint32LE(paths.size());
+
+		for (size_t i = 0; i < paths.size(); i++) {
+			writeString(file, paths[i]);
+
+			file.writeUint32LE(data[i].size());
+			if (!data[i].empty())
+				if (file.write(&data[i][0], data[i].size()) != data[i].size())
+					throw Common::Exception(Common::kWriteError);
+		}
+
+		file.flush();
+		file.close();
+
+		Common::FilePath::renameFile(tmpFile, _file);
+
+	} catch (...) {
+		Common::FilePath::removeFile(tmpFile);
+		throw;
+	}
+}
+
+bool ResourceIndexCache::get(const Common::UString &path, ArchiveType type, Common::HashAlgo hashAlgo,
+                             Tables &tables) {
+
+	Common::ScopedPtr<Common::SeekableReadStream> stream;
+
+	{
+		Common::StackLock lock(_mutex);
+
+		NewEntries::const_iterator newEntry = _newEntries.find(path);
+		if (newEntry != _newEntries.end()) {
+			if (newEntry->second.empty())
+				return false;
+
+			stream.reset(new Common::MemoryReadStream(&newEntry->second[0], newEntry->second.size()));
+		} else {
+			Entries::const_iterator entry = _entries.find(path);
+			if (entry == _entries.end())
+				return false;
+
+			stream.reset(_cache->readStreamAt(entry->second.offset, entry->second.size));
+		}
+
+		/* The stream only stays valid as long as the entry does. Entries are only
+		 * ever added or invalidated, so we read it while holding the lock. */
+
+		bool valid = false;
+		try {
+			valid = readEntry(*stream, type, hashAlgo, tables);
+		} catch (...) {
+		}
+
+		if (valid)
+			return true;
+
+		// Throw out the outdated or broken entry
+		_entries.erase(path);
+		_newEntries.erase(path);
+
+		_changed = true;
+	}
+
+	tables.clear();
+	return false;
+}
+
+void ResourceIndexCache::add(const Common::UString &path, ArchiveType type, Common::HashAlgo hashAlgo,
+                             const Tables &tables) {
+
+	if (!isOpen())
+		return;
+
+	Common::MemoryWriteStreamDynamic stream(true);
+
+	writeFileInfo(stream, path);
+	writeEntry(stream, type, hashAlgo, tables);
+
+	std::vector<byte> data(stream.getData(), stream.getData() + stream.size());
+
+	Common::StackLock lock(_mutex);
+
+	_newEntries[path].swap(data);
+	_changed = true;
+}
+
+bool ResourceIndexCache::readEntry(Common::SeekableReadStream &stream, ArchiveType type,
+                                   Common::HashAlgo hashAlgo, Tables &tables) {
+
+	Common::UString path;
+	readString(stream, path);
+
+	const uint64 size = stream.readUint64LE();
+	const uint64 time = stream.readUint64LE();
+
+	if (((ArchiveType) stream.readUint32LE()) != type)
+		return false;
+	if (((Common::HashAlgo) stream.readSint32LE()) != hashAlgo)
+		return false;
+
+	if (!isUnchanged(path, size, time))
+		return false;
+
+	tables.clear();
+	tables.resize(stream.readUint32LE());
+
+	for (Tables::iterator t = tables.begin(); t != tables.end(); ++t) {
+		readString(stream, t->path);
+
+		const uint64 tableSize = stream.readUint64LE();
+		const uint64 tableTime = stream.readUint64LE();
+
+		if (!isUnchanged(t->path, tableSize, tableTime))
+			return false;
+
+		const uint32 count = stream.readUint32LE();
+		for (uint32 i = 0; i < count; i++) {
+			t->resources.push_back(Archive::Resource());
+			Archive::Resource &res = t->resources.back();
+
+			readString(stream, res.name);
+
+			res.type  = (FileType) stream.readUint32LE();
+			res.hash  = stream.readUint64LE();
+			res.index = stream.readUint32LE();
+		}
+	}
+
+	return true;
+}
+
+void ResourceIndexCache::writeEntry(Common::WriteStream &stream, ArchiveType type,
+                                    Common::HashAlgo hashAlgo, const Tables &tables) {
+
+	stream.writeUint32LE((uint32) type);
+	stream.writeSint32LE((int32) hashAlgo);
+
+	stream.writeUint32LE(tables.size());
+	for (Tables::const_iterator t = tables.begin(); t != tables.end(); ++t) {
+		writeFileInfo(stream, t->path);
+
+		stream.writeUint32LE(t->resources.size());
+		for (Archive::ResourceList::const_iterator r = t->resources.begin(); r != t->resources.end(); ++r) {
+			writeString(stream, r->name);
+			stream.writeUint32LE((uint32) r->type);
+			stream.writeUint64LE(r->hash);
+			stream.writeUint32LE(r->index);
+		}
+	}
+}
+
+void ResourceIndexCache::readString(Common::SeekableReadStream &stream, Common::UString &str) {
+	const uint32 length = stream.readUint32LE();
+	if (length == 0) {
+		str.clear();
+		return;
+	}
+
+	if ((length > kMaxStringLength) || (length > (stream.size() - stream.pos())))
+		throw Common::Exception("Invalid string length %u", length);
+
+	char data[kMaxStringLength];
+	if (stream.read(data, length) != length)
+		throw Common::Exception(Common::kReadError);
+
+	// Construct the string in place, without copying it again
+	Common::UString(data, length).swap(str);
+}
+
+void ResourceIndexCache::writeString(Common::WriteStream &stream, const Common::UString &str) {
+	const size_t length = std::strlen(str.c_str());
+	if (length > kMaxStringLength)
+		throw Common::Exception("String too long (%u)", (uint) length);
+
+	stream.writeUint32LE(length);
+	stream.writeString(str);
+}
+
+void ResourceIndexCache::writeFileInfo(Common::WriteStream &stream, const Common::UString &path) {
+	writeString(stream, path);
+
+	stream.writeUint64LE(Common::FilePath::getFileSize(path));
+	stream.writeUint64LE(Common::FilePath::getModificationTime(path));
+}
+
+bool ResourceIndexCache::isUnchanged(const Common::UString &path, uint64 size, uint64 time) {
+	if (!Common::FilePath::isRegularFile(path))
+		return false;
+
+	return (Common::FilePath::getFileSize(path) == size) &&
+	       (Common::FilePath::getModificationTime(path) == time);
+}
+
+} // End of namespace Aurora
@@ -0,0 +1,159 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A persistent cache of archive resource tables.
+ */
+
+#ifndef AURORA_RESINDEXCACHE_H
+#define AURORA_RESINDEXCACHE_H
+
+#include <vector>
+#include <map>
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/types.h"
+#include "src/common/ustring.h"
+#include "src/common/hash.h"
+#include "src/common/mutex.h"
+#include "src/common/scopedptr.h"
+
+#include "src/aurora/types.h"
+#include "src/aurora/archive.h"
+
+namespace Common {
+	class SeekableReadStream;
+	class WriteStream;
+}
+
+namespace Aurora {
+
+/** A persistent cache of archive resource tables.
+ *
+ *  Reading the resource tables of hundreds of archive files, and hashing
+ *  all the resource names within, takes a noticeable amount of time. This
+ *  cache stores these tables in a compact binary file, so that they can be
+ *  reused the next time, as long as the archive files haven't changed.
+ *
+ *  An archive file counts as unchanged if its size and modification time,
+ *  with the full resolution the filesystem provides, are still the same as
+ *  when its table was stored.
+ *
+ *  The cache file is mapped into memory, and an entry is only read when
+ *  it's requested. get() and add() can be called from several threads.
+ */
+class ResourceIndexCache : boost::noncopyable {
+public:
+	/** The cached resource table of one archive file.
+	 *
+	 *  Most archives consist of a single table. A KEY archive has one table
+	 *  for each of its BIF files instead.
+	 */
+	struct Table {
+		/** The path to the archive file. */
+		Common::UString path;
+
+		/** The resources within the archive, with their names hashed. */
+		Archive::ResourceList resources;
+	};
+
+	typedef std::vector<Table> Tables;
+
+	ResourceIndexCache();
+	~ResourceIndexCache();
+
+	/** Open a cache file.
+	 *
+	 *  If the file doesn't exist or is invalid, we start with an empty cache.
+	 */
+	void open(const Common::UString &file);
+
+	/** Write the cache back into its file, if it changed, and close it. */
+	void close();
+
+	/** Was a cache file opened? */
+	bool isOpen() const;
+
+	/** Get the cached resource tables of an archive file.
+	 *
+	 *  The archive type and the hash algorithm have to be the same as when
+	 *  the tables were stored, and none of the archive files involved may
+	 *  have changed since.
+	 *
+	 *  @param  path The path to the archive file.
+	 *  @param  type The type of the archive.
+	 *  @param  hashAlgo The algorithm the resource names were hashed with.
+	 *  @param  tables The cached tables will be stored here.
+	 *  @return true if valid tables were found, false otherwise.
+	 */
+	bool get(const Common::UString &path, ArchiveType type, Common::HashAlgo hashAlgo, Tables &tables);
+
+	/** Store the resource tables of an archive file.
+	 *
+	 *  @param path The path to the archive file.
+	 *  @param type The type of the archive.
+	 *  @param hashAlgo The algorithm the resource names were hashed with.
+	 *  @param tables The tables to store.
+	 */
+	void add(const Common::UString &path, ArchiveType type, Common::HashAlgo hashAlgo, const Tables &tables);
+
+private:
+	/** An entry within the cache file. */
+	struct Entry {
+		size_t offset; ///< The offset of the entry data within the cache file.
+		size_t size;   ///< The size of the entry data.
+	};
+
+	typedef std::map<Common::UString, Entry> Entries;
+	typedef std::map<Common::UString, std::vector<byte> > NewEntries;
+
+	Common::UString _file; ///< The path of the cache file.
+
+	/** The mapped cache file, if it existed. */
+	Common::ScopedPtr<Common::SeekableReadStream> _cache;
+
+	Entries    _entries;    ///< All valid entries within the cache file.
+	NewEntries _newEntries; ///< All entries added since.
+
+	bool _changed; ///< Did the cache change since it was opened?
+
+	Common::Mutex _mutex;
+
+
+	void readEntries();
+	void save();
+
+	static bool readEntry(Common::SeekableReadStream &stream, ArchiveType type,
+	                      Common::HashAlgo hashAlgo, Tables &tables);
+	static void writeEntry(Common::WriteStream &stream, ArchiveType type,
+	                       Common::HashAlgo hashAlgo, const Tables &tables);
+
+	static void readString(Common::SeekableReadStream &stream, Common::UString &str);
+	static void writeString(Common::WriteStream &stream, const Common::UString &str);
+
+	static void writeFileInfo(Common::WriteStream &stream, const Common::UString &path);
+
+	static bool isUnchanged(const Common::UString &path, uint64 size, uint64 time);
+};
+
+} // End of namespace Aurora
+
+#endif // AURORA_RESINDEXCACHE_H
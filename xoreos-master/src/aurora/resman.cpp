@@ -24,12 +24,17 @@
 
 #include <cassert>
 
+#include <SDL_cpuinfo.h>
+
 #include <boost/scope_exit.hpp>
 
 #include "src/common/util.h"
 #include "src/common/scopedptr.h"
+#include "src/common/ptrvector.h"
+#include "src/common/thread.h"
 #include "src/common/error.h"
 #include "src/common/readstream.h"
+#include "src/common/memreadstream.h"
 #include "src/common/filepath.h"
 #include "src/common/readfile.h"
 #include "src/common/writefile.h"
@@ -93,7 +98,7 @@ void ResourceManager::OpenedArchive::set(KnownArchive &kA, Archive &a) {
 }
 
 
-ResourceManager::Resource::Resource() : type(kFileTypeNone), isSmall(false), priority(0),
+ResourceManager::Resource::Resource() : type(kFileTypeNone), isSmall(false), priority(0), hash(0),
 		source(kSourceNone), archive(0), archiveIndex(0xFFFFFFFF) {
 
 	selfArchive.first = 0;
@@ -104,8 +109,147 @@ bool ResourceManager::Resource::operator<(const Resource &right) const {
 }
 
 
+ResourceManager::LoadedArchives::~LoadedArchives() {
+	for (std::vector<Archive *>::iterator a = archives.begin(); a != archives.end(); ++a)
+		delete *a;
+}
+
+
+/** An archive in a batch, to be loaded by one of the batch threads.
+ *
+ *  This is either an archive we want to index, or one of the BIFs of a KEY.
+ */
+struct ResourceManager::BatchJob : boost::noncopyable {
+	const BatchArchive *archive; ///< The archive we want to index.
+	KnownArchive       *known;   ///< What we know about that archive, if anything.
+
+	const KEYFile *key;      ///< The KEY this BIF belongs to.
+	uint32         keyIndex; ///< The index of this BIF within the KEY.
+
+	LoadedArchives loaded;   ///< The loaded archive(s).
+	bool           isLoaded; ///< Was the archive loaded successfully?
+
+	BatchJob(const BatchArchive &a, KnownArchive *k) : archive(&a), known(k),
+		key(0), keyIndex(0xFFFFFFFF), isLoaded(false) {
+	}
+
+	BatchJob(const KEYFile &kf, uint32 i, KnownArchive &k) : archive(0), known(&k),
+		key(&kf), keyIndex(i), isLoaded(false) {
+	}
+};
+
+/** The jobs of a batch, shared between all batch threads. */
+struct ResourceManager::BatchQueue : boost::noncopyable {
+	Common::PtrVector<BatchJob> jobs;
+
+	size_t        next;  ///< Index of the next job to take.
+	Common::Mutex mutex; ///< Protects next.
+
+	/** Unlocked by every batch thread once it's done. */
+	Common::Semaphore finished;
+
+	BatchQueue() : next(0) {
+	}
+};
+
+/** A thread loading the archives of a batch. */
+class ResourceManager::BatchThread : public Common::Thread {
+public:
+	BatchThread(ResourceManager &resMan, BatchQueue &queue) : _resMan(&resMan), _queue(&queue) {
+	}
+
+	~BatchThread() {
+		destroyThread();
+	}
+
+private:
+	ResourceManager *_resMan;
+	BatchQueue      *_queue;
+
+	void threadMethod() {
+		_resMan->loadBatchJobs(*_queue);
+
+		_queue->finished.unlock();
+	}
+};
+
+/** An archive whose resource table was taken out of the index cache.
+ *
+ *  The real archive is only opened once a resource is requested from it.
+ */
+class ResourceManager::IndexedArchive : public Archive {
+public:
+	IndexedArchive(const ResourceManager &resMan, const KnownArchive &known, ResourceList &resources) :
+		_resMan(&resMan), _known(&known), _hashAlgo(resMan._hashAlgo) {
+
+		_resources.swap(resources);
+	}
+
+	~IndexedArchive() {
+	}
+
+	const ResourceList &getResources() const {
+		return _resources;
+	}
+
+	uint32 getResourceSize(uint32 index) const {
+		return getArchive().getResourceSize(index);
+	}
+
+	bool isResourceDecoded(uint32 index) const {
+		return getArchive().isResourceDecoded(index);
+	}
+
+	Common::SeekableReadStream *getResource(uint32 index, bool tryNoCopy) const {
+		return getArchive().getResource(index, tryNoCopy);
+	}
+
+	/** The cached hashes were created with the resource manager's algorithm. */
+	Common::HashAlgo getNameHashAlgo() const {
+		return _hashAlgo;
+	}
+
+private:
+	const ResourceManager *_resMan;
+	const KnownArchive    *_known;
+
+	ResourceList     _resources;
+	Common::HashAlgo _hashAlgo;
+
+	mutable Common::ScopedPtr<Archive> _archive;
+	mutable Common::Mutex _mutex;
+
+	const Archive &getArchive() const {
+		Common::StackLock lock(_mutex);
+
+		if (!_archive)
+			_archive.reset(_resMan->openArchive(*_known, std::vector<byte>()));
+
+		return *_archive;
+	}
+};
+
+
+ResourceManager::BatchArchive::BatchArchive(const Common::UString &f, uint32 p, Common::ChangeID *c) :
+	file(f), priority(p), changeID(c) {
+
+}
+
+
+ResourceManager::CacheStats::CacheStats() : budget(0), size(0), count(0),
+	hits(0), misses(0), evictions(0) {
+
+}
+
+
+ResourceManager::CachedResource::CachedResource(uint64 h, const boost::shared_array<const byte> &d, size_t s) :
+	hash(h), data(d), size(s) {
+
+}
+
+
 ResourceManager::ResourceManager() : _hasSmall(false),
-	_hashAlgo(Common::kHashFNV64) {
+	_hashAlgo(Common::kHashFNV64), _cacheGeneration(0), _changeCount(0) {
 
 	// These file types are archives
 
@@ -197,6 +341,8 @@ void ResourceManager::clearResources() {
 	_resources.clear();
 
 	_changes.clear();
+
+	flushCache();
 }
 
 void ResourceManager::setRIMsAreERFs(bool rimsAreERFs) {
@@ -288,7 +434,14 @@ Common::SeekableReadStream *ResourceManager::openArchiveStream(const KnownArchiv
 	if (!archive.resource)
 		throw Common::Exception("Archive without resource reference");
 
-	return getResource(*archive.resource, true);
+	/* Map archives found directly on disk into memory. That way, their
+	 * uncompressed resources can be handed out as views into the mapping,
+	 * without allocating and copying. */
+	const Resource &res = *archive.resource;
+	if ((res.source == kSourceFile) && !res.isSmall)
+		return new Common::ReadFile(res.path, true);
+
+	return getResource(res, true);
 }
 
 void ResourceManager::indexArchive(const Common::UString &file, uint32 priority,
@@ -305,99 +458,342 @@ void ResourceManager::indexArchive(const Common::UString &file, uint32 priority,
 	if (changeID)
 		change = newChangeSet(*changeID);
 
-	Common::SeekableReadStream *archiveStream = openArchiveStream(*knownArchive);
+	LoadedArchives loaded;
+	loadArchive(*knownArchive, password, loaded);
+
+	indexArchives(loaded, priority, change);
+}
 
-	Common::ScopedPtr<Archive> archive;
-	switch (knownArchive->type) {
-		case kArchiveKEY:
-			indexKEY(archiveStream, priority, change);
+void ResourceManager::indexArchive(const Common::UString &file, uint32 priority, Common::ChangeID *changeID) {
+	std::vector<byte> password;
+
+	indexArchive(file, priority, password, changeID);
+}
+
+void ResourceManager::indexArchives(const std::vector<BatchArchive> &archives) {
+	size_t start = 0;
+	while (start < archives.size()) {
+		BatchQueue queue;
+
+		/* Collect all archives we already know about. An archive we don't know yet
+		 * might be contained in one of the archives in front of it, so we have to
+		 * index those first. */
+		size_t end = start;
+		for (; end < archives.size(); end++) {
+			KnownArchive *knownArchive = findArchive(archives[end].file);
+			if (!knownArchive && (end > start))
+				break;
+
+			queue.jobs.push_back(new BatchJob(archives[end], knownArchive));
+		}
+
+		// Open and read the archives in parallel
+		loadBatch(queue);
+
+		// Index them in order
+		for (Common::PtrVector<BatchJob>::iterator j = queue.jobs.begin(); j != queue.jobs.end(); ++j) {
+			const BatchArchive &archive = *(*j)->archive;
+
+			try {
+				/* Archives that couldn't be loaded in parallel are indexed the normal way.
+				 * This also throws the same errors a normal indexArchive() call would. */
+				if (!(*j)->isLoaded) {
+					indexArchive(archive.file, archive.priority, archive.password, archive.changeID);
+					continue;
+				}
+
+				Change *change = 0;
+				if (archive.changeID)
+					change = newChangeSet(*archive.changeID);
+
+				indexArchives((*j)->loaded, archive.priority, change);
+
+			} catch (Common::Exception &e) {
+				e.add("Failed to index archive \"%s\"", archive.file.c_str());
+				throw;
+			}
+		}
+
+		start = end;
+	}
+}
+
+void ResourceManager::loadBatch(BatchQueue &queue) {
+	// The calling thread works on the queue as well
+	const size_t threadCount = MIN<size_t>(MAX(SDL_GetCPUCount(), 1), queue.jobs.size()) - 1;
+
+	Common::PtrVector<BatchThread> threads;
+	threads.reserve(threadCount);
+
+	for (size_t i = 0; i < threadCount; i++) {
+		threads.push_back(new BatchThread(*this, queue));
+
+		if (!threads.back()->createThread("ResIndex")) {
+			threads.pop_back();
 			break;
+		}
+	}
+
+	loadBatchJobs(queue);
+
+	// Wait for all threads to finish
+	for (size_t i = 0; i < threads.size(); i++)
+		queue.finished.lock();
+}
+
+void ResourceManager::loadBatchJobs(BatchQueue &queue) {
+	while (true) {
+		BatchJob *job = 0;
+
+		{
+			Common::StackLock lock(queue.mutex);
+
+			if (queue.next >= queue.jobs.size())
+				break;
+
+			job = queue.jobs[queue.next++];
+		}
+
+		/* Only archives that are plain files can be read safely from several
+		 * threads. Everything else is left to be indexed the normal way. */
+		if (!job->known || !job->known->resource || (job->known->resource->source != kSourceFile))
+			continue;
+
+		// Lone BIFs can only be indexed through their KEY
+		if (!job->key && (job->known->type == kArchiveBIF))
+			continue;
+
+		try {
+			if (job->key)
+				openKEYBIF(*job->key, job->keyIndex, *job->known, job->loaded);
+			else
+				loadArchive(*job->known, job->archive->password, job->loaded);
+
+			job->isLoaded = true;
+		} catch (...) {
+			// Try again later, in order, to throw the error in the right place
+		}
+	}
+}
+
+void ResourceManager::loadArchive(KnownArchive &knownArchive, const std::vector<byte> &password,
+                                  LoadedArchives &loaded) {
+
+	// We can't cache the contents of encrypted archives
+	const bool cacheable = password.empty() && isIndexCacheable(knownArchive);
+	if (cacheable && loadCachedArchive(knownArchive, loaded))
+		return;
+
+	const size_t start = loaded.archives.size();
+
+	if (knownArchive.type == kArchiveKEY) {
+		openKEYBIFs(openArchiveStream(knownArchive), loaded);
+	} else {
+		Common::ScopedPtr<Archive> archive(openArchive(knownArchive, password));
+
+		loaded.known.push_back(&knownArchive);
+		loaded.archives.push_back(archive.get());
+
+		archive.release();
+	}
+
+	if (cacheable)
+		cacheArchive(knownArchive, loaded, start);
+}
+
+Archive *ResourceManager::openArchive(const KnownArchive &knownArchive,
+                                      const std::vector<byte> &password) const {
+
+	Common::SeekableReadStream *archiveStream = openArchiveStream(knownArchive);
+
+	switch (knownArchive.type) {
+		case kArchiveBIF:
+			return new BIFFile(archiveStream);
 
 		case kArchiveNDS:
-			archive.reset(new NDSFile(archiveStream));
-			break;
+			return new NDSFile(archiveStream);
 
 		case kArchiveHERF:
-			archive.reset(new HERFFile(archiveStream));
-			break;
+			return new HERFFile(archiveStream);
 
 		case kArchiveERF:
-			archive.reset(new ERFFile(archiveStream, password));
-			break;
+			return new ERFFile(archiveStream, password);
 
 		case kArchiveRIM:
-			archive.reset(new RIMFile(archiveStream));
-			break;
+			return new RIMFile(archiveStream);
 
 		case kArchiveZIP:
-			archive.reset(new ZIPFile(archiveStream));
-			break;
+			return new ZIPFile(archiveStream);
 
 		case kArchiveEXE:
-			archive.reset(new PEFile(archiveStream, _cursorRemap));
-			break;
+			return new PEFile(archiveStream, _cursorRemap);
 
 		case kArchiveNSBTX:
-			archive.reset(new NSBTXFile(archiveStream));
-			break;
+			return new NSBTXFile(archiveStream);
 
 		default:
-			throw Common::Exception("Invalid archive type %d", knownArchive->type);
+			break;
 	}
 
-	if (archive)
-		indexArchive(*knownArchive, archive.release(), priority, change);
+	delete archiveStream;
+	throw Common::Exception("Invalid archive type %d", knownArchive.type);
 }
 
-void ResourceManager::indexArchive(const Common::UString &file, uint32 priority, Common::ChangeID *changeID) {
-	std::vector<byte> password;
+void ResourceManager::openKEYBIFs(Common::SeekableReadStream *keyStream, LoadedArchives &loaded) {
+	Common::ScopedPtr<Common::SeekableReadStream> stream(keyStream);
+	KEYFile key(*keyStream);
 
-	indexArchive(file, priority, password, changeID);
+	const KEYFile::BIFList &keyBIFs = key.getBIFs();
+
+	BatchQueue queue;
+	queue.jobs.reserve(keyBIFs.size());
+
+	for (uint32 i = 0; i < keyBIFs.size(); i++) {
+		KnownArchive *knownBIF = findArchive(keyBIFs[i], _knownArchives[kArchiveBIF]);
+		if (!knownBIF)
+			throw Common::Exception("BIF \"%s\" not found", keyBIFs[i].c_str());
+
+		queue.jobs.push_back(new BatchJob(key, i, *knownBIF));
+	}
+
+	// Open and read the BIFs in parallel
+	loadBatch(queue);
+
+	loaded.known.reserve(loaded.known.size() + keyBIFs.size());
+	loaded.archives.reserve(loaded.archives.size() + keyBIFs.size());
+
+	// Collect them in order
+	for (Common::PtrVector<BatchJob>::iterator j = queue.jobs.begin(); j != queue.jobs.end(); ++j) {
+		/* BIFs that couldn't be loaded in parallel are opened here.
+		 * This also throws the errors in the right order. */
+		if (!(*j)->isLoaded) {
+			openKEYBIF(key, (*j)->keyIndex, *(*j)->known, loaded);
+			continue;
+		}
+
+		loaded.known.push_back((*j)->loaded.known.front());
+		loaded.archives.push_back((*j)->loaded.archives.front());
+
+		(*j)->loaded.archives.clear();
+	}
+}
+
+void ResourceManager::openKEYBIF(const KEYFile &key, uint32 index, KnownArchive &knownBIF,
+                                 LoadedArchives &loaded) const {
+
+	Common::ScopedPtr<BIFFile> bif(new BIFFile(openArchiveStream(knownBIF)));
+	bif->mergeKEY(key, index);
+
+	loaded.known.push_back(&knownBIF);
+	loaded.archives.push_back(bif.get());
+
+	bif.release();
+}
+
+void ResourceManager::openIndexCache(const Common::UString &file) {
+	_indexCache.open(file);
+}
+
+void ResourceManager::closeIndexCache() {
+	_indexCache.close();
+}
+
+bool ResourceManager::isIndexCacheable(const KnownArchive &knownArchive) const {
+	if (!_indexCache.isOpen())
+		return false;
+
+	// Only archives found directly on disk can be checked for changes
+	if (!knownArchive.resource || (knownArchive.resource->source != kSourceFile) || knownArchive.resource->isSmall)
+		return false;
+
+	// The contents of EXE files depend on the cursor remap
+	return knownArchive.type != kArchiveEXE;
 }
 
-uint32 ResourceManager::openKEYBIFs(Common::SeekableReadStream *keyStream,
-                                    std::vector<KnownArchive *> &archives,
-                                    std::vector<BIFFile *> &bifs) {
+bool ResourceManager::loadCachedArchive(KnownArchive &knownArchive, LoadedArchives &loaded) {
+	ResourceIndexCache::Tables tables;
+	if (!_indexCache.get(knownArchive.resource->path, knownArchive.type, _hashAlgo, tables))
+		return false;
+
+	// Find the archive files the tables belong to
+	std::vector<KnownArchive *> known;
+	known.reserve(tables.size());
+
+	if (knownArchive.type == kArchiveKEY) {
+		/* The KEY file itself didn't change, so it still references the same BIFs.
+		 * We only need to make sure that we still know those BIFs as well. */
+		KnownArchives &bifs = _knownArchives[kArchiveBIF];
+
+		for (ResourceIndexCache::Tables::const_iterator t = tables.begin(); t != tables.end(); ++t) {
+			KnownArchive *knownBIF = 0;
+			for (KnownArchives::iterator b = bifs.begin(); b != bifs.end(); ++b) {
+				if (isIndexCacheable(*b) && (b->resource->path == t->path)) {
+					knownBIF = &*b;
+					break;
+				}
+			}
 
-	bool success = false;
-	BOOST_SCOPE_EXIT( (&success) (&archives) (&bifs) ) {
-		if (!success) {
-			for (std::vector<BIFFile *>::iterator b = bifs.begin(); b != bifs.end(); ++b)
-				delete *b;
+			if (!knownBIF)
+				return false;
 
-			bifs.clear();
-			archives.clear();
+			known.push_back(knownBIF);
 		}
-	} BOOST_SCOPE_EXIT_END
 
-	Common::ScopedPtr<Common::SeekableReadStream> stream(keyStream);
-	KEYFile key(*keyStream);
+	} else {
+		if ((tables.size() != 1) || (tables[0].path != knownArchive.resource->path))
+			return false;
 
-	const KEYFile::BIFList &keyBIFs = key.getBIFs();
-	archives.resize(keyBIFs.size(), 0);
-	bifs.resize(keyBIFs.size(), 0);
+		known.push_back(&knownArchive);
+	}
 
-	for (uint32 i = 0; i < keyBIFs.size(); i++) {
-		archives[i] = findArchive(keyBIFs[i], _knownArchives[kArchiveBIF]);
-		if (!archives[i])
-			throw Common::Exception("BIF \"%s\" not found", keyBIFs[i].c_str());
+	loaded.known.reserve(loaded.known.size() + known.size());
+	loaded.archives.reserve(loaded.archives.size() + known.size());
 
-		bifs[i] = new BIFFile(openArchiveStream(*archives[i]));
-		bifs[i]->mergeKEY(key, i);
+	for (size_t i = 0; i < known.size(); i++) {
+		Common::ScopedPtr<Archive> archive(new IndexedArchive(*this, *known[i], tables[i].resources));
+
+		loaded.known.push_back(known[i]);
+		loaded.archives.push_back(archive.release());
 	}
 
-	success = true;
-	return archives.size();
+	return true;
 }
 
-void ResourceManager::indexKEY(Common::SeekableReadStream *stream, uint32 priority, Change *change) {
-	std::vector<KnownArchive *> archives;
-	std::vector<BIFFile *> bifs;
+void ResourceManager::cacheArchive(const KnownArchive &knownArchive, const LoadedArchives &loaded, size_t start) {
+	ResourceIndexCache::Tables tables(loaded.archives.size() - start);
+
+	for (size_t i = 0; i < tables.size(); i++) {
+		const KnownArchive &known   = *loaded.known[start + i];
+		const Archive      &archive = *loaded.archives[start + i];
+
+		// A KEY file can reference BIFs that aren't found directly on disk
+		if (!isIndexCacheable(known))
+			return;
+
+		const Common::HashAlgo hashAlgo = archive.getNameHashAlgo();
+		if ((hashAlgo != Common::kHashNone) && (hashAlgo != _hashAlgo))
+			return;
+
+		tables[i].path      = known.resource->path;
+		tables[i].resources = archive.getResources();
 
-	const uint32 count = openKEYBIFs(stream, archives, bifs);
+		// Store the hashes we'd otherwise calculate when indexing
+		if (hashAlgo == Common::kHashNone)
+			for (Archive::ResourceList::iterator r = tables[i].resources.begin(); r != tables[i].resources.end(); ++r)
+				r->hash = getHash(r->name, r->type);
+	}
+
+	_indexCache.add(knownArchive.resource->path, knownArchive.type, _hashAlgo, tables);
+}
+
+void ResourceManager::indexArchives(LoadedArchives &loaded, uint32 priority, Change *change) {
+	for (size_t i = 0; i < loaded.archives.size(); i++) {
+		// indexArchive() takes over the archive
+		Archive *archive = loaded.archives[i];
+		loaded.archives[i] = 0;
 
-	for (uint32 i = 0; i < count; i++)
-		indexArchive(*archives[i], bifs[i], priority, change);
+		indexArchive(*loaded.known[i], archive, priority, change);
+	}
 }
 
 void ResourceManager::indexArchive(KnownArchive &knownArchive, Archive *archive,
@@ -588,6 +984,9 @@ void ResourceManager::undo(Common::ChangeID &changeID) {
 	// Now we can remove the change set from our list of change sets
 	_changes.erase(change->_change);
 
+	// Cached resources might have come from the removed archives
+	flushCache();
+
 	// And finally set the change ID to a defined empty state
 	changeID.clear();
 }
@@ -603,6 +1002,8 @@ void ResourceManager::blacklist(const Common::UString &name, FileType type) {
 
 	for (ResourceList::iterator res = resList->second.begin(); res != resList->second.end(); ++res)
 		res->priority = 0;
+
+	uncacheResource(resList->first);
 }
 
 void ResourceManager::declareResource(const Common::UString &name, FileType type) {
@@ -628,6 +1029,8 @@ void ResourceManager::declareResource(const Common::UString &name, FileType type
 
 		checkResourceIsArchive(*r, 0);
 	}
+
+	uncacheResource(resList->first);
 }
 
 void ResourceManager::declareResource(const Common::UString &name) {
@@ -701,6 +1104,17 @@ uint32 ResourceManager::getResourceSize(const Resource &res) const {
 	return 0xFFFFFFFF;
 }
 
+bool ResourceManager::isResourceDecoded(const Resource &res) const {
+	if (res.isSmall)
+		return true;
+
+	if ((res.source != kSourceArchive) || (res.archive == 0) || (res.archive->archive == 0) ||
+	    (res.archiveIndex == 0xFFFFFFFF))
+		return false;
+
+	return res.archive->archive->isResourceDecoded(res.archiveIndex);
+}
+
 Common::SeekableReadStream *ResourceManager::getArchiveResource(const Resource &res, bool tryNoCopy) const {
 	if ((res.archive == 0) || (res.archive->archive == 0) || (res.archiveIndex == 0xFFFFFFFF))
 		throw Common::Exception("Archive resource has no archive");
@@ -731,7 +1145,7 @@ Common::SeekableReadStream *ResourceManager::getResource(const Common::UString &
 	if (foundType)
 		*foundType = res->type;
 
-	return getResource(*res);
+	return getCachedResource(*res);
 }
 
 Common::SeekableReadStream *ResourceManager::getResource(uint64 hash, FileType *type) const {
@@ -743,7 +1157,7 @@ Common::SeekableReadStream *ResourceManager::getResource(uint64 hash, FileType *
 	if (type)
 		*type = res->type;
 
-	return getResource(*res);
+	return getCachedResource(*res);
 }
 
 Common::SeekableReadStream *ResourceManager::getResource(const Resource &res, bool tryNoCopy) const {
@@ -784,6 +1198,151 @@ Common::SeekableReadStream *ResourceManager::getResource(ResourceType resType,
 	return 0;
 }
 
+void ResourceManager::setCacheSize(size_t size) {
+	Common::StackLock lock(_cacheMutex);
+
+	_cacheStats.budget = size;
+
+	evictCache();
+}
+
+uint32 ResourceManager::getChangeCount() const {
+	return _changeCount;
+}
+
+void ResourceManager::getCacheStats(CacheStats &stats) const {
+	Common::StackLock lock(_cacheMutex);
+
+	stats = _cacheStats;
+}
+
+void ResourceManager::clearCache() {
+	flushCache();
+
+	Common::StackLock lock(_cacheMutex);
+
+	_cacheStats.hits      = 0;
+	_cacheStats.misses    = 0;
+	_cacheStats.evictions = 0;
+}
+
+void ResourceManager::flushCache() {
+	_changeCount++;
+
+	Common::StackLock lock(_cacheMutex);
+
+	_cache.clear();
+	_cacheMap.clear();
+
+	_cacheStats.size  = 0;
+	_cacheStats.count = 0;
+
+	_cacheGeneration++;
+}
+
+void ResourceManager::uncacheResource(uint64 hash) {
+	_changeCount++;
+
+	Common::StackLock lock(_cacheMutex);
+
+	ResourceCacheMap::iterator cached = _cacheMap.find(hash);
+	if (cached == _cacheMap.end())
+		return;
+
+	_cacheStats.size -= cached->second->size;
+	_cacheStats.count--;
+
+	_cache.erase(cached->second);
+	_cacheMap.erase(cached);
+}
+
+void ResourceManager::evictCache() const {
+	// Needs to be called with _cacheMutex locked
+
+	while ((_cacheStats.size > _cacheStats.budget) && !_cache.empty()) {
+		const CachedResource &lru = _cache.back();
+
+		_cacheStats.size -= lru.size;
+		_cacheStats.count--;
+		_cacheStats.evictions++;
+
+		_cacheMap.erase(lru.hash);
+		_cache.pop_back();
+	}
+}
+
+Common::SeekableReadStream *ResourceManager::getCachedResource(const Resource &res) const {
+	/* Resources that would take up more than this fraction of the cache
+	 * are never cached, so that one big resource can't wipe the whole cache. */
+	static const size_t kMaxCacheFraction = 4;
+
+	/* Plain resources are not worth caching: reading them again is as fast as
+	 * copying them out of the cache, often straight from a memory-mapped archive. */
+	if (!isResourceDecoded(res))
+		return getResource(res);
+
+	size_t maxSize    = 0;
+	uint32 generation = 0;
+
+	{
+		Common::StackLock lock(_cacheMutex);
+
+		ResourceCacheMap::iterator cached = _cacheMap.find(res.hash);
+		if (cached != _cacheMap.end()) {
+			// Move the resource to the front of the LRU list
+			_cache.splice(_cache.begin(), _cache, cached->second);
+
+			_cacheStats.hits++;
+
+			return new Common::SharedMemoryReadStream(cached->second->data, cached->second->size);
+		}
+
+		if (_cacheStats.budget > 0) {
+			_cacheStats.misses++;
+
+			maxSize    = _cacheStats.budget / kMaxCacheFraction;
+			generation = _cacheGeneration;
+		}
+	}
+
+	// Don't even try to cache resources that are obviously too big (or of unknown size)
+	if ((maxSize == 0) || (!res.isSmall && (getResourceSize(res) > maxSize)))
+		return getResource(res);
+
+	Common::ScopedPtr<Common::SeekableReadStream> stream(getResource(res));
+
+	const size_t size = stream->size();
+	if (size > maxSize)
+		return stream.release();
+
+	/* Take over the buffer the decoder has filled. If there is none (an uncompressed
+	 * "small" file is only wrapped, for example), nothing was decoded after all. */
+	Common::MemoryReadStream *memStream = dynamic_cast<Common::MemoryReadStream *>(stream.get());
+	const byte *buffer = memStream ? memStream->takeData() : 0;
+	if (!buffer)
+		return stream.release();
+
+	boost::shared_array<const byte> data(buffer);
+
+	stream.reset();
+
+	Common::StackLock lock(_cacheMutex);
+
+	/* Only add the resource if the cache hasn't been flushed in the meantime,
+	 * and no other thread has added the same resource already. */
+	if ((generation == _cacheGeneration) && (_cacheMap.find(res.hash) == _cacheMap.end())) {
+		_cache.push_front(CachedResource(res.hash, data, size));
+		_cacheMap.insert(std::make_pair(res.hash, _cache.begin()));
+
+		_cacheStats.size += size;
+		_cacheStats.count++;
+
+		evictCache();
+	}
+
+	return new Common::SharedMemoryReadStream(data, size);
+}
+
 void ResourceManager::getAvailableResources(FileType type,
 		std::list<ResourceID> &list) const {
 
@@ -938,6 +1497,11 @@ bool ResourceManager::checkResourceIsArchive(Resource &resource, Change *change)
 }
 
 void ResourceManager::addResource(Resource &resource, uint64 hash, Change *change) {
+	resource.hash = hash;
+
+	// A new resource might override one we already have cached
+	uncacheResource(hash);
+
 	ResourceMap::iterator resList = _resources.find(hash);
 	if (resList == _resources.end()) {
 		// We don't have a resource with this name yet, create a new resource list for it
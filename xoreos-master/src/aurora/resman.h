@@ -30,14 +30,20 @@
 #include <map>
 #include <set>
 
+#include <boost/noncopyable.hpp>
+#include <boost/shared_array.hpp>
+
 #include "src/common/types.h"
 #include "src/common/ustring.h"
 #include "src/common/singleton.h"
 #include "src/common/filelist.h"
 #include "src/common/hash.h"
 #include "src/common/changeid.h"
+#include "src/common/mutex.h"
+#include "src/common/atomic.h"
 
 #include "src/aurora/types.h"
+#include "src/aurora/resindexcache.h"
 
 namespace Common {
 	class SeekableReadStream;
@@ -51,6 +57,11 @@ class BIFFile;
 
 /** A resource manager holding information about and handling all request for all
  *  resources usable by the game.
+ *
+ *  While the index is not modified (i.e. no archives or directories are indexed
+ *  or removed), getResource() can be called from several threads at once. The
+ *  BIF, BZF, ERF, RIM, HERF and NDS archives read their resources with positional
+ *  reads that never touch the shared stream position.
  */
 class ResourceManager : public Common::Singleton<ResourceManager> {
 public:
@@ -60,6 +71,16 @@ public:
 		uint64 hash;
 	};
 
+	/** An archive to be indexed as part of a batch, see indexArchives(). */
+	struct BatchArchive {
+		Common::UString   file;     ///< The name of the archive file to index.
+		uint32            priority; ///< The priority of the archive's resources.
+		std::vector<byte> password; ///< Use this password to decrypt the archive file, if necessary.
+		Common::ChangeID *changeID; ///< If given, record the changes done by this archive here.
+
+		BatchArchive(const Common::UString &f = "", uint32 p = 0, Common::ChangeID *c = 0);
+	};
+
 	ResourceManager();
 	~ResourceManager();
 
@@ -135,6 +156,33 @@ public:
 	 */
 	void indexArchive(const Common::UString &file, uint32 priority, const std::vector<byte> &password,
 	                  Common::ChangeID *changeID = 0);
+
+	/** Add all the resources of several archives to the resource manager.
+	 *
+	 *  The archive files are opened and their resource tables read in parallel,
+	 *  on several threads. The resources are then added in the order of the list,
+	 *  so the result is the same as calling indexArchive() on each archive in turn.
+	 *
+	 *  @param archives The archives to index.
+	 */
+	void indexArchives(const std::vector<BatchArchive> &archives);
+	// '---
+
+	// .--- Index cache
+	/** Use a persistent cache for the resource tables of archive files.
+	 *
+	 *  Archives found directly on disk will have their resource tables stored
+	 *  in this cache file. As long as an archive file doesn't change, indexing
+	 *  it again later, even in a later run, will use the cached table instead
+	 *  of opening and reading the archive. The archive itself is then only
+	 *  opened once one of its resources is actually requested.
+	 *
+	 *  @param file The cache file to use. It will be created if necessary.
+	 */
+	void openIndexCache(const Common::UString &file);
+
+	/** Write the index cache back into its file, and stop using it. */
+	void closeIndexCache();
 	// '---
 
 	// .--- Directories and files
@@ -338,6 +386,46 @@ public:
 	/** Dump a list of all resources into a file. */
 	void dumpResourcesList(const Common::UString &fileName) const;
 
+	/** Return a counter that changes every time the available resources change.
+	 *
+	 *  Data derived from resources that was created while this counter had a
+	 *  different value might be stale, and should be created anew.
+	 */
+	uint32 getChangeCount() const;
+
+	// .--- Resource cache
+	/** Statistics of the decoded resource cache. */
+	struct CacheStats {
+		size_t budget; ///< The maximum number of bytes the cache may hold.
+		size_t size;   ///< The number of bytes currently held.
+		size_t count;  ///< The number of resources currently held.
+
+		uint64 hits;      ///< Number of requests served from the cache.
+		uint64 misses;    ///< Number of requests that had to read the resource.
+		uint64 evictions; ///< Number of resources dropped to stay within the budget.
+
+		CacheStats();
+	};
+
+	/** Set the size of the decoded resource cache, in bytes.
+	 *
+	 *  The cache keeps the decoded data of recently requested compressed,
+	 *  encrypted or converted resources around, so that repeated requests for
+	 *  the same resource don't have to decode it again. Plain resources are
+	 *  never cached, since reading them again is just as fast. When the cache
+	 *  is full, the least recently used resources are dropped.
+	 *
+	 *  A size of 0 disables the cache. By default, the cache is disabled.
+	 */
+	void setCacheSize(size_t size);
+
+	/** Return the statistics of the decoded resource cache. */
+	void getCacheStats(CacheStats &stats) const;
+
+	/** Drop all resources from the decoded resource cache and reset its statistics. */
+	void clearCache();
+	// '---
+
 
 private:
 	typedef std::vector<FileType> FileTypeList;
@@ -382,6 +470,20 @@ private:
 	typedef std::list<KnownArchive> KnownArchives;
 	/** List of all opened archive files. */
 	typedef std::list<OpenedArchive> OpenedArchives;
+
+	/** Archives that have been opened and read, but not yet indexed. */
+	struct LoadedArchives : boost::noncopyable {
+		std::vector<KnownArchive *> known;    ///< What we know about these archives.
+		std::vector<Archive *>      archives; ///< The opened archives.
+
+		~LoadedArchives();
+	};
+
+	struct BatchJob;
+	struct BatchQueue;
+	class BatchThread;
+
+	class IndexedArchive;
 	// '---
 
 	// .--- Resources
@@ -403,6 +505,9 @@ private:
 		/** The resource's priority over others with the same name and type. */
 		uint32 priority;
 
+		/** The hash this resource is indexed under. */
+		uint64 hash;
+
 		/** The archive this resource itself is. */
 		std::pair<KnownArchives *, KnownArchives::iterator> selfArchive;
 
@@ -466,6 +571,23 @@ private:
 	};
 	// '---
 
+	// .--- Resource cache
+	/** A resource held in the decoded resource cache. */
+	struct CachedResource {
+		uint64 hash; ///< The hash of the resource.
+
+		boost::shared_array<const byte> data; ///< The decoded data.
+		size_t size;                          ///< The size of the decoded data.
+
+		CachedResource(uint64 h, const boost::shared_array<const byte> &d, size_t s);
+	};
+
+	/** List of cached resources, most recently used first. */
+	typedef std::list<CachedResource> ResourceCache;
+	/** Map over the cached resources, indexed by their hash. */
+	typedef std::map<uint64, ResourceCache::iterator> ResourceCacheMap;
+	// '---
+
 
 	/** Do we have "small" files? */
 	bool _hasSmall;
@@ -493,6 +615,22 @@ private:
 	FileTypeSet  _archiveTypeTypes [kArchiveMAX];  ///< All valid archive types file types.
 	FileTypeList _resourceTypeTypes[kResourceMAX]; ///< All valid resource type file types.
 
+	mutable ResourceCache    _cache;      ///< The decoded resource cache.
+	mutable ResourceCacheMap _cacheMap;   ///< Cached resources, indexed by their hash.
+	mutable CacheStats       _cacheStats; ///< Statistics of the decoded resource cache.
+
+	/** Incremented every time the cache is flushed, to catch stale decodes. */
+	mutable uint32 _cacheGeneration;
+
+	/** Protects the decoded resource cache. */
+	mutable Common::Mutex _cacheMutex;
+
+	/** Incremented every time resources are added, removed or changed. */
+	boost::atomic<uint32> _changeCount;
+
+	/** The persistent cache of archive resource tables. */
+	ResourceIndexCache _indexCache;
+
 
 	void clearResources();
 
@@ -502,14 +640,24 @@ private:
 	// '---
 
 	// .--- Indexing archives
-	void indexKEY(Common::SeekableReadStream *stream, uint32 priority, Change *change);
-	uint32 openKEYBIFs(Common::SeekableReadStream *keyStream,
-	                   std::vector<KnownArchive *> &archives, std::vector<BIFFile *> &bifs);
+	void openKEYBIFs(Common::SeekableReadStream *keyStream, LoadedArchives &loaded);
+	void openKEYBIF(const KEYFile &key, uint32 index, KnownArchive &knownBIF, LoadedArchives &loaded) const;
+
+	void loadArchive(KnownArchive &knownArchive, const std::vector<byte> &password, LoadedArchives &loaded);
+
+	bool isIndexCacheable(const KnownArchive &knownArchive) const;
+	bool loadCachedArchive(KnownArchive &knownArchive, LoadedArchives &loaded);
+	void cacheArchive(const KnownArchive &knownArchive, const LoadedArchives &loaded, size_t start);
 
 	void indexArchive(KnownArchive &knownArchive, Archive *archive,
 	                  uint32 priority, Change *change);
+	void indexArchives(LoadedArchives &loaded, uint32 priority, Change *change);
+
+	void loadBatch(BatchQueue &queue);
+	void loadBatchJobs(BatchQueue &queue);
 
 	Common::SeekableReadStream *openArchiveStream(const KnownArchive &archive) const;
+	Archive *openArchive(const KnownArchive &knownArchive, const std::vector<byte> &password) const;
 	// '---
 
 	// .--- Adding resources
@@ -532,6 +680,16 @@ private:
 	Common::SeekableReadStream *getArchiveResource(const Resource &res, bool tryNoCopy = false) const;
 
 	uint32 getResourceSize(const Resource &res) const;
+
+	bool isResourceDecoded(const Resource &res) const;
+	// '---
+
+	// .--- Caching resources
+	Common::SeekableReadStream *getCachedResource(const Resource &res) const;
+
+	void uncacheResource(uint64 hash);
+	void flushCache();
+	void evictCache() const;
 	// '---
 
 	// .--- Resource utility methods
@@ -111,9 +111,7 @@ Common::SeekableReadStream *RIMFile::getResource(uint32 index, bool tryNoCopy) c
 	if (tryNoCopy)
 		return new Common::SeekableSubReadStream(_rim.get(), res.offset, res.offset + res.size);
 
-	_rim->seek(res.offset);
-
-	return _rim->readStream(res.size);
+	return _rim->readStreamAt(res.offset, res.size);
 }
 
 } // End of namespace Aurora
@@ -36,6 +36,7 @@ src_aurora_libaurora_la_SOURCES += \
     src/aurora/rimfile.h \
     src/aurora/ndsrom.h \
     src/aurora/zipfile.h \
+    src/aurora/resindexcache.h \
     src/aurora/resman.h \
     src/aurora/talktable.h \
     src/aurora/talktable_tlk.h \
@@ -75,6 +76,7 @@ src_aurora_libaurora_la_SOURCES += \
     src/aurora/rimfile.cpp \
     src/aurora/ndsrom.cpp \
     src/aurora/zipfile.cpp \
+    src/aurora/resindexcache.cpp \
     src/aurora/resman.cpp \
     src/aurora/talktable.cpp \
     src/aurora/talktable_tlk.cpp \
@@ -37,7 +37,7 @@ DECLARE_SINGLETON(Aurora::TalkManager)
 
 namespace Aurora {
 
-TalkManager::TalkManager() {
+TalkManager::TalkManager() : _decodeMode(kDecodeLazy) {
 }
 
 TalkManager::~TalkManager() {
@@ -54,6 +54,10 @@ void TalkManager::clear() {
 	_tablesAlt.clear();
 }
 
+void TalkManager::setDecodeMode(DecodeMode mode) {
+	_decodeMode = mode;
+}
+
 static TalkTable *loadTable(const Common::UString &name, Common::Encoding encoding) {
 	if (name.empty())
 		return 0;
@@ -84,6 +88,15 @@ void TalkManager::addTable(const Common::UString &nameMale, const Common::UStrin
 	if (!tableMale && !tableFemale)
 		throw Common::Exception("No such talk table \"%s\"/\"%s\"", nameMale.c_str(), nameFemale.c_str());
 
+	if (_decodeMode != kDecodeLazy) {
+		const bool background = _decodeMode == kDecodeBackground;
+
+		if (tableMale)
+			tableMale->preDecode(background);
+		if (tableFemale)
+			tableFemale->preDecode(background);
+	}
+
 	Tables *tables = &_tablesMain;
 	if (isAlt)
 		tables = &_tablesAlt;
@@ -41,11 +41,21 @@ class TalkTable;
 /** The global Aurora talk manager, holding the current talk tables. */
 class TalkManager : public Common::Singleton<TalkManager> {
 public:
+	/** When to decode the strings of a talk table. */
+	enum DecodeMode {
+		kDecodeLazy,      ///< Decode each string when it's first looked up.
+		kDecodeLoad,      ///< Decode all strings when the talk table is added.
+		kDecodeBackground ///< Decode all strings in a background thread.
+	};
+
 	TalkManager();
 	~TalkManager();
 
 	void clear();
 
+	/** Set when to decode the strings of talk tables added from now on. */
+	void setDecodeMode(DecodeMode mode);
+
 	/** Add a talk table to the talk manager.
 	 *
 	 *  @param nameMale   Resource name of the male version.
@@ -98,6 +108,8 @@ private:
 	Tables _tablesMain;
 	Tables _tablesAlt;
 
+	DecodeMode _decodeMode;
+
 
 	void deleteTable(Table &table);
 
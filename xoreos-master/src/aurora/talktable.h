@@ -60,6 +60,14 @@ public:
 
 	virtual uint32 getSoundID(uint32 strRef) const = 0;
 
+	/** Decode all strings up front, instead of on first access.
+	 *
+	 *  Talk tables that don't support this keep decoding their strings lazily.
+	 *
+	 *  @param background Decode the strings in a background thread.
+	 */
+	virtual void preDecode(bool background);
+
 	/** Take over this stream and read a talk table (of either format) out of it. */
 	static TalkTable *load(Common::SeekableReadStream *tlk, Common::Encoding encoding);
 
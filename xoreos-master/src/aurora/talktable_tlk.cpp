@@ -28,11 +28,15 @@
 
 #include <cassert>
 
+#include <vector>
+
 #include "src/common/util.h"
 #include "src/common/strutil.h"
 #include "src/common/memreadstream.h"
 #include "src/common/readfile.h"
 #include "src/common/error.h"
+#include "src/common/encoding.h"
+#include "src/common/thread.h"
 
 #include "src/aurora/talktable_tlk.h"
 #include "src/aurora/language.h"
@@ -43,8 +47,26 @@ static const uint32 kVersion4 = MKTAG('V', '4', '.', '0');
 
 namespace Aurora {
 
+/** A thread decoding all strings of a talk table. */
+class TalkTable_TLK::DecodeThread : public Common::Thread {
+public:
+	DecodeThread(TalkTable_TLK &tlk) : _tlk(&tlk) {
+	}
+
+	~DecodeThread() {
+		destroyThread();
+	}
+
+private:
+	TalkTable_TLK *_tlk;
+
+	void threadMethod() {
+		_tlk->decodeAll(_killThread);
+	}
+};
+
 TalkTable_TLK::TalkTable_TLK(Common::SeekableReadStream *tlk, Common::Encoding encoding) :
-	TalkTable(encoding), _tlk(tlk) {
+	TalkTable(encoding), _tlk(tlk), _decoded(false) {
 
 	assert(_tlk);
 
@@ -52,6 +74,8 @@ TalkTable_TLK::TalkTable_TLK(Common::SeekableReadStream *tlk, Common::Encoding e
 }
 
 TalkTable_TLK::~TalkTable_TLK() {
+	// Stop decoding before the strings go away
+	_decodeThread.reset();
 }
 
 void TalkTable_TLK::load() {
@@ -113,8 +137,22 @@ void TalkTable_TLK::readEntryTableV4() {
 	}
 }
 
+bool TalkTable_TLK::hasText(const Entry &entry) {
+	return (entry.length > 0) && (entry.flags & kFlagTextPresent);
+}
+
+Common::UString TalkTable_TLK::decodeString(const byte *data, size_t size) const {
+	if (_encoding == Common::kEncodingInvalid)
+		return "[???]";
+
+	Common::MemoryReadStream raw(data, size);
+	Common::ScopedPtr<Common::MemoryReadStream> parsed(LangMan.preParseColorCodes(raw));
+
+	return Common::readString(*parsed, _encoding);
+}
+
 void TalkTable_TLK::readString(Entry &entry) const {
-	if (!entry.text.empty() || (entry.length == 0) || !(entry.flags & kFlagTextPresent))
+	if (!entry.text.empty() || !hasText(entry))
 		// We already have the string
 		return;
 
@@ -127,12 +165,97 @@ void TalkTable_TLK::readString(Entry &entry) const {
 		return;
 
 	Common::ScopedPtr<Common::MemoryReadStream> data(_tlk->readStream(length));
-	Common::ScopedPtr<Common::MemoryReadStream> parsed(LangMan.preParseColorCodes(*data));
 
-	if (_encoding != Common::kEncodingInvalid)
-		entry.text = Common::readString(*parsed, _encoding);
-	else
-		entry.text = "[???]";
+	entry.text = decodeString(data->getData(), data->size());
+}
+
+void TalkTable_TLK::preDecode(bool background) {
+	if (isPreDecoded() || _decodeThread)
+		return;
+
+	if (background) {
+		// Make sure the encoding conversion is set up before another thread uses it
+		if (_encoding != Common::kEncodingInvalid)
+			Common::hasSupportEncoding(_encoding);
+
+		_decodeThread.reset(new DecodeThread(*this));
+		if (_decodeThread->createThread("TLKDecode"))
+			return;
+
+		warning("Failed to create a thread to decode the talk table in the background");
+		_decodeThread.reset();
+	}
+
+	const bool kill = false;
+	decodeAll(kill);
+}
+
+bool TalkTable_TLK::isPreDecoded() const {
+	return _decoded.load(boost::memory_order_acquire);
+}
+
+void TalkTable_TLK::decodeAll(const volatile bool &kill) {
+	/* This runs in a thread of its own, where an escaping exception would
+	 * take down the whole process. Since _decoded isn't set on failure,
+	 * lookups just keep decoding their strings themselves. */
+	try {
+		decodeAllStrings(kill);
+	} catch (...) {
+		Common::exceptionDispatcherWarning("Failed to decode the talk table up front, "
+		                                   "decoding strings on demand instead");
+	}
+}
+
+void TalkTable_TLK::decodeAllStrings(const volatile bool &kill) {
+	/* The strings are stored back to back after the entry table.
+	 * Read all of them in one go, then decode them one by one. */
+
+	size_t start = SIZE_MAX, end = 0;
+	for (Entries::const_iterator entry = _entries.begin(); entry != _entries.end(); ++entry) {
+		if (!hasText(*entry))
+			continue;
+
+		start = MIN<size_t>(start, entry->offset);
+		end   = MAX<size_t>(end  , (size_t) entry->offset + entry->length);
+	}
+
+	std::vector<byte> data;
+
+	{
+		Common::StackLock lock(_mutex);
+
+		end = MIN<size_t>(end, _tlk->size());
+		if (start < end) {
+			data.resize(end - start);
+
+			_tlk->seek(start);
+			data.resize(_tlk->read(&data[0], data.size()));
+
+			end = start + data.size();
+		}
+	}
+
+	for (Entries::iterator entry = _entries.begin(); entry != _entries.end(); ++entry) {
+		if (kill)
+			return;
+
+		if (!hasText(*entry) || (entry->offset >= end))
+			continue;
+
+		const size_t length = MIN<size_t>(entry->length, end - entry->offset);
+
+		const Common::UString text = decodeString(&data[entry->offset - start], length);
+		if (text.empty())
+			continue;
+
+		/* A lookup might have decoded this string in the meantime. Strings
+		 * are only ever set once, since callers hold references to them. */
+		Common::StackLock lock(_mutex);
+		if (entry->text.empty())
+			entry->text = text;
+	}
+
+	_decoded.store(true, boost::memory_order_release);
 }
 
 uint32 TalkTable_TLK::getLanguageID() const {
@@ -148,9 +271,15 @@ const Common::UString &TalkTable_TLK::getString(uint32 strRef) const {
 	if (strRef >= _entries.size())
 		return kEmptyString;
 
-	readString(_entries[strRef]);
+	Entry &entry = _entries[strRef];
+	if (isPreDecoded())
+		return entry.text;
+
+	Common::StackLock lock(_mutex);
+
+	readString(entry);
 
-	return _entries[strRef].text;
+	return entry.text;
 }
 
 const Common::UString &TalkTable_TLK::getSoundResRef(uint32 strRef) const {
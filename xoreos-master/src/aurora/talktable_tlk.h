@@ -30,6 +30,8 @@
 #include "src/common/types.h"
 #include "src/common/scopedptr.h"
 #include "src/common/ustring.h"
+#include "src/common/mutex.h"
+#include "src/common/atomic.h"
 
 #include "src/aurora/aurorafile.h"
 #include "src/aurora/talktable.h"
@@ -49,6 +51,12 @@ namespace Aurora {
  *  - V3.0, used by Neverwinter Nights, Neverwinter Nights 2, Knight of
  *    the Old Republic, Knight of the Old Republic II and The Witcher
  *  - V4.0, used by Jade Empire
+ *
+ *  Strings are decoded lazily, on first access, which keeps the memory
+ *  footprint down to the strings that are actually used. Alternatively,
+ *  preDecode() decodes all strings up front, optionally in a background
+ *  thread. Once that is finished, looking up a string doesn't take a
+ *  lock anymore.
  */
 class TalkTable_TLK : public AuroraFile, public TalkTable {
 public:
@@ -66,6 +74,16 @@ public:
 
 	uint32 getSoundID(uint32 strRef) const;
 
+	/** Decode all strings up front.
+	 *
+	 *  @param background Decode the strings in a background thread. Until
+	 *                    it's finished, strings are still decoded lazily.
+	 */
+	void preDecode(bool background = false);
+
+	/** Have all strings been decoded? */
+	bool isPreDecoded() const;
+
 	static uint32 getLanguageID(Common::SeekableReadStream &tlk);
 	static uint32 getLanguageID(const Common::UString &file);
 
@@ -97,6 +115,8 @@ private:
 
 	typedef std::vector<Entry> Entries;
 
+	class DecodeThread;
+
 
 	Common::ScopedPtr<Common::SeekableReadStream> _tlk;
 
@@ -104,12 +124,34 @@ private:
 
 	mutable Entries _entries;
 
+	/** Protects the stream and the lazily decoded strings. */
+	mutable Common::Mutex _mutex;
+
+	/** Have all strings been decoded? Lookups are lock-free once this is set. */
+	boost::atomic<bool> _decoded;
+
+	Common::ScopedPtr<DecodeThread> _decodeThread;
+
 	void load();
 
 	void readEntryTableV3(uint32 stringsOffset);
 	void readEntryTableV4();
 
 	void readString(Entry &entry) const;
+
+	/** Decode all strings, until told to stop.
+	 *
+	 *  Should that fail, the failure is reported as a warning, and the
+	 *  remaining strings are decoded lazily, on first access, instead.
+	 */
+	void decodeAll(const volatile bool &kill);
+	/** Decode all strings, until told to stop, throwing on failure. */
+	void decodeAllStrings(const volatile bool &kill);
+
+	/** Decode the raw data of one string. */
+	Common::UString decodeString(const byte *data, size_t size) const;
+
+	static bool hasText(const Entry &entry);
 };
 
 } // End of namespace Aurora
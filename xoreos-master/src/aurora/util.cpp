@@ -339,14 +339,20 @@ const FileTypeManager::Type FileTypeManager::types[] = {
 
 
 FileTypeManager::FileTypeManager() {
+	/* Build all lookup tables up front. Once built, they are never modified,
+	 * so the file type lookups can be used from several threads at once. */
+
+	buildExtensionLookup();
+	buildTypeLookup();
+
+	for (int algo = 0; algo < Common::kHashMAX; algo++)
+		buildHashLookup((Common::HashAlgo) algo);
 }
 
 FileTypeManager::~FileTypeManager() {
 }
 
 FileType FileTypeManager::getFileType(const Common::UString &path) {
-	buildExtensionLookup();
-
 	Common::UString ext = Common::FilePath::getExtension(path).toLower();
 
 	ExtensionLookup::const_iterator t = _extensionLookup.find(ext);
@@ -361,8 +367,6 @@ Common::UString FileTypeManager::addFileType(const Common::UString &path, FileTy
 }
 
 Common::UString FileTypeManager::setFileType(const Common::UString &path, FileType type) {
-	buildTypeLookup();
-
 	Common::UString ext;
 	TypeLookup::const_iterator t = _typeLookup.find(type);
 	if (t != _typeLookup.end())
@@ -375,8 +379,6 @@ FileType FileTypeManager::getFileType(Common::HashAlgo algo, uint64 hashedExtens
 	if ((algo < 0) || (algo >= Common::kHashMAX))
 		return kFileTypeNone;
 
-	buildHashLookup(algo);
-
 	HashLookup::const_iterator t = _hashLookup[algo].find(hashedExtension);
 	if (t != _hashLookup[algo].end())
 		return t->second->type;
@@ -30,9 +30,11 @@
 #include <boost/noncopyable.hpp>
 
 #include "src/common/types.h"
+#include "src/common/util.h"
 #include "src/common/disposableptr.h"
 #include "src/common/error.h"
 #include "src/common/readstream.h"
+#include "src/common/memreadstream.h"
 
 namespace Common {
 
@@ -66,6 +68,16 @@ public:
 	/** Add a bit to the n-bit value x, making it an (n+1)-bit value. */
 	virtual void addBit(uint32 &x, size_t n) = 0;
 
+	/** Read a multi-bit value from the bit stream, without moving the position.
+	 *
+	 *  The value is the same one getBits() would return. Bits beyond the end
+	 *  of the bit stream are read as 0.
+	 */
+	virtual uint32 peekBits(size_t n) = 0;
+
+	/** Are the bits of each data value handed out from the MSB to the LSB? */
+	virtual bool isMSBFirst() const = 0;
+
 protected:
 	BitStream() {
 	}
@@ -209,6 +221,51 @@ public:
 			x = (x & ~(1 << n)) | (getBit() << n);
 	}
 
+	/** Read a multi-bit value from the bit stream, without moving the position. */
+	uint32 peekBits(size_t n) {
+		if (n == 0)
+			return 0;
+
+		if (n > 32)
+			throw Exception("Too many bits requested to be read");
+
+		/* Collect the bits into a window: starting at the MSB when reading
+		 * MSB to LSB, and starting at the LSB otherwise. The remaining bits
+		 * of the current value are already in the right place. */
+		uint64 window = (_inValue == 0) ? 0 : _value;
+		size_t count  = (_inValue == 0) ? 0 : (valueBits - _inValue);
+
+		size_t offset = _stream->pos();
+		while (count < n) {
+			byte data[valueBits / 8];
+			if (_stream->readAt(offset, data, sizeof(data)) != sizeof(data))
+				break;
+
+			offset += sizeof(data);
+
+			uint64 value = 0;
+			for (size_t i = 0; i < sizeof(data); i++)
+				value |= ((uint64) data[isLE ? i : (sizeof(data) - 1 - i)]) << (i * 8);
+
+			if (isMSB2LSB)
+				window |= (value << (64 - valueBits)) >> count;
+			else
+				window |= value << count;
+
+			count += valueBits;
+		}
+
+		if (isMSB2LSB)
+			return (uint32) (window >> (64 - n));
+
+		return (uint32) (window & (0xFFFFFFFFULL >> (32 - n)));
+	}
+
+	/** Are the bits of each data value handed out from the MSB to the LSB? */
+	bool isMSBFirst() const {
+		return isMSB2LSB;
+	}
+
 	/** Rewind the bit stream back to the start. */
 	void rewind() {
 		_stream->seek(0);
@@ -219,8 +276,25 @@ public:
 
 	/** Skip the specified amount of bits. */
 	void skip(size_t n) {
-		while (n-- > 0)
-			getBit();
+		while (n > 0) {
+			// Check if we need the next value
+			if (_inValue == 0)
+				readValue();
+
+			// Skip as many bits as we can within the current value
+			const size_t count = MIN<size_t>(n, valueBits - _inValue);
+
+			if (count >= 64)
+				_value = 0;
+			else if (isMSB2LSB)
+				_value <<= count;
+			else
+				_value >>= count;
+
+			_inValue = (_inValue + count) % valueBits;
+
+			n -= count;
+		}
 	}
 
 	/** Return the stream position in bits. */
@@ -276,6 +350,291 @@ typedef BitStreamImpl<64, false, true > BitStream64BEMSB;
 /** 64-bit big-endian data, LSB to MSB. */
 typedef BitStreamImpl<64, false, false> BitStream64BELSB;
 
+/**
+ * A template implementing a fast bit stream over a contiguous block of memory.
+ *
+ * It reads the same data memory layouts as BitStreamImpl, but keeps up to 64 bits
+ * of the data in a cache, refilled one data value at a time, so that reading a
+ * multi-bit value is only a few shifts. None of its methods are virtual, so codecs
+ * can use it directly in their inner loops, where every call can be inlined.
+ *
+ * The bit stream does not copy the data, so the data has to stay valid for as
+ * long as the bit stream is used.
+ */
+template<int valueBits, bool isLE, bool isMSB2LSB>
+class MemoryBitStreamImpl : boost::noncopyable {
+private:
+	DisposablePtr<MemoryReadStream> _stream; ///< The input stream, if any.
+
+	const byte *_data; ///< The data.
+	size_t      _size; ///< The size of the data in bytes, rounded down to full data values.
+
+	size_t _dataPos; ///< Offset of the next data value to be added to the cache.
+
+	/** The cached bits. The next bit is the MSB when reading MSB to LSB, and the LSB otherwise. */
+	uint64 _cache;
+	size_t _cacheBits; ///< Number of bits in the cache.
+
+	/** Read a data value. */
+	static inline uint64 readData(const byte *data) {
+		uint64 value = 0;
+
+		for (int i = 0; i < (valueBits / 8); i++)
+			value |= ((uint64) data[isLE ? i : ((valueBits / 8) - 1 - i)]) << (i * 8);
+
+		return value;
+	}
+
+	/** Add as many data values to the cache as fit. */
+	inline void refill() {
+		while ((_cacheBits <= (size_t) (64 - valueBits)) && (_dataPos < _size)) {
+			const uint64 value = readData(_data + _dataPos);
+			_dataPos += valueBits / 8;
+
+			if (isMSB2LSB)
+				_cache |= (value << (64 - valueBits)) >> _cacheBits;
+			else
+				_cache |= value << _cacheBits;
+
+			_cacheBits += valueBits;
+		}
+	}
+
+	/** Return the next n bits out of the cache, 0 < n <= MIN(32, _cacheBits). */
+	inline uint32 peekCache(size_t n) const {
+		if (isMSB2LSB)
+			return (uint32) (_cache >> (64 - n));
+
+		return (uint32) (_cache & (0xFFFFFFFFULL >> (32 - n)));
+	}
+
+	/** Remove the next n bits from the cache, n <= _cacheBits. */
+	inline void dropCache(size_t n) {
+		if (n >= 64)
+			_cache = 0;
+		else if (isMSB2LSB)
+			_cache <<= n;
+		else
+			_cache >>= n;
+
+		_cacheBits -= n;
+	}
+
+	/** Read a value spanning the end of the cache, with 64-bit data values or at the end of the stream. */
+	uint32 getBitsSpanning(size_t n) {
+		const size_t first = _cacheBits;
+		const uint32 head  = (first > 0) ? peekCache(first) : 0;
+
+		dropCache(first);
+		refill();
+
+		const size_t second = n - first;
+		if (_cacheBits < second)
+			throw Exception("BitStream::getBits(): End of bit stream reached");
+
+		const uint32 tail = peekCache(second);
+		dropCache(second);
+
+		if (isMSB2LSB)
+			return (second >= 32) ? tail : ((head << second) | tail);
+
+		return head | (tail << first);
+	}
+
+public:
+	/** Create a bit stream over this data. */
+	MemoryBitStreamImpl(const byte *data, size_t size) : _stream(0, false),
+		_data(data), _size(size & ~((size_t) ((valueBits >> 3) - 1))), _dataPos(0), _cache(0), _cacheBits(0) {
+
+		assert(_data || (_size == 0));
+	}
+
+	/** Create a bit stream over the data of this stream and optionally delete it on destruction. */
+	MemoryBitStreamImpl(MemoryReadStream *stream, bool disposeAfterUse = false) : _stream(stream, disposeAfterUse),
+		_data(0), _size(0), _dataPos(0), _cache(0), _cacheBits(0) {
+
+		assert(_stream);
+
+		_data = _stream->getData();
+		_size = _stream->size() & ~((size_t) ((valueBits >> 3) - 1));
+	}
+
+	/** Create a bit stream over the data of this stream. */
+	MemoryBitStreamImpl(MemoryReadStream &stream) : _stream(&stream, false),
+		_data(stream.getData()), _size(stream.size() & ~((size_t) ((valueBits >> 3) - 1))),
+		_dataPos(0), _cache(0), _cacheBits(0) {
+
+	}
+
+	~MemoryBitStreamImpl() {
+	}
+
+	/** Read a bit from the bit stream. */
+	inline uint32 getBit() {
+		if (_cacheBits == 0) {
+			refill();
+
+			if (_cacheBits == 0)
+				throw Exception("BitStream::getBit(): End of bit stream reached");
+		}
+
+		const uint32 b = peekCache(1);
+		dropCache(1);
+
+		return b;
+	}
+
+	/** Read a multi-bit value from the bit stream. */
+	inline uint32 getBits(size_t n) {
+		if (n == 0)
+			return 0;
+
+		if (n > 32)
+			throw Exception("Too many bits requested to be read");
+
+		if (_cacheBits < n) {
+			refill();
+
+			if (_cacheBits < n)
+				return getBitsSpanning(n);
+		}
+
+		const uint32 v = peekCache(n);
+		dropCache(n);
+
+		return v;
+	}
+
+	/** Read a multi-bit value from the bit stream, without moving the position.
+	 *
+	 *  The value is the same one getBits() would return. Bits beyond the end
+	 *  of the bit stream are read as 0.
+	 */
+	inline uint32 peekBits(size_t n) {
+		if (n == 0)
+			return 0;
+
+		if (n > 32)
+			throw Exception("Too many bits requested to be read");
+
+		if (_cacheBits < n) {
+			refill();
+
+			if (_cacheBits < n) {
+				// Add in the next data value, without taking it out of the data
+				const uint64 next = (_dataPos < _size) ? readData(_data + _dataPos) : 0;
+
+				const uint64 window = isMSB2LSB ?
+					(_cache | ((next << (64 - valueBits)) >> _cacheBits)) : (_cache | (next << _cacheBits));
+
+				if (isMSB2LSB)
+					return (uint32) (window >> (64 - n));
+
+				return (uint32) (window & (0xFFFFFFFFULL >> (32 - n)));
+			}
+		}
+
+		return peekCache(n);
+	}
+
+	/** Add a bit to the n-bit value x, making it an (n+1)-bit value. */
+	inline void addBit(uint32 &x, size_t n) {
+		if (n >= 32)
+			throw Exception("Too many bits requested to be read");
+
+		if (isMSB2LSB)
+			x = (x << 1) | getBit();
+		else
+			x = (x & ~(1 << n)) | (getBit() << n);
+	}
+
+	/** Skip the specified amount of bits. */
+	inline void skip(size_t n) {
+		if (n <= _cacheBits) {
+			dropCache(n);
+			return;
+		}
+
+		n -= _cacheBits;
+		dropCache(_cacheBits);
+
+		// Skip over full data values without reading them
+		const size_t values = MIN<size_t>(n / valueBits, (_size - _dataPos) / (valueBits / 8));
+
+		_dataPos += values * (valueBits / 8);
+		n        -= values * valueBits;
+
+		if (n > 0) {
+			refill();
+
+			if (_cacheBits < n)
+				throw Exception("BitStream::skip(): End of bit stream reached");
+
+			dropCache(n);
+		}
+	}
+
+	/** Rewind the bit stream back to the start. */
+	void rewind() {
+		_dataPos   = 0;
+		_cache     = 0;
+		_cacheBits = 0;
+	}
+
+	/** Are the bits of each data value handed out from the MSB to the LSB? */
+	bool isMSBFirst() const {
+		return isMSB2LSB;
+	}
+
+	/** Return the stream position in bits. */
+	size_t pos() const {
+		return _dataPos * 8 - _cacheBits;
+	}
+
+	/** Return the stream size in bits. */
+	size_t size() const {
+		return _size * 8;
+	}
+
+	bool eos() const {
+		return pos() >= size();
+	}
+};
+
+// typedefs for various memory layouts.
+
+/** 8-bit data, MSB to LSB. */
+typedef MemoryBitStreamImpl<8, false, true > MemoryBitStream8MSB;
+/** 8-bit data, LSB to MSB. */
+typedef MemoryBitStreamImpl<8, false, false> MemoryBitStream8LSB;
+
+/** 16-bit little-endian data, MSB to LSB. */
+typedef MemoryBitStreamImpl<16, true , true > MemoryBitStream16LEMSB;
+/** 16-bit little-endian data, LSB to MSB. */
+typedef MemoryBitStreamImpl<16, true , false> MemoryBitStream16LELSB;
+/** 16-bit big-endian data, MSB to LSB. */
+typedef MemoryBitStreamImpl<16, false, true > MemoryBitStream16BEMSB;
+/** 16-bit big-endian data, LSB to MSB. */
+typedef MemoryBitStreamImpl<16, false, false> MemoryBitStream16BELSB;
+
+/** 32-bit little-endian data, MSB to LSB. */
+typedef MemoryBitStreamImpl<32, true , true > MemoryBitStream32LEMSB;
+/** 32-bit little-endian data, LSB to MSB. */
+typedef MemoryBitStreamImpl<32, true , false> MemoryBitStream32LELSB;
+/** 32-bit big-endian data, MSB to LSB. */
+typedef MemoryBitStreamImpl<32, false, true > MemoryBitStream32BEMSB;
+/** 32-bit big-endian data, LSB to MSB. */
+typedef MemoryBitStreamImpl<32, false, false> MemoryBitStream32BELSB;
+
+/** 64-bit little-endian data, MSB to LSB. */
+typedef MemoryBitStreamImpl<64, true , true > MemoryBitStream64LEMSB;
+/** 64-bit little-endian data, LSB to MSB. */
+typedef MemoryBitStreamImpl<64, true , false> MemoryBitStream64LELSB;
+/** 64-bit big-endian data, MSB to LSB. */
+typedef MemoryBitStreamImpl<64, false, true > MemoryBitStream64BEMSB;
+/** 64-bit big-endian data, LSB to MSB. */
+typedef MemoryBitStreamImpl<64, false, false> MemoryBitStream64BELSB;
+
 } // End of namespace Common
 
 #endif // COMMON_BITSTREAM_H
@@ -100,6 +100,9 @@ public:
 	/** Change the disposable flag. */
 	void setDisposable(bool d) { _dispose = d; }
 
+	/** Will the pointer be disposed of when the DisposablePtr is destroyed? */
+	bool isDisposable() const { return _dispose; }
+
 	/** Unconditionally dispose of the pointer, destroying the old object. */
 	void dispose() {
 		Deallocator::destroy(_pointer);
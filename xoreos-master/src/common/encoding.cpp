@@ -33,6 +33,7 @@
 #include "src/common/error.h"
 #include "src/common/scopedptr.h"
 #include "src/common/singleton.h"
+#include "src/common/mutex.h"
 #include "src/common/ustring.h"
 #include "src/common/memreadstream.h"
 #include "src/common/writestream.h"
@@ -116,6 +117,9 @@ private:
 	iconv_t _contextFrom[kEncodingMAX];
 	iconv_t _contextTo  [kEncodingMAX];
 
+	/** iconv contexts carry state, so only one conversion may run at a time. */
+	Mutex _mutex;
+
 	byte *doConvert(iconv_t &ctx, byte *data, size_t nIn, size_t nOut, size_t &size) {
 		size_t inBytes  = nIn;
 		size_t outBytes = nOut;
@@ -124,6 +128,8 @@ private:
 
 		byte *outBuf = convData.get();
 
+		StackLock lock(_mutex);
+
 		// Reset the converter's state
 		iconv(ctx, 0, 0, 0, 0);
 
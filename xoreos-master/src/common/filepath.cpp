@@ -78,6 +78,14 @@ size_t FilePath::getFileSize(const UString &p) {
 	return size;
 }
 
+uint64 FilePath::getModificationTime(const UString &p) {
+	const uint64 time = Platform::getModificationTime(p);
+	if (time == 0)
+		warning("Failed to get modification time of file \"%s\"", p.c_str());
+
+	return time;
+}
+
 UString FilePath::getFile(const UString &p) {
 	path file(p.c_str());
 
@@ -347,6 +355,23 @@ bool FilePath::createDirectories(const UString &path) {
 	}
 }
 
+void FilePath::renameFile(const UString &from, const UString &to) {
+	try {
+		boost::filesystem::rename(from.c_str(), to.c_str());
+	} catch (std::exception &se) {
+		throw Exception(se);
+	}
+}
+
+bool FilePath::removeFile(const UString &p) {
+	try {
+		return boost::filesystem::remove(p.c_str());
+	} catch (...) {
+	}
+
+	return false;
+}
+
 UString FilePath::escapeStringLiteral(const UString &str) {
 	const boost::regex esc("[\\^\\.\\$\\|\\(\\)\\[\\]\\*\\+\\?\\/\\\\]");
 	const std::string  rep("\\\\\\1&");
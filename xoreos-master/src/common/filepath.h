@@ -58,6 +58,15 @@ public:
 	 */
 	static size_t getFileSize(const UString &p);
 
+	/** Return the time a file was last modified.
+	 *
+	 *  @param  p The file to look up.
+	 *  @return The modification time of the file, in nanoseconds since the epoch,
+	 *          or 0 if not a valid file. The actual resolution depends on the OS
+	 *          and the filesystem.
+	 */
+	static uint64 getModificationTime(const UString &p);
+
 	/** Return a file name without its path.
 	 *
 	 *  Example: "/path/to/file.ext" > "file.ext"
@@ -201,6 +210,20 @@ public:
 	 */
 	static bool createDirectories(const UString &path);
 
+	/** Rename a file, replacing the target file if it already exists.
+	 *
+	 *  @param  from The file to rename.
+	 *  @param  to The new path of the file.
+	 */
+	static void renameFile(const UString &from, const UString &to);
+
+	/** Remove a file.
+	 *
+	 *  @param  p The file to remove.
+	 *  @return true if the file was removed.
+	 */
+	static bool removeFile(const UString &p);
+
 	/** Escape a string literal for use in a regexp. */
 	static UString escapeStringLiteral(const UString &str);
 
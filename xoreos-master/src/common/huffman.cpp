@@ -23,15 +23,39 @@
  */
 
 #include <cassert>
+#include <algorithm>
+#include <map>
 
 #include "src/common/huffman.h"
 #include "src/common/util.h"
 #include "src/common/error.h"
 #include "src/common/bitstream.h"
 
+/** The maximum number of bits indexing a lookup table. */
+static const uint8 kMaxTableBits = 9;
+
 namespace Common {
 
-Huffman::Symbol::Symbol(uint32 c, uint32 s) : code(c), symbol(s) {
+/** Reverse the order of the lowest length bits in value. */
+static uint32 reverseBits(uint32 value, uint8 length) {
+	uint32 result = 0;
+
+	for (uint8 i = 0; i < length; i++, value >>= 1)
+		result = (result << 1) | (value & 1);
+
+	return result;
+}
+
+
+Huffman::Code::Code(uint32 c, uint8 l, uint32 i) : code(c), length(l), index(i) {
+}
+
+bool Huffman::Code::operator<(const Code &right) const {
+	return length < right.length;
+}
+
+
+Huffman::TableEntry::TableEntry() : value(0), length(0) {
 }
 
 
@@ -59,18 +83,94 @@ void Huffman::init(uint8 maxLength, size_t codeCount, const uint32 *codes,
 
 	assert(maxLength <= 32);
 
-	_codes.resize(maxLength);
+	_tableBits = MIN(MAX<uint8>(maxLength, 1), kMaxTableBits);
+
 	_symbols.resize(codeCount);
+	setSymbols(symbols);
+
+	/* A bitstream reading MSB to LSB adds each new bit at the bottom of the code,
+	 * while a bitstream reading LSB to MSB adds each new bit at the top. */
+	Codes msbCodes, lsbCodes;
+	msbCodes.reserve(codeCount);
+	lsbCodes.reserve(codeCount);
 
 	for (size_t i = 0; i < codeCount; i++) {
-		// The symbol. If none were specified, just assume it's identical to the code index
-		uint32 symbol = symbols ? symbols[i] : i;
+		// Codes with bits set beyond their length can never be matched
+		if ((lengths[i] == 0) || (lengths[i] > maxLength) || ((((uint64) codes[i]) >> lengths[i]) != 0))
+			continue;
+
+		msbCodes.push_back(Code(codes[i], lengths[i], i));
+		lsbCodes.push_back(Code(reverseBits(codes[i], lengths[i]), lengths[i], i));
+	}
+
+	// If several codes match, the shortest one wins
+	std::stable_sort(msbCodes.begin(), msbCodes.end());
+	std::stable_sort(lsbCodes.begin(), lsbCodes.end());
+
+	_tables[0].resize(1 << _tableBits);
+	_tables[1].resize(1 << _tableBits);
+
+	buildTable(_tables[0], 0, _tableBits, msbCodes, true);
+	buildTable(_tables[1], 0, _tableBits, lsbCodes, false);
+}
+
+void Huffman::buildTable(Table &table, size_t offset, uint8 bits, const Codes &codes, bool msbFirst) {
+	/* The table is indexed by the value BitStream::peekBits() returns. When reading
+	 * LSB to MSB, the first bit read ends up in the LSB of that value. */
 
-		// Put the code and symbol into the correct list
-		_codes[lengths[i] - 1].push_back(Symbol(codes[i], symbol));
+	// Fill in the codes short enough to be found directly in this table
+	for (Codes::const_iterator c = codes.begin(); c != codes.end(); ++c) {
+		if (c->length > bits)
+			continue;
 
-		// And put the pointer to the symbol/code struct into the symbol list.
-		_symbols[i] = &_codes[lengths[i] - 1].back();
+		const uint32 fillCount = 1 << (bits - c->length);
+		const uint32 fillStart = c->code << (bits - c->length);
+
+		for (uint32 i = 0; i < fillCount; i++) {
+			const uint32 index = msbFirst ? (fillStart + i) : reverseBits(fillStart + i, bits);
+
+			TableEntry &entry = table[offset + index];
+			if (entry.length != 0)
+				continue;
+
+			entry.value  = c->index;
+			entry.length = c->length;
+		}
+	}
+
+	// Sort the longer codes by their prefix, which indexes their sub-table
+	std::map<uint32, Codes> subCodes;
+	for (Codes::const_iterator c = codes.begin(); c != codes.end(); ++c) {
+		if (c->length <= bits)
+			continue;
+
+		const uint8  length = c->length - bits;
+		const uint32 prefix = c->code >> length;
+		const uint32 code   = c->code & (0xFFFFFFFF >> (32 - length));
+
+		subCodes[prefix].push_back(Code(code, length, c->index));
+	}
+
+	for (std::map<uint32, Codes>::const_iterator s = subCodes.begin(); s != subCodes.end(); ++s) {
+		const uint32 index = msbFirst ? s->first : reverseBits(s->first, bits);
+
+		// A shorter code with the same prefix shadows all of these
+		if (table[offset + index].length != 0)
+			continue;
+
+		uint8 subBits = 0;
+		for (Codes::const_iterator c = s->second.begin(); c != s->second.end(); ++c)
+			subBits = MAX(subBits, c->length);
+
+		subBits = MIN(subBits, kMaxTableBits);
+
+		const size_t subOffset = table.size();
+		table.resize(subOffset + (1 << subBits));
+
+		table[offset + index].value  = subOffset;
+		table[offset + index].length = -((int32) subBits);
+
+		buildTable(table, subOffset, subBits, s->second, msbFirst);
 	}
 }
 
@@ -79,21 +179,11 @@ Huffman::~Huffman() {
 
 void Huffman::setSymbols(const uint32 *symbols) {
 	for (size_t i = 0; i < _symbols.size(); i++)
-		_symbols[i]->symbol = symbols ? *symbols++ : i;
+		_symbols[i] = symbols ? *symbols++ : i;
 }
 
 uint32 Huffman::getSymbol(BitStream &bits) const {
-	uint32 code = 0;
-
-	for (size_t i = 0; i < _codes.size(); i++) {
-		bits.addBit(code, i);
-
-		for (CodeList::const_iterator cCode = _codes[i].begin(); cCode != _codes[i].end(); ++cCode)
-			if (code == cCode->code)
-				return cCode->symbol;
-	}
-
-	throw Exception("Unknown Huffman code");
+	return decodeSymbol(bits);
 }
 
 } // End of namespace Common
@@ -26,9 +26,9 @@
 #define COMMON_HUFFMAN_H
 
 #include <vector>
-#include <list>
 
 #include "src/common/types.h"
+#include "src/common/error.h"
 
 namespace Common {
 
@@ -43,7 +43,13 @@ struct HuffmanTable {
 	const uint32 *symbols; ///< The symbols, 0 if identical to the codes.
 };
 
-/** Decode a Huffman'd bitstream. */
+/** Decode a Huffman'd bitstream.
+ *
+ *  The codes are decoded with the help of lookup tables: a primary table
+ *  indexed by the next few bits of the stream, and sub-tables for the
+ *  codes that are longer than that. Most symbols are therefore found with
+ *  a single table lookup, instead of going through the codes bit by bit.
+ */
 class Huffman {
 public:
 	/** Construct a Huffman decoder.
@@ -65,26 +71,87 @@ public:
 	/** Return the next symbol in the bitstream. */
 	uint32 getSymbol(BitStream &bits) const;
 
+	/** Return the next symbol in the bitstream.
+	 *
+	 *  This variant takes any kind of bit stream, for example a MemoryBitStreamImpl,
+	 *  so that the reading of the bits can be inlined.
+	 */
+	template<class BitStreamType>
+	uint32 getSymbol(BitStreamType &bits) const {
+		return decodeSymbol(bits);
+	}
+
 private:
-	struct Symbol {
-		uint32 code;
-		uint32 symbol;
+	/** A code, with its bits in the order they're read from the bitstream. */
+	struct Code {
+		uint32 code;   ///< The code bits, the first read bit in the MSB.
+		uint8  length; ///< The length of the code in bits.
+		uint32 index;  ///< The index of the code.
+
+		Code(uint32 c, uint8 l, uint32 i);
 
-		Symbol(uint32 c, uint32 s);
+		/** Sort by code length. */
+		bool operator<(const Code &right) const;
 	};
 
-	typedef std::list<Symbol>     CodeList;
-	typedef std::vector<CodeList> CodeLists;
-	typedef std::vector<Symbol *> SymbolList;
+	typedef std::vector<Code> Codes;
 
-	/** Lists of codes and their symbols, sorted by code length. */
-	CodeLists _codes;
+	/** An entry in a lookup table. */
+	struct TableEntry {
+		/** The index of the code found, or the offset of the sub-table. */
+		uint32 value;
+		/** > 0: The length of the code found. < 0: The number of bits indexing the
+		 *  sub-table. 0: No code found. */
+		int32 length;
 
-	/** Sorted list of pointers to the symbols. */
-	SymbolList _symbols;
+		TableEntry();
+	};
+
+	typedef std::vector<TableEntry> Table;
+
+	/** The number of bits indexing the primary table. */
+	uint8 _tableBits;
+
+	/** The lookup tables, for bitstreams reading MSB to LSB, and LSB to MSB.
+	 *
+	 *  Both use the same codes, but the bits of each code come in a different
+	 *  order, and so they are found at different places in the tables.
+	 */
+	Table _tables[2];
+
+	/** The symbols, indexed by the code index. */
+	std::vector<uint32> _symbols;
 
 	void init(uint8 maxLength, size_t codeCount, const uint32 *codes,
 	          const uint8 *lengths, const uint32 *symbols);
+
+	static void buildTable(Table &table, size_t offset, uint8 bits, const Codes &codes, bool msbFirst);
+
+	template<class BitStreamType>
+	inline uint32 decodeSymbol(BitStreamType &bits) const {
+		const Table &table = _tables[bits.isMSBFirst() ? 0 : 1];
+
+		size_t offset = 0;
+		uint8  length = _tableBits;
+
+		while (true) {
+			const TableEntry &entry = table[offset + bits.peekBits(length)];
+
+			if (entry.length > 0) {
+				bits.skip(entry.length);
+				return _symbols[entry.value];
+			}
+
+			if (entry.length == 0)
+				throw Exception("Unknown Huffman code");
+
+			// Descend into the sub-table
+			bits.skip(length);
+
+			offset = entry.value;
+			length = -entry.length;
+		}
+	}
 };
 
 } // End of namespace Common
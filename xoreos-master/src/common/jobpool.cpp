@@ -0,0 +1,255 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A pool of worker threads, running sets of independent jobs.
+ */
+
+#include <cassert>
+
+#include "src/common/jobpool.h"
+#include "src/common/thread.h"
+#include "src/common/util.h"
+
+namespace Common {
+
+/** A worker thread of the pool. */
+class JobPool::Worker : public Thread {
+public:
+	Worker(JobPool &pool, size_t queue) : _pool(&pool), _queue(queue) {
+	}
+
+	~Worker() {
+		destroyThread();
+	}
+
+private:
+	JobPool *_pool;
+	size_t   _queue;
+
+	void threadMethod() {
+		// Report in, so that init() knows our ID
+		_pool->_workerIDs[_queue - 1] = SDL_ThreadID();
+		_pool->_finished.unlock();
+
+		while (!_killThread) {
+			_pool->_start.lock();
+			if (_pool->_quit || _killThread)
+				break;
+
+			_pool->work(_queue);
+
+			_pool->_finished.unlock();
+		}
+	}
+};
+
+
+JobPool::JobPool() : _jobs(0), _quit(false), _hasError(false) {
+	// The calling thread's queue
+	_queues.push_back(new Queue);
+}
+
+JobPool::~JobPool() {
+	deinit();
+}
+
+void JobPool::init(size_t threadCount) {
+	deinit();
+
+	_workerIDs.resize(threadCount, 0);
+
+	_workers.reserve(threadCount);
+	for (size_t i = 0; i < threadCount; i++) {
+		_queues.push_back(new Queue);
+		_workers.push_back(new Worker(*this, i + 1));
+
+		if (!_workers.back()->createThread("JobPool")) {
+			_workers.pop_back();
+			_queues.pop_back();
+			break;
+		}
+	}
+
+	// Wait until all workers reported in
+	for (size_t i = 0; i < _workers.size(); i++)
+		_finished.lock();
+
+	_workerIDs.resize(_workers.size());
+}
+
+void JobPool::deinit() {
+	if (_workers.empty())
+		return;
+
+	_quit = true;
+	for (size_t i = 0; i < _workers.size(); i++)
+		_start.unlock();
+
+	_workers.clear();
+	_queues.resize(1);
+
+	_workerIDs.clear();
+
+	// Throw away wakeups a worker didn't get to
+	while (_start.lockTry())
+		;
+
+	_quit = false;
+}
+
+size_t JobPool::getThreadCount() const {
+	return _workers.size();
+}
+
+bool JobPool::isWorkerThread() const {
+	if (_workerIDs.empty())
+		return false;
+
+	const SDL_threadID id = SDL_ThreadID();
+	for (std::vector<SDL_threadID>::const_iterator w = _workerIDs.begin(); w != _workerIDs.end(); ++w)
+		if (*w == id)
+			return true;
+
+	return false;
+}
+
+void JobPool::run(JobSet &jobs, size_t count) {
+	if (count == 0)
+		return;
+
+	StackLock runLock(_runMutex);
+
+	assert(!isWorkerThread());
+
+	// Not worth waking up anybody
+	if (_workers.empty() || (count == 1)) {
+		for (size_t i = 0; i < count; i++)
+			jobs.runJob(i);
+
+		return;
+	}
+
+	_jobs     = &jobs;
+	_hasError = false;
+
+	// Split the jobs evenly between all threads
+	const size_t threadCount = _queues.size();
+	for (size_t i = 0; i < threadCount; i++) {
+		StackLock lock(_queues[i]->mutex);
+
+		_queues[i]->begin = (count *  i     ) / threadCount;
+		_queues[i]->end   = (count * (i + 1)) / threadCount;
+	}
+
+	const size_t wakeCount = MIN(count, threadCount) - 1;
+	for (size_t i = 0; i < wakeCount; i++)
+		_start.unlock();
+
+	work(0);
+
+	// Wait for all workers we woke up to finish
+	for (size_t i = 0; i < wakeCount; i++)
+		_finished.lock();
+
+	_jobs = 0;
+
+	if (_hasError)
+		throw _error;
+}
+
+void JobPool::work(size_t queue) {
+	while (true) {
+		size_t job;
+
+		if (!takeJob(queue, job)) {
+			// Our own queue is empty, help out somebody else
+			if (!stealJobs(queue))
+				break;
+
+			continue;
+		}
+
+		try {
+			_jobs->runJob(job);
+		} catch (Exception &e) {
+			setError(e);
+		} catch (std::exception &e) {
+			setError(Exception(e));
+		} catch (...) {
+			setError(Exception("Unknown exception in job %u", (uint)job));
+		}
+	}
+}
+
+bool JobPool::takeJob(size_t queue, size_t &job) {
+	Queue &q = *_queues[queue];
+	StackLock lock(q.mutex);
+
+	if (q.begin >= q.end)
+		return false;
+
+	job = q.begin++;
+	return true;
+}
+
+bool JobPool::stealJobs(size_t queue) {
+	const size_t threadCount = _queues.size();
+
+	for (size_t i = 1; i < threadCount; i++) {
+		Queue &victim = *_queues[(queue + i) % threadCount];
+
+		size_t begin, end;
+		{
+			StackLock lock(victim.mutex);
+
+			if (victim.begin >= victim.end)
+				continue;
+
+			// Take the back half, rounding up, so that single jobs can be stolen too
+			begin = victim.begin + (victim.end - victim.begin) / 2;
+			end   = victim.end;
+
+			victim.end = begin;
+		}
+
+		Queue &own = *_queues[queue];
+		StackLock lock(own.mutex);
+
+		own.begin = begin;
+		own.end   = end;
+
+		return true;
+	}
+
+	return false;
+}
+
+void JobPool::setError(const Exception &e) {
+	StackLock lock(_errorMutex);
+
+	if (_hasError)
+		return;
+
+	_error    = e;
+	_hasError = true;
+}
+
+} // End of namespace Common
@@ -0,0 +1,135 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A pool of worker threads, running sets of independent jobs.
+ */
+
+#ifndef COMMON_JOBPOOL_H
+#define COMMON_JOBPOOL_H
+
+#include <vector>
+
+#include <SDL_thread.h>
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/types.h"
+#include "src/common/error.h"
+#include "src/common/mutex.h"
+#include "src/common/ptrvector.h"
+
+namespace Common {
+
+/** A set of independent jobs, identified by their index. */
+class JobSet {
+public:
+	virtual ~JobSet() {}
+
+	/** Run the job with this index.
+	 *
+	 *  This is called from any of the pool's threads, in no particular
+	 *  order, and concurrently with other jobs of the same set.
+	 */
+	virtual void runJob(size_t index) = 0;
+};
+
+/** A pool of worker threads, running sets of independent jobs.
+ *
+ *  At the start of every run, the jobs are split evenly between the
+ *  thread calling run() and the worker threads. Every thread works
+ *  through its own range of jobs front to back. Once its range is
+ *  exhausted, it steals the back half of the range of another thread,
+ *  so that a few expensive jobs don't leave all other threads idle.
+ *
+ *  Since the calling thread works on the jobs as well, a pool without
+ *  any worker threads simply runs all jobs in order.
+ */
+class JobPool : boost::noncopyable {
+public:
+	JobPool();
+	~JobPool();
+
+	/** Start this many worker threads, in addition to the thread calling run(). */
+	void init(size_t threadCount);
+	/** Stop all worker threads. */
+	void deinit();
+
+	/** Return the number of running worker threads. */
+	size_t getThreadCount() const;
+
+	/** Was this called from one of the pool's worker threads? */
+	bool isWorkerThread() const;
+
+	/** Run the jobs [0, count) of this set, and return once all of them are done.
+	 *
+	 *  If any of the jobs throws, the other jobs are still run, and the
+	 *  first exception is then rethrown here.
+	 *
+	 *  Jobs must not call run() themselves.
+	 */
+	void run(JobSet &jobs, size_t count);
+
+private:
+	class Worker;
+
+	/** The range of jobs a thread still has to do. */
+	struct Queue : boost::noncopyable {
+		Mutex mutex;
+
+		size_t begin;
+		size_t end;
+
+		Queue() : begin(0), end(0) {
+		}
+	};
+
+	PtrVector<Worker> _workers;
+	PtrVector<Queue>  _queues; ///< One for each worker, plus one for the calling thread.
+
+	std::vector<SDL_threadID> _workerIDs;
+
+	Mutex _runMutex; ///< Only one run() at a time.
+
+	JobSet *_jobs;
+
+	Semaphore _start;    ///< Unlocked once per worker when new jobs are ready.
+	Semaphore _finished; ///< Unlocked by every worker once it's done with the jobs.
+
+	volatile bool _quit;
+
+	Mutex     _errorMutex;
+	bool      _hasError;
+	Exception _error;
+
+	/** Work on the jobs, starting with our own queue. */
+	void work(size_t queue);
+
+	/** Take the next job out of our own queue. */
+	bool takeJob(size_t queue, size_t &job);
+	/** Move the back half of another queue into our own queue. */
+	bool stealJobs(size_t queue);
+
+	void setError(const Exception &e);
+};
+
+} // End of namespace Common
+
+#endif // COMMON_JOBPOOL_H
@@ -89,6 +89,18 @@ size_t MemoryReadStream::seek(ptrdiff_t offset, Origin whence) {
 	return oldPos;
 }
 
+size_t MemoryReadStream::readAt(size_t offset, void *dataPtr, size_t dataSize) {
+	assert(dataPtr);
+
+	if (offset >= _size)
+		return 0;
+
+	dataSize = MIN<size_t>(dataSize, _size - offset);
+	std::memcpy(dataPtr, _ptrOrig.get() + offset, dataSize);
+
+	return dataSize;
+}
+
 bool MemoryReadStream::eos() const {
 	return _eos;
 }
@@ -105,6 +117,14 @@ const byte *MemoryReadStream::getData() const {
 	return _ptrOrig.get();
 }
 
+const byte *MemoryReadStream::takeData() {
+	if (!_ptrOrig.isDisposable())
+		return 0;
+
+	_ptrOrig.setDisposable(false);
+	return _ptrOrig.get();
+}
+
 
 MemoryReadStreamEndian::MemoryReadStreamEndian(const byte *dataPtr, size_t dataSize,
                                                bool bigEndian, bool disposeMemory) :
@@ -53,6 +53,7 @@
 #include <cstring>
 
 #include <boost/noncopyable.hpp>
+#include <boost/shared_array.hpp>
 
 #include "src/common/types.h"
 #include "src/common/disposableptr.h"
@@ -100,8 +101,18 @@ public:
 
 	size_t seek(ptrdiff_t offset, Origin whence = kOriginBegin);
 
+	size_t readAt(size_t offset, void *dataPtr, size_t dataSize);
+
 	const byte *getData() const;
 
+	/** Take over the memory buffer this stream owns.
+	 *
+	 *  If the stream disposes of its memory, the caller is now responsible for
+	 *  delete[]'ing it instead. Otherwise, 0 is returned and nothing changes.
+	 *  Either way, the stream stays readable as long as the buffer exists.
+	 */
+	const byte *takeData();
+
 private:
 	DisposableArray<const byte> _ptrOrig;
 	const byte *_ptr;
@@ -114,6 +125,25 @@ private:
 };
 
 
+/** A MemoryReadStream over a reference-counted buffer.
+ *
+ *  Several streams can share the same buffer, which is only freed once
+ *  the last of them has been destroyed. This is used to hand out cached
+ *  resource data without copying it for every caller.
+ */
+class SharedMemoryReadStream : public MemoryReadStream {
+public:
+	SharedMemoryReadStream(const boost::shared_array<const byte> &data, size_t dataSize) :
+		MemoryReadStream(data.get(), dataSize, false), _data(data) {
+
+	}
+
+	~SharedMemoryReadStream() { }
+
+private:
+	boost::shared_array<const byte> _data;
+};
+
 /** This is a wrapper around MemoryReadStream, but it adds non-endian
  *  read methods whose endianness is set on the stream creation.
  */
@@ -24,6 +24,8 @@
 
 #include <cassert>
 
+#include <SDL_timer.h>
+
 #include "src/common/mutex.h"
 
 namespace Common {
@@ -97,6 +99,67 @@ StackLock::~StackLock() {
 }
 
 
+ReadWriteLock::ReadWriteLock() : _state(0) {
+}
+
+ReadWriteLock::~ReadWriteLock() {
+	assert(_state.load() == 0);
+}
+
+void ReadWriteLock::lockRead() {
+	int32 state = _state.load(boost::memory_order_relaxed);
+
+	while (true) {
+		if ((state >= 0) &&
+		    _state.compare_exchange_weak(state, state + 1, boost::memory_order_acquire, boost::memory_order_relaxed))
+			return;
+
+		// A writer is busy. Give it a chance to finish
+		if (state < 0) {
+			SDL_Delay(0);
+			state = _state.load(boost::memory_order_relaxed);
+		}
+	}
+}
+
+void ReadWriteLock::unlockRead() {
+	_state.fetch_sub(1, boost::memory_order_release);
+}
+
+void ReadWriteLock::lockWrite() {
+	int32 state = 0;
+
+	while (!_state.compare_exchange_weak(state, -1, boost::memory_order_acquire, boost::memory_order_relaxed)) {
+		if (state != 0)
+			SDL_Delay(0);
+
+		state = 0;
+	}
+}
+
+void ReadWriteLock::unlockWrite() {
+	_state.store(0, boost::memory_order_release);
+}
+
+
+StackReadLock::StackReadLock(ReadWriteLock &lock) : _lock(&lock) {
+	_lock->lockRead();
+}
+
+StackReadLock::~StackReadLock() {
+	_lock->unlockRead();
+}
+
+
+StackWriteLock::StackWriteLock(ReadWriteLock &lock) : _lock(&lock) {
+	_lock->lockWrite();
+}
+
+StackWriteLock::~StackWriteLock() {
+	_lock->unlockWrite();
+}
+
+
 Condition::Condition() : _ownMutex(true) {
 	_mutex = new Mutex;
 
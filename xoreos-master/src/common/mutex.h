@@ -25,6 +25,8 @@
 #ifndef COMMON_MUTEX_H
 #define COMMON_MUTEX_H
 
+#include "src/common/atomic.h"
+
 #include <SDL_thread.h>
 
 #include <boost/noncopyable.hpp>
@@ -76,6 +78,48 @@ private:
 	Semaphore *_semaphore;
 };
 
+/** A lock that many readers can hold at the same time, but only ever one writer.
+ *
+ *  Readers only touch an atomic counter, so they never wait on each other.
+ *  A writer spins until all current readers are gone, so the reading side
+ *  should only ever be held for very short amounts of time. Not recursive.
+ */
+class ReadWriteLock : boost::noncopyable {
+public:
+	ReadWriteLock();
+	~ReadWriteLock();
+
+	void lockRead();
+	void unlockRead();
+
+	void lockWrite();
+	void unlockWrite();
+
+private:
+	/** Number of readers, or -1 while a writer holds the lock. */
+	boost::atomic<int32> _state;
+};
+
+/** Convenience class that read-locks a ReadWriteLock on creation and unlocks it on destruction. */
+class StackReadLock : boost::noncopyable {
+public:
+	StackReadLock(ReadWriteLock &lock);
+	~StackReadLock();
+
+private:
+	ReadWriteLock *_lock;
+};
+
+/** Convenience class that write-locks a ReadWriteLock on creation and unlocks it on destruction. */
+class StackWriteLock : boost::noncopyable {
+public:
+	StackWriteLock(ReadWriteLock &lock);
+	~StackWriteLock();
+
+private:
+	ReadWriteLock *_lock;
+};
+
 /** A condition. */
 class Condition : boost::noncopyable {
 public:
@@ -29,18 +29,25 @@
 	#include <windows.h>
 	#include <shellapi.h>
 	#include <wchar.h>
+	#include <io.h>
 #endif
 
 #if defined(UNIX)
 	#include <pwd.h>
 	#include <unistd.h>
+	#include <errno.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
 #endif
 
 #include <cassert>
 #include <cstdlib>
+#include <cstring>
+#include <ctime>
 
 #include <boost/locale.hpp>
 #include <boost/filesystem/path.hpp>
+#include <boost/filesystem/operations.hpp>
 
 #include "src/common/platform.h"
 #include "src/common/error.h"
@@ -118,6 +125,116 @@ std::FILE *Platform::openFile(const UString &fileName, FileMode mode) {
 }
 // '--- openFile() ---'
 
+// .--- readFileAt() ---.
+#if defined(WIN32)
+
+size_t Platform::readFileAt(std::FILE *file, size_t offset, void *dataPtr, size_t dataSize) {
+	assert(file && dataPtr);
+
+	/* Windows has no positional read that leaves the file pointer alone: even
+	 * ReadFile() with an explicit offset moves it on a synchronous handle. So
+	 * instead, we hold the std::FILE's own lock while we seek, read and seek
+	 * back. The CRT takes the same lock for every other operation on the file,
+	 * so no other thread can read or seek in between. */
+	_lock_file(file);
+
+	size_t bytesRead = 0;
+
+	const long oldPos = std::ftell(file);
+	if ((oldPos >= 0) && (std::fseek(file, (long) offset, SEEK_SET) == 0)) {
+		bytesRead = std::fread(dataPtr, 1, dataSize, file);
+
+		std::fseek(file, oldPos, SEEK_SET);
+	}
+
+	_unlock_file(file);
+
+	return bytesRead;
+}
+
+#else
+
+size_t Platform::readFileAt(std::FILE *file, size_t offset, void *dataPtr, size_t dataSize) {
+	assert(file && dataPtr);
+
+	const int fd = fileno(file);
+
+	byte  *data      = reinterpret_cast<byte *>(dataPtr);
+	size_t bytesRead = 0;
+
+	while (bytesRead < dataSize) {
+		const ssize_t result = pread(fd, data + bytesRead, dataSize - bytesRead, offset + bytesRead);
+		if (result < 0) {
+			if (errno == EINTR)
+				continue;
+
+			break;
+		}
+
+		if (result == 0)
+			break;
+
+		bytesRead += result;
+	}
+
+	return bytesRead;
+}
+
+#endif
+// '--- readFileAt() ---'
+
+// .--- mapFile() ---.
+#if defined(WIN32)
+
+const byte *Platform::mapFile(std::FILE *file, size_t size) {
+	assert(file);
+
+	if (size == 0)
+		return 0;
+
+	HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(file)));
+	if (handle == INVALID_HANDLE_VALUE)
+		return 0;
+
+	HANDLE mapping = CreateFileMappingW(handle, 0, PAGE_READONLY, 0, 0, 0);
+	if (!mapping)
+		return 0;
+
+	// The view keeps the mapping object alive on its own
+	void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+	CloseHandle(mapping);
+
+	return reinterpret_cast<const byte *>(data);
+}
+
+void Platform::unmapFile(const byte *data, size_t UNUSED(size)) {
+	if (data)
+		UnmapViewOfFile(data);
+}
+
+#else
+
+const byte *Platform::mapFile(std::FILE *file, size_t size) {
+	assert(file);
+
+	if (size == 0)
+		return 0;
+
+	void *data = mmap(0, size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+	if (data == MAP_FAILED)
+		return 0;
+
+	return reinterpret_cast<const byte *>(data);
+}
+
+void Platform::unmapFile(const byte *data, size_t size) {
+	if (data)
+		munmap(const_cast<byte *>(data), size);
+}
+
+#endif
+// '--- mapFile() ---'
+
 // .--- Windows utility functions ---.
 #if defined(WIN32)
 
@@ -176,6 +293,60 @@ static inline UString getWindowsVariable(const wchar_t *variable) {
 #endif
 // '--- Windows utility functions ---'
 
+// .--- getModificationTime() ---.
+#if defined(WIN32)
+
+uint64 Platform::getModificationTime(const UString &fileName) {
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	if (!GetFileAttributesExW(boost::filesystem::path(fileName.c_str()).c_str(), GetFileExInfoStandard, &attributes))
+		return 0;
+
+	// A FILETIME counts 100ns intervals since 1601-01-01
+	static const uint64 kEpochDifference = UINT64_C(116444736000000000);
+
+	const uint64 time = (((uint64) attributes.ftLastWriteTime.dwHighDateTime) << 32) |
+	                               attributes.ftLastWriteTime.dwLowDateTime;
+	if (time < kEpochDifference)
+		return 0;
+
+	return (time - kEpochDifference) * 100;
+}
+
+#elif defined(UNIX)
+
+uint64 Platform::getModificationTime(const UString &fileName) {
+	struct stat fileStat;
+	if (stat(boost::filesystem::path(fileName.c_str()).c_str(), &fileStat) != 0)
+		return 0;
+
+#if defined(MACOSX)
+	const struct timespec &time = fileStat.st_mtimespec;
+#else
+	const struct timespec &time = fileStat.st_mtim;
+#endif
+
+	return ((uint64) time.tv_sec) * UINT64_C(1000000000) + (uint64) time.tv_nsec;
+}
+
+#else
+
+uint64 Platform::getModificationTime(const UString &fileName) {
+	std::time_t time = (std::time_t) -1;
+
+	try {
+		time = boost::filesystem::last_write_time(fileName.c_str());
+	} catch (...) {
+	}
+
+	if (time == ((std::time_t) -1))
+		return 0;
+
+	return ((uint64) time) * UINT64_C(1000000000);
+}
+
+#endif
+// '--- getModificationTime() ---'
+
 // .--- OS-specific directories ---.
 UString Platform::getHomeDirectory() {
 	UString directory;
@@ -29,6 +29,7 @@
 
 #include <vector>
 
+#include "src/common/types.h"
 #include "src/common/ustring.h"
 
 namespace Common {
@@ -51,6 +52,31 @@ public:
 	/** Open a file with an UTF-8 encoded name. */
 	static std::FILE *openFile(const UString &fileName, FileMode mode);
 
+	/** Read from an opened file at a specific offset, without using or changing
+	 *  the file position of the std::FILE. Can be called concurrently on the same
+	 *  file from several threads.
+	 *
+	 *  @return The number of bytes that were actually read.
+	 */
+	static size_t readFileAt(std::FILE *file, size_t offset, void *dataPtr, size_t dataSize);
+
+	/** Map the first size bytes of an opened file read-only into memory.
+	 *
+	 *  @return A pointer to the mapped data, or 0 if the file can't be mapped.
+	 */
+	static const byte *mapFile(std::FILE *file, size_t size);
+
+	/** Unmap a file mapping created by mapFile(). */
+	static void unmapFile(const byte *data, size_t size);
+
+	/** Return the time a file was last modified, in nanoseconds since the epoch.
+	 *
+	 *  The actual resolution depends on the OS and the filesystem.
+	 *
+	 *  @return The modification time, or 0 if it can't be determined.
+	 */
+	static uint64 getModificationTime(const UString &fileName);
+
 	/** Return the OS-specific path of the user's home directory. */
 	static UString getHomeDirectory();
 	/** Return the OS-specific path of the config directory. */
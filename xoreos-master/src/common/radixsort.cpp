@@ -0,0 +1,85 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Stable radix sort on 64-bit integer keys.
+ */
+
+#include <cstring>
+
+#include <algorithm>
+
+#include "src/common/radixsort.h"
+
+namespace Common {
+
+static const size_t kRadixBits    = 8;
+static const size_t kRadixBuckets = 1 << kRadixBits;
+static const size_t kRadixPasses  = 64 / kRadixBits;
+
+void radixSort(std::vector<RadixSortKey> &keys, std::vector<RadixSortKey> &scratch) {
+	const size_t count = keys.size();
+	if (count < 2)
+		return;
+
+	// Count the occurrences of all digits in one go
+	size_t histogram[kRadixPasses][kRadixBuckets];
+	std::memset(histogram, 0, sizeof(histogram));
+
+	for (size_t i = 0; i < count; i++) {
+		uint64 key = keys[i].key;
+
+		for (size_t pass = 0; pass < kRadixPasses; pass++, key >>= kRadixBits)
+			histogram[pass][key & (kRadixBuckets - 1)]++;
+	}
+
+	scratch.resize(count);
+
+	RadixSortKey *src = &keys[0];
+	RadixSortKey *dst = &scratch[0];
+
+	for (size_t pass = 0; pass < kRadixPasses; pass++) {
+		size_t *digits = histogram[pass];
+		const size_t shift = pass * kRadixBits;
+
+		// All keys have the same digit here, so this pass wouldn't change anything
+		if (digits[(src[0].key >> shift) & (kRadixBuckets - 1)] == count)
+			continue;
+
+		size_t offset = 0;
+		for (size_t i = 0; i < kRadixBuckets; i++) {
+			const size_t n = digits[i];
+
+			digits[i] = offset;
+			offset   += n;
+		}
+
+		for (size_t i = 0; i < count; i++)
+			dst[digits[(src[i].key >> shift) & (kRadixBuckets - 1)]++] = src[i];
+
+		std::swap(src, dst);
+	}
+
+	// An odd number of passes left the result in the scratch space
+	if (src != &keys[0])
+		keys.swap(scratch);
+}
+
+} // End of namespace Common
@@ -0,0 +1,58 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Stable radix sort on 64-bit integer keys.
+ */
+
+#ifndef COMMON_RADIXSORT_H
+#define COMMON_RADIXSORT_H
+
+#include <vector>
+
+#include "src/common/types.h"
+
+namespace Common {
+
+/** A sort key, together with the index of the element it was created for. */
+struct RadixSortKey {
+	uint64 key;   ///< The value to sort by.
+	uint32 index; ///< Index of the element this key belongs to.
+
+	RadixSortKey() : key(0), index(0) { }
+	RadixSortKey(uint64 k, uint32 i) : key(k), index(i) { }
+};
+
+/** Sort the keys in ascending order of their key values.
+ *
+ *  This is a least significant digit radix sort, 8 bits per pass. The sort is
+ *  stable, so keys with equal values keep their relative order. Passes over
+ *  digits that are the same in all keys are skipped, so keys that only use
+ *  their lower bits are cheap to sort.
+ *
+ *  @param keys    The keys to sort.
+ *  @param scratch Temporary storage. It will be resized to fit the keys, and can
+ *                 be reused across calls to avoid reallocations.
+ */
+void radixSort(std::vector<RadixSortKey> &keys, std::vector<RadixSortKey> &scratch);
+
+} // End of namespace Common
+
+#endif // COMMON_RADIXSORT_H
@@ -23,19 +23,58 @@
  */
 
 #include <cassert>
+#include <cstring>
 
 #include "src/common/readfile.h"
+#include "src/common/util.h"
 #include "src/common/error.h"
 #include "src/common/ustring.h"
 #include "src/common/platform.h"
+#include "src/common/memreadstream.h"
 
 namespace Common {
 
-ReadFile::ReadFile() : _handle(0), _size(kSizeInvalid) {
+/** A read-only memory mapping of a whole file. */
+class ReadFile::Mapping : boost::noncopyable {
+public:
+	Mapping(const byte *data, size_t size) : _data(data), _size(size) {
+	}
+
+	~Mapping() {
+		Platform::unmapFile(_data, _size);
+	}
+
+	const byte *getData() const {
+		return _data;
+	}
+
+private:
+	const byte *_data;
+	size_t _size;
+};
+
+/** A MemoryReadStream view into a file mapping, keeping the mapping alive. */
+class ReadFile::MappedView : public MemoryReadStream {
+public:
+	MappedView(const boost::shared_ptr<Mapping> &mapping, size_t offset, size_t size) :
+		MemoryReadStream(mapping->getData() + offset, size), _mapping(mapping) {
+	}
+
+	~MappedView() {
+	}
+
+private:
+	boost::shared_ptr<Mapping> _mapping;
+};
+
+
+ReadFile::ReadFile() : _handle(0), _size(kSizeInvalid), _pos(0), _eos(false) {
 }
 
-ReadFile::ReadFile(const UString &fileName) : _handle(0), _size(kSizeInvalid) {
-	if (!open(fileName))
+ReadFile::ReadFile(const UString &fileName, bool mapped) :
+	_handle(0), _size(kSizeInvalid), _pos(0), _eos(false) {
+
+	if (!open(fileName, mapped))
 		throw Exception("Can't open file \"%s\"", fileName.c_str());
 }
 
@@ -58,7 +97,7 @@ static long getInitialSize(std::FILE *handle) {
 	return fileSize;
 }
 
-bool ReadFile::open(const UString &fileName) {
+bool ReadFile::open(const UString &fileName, bool mapped) {
 	close();
 
 	long fileSize = -1;
@@ -78,25 +117,55 @@ bool ReadFile::open(const UString &fileName) {
 
 	_size = (size_t)fileSize;
 
+	if (mapped)
+		map(fileName);
+
 	return true;
 }
 
+void ReadFile::map(const UString &fileName) {
+	const byte *data = Platform::mapFile(_handle, _size);
+	if (!data) {
+		if (_size > 0)
+			warning("Failed to map file \"%s\" into memory", fileName.c_str());
+
+		return;
+	}
+
+	_mapping.reset(new Mapping(data, _size));
+
+	_pos = 0;
+	_eos = false;
+}
+
 void ReadFile::close() {
+	_mapping.reset();
+
 	if (_handle)
 		std::fclose(_handle);
 
 	_handle = 0;
 	_size   = kSizeInvalid;
+
+	_pos = 0;
+	_eos = false;
 }
 
 bool ReadFile::isOpen() const {
 	return _handle != 0;
 }
 
+bool ReadFile::isMapped() const {
+	return _mapping.get() != 0;
+}
+
 bool ReadFile::eos() const {
 	if (!_handle)
 		return true;
 
+	if (_mapping)
+		return _eos;
+
 	return std::feof(_handle) != 0;
 }
 
@@ -104,6 +173,9 @@ size_t ReadFile::pos() const {
 	if (!_handle)
 		return kPositionInvalid;
 
+	if (_mapping)
+		return _pos;
+
 	return (size_t)std::ftell(_handle);
 }
 
@@ -121,6 +193,17 @@ size_t ReadFile::seek(ptrdiff_t offset, Origin whence) {
 
 	size_t oldPos = pos();
 
+	if (_mapping) {
+		const size_t newPos = evalSeek(offset, whence, _pos, 0, _size);
+		if (newPos > _size)
+			throw Exception(kSeekError);
+
+		_pos = newPos;
+		_eos = false;
+
+		return oldPos;
+	}
+
 	if (std::fseek(_handle, offset, kSeekToWhence[whence]) != 0)
 		throw Exception(kSeekError);
 
@@ -136,7 +219,46 @@ size_t ReadFile::read(void *dataPtr, size_t dataSize) {
 		return 0;
 
 	assert(dataPtr);
+
+	if (_mapping) {
+		if (dataSize > (_size - _pos)) {
+			dataSize = _size - _pos;
+			_eos = true;
+		}
+
+		std::memcpy(dataPtr, _mapping->getData() + _pos, dataSize);
+		_pos += dataSize;
+
+		return dataSize;
+	}
+
 	return std::fread(dataPtr, 1, dataSize, _handle);
 }
 
+size_t ReadFile::readAt(size_t offset, void *dataPtr, size_t dataSize) {
+	if (!_handle || (offset >= _size))
+		return 0;
+
+	assert(dataPtr);
+
+	dataSize = MIN<size_t>(dataSize, _size - offset);
+
+	if (_mapping) {
+		std::memcpy(dataPtr, _mapping->getData() + offset, dataSize);
+		return dataSize;
+	}
+
+	return Platform::readFileAt(_handle, offset, dataPtr, dataSize);
+}
+
+MemoryReadStream *ReadFile::readStreamAt(size_t offset, size_t dataSize) {
+	if (!_mapping)
+		return SeekableReadStream::readStreamAt(offset, dataSize);
+
+	if ((offset > _size) || (dataSize > (_size - offset)))
+		throw Exception(kReadError);
+
+	return new MappedView(_mapping, offset, dataSize);
+}
+
 } // End of namespace Common
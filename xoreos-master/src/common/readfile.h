@@ -28,6 +28,7 @@
 #include <cstdio>
 
 #include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include "src/common/types.h"
 #include "src/common/readstream.h"
@@ -36,19 +37,31 @@ namespace Common {
 
 class UString;
 
-/** A simple streaming file reading class. */
+/** A simple streaming file reading class.
+ *
+ *  Optionally, the file can be mapped into memory as a whole. In that
+ *  mode, all reads are served directly from the mapping, and
+ *  readStreamAt() returns MemoryReadStream views into the mapping instead
+ *  of copies. These views keep the mapping alive even after the ReadFile
+ *  itself has been destroyed.
+ */
 class ReadFile : boost::noncopyable, public SeekableReadStream {
 public:
 	ReadFile();
-	ReadFile(const UString &fileName);
+	ReadFile(const UString &fileName, bool mapped = false);
 	~ReadFile();
 
 	/** Try to open the file with the given fileName.
+	 *
+	 *  If mapped is true, try to map the whole file into memory. If
+	 *  that fails, the file is silently read through normal file
+	 *  operations instead.
 	 *
 	 *  @param  fileName the name of the file to open
+	 *  @param  mapped   try to map the file into memory?
 	 *  @return true if file was opened successfully, false otherwise
 	 */
-	bool open(const UString &fileName);
+	bool open(const UString &fileName, bool mapped = false);
 
 	/** Close the file, if open. */
 	void close();
@@ -59,6 +72,9 @@ public:
 	 */
 	bool isOpen() const;
 
+	/** Is the file mapped into memory? */
+	bool isMapped() const;
+
 	bool eos() const;
 
 	size_t pos() const;
@@ -67,9 +83,34 @@ public:
 	size_t seek(ptrdiff_t offset, Origin whence = kOriginBegin);
 	size_t read(void *dataPtr, size_t dataSize);
 
+	/** Read from a specific position, using positional reads on the file.
+	 *
+	 *  This neither uses nor changes the stream position, and is safe to be
+	 *  called from several threads at once.
+	 */
+	size_t readAt(size_t offset, void *dataPtr, size_t dataSize);
+
+	/** Return a stream of a part of the file.
+	 *
+	 *  If the file is mapped into memory, this is a view into the mapping
+	 *  that does not copy any data. Otherwise, the data is read into a new
+	 *  buffer.
+	 */
+	MemoryReadStream *readStreamAt(size_t offset, size_t dataSize);
+
 protected:
+	class Mapping;
+	class MappedView;
+
 	std::FILE *_handle; ///< The actual file handle.
 	size_t _size;       ///< The file's size.
+
+	boost::shared_ptr<Mapping> _mapping; ///< The memory mapping of the file, if any.
+
+	size_t _pos; ///< The current position within the mapping.
+	bool   _eos; ///< Did we try to read past the end of the mapping?
+
+	void map(const UString &fileName);
 };
 
 } // End of namespace Common
@@ -80,6 +80,25 @@ SeekableReadStream::SeekableReadStream() {
 SeekableReadStream::~SeekableReadStream() {
 }
 
+size_t SeekableReadStream::readAt(size_t offset, void *dataPtr, size_t dataSize) {
+	const size_t oldPos = pos();
+
+	seek(offset);
+	const size_t bytesRead = read(dataPtr, dataSize);
+	seek(oldPos);
+
+	return bytesRead;
+}
+
+MemoryReadStream *SeekableReadStream::readStreamAt(size_t offset, size_t dataSize) {
+	ScopedArray<byte> buf(new byte[dataSize]);
+
+	if (readAt(offset, buf.get(), dataSize) != dataSize)
+		throw Exception(kReadError);
+
+	return new MemoryReadStream(buf.release(), dataSize, true);
+}
+
 size_t SeekableReadStream::evalSeek(ptrdiff_t offset, Origin whence, size_t pos, size_t begin, size_t size) {
 	switch (whence) {
 		case kOriginEnd:
@@ -162,6 +181,22 @@ size_t SeekableSubReadStream::seek(ptrdiff_t offset, Origin whence) {
 	return oldPos;
 }
 
+size_t SeekableSubReadStream::readAt(size_t offset, void *dataPtr, size_t dataSize) {
+	if (offset >= size())
+		return 0;
+
+	dataSize = MIN<size_t>(dataSize, size() - offset);
+
+	return _parentStream->readAt(_begin + offset, dataPtr, dataSize);
+}
+
+MemoryReadStream *SeekableSubReadStream::readStreamAt(size_t offset, size_t dataSize) {
+	if ((offset > size()) || (dataSize > (size() - offset)))
+		throw Exception(kReadError);
+
+	return _parentStream->readStreamAt(_begin + offset, dataSize);
+}
+
 
 SeekableSubReadStreamEndian::SeekableSubReadStreamEndian(SeekableReadStream *parentStream,
 		size_t begin, size_t end, bool bigEndian, bool disposeParentStream) :
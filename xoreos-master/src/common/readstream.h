@@ -318,6 +318,33 @@ public:
 		return seek(offset, kOriginCurrent);
 	}
 
+	/** Read data from a specific position in the stream, without changing
+	 *  the stream position indicator or the end-of-file indicator.
+	 *
+	 *  The default implementation simply seeks, reads and seeks back. Streams
+	 *  that can read from an arbitrary position without touching any shared
+	 *  state override this. For those (MemoryReadStream, ReadFile and any
+	 *  SeekableSubReadStream on top of them), readAt() may be called from
+	 *  several threads at the same time.
+	 *
+	 *  @param  offset   the position to read from, relative to the start of the stream.
+	 *  @param  dataPtr  pointer to a buffer into which the data is read.
+	 *  @param  dataSize number of bytes to be read.
+	 *  @return the number of bytes that were actually read.
+	 */
+	virtual size_t readAt(size_t offset, void *dataPtr, size_t dataSize);
+
+	/** Read the specified amount of data from a specific position into a new[]'ed
+	 *  buffer which then is wrapped into a MemoryReadStream.
+	 *
+	 *  Like readAt(), this does not change the stream position indicator.
+	 *  When less than dataSize bytes can be read, a kReadError exception is thrown.
+	 *
+	 *  Streams that already hold their data in shared memory (like a mapped
+	 *  ReadFile) may override this to return a view instead of a copy.
+	 */
+	virtual MemoryReadStream *readStreamAt(size_t offset, size_t dataSize);
+
 	/** Evaluate the seek offset relative to whence into a position from the beginning. */
 	static size_t evalSeek(ptrdiff_t offset, Origin whence, size_t pos, size_t begin, size_t size);
 };
@@ -367,6 +394,9 @@ public:
 
 	size_t seek(ptrdiff_t offset, Origin whence = kOriginBegin);
 
+	size_t readAt(size_t offset, void *dataPtr, size_t dataSize);
+	MemoryReadStream *readStreamAt(size_t offset, size_t dataSize);
+
 protected:
 	SeekableReadStream *_parentStream;
 
@@ -44,6 +44,7 @@ src_common_libcommon_la_SOURCES += \
     src/common/mdct.h \
     src/common/threads.h \
     src/common/thread.h \
+    src/common/jobpool.h \
     src/common/mutex.h \
     src/common/ustring.h \
     src/common/hash.h \
@@ -73,6 +74,7 @@ src_common_libcommon_la_SOURCES += \
     src/common/filepath.h \
     src/common/filelist.h \
     src/common/binsearch.h \
+    src/common/radixsort.h \
     src/common/bitstream.h \
     src/common/huffman.h \
     src/common/vector3.h \
@@ -99,6 +101,7 @@ src_common_libcommon_la_SOURCES += \
     src/common/mdct.cpp \
     src/common/threads.cpp \
     src/common/thread.cpp \
+    src/common/jobpool.cpp \
     src/common/mutex.cpp \
     src/common/ustring.cpp \
     src/common/md5.cpp \
@@ -125,6 +128,7 @@ src_common_libcommon_la_SOURCES += \
     src/common/writefile.cpp \
     src/common/filepath.cpp \
     src/common/filelist.cpp \
+    src/common/radixsort.cpp \
     src/common/huffman.cpp \
     src/common/matrix4x4.cpp \
     src/common/boundingbox.cpp \
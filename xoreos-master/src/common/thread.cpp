@@ -46,15 +46,25 @@ bool Thread::createThread(const UString &name) {
 		// Already running, nothing to do
 		return true;
 
+	// Clean up after a previous thread that finished on its own
+	if (_thread)
+		SDL_WaitThread(_thread, 0);
+
+	/* Mark the thread as running before it actually starts, so that
+	 * destroyThread() always waits for it. */
+	_threadRunning = true;
+
 	// Try to create the thread
-	if (!(_thread = SDL_CreateThread(threadHelper, name.empty() ? 0 : name.c_str(), static_cast<void *>(this))))
+	if (!(_thread = SDL_CreateThread(threadHelper, name.empty() ? 0 : name.c_str(), static_cast<void *>(this)))) {
+		_threadRunning = false;
 		return false;
+	}
 
 	return true;
 }
 
 bool Thread::destroyThread() {
-	if (!_threadRunning)
+	if (!_thread)
 		return true;
 
 	// Signal the thread that it should die
@@ -68,6 +78,7 @@ bool Thread::destroyThread() {
 		// Wait for everything to settle
 		SDL_WaitThread(_thread, 0);
 
+		_thread        = 0;
 		_killThread    = false;
 		_threadRunning = false;
 
@@ -76,6 +87,7 @@ bool Thread::destroyThread() {
 
 	/// FIXME: not sure if the thread is really killed
 
+	_thread        = 0;
 	_killThread    = false;
 	_threadRunning = false;
 
@@ -85,9 +97,6 @@ bool Thread::destroyThread() {
 int Thread::threadHelper(void *obj) {
 	Thread *thread = static_cast<Thread *>(obj);
 
-	// The thread is running.
-	thread->_threadRunning = true;
-
 	// Run the thread
 	thread->threadMethod();
 
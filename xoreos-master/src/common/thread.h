@@ -50,7 +50,7 @@ protected:
 private:
 	SDL_Thread *_thread;
 
-	bool _threadRunning;
+	volatile bool _threadRunning;
 
 	virtual void threadMethod() = 0;
 
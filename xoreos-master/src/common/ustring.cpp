@@ -47,8 +47,8 @@ UString::UString(const char *str) {
 	*this = str;
 }
 
-UString::UString(const char *str, size_t n) {
-	*this = std::string(str, n);
+UString::UString(const char *str, size_t n) : _string(str, n) {
+	recalculateSize();
 }
 
 UString::UString(uint32 c, size_t n) : _size(0) {
@@ -166,25 +166,16 @@ UString &UString::operator+=(uint32 c) {
 }
 
 int UString::strcmp(const UString &str) const {
-	UString::iterator it1 = begin();
-	UString::iterator it2 = str.begin();
-	for (; (it1 != end()) && (it2 != str.end()); ++it1, ++it2) {
-		uint32 c1 = *it1;
-		uint32 c2 = *it2;
+	/* UTF-8 sorts bytewise in codepoint order, so there's no need
+	 * to decode the strings to compare them. */
+	const int cmp = std::strcmp(_string.c_str(), str._string.c_str());
 
-		if (c1 < c2)
-			return -1;
-		if (c1 > c2)
-			return  1;
-	}
-
-	if ((it1 == end()) && (it2 == str.end()))
-		return 0;
-
-	if (it1 == end())
+	if (cmp < 0)
 		return -1;
+	if (cmp > 0)
+		return  1;
 
-	return 1;
+	return 0;
 }
 
 int UString::stricmp(const UString &str) const {
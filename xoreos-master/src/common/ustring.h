@@ -25,6 +25,8 @@
 #ifndef COMMON_USTRING_H
 #define COMMON_USTRING_H
 
+#include <cstring>
+
 #include <string>
 #include <sstream>
 #include <vector>
@@ -219,13 +221,12 @@ static inline UString operator+(const char *left, const UString &right) {
 // Hash functions
 
 struct hashUStringCaseSensitive {
+	/** Equal strings have equal UTF-8 encodings, so we can hash the raw
+	 *  bytes instead of decoding every codepoint. */
 	size_t operator()(const UString &str) const {
-		size_t seed = 0;
+		const char *s = str.c_str();
 
-		for (UString::iterator it = str.begin(); it != str.end(); ++it)
-			boost::hash_combine<uint32>(seed, *it);
-
-		return seed;
+		return boost::hash_range(s, s + std::strlen(s));
 	}
 };
 
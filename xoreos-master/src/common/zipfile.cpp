@@ -74,7 +74,11 @@ void ZipFile::load(SeekableReadStream &zip) {
 		 File  file;
 		IFile iFile;
 
-		zip.skip(20);
+		zip.skip(6);
+
+		iFile.compMethod = zip.readUint16LE();
+
+		zip.skip(12);
 
 		iFile.size = zip.readUint32LE();
 
@@ -155,6 +159,10 @@ size_t ZipFile::getFileSize(uint32 index) const {
 	return getIFile(index).size;
 }
 
+bool ZipFile::isFileCompressed(uint32 index) const {
+	return getIFile(index).compMethod != 0;
+}
+
 SeekableReadStream *ZipFile::getFile(uint32 index, bool tryNoCopy) const {
 	const IFile &file = getIFile(index);
 
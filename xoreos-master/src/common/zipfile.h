@@ -58,6 +58,9 @@ public:
 	/** Return the size of a file. */
 	size_t getFileSize(uint32 index) const;
 
+	/** Is this file stored compressed within the ZIP? */
+	bool isFileCompressed(uint32 index) const;
+
 	/** Return a stream of the file's contents. */
 	SeekableReadStream *getFile(uint32 index, bool tryNoCopy = false) const;
 
@@ -66,6 +69,8 @@ private:
 	struct IFile {
 		uint32 offset; ///< The offset of the file within the ZIP.
 		uint32 size;   ///< The file's size.
+
+		uint16 compMethod; ///< The file's compression method.
 	};
 
 	typedef std::vector<IFile> IFileList;
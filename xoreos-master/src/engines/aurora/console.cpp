@@ -33,10 +33,13 @@
 #include "src/common/filepath.h"
 #include "src/common/readline.h"
 #include "src/common/configman.h"
+#include "src/common/writefile.h"
 
 #include "src/aurora/resman.h"
 #include "src/aurora/talkman.h"
 
+#include "src/aurora/nwscript/profiler.h"
+
 #include "src/graphics/graphics.h"
 #include "src/graphics/font.h"
 #include "src/graphics/camera.h"
@@ -729,6 +732,12 @@ Console::Console(Engine &engine, const Common::UString &font, int fontHeight) :
 			"Usage: dump2da <2da>\nDump a 2DA to file");
 	registerCommand("dumpall2da" , boost::bind(&Console::cmdDumpAll2DA , this, _1),
 			"Usage: dumpall2da\nDump all 2DA to file");
+	registerCommand("rescache"   , boost::bind(&Console::cmdResCache   , this, _1),
+			"Usage: rescache [clear]\nPrint the resource cache statistics, or clear the cache");
+	registerCommand("scriptprof" , boost::bind(&Console::cmdScriptProf , this, _1),
+			"Usage: scriptprof [on|off|clear]\n       scriptprof dump <file>\n"
+			"Print the script profile, turn the profiler on or off, clear it,\n"
+			"or dump the call stacks in folded format, for flame graphs");
 	registerCommand("listvideos" , boost::bind(&Console::cmdListVideos , this, _1),
 			"Usage: listvideos\nList all available videos");
 	registerCommand("playvideo"  , boost::bind(&Console::cmdPlayVideo  , this, _1),
@@ -739,6 +748,8 @@ Console::Console(Engine &engine, const Common::UString &font, int fontHeight) :
 			"Usage: playsound <sound>\nPlay the specified sound");
 	registerCommand("silence"    , boost::bind(&Console::cmdSilence    , this, _1),
 			"Usage: silence\nStop all playing sounds and music");
+	registerCommand("sndcache"   , boost::bind(&Console::cmdSndCache   , this, _1),
+			"Usage: sndcache [clear]\nPrint the sample cache statistics, or clear the cache");
 	registerCommand("getoption"  , boost::bind(&Console::cmdGetOption  , this, _1),
 			"Usage: getoption <option>\nPrint the value of a config options");
 	registerCommand("setoption"  , boost::bind(&Console::cmdSetOption  , this, _1),
@@ -1253,6 +1264,100 @@ void Console::cmdDumpAll2DA(const CommandLine &UNUSED(cl)) {
 	}
 }
 
+void Console::cmdResCache(const CommandLine &cl) {
+	if (cl.args == "clear") {
+		ResMan.clearCache();
+		printf("Cleared the resource cache");
+		return;
+	}
+
+	if (!cl.args.empty()) {
+		printCommandHelp(cl.cmd);
+		return;
+	}
+
+	Aurora::ResourceManager::CacheStats stats;
+	ResMan.getCacheStats(stats);
+
+	if (stats.budget == 0) {
+		printf("The resource cache is disabled");
+		return;
+	}
+
+	printf("Resource cache: %s / %s bytes in %s resources",
+	       Common::composeString(stats.size).c_str(), Common::composeString(stats.budget).c_str(),
+	       Common::composeString(stats.count).c_str());
+	printf("Hits: %s, misses: %s, evictions: %s",
+	       Common::composeString(stats.hits).c_str(), Common::composeString(stats.misses).c_str(),
+	       Common::composeString(stats.evictions).c_str());
+}
+
+void Console::cmdScriptProf(const CommandLine &cl) {
+	std::vector<Common::UString> args;
+	splitArguments(cl.args, args);
+
+	if ((args.size() == 1) && ((args[0] == "on") || (args[0] == "off"))) {
+		NCSProfile.setEnabled(args[0] == "on");
+		printf("Script profiler %s", NCSProfile.isEnabled() ? "enabled" : "disabled");
+		return;
+	}
+
+	if ((args.size() == 1) && (args[0] == "clear")) {
+		NCSProfile.clear();
+		printf("Cleared the script profile");
+		return;
+	}
+
+	if ((args.size() == 2) && (args[0] == "dump")) {
+		const Common::UString file = Common::FilePath::getUserDataFile(args[1]);
+
+		try {
+			Common::WriteFile stream(file);
+
+			NCSProfile.writeFoldedStacks(stream);
+			stream.flush();
+
+		} catch (Common::Exception &e) {
+			printException(e, "WARNING: ");
+			return;
+		}
+
+		printf("Dumped the script call stacks to \"%s\"", file.c_str());
+		return;
+	}
+
+	if (!args.empty()) {
+		printCommandHelp(cl.cmd);
+		return;
+	}
+
+	static const size_t kMaxEntries = 10;
+	static const char * const kCategoryNames[Aurora::NWScript::NCSProfiler::kCategoryMAX] = {
+		"Scripts", "Subroutines", "Engine functions"
+	};
+
+	if (!NCSProfile.isEnabled())
+		printf("The script profiler is disabled");
+
+	for (size_t i = 0; i < Aurora::NWScript::NCSProfiler::kCategoryMAX; i++) {
+		std::vector<Aurora::NWScript::NCSProfiler::Entry> entries;
+		NCSProfile.getEntries((Aurora::NWScript::NCSProfiler::Category) i, entries);
+
+		printf("%s (%u):", kCategoryNames[i], (uint)entries.size());
+
+		for (size_t j = 0; j < MIN(entries.size(), kMaxEntries); j++) {
+			const Aurora::NWScript::NCSProfiler::Entry &entry = entries[j];
+
+			printf("  %-32s %8s calls, %10s us (%10s us self), %10s instr, %8s allocs",
+			       entry.name.c_str(), Common::composeString(entry.calls).c_str(),
+			       Common::composeString(entry.totalTime).c_str(),
+			       Common::composeString(entry.selfTime).c_str(),
+			       Common::composeString(entry.instructions).c_str(),
+			       Common::composeString(entry.allocations).c_str());
+		}
+	}
+}
+
 void Console::cmdListVideos(const CommandLine &UNUSED(cl)) {
 	updateVideos();
 	printList(_videos, _maxSizeVideos);
@@ -1285,6 +1390,38 @@ void Console::cmdSilence(const CommandLine &UNUSED(cl)) {
 	SoundMan.stopAll();
 }
 
+void Console::cmdSndCache(const CommandLine &cl) {
+	if (cl.args == "clear") {
+		SoundMan.clearSampleCache();
+		printf("Cleared the sample cache");
+		return;
+	}
+
+	if (!cl.args.empty()) {
+		printCommandHelp(cl.cmd);
+		return;
+	}
+
+	Sound::SampleCache::Stats stats;
+	SoundMan.getSampleCacheStats(stats);
+
+	if (stats.budget == 0) {
+		printf("The sample cache is disabled");
+		return;
+	}
+
+	const uint64 requests = stats.hits + stats.misses;
+	const double hitRate  = (requests > 0) ? ((stats.hits * 100.0) / requests) : 0.0;
+
+	printf("Sample cache: %s / %s bytes in %s sounds of up to %ums, %s known to be too long",
+	       Common::composeString(stats.size).c_str(), Common::composeString(stats.budget).c_str(),
+	       Common::composeString(stats.count).c_str(), stats.maxDuration,
+	       Common::composeString(stats.tooLong).c_str());
+	printf("Hits: %s, misses: %s (%.1f%% hit rate), evictions: %s",
+	       Common::composeString(stats.hits).c_str(), Common::composeString(stats.misses).c_str(),
+	       hitRate, Common::composeString(stats.evictions).c_str());
+}
+
 void Console::cmdGetOption(const CommandLine &cl) {
 	std::vector<Common::UString> args;
 	splitArguments(cl.args, args);
@@ -1562,6 +1699,15 @@ void Console::splitArguments(Common::UString argLine, std::vector<Common::UStrin
 		args.pop_back();
 }
 
+void Console::printActionStats(const Aurora::NWScript::ActionScheduler::Stats &stats) {
+	printf("Pending actions: %s (peak %s)",
+	       Common::composeString(stats.pending).c_str(), Common::composeString(stats.peakPending).c_str());
+	printf("Scheduled: %s, executed: %s, deferred frames: %s",
+	       Common::composeString(stats.scheduled).c_str(), Common::composeString(stats.executed).c_str(),
+	       Common::composeString(stats.deferrals).c_str());
+	printf("Latency: %.2fms average, %ums maximum", stats.getAverageLatency(), stats.maxLatency);
+}
+
 void Console::setArguments(const Common::UString &cmd, const std::vector<Common::UString> &args) {
 	_readLine->setArguments(cmd, args);
 }
@@ -38,6 +38,8 @@
 #include "src/common/ustring.h"
 #include "src/common/writefile.h"
 
+#include "src/aurora/nwscript/actionscheduler.h"
+
 #include "src/events/types.h"
 #include "src/events/notifyable.h"
 
@@ -229,6 +231,9 @@ protected:
 	void printCommandHelp(const Common::UString &cmd);
 	void printList(const std::vector<Common::UString> &list, size_t maxSize = 0);
 
+	/** Print the statistics of a module's delayed script actions. */
+	void printActionStats(const Aurora::NWScript::ActionScheduler::Stats &stats);
+
 	void setArguments(const Common::UString &cmd, const std::vector<Common::UString> &args);
 	void setArguments(const Common::UString &cmd);
 
@@ -292,11 +297,14 @@ private:
 	void cmdDumpTGA    (const CommandLine &cl);
 	void cmdDump2DA    (const CommandLine &cl);
 	void cmdDumpAll2DA (const CommandLine &cl);
+	void cmdResCache   (const CommandLine &cl);
+	void cmdScriptProf (const CommandLine &cl);
 	void cmdListVideos (const CommandLine &cl);
 	void cmdPlayVideo  (const CommandLine &cl);
 	void cmdListSounds (const CommandLine &cl);
 	void cmdPlaySound  (const CommandLine &cl);
 	void cmdSilence    (const CommandLine &cl);
+	void cmdSndCache   (const CommandLine &cl);
 	void cmdGetOption  (const CommandLine &cl);
 	void cmdSetOption  (const CommandLine &cl);
 	void cmdShowFPS    (const CommandLine &cl);
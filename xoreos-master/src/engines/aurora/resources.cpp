@@ -66,6 +66,41 @@ void indexMandatoryArchive(const Common::UString &file, uint32 priority, ChangeL
 	indexMandatoryArchive(file, priority, password, changes);
 }
 
+static void indexMandatoryArchives(const std::vector<Common::UString> &files, uint32 priority,
+                                   ChangeList *changes) {
+
+	if (EventMan.quitRequested())
+		return;
+
+	std::vector<Aurora::ResourceManager::BatchArchive> archives;
+	archives.reserve(files.size());
+
+	for (std::vector<Common::UString>::const_iterator f = files.begin(); f != files.end(); ++f) {
+		Common::ChangeID *changeID = 0;
+		if (changes) {
+			changes->push_back(Common::ChangeID());
+			changeID = &changes->back();
+		}
+
+		archives.push_back(Aurora::ResourceManager::BatchArchive(*f, priority++, changeID));
+	}
+
+	try {
+		ResMan.indexArchives(archives);
+	} catch (Common::Exception &e) {
+		e.add("Failed to index mandatory archives");
+		throw;
+	}
+}
+
+void indexMandatoryArchives(const std::vector<Common::UString> &files, uint32 priority) {
+	indexMandatoryArchives(files, priority, 0);
+}
+
+void indexMandatoryArchives(const std::vector<Common::UString> &files, uint32 priority, ChangeList &changes) {
+	indexMandatoryArchives(files, priority, &changes);
+}
+
 bool indexOptionalArchive(const Common::UString &file, uint32 priority, const std::vector<byte> &password,
                           Common::ChangeID *changeID) {
 
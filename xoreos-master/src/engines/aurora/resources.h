@@ -56,6 +56,14 @@ bool indexOptionalArchive(const Common::UString &file, uint32 priority, const st
 bool indexOptionalArchive(const Common::UString &file, uint32 priority, const std::vector<byte> &password,
                           ChangeList &changes);
 
+/** Add several archive files to the resource manager, erroring out if any of them does not exist.
+ *
+ *  The archives are read in parallel, but indexed in order, with the priority counting
+ *  upwards from the given priority.
+ */
+void indexMandatoryArchives(const std::vector<Common::UString> &files, uint32 priority);
+void indexMandatoryArchives(const std::vector<Common::UString> &files, uint32 priority, ChangeList &changes);
+
 /** Add a directory to the resource manager, erroring out if it does not exist. */
 void indexMandatoryDirectory(const Common::UString &dir, const char *glob, int depth,
                              uint32 priority, Common::ChangeID *changeID = 0);
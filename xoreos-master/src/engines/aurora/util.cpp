@@ -87,11 +87,26 @@ Sound::ChannelHandle playSound(const Common::UString &sound, Sound::SoundType so
 	Sound::ChannelHandle channel;
 
 	try {
-		Common::SeekableReadStream *soundStream = ResMan.getResource(resType, sound);
-		if (!soundStream)
-			return channel;
+		/* Short sound effects are kept decoded in the sample cache. Whenever the
+		 * resources change, the cache is flushed, so that stale sounds are never played. */
+		Common::UString cacheName;
+		if (soundType != Sound::kSoundTypeMusic) {
+			cacheName = Common::UString::format("%s.%d", sound.c_str(), (int) resType);
+
+			SoundMan.validateSampleCache(ResMan.getChangeCount());
+			channel = SoundMan.playCachedSound(cacheName, soundType, loop);
+		}
+
+		if (!SoundMan.isValidChannel(channel)) {
+			Common::SeekableReadStream *soundStream = ResMan.getResource(resType, sound);
+			if (!soundStream)
+				return channel;
 
-		channel = SoundMan.playSoundFile(soundStream, soundType, loop);
+			if (cacheName.empty())
+				channel = SoundMan.playSoundFile(soundStream, soundType, loop);
+			else
+				channel = SoundMan.playSoundFile(cacheName, soundStream, soundType, loop);
+		}
 
 		debugC(Common::kDebugEngineSound, 1, "Playing sound \"%s\" in %s",
 		       sound.c_str(), SoundMan.formatChannel(channel).c_str());
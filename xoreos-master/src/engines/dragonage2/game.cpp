@@ -23,6 +23,7 @@
  */
 
 #include <cassert>
+#include <vector>
 
 #include "src/common/error.h"
 #include "src/common/filelist.h"
@@ -188,10 +189,13 @@ void Game::loadResourceDir(const Common::UString &dir, uint32 priority, ChangeLi
 	files.sort(true);
 	files.relativize(ResMan.getDataBase());
 
+	std::vector<Common::UString> archives;
 	for (Common::FileList::const_iterator f = files.begin(); f != files.end(); ++f)
 		if (Common::FilePath::getExtension(*f).equalsIgnoreCase(".erf") ||
 		    Common::FilePath::getExtension(*f).equalsIgnoreCase(".rimp"))
-			indexMandatoryArchive("/" + *f, priority++, changes);
+			archives.push_back("/" + *f);
+
+	indexMandatoryArchives(archives, priority, changes);
 }
 
 void Game::unloadTalkTables(ChangeList &changes) {
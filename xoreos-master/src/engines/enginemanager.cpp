@@ -217,11 +217,33 @@ void GameInstanceEngine::listLanguages() {
 }
 
 void GameInstanceEngine::run() {
+	// The size of the decoded resource cache is configured in MiB
+	const int cacheSize = ConfigMan.getInt("resourcecache", 0);
+	ResMan.setCacheSize(((size_t) MAX(cacheSize, 0)) * 1024 * 1024);
+
+	if (ConfigMan.getBool("indexcache", true))
+		ResMan.openIndexCache(Common::FilePath::getUserDataFile("resourceindex.cache"));
+
+	const Common::UString tlkDecode = ConfigMan.getString("tlkdecode", "lazy");
+	if      (tlkDecode.equalsIgnoreCase("load"))
+		TalkMan.setDecodeMode(Aurora::TalkManager::kDecodeLoad);
+	else if (tlkDecode.equalsIgnoreCase("background"))
+		TalkMan.setDecodeMode(Aurora::TalkManager::kDecodeBackground);
+	else
+		TalkMan.setDecodeMode(Aurora::TalkManager::kDecodeLazy);
+
 	createEngine();
 
 	_engine->start(_probe->getGameID(), _target, _probe->getPlatform());
 
 	destroyEngine();
+
+	try {
+		ResMan.closeIndexCache();
+	} catch (Common::Exception &e) {
+		e.add("Failed to write the resource index cache");
+		Common::printException(e, "WARNING: ");
+	}
 }
 
 
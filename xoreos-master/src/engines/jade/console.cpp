@@ -55,6 +55,8 @@ Console::Console(JadeEngine &engine) :
 			"Usage: listmodules\nList all modules");
 	registerCommand("loadmodule" , boost::bind(&Console::cmdLoadModule , this, _1),
 			"Usage: loadmodule <module>\nLoad and enter the specified module");
+	registerCommand("actionstats", boost::bind(&Console::cmdActionStats, this, _1),
+			"Usage: actionstats\nPrint statistics about the delayed script actions");
 }
 
 Console::~Console() {
@@ -100,6 +102,10 @@ void Console::cmdLoadModule(const CommandLine &cl) {
 	printf("No such module \"%s\"", cl.args.c_str());
 }
 
+void Console::cmdActionStats(const CommandLine &UNUSED(cl)) {
+	printActionStats(_engine->getGame().getModule().getActionStats());
+}
+
 } // End of namespace Jade
 
 } // End of namespace Engines
@@ -56,6 +56,7 @@ private:
 	void cmdExitModule (const CommandLine &cl);
 	void cmdListModules(const CommandLine &cl);
 	void cmdLoadModule (const CommandLine &cl);
+	void cmdActionStats(const CommandLine &cl);
 };
 
 } // End of namespace Jade
@@ -204,11 +204,7 @@ void Functions::getObjectByTag(Aurora::NWScript::FunctionContext &ctx) {
 
 	int nth = ctx.getParams()[1].getInt();
 
-	Common::ScopedPtr<Aurora::NWScript::ObjectSearch> search(_game->getModule().findObjectsByTag(tag));
-	while (nth-- > 0)
-		search->next();
-
-	ctx.getReturn() = search->get();
+	ctx.getReturn() = _game->getModule().getObjectByTag(tag, MAX(nth, 0));
 }
 
 void Functions::getWaypointByTag(Aurora::NWScript::FunctionContext &ctx) {
@@ -218,10 +214,10 @@ void Functions::getWaypointByTag(Aurora::NWScript::FunctionContext &ctx) {
 	if (tag.empty())
 		return;
 
-	Common::ScopedPtr<Aurora::NWScript::ObjectSearch> search(_game->getModule().findObjectsByTag(tag));
+	Aurora::NWScript::SearchTag search(_game->getModule(), tag);
 	Aurora::NWScript::Object *object = 0;
 
-	while ((object = search->next())) {
+	while ((object = search.next())) {
 		Waypoint *waypoint = Jade::ObjectContainer::toWaypoint(object);
 
 		if (waypoint) {
@@ -62,6 +62,8 @@ Console::Console(KotOREngine &engine) :
 	registerCommand("playmusic"  , boost::bind(&Console::cmdPlayMusic  , this, _1),
 			"Usage: playmusic [<music>]\nPlay the specified music resource. "
 			"If none was specified, play the default area music.");
+	registerCommand("actionstats", boost::bind(&Console::cmdActionStats, this, _1),
+			"Usage: actionstats\nPrint statistics about the delayed script actions");
 }
 
 Console::~Console() {
@@ -141,6 +143,10 @@ void Console::cmdPlayMusic(const CommandLine &cl) {
 	_engine->getGame().playMusic(cl.args);
 }
 
+void Console::cmdActionStats(const CommandLine &UNUSED(cl)) {
+	printActionStats(_engine->getGame().getModule().getActionStats());
+}
+
 } // End of namespace KotOR
 
 } // End of namespace Engines
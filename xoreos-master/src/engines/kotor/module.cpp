@@ -55,11 +55,6 @@ namespace Engines {
 
 namespace KotOR {
 
-bool Module::Action::operator<(const Action &s) const {
-	return timestamp < s.timestamp;
-}
-
-
 Module::Module(::Engines::Console &console) : Object(kObjectTypeModule),
 	_console(&console), _hasModule(false), _running(false),
 	_currentTexturePack(-1), _exit(false), _entryLocationType(kObjectTypeAll),
@@ -339,12 +334,12 @@ bool Module::getObjectLocation(const Common::UString &object, ObjectType locatio
 	if (object.empty())
 		return false;
 
-	Common::ScopedPtr<Aurora::NWScript::ObjectSearch> search(findObjectsByTag(object));
+	Aurora::NWScript::SearchTag search(*this, object);
 
 
 	KotOR::Object *kotorObject = 0;
-	while (!kotorObject && search->get()) {
-		kotorObject = KotOR::ObjectContainer::toObject(search->next());
+	while (!kotorObject && search.get()) {
+		kotorObject = KotOR::ObjectContainer::toObject(search.next());
 		if (!kotorObject || !(kotorObject->getType() & location))
 			kotorObject = 0;
 	}
@@ -459,20 +454,7 @@ void Module::handleEvents() {
 }
 
 void Module::handleActions() {
-	uint32 now = EventMan.getTimestamp();
-
-	while (!_delayedActions.empty()) {
-		ActionQueue::iterator action = _delayedActions.begin();
-
-		if (now < action->timestamp)
-			break;
-
-		if (action->type == kActionScript)
-			ScriptContainer::runScript(action->script, action->state,
-			                           action->owner, action->triggerer);
-
-		_delayedActions.erase(action);
-	}
+	_delayedActions.run(EventMan.getTimestamp());
 }
 
 void Module::movePC(float x, float y, float z) {
@@ -535,16 +517,11 @@ void Module::delayScript(const Common::UString &script,
                          const Aurora::NWScript::ScriptState &state,
                          Aurora::NWScript::Object *owner,
                          Aurora::NWScript::Object *triggerer, uint32 delay) {
-	Action action;
-
-	action.type      = kActionScript;
-	action.script    = script;
-	action.state     = state;
-	action.owner     = owner;
-	action.triggerer = triggerer;
-	action.timestamp = EventMan.getTimestamp() + delay;
+	_delayedActions.schedule(EventMan.getTimestamp(), delay, script, state, owner, triggerer);
+}
 
-	_delayedActions.insert(action);
+const Aurora::NWScript::ActionScheduler::Stats &Module::getActionStats() const {
+	return _delayedActions.getStats();
 }
 
 Common::UString Module::getName(const Common::UString &module) {
@@ -26,7 +26,6 @@
 #define ENGINES_KOTOR_MODULE_H
 
 #include <list>
-#include <set>
 
 #include "src/common/scopedptr.h"
 #include "src/common/ustring.h"
@@ -35,6 +34,8 @@
 
 #include "src/aurora/ifofile.h"
 
+#include "src/aurora/nwscript/actionscheduler.h"
+
 #include "src/graphics/aurora/fadequad.h"
 
 #include "src/events/types.h"
@@ -102,6 +103,9 @@ public:
 	                 Aurora::NWScript::Object *owner, Aurora::NWScript::Object *triggerer,
 	                 uint32 delay);
 
+	/** Return statistics about the delayed script actions. */
+	const Aurora::NWScript::ActionScheduler::Stats &getActionStats() const;
+
 	// .--- PC management
 	/** Move the player character to this position within the current area. */
 	void movePC(float x, float y, float z);
@@ -137,27 +141,7 @@ public:
 	// '---
 
 private:
-	enum ActionType {
-		kActionNone   = 0,
-		kActionScript = 1
-	};
-
-	struct Action {
-		ActionType type;
-
-		Common::UString script;
-
-		Aurora::NWScript::ScriptState state;
-		Aurora::NWScript::Object *owner;
-		Aurora::NWScript::Object *triggerer;
-
-		uint32 timestamp;
-
-		bool operator<(const Action &s) const;
-	};
-
 	typedef std::list<Events::Event> EventQueue;
-	typedef std::multiset<Action> ActionQueue;
 
 
 	::Engines::Console *_console;
@@ -194,8 +178,10 @@ private:
 
 	Common::ScopedPtr<IngameGUI> _ingame; ///< The ingame ui.
 
-	EventQueue  _eventQueue;
-	ActionQueue _delayedActions;
+	EventQueue _eventQueue;
+
+	/** Delayed script actions, like those created by DelayCommand(). */
+	Aurora::NWScript::ActionScheduler _delayedActions;
 
 
 	// .--- Unloading
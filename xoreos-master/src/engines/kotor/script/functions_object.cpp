@@ -66,12 +66,7 @@ void Functions::getObjectByTag(Aurora::NWScript::FunctionContext &ctx) {
 	Common::UString name = ctx.getParams()[0].getString();
 	int nth = ctx.getParams()[1].getInt();
 
-	Aurora::NWScript::ObjectSearch* search = _game->getModule().findObjectsByTag(name);
-	for (int i = 0; i < nth; ++i) {
-		search->next();
-	}
-
-	ctx.getReturn() = search->get();
+	ctx.getReturn() = _game->getModule().getObjectByTag(name, MAX(nth, 0));
 }
 
 void Functions::getMinOneHP(Aurora::NWScript::FunctionContext &ctx) {
@@ -324,12 +324,12 @@ bool Module::getObjectLocation(const Common::UString &object, ObjectType locatio
 	if (object.empty())
 		return false;
 
-	Common::ScopedPtr<Aurora::NWScript::ObjectSearch> search(findObjectsByTag(object));
+	Aurora::NWScript::SearchTag search(*this, object);
 
 
 	KotOR2::Object *kotorObject = 0;
-	while (!kotorObject && search->get()) {
-		kotorObject = KotOR2::ObjectContainer::toObject(search->next());
+	while (!kotorObject && search.get()) {
+		kotorObject = KotOR2::ObjectContainer::toObject(search.next());
 		if (!kotorObject || !(kotorObject->getType() & location))
 			kotorObject = 0;
 	}
@@ -86,6 +86,13 @@ void Area::load() {
 }
 
 void Area::clear() {
+	// Objects still in this area, owned by us or not, need to forget about it
+	std::vector<Aurora::NWScript::Object *> objects;
+	_objectGrid.getObjects(objects);
+
+	for (std::vector<Aurora::NWScript::Object *>::iterator o = objects.begin(); o != objects.end(); ++o)
+		static_cast<NWN::Object *>(*o)->setArea(0);
+
 	// Delete objects
 	for (ObjectList::iterator o = _objects.begin(); o != _objects.end(); ++o)
 		_module->removeObject(**o);
@@ -618,6 +625,39 @@ void Area::removeFocus() {
 	_activeObject = 0;
 }
 
+void Area::notifyObjectMoved(NWN::Object &object) {
+	float x, y, z;
+	object.getPosition(x, y, z);
+
+	// Objects of invalid types never match any type bitfield
+	uint32 type = (uint32) object.getType();
+	if (type >= kObjectTypeMAX)
+		type = 0;
+
+	_objectGrid.setObject(object, x, y, z, type);
+}
+
+void Area::notifyObjectLeft(NWN::Object &object) {
+	_objectGrid.removeObject(object);
+}
+
+NWN::Object *Area::getNearestObject(const NWN::Object &target, uint32 types, size_t nth) const {
+	float x, y, z;
+	target.getPosition(x, y, z);
+
+	return static_cast<NWN::Object *>(_objectGrid.getNearest(x, y, z, nth, types, "", &target));
+}
+
+NWN::Object *Area::getNearestObjectByTag(const NWN::Object &target, const Common::UString &tag,
+                                         size_t nth) const {
+
+	float x, y, z;
+	target.getPosition(x, y, z);
+
+	return static_cast<NWN::Object *>(_objectGrid.getNearest(x, y, z, nth,
+		Aurora::NWScript::ObjectGrid::kTypeAny, tag, &target));
+}
+
 void Area::notifyCameraMoved() {
 	checkActive();
 }
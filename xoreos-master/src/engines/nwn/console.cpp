@@ -27,6 +27,7 @@
 #include <boost/bind.hpp>
 
 #include "src/common/ustring.h"
+#include "src/common/strutil.h"
 #include "src/common/util.h"
 #include "src/common/configman.h"
 
@@ -86,6 +87,8 @@ Console::Console(NWNEngine &engine) :
 	registerCommand("playmusic"    , boost::bind(&Console::cmdPlayMusic    , this, _1),
 			"Usage: playmusic [<music>]\nPlay the specified music resource. "
 			"If none was specified, play the default area music.");
+	registerCommand("actionstats"  , boost::bind(&Console::cmdActionStats  , this, _1),
+			"Usage: actionstats\nPrint statistics about the delayed script actions");
 }
 
 Console::~Console() {
@@ -233,6 +236,10 @@ void Console::cmdListAreas(const CommandLine &UNUSED(cl)) {
 		printf("%s (\"%s\")", a->c_str(), Area::getName(*a).c_str());
 }
 
+void Console::cmdActionStats(const CommandLine &UNUSED(cl)) {
+	printActionStats(_engine->getGame().getModule().getActionStats());
+}
+
 void Console::cmdGotoArea(const CommandLine &cl) {
 	if (cl.args.empty()) {
 		printCommandHelp(cl.cmd);
@@ -79,6 +79,7 @@ private:
 	void cmdListMusic    (const CommandLine &cl);
 	void cmdStopMusic    (const CommandLine &cl);
 	void cmdPlayMusic    (const CommandLine &cl);
+	void cmdActionStats  (const CommandLine &cl);
 };
 
 } // End of namespace NWN
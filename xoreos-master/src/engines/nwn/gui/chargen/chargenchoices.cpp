@@ -22,6 +22,8 @@
  *  The character choices in the character generator.
  */
 
+#include <map>
+
 #include "src/common/util.h"
 
 #include "src/aurora/2dareg.h"
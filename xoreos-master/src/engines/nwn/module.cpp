@@ -97,11 +97,6 @@ namespace Engines {
 
 namespace NWN {
 
-bool Module::Action::operator<(const Action &s) const {
-	return timestamp < s.timestamp;
-}
-
-
 Module::Module(::Engines::Console &console, const Version &gameVersion) : Object(kObjectTypeModule),
 	_console(&console), _gameVersion(&gameVersion), _hasModule(false),
 	_running(false), _currentTexturePack(-1), _exit(false), _currentArea(0) {
@@ -512,20 +507,7 @@ void Module::handleEvents() {
 }
 
 void Module::handleActions() {
-	uint32 now = EventMan.getTimestamp();
-
-	while (!_delayedActions.empty()) {
-		ActionQueue::iterator action = _delayedActions.begin();
-
-		if (now < action->timestamp)
-			break;
-
-		if (action->type == kActionScript)
-			ScriptContainer::runScript(action->script, action->state,
-			                           action->owner, action->triggerer);
-
-		_delayedActions.erase(action);
-	}
+	_delayedActions.run(EventMan.getTimestamp());
 }
 
 void Module::unload(bool completeUnload) {
@@ -753,16 +735,11 @@ void Module::delayScript(const Common::UString &script,
                          const Aurora::NWScript::ScriptState &state,
                          Aurora::NWScript::Object *owner,
                          Aurora::NWScript::Object *triggerer, uint32 delay) {
-	Action action;
-
-	action.type      = kActionScript;
-	action.script    = script;
-	action.state     = state;
-	action.owner     = owner;
-	action.triggerer = triggerer;
-	action.timestamp = EventMan.getTimestamp() + delay;
+	_delayedActions.schedule(EventMan.getTimestamp(), delay, script, state, owner, triggerer);
+}
 
-	_delayedActions.insert(action);
+const Aurora::NWScript::ActionScheduler::Stats &Module::getActionStats() const {
+	return _delayedActions.getStats();
 }
 
 Common::UString Module::getDescriptionExtra(Common::UString module) {
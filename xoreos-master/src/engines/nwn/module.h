@@ -27,7 +27,6 @@
 
 #include <list>
 #include <map>
-#include <set>
 
 #include "src/common/scopedptr.h"
 #include "src/common/ptrmap.h"
@@ -36,6 +35,8 @@
 
 #include "src/aurora/ifofile.h"
 
+#include "src/aurora/nwscript/actionscheduler.h"
+
 #include "src/graphics/aurora/types.h"
 
 #include "src/events/types.h"
@@ -117,6 +118,9 @@ public:
 	                 Aurora::NWScript::Object *owner, Aurora::NWScript::Object *triggerer,
 	                 uint32 delay);
 
+	/** Return statistics about the delayed script actions. */
+	const Aurora::NWScript::ActionScheduler::Stats &getActionStats() const;
+
 	// .--- PC management
 	/** Move the player character to this area. */
 	void movePC(const Common::UString &area);
@@ -147,29 +151,9 @@ public:
 	// '---
 
 private:
-	enum ActionType {
-		kActionNone   = 0,
-		kActionScript = 1
-	};
-
-	struct Action {
-		ActionType type;
-
-		Common::UString script;
-
-		Aurora::NWScript::ScriptState state;
-		Aurora::NWScript::Object *owner;
-		Aurora::NWScript::Object *triggerer;
-
-		uint32 timestamp;
-
-		bool operator<(const Action &s) const;
-	};
-
 	typedef Common::PtrMap<Common::UString, Area> AreaMap;
 
 	typedef std::list<Events::Event> EventQueue;
-	typedef std::multiset<Action> ActionQueue;
 
 
 	::Engines::Console *_console;
@@ -205,8 +189,10 @@ private:
 
 	Common::UString _newModule; ///< The module we should change to.
 
-	EventQueue  _eventQueue;
-	ActionQueue _delayedActions;
+	EventQueue _eventQueue;
+
+	/** Delayed script actions, like those created by DelayCommand(). */
+	Aurora::NWScript::ActionScheduler _delayedActions;
 
 
 	// .--- Unloading
@@ -43,6 +43,7 @@
 
 #include "src/engines/nwn/types.h"
 #include "src/engines/nwn/object.h"
+#include "src/engines/nwn/area.h"
 
 namespace Engines {
 
@@ -64,6 +65,9 @@ Object::Object(ObjectType type) : _type(type),
 }
 
 Object::~Object() {
+	if (_area)
+		_area->notifyObjectLeft(*this);
+
 	destroyTooltip();
 }
 
@@ -135,7 +139,13 @@ Area *Object::getArea() const {
 }
 
 void Object::setArea(Area *area) {
+	if (_area)
+		_area->notifyObjectLeft(*this);
+
 	_area = area;
+
+	if (_area)
+		_area->notifyObjectMoved(*this);
 }
 
 Location Object::getLocation() const {
@@ -168,6 +178,9 @@ void Object::setPosition(float x, float y, float z) {
 	_position[0] = x;
 	_position[1] = y;
 	_position[2] = z;
+
+	if (_area)
+		_area->notifyObjectMoved(*this);
 }
 
 void Object::setOrientation(float x, float y, float z, float angle) {
@@ -88,6 +88,13 @@ Area::~Area() {
 }
 
 void Area::clear() {
+	// Objects still in this area, owned by us or not, need to forget about it
+	std::vector<Aurora::NWScript::Object *> objects;
+	_objectGrid.getObjects(objects);
+
+	for (std::vector<Aurora::NWScript::Object *>::iterator o = objects.begin(); o != objects.end(); ++o)
+		static_cast<NWN2::Object *>(*o)->setArea(0);
+
 	// Delete objects
 	for (ObjectList::iterator o = _objects.begin(); o != _objects.end(); ++o)
 		_module->removeObject(**o);
@@ -629,6 +636,39 @@ void Area::removeFocus() {
 	_activeObject = 0;
 }
 
+void Area::notifyObjectMoved(NWN2::Object &object) {
+	float x, y, z;
+	object.getPosition(x, y, z);
+
+	// Objects of invalid types never match any type bitfield
+	uint32 type = (uint32) object.getType();
+	if (type >= kObjectTypeMAX)
+		type = 0;
+
+	_objectGrid.setObject(object, x, y, z, type);
+}
+
+void Area::notifyObjectLeft(NWN2::Object &object) {
+	_objectGrid.removeObject(object);
+}
+
+NWN2::Object *Area::getNearestObject(const NWN2::Object &target, uint32 types, size_t nth) const {
+	float x, y, z;
+	target.getPosition(x, y, z);
+
+	return static_cast<NWN2::Object *>(_objectGrid.getNearest(x, y, z, nth, types, "", &target));
+}
+
+NWN2::Object *Area::getNearestObjectByTag(const NWN2::Object &target, const Common::UString &tag,
+                                          size_t nth) const {
+
+	float x, y, z;
+	target.getPosition(x, y, z);
+
+	return static_cast<NWN2::Object *>(_objectGrid.getNearest(x, y, z, nth,
+		Aurora::NWScript::ObjectGrid::kTypeAny, tag, &target));
+}
+
 void Area::notifyCameraMoved() {
 	checkActive();
 }
@@ -37,6 +37,8 @@
 
 #include "src/aurora/types.h"
 
+#include "src/aurora/nwscript/objectgrid.h"
+
 #include "src/graphics/aurora/types.h"
 
 #include "src/sound/types.h"
@@ -110,6 +112,18 @@ public:
 	/** Forcibly remove the focus from the currently highlighted object. */
 	void removeFocus();
 
+	// Objects
+
+	/** Notify the area that an object entered it or moved within it. */
+	void notifyObjectMoved(NWN2::Object &object);
+	/** Notify the area that an object left it. */
+	void notifyObjectLeft(NWN2::Object &object);
+
+	/** Return the nth nearest object (0 is the nearest) to the target, with a type in the types bitfield. */
+	NWN2::Object *getNearestObject(const NWN2::Object &target, uint32 types, size_t nth) const;
+	/** Return the nth nearest object (0 is the nearest) to the target with this tag. */
+	NWN2::Object *getNearestObjectByTag(const NWN2::Object &target, const Common::UString &tag, size_t nth) const;
+
 
 	/** Return the localized name of an area. */
 	static Common::UString getName(const Common::UString &resRef);
@@ -191,6 +205,9 @@ private:
 	ObjectList _objects;   ///< List of all objects in the area.
 	ObjectMap  _objectMap; ///< Map of all non-static objects in the area.
 
+	/** The positions of all objects currently in the area, for nearest-object queries. */
+	Aurora::NWScript::ObjectGrid _objectGrid;
+
 	/** The currently active (highlighted) object. */
 	Engines::NWN2::Object *_activeObject;
 
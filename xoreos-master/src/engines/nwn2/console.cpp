@@ -71,6 +71,8 @@ Console::Console(NWN2Engine &engine) :
 	registerCommand("loadmodule"   , boost::bind(&Console::cmdLoadModule   , this, _1),
 			"Usage: loadmodule <module>\nLoads a module, "
 			"replacing the currently running one");
+	registerCommand("actionstats"  , boost::bind(&Console::cmdActionStats  , this, _1),
+			"Usage: actionstats\nPrint statistics about the delayed script actions");
 }
 
 Console::~Console() {
@@ -231,6 +233,10 @@ void Console::cmdLoadModule(const CommandLine &cl) {
 	printf("No such module \"%s\"", cl.args.c_str());
 }
 
+void Console::cmdActionStats(const CommandLine &UNUSED(cl)) {
+	printActionStats(_engine->getGame().getModule().getActionStats());
+}
+
 } // End of namespace NWN2
 
 } // End of namespace Engines
@@ -43,6 +43,7 @@
 
 #include "src/engines/nwn2/types.h"
 #include "src/engines/nwn2/object.h"
+#include "src/engines/nwn2/area.h"
 
 namespace Engines {
 
@@ -62,6 +63,8 @@ Object::Object(ObjectType type) : _type(type),
 }
 
 Object::~Object() {
+	if (_area)
+		_area->notifyObjectLeft(*this);
 }
 
 ObjectType Object::getType() const {
@@ -119,7 +122,13 @@ Area *Object::getArea() const {
 }
 
 void Object::setArea(Area *area) {
+	if (_area)
+		_area->notifyObjectLeft(*this);
+
 	_area = area;
+
+	if (_area)
+		_area->notifyObjectMoved(*this);
 }
 
 Location Object::getLocation() const {
@@ -152,6 +161,9 @@ void Object::setPosition(float x, float y, float z) {
 	_position[0] = x;
 	_position[1] = y;
 	_position[2] = z;
+
+	if (_area)
+		_area->notifyObjectMoved(*this);
 }
 
 void Object::setOrientation(float x, float y, float z, float angle) {
@@ -40,22 +40,6 @@ namespace Engines {
 
 namespace NWN2 {
 
-ObjectDistanceSort::ObjectDistanceSort(const NWN2::Object &target) {
-	target.getPosition(xt, yt, zt);
-}
-
-bool ObjectDistanceSort::operator()(NWN2::Object *a, NWN2::Object *b) {
-	return getDistance(*a) < getDistance(*b);
-}
-
-float ObjectDistanceSort::getDistance(NWN2::Object &a) {
-	float x, y, z;
-	a.getPosition(x, y, z);
-
-	return ABS(x - xt) + ABS(y - yt) + ABS(z - zt);
-}
-
-
 class SearchType : public ::Aurora::NWScript::SearchRange< std::list<NWN2::Object *> > {
 public:
 	SearchType(const iterator &a, const iterator &b) : ::Aurora::NWScript::SearchRange<type>(std::make_pair(a, b)) { }
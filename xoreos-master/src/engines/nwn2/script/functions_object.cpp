@@ -30,6 +30,7 @@
 #include "src/engines/nwn2/types.h"
 #include "src/engines/nwn2/game.h"
 #include "src/engines/nwn2/module.h"
+#include "src/engines/nwn2/area.h"
 #include "src/engines/nwn2/objectcontainer.h"
 #include "src/engines/nwn2/object.h"
 #include "src/engines/nwn2/creature.h"
@@ -199,11 +200,7 @@ void Functions::getObjectByTag(Aurora::NWScript::FunctionContext &ctx) {
 
 	int nth = ctx.getParams()[1].getInt();
 
-	Common::ScopedPtr<Aurora::NWScript::ObjectSearch> search(_game->getModule().findObjectsByTag(tag));
-	while (nth-- > 0)
-		search->next();
-
-	ctx.getReturn() = search->get();
+	ctx.getReturn() = _game->getModule().getObjectByTag(tag, MAX(nth, 0));
 }
 
 void Functions::getWaypointByTag(Aurora::NWScript::FunctionContext &ctx) {
@@ -213,10 +210,10 @@ void Functions::getWaypointByTag(Aurora::NWScript::FunctionContext &ctx) {
 	if (tag.empty())
 		return;
 
-	Common::ScopedPtr<Aurora::NWScript::ObjectSearch> search(_game->getModule().findObjectsByTag(tag));
+	Aurora::NWScript::SearchTag search(_game->getModule(), tag);
 	Aurora::NWScript::Object *object = 0;
 
-	while ((object = search->next())) {
+	while ((object = search.next())) {
 		Waypoint *waypoint = NWN2::ObjectContainer::toWaypoint(object);
 
 		if (waypoint) {
@@ -230,7 +227,7 @@ void Functions::getNearestObject(Aurora::NWScript::FunctionContext &ctx) {
 	ctx.getReturn() = (Aurora::NWScript::Object *) 0;
 
 	NWN2::Object *target = NWN2::ObjectContainer::toObject(getParamObject(ctx, 1));
-	if (!target)
+	if (!target || !target->getArea())
 		return;
 
 	// Bitfield of type(s) to check for
@@ -238,33 +235,7 @@ void Functions::getNearestObject(Aurora::NWScript::FunctionContext &ctx) {
 	// We want the nth nearest object
 	size_t nth  = MAX<int32>(ctx.getParams()[2].getInt() - 1, 0);
 
-	Common::ScopedPtr<Aurora::NWScript::ObjectSearch> search(_game->getModule().findObjects());
-	Aurora::NWScript::Object *object = 0;
-
-	std::list<Object *> objects;
-	while ((object = search->next())) {
-		// Needs to be a valid object, not the target, but in the target's area
-		NWN2::Object *nwn2Object = NWN2::ObjectContainer::toObject(object);
-		if (!nwn2Object || (nwn2Object == target) || (nwn2Object->getArea() != target->getArea()))
-			continue;
-
-		// Ignore invalid object types
-		const uint32 objectType = (uint32) nwn2Object->getType();
-		if (objectType >= kObjectTypeMAX)
-			continue;
-
-		if (type & objectType)
-			objects.push_back(nwn2Object);
-	}
-
-	objects.sort(ObjectDistanceSort(*target));
-
-	std::list<Object *>::iterator it = objects.begin();
-	for (size_t n = 0; (n < nth) && (it != objects.end()); ++n)
-		++it;
-
-	if (it != objects.end())
-		ctx.getReturn() = *it;
+	ctx.getReturn() = target->getArea()->getNearestObject(*target, type, nth);
 }
 
 void Functions::getNearestObjectByTag(Aurora::NWScript::FunctionContext &ctx) {
@@ -275,39 +246,19 @@ void Functions::getNearestObjectByTag(Aurora::NWScript::FunctionContext &ctx) {
 		return;
 
 	NWN2::Object *target = NWN2::ObjectContainer::toObject(getParamObject(ctx, 1));
-	if (!target)
+	if (!target || !target->getArea())
 		return;
 
 	size_t nth = MAX<int32>(ctx.getParams()[2].getInt() - 1, 0);
 
-	Common::ScopedPtr<Aurora::NWScript::ObjectSearch> search(_game->getModule().findObjectsByTag(tag));
-	Aurora::NWScript::Object *object = 0;
-
-	std::list<Object *> objects;
-	while ((object = search->next())) {
-		// Needs to be a valid object, not the target, but in the target's area
-		NWN2::Object *nwn2Object = NWN2::ObjectContainer::toObject(object);
-		if (!nwn2Object || (nwn2Object == target) || (nwn2Object->getArea() != target->getArea()))
-			continue;
-
-		objects.push_back(nwn2Object);
-	}
-
-	objects.sort(ObjectDistanceSort(*target));
-
-	std::list<Object *>::iterator it = objects.begin();
-	for (size_t n = 0; (n < nth) && (it != objects.end()); ++n)
-		++it;
-
-	if (it != objects.end())
-		ctx.getReturn() = *it;
+	ctx.getReturn() = target->getArea()->getNearestObjectByTag(*target, tag, nth);
 }
 
 void Functions::getNearestCreature(Aurora::NWScript::FunctionContext &ctx) {
 	ctx.getReturn() = (Aurora::NWScript::Object *) 0;
 
 	NWN2::Object *target = NWN2::ObjectContainer::toObject(getParamObject(ctx, 2));
-	if (!target)
+	if (!target || !target->getArea())
 		return;
 
 	size_t nth = MAX<int32>(ctx.getParams()[3].getInt() - 1, 0);
@@ -322,25 +273,7 @@ void Functions::getNearestCreature(Aurora::NWScript::FunctionContext &ctx) {
 	 * int crit3Value = ctx.getParams()[7].getInt();
 	 */
 
-	Common::ScopedPtr<Aurora::NWScript::ObjectSearch> search(_game->getModule().findObjects());
-	Aurora::NWScript::Object *object = 0;
-
-	std::list<Object *> creatures;
-	while ((object = search->next())) {
-		Creature *creature = NWN2::ObjectContainer::toCreature(object);
-
-		if (creature && (creature != target) && (creature->getArea() == target->getArea()))
-			creatures.push_back(creature);
-	}
-
-	creatures.sort(ObjectDistanceSort(*target));
-
-	std::list<Object *>::iterator it = creatures.begin();
-	for (size_t n = 0; (n < nth) && (it != creatures.end()); ++n)
-		++it;
-
-	if (it != creatures.end())
-		ctx.getReturn() = *it;
+	ctx.getReturn() = target->getArea()->getNearestObject(*target, kObjectTypeCreature, nth);
 }
 
 void Functions::jumpToLocation(Aurora::NWScript::FunctionContext &ctx) {
@@ -76,6 +76,8 @@ Console::Console(WitcherEngine &engine) :
 	registerCommand("loadmodule"   , boost::bind(&Console::cmdLoadModule   , this, _1),
 			"Usage: loadmodule <module>\nLoads a module, "
 			"replacing the currently running one");
+	registerCommand("actionstats"  , boost::bind(&Console::cmdActionStats  , this, _1),
+			"Usage: actionstats\nPrint statistics about the delayed script actions");
 }
 
 Console::~Console() {
@@ -245,6 +247,10 @@ void Console::cmdLoadModule(const CommandLine &cl) {
 	printf("No such module \"%s\"", cl.args.c_str());
 }
 
+void Console::cmdActionStats(const CommandLine &UNUSED(cl)) {
+	printActionStats(_engine->getGame().getModule().getActionStats());
+}
+
 } // End of namespace Witcher
 
 } // End of namespace Engines
@@ -74,6 +74,7 @@ private:
 	void cmdLoadCampaign (const CommandLine &cl);
 	void cmdListModules  (const CommandLine &cl);
 	void cmdLoadModule   (const CommandLine &cl);
+	void cmdActionStats  (const CommandLine &cl);
 };
 
 } // End of namespace Witcher
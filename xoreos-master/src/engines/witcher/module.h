@@ -27,7 +27,6 @@
 
 #include <list>
 #include <map>
-#include <set>
 
 #include "src/common/ptrmap.h"
 #include "src/common/ustring.h"
@@ -35,6 +34,8 @@
 
 #include "src/aurora/ifofile.h"
 
+#include "src/aurora/nwscript/actionscheduler.h"
+
 #include "src/events/types.h"
 
 #include "src/engines/witcher/objectcontainer.h"
@@ -88,6 +89,9 @@ public:
 	                 Aurora::NWScript::Object *owner, Aurora::NWScript::Object *triggerer,
 	                 uint32 delay);
 
+	/** Return statistics about the delayed script actions. */
+	const Aurora::NWScript::ActionScheduler::Stats &getActionStats() const;
+
 	// .--- PC management
 	/** Move the player character to this area. */
 	void movePC(const Common::UString &area);
@@ -131,29 +135,9 @@ public:
 	// '---
 
 private:
-	enum ActionType {
-		kActionNone   = 0,
-		kActionScript = 1
-	};
-
-	struct Action {
-		ActionType type;
-
-		Common::UString script;
-
-		Aurora::NWScript::ScriptState state;
-		Aurora::NWScript::Object *owner;
-		Aurora::NWScript::Object *triggerer;
-
-		uint32 timestamp;
-
-		bool operator<(const Action &s) const;
-	};
-
 	typedef Common::PtrMap<Common::UString, Area> AreaMap;
 
 	typedef std::list<Events::Event> EventQueue;
-	typedef std::multiset<Action> ActionQueue;
 
 
 	::Engines::Console  *_console;
@@ -180,8 +164,10 @@ private:
 	/** The tag of the object in the start location for this module. */
 	Common::UString _entryLocation;
 
-	EventQueue  _eventQueue;
-	ActionQueue _delayedActions;
+	EventQueue _eventQueue;
+
+	/** Delayed script actions, like those created by DelayCommand(). */
+	Aurora::NWScript::ActionScheduler _delayedActions;
 
 
 	// .--- Unloading
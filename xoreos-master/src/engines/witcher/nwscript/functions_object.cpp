@@ -30,6 +30,7 @@
 #include "src/engines/witcher/types.h"
 #include "src/engines/witcher/game.h"
 #include "src/engines/witcher/module.h"
+#include "src/engines/witcher/area.h"
 #include "src/engines/witcher/objectcontainer.h"
 #include "src/engines/witcher/object.h"
 #include "src/engines/witcher/creature.h"
@@ -194,11 +195,7 @@ void Functions::getObjectByTag(Aurora::NWScript::FunctionContext &ctx) {
 
 	int nth = ctx.getParams()[1].getInt();
 
-	Common::ScopedPtr<Aurora::NWScript::ObjectSearch> search(_game->getModule().findObjectsByTag(tag));
-	while (nth-- > 0)
-		search->next();
-
-	ctx.getReturn() = search->get();
+	ctx.getReturn() = _game->getModule().getObjectByTag(tag, MAX(nth, 0));
 }
 
 void Functions::getWaypointByTag(Aurora::NWScript::FunctionContext &ctx) {
@@ -208,10 +205,10 @@ void Functions::getWaypointByTag(Aurora::NWScript::FunctionContext &ctx) {
 	if (tag.empty())
 		return;
 
-	Common::ScopedPtr<Aurora::NWScript::ObjectSearch> search(_game->getModule().findObjectsByTag(tag));
+	Aurora::NWScript::SearchTag search(_game->getModule(), tag);
 	Aurora::NWScript::Object *object = 0;
 
-	while ((object = search->next())) {
+	while ((object = search.next())) {
 		Waypoint *waypoint = Witcher::ObjectContainer::toWaypoint(object);
 
 		if (waypoint) {
@@ -225,7 +222,7 @@ void Functions::getNearestObject(Aurora::NWScript::FunctionContext &ctx) {
 	ctx.getReturn() = (Aurora::NWScript::Object *) 0;
 
 	Witcher::Object *target = Witcher::ObjectContainer::toObject(getParamObject(ctx, 1));
-	if (!target)
+	if (!target || !target->getArea())
 		return;
 
 	// Bitfield of type(s) to check for
@@ -233,33 +230,7 @@ void Functions::getNearestObject(Aurora::NWScript::FunctionContext &ctx) {
 	// We want the nth nearest object
 	size_t nth  = MAX<int32>(ctx.getParams()[2].getInt() - 1, 0);
 
-	Common::ScopedPtr<Aurora::NWScript::ObjectSearch> search(_game->getModule().findObjects());
-	Aurora::NWScript::Object *object = 0;
-
-	std::list<Object *> objects;
-	while ((object = search->next())) {
-		// Needs to be a valid object, not the target, but in the target's area
-		Witcher::Object *witcherObject = Witcher::ObjectContainer::toObject(object);
-		if (!witcherObject || (witcherObject == target) || (witcherObject->getArea() != target->getArea()))
-			continue;
-
-		// Ignore invalid object types
-		const uint32 objectType = (uint32) witcherObject->getType();
-		if (objectType >= kObjectTypeMAX)
-			continue;
-
-		if (type & objectType)
-			objects.push_back(witcherObject);
-	}
-
-	objects.sort(ObjectDistanceSort(*target));
-
-	std::list<Object *>::iterator it = objects.begin();
-	for (size_t n = 0; (n < nth) && (it != objects.end()); ++n)
-		++it;
-
-	if (it != objects.end())
-		ctx.getReturn() = *it;
+	ctx.getReturn() = target->getArea()->getNearestObject(*target, type, nth);
 }
 
 void Functions::getNearestObjectByTag(Aurora::NWScript::FunctionContext &ctx) {
@@ -270,39 +241,19 @@ void Functions::getNearestObjectByTag(Aurora::NWScript::FunctionContext &ctx) {
 		return;
 
 	Witcher::Object *target = Witcher::ObjectContainer::toObject(getParamObject(ctx, 1));
-	if (!target)
+	if (!target || !target->getArea())
 		return;
 
 	size_t nth = MAX<int32>(ctx.getParams()[2].getInt() - 1, 0);
 
-	Common::ScopedPtr<Aurora::NWScript::ObjectSearch> search(_game->getModule().findObjectsByTag(tag));
-	Aurora::NWScript::Object *object = 0;
-
-	std::list<Object *> objects;
-	while ((object = search->next())) {
-		// Needs to be a valid object, not the target, but in the target's area
-		Witcher::Object *witcherObject = Witcher::ObjectContainer::toObject(object);
-		if (!witcherObject || (witcherObject == target) || (witcherObject->getArea() != target->getArea()))
-			continue;
-
-		objects.push_back(witcherObject);
-	}
-
-	objects.sort(ObjectDistanceSort(*target));
-
-	std::list<Object *>::iterator it = objects.begin();
-	for (size_t n = 0; (n < nth) && (it != objects.end()); ++n)
-		++it;
-
-	if (it != objects.end())
-		ctx.getReturn() = *it;
+	ctx.getReturn() = target->getArea()->getNearestObjectByTag(*target, tag, nth);
 }
 
 void Functions::getNearestCreature(Aurora::NWScript::FunctionContext &ctx) {
 	ctx.getReturn() = (Aurora::NWScript::Object *) 0;
 
 	Witcher::Object *target = Witcher::ObjectContainer::toObject(getParamObject(ctx, 2));
-	if (!target)
+	if (!target || !target->getArea())
 		return;
 
 	size_t nth = MAX<int32>(ctx.getParams()[3].getInt() - 1, 0);
@@ -317,25 +268,7 @@ void Functions::getNearestCreature(Aurora::NWScript::FunctionContext &ctx) {
 	 * int crit3Value = ctx.getParams()[7].getInt();
 	 */
 
-	Common::ScopedPtr<Aurora::NWScript::ObjectSearch> search(_game->getModule().findObjects());
-	Aurora::NWScript::Object *object = 0;
-
-	std::list<Object *> creatures;
-	while ((object = search->next())) {
-		Creature *creature = Witcher::ObjectContainer::toCreature(object);
-
-		if (creature && (creature != target) && (creature->getArea() == target->getArea()))
-			creatures.push_back(creature);
-	}
-
-	creatures.sort(ObjectDistanceSort(*target));
-
-	std::list<Object *>::iterator it = creatures.begin();
-	for (size_t n = 0; (n < nth) && (it != creatures.end()); ++n)
-		++it;
-
-	if (it != creatures.end())
-		ctx.getReturn() = *it;
+	ctx.getReturn() = target->getArea()->getNearestObject(*target, kObjectTypeCreature, nth);
 }
 
 void Functions::jumpToLocation(Aurora::NWScript::FunctionContext &ctx) {
@@ -32,6 +32,7 @@
 #include "src/engines/aurora/util.h"
 
 #include "src/engines/witcher/object.h"
+#include "src/engines/witcher/area.h"
 
 namespace Engines {
 
@@ -50,6 +51,8 @@ Object::Object(ObjectType type) : _type(type),
 }
 
 Object::~Object() {
+	if (_area)
+		_area->notifyObjectLeft(*this);
 }
 
 ObjectType Object::getType() const {
@@ -108,7 +111,13 @@ Area *Object::getArea() const {
 }
 
 void Object::setArea(Area *area) {
+	if (_area)
+		_area->notifyObjectLeft(*this);
+
 	_area = area;
+
+	if (_area)
+		_area->notifyObjectMoved(*this);
 }
 
 Location Object::getLocation() const {
@@ -141,6 +150,9 @@ void Object::setPosition(float x, float y, float z) {
 	_position[0] = x;
 	_position[1] = y;
 	_position[2] = z;
+
+	if (_area)
+		_area->notifyObjectMoved(*this);
 }
 
 void Object::setOrientation(float x, float y, float z, float angle) {
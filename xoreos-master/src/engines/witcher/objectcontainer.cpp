@@ -40,22 +40,6 @@ namespace Engines {
 
 namespace Witcher {
 
-ObjectDistanceSort::ObjectDistanceSort(const Witcher::Object &target) {
-	target.getPosition(xt, yt, zt);
-}
-
-bool ObjectDistanceSort::operator()(Witcher::Object *a, Witcher::Object *b) {
-	return getDistance(*a) < getDistance(*b);
-}
-
-float ObjectDistanceSort::getDistance(Witcher::Object &a) {
-	float x, y, z;
-	a.getPosition(x, y, z);
-
-	return ABS(x - xt) + ABS(y - yt) + ABS(z - zt);
-}
-
-
 class SearchType : public ::Aurora::NWScript::SearchRange< std::list<Witcher::Object *> > {
 public:
 	SearchType(const iterator &a, const iterator &b) : ::Aurora::NWScript::SearchRange<type>(std::make_pair(a, b)) { }
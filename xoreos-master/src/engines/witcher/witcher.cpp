@@ -157,7 +157,7 @@ void WitcherEngine::run() {
 }
 
 void WitcherEngine::init() {
-	LoadProgress progress(15);
+	LoadProgress progress(14);
 
 	progress.step("Declare languages");
 	declareLanguages();
@@ -223,11 +223,10 @@ void WitcherEngine::initResources(LoadProgress &progress) {
 	// Contains BIFs with voices for the two premium modules
 	indexOptionalDirectory("data/voices", 0, 0, 6);
 
-	progress.step("Loading main KEY");
-	indexMandatoryArchive("main.key", 10);
+	progress.step("Loading the main and localized base KEYs");
+	static const char * const kBaseKEYs[] = { "main.key", "localized.key" };
 
-	progress.step("Loading the localized base KEY");
-	indexMandatoryArchive("localized.key", 50);
+	indexMandatoryArchives(std::vector<Common::UString>(kBaseKEYs, kBaseKEYs + ARRAYSIZE(kBaseKEYs)), 10);
 
 	// Language files at 100-102
 
@@ -299,23 +298,23 @@ void WitcherEngine::loadLanguageFiles(Aurora::Language langText, Aurora::Languag
 	unloadLanguageFiles();
 	LangMan.setCurrentLanguage(langText, langVoice);
 
-	Common::UString archive;
+	std::vector<Common::UString> archives;
 
-	_languageResources.push_back(Common::ChangeID());
-	archive = Common::UString::format("lang_%d.key", LangMan.getLanguageID(langVoice));
-	indexMandatoryArchive(archive, 100, &_languageResources.back());
+	archives.push_back(Common::UString::format("lang_%d.key", LangMan.getLanguageID(langVoice)));
 
 	// Voices for the first premium module (The Price of Neutrality)
-	_languageResources.push_back(Common::ChangeID());
-	archive = Common::UString::format("M1_%d.key", LangMan.getLanguageID(langVoice));
-	indexOptionalArchive(archive, 101, &_languageResources.back());
+	const Common::UString m1 = Common::UString::format("M1_%d.key", LangMan.getLanguageID(langVoice));
+	if (ResMan.hasArchive(m1))
+		archives.push_back(m1);
 
 	// Voices for the second premium module (Side Effects)
-	_languageResources.push_back(Common::ChangeID());
-	archive = Common::UString::format("M2_%d.key", LangMan.getLanguageID(langVoice));
-	indexOptionalArchive(archive, 102, &_languageResources.back());
+	const Common::UString m2 = Common::UString::format("M2_%d.key", LangMan.getLanguageID(langVoice));
+	if (ResMan.hasArchive(m2))
+		archives.push_back(m2);
 
-	archive = Common::UString::format("dialog_%d", LangMan.getLanguageID(langText));
+	indexMandatoryArchives(archives, 100, _languageResources);
+
+	const Common::UString archive = Common::UString::format("dialog_%d", LangMan.getLanguageID(langText));
 	TalkMan.addTable(archive, "", false, 0, &_languageTLK);
 }
 
@@ -27,6 +27,7 @@
 
 #include "src/graphics/graphics.h"
 #include "src/graphics/camera.h"
+#include "src/graphics/skinning.h"
 
 #include "src/graphics/aurora/model.h"
 #include "src/graphics/aurora/modelnode.h"
@@ -229,11 +230,18 @@ void Animation::interpolateOrientation(ModelNode *animNode, ModelNode *target, f
 	target->setOrientation(x, y, z, Common::rad2deg(acos(q) * 2.0));
 }
 
-void Animation::updateSkinnedModel(Model *model) {
+void Animation::updateSkinnedModel(Model *model) const {
+	std::vector<float>       palette;
+	std::vector<ModelNode *> nodeChain;
+
 	const std::list<ModelNode *> &nodes = model->getNodes();
 	for (std::list<ModelNode *>::const_iterator it = nodes.begin(); it != nodes.end(); ++it) {
 		ModelNode *node = *it;
-		if (!node->_mesh || !node->_mesh->skin)
+		if (!node->_mesh || !node->_mesh->skin || !node->_mesh->data)
+			continue;
+
+		ModelNode::Skin *skin = node->_mesh->skin;
+		if (skin->influences.boneCount == 0)
 			continue;
 
 		Common::Matrix4x4 transform;
@@ -244,79 +252,51 @@ void Animation::updateSkinnedModel(Model *model) {
 		                 node->_orientation[2]);
 		Common::Matrix4x4 invTransform = transform.getInverse();
 
-		ModelNode::Skin *skin = node->_mesh->skin;
+		/* Combine all transformations a vertex goes through for each bone
+		 * into a single matrix, once per frame: into the node space, through
+		 * the inverse bind pose and the current bone transformation, and
+		 * back out of the node space. */
 
-		_invBindPoseMatrices.reserve(16 * skin->boneMappingCount);
-		float *invBindPoseArr = &_invBindPoseMatrices[0];
+		palette.assign(16 * skin->influences.boneCount, 0.0f);
 
-		_boneTransMatrices.reserve(16 * skin->boneMappingCount);
-		float *boneTransArr = &_boneTransMatrices[0];
+		for (uint32 i = 0; i < skin->boneMappingCount; ++i) {
+			const int index = static_cast<int>(skin->boneMapping[i]);
+			if ((index < 0) || (static_cast<uint32>(index) >= skin->influences.boneCount) ||
+			    !skin->boneNodeMap[index])
+				continue;
 
-		for (uint16 i = 0; i < skin->boneMappingCount; ++i) {
-			int index = static_cast<int>(skin->boneMapping[i]);
-			if (index != -1) {
-				uint32 off = index * 16;
-				computeNodeTransform(skin->boneNodeMap[index], invBindPoseArr + off,
-				                     boneTransArr + off);
-			}
+			float invBindPose[16], boneTransform[16];
+			computeNodeTransform(skin->boneNodeMap[index], nodeChain, invBindPose, boneTransform);
+
+			Common::Matrix4x4 bone(invTransform);
+			bone *= Common::Matrix4x4(boneTransform);
+			bone *= Common::Matrix4x4(invBindPose);
+			bone *= transform;
+
+			memcpy(&palette[16 * index], bone.get(), 16 * sizeof(float));
 		}
 
 		// TODO: Use vertex shader
 
-		ModelNode::MeshData *meshData = node->_mesh->data;
-		VertexBuffer &vertexBuffer = meshData->vertexBuffer;
-		uint32 vertexCount = vertexBuffer.getCount();
-		uint32 stride = vertexBuffer.getSize() / sizeof(float);
-		float *v = reinterpret_cast<float *>(vertexBuffer.getData());
-		float *iv = &meshData->initialVertexCoords[0];
-		float *boneWeights = &skin->boneWeights[0];
-		float *boneMappingId = &skin->boneMappingId[0];
-		Common::Matrix4x4 invBindPose;
-		Common::Matrix4x4 boneTransform;
-
-		for (uint32 i = 0; i < vertexCount; ++i) {
-			v[0] = 0;
-			v[1] = 0;
-			v[2] = 0;
-			for (uint8 j = 0; j < 4; ++j) {
-				int index = static_cast<int>(boneMappingId[j]);
-				if (index != -1) {
-					uint32 off = index * 16;
-					float rv[3];
-					float tv[3];
-
-					transform.multiply(iv, rv);
-
-					invBindPose = invBindPoseArr + off;
-					invBindPose.multiply(rv, tv);
-
-					boneTransform = boneTransArr + off;
-					boneTransform.multiply(tv, rv);
-
-					invTransform.multiply(rv, tv);
-
-					v[0] += tv[0] * boneWeights[j];
-					v[1] += tv[1] * boneWeights[j];
-					v[2] += tv[2] * boneWeights[j];
-				}
-			}
-			v += stride;
-			iv += 3;
-			boneWeights += 4;
-			boneMappingId += 4;
-		}
+		VertexBuffer &vertexBuffer = node->_mesh->data->vertexBuffer;
+
+		const float *normals = skin->initialNormalCoords.empty() ? 0 : &skin->initialNormalCoords[0];
+
+		skinVertices(skin->influences, &palette[0], &node->_mesh->data->initialVertexCoords[0], normals,
+		             reinterpret_cast<float *>(vertexBuffer.getData()), vertexBuffer.getSize() / sizeof(float));
 	}
 }
 
-void Animation::computeNodeTransform(ModelNode *node, float *outInvBindPose, float *outTransform) {
-	_nodeChain.clear();
+void Animation::computeNodeTransform(ModelNode *node, std::vector<ModelNode *> &nodeChain,
+                                     float *outInvBindPose, float *outTransform) {
+	nodeChain.clear();
 	for (ModelNode *node2 = node; node2; node2 = node2->_parent)
-		_nodeChain.push_back(node2);
+		nodeChain.push_back(node2);
 
 	Common::Matrix4x4 bindPose;
 	Common::Matrix4x4 transform;
-	for (int i = _nodeChain.size() - 1; i >= 0; --i) {
-		const ModelNode *node2 = _nodeChain[i];
+	for (int i = nodeChain.size() - 1; i >= 0; --i) {
+		const ModelNode *node2 = nodeChain[i];
 		if (node2->_positionFrames.size() > 0) {
 			const PositionKeyFrame &pos = node2->_positionFrames[0];
 			bindPose.translate(pos.x, pos.y, pos.z);
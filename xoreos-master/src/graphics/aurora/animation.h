@@ -94,22 +94,25 @@ protected:
 	float _transtime;
 
 private:
-	std::vector<float>       _invBindPoseMatrices;
-	std::vector<float>       _boneTransMatrices;
-	std::vector<ModelNode *> _nodeChain;
-
 	void interpolatePosition(ModelNode *animNode, ModelNode *target, float time, float scale,
 	                         bool relative) const;
 	void interpolateOrientation(ModelNode *animNode, ModelNode *target, float time) const;
 
-	/** Transform vertices for each node of the specified model based on current animation. */
-	void updateSkinnedModel(Model *model);
+	/** Transform vertices for each node of the specified model based on current animation.
+	 *
+	 *  Animations are shared between all models using the same supermodel, and
+	 *  models are advanced in parallel by the graphics manager's job pool. So
+	 *  this must not modify the animation itself.
+	 */
+	void updateSkinnedModel(Model *model) const;
 
 	/** Compute node transformation and inverse bind pose matrices.
+	 *  @param nodeChain Scratch space for the chain of parent nodes.
 	 *  @param outInvBindPose Pointer to a 16-value array to store inverse bind pose matrix.
 	 *  @param outTransform Pointer to a 16-value array to store transformation matrix.
 	 */
-	void computeNodeTransform(ModelNode *node, float *outInvBindPose, float *outTransform);
+	static void computeNodeTransform(ModelNode *node, std::vector<ModelNode *> &nodeChain,
+	                                 float *outInvBindPose, float *outTransform);
 };
 
 } // End of namespace Aurora
@@ -73,6 +73,9 @@ Model::Model(ModelType type) : Renderable((RenderableType) type),
 	_animationLoopLength = 1.0f;
 	_animationLoopTime   = 0.0f;
 
+	// Models are never created from within the job pool, so seeding from std::rand() is safe
+	_randomState = ((uint32) std::rand()) + 1;
+
 	_boundRenderable = new Shader::ShaderRenderable();
 	_boundRenderable->setSurface(SurfaceMan.getSurface("defaultSurface"));
 	_boundRenderable->setMaterial(MaterialMan.getMaterial("defaultWhite"));
@@ -136,6 +139,13 @@ bool Model::isIn(float x1, float y1, float z1, float x2, float y2, float z2) con
 	return _absoluteBoundBox.isIn(x1, y1, z1, x2, y2, z2);
 }
 
+const Common::BoundingBox *Model::getWorldBound() const {
+	if (_type == kModelTypeGUIFront)
+		return 0;
+
+	return &_absoluteBoundBox;
+}
+
 float Model::getWidth() const {
 	return _boundBox.getWidth() * _scale[0];
 }
@@ -213,8 +223,8 @@ void Model::playDefaultAnimation() {
 	}
 }
 
-Animation *Model::selectDefaultAnimation() const {
-	uint8 pick = std::rand() % 100;
+Animation *Model::selectDefaultAnimation() {
+	uint8 pick = getRandom() % 100;
 	for (DefaultAnimations::const_iterator a = _defaultAnimations.begin(); a != _defaultAnimations.end(); ++a) {
 		if (pick < a->probability)
 			return a->animation;
@@ -225,6 +235,15 @@ Animation *Model::selectDefaultAnimation() const {
 	return 0;
 }
 
+uint32 Model::getRandom() {
+	// xorshift32, which never reaches 0 from a non-zero state
+	_randomState ^= _randomState << 13;
+	_randomState ^= _randomState >> 17;
+	_randomState ^= _randomState <<  5;
+
+	return _randomState;
+}
+
 void Model::setCurrentAnimation(Animation *anim) {
 	if (!_currentState)
 		return;
@@ -84,6 +84,9 @@ public:
 	/** Does the line from x1.y1.z1 to x2.y2.z2 intersect with model's bounding box? */
 	bool isIn(float x1, float y1, float z1, float x2, float y2, float z2) const;
 
+	/** Return the model's bounding box in world coordinates. */
+	const Common::BoundingBox *getWorldBound() const;
+
 
 	// Positioning
 
@@ -288,6 +291,13 @@ private:
 	float _animationLoopLength; ///< The length of one loop of the current animation.
 	float _animationLoopTime;   ///< The time the current loop of the current animation has played.
 
+	/** State of the model's own random number sequence, for picking default animations.
+	 *
+	 *  Models are advanced in parallel on the graphics job pool, so they can't
+	 *  share the global state of std::rand().
+	 */
+	uint32 _randomState;
+
 	std::vector<ModelNode *> _animationNodeMap;
 
 	/** Create the list of all state names. */
@@ -299,7 +309,10 @@ private:
 
 	void manageAnimations(float dt);
 
-	Animation *selectDefaultAnimation() const;
+	Animation *selectDefaultAnimation();
+
+	/** Return the next number of the model's own random number sequence. */
+	uint32 getRandom();
 
 	void setCurrentAnimation(Animation *anim);
 
@@ -386,7 +386,7 @@ void Model_KotOR::makeBoneNodeMap() {
 		ModelNode::Mesh *mesh = node->getMesh();
 		if (mesh && mesh->skin) {
 			ModelNode::Skin *skin = mesh->skin;
-			skin->boneNodeMap.reserve(skin->boneMappingCount);
+			skin->boneNodeMap.resize(skin->boneMappingCount, 0);
 			for (uint16 i = 0; i < skin->boneMappingCount; ++i) {
 				int index = static_cast<int>(skin->boneMapping[i]);
 				if (index != -1) {
@@ -693,7 +693,7 @@ void ModelNode_KotOR::readMesh(Model_KotOR::ParserContext &ctx) {
 		vertexDecl.push_back(VertexAttrib(VTCOORD + t , 2, GL_FLOAT));
 
 	_mesh->data->vertexBuffer.setVertexDeclInterleave(ctx.vertexCount, vertexDecl);
-	_mesh->data->initialVertexCoords.reserve(3 * ctx.vertexCount);
+	_mesh->data->initialVertexCoords.resize(3 * ctx.vertexCount);
 
 	float *v = reinterpret_cast<float *>(_mesh->data->vertexBuffer.getData());
 	float *iv = &_mesh->data->initialVertexCoords[0];
@@ -763,8 +763,9 @@ void ModelNode_KotOR::readSkin(Model_KotOR::ParserContext &ctx) {
 		_mesh->skin->boneMapping.push_back(ctx.mdl->readIEEEFloatLE());
 	ctx.mdl->seek(pos);
 
-	std::vector<float> &boneWeights = _mesh->skin->boneWeights;
-	std::vector<float> &boneMappingId = _mesh->skin->boneMappingId;
+	std::vector<float> boneWeights, boneMappingId;
+	boneWeights.reserve(4 * ctx.vertexCount);
+	boneMappingId.reserve(4 * ctx.vertexCount);
 
 	for (int i = 0; i < ctx.vertexCount; i++) {
 		// Bone weights
@@ -781,6 +782,26 @@ void ModelNode_KotOR::readSkin(Model_KotOR::ParserContext &ctx) {
 		boneMappingId.push_back(ctx.mdx->readIEEEFloatLE());
 		boneMappingId.push_back(ctx.mdx->readIEEEFloatLE());
 	}
+
+	if (!_mesh->data || (ctx.vertexCount == 0))
+		return;
+
+	_mesh->skin->influences.set(&boneMappingId[0], &boneWeights[0], ctx.vertexCount, boneMappingCount);
+
+	// Remember the initial normals, which follow the positions in the vertex buffer
+	VertexBuffer &vertexBuffer = _mesh->data->vertexBuffer;
+
+	const uint32 stride = vertexBuffer.getSize() / sizeof(float);
+	const float *v = reinterpret_cast<const float *>(vertexBuffer.getData());
+
+	std::vector<float> &normals = _mesh->skin->initialNormalCoords;
+	normals.resize(3 * ctx.vertexCount);
+
+	for (uint32 i = 0; i < ctx.vertexCount; i++, v += stride) {
+		normals[3 * i + 0] = v[3];
+		normals[3 * i + 1] = v[4];
+		normals[3 * i + 2] = v[5];
+	}
 }
 
 } // End of namespace Aurora
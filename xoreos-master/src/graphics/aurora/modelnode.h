@@ -35,6 +35,7 @@
 #include "src/graphics/types.h"
 #include "src/graphics/indexbuffer.h"
 #include "src/graphics/vertexbuffer.h"
+#include "src/graphics/skinning.h"
 
 #include "src/graphics/aurora/types.h"
 #include "src/graphics/aurora/texturehandle.h"
@@ -133,10 +134,11 @@ public:
 	struct Skin {
 		std::vector<float>       boneMapping;
 		uint32                   boneMappingCount;
-		std::vector<float>       boneWeights;
-		std::vector<float>       boneMappingId;
+		SkinInfluences           influences;  ///< The bones influencing each vertex.
 		std::vector<ModelNode *> boneNodeMap;
 
+		std::vector<float> initialNormalCoords; ///< Initial node vertex normals.
+
 		Skin();
 	};
 
@@ -0,0 +1,324 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A bounding volume hierarchy, for culling and picking.
+ */
+
+#include <cmath>
+
+#include <algorithm>
+
+#include "src/common/util.h"
+#include "src/common/boundingbox.h"
+
+#include "src/graphics/bvh.h"
+#include "src/graphics/frustum.h"
+
+namespace Graphics {
+
+/** Sort build items by their center along one axis. */
+struct CenterLess {
+	int axis;
+
+	CenterLess(int a) : axis(a) {
+	}
+
+	template<typename T>
+	bool operator()(const T &a, const T &b) const {
+		return a.center[axis] < b.center[axis];
+	}
+};
+
+static bool getBounds(const Common::BoundingBox *bound, float *min, float *max) {
+	if (!bound || bound->empty())
+		return false;
+
+	bound->getMin(min[0], min[1], min[2]);
+	bound->getMax(max[0], max[1], max[2]);
+
+	return true;
+}
+
+static inline void addBounds(float *min, float *max, const float *addMin, const float *addMax) {
+	for (int i = 0; i < 3; i++) {
+		min[i] = MIN(min[i], addMin[i]);
+		max[i] = MAX(max[i], addMax[i]);
+	}
+}
+
+/** Could the line from p with the direction d intersect with the box? */
+static bool lineInBox(const float *p, const float *d, const float *min, const float *max) {
+	float tMin = 0.0f, tMax = 1.0f;
+
+	for (int i = 0; i < 3; i++) {
+		// Grow the box a bit, to err on the side of finding too many items
+		const float epsilon = (ABS(min[i]) + ABS(max[i]) + 1.0f) * 1.0e-5f;
+
+		const float boxMin = min[i] - epsilon;
+		const float boxMax = max[i] + epsilon;
+
+		if (ABS(d[i]) < 1.0e-12f) {
+			// Parallel to this slab
+			if ((p[i] < boxMin) || (p[i] > boxMax))
+				return false;
+
+			continue;
+		}
+
+		float t1 = (boxMin - p[i]) / d[i];
+		float t2 = (boxMax - p[i]) / d[i];
+		if (t1 > t2)
+			SWAP(t1, t2);
+
+		tMin = MAX(tMin, t1);
+		tMax = MIN(tMax, t2);
+
+		if (tMin > tMax)
+			return false;
+	}
+
+	return true;
+}
+
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy() : _itemCount(0) {
+}
+
+BoundingVolumeHierarchy::~BoundingVolumeHierarchy() {
+}
+
+void BoundingVolumeHierarchy::clear() {
+	_itemCount = 0;
+
+	_nodes.clear();
+	_items.clear();
+	_boxes.clear();
+	_unbounded.clear();
+}
+
+size_t BoundingVolumeHierarchy::getItemCount() const {
+	return _itemCount;
+}
+
+void BoundingVolumeHierarchy::build(const std::vector<const Common::BoundingBox *> &bounds) {
+	clear();
+
+	_itemCount = bounds.size();
+
+	_buildItems.clear();
+	_buildItems.reserve(bounds.size());
+
+	for (size_t i = 0; i < bounds.size(); i++) {
+		Box box;
+		if (!getBounds(bounds[i], box.min, box.max)) {
+			_unbounded.push_back(i);
+			continue;
+		}
+
+		BuildItem item;
+
+		item.item = i;
+		for (int j = 0; j < 3; j++)
+			item.center[j] = (box.min[j] + box.max[j]) / 2.0f;
+
+		_buildItems.push_back(item);
+	}
+
+	if (_buildItems.empty())
+		return;
+
+	_nodes.reserve(2 * ((_buildItems.size() + kLeafSize - 1) / kLeafSize));
+	_boxes.resize(_buildItems.size());
+
+	buildNode(bounds, 0, _buildItems.size());
+
+	_items.resize(_buildItems.size());
+	for (size_t i = 0; i < _buildItems.size(); i++)
+		_items[i] = _buildItems[i].item;
+}
+
+uint32 BoundingVolumeHierarchy::buildNode(const std::vector<const Common::BoundingBox *> &bounds,
+                                          uint32 start, uint32 count) {
+
+	const uint32 index = _nodes.size();
+	_nodes.push_back(Node());
+
+	_nodes[index].start = start;
+	_nodes[index].count = count;
+	_nodes[index].right = 0;
+
+	if (count <= kLeafSize) {
+		Node &node = _nodes[index];
+
+		for (uint32 i = start; i < (start + count); i++) {
+			Box &box = _boxes[i];
+			getBounds(bounds[_buildItems[i].item], box.min, box.max);
+
+			if (i == start) {
+				std::copy(box.min, box.min + 3, node.min);
+				std::copy(box.max, box.max + 3, node.max);
+			} else
+				addBounds(node.min, node.max, box.min, box.max);
+		}
+
+		return index;
+	}
+
+	// Split along the axis where the item centers are spread out the most
+
+	float centerMin[3], centerMax[3];
+	std::copy(_buildItems[start].center, _buildItems[start].center + 3, centerMin);
+	std::copy(_buildItems[start].center, _buildItems[start].center + 3, centerMax);
+
+	for (uint32 i = start + 1; i < (start + count); i++)
+		addBounds(centerMin, centerMax, _buildItems[i].center, _buildItems[i].center);
+
+	int axis = 0;
+	for (int i = 1; i < 3; i++)
+		if ((centerMax[i] - centerMin[i]) > (centerMax[axis] - centerMin[axis]))
+			axis = i;
+
+	const uint32 half = count / 2;
+
+	std::nth_element(_buildItems.begin() + start, _buildItems.begin() + start + half,
+	                 _buildItems.begin() + start + count, CenterLess(axis));
+
+	const uint32 left  = buildNode(bounds, start, half);
+	const uint32 right = buildNode(bounds, start + half, count - half);
+
+	Node &node = _nodes[index];
+
+	node.right = right;
+
+	std::copy(_nodes[left].min, _nodes[left].min + 3, node.min);
+	std::copy(_nodes[left].max, _nodes[left].max + 3, node.max);
+	addBounds(node.min, node.max, _nodes[right].min, _nodes[right].max);
+
+	return index;
+}
+
+bool BoundingVolumeHierarchy::refit(const std::vector<const Common::BoundingBox *> &bounds) {
+	if (bounds.size() != _itemCount)
+		return false;
+
+	for (size_t i = 0; i < _items.size(); i++)
+		if (!getBounds(bounds[_items[i]], _boxes[i].min, _boxes[i].max))
+			return false;
+
+	// Children always come after their parents
+	for (size_t i = _nodes.size(); i-- > 0; ) {
+		Node &node = _nodes[i];
+
+		if (node.right != 0) {
+			std::copy(_nodes[i + 1].min, _nodes[i + 1].min + 3, node.min);
+			std::copy(_nodes[i + 1].max, _nodes[i + 1].max + 3, node.max);
+			addBounds(node.min, node.max, _nodes[node.right].min, _nodes[node.right].max);
+			continue;
+		}
+
+		std::copy(_boxes[node.start].min, _boxes[node.start].min + 3, node.min);
+		std::copy(_boxes[node.start].max, _boxes[node.start].max + 3, node.max);
+		for (uint32 j = node.start + 1; j < (node.start + node.count); j++)
+			addBounds(node.min, node.max, _boxes[j].min, _boxes[j].max);
+	}
+
+	return true;
+}
+
+void BoundingVolumeHierarchy::markVisible(const Node &node, std::vector<bool> &visible) const {
+	for (uint32 i = node.start; i < (node.start + node.count); i++)
+		visible[_items[i]] = true;
+}
+
+void BoundingVolumeHierarchy::cull(const Frustum &frustum, std::vector<bool> &visible) const {
+	visible.assign(_itemCount, false);
+
+	for (std::vector<uint32>::const_iterator u = _unbounded.begin(); u != _unbounded.end(); ++u)
+		visible[*u] = true;
+
+	if (_nodes.empty())
+		return;
+
+	std::vector<uint32> stack;
+	stack.push_back(0);
+
+	while (!stack.empty()) {
+		const uint32 index = stack.back();
+		stack.pop_back();
+
+		const Node &node = _nodes[index];
+
+		const Frustum::Containment containment = frustum.contains(node.min, node.max);
+		if (containment == Frustum::kContainmentOutside)
+			continue;
+
+		if (containment == Frustum::kContainmentInside) {
+			markVisible(node, visible);
+			continue;
+		}
+
+		if (node.right != 0) {
+			stack.push_back(node.right);
+			stack.push_back(index + 1);
+			continue;
+		}
+
+		for (uint32 i = node.start; i < (node.start + node.count); i++)
+			if (frustum.contains(_boxes[i].min, _boxes[i].max) != Frustum::kContainmentOutside)
+				visible[_items[i]] = true;
+	}
+}
+
+void BoundingVolumeHierarchy::intersect(float x1, float y1, float z1, float x2, float y2, float z2,
+                                        std::vector<size_t> &items) const {
+
+	items.assign(_unbounded.begin(), _unbounded.end());
+
+	if (_nodes.empty())
+		return;
+
+	const float p[3] = { x1, y1, z1 };
+	const float d[3] = { x2 - x1, y2 - y1, z2 - z1 };
+
+	std::vector<uint32> stack;
+	stack.push_back(0);
+
+	while (!stack.empty()) {
+		const uint32 index = stack.back();
+		stack.pop_back();
+
+		const Node &node = _nodes[index];
+		if (!lineInBox(p, d, node.min, node.max))
+			continue;
+
+		if (node.right != 0) {
+			stack.push_back(node.right);
+			stack.push_back(index + 1);
+			continue;
+		}
+
+		for (uint32 i = node.start; i < (node.start + node.count); i++)
+			if (lineInBox(p, d, _boxes[i].min, _boxes[i].max))
+				items.push_back(_items[i]);
+	}
+}
+
+} // End of namespace Graphics
@@ -0,0 +1,135 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A bounding volume hierarchy, for culling and picking.
+ */
+
+#ifndef GRAPHICS_BVH_H
+#define GRAPHICS_BVH_H
+
+#include <vector>
+
+#include "src/common/types.h"
+
+namespace Common {
+	class BoundingBox;
+}
+
+namespace Graphics {
+
+class Frustum;
+
+/** A bounding volume hierarchy over a set of items, identified by their index.
+ *
+ *  The hierarchy is a binary tree of axis-aligned boxes, split at the median
+ *  along the longest axis. Items without a bounding box are kept apart, and
+ *  are always returned by all queries.
+ *
+ *  When the items stay the same, but their bounds change (because they moved,
+ *  or were animated), refit() updates the boxes without rebuilding the tree.
+ */
+class BoundingVolumeHierarchy {
+public:
+	BoundingVolumeHierarchy();
+	~BoundingVolumeHierarchy();
+
+	/** Remove all items. */
+	void clear();
+
+	/** Build the hierarchy anew.
+	 *
+	 *  @param bounds The bounds of each item, or 0 for items without known bounds.
+	 */
+	void build(const std::vector<const Common::BoundingBox *> &bounds);
+
+	/** Update the bounds of the items, without changing the tree.
+	 *
+	 *  The items must be the ones of the last build(). If an item lost its
+	 *  bounds, the tree can't be refitted and false is returned. In that case,
+	 *  the hierarchy needs to be built anew.
+	 */
+	bool refit(const std::vector<const Common::BoundingBox *> &bounds);
+
+	/** Return the number of items. */
+	size_t getItemCount() const;
+
+	/** Mark all items that are at least partially inside the frustum as visible.
+	 *
+	 *  visible is resized to the number of items, and all other items are marked
+	 *  as not visible.
+	 */
+	void cull(const Frustum &frustum, std::vector<bool> &visible) const;
+
+	/** Find all items that might intersect the line from x1.y1.z1 to x2.y2.z2.
+	 *
+	 *  The items are returned in no particular order.
+	 */
+	void intersect(float x1, float y1, float z1, float x2, float y2, float z2,
+	               std::vector<size_t> &items) const;
+
+private:
+	static const size_t kLeafSize = 4; ///< The maximum number of items in a leaf.
+
+	/** A node in the tree.
+	 *
+	 *  The nodes are stored depth-first, so that the left child directly
+	 *  follows its parent. The items of every node form a contiguous range
+	 *  in _items.
+	 */
+	struct Node {
+		float min[3];
+		float max[3];
+
+		uint32 start; ///< The first item, in _items.
+		uint32 count; ///< The number of items.
+		uint32 right; ///< The index of the right child, or 0 for a leaf.
+	};
+
+	/** The bounds of an item. */
+	struct Box {
+		float min[3];
+		float max[3];
+	};
+
+	/** An item, while building the tree. */
+	struct BuildItem {
+		uint32 item;
+
+		float center[3];
+	};
+
+	size_t _itemCount;
+
+	std::vector<Node>   _nodes;
+	std::vector<uint32> _items;     ///< The items in the tree, in leaf order.
+	std::vector<Box>    _boxes;     ///< The bounds of the items in the tree, in leaf order.
+	std::vector<uint32> _unbounded; ///< The items without bounds.
+
+	std::vector<BuildItem> _buildItems;
+
+	uint32 buildNode(const std::vector<const Common::BoundingBox *> &bounds, uint32 start, uint32 count);
+
+	void markVisible(const Node &node, std::vector<bool> &visible) const;
+};
+
+} // End of namespace Graphics
+
+#endif // GRAPHICS_BVH_H
@@ -0,0 +1,77 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A view frustum, for culling.
+ */
+
+#include "src/common/matrix4x4.h"
+
+#include "src/graphics/frustum.h"
+
+namespace Graphics {
+
+Frustum::Frustum() {
+	// Everything is inside
+	for (int i = 0; i < 6; i++) {
+		_planes[i][0] = _planes[i][1] = _planes[i][2] = 0.0f;
+		_planes[i][3] = 1.0f;
+	}
+}
+
+void Frustum::set(const Common::Matrix4x4 &projectionModelview) {
+	/* Each plane is the sum or difference of the fourth row of the matrix
+	 * and one of the others (Gribb & Hartmann). The matrix is column-major. */
+
+	const float *m = projectionModelview.get();
+
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 4; j++) {
+			_planes[2 * i + 0][j] = m[4 * j + 3] + m[4 * j + i];
+			_planes[2 * i + 1][j] = m[4 * j + 3] - m[4 * j + i];
+		}
+	}
+}
+
+Frustum::Containment Frustum::contains(const float *min, const float *max) const {
+	Containment containment = kContainmentInside;
+
+	for (int i = 0; i < 6; i++) {
+		const float *p = _planes[i];
+
+		// The corners farthest along and against the plane normal
+		const float far  = p[0] * ((p[0] >= 0.0f) ? max[0] : min[0]) +
+		                   p[1] * ((p[1] >= 0.0f) ? max[1] : min[1]) +
+		                   p[2] * ((p[2] >= 0.0f) ? max[2] : min[2]) + p[3];
+		const float near = p[0] * ((p[0] >= 0.0f) ? min[0] : max[0]) +
+		                   p[1] * ((p[1] >= 0.0f) ? min[1] : max[1]) +
+		                   p[2] * ((p[2] >= 0.0f) ? min[2] : max[2]) + p[3];
+
+		if (far < 0.0f)
+			return kContainmentOutside;
+
+		if (near < 0.0f)
+			containment = kContainmentIntersect;
+	}
+
+	return containment;
+}
+
+} // End of namespace Graphics
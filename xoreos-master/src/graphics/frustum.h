@@ -0,0 +1,65 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A view frustum, for culling.
+ */
+
+#ifndef GRAPHICS_FRUSTUM_H
+#define GRAPHICS_FRUSTUM_H
+
+#include "src/common/types.h"
+
+namespace Common {
+	class Matrix4x4;
+}
+
+namespace Graphics {
+
+/** The volume visible through a camera, bounded by six planes. */
+class Frustum {
+public:
+	/** Where a box lies in relation to the frustum. */
+	enum Containment {
+		kContainmentOutside,   ///< Completely outside.
+		kContainmentIntersect, ///< Partially inside.
+		kContainmentInside     ///< Completely inside.
+	};
+
+	Frustum();
+
+	/** Extract the frustum planes out of a combined projection and modelview matrix.
+	 *
+	 *  This works for both perspective and orthogonal projections. The frustum
+	 *  is then in the coordinate space the modelview matrix transforms from.
+	 */
+	void set(const Common::Matrix4x4 &projectionModelview);
+
+	/** Where does the axis-aligned box between min and max lie? */
+	Containment contains(const float *min, const float *max) const;
+
+private:
+	/** Planes a.x + b.y + c.z + d = 0, with the normal (a, b, c) pointing inside. */
+	float _planes[6][4];
+};
+
+} // End of namespace Graphics
+
+#endif // GRAPHICS_FRUSTUM_H
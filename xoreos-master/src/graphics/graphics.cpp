@@ -25,8 +25,13 @@
 #include <cassert>
 #include <cstring>
 
+#include <algorithm>
+#include <functional>
+
 #include <boost/bind.hpp>
 
+#include <SDL_cpuinfo.h>
+
 #include "src/version/version.h"
 
 #include "src/common/util.h"
@@ -50,6 +55,7 @@
 #include "src/graphics/glcontainer.h"
 #include "src/graphics/renderable.h"
 #include "src/graphics/camera.h"
+#include "src/graphics/frustum.h"
 
 #include "src/graphics/images/decoder.h"
 #include "src/graphics/images/screenshot.h"
@@ -65,6 +71,21 @@ namespace Graphics {
 
 PFNGLCOMPRESSEDTEXIMAGE2DPROC glCompressedTexImage2D;
 
+/** Advance the animation of one world object per job. */
+class AdvanceTimeJobs : public Common::JobSet {
+public:
+	AdvanceTimeJobs(const std::vector<Renderable *> &objects, float dt) : _objects(&objects), _dt(dt) {
+	}
+
+	void runJob(size_t index) {
+		(*_objects)[index]->advanceTime(_dt);
+	}
+
+private:
+	const std::vector<Renderable *> *_objects;
+	float _dt;
+};
+
 GraphicsManager::GraphicsManager() : Events::Notifyable() {
 	_ready = false;
 
@@ -105,6 +126,9 @@ GraphicsManager::GraphicsManager() : Events::Notifyable() {
 
 	_lastSampled = 0;
 
+	_worldObjectsChanges = 0;
+	_worldIndexValid     = false;
+
 	glCompressedTexImage2D = 0;
 }
 
@@ -143,6 +167,9 @@ void GraphicsManager::init() {
 	MaterialMan.init();
 	MeshMan.init();
 
+	// The main thread works on the jobs as well
+	_jobPool.init(MAX(SDL_GetCPUCount(), 1) - 1);
+
 	_ready = true;
 }
 
@@ -154,6 +181,8 @@ void GraphicsManager::deinit() {
 
 	QueueMan.clearAllQueues();
 
+	_jobPool.deinit();
+
 	MeshMan.deinit();
 	MaterialMan.deinit();
 	SurfaceMan.deinit();
@@ -675,7 +704,10 @@ bool GraphicsManager::unproject(float x, float y,
 
 void GraphicsManager::lockFrame() {
 	uint32 lock = _frameLock.fetch_add(1, boost::memory_order_acquire);
-	if (Common::isMainThread() || EventMan.quitRequested() || (lock > 0))
+
+	/* The job pool workers only ever run in the middle of renderWorld(), on
+	 * behalf of the main thread. Waiting for the frame to end would deadlock. */
+	if (Common::isMainThread() || _jobPool.isWorkerThread() || EventMan.quitRequested() || (lock > 0))
 		return;
 
 	_frameEndSignal.store(false, boost::memory_order_release);
@@ -804,7 +836,7 @@ Renderable *GraphicsManager::getGUIObjectAt(float x, float y) const {
 	return object;
 }
 
-Renderable *GraphicsManager::getWorldObjectAt(float x, float y) const {
+Renderable *GraphicsManager::getWorldObjectAt(float x, float y) {
 	if (QueueMan.isQueueEmpty(kQueueVisibleWorldObject))
 		return 0;
 
@@ -818,17 +850,43 @@ Renderable *GraphicsManager::getWorldObjectAt(float x, float y) const {
 	Renderable *object = 0;
 
 	QueueMan.lockQueue(kQueueVisibleWorldObject);
-	const std::list<Queueable *> &objects = QueueMan.getQueue(kQueueVisibleWorldObject);
 
-	for (std::list<Queueable *>::const_iterator o = objects.begin(); o != objects.end(); ++o) {
-		Renderable &r = static_cast<Renderable &>(**o);
+	if (!_worldIndexValid || (QueueMan.getQueueChanges(kQueueVisibleWorldObject) != _worldObjectsChanges)) {
+		// The index is out of date, go through all objects
 
-		if (!r.isClickable())
-			// Object isn't clickable, don't check
-			continue;
+		const std::list<Queueable *> &objects = QueueMan.getQueue(kQueueVisibleWorldObject);
+
+		for (std::list<Queueable *>::const_iterator o = objects.begin(); o != objects.end(); ++o) {
+			Renderable &r = static_cast<Renderable &>(**o);
+
+			if (!r.isClickable())
+				// Object isn't clickable, don't check
+				continue;
+
+			// If the line intersects with the object, return it
+			if (r.isIn(x1, y1, z1, x2, y2, z2)) {
+				object = &r;
+				break;
+			}
+		}
+
+		QueueMan.unlockQueue(kQueueVisibleWorldObject);
+		return object;
+	}
+
+	/* Only check the objects the index says might be hit, with the bounds as of
+	 * the last rendered frame. Like above, the object first in the queue wins.
+	 * _worldObjects is in render order, which is the reverse of the queue. */
+
+	std::vector<size_t> candidates;
+	_worldIndex.intersect(x1, y1, z1, x2, y2, z2, candidates);
+
+	std::sort(candidates.begin(), candidates.end(), std::greater<size_t>());
+
+	for (std::vector<size_t>::const_iterator c = candidates.begin(); c != candidates.end(); ++c) {
+		Renderable &r = *_worldObjects[*c];
 
-		// If the line intersects with the object, return it
-		if (r.isIn(x1, y1, z1, x2, y2, z2)) {
+		if (r.isClickable() && r.isIn(x1, y1, z1, x2, y2, z2)) {
 			object = &r;
 			break;
 		}
@@ -934,7 +992,7 @@ bool GraphicsManager::renderWorld() {
 	_modelview.translate(-cPos[0], -cPos[1], -cPos[2]);
 
 	QueueMan.lockQueue(kQueueVisibleWorldObject);
-	const std::list<Queueable *> &objects = QueueMan.getQueue(kQueueVisibleWorldObject);
+	collectWorldObjects();
 
 	buildNewTextures();
 
@@ -950,26 +1008,33 @@ bool GraphicsManager::renderWorld() {
 	// If game paused, skip the advanceTime loop below
 
 	// Advance time for animation queues
-	for (std::list<Queueable *>::const_reverse_iterator o = objects.rbegin();
-	     o != objects.rend(); ++o) {
-		static_cast<Renderable *>(*o)->advanceTime(elapsedTime);
-	}
+	advanceWorldObjects(elapsedTime);
+
+	// Only draw the objects within the view frustum
+	updateWorldIndex();
+
+	Frustum frustum;
+	frustum.set(_projection * _modelview);
+
+	_worldIndex.cull(frustum, _worldVisible);
 
 	// Draw opaque objects
-	for (std::list<Queueable *>::const_reverse_iterator o = objects.rbegin();
-	     o != objects.rend(); ++o) {
+	for (size_t i = 0; i < _worldObjects.size(); i++) {
+		if (!_worldVisible[i])
+			continue;
 
 		glPushMatrix();
-		static_cast<Renderable *>(*o)->render(kRenderPassOpaque);
+		_worldObjects[i]->render(kRenderPassOpaque);
 		glPopMatrix();
 	}
 
 	// Draw transparent objects
-	for (std::list<Queueable *>::const_reverse_iterator o = objects.rbegin();
-	     o != objects.rend(); ++o) {
+	for (size_t i = 0; i < _worldObjects.size(); i++) {
+		if (!_worldVisible[i])
+			continue;
 
 		glPushMatrix();
-		static_cast<Renderable *>(*o)->render(kRenderPassTransparent);
+		_worldObjects[i]->render(kRenderPassTransparent);
 		glPopMatrix();
 	}
 
@@ -977,6 +1042,44 @@ bool GraphicsManager::renderWorld() {
 	return true;
 }
 
+void GraphicsManager::collectWorldObjects() {
+	const uint32 changes = QueueMan.getQueueChanges(kQueueVisibleWorldObject);
+	if (_worldIndexValid && (changes == _worldObjectsChanges))
+		return;
+
+	const std::list<Queueable *> &objects = QueueMan.getQueue(kQueueVisibleWorldObject);
+
+	_worldObjects.clear();
+	for (std::list<Queueable *>::const_reverse_iterator o = objects.rbegin();
+	     o != objects.rend(); ++o)
+		_worldObjects.push_back(static_cast<Renderable *>(*o));
+
+	_worldObjectsChanges = changes;
+	_worldIndexValid     = false;
+}
+
+void GraphicsManager::advanceWorldObjects(float dt) {
+	/* Each object only touches its own model nodes, and the animations shared
+	 * through supermodels keep no state of their own. So all objects can be
+	 * advanced at the same time, before the (serial) draw passes. */
+
+	AdvanceTimeJobs jobs(_worldObjects, dt);
+	_jobPool.run(jobs, _worldObjects.size());
+}
+
+void GraphicsManager::updateWorldIndex() {
+	_worldBounds.resize(_worldObjects.size());
+	for (size_t i = 0; i < _worldObjects.size(); i++)
+		_worldBounds[i] = _worldObjects[i]->getWorldBound();
+
+	// Objects only moving around keep the shape of the tree
+	if (_worldIndexValid && _worldIndex.refit(_worldBounds))
+		return;
+
+	_worldIndex.build(_worldBounds);
+	_worldIndexValid = true;
+}
+
 bool GraphicsManager::renderGUIFront() {
 	return renderGUI(_scalingType, kQueueVisibleGUIFrontObject, false);
 }
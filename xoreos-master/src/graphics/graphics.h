@@ -34,12 +34,14 @@
 #include "src/common/scopedptr.h"
 #include "src/common/singleton.h"
 #include "src/common/mutex.h"
+#include "src/common/jobpool.h"
 #include "src/common/matrix4x4.h"
 #include "src/common/vector3.h"
 #include "src/common/ustring.h"
 
 #include "src/graphics/types.h"
 #include "src/graphics/windowman.h"
+#include "src/graphics/bvh.h"
 
 #include "src/events/notifyable.h"
 
@@ -48,6 +50,7 @@ namespace Graphics {
 class FPSCounter;
 class Cursor;
 class Renderable;
+class Queueable;
 
 /** The graphics manager. */
 class GraphicsManager : public Common::Singleton<GraphicsManager>, public Events::Notifyable {
@@ -194,6 +197,19 @@ private:
 	boost::atomic<uint32> _frameLock;
 	boost::atomic<bool>   _frameEndSignal;
 
+	/** Worker threads advancing the animations of the visible world objects each frame. */
+	Common::JobPool _jobPool;
+
+	std::vector<Renderable *> _worldObjects;        ///< The visible world objects, in render order.
+	uint32                    _worldObjectsChanges; ///< The world queue's changes counter for _worldObjects.
+
+	std::vector<const Common::BoundingBox *> _worldBounds; ///< The bounds of _worldObjects.
+
+	BoundingVolumeHierarchy _worldIndex;      ///< A spatial index over _worldObjects.
+	bool                    _worldIndexValid; ///< Does the _worldIndex match _worldObjects?
+
+	std::vector<bool> _worldVisible; ///< Which of _worldObjects are within the view frustum.
+
 	Cursor     *_cursor;       ///< The current cursor.
 
 	bool _takeScreenshot; ///< Should screenshot be taken?
@@ -227,10 +243,17 @@ private:
 	void cleanupAbandoned();
 
 	Renderable *getGUIObjectAt(float x, float y) const;
-	Renderable *getWorldObjectAt(float x, float y) const;
+	Renderable *getWorldObjectAt(float x, float y);
 
 	void buildNewTextures();
 
+	/** Update _worldObjects out of the visible world objects queue, if that changed. */
+	void collectWorldObjects();
+	/** Advance the animations of all visible world objects, in parallel. */
+	void advanceWorldObjects(float dt);
+	/** Update the spatial index with the current bounds of the world objects. */
+	void updateWorldIndex();
+
 	void beginScene();
 	bool playVideo();
 	bool renderWorld();
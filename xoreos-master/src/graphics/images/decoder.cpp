@@ -27,7 +27,6 @@
 #include "src/common/scopedptr.h"
 #include "src/common/util.h"
 #include "src/common/error.h"
-#include "src/common/memreadstream.h"
 
 #include "src/graphics/graphics.h"
 
@@ -229,14 +228,12 @@ void ImageDecoder::decompress(MipMap &out, const MipMap &in, PixelFormatRaw form
 
 	out.data.reset(new byte[out.size]);
 
-	Common::ScopedPtr<Common::MemoryReadStream> stream(new Common::MemoryReadStream(in.data.get(), in.size));
-
 	if      (format == kPixelFormatDXT1)
-		decompressDXT1(out.data.get(), *stream, out.width, out.height, out.width * 4);
+		decompressDXT1(out.data.get(), in.data.get(), in.size, out.width, out.height, out.width * 4);
 	else if (format == kPixelFormatDXT3)
-		decompressDXT3(out.data.get(), *stream, out.width, out.height, out.width * 4);
+		decompressDXT3(out.data.get(), in.data.get(), in.size, out.width, out.height, out.width * 4);
 	else if (format == kPixelFormatDXT5)
-		decompressDXT5(out.data.get(), *stream, out.width, out.height, out.width * 4);
+		decompressDXT5(out.data.get(), in.data.get(), in.size, out.width, out.height, out.width * 4);
 }
 
 void ImageDecoder::decompress() {
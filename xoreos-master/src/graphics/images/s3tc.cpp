@@ -22,198 +22,294 @@
  *  Manual S3TC DXTn decompression methods.
  */
 
+/* The decompression works directly on the DXTn blocks in memory. The palette
+ * of each block is computed with integer arithmetic, and the 16 pixels of a
+ * block are then written by a kernel that picks the palette entries for a
+ * whole row of pixels at once. There is an SSE2 and a NEON variant of that
+ * kernel, and a plain C++ fallback. All three produce the same output.
+ *
+ * The SIMD kernels build the pixels in the lanes of a vector register, and
+ * only match the RGBA byte order in memory on little-endian machines. */
+
+#include <cstring>
+
 #include "src/common/util.h"
-#include "src/common/readstream.h"
+#include "src/common/error.h"
 
 #include "src/graphics/images/s3tc.h"
 
+#if defined(XOREOS_LITTLE_ENDIAN)
+	#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+		#define XOREOS_S3TC_SSE2 1
+		#include <emmintrin.h>
+	#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+		#define XOREOS_S3TC_NEON 1
+		#include <arm_neon.h>
+	#endif
+#endif
+
 namespace Graphics {
 
-static inline uint32 convert565To8888(uint16 color) {
-	return ((color & 0x1F) << 11) | ((color & 0x7E0) << 13) | ((color & 0xF800) << 16) | 0xFF;
+enum DXTFormat {
+	kDXT1,
+	kDXT3,
+	kDXT5
+};
+
+/** The 4 RGBA colors a DXTn color block can pick from. */
+typedef byte ColorPalette[4][4];
+
+/** Expand a RGB565 color into RGBA, keeping the low bits of each channel empty. */
+static inline void expandColor(uint16 color, byte alpha, byte *rgba) {
+	rgba[0] = (color >> 8) & 0xF8;
+	rgba[1] = (color >> 3) & 0xFC;
+	rgba[2] = (color << 3) & 0xF8;
+	rgba[3] = alpha;
 }
 
-static inline uint32 interpolate32(double weight, uint32 color_0, uint32 color_1) {
-	byte r[3], g[3], b[3], a[3];
-	r[0] = color_0 >> 24;
-	r[1] = color_1 >> 24;
-	r[2] = (byte)((1.0f - weight) * (double)r[0] + weight * (double)r[1]);
-	g[0] = (color_0 >> 16) & 0xFF;
-	g[1] = (color_1 >> 16) & 0xFF;
-	g[2] = (byte)((1.0f - weight) * (double)g[0] + weight * (double)g[1]);
-	b[0] = (color_0 >> 8) & 0xFF;
-	b[1] = (color_1 >> 8) & 0xFF;
-	b[2] = (byte)((1.0f - weight) * (double)b[0] + weight * (double)b[1]);
-	a[0] = color_0 & 0xFF;
-	a[1] = color_1 & 0xFF;
-	a[2] = (byte)((1.0f - weight) * (double)a[0] + weight * (double)a[1]);
-	return r[2] << 24 | g[2] << 16 | b[2] << 8 | a[2];
+/** Read the two colors of a color block and interpolate the other two palette entries.
+ *
+ *  DXT1 blocks with color0 <= color1 have only one interpolated color, and the
+ *  fourth entry is transparent black. DXT3 and DXT5 blocks always have 4 colors,
+ *  and their alpha is filled in separately.
+ */
+static inline void readColorPalette(const byte *block, bool dxt1, ColorPalette &palette) {
+	const uint16 color0 = READ_LE_UINT16(block + 0);
+	const uint16 color1 = READ_LE_UINT16(block + 2);
+
+	const byte alpha = dxt1 ? 0xFF : 0x00;
+
+	expandColor(color0, alpha, palette[0]);
+	expandColor(color1, alpha, palette[1]);
+
+	if (!dxt1 || (color0 > color1)) {
+		for (int i = 0; i < 4; i++) {
+			palette[2][i] = (2 * palette[0][i] +     palette[1][i]) / 3;
+			palette[3][i] = (    palette[0][i] + 2 * palette[1][i]) / 3;
+		}
+	} else {
+		for (int i = 0; i < 4; i++) {
+			palette[2][i] = (palette[0][i] + palette[1][i]) / 2;
+			palette[3][i] = 0;
+		}
+	}
 }
 
-struct DXT1Texel {
-	uint16 color_0;
-	uint16 color_1;
-	uint32 pixels;
-};
+/** Read the explicit 4-bit alpha values of a DXT3 alpha block. */
+static inline void readAlphaDXT3(const byte *block, byte (&alpha)[16]) {
+	for (int i = 0; i < 8; i++) {
+		alpha[2 * i + 0] = (block[i] & 0x0F) << 4;
+		alpha[2 * i + 1] =  block[i] & 0xF0;
+	}
+}
 
-#define READ_DXT1_TEXEL(x) \
-	x.color_0 = src.readUint16LE(); \
-	x.color_1 = src.readUint16LE(); \
-	x.pixels = src.readUint32BE()
-
-void decompressDXT1(byte *dest, Common::SeekableReadStream &src, uint32 width, uint32 height, uint32 pitch) {
-	for (int32 ty = height; ty > 0; ty -= 4) {
-		for (uint32 tx = 0; tx < width; tx += 4) {
-			DXT1Texel tex;
-			READ_DXT1_TEXEL(tex);
-			uint32 blended[4];
-
-			blended[0] = convert565To8888(tex.color_0);
-			blended[1] = convert565To8888(tex.color_1);
-
-			if (tex.color_0 > tex.color_1) {
-				blended[2] = interpolate32(0.333333f, blended[0], blended[1]);
-				blended[3] = interpolate32(0.666666f, blended[0], blended[1]);
-			} else {
-				blended[2] = interpolate32(0.5f, blended[0], blended[1]);
-				blended[3] = 0;
-			}
+/** Read the interpolated alpha values of a DXT5 alpha block. */
+static inline void readAlphaDXT5(const byte *block, byte (&alpha)[16]) {
+	byte palette[8];
 
-			uint32 cpx = tex.pixels;
-			uint32 blockWidth = MIN<uint32>(width, 4);
-			uint32 blockHeight = MIN<uint32>(height, 4);
+	palette[0] = block[0];
+	palette[1] = block[1];
 
-			for (byte y = 0; y < blockHeight; ++y) {
-				for (byte x = 0; x < blockWidth; ++x) {
-					const uint32 destX = tx + x;
-					const uint32 destY = height - 1 - (ty - blockHeight + y);
+	if (palette[0] > palette[1]) {
+		for (int i = 1; i < 7; i++)
+			palette[i + 1] = ((7 - i) * palette[0] + i * palette[1] + 3) / 7;
+	} else {
+		for (int i = 1; i < 5; i++)
+			palette[i + 1] = ((5 - i) * palette[0] + i * palette[1] + 2) / 5;
 
-					const uint32 pixel =  blended[cpx & 3];
+		palette[6] = 0x00;
+		palette[7] = 0xFF;
+	}
 
-					cpx >>= 2;
+	// 16 3-bit indices, as a 48-bit little-endian value
+	uint64 indices = 0;
+	for (int i = 0; i < 6; i++)
+		indices |= ((uint64) block[2 + i]) << (8 * i);
 
-					if ((destX < width) && (destY < height))
-						WRITE_BE_UINT32(dest + destY * pitch + destX * 4, pixel);
-				}
-			}
+	for (int i = 0; i < 16; i++, indices >>= 3)
+		alpha[i] = palette[indices & 7];
+}
+
+#if defined(XOREOS_S3TC_SSE2)
+
+/** Write a 4x4 block of pixels, picking the palette colors with the 2-bit indices.
+ *  If alpha is given, the alpha of each pixel is replaced with those values. */
+static inline void writePixels(byte *dest, size_t pitch, const ColorPalette &palette,
+                               const byte *indices, const byte *alpha) {
+
+	uint32 colors[4];
+	std::memcpy(colors, palette, sizeof(colors));
+
+	const __m128i color0 = _mm_set1_epi32((int) colors[0]);
+	const __m128i color1 = _mm_set1_epi32((int) colors[1]);
+	const __m128i color2 = _mm_set1_epi32((int) colors[2]);
+	const __m128i color3 = _mm_set1_epi32((int) colors[3]);
+
+	// Each lane looks at the index bits of its own pixel
+	const __m128i mask   = _mm_set_epi32(0xC0, 0x30, 0x0C, 0x03);
+	const __m128i index1 = _mm_set_epi32(0x40, 0x10, 0x04, 0x01);
+	const __m128i index2 = _mm_slli_epi32(index1, 1);
+	const __m128i index3 = _mm_or_si128(index1, index2);
+	const __m128i zero   = _mm_setzero_si128();
+
+	for (int y = 0; y < 4; y++, dest += pitch) {
+		const __m128i index = _mm_and_si128(_mm_set1_epi32(indices[y]), mask);
+
+		__m128i pixels = _mm_or_si128(
+			_mm_or_si128(_mm_and_si128(_mm_cmpeq_epi32(index, zero  ), color0),
+			             _mm_and_si128(_mm_cmpeq_epi32(index, index1), color1)),
+			_mm_or_si128(_mm_and_si128(_mm_cmpeq_epi32(index, index2), color2),
+			             _mm_and_si128(_mm_cmpeq_epi32(index, index3), color3)));
+
+		if (alpha) {
+			uint32 rowAlpha;
+			std::memcpy(&rowAlpha, alpha + 4 * y, 4);
+
+			const __m128i alpha32 =
+				_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128((int) rowAlpha), zero), zero);
+
+			pixels = _mm_or_si128(pixels, _mm_slli_epi32(alpha32, 24));
 		}
+
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dest), pixels);
 	}
 }
 
-struct DXT23Texel : public DXT1Texel {
-	uint16 alpha[4];
-};
+#elif defined(XOREOS_S3TC_NEON)
 
-#define READ_DXT3_TEXEL(x) \
-	x.alpha[0] = src.readUint16LE(); \
-	x.alpha[1] = src.readUint16LE(); \
-	x.alpha[2] = src.readUint16LE(); \
-	x.alpha[3] = src.readUint16LE(); \
-	READ_DXT1_TEXEL(x)
-
-void decompressDXT3(byte *dest, Common::SeekableReadStream &src, uint32 width, uint32 height, uint32 pitch) {
-	for (int32 ty = height; ty > 0; ty -= 4) {
-		for (uint32 tx = 0; tx < width; tx += 4) {
-			DXT23Texel tex;
-			uint32 blended[4];
-			READ_DXT3_TEXEL(tex);
-
-			blended[0] = convert565To8888(tex.color_0) & 0xFFFFFF00;
-			blended[1] = convert565To8888(tex.color_1) & 0xFFFFFF00;
-			blended[2] = interpolate32(0.333333f, blended[0], blended[1]);
-			blended[3] = interpolate32(0.666666f, blended[0], blended[1]);
-
-			uint32 cpx = tex.pixels;
-			uint32 blockWidth = MIN<uint32>(width, 4);
-			uint32 blockHeight = MIN<uint32>(height, 4);
-
-			for (byte y = 0; y < blockHeight; ++y) {
-				for (byte x = 0; x < blockWidth; ++x) {
-					const uint32 destX = tx + x;
-					const uint32 destY = height - 1 - (ty - blockHeight + y);
-
-					const uint32 alpha = (tex.alpha[y] >> (x * 4)) & 0xF;
-					const uint32 pixel = blended[cpx & 3] | alpha << 4;
-
-					cpx >>= 2;
-
-					if ((destX < width) && (destY < height))
-						WRITE_BE_UINT32(dest + destY * pitch + destX * 4, pixel);
-				}
-			}
+/** Write a 4x4 block of pixels, picking the palette colors with the 2-bit indices.
+ *  If alpha is given, the alpha of each pixel is replaced with those values. */
+static inline void writePixels(byte *dest, size_t pitch, const ColorPalette &palette,
+                               const byte *indices, const byte *alpha) {
+
+	static const uint32_t kMask  [4] = { 0x03, 0x0C, 0x30, 0xC0 };
+	static const uint32_t kIndex1[4] = { 0x01, 0x04, 0x10, 0x40 };
+
+	uint32_t colors[4];
+	std::memcpy(colors, palette, sizeof(colors));
+
+	const uint32x4_t color0 = vdupq_n_u32(colors[0]);
+	const uint32x4_t color1 = vdupq_n_u32(colors[1]);
+	const uint32x4_t color2 = vdupq_n_u32(colors[2]);
+	const uint32x4_t color3 = vdupq_n_u32(colors[3]);
+
+	// Each lane looks at the index bits of its own pixel
+	const uint32x4_t mask   = vld1q_u32(kMask);
+	const uint32x4_t index1 = vld1q_u32(kIndex1);
+	const uint32x4_t index2 = vshlq_n_u32(index1, 1);
+	const uint32x4_t index3 = vorrq_u32(index1, index2);
+	const uint32x4_t zero   = vdupq_n_u32(0);
+
+	for (int y = 0; y < 4; y++, dest += pitch) {
+		const uint32x4_t index = vandq_u32(vdupq_n_u32(indices[y]), mask);
+
+		uint32x4_t pixels = vorrq_u32(
+			vorrq_u32(vandq_u32(vceqq_u32(index, zero  ), color0),
+			          vandq_u32(vceqq_u32(index, index1), color1)),
+			vorrq_u32(vandq_u32(vceqq_u32(index, index2), color2),
+			          vandq_u32(vceqq_u32(index, index3), color3)));
+
+		if (alpha) {
+			uint32_t rowAlpha;
+			std::memcpy(&rowAlpha, alpha + 4 * y, 4);
+
+			const uint16x8_t alpha16 = vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(rowAlpha)));
+			const uint32x4_t alpha32 = vmovl_u16(vget_low_u16(alpha16));
+
+			pixels = vorrq_u32(pixels, vshlq_n_u32(alpha32, 24));
 		}
+
+		vst1q_u8(dest, vreinterpretq_u8_u32(pixels));
 	}
 }
 
-struct DXT45Texel : public DXT1Texel {
-	byte alpha_0;
-	byte alpha_1;
-	uint64 alphabl;
-};
+#else
+
+/** Write a 4x4 block of pixels, picking the palette colors with the 2-bit indices.
+ *  If alpha is given, the alpha of each pixel is replaced with those values. */
+static inline void writePixels(byte *dest, size_t pitch, const ColorPalette &palette,
+                               const byte *indices, const byte *alpha) {
+
+	for (int y = 0; y < 4; y++, dest += pitch) {
+		byte *pixel = dest;
+
+		for (int x = 0; x < 4; x++, pixel += 4) {
+			std::memcpy(pixel, palette[(indices[y] >> (2 * x)) & 3], 4);
+
+			if (alpha)
+				pixel[3] = alpha[4 * y + x];
+		}
+	}
+}
+
+#endif
 
-static uint64 readUint48LE(Common::SeekableReadStream &src) {
-	uint64 output = src.readUint32LE();
-	return output | ((uint64)src.readUint16LE() << 32);
+/** Decode one DXTn block into a 4x4 block of RGBA8 pixels. */
+template<DXTFormat format>
+static inline void decodeBlock(byte *dest, size_t pitch, const byte *block) {
+	ColorPalette palette;
+
+	if (format == kDXT1) {
+		readColorPalette(block, true, palette);
+		writePixels(dest, pitch, palette, block + 4, 0);
+		return;
+	}
+
+	byte alpha[16];
+	if (format == kDXT3)
+		readAlphaDXT3(block, alpha);
+	else
+		readAlphaDXT5(block, alpha);
+
+	readColorPalette(block + 8, false, palette);
+	writePixels(dest, pitch, palette, block + 12, alpha);
 }
 
-#define READ_DXT5_TEXEL(x) \
-	x.alpha_0 = src.readByte(); \
-	x.alpha_1 = src.readByte(); \
-	x.alphabl = readUint48LE(src); \
-	READ_DXT1_TEXEL(x)
-
-void decompressDXT5(byte *dest, Common::SeekableReadStream &src, uint32 width, uint32 height, uint32 pitch) {
-	for (int32 ty = height; ty > 0; ty -= 4) {
-		for (uint32 tx = 0; tx < width; tx += 4) {
-			uint32 blended[4];
-			byte alphab[8];
-			DXT45Texel tex;
-			READ_DXT5_TEXEL(tex);
-
-			alphab[0] = tex.alpha_0;
-			alphab[1] = tex.alpha_1;
-
-			if (tex.alpha_0 > tex.alpha_1) {
-				alphab[2] = (byte)((6.0f * (double)alphab[0] + 1.0f * (double)alphab[1] + 3.0f) / 7.0f);
-				alphab[3] = (byte)((5.0f * (double)alphab[0] + 2.0f * (double)alphab[1] + 3.0f) / 7.0f);
-				alphab[4] = (byte)((4.0f * (double)alphab[0] + 3.0f * (double)alphab[1] + 3.0f) / 7.0f);
-				alphab[5] = (byte)((3.0f * (double)alphab[0] + 4.0f * (double)alphab[1] + 3.0f) / 7.0f);
-				alphab[6] = (byte)((2.0f * (double)alphab[0] + 5.0f * (double)alphab[1] + 3.0f) / 7.0f);
-				alphab[7] = (byte)((1.0f * (double)alphab[0] + 6.0f * (double)alphab[1] + 3.0f) / 7.0f);
-			} else {
-				alphab[2] = (byte)((4.0f * (double)alphab[0] + 1.0f * (double)alphab[1] + 2.0f) / 5.0f);
-				alphab[3] = (byte)((3.0f * (double)alphab[0] + 2.0f * (double)alphab[1] + 2.0f) / 5.0f);
-				alphab[4] = (byte)((2.0f * (double)alphab[0] + 3.0f * (double)alphab[1] + 2.0f) / 5.0f);
-				alphab[5] = (byte)((1.0f * (double)alphab[0] + 4.0f * (double)alphab[1] + 2.0f) / 5.0f);
-				alphab[6] = 0;
-				alphab[7] = 255;
-			}
+template<DXTFormat format>
+static void decompress(byte *dest, const byte *src, size_t srcSize, uint32 width, uint32 height, uint32 pitch) {
+	const size_t blockSize = (format == kDXT1) ? 8 : 16;
+
+	const size_t blocksX = (width  + 3) / 4;
+	const size_t blocksY = (height + 3) / 4;
 
-			blended[0] = convert565To8888(tex.color_0) & 0xFFFFFF00;
-			blended[1] = convert565To8888(tex.color_1) & 0xFFFFFF00;
-			blended[2] = interpolate32(0.333333f, blended[0], blended[1]);
-			blended[3] = interpolate32(0.666666f, blended[0], blended[1]);
+	if ((blocksX * blocksY * blockSize) > srcSize)
+		throw Common::Exception("Not enough DXT data for %ux%u pixels (%u bytes)", width, height, (uint)srcSize);
 
-			uint32 cpx = tex.pixels;
-			uint32 blockWidth = MIN<uint32>(width, 4);
-			uint32 blockHeight = MIN<uint32>(height, 4);
+	for (size_t blockY = 0; blockY < blocksY; blockY++) {
+		byte *destRow = dest + blockY * 4 * pitch;
 
-			for (byte y = 0; y < blockHeight; ++y) {
-				for (byte x = 0; x < blockWidth; ++x) {
-					const uint32 destX = tx + x;
-					const uint32 destY = height - 1 - (ty - blockHeight + y);
+		const uint32 rows = MIN<uint32>(height - blockY * 4, 4);
 
-					const uint32 alpha = alphab[(tex.alphabl >> (3 * (4 * (3 - y) + x))) & 7];
-					const uint32 pixel = blended[cpx & 3] | alpha;
+		for (size_t blockX = 0; blockX < blocksX; blockX++, src += blockSize) {
+			byte *destBlock = destRow + blockX * 4 * 4;
 
-					cpx >>= 2;
+			const uint32 columns = MIN<uint32>(width - blockX * 4, 4);
 
-					if ((destX < width) && (destY < height))
-						WRITE_BE_UINT32(dest + destY * pitch + destX * 4, pixel);
-				}
+			if ((rows == 4) && (columns == 4)) {
+				decodeBlock<format>(destBlock, pitch, src);
+				continue;
 			}
+
+			// Clip the blocks at the right and bottom edges of the image
+			byte block[4 * 4 * 4];
+			decodeBlock<format>(block, 4 * 4, src);
+
+			for (uint32 y = 0; y < rows; y++)
+				std::memcpy(destBlock + y * pitch, block + y * 4 * 4, columns * 4);
 		}
 	}
 }
 
+void decompressDXT1(byte *dest, const byte *src, size_t srcSize, uint32 width, uint32 height, uint32 pitch) {
+	decompress<kDXT1>(dest, src, srcSize, width, height, pitch);
+}
+
+void decompressDXT3(byte *dest, const byte *src, size_t srcSize, uint32 width, uint32 height, uint32 pitch) {
+	decompress<kDXT3>(dest, src, srcSize, width, height, pitch);
+}
+
+void decompressDXT5(byte *dest, const byte *src, size_t srcSize, uint32 width, uint32 height, uint32 pitch) {
+	decompress<kDXT5>(dest, src, srcSize, width, height, pitch);
+}
+
 } // End of namespace Graphics
@@ -27,15 +27,28 @@
 
 #include "src/common/types.h"
 
-namespace Common {
-	class SeekableReadStream;
-}
-
 namespace Graphics {
 
-void decompressDXT1(byte *dest, Common::SeekableReadStream &src, uint32 width, uint32 height, uint32 pitch);
-void decompressDXT3(byte *dest, Common::SeekableReadStream &src, uint32 width, uint32 height, uint32 pitch);
-void decompressDXT5(byte *dest, Common::SeekableReadStream &src, uint32 width, uint32 height, uint32 pitch);
+/** Decompress DXT1 data into RGBA8 pixels.
+ *
+ *  The 4x4 pixel blocks are read from a contiguous block of memory. Blocks
+ *  at the right and bottom edges are clipped when width or height are not
+ *  multiples of 4.
+ *
+ *  @param dest    The memory to write the RGBA8 pixels into.
+ *  @param src     The DXT1 blocks.
+ *  @param srcSize The size of the DXT1 data in bytes.
+ *  @param width   The width of the image in pixels.
+ *  @param height  The height of the image in pixels.
+ *  @param pitch   The size of a row of pixels in dest, in bytes.
+ */
+void decompressDXT1(byte *dest, const byte *src, size_t srcSize, uint32 width, uint32 height, uint32 pitch);
+
+/** Decompress DXT3 data into RGBA8 pixels. See decompressDXT1() for the parameters. */
+void decompressDXT3(byte *dest, const byte *src, size_t srcSize, uint32 width, uint32 height, uint32 pitch);
+
+/** Decompress DXT5 data into RGBA8 pixels. See decompressDXT1() for the parameters. */
+void decompressDXT5(byte *dest, const byte *src, size_t srcSize, uint32 width, uint32 height, uint32 pitch);
 
 } // End of namespace Graphics
 
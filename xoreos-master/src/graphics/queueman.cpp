@@ -35,6 +35,8 @@ static bool queueComp(Queueable *a, Queueable *b) {
 
 
 QueueManager::QueueManager() {
+	for (int i = 0; i < kQueueMAX; i++)
+		_queueChanges[i] = 0;
 }
 
 QueueManager::~QueueManager() {
@@ -59,10 +61,15 @@ const std::list<Queueable *> &QueueManager::getQueue(QueueType queue) const {
 	return _queue[queue];
 }
 
+uint32 QueueManager::getQueueChanges(QueueType queue) const {
+	return _queueChanges[queue];
+}
+
 void QueueManager::sortQueue(QueueType queue) {
 	lockQueue(queue);
 
 	_queue[queue].sort(queueComp);
+	_queueChanges[queue]++;
 
 	unlockQueue(queue);
 }
@@ -72,6 +79,7 @@ std::list<Queueable *>::iterator QueueManager::addToQueue(QueueType queue, Queue
 
 	_queue[queue].push_back(&q);
 	std::list<Queueable *>::iterator ref = --_queue[queue].end();
+	_queueChanges[queue]++;
 
 	unlockQueue(queue);
 
@@ -84,6 +92,7 @@ void QueueManager::removeFromQueue(QueueType queue,
 	lockQueue(queue);
 
 	_queue[queue].erase(ref);
+	_queueChanges[queue]++;
 
 	unlockQueue(queue);
 }
@@ -96,6 +105,7 @@ void QueueManager::clearQueue(QueueType queue) {
 		(*q)->kickedOut(queue);
 
 	_queue[queue].clear();
+	_queueChanges[queue]++;
 
 	unlockQueue(queue);
 }
@@ -50,6 +50,9 @@ public:
 
 	const std::list<Queueable *> &getQueue(QueueType queue) const;
 
+	/** Return a counter that changes whenever objects are added to, removed from or reordered in the queue. */
+	uint32 getQueueChanges(QueueType queue) const;
+
 	void sortQueue(QueueType queue);
 	void clearQueue(QueueType queue);
 
@@ -59,6 +62,8 @@ private:
 	Common::Mutex _queueMutex[kQueueMAX];
 	std::list<Queueable *> _queue[kQueueMAX];
 
+	uint32 _queueChanges[kQueueMAX];
+
 	std::list<Queueable *>::iterator addToQueue(QueueType queue, Queueable &q);
 	void removeFromQueue(QueueType queue, const std::list<Queueable *>::iterator &ref);
 
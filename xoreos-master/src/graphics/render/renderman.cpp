@@ -47,6 +47,11 @@ void RenderManager::queueRenderable(Shader::ShaderRenderable *renderable, const
 	}
 }
 
+void RenderManager::removeRenderable(Shader::ShaderRenderable *renderable, const Common::Matrix4x4 *transform) {
+	_queueColorSolid.removeItem(renderable, transform);
+	_queueColorTransparent.removeItem(renderable, transform);
+}
+
 void RenderManager::sort() {
 	_queueColorSolid.sortShader();
 	_queueColorTransparent.sortDepth();
@@ -39,6 +39,7 @@ public:
 	void setCameraReference(const Common::Vector3 &reference);
 
 	void queueRenderable(Shader::ShaderRenderable *renderable, const Common::Matrix4x4 *transform);
+	void removeRenderable(Shader::ShaderRenderable *renderable, const Common::Matrix4x4 *transform);
 
 	void sort();
 
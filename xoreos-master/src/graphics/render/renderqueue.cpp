@@ -23,38 +23,43 @@
  */
 
 #include <cassert>
+#include <cstring>
 
 #include "src/graphics/render/renderqueue.h"
 #include "src/common/util.h"
 
-#include <algorithm>
-
 namespace Graphics {
 
 namespace Render {
 
-bool compareShader(const RenderQueue::RenderQueueNode &a, const RenderQueue::RenderQueueNode &b)
-{
-	if (a.program < b.program)
-		return false;
-	else if (a.program > b.program)
-		return true;
-	if (a.material < b.material)  // node_program values are equal.
-		return false;
-	else if (a.material > b.material)
-		return true;
-	else  // node material values are equal, compare mesh values next.
-		return (a.mesh <= b.mesh ? false : true);
-	// No, surfaces are not compared here.
+/** Number of distinct objects of one kind we hand out sort key IDs for.
+ *
+ *  Programs get 16 bits of the sort key, materials and meshes 24 bits each.
+ *  Once we run out of IDs, we start over. Objects might then share an ID,
+ *  which only means they might not be batched together optimally.
+ */
+static const size_t kMaxProgramIDs  = 1 << 16;
+static const size_t kMaxMaterialIDs = 1 << 24;
+static const size_t kMaxMeshIDs     = 1 << 24;
+
+
+RenderQueue::Stats::Stats() {
+	clear();
 }
 
-bool compareDepth(const RenderQueue::RenderQueueNode &a, const RenderQueue::RenderQueueNode &b) {
-	return (a.reference <= b.reference);
-	//return (a.reference.lengthSquared() <= b.reference.lengthSquared());
+void RenderQueue::Stats::clear() {
+	nodes           = 0;
+	batches         = 0;
+	programChanges  = 0;
+	materialChanges = 0;
+	meshChanges     = 0;
+	drawCalls       = 0;
+	reusedSorts     = 0;
 }
 
-RenderQueue::RenderQueue(uint32 precache) : _nodeArray(precache) {
-//	_nodeArray.reserve(1000);
+
+RenderQueue::RenderQueue(uint32 precache) : _order(kOrderNone), _reusedSort(false) {
+	_nodeArray.reserve(precache);
 }
 
 RenderQueue::~RenderQueue()
@@ -67,86 +72,225 @@ void RenderQueue::setCameraReference(const Common::Vector3 &reference) {
 }
 
 void RenderQueue::queueItem(Shader::ShaderProgram *program, Shader::ShaderSurface *surface, Shader::ShaderMaterial *material, Mesh::Mesh *mesh, const Common::Matrix4x4 *transform) {
-	Common::Vector3 ref = transform->getPosition();
-	ref -= _cameraReference;
-	// Length squared of ref serves as a suitable depth sorting value.
-	_nodeArray.push_back(RenderQueueNode(program, surface, material, mesh, transform, ref.dot(ref)));
+	addNode(RenderQueueNode(program, surface, material, mesh, transform));
 }
 
 void RenderQueue::queueItem(Shader::ShaderRenderable *renderable, const Common::Matrix4x4 *transform) {
-	Common::Vector3 ref = transform->getPosition();
-	ref -= _cameraReference;
-	// Length squared of ref serves as a suitable depth sorting value.
-	_nodeArray.push_back(RenderQueueNode(renderable->getProgram(), renderable->getSurface(), renderable->getMaterial(), renderable->getMesh(), transform, ref.dot(ref)));
+	addNode(RenderQueueNode(renderable, transform));
+}
+
+void RenderQueue::addNode(const RenderQueueNode &node) {
+	_nodeArray.push_back(node);
+	_nodeArray.back().shaderKey = getShaderKey(node);
+
+	_order = kOrderNone;
+}
+
+void RenderQueue::removeItem(Shader::ShaderRenderable *renderable, const Common::Matrix4x4 *transform) {
+	size_t kept = 0;
+	for (size_t i = 0; i < _nodeArray.size(); i++)
+		if ((_nodeArray[i].renderable != renderable) || (_nodeArray[i].transform != transform))
+			_nodeArray[kept++] = _nodeArray[i];
+
+	if (kept == _nodeArray.size())
+		return;
+
+	_nodeArray.resize(kept);
+	_order = kOrderNone;
+}
+
+void RenderQueue::updateNodes() {
+	for (std::vector<RenderQueueNode>::iterator n = _nodeArray.begin(); n != _nodeArray.end(); ++n) {
+		Shader::ShaderRenderable *renderable = n->renderable;
+		if (!renderable)
+			continue;
+
+		if ((n->program  == renderable->getProgram())  && (n->surface == renderable->getSurface()) &&
+		    (n->material == renderable->getMaterial()) && (n->mesh    == renderable->getMesh()))
+			continue;
+
+		n->program   = renderable->getProgram();
+		n->surface   = renderable->getSurface();
+		n->material  = renderable->getMaterial();
+		n->mesh      = renderable->getMesh();
+		n->shaderKey = getShaderKey(*n);
+
+		_order = kOrderNone;
+	}
+}
+
+uint32 RenderQueue::getID(IDMap &ids, const void *object, size_t maxIDs) {
+	IDMap::const_iterator id = ids.find(object);
+	if (id != ids.end())
+		return id->second;
+
+	if (ids.size() >= maxIDs)
+		ids.clear();
+
+	const uint32 newID = ids.size();
+	ids.insert(std::make_pair(object, newID));
+
+	return newID;
+}
+
+uint64 RenderQueue::getShaderKey(const RenderQueueNode &node) {
+	// No, surfaces are not part of the key.
+	return (((uint64) getID(_programIDs , node.program , kMaxProgramIDs )) << 48) |
+	       (((uint64) getID(_materialIDs, node.material, kMaxMaterialIDs)) << 24) |
+	        ((uint64) getID(_meshIDs    , node.mesh    , kMaxMeshIDs    ));
 }
 
 void RenderQueue::sortShader() {
-	std::sort(_nodeArray.begin(), _nodeArray.end(), compareShader);
+	updateNodes();
+
+	// Nothing changed, so the sorted order and batches from last time are still correct
+	_reusedSort = _order == kOrderShader;
+	if (_reusedSort)
+		return;
+
+	_keys.resize(_nodeArray.size());
+	for (size_t i = 0; i < _nodeArray.size(); i++)
+		_keys[i] = Common::RadixSortKey(_nodeArray[i].shaderKey, i);
+
+	sortKeys(kOrderShader);
 }
 
 void RenderQueue::sortDepth() {
-	std::sort(_nodeArray.begin(), _nodeArray.end(), compareDepth);
+	updateNodes();
+
+	// The camera and the items might have moved, so this needs to be sorted every time
+	_reusedSort = false;
+
+	_keys.resize(_nodeArray.size());
+	for (size_t i = 0; i < _nodeArray.size(); i++) {
+		RenderQueueNode &node = _nodeArray[i];
+
+		Common::Vector3 ref = node.transform->getPosition();
+		ref -= _cameraReference;
+		// Length squared of ref serves as a suitable depth sorting value.
+		node.reference = ref.dot(ref);
+
+		// The reference is never negative, so its bits sort the same as its value
+		uint32 depth;
+		std::memcpy(&depth, &node.reference, sizeof(depth));
+
+		_keys[i] = Common::RadixSortKey(depth, i);
+	}
+
+	sortKeys(kOrderDepth);
+}
+
+void RenderQueue::sortKeys(Order order) {
+	Common::radixSort(_keys, _keyScratch);
+
+	_sortedArray.resize(_nodeArray.size());
+	for (size_t i = 0; i < _keys.size(); i++)
+		_sortedArray[i] = _nodeArray[_keys[i].index];
+
+	buildBatches();
+
+	_order = order;
+}
+
+void RenderQueue::buildBatches() {
+	_batches.clear();
+
+	for (size_t i = 0; i < _sortedArray.size(); i++) {
+		const RenderQueueNode &node = _sortedArray[i];
+
+		if (!_batches.empty()) {
+			Batch &batch = _batches.back();
+
+			if ((batch.program == node.program) && (batch.material == node.material) &&
+			    (batch.surface == node.surface) && (batch.mesh     == node.mesh)) {
+				batch.end = i + 1;
+				continue;
+			}
+		}
+
+		Batch batch;
+		batch.program  = node.program;
+		batch.surface  = node.surface;
+		batch.material = node.material;
+		batch.mesh     = node.mesh;
+		batch.start    = i;
+		batch.end      = i + 1;
+
+		_batches.push_back(batch);
+	}
 }
 
 void RenderQueue::render() {
-	if (_nodeArray.size() == 0) {
+	_stats.clear();
+	_stats.reusedSorts = _reusedSort ? 1 : 0;
+
+	if (_order == kOrderNone) {
+		// Not sorted since the last change, so render in queueing order
+		_sortedArray = _nodeArray;
+		buildBatches();
+
+		_order      = kOrderQueue;
+		_reusedSort = false;
+	}
+
+	if (_batches.empty()) {
 		return;
 	}
 
 	Shader::ShaderProgram *currentProgram = 0;
 	Shader::ShaderMaterial *currentMaterial = 0;
-	Shader::ShaderSurface *currentSurface = 0;
-	Mesh::Mesh *currentMesh = 0;
-
-	uint32 i = 0;
-	uint32 limit = _nodeArray.size();
-	while (i < limit) {
-		assert(_nodeArray[i].program);
-		if (currentProgram != _nodeArray[i].program) {
-			currentProgram = _nodeArray[i].program;
+
+	for (std::vector<Batch>::const_iterator batch = _batches.begin(); batch != _batches.end(); ++batch) {
+		assert(batch->program);
+		if (currentProgram != batch->program) {
+			currentProgram = batch->program;
 			glUseProgram(currentProgram->glid);
+			_stats.programChanges++;
 
 			if (currentMaterial != 0) {
 				currentMaterial->unbindGLState();
 			}
 			currentMaterial = 0;
-			currentSurface = 0;
 		}
 
-		assert(_nodeArray[i].material);
-		if (currentMaterial != _nodeArray[i].material) {
+		assert(batch->material);
+		if (currentMaterial != batch->material) {
 			if (currentMaterial != 0) {
 				currentMaterial->unbindGLState();
 			}
-			currentMaterial = _nodeArray[i].material;
+			currentMaterial = batch->material;
 			currentMaterial->bindProgram(currentProgram);
 			currentMaterial->bindGLState();
+			_stats.materialChanges++;
 		}
 
-		assert(_nodeArray[i].surface);
-		assert(_nodeArray[i].mesh);
+		assert(batch->surface);
+		assert(batch->mesh);
 
-		currentSurface = _nodeArray[i].surface;
-		currentMesh = _nodeArray[i].mesh;
-		currentMesh->renderBind();  // Binds VAO ready for rendering.
+		batch->mesh->renderBind();  // Binds VAO ready for rendering.
+		_stats.meshChanges++;
+		_stats.batches++;
 
 		// There's at least one mesh to be rendering here.
-		assert(_nodeArray[i].transform);
-		currentSurface->bindProgram(currentProgram, _nodeArray[i].transform);
-		currentMesh->render();
+		assert(_sortedArray[batch->start].transform);
+		batch->surface->bindProgram(currentProgram, _sortedArray[batch->start].transform);
+		batch->mesh->render();
+		_stats.drawCalls++;
 
-		++i;  // Move to next object.
-		while ((i < limit) && (_nodeArray[i].mesh == currentMesh) && (_nodeArray[i].material == currentMaterial) && (_nodeArray[i].surface == currentSurface)) {
+		for (size_t i = batch->start + 1; i < batch->end; i++) {
 			// Next object is basically the same, but will have a different object modelview transform. So rebind that, and render again.
-			assert(_nodeArray[i].transform);
-			currentSurface->bindObjectModelview(currentProgram, _nodeArray[i].transform);
-			currentMesh->render();
-			++i;
+			assert(_sortedArray[i].transform);
+			batch->surface->bindObjectModelview(currentProgram, _sortedArray[i].transform);
+			batch->mesh->render();
+			_stats.drawCalls++;
 		}
+
 		// Done rendering, unbind the mesh, and onwards into the queue.
-		currentMesh->renderUnbind();
+		batch->mesh->renderUnbind();
 	}
 
+	_stats.nodes = _sortedArray.size();
+
 	// Restore OpenGL state on exit.
 	glDisable(GL_BLEND);
 	glEnable(GL_CULL_FACE);
@@ -156,6 +300,12 @@ void RenderQueue::render() {
 
 void RenderQueue::clear() {
 	_nodeArray.clear();
+
+	_order = kOrderNone;
+}
+
+const RenderQueue::Stats &RenderQueue::getStats() const {
+	return _stats;
 }
 
 } // namespace Render
@@ -25,11 +25,15 @@
 #ifndef GRAPHICS_RENDER_RENDERQUEUE_H
 #define GRAPHICS_RENDER_RENDERQUEUE_H
 
+#include <vector>
+
+#include <boost/unordered/unordered_map.hpp>
+
+#include "src/common/radixsort.h"
+
 #include "src/graphics/graphics.h"
 #include "src/graphics/shader/shaderrenderable.h"
 
-#include <vector>
-
 namespace Graphics {
 
 namespace Render {
@@ -37,20 +41,33 @@ namespace Render {
 class RenderQueue {
 public:
 	struct RenderQueueNode {
+		Shader::ShaderRenderable *renderable; ///< The renderable this item was queued from, if any.
 		Shader::ShaderProgram *program;
 		Shader::ShaderSurface *surface;
 		Shader::ShaderMaterial *material;
 		Mesh::Mesh *mesh;
 		const Common::Matrix4x4 *transform;
+		uint64 shaderKey; ///< Packed program, material and mesh IDs, for sorting by shader.
 		float reference;  ///< Reference point to the camera location, primarily used for depth sorting.
-		float padding;    ///< Padding for 64bit architectures.
 
-		RenderQueueNode() : program(0), surface(0), material(0), mesh(0), transform(0), reference(0.0f) {}
-		RenderQueueNode(const RenderQueueNode &src) : program(src.program), surface(src.surface), material(src.material), mesh(src.mesh), transform(src.transform), reference(src.reference) {}
-		RenderQueueNode(Shader::ShaderProgram *prog, Shader::ShaderSurface *sur, Shader::ShaderMaterial *mat, Mesh::Mesh *mes, const Common::Matrix4x4 *t) : program(prog), surface(sur), material(mat), mesh(mes), transform(t), reference(0.0f) {}
-		RenderQueueNode(Shader::ShaderProgram *prog, Shader::ShaderSurface *sur, Shader::ShaderMaterial *mat, Mesh::Mesh *mes, const Common::Matrix4x4 *t, float ref) : program(prog), surface(sur), material(mat), mesh(mes), transform(t), reference(ref) {}
+		RenderQueueNode() : renderable(0), program(0), surface(0), material(0), mesh(0), transform(0), shaderKey(0), reference(0.0f) {}
+		RenderQueueNode(Shader::ShaderProgram *prog, Shader::ShaderSurface *sur, Shader::ShaderMaterial *mat, Mesh::Mesh *mes, const Common::Matrix4x4 *t) : renderable(0), program(prog), surface(sur), material(mat), mesh(mes), transform(t), shaderKey(0), reference(0.0f) {}
+		RenderQueueNode(Shader::ShaderRenderable *r, const Common::Matrix4x4 *t) : renderable(r), program(r->getProgram()), surface(r->getSurface()), material(r->getMaterial()), mesh(r->getMesh()), transform(t), shaderKey(0), reference(0.0f) {}
+	};
+
+	/** Statistics about the last rendered contents of a queue. */
+	struct Stats {
+		uint32 nodes;           ///< Number of rendered queue items.
+		uint32 batches;         ///< Number of runs sharing program, material, surface and mesh.
+		uint32 programChanges;  ///< Number of shader program switches.
+		uint32 materialChanges; ///< Number of material switches.
+		uint32 meshChanges;     ///< Number of mesh binds.
+		uint32 drawCalls;       ///< Number of mesh render calls.
+		uint32 reusedSorts;     ///< Number of sorts skipped because the queue contents didn't change.
 
-		inline const RenderQueueNode &operator=(const RenderQueueNode &src) { material = src.material; surface = src.surface; mesh = src.mesh; transform = src.transform; reference = src.reference; return *this; }
+		Stats();
+
+		void clear();
 	};
 
 	RenderQueue(uint32 precache = 1000);
@@ -58,20 +75,92 @@ public:
 
 	void setCameraReference(const Common::Vector3 &reference);
 
+	/** Add an item to the queue.
+	 *
+	 *  Items stay queued over several frames, until they are removed again or
+	 *  the queue is cleared. As long as no item is added, removed or changes
+	 *  its material, the sorted order and the batches are kept from frame to
+	 *  frame.
+	 */
 	void queueItem(Shader::ShaderProgram *program, Shader::ShaderSurface *surface, Shader::ShaderMaterial *material, Mesh::Mesh *mesh, const Common::Matrix4x4 *transform);
+	/** Add a renderable to the queue. Changes to its program, surface, material
+	 *  or mesh are picked up at the next sort. */
 	void queueItem(Shader::ShaderRenderable *renderable, const Common::Matrix4x4 *transform);
 
-	void sortShader(); ///< Sort queue elements by shader program.
-	void sortDepth();  ///< Sort queue elements by depth.
+	/** Remove all items queued with this renderable and transform. */
+	void removeItem(Shader::ShaderRenderable *renderable, const Common::Matrix4x4 *transform);
+
+	/** Sort queue elements by shader program, then material, then mesh.
+	 *
+	 *  If no items were added, removed or changed since the last sort,
+	 *  the previous sorted order and batches are kept as they are.
+	 */
+	void sortShader();
+	/** Sort queue elements by depth, front to back. */
+	void sortDepth();
 
 	void render();  ///< Render all queued items.
 
 	void clear();  ///< Clear the queue of all items.
 
+	/** Return the statistics of the last render() call. */
+	const Stats &getStats() const;
+
 private:
+	typedef boost::unordered_map<const void *, uint32> IDMap;
+
+	/** A run of items sharing program, material, surface and mesh. */
+	struct Batch {
+		Shader::ShaderProgram *program;
+		Shader::ShaderSurface *surface;
+		Shader::ShaderMaterial *material;
+		Mesh::Mesh *mesh;
+
+		size_t start; ///< Index of the first item in _sortedArray.
+		size_t end;   ///< Index after the last item in _sortedArray.
+	};
+
+	std::vector<RenderQueueNode> _nodeArray;   ///< The items queued, in queueing order.
+	std::vector<RenderQueueNode> _sortedArray; ///< The items in sorted order.
+
+	std::vector<Batch> _batches; ///< The batches of _sortedArray.
+
+	/** The order of the items in _sortedArray. */
+	enum Order {
+		kOrderNone,   ///< Items were added, removed or changed since _sortedArray was built.
+		kOrderQueue,  ///< Queueing order.
+		kOrderShader, ///< Sorted by shader.
+		kOrderDepth   ///< Sorted by depth.
+	};
+
+	Order _order;
+	bool _reusedSort; ///< Did the last sort keep the previous order?
+
+	std::vector<Common::RadixSortKey> _keys;
+	std::vector<Common::RadixSortKey> _keyScratch;
+
+	/** Small, dense IDs for the objects in the sort keys. */
+	IDMap _programIDs;
+	IDMap _materialIDs;
+	IDMap _meshIDs;
 
-	std::vector<RenderQueueNode>_nodeArray;
 	Common::Vector3 _cameraReference;
+
+	Stats _stats;
+
+	static uint32 getID(IDMap &ids, const void *object, size_t maxIDs);
+
+	uint64 getShaderKey(const RenderQueueNode &node);
+
+	void addNode(const RenderQueueNode &node);
+
+	/** Pick up changes to the queued renderables. */
+	void updateNodes();
+
+	/** Sort the queued items by the keys in _keys, and batch them. */
+	void sortKeys(Order order);
+	/** Split _sortedArray into batches. */
+	void buildBatches();
 };
 
 } // namespace Render
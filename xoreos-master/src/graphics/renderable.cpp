@@ -138,6 +138,10 @@ bool Renderable::isIn(float UNUSED(x1), float UNUSED(y1), float UNUSED(z1),
 	return false;
 }
 
+const Common::BoundingBox *Renderable::getWorldBound() const {
+	return 0;
+}
+
 void Renderable::lockFrame() {
 	GfxMan.lockFrame();
 }
@@ -29,11 +29,13 @@
 
 #include "src/common/ustring.h"
 
-#include "src/common/ustring.h"
-
 #include "src/graphics/types.h"
 #include "src/graphics/queueable.h"
 
+namespace Common {
+	class BoundingBox;
+}
+
 namespace Graphics {
 
 /** An object that can be displayed by the graphics manager. */
@@ -81,6 +83,13 @@ public:
 	/** Does the line from x1.y1.z1 to x2.y2.z2 intersect with the object? */
 	virtual bool isIn(float x1, float y1, float z1, float x2, float y2, float z2) const;
 
+	/** Return the object's bounding box in world coordinates, or 0 if it's not known.
+	 *
+	 *  The object must be completely inside this box. Objects without a box are
+	 *  never culled, and always checked when picking.
+	 */
+	virtual const Common::BoundingBox *getWorldBound() const;
+
 protected:
 	QueueType _queueExists;
 	QueueType _queueVisible;
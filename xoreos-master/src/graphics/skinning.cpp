@@ -0,0 +1,220 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Skinning of mesh vertices on the CPU.
+ *
+ *  Instead of transforming a vertex by each of its bones and blending the
+ *  results, the kernels blend the bone matrices by the vertex's weights and
+ *  transform the vertex once. Since the bones are affine, this is the same.
+ *
+ *  Each matrix column is one 4-float vector, so blending is 16 multiply-adds
+ *  and transforming the position is another 4. There is an SSE2 and a NEON
+ *  variant of these kernels, as well as a plain C++ fallback.
+ */
+
+#include <cassert>
+#include <cmath>
+
+#include "src/graphics/skinning.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+	#define XOREOS_SKINNING_SSE2 1
+	#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#define XOREOS_SKINNING_NEON 1
+	#include <arm_neon.h>
+#endif
+
+namespace Graphics {
+
+SkinInfluences::SkinInfluences() : vertexCount(0), boneCount(0) {
+}
+
+void SkinInfluences::set(const float *boneIDs, const float *boneWeights, uint32 vertices, uint32 bonesCount) {
+	vertexCount = vertices;
+	boneCount   = bonesCount;
+
+	bones.resize(kInfluenceCount * vertexCount);
+	weights.resize(kInfluenceCount * vertexCount);
+
+	for (size_t i = 0; i < bones.size(); i++) {
+		const int bone = static_cast<int>(boneIDs[i]);
+
+		if ((bone < 0) || (static_cast<uint32>(bone) >= boneCount)) {
+			bones  [i] = 0;
+			weights[i] = 0.0f;
+			continue;
+		}
+
+		bones  [i] = bone;
+		weights[i] = boneWeights[i];
+	}
+}
+
+static inline void normalize(float *n) {
+	const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+	if (length <= 0.0f)
+		return;
+
+	n[0] /= length;
+	n[1] /= length;
+	n[2] /= length;
+}
+
+#if defined(XOREOS_SKINNING_SSE2)
+
+static inline void skinVertex(const uint16 *bones, const float *weights, const float *palette,
+                              const float *position, const float *normal, float *out) {
+
+	__m128 c0 = _mm_setzero_ps(), c1 = _mm_setzero_ps(), c2 = _mm_setzero_ps(), c3 = _mm_setzero_ps();
+
+	for (uint32 i = 0; i < SkinInfluences::kInfluenceCount; i++) {
+		const float  *m = palette + 16 * bones[i];
+		const __m128  w = _mm_set1_ps(weights[i]);
+
+		c0 = _mm_add_ps(c0, _mm_mul_ps(_mm_loadu_ps(m +  0), w));
+		c1 = _mm_add_ps(c1, _mm_mul_ps(_mm_loadu_ps(m +  4), w));
+		c2 = _mm_add_ps(c2, _mm_mul_ps(_mm_loadu_ps(m +  8), w));
+		c3 = _mm_add_ps(c3, _mm_mul_ps(_mm_loadu_ps(m + 12), w));
+	}
+
+	float result[4];
+
+	__m128 p = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(position[0])),
+	                                 _mm_mul_ps(c1, _mm_set1_ps(position[1]))),
+	                      _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(position[2])), c3));
+
+	_mm_storeu_ps(result, p);
+	out[0] = result[0];
+	out[1] = result[1];
+	out[2] = result[2];
+
+	if (!normal)
+		return;
+
+	__m128 n = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(normal[0])),
+	                                 _mm_mul_ps(c1, _mm_set1_ps(normal[1]))),
+	                      _mm_mul_ps(c2, _mm_set1_ps(normal[2])));
+
+	_mm_storeu_ps(result, n);
+	out[3] = result[0];
+	out[4] = result[1];
+	out[5] = result[2];
+
+	normalize(out + 3);
+}
+
+#elif defined(XOREOS_SKINNING_NEON)
+
+static inline void skinVertex(const uint16 *bones, const float *weights, const float *palette,
+                              const float *position, const float *normal, float *out) {
+
+	float32x4_t c0 = vdupq_n_f32(0.0f), c1 = vdupq_n_f32(0.0f), c2 = vdupq_n_f32(0.0f), c3 = vdupq_n_f32(0.0f);
+
+	for (uint32 i = 0; i < SkinInfluences::kInfluenceCount; i++) {
+		const float *m = palette + 16 * bones[i];
+
+		c0 = vmlaq_n_f32(c0, vld1q_f32(m +  0), weights[i]);
+		c1 = vmlaq_n_f32(c1, vld1q_f32(m +  4), weights[i]);
+		c2 = vmlaq_n_f32(c2, vld1q_f32(m +  8), weights[i]);
+		c3 = vmlaq_n_f32(c3, vld1q_f32(m + 12), weights[i]);
+	}
+
+	float result[4];
+
+	float32x4_t p = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(c3, c0, position[0]), c1, position[1]), c2, position[2]);
+
+	vst1q_f32(result, p);
+	out[0] = result[0];
+	out[1] = result[1];
+	out[2] = result[2];
+
+	if (!normal)
+		return;
+
+	float32x4_t n = vmlaq_n_f32(vmlaq_n_f32(vmulq_n_f32(c0, normal[0]), c1, normal[1]), c2, normal[2]);
+
+	vst1q_f32(result, n);
+	out[3] = result[0];
+	out[4] = result[1];
+	out[5] = result[2];
+
+	normalize(out + 3);
+}
+
+#else
+
+static inline void skinVertex(const uint16 *bones, const float *weights, const float *palette,
+                              const float *position, const float *normal, float *out) {
+
+	// Only the upper 3 rows of the affine matrices are of interest
+	float m[12] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+
+	for (uint32 i = 0; i < SkinInfluences::kInfluenceCount; i++) {
+		const float *bone = palette + 16 * bones[i];
+		const float  w    = weights[i];
+
+		for (uint32 c = 0; c < 4; c++) {
+			m[c * 3 + 0] += bone[c * 4 + 0] * w;
+			m[c * 3 + 1] += bone[c * 4 + 1] * w;
+			m[c * 3 + 2] += bone[c * 4 + 2] * w;
+		}
+	}
+
+	for (uint32 r = 0; r < 3; r++)
+		out[r] = m[r] * position[0] + m[3 + r] * position[1] + m[6 + r] * position[2] + m[9 + r];
+
+	if (!normal)
+		return;
+
+	for (uint32 r = 0; r < 3; r++)
+		out[3 + r] = m[r] * normal[0] + m[3 + r] * normal[1] + m[6 + r] * normal[2];
+
+	normalize(out + 3);
+}
+
+#endif
+
+void skinVertices(const SkinInfluences &influences, const float *palette,
+                  const float *positions, const float *normals, float *out, uint32 stride) {
+
+	if ((influences.vertexCount == 0) || (influences.boneCount == 0))
+		return;
+
+	assert(stride >= (normals ? 6 : 3));
+
+	const uint16 *bones   = &influences.bones[0];
+	const float  *weights = &influences.weights[0];
+
+	for (uint32 i = 0; i < influences.vertexCount; i++) {
+		skinVertex(bones, weights, palette, positions, normals, out);
+
+		bones     += SkinInfluences::kInfluenceCount;
+		weights   += SkinInfluences::kInfluenceCount;
+		positions += 3;
+		out       += stride;
+
+		if (normals)
+			normals += 3;
+	}
+}
+
+} // End of namespace Graphics
@@ -0,0 +1,83 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Skinning of mesh vertices on the CPU.
+ */
+
+#ifndef GRAPHICS_SKINNING_H
+#define GRAPHICS_SKINNING_H
+
+#include <vector>
+
+#include "src/common/types.h"
+
+namespace Graphics {
+
+/** The bone influences of the vertices of a skinned mesh.
+ *
+ *  Every vertex is influenced by up to 4 bones. The bone indices and weights
+ *  are kept in their own tightly packed arrays, apart from the vertex data.
+ *  Unused influences point to bone 0 with a weight of 0, so that the skinning
+ *  kernels don't need to branch.
+ */
+struct SkinInfluences {
+	static const uint32 kInfluenceCount = 4; ///< Influences per vertex.
+
+	uint32 vertexCount;
+	uint32 boneCount;
+
+	std::vector<uint16> bones;   ///< kInfluenceCount bone indices per vertex.
+	std::vector<float>  weights; ///< kInfluenceCount bone weights per vertex.
+
+	SkinInfluences();
+
+	/** Pack the bone influences as found in model files.
+	 *
+	 *  @param boneIDs     kInfluenceCount bone indices per vertex, as floats.
+	 *                     Negative indices mark unused influences.
+	 *  @param boneWeights kInfluenceCount bone weights per vertex.
+	 *  @param vertices    The number of vertices.
+	 *  @param bonesCount  The number of bones in the palette.
+	 */
+	void set(const float *boneIDs, const float *boneWeights, uint32 vertices, uint32 bonesCount);
+};
+
+/** Skin vertex positions and, optionally, normals.
+ *
+ *  Every bone in the palette is a column-major 4x4 affine matrix (16 floats),
+ *  transforming the initial vertex into its skinned position. A vertex is the
+ *  weighted sum of its positions as transformed by each of its bones. Normals
+ *  are blended the same way, without the translation, and then normalized.
+ *
+ *  @param influences The bone influences of the vertices.
+ *  @param palette    influences.boneCount bone matrices.
+ *  @param positions  The initial vertex positions, 3 floats per vertex.
+ *  @param normals    The initial vertex normals, 3 floats per vertex, or 0.
+ *  @param out        The first skinned vertex: its position, followed by its
+ *                    normal if normals are skinned too.
+ *  @param stride     The distance between two skinned vertices, in floats.
+ */
+void skinVertices(const SkinInfluences &influences, const float *palette,
+                  const float *positions, const float *normals, float *out, uint32 stride);
+
+} // End of namespace Graphics
+
+#endif // GRAPHICS_SKINNING_H
@@ -0,0 +1,121 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  The interface of an audio output backend.
+ */
+
+#ifndef SOUND_BACKEND_H
+#define SOUND_BACKEND_H
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/types.h"
+
+namespace Sound {
+
+/** An audio output backend.
+ *
+ *  This follows the model of OpenAL: a source plays a queue of buffers filled
+ *  with 16-bit PCM data. Once a buffer finished playing, it's processed, and
+ *  can be unqueued, refilled and queued again. A source that plays all its
+ *  queued buffers stops by itself.
+ *
+ *  The SoundManager only calls a backend while holding its mutex. Errors are
+ *  reported by throwing a Common::Exception.
+ */
+class AudioBackend : boost::noncopyable {
+public:
+	/** The name of a source. 0 is never a valid source. */
+	typedef uint32 Source;
+	/** The name of a buffer. 0 is never a valid buffer. */
+	typedef uint32 Buffer;
+
+	/** The playback state of a source. */
+	enum SourceState {
+		kSourceInitial, ///< Never played.
+		kSourcePlaying, ///< Currently playing.
+		kSourcePaused,  ///< Paused.
+		kSourceStopped  ///< Played all its buffers.
+	};
+
+	virtual ~AudioBackend() {}
+
+	/** Open the output device. */
+	virtual void init() = 0;
+	/** Close the output device. */
+	virtual void deinit() = 0;
+
+	/** Return the name of this backend. */
+	virtual const char *getName() const = 0;
+
+	/** Return the maximum time in ms the SoundManager may wait between two updates. */
+	virtual uint32 getUpdateInterval() const = 0;
+
+	/** Can the backend play PCM data with this many channels? */
+	virtual bool hasChannelCount(int channels) const = 0;
+
+	/** Set the gain of the listener (= the global master volume). */
+	virtual void setListenerGain(float gain) = 0;
+
+	// .--- Sources and buffers
+	virtual Source createSource() = 0;
+	virtual void deleteSource(Source source) = 0;
+
+	virtual Buffer createBuffer() = 0;
+	virtual void deleteBuffer(Buffer buffer) = 0;
+
+	/** Fill a buffer with this many bytes of 16-bit PCM data. */
+	virtual void bufferData(Buffer buffer, const int16 *data, size_t size, int channels, int rate) = 0;
+	// '---
+
+	// .--- Buffer queue
+	/** Queue a buffer at the end of a source's queue. */
+	virtual void queueBuffer(Source source, Buffer buffer) = 0;
+	/** Unqueue up to count processed buffers, returning the number unqueued. */
+	virtual size_t unqueueBuffers(Source source, Buffer *buffers, size_t count) = 0;
+
+	/** Return the number of buffers in a source's queue. */
+	virtual size_t getQueuedBuffers(Source source) = 0;
+	/** Return the number of buffers in a source's queue that finished playing. */
+	virtual size_t getProcessedBuffers(Source source) = 0;
+	// '---
+
+	// .--- Playback
+	virtual SourceState getSourceState(Source source) = 0;
+	/** Return the offset in bytes into the buffer that's currently playing. */
+	virtual size_t getSourceOffset(Source source) = 0;
+
+	virtual void playSource(Source source) = 0;
+	virtual void pauseSource(Source source) = 0;
+	// '---
+
+	// .--- Source properties
+	virtual void setSourceGain(Source source, float gain) = 0;
+	virtual void setSourcePitch(Source source, float pitch) = 0;
+
+	virtual void setSourcePosition(Source source, float x, float y, float z) = 0;
+	virtual void getSourcePosition(Source source, float &x, float &y, float &z) = 0;
+	// '---
+};
+
+} // End of namespace Sound
+
+#endif // SOUND_BACKEND_H
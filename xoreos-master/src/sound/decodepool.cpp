@@ -0,0 +1,284 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A pool of threads decoding audio streams ahead of their playback.
+ */
+
+#include <cassert>
+
+#include <algorithm>
+
+#include "src/common/util.h"
+#include "src/common/scopedptr.h"
+#include "src/common/error.h"
+#include "src/common/thread.h"
+
+#include "src/sound/decodepool.h"
+#include "src/sound/audiostream.h"
+
+/** Number of samples a worker decodes in one go. */
+static const size_t kDecodeChunkSize = 4096;
+
+/** Time in ms an idle worker waits before looking at starved streams again. */
+static const uint32 kIdleTimeout = 10;
+
+namespace Sound {
+
+DecodedStream::DecodedStream(AudioStream &stream, size_t capacity) : _stream(&stream),
+	_ring(MAX<size_t>(capacity, MAX(stream.getChannels(), 1))), _chunkSize(0),
+	_finished(false), _failed(false), _busy(false), _starved(false) {
+
+	// Only ever decode whole sample frames
+	const size_t frameSize = MAX(_stream->getChannels(), 1);
+
+	_chunkSize  = MIN(kDecodeChunkSize, _ring.getCapacity());
+	_chunkSize -= _chunkSize % frameSize;
+}
+
+DecodedStream::~DecodedStream() {
+}
+
+size_t DecodedStream::read(int16 *samples, size_t count) {
+	return _ring.read(samples, count);
+}
+
+size_t DecodedStream::getAvailable() const {
+	return _ring.getAvailable();
+}
+
+bool DecodedStream::endOfStream() const {
+	return _finished.load(boost::memory_order_acquire) && (_ring.getAvailable() == 0);
+}
+
+bool DecodedStream::hasFailed() const {
+	return _failed.load(boost::memory_order_acquire);
+}
+
+bool DecodedStream::needsData() const {
+	return !_finished.load(boost::memory_order_relaxed) && (_ring.getFree() >= _chunkSize);
+}
+
+size_t DecodedStream::decode(int16 *buffer, bool &starved) {
+	starved = false;
+
+	size_t count = MIN(_chunkSize, _ring.getFree());
+	count -= count % MAX(_stream->getChannels(), 1);
+
+	if (count == 0)
+		return 0;
+
+	size_t decoded = AudioStream::kSizeInvalid;
+	try {
+		decoded = _stream->readBuffer(buffer, count);
+	} catch (...) {
+		Common::exceptionDispatcherWarning("Failed decoding audio stream");
+	}
+
+	if ((decoded == AudioStream::kSizeInvalid) || (decoded > count)) {
+		_failed.store(true, boost::memory_order_release);
+		_finished.store(true, boost::memory_order_release);
+		return 0;
+	}
+
+	_ring.write(buffer, decoded);
+
+	if (_stream->endOfStream())
+		_finished.store(true, boost::memory_order_release);
+	else if (decoded == 0)
+		// No more data for now, but more might come later (queuing streams)
+		starved = true;
+
+	return decoded;
+}
+
+
+/** A worker thread of the pool. */
+class DecodePool::Worker : public Common::Thread {
+public:
+	Worker(DecodePool &pool) : _pool(&pool), _buffer(new int16[kDecodeChunkSize]) {
+	}
+
+	~Worker() {
+		destroyThread();
+	}
+
+private:
+	DecodePool *_pool;
+
+	Common::ScopedArray<int16> _buffer; ///< Scratch buffer for decoding.
+
+	void threadMethod() {
+		_pool->work(_buffer.get(), _killThread);
+	}
+};
+
+
+DecodePool::DecodePool() : _quit(false), _work(_mutex), _idle(_mutex) {
+}
+
+DecodePool::~DecodePool() {
+	deinit();
+}
+
+void DecodePool::init(size_t threadCount) {
+	deinit();
+
+	_quit = false;
+
+	for (size_t i = 0; i < threadCount; i++) {
+		_workers.push_back(new Worker(*this));
+
+		if (!_workers.back()->createThread("DecodePool")) {
+			_workers.pop_back();
+			break;
+		}
+	}
+
+	// Without any workers, nothing would decode the streams after they're added
+	if ((threadCount > 0) && _workers.empty())
+		throw Common::Exception("Failed to create audio decoding threads");
+}
+
+void DecodePool::deinit() {
+	_mutex.lock();
+	_quit = true;
+
+	for (size_t i = 0; i < _workers.size(); i++)
+		_work.signal();
+	_mutex.unlock();
+
+	// Waits for the threads to end
+	_workers.clear();
+
+	Common::StackLock lock(_mutex);
+
+	for (std::vector<DecodedStream *>::iterator s = _streams.begin(); s != _streams.end(); ++s)
+		delete *s;
+
+	_streams.clear();
+}
+
+size_t DecodePool::getThreadCount() const {
+	return _workers.size();
+}
+
+DecodedStream *DecodePool::add(AudioStream &stream, size_t capacity) {
+	Common::ScopedPtr<DecodedStream> decoded(new DecodedStream(stream, capacity));
+
+	// Prime the ring buffer, so that playback can start right away
+	int16 buffer[kDecodeChunkSize];
+	bool starved = false;
+	while (decoded->needsData() && !starved)
+		if (decoded->decode(buffer, starved) == 0)
+			break;
+
+	Common::StackLock lock(_mutex);
+
+	_streams.push_back(decoded.get());
+	_work.signal();
+
+	return decoded.release();
+}
+
+void DecodePool::remove(DecodedStream *stream) {
+	if (!stream)
+		return;
+
+	Common::StackLock lock(_mutex);
+
+	std::vector<DecodedStream *>::iterator s = std::find(_streams.begin(), _streams.end(), stream);
+	assert(s != _streams.end());
+
+	while (stream->_busy)
+		_idle.wait(kIdleTimeout);
+
+	_streams.erase(s);
+	delete stream;
+}
+
+void DecodePool::wake() {
+	Common::StackLock lock(_mutex);
+
+	_work.signal();
+}
+
+DecodedStream *DecodePool::claim() {
+	DecodedStream *claimed = 0;
+	size_t candidates = 0;
+
+	for (std::vector<DecodedStream *>::iterator s = _streams.begin(); s != _streams.end(); ++s) {
+		if ((*s)->_busy || (*s)->_starved || !(*s)->needsData())
+			continue;
+
+		candidates++;
+
+		// Prefer the stream with the fewest samples left to play
+		if (!claimed || ((*s)->getAvailable() < claimed->getAvailable()))
+			claimed = *s;
+	}
+
+	if (claimed)
+		claimed->_busy = true;
+
+	// Get another worker going if there's more work to do
+	if (candidates > 1)
+		_work.signal();
+
+	return claimed;
+}
+
+void DecodePool::work(int16 *buffer, const volatile bool &kill) {
+	Common::StackLock lock(_mutex);
+
+	while (!_quit && !kill) {
+		DecodedStream *stream = claim();
+		if (!stream) {
+			// Nothing to do right now. Give the starved streams another chance after a while
+			bool hasStarved = false;
+			for (std::vector<DecodedStream *>::iterator s = _streams.begin(); s != _streams.end(); ++s) {
+				hasStarved = hasStarved || (*s)->_starved;
+
+				(*s)->_starved = false;
+			}
+
+			/* Without any starved streams, only add(), wake() or deinit()
+			 * can give us something to do. Sleep until one of them does. */
+			if (hasStarved)
+				_work.wait(kIdleTimeout);
+			else
+				_work.wait();
+
+			continue;
+		}
+
+		bool starved = false;
+
+		_mutex.unlock();
+		stream->decode(buffer, starved);
+		_mutex.lock();
+
+		stream->_starved = starved;
+		stream->_busy    = false;
+		_idle.signal();
+	}
+}
+
+} // End of namespace Sound
@@ -0,0 +1,146 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A pool of threads decoding audio streams ahead of their playback.
+ */
+
+#ifndef SOUND_DECODEPOOL_H
+#define SOUND_DECODEPOOL_H
+
+#include "src/common/atomic.h"
+
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/types.h"
+#include "src/common/ptrvector.h"
+#include "src/common/mutex.h"
+
+#include "src/sound/ringbuffer.h"
+
+namespace Sound {
+
+class AudioStream;
+class DecodePool;
+
+/** An audio stream that is being decoded ahead by a DecodePool.
+ *
+ *  The decoded samples are read out of a ring buffer, which the pool's
+ *  workers keep filled. Reading never waits on the decoding.
+ */
+class DecodedStream : boost::noncopyable {
+public:
+	~DecodedStream();
+
+	/** Read up to this many already decoded samples, returning the number of samples read. */
+	size_t read(int16 *samples, size_t count);
+
+	/** Return the number of decoded samples ready to be read. */
+	size_t getAvailable() const;
+
+	/** Was the whole stream decoded and read? */
+	bool endOfStream() const;
+	/** Did decoding the stream fail? */
+	bool hasFailed() const;
+
+private:
+	AudioStream *_stream; ///< The stream we're decoding.
+	RingBuffer   _ring;   ///< The decoded samples.
+
+	size_t _chunkSize; ///< Number of samples to decode in one go.
+
+	boost::atomic<bool> _finished; ///< Has the whole stream been decoded?
+	boost::atomic<bool> _failed;   ///< Did the decoding fail?
+
+	bool _busy;    ///< Is a worker currently decoding this stream? Protected by the pool mutex.
+	bool _starved; ///< Did the stream run out of data for now? Protected by the pool mutex.
+
+	DecodedStream(AudioStream &stream, size_t capacity);
+
+	/** Does this stream have enough free space for another chunk? */
+	bool needsData() const;
+
+	/** Decode one chunk into the ring buffer, using this scratch buffer of at least chunk size.
+	 *
+	 *  Doesn't touch any of the state protected by the pool mutex. Instead, starved is set
+	 *  when the stream had no data for now, but might get more later.
+	 */
+	size_t decode(int16 *buffer, bool &starved);
+
+	friend class DecodePool;
+};
+
+/** A pool of worker threads, decoding audio streams ahead into ring buffers.
+ *
+ *  Whenever a stream has free space in its ring buffer, a worker decodes
+ *  another chunk of it, preferring the streams that are closest to running
+ *  dry. The workers sleep while there's nothing to decode.
+ */
+class DecodePool : boost::noncopyable {
+public:
+	DecodePool();
+	~DecodePool();
+
+	/** Start this many worker threads. */
+	void init(size_t threadCount);
+	/** Stop all worker threads and discard all streams. */
+	void deinit();
+
+	/** Return the number of worker threads. */
+	size_t getThreadCount() const;
+
+	/** Start decoding this audio stream into a ring buffer of at least this many samples.
+	 *
+	 *  The ring buffer is filled once right away, on the calling thread. Afterwards,
+	 *  only the workers may touch the audio stream until it is removed again. The
+	 *  audio stream is not taken over.
+	 */
+	DecodedStream *add(AudioStream &stream, size_t capacity);
+	/** Stop decoding and delete the decoded stream, waiting for a worker still decoding it. */
+	void remove(DecodedStream *stream);
+
+	/** Signal that decoded samples have been read, and the workers should refill. */
+	void wake();
+
+private:
+	class Worker;
+
+	Common::PtrVector<Worker> _workers;
+
+	std::vector<DecodedStream *> _streams; ///< All streams currently being decoded.
+
+	bool _quit; ///< Should the workers quit?
+
+	Common::Mutex     _mutex; ///< Protects the stream list and their state.
+	Common::Condition _work;  ///< Signals that a stream needs more data.
+	Common::Condition _idle;  ///< Signals that a worker finished decoding a chunk.
+
+	/** Find the most urgent stream needing data and mark it busy. Needs the mutex. */
+	DecodedStream *claim();
+
+	/** The main loop of a worker. */
+	void work(int16 *buffer, const volatile bool &kill);
+};
+
+} // End of namespace Sound
+
+#endif // SOUND_DECODEPOOL_H
@@ -405,6 +405,10 @@ size_t MS_ADPCMStream::readBuffer(int16 *buffer, const size_t numSamples) {
 
 	while (samples < numSamples && !_stream->eos() && _stream->pos() < _endpos) {
 		if (_blockPos[0] == _blockAlign) {
+			// The block header holds two samples per channel, which need to fit
+			if ((numSamples - samples) < (size_t)(2 * _channels))
+				break;
+
 			// read block header
 			for (i = 0; i < _channels; i++) {
 				_status.ch[i].predictor = CLIP(_stream->readByte(), (byte)0, (byte)6);
@@ -427,12 +431,16 @@ size_t MS_ADPCMStream::readBuffer(int16 *buffer, const size_t numSamples) {
 			_blockPos[0] = _channels * 7;
 		}
 
-		for (; samples < numSamples && _blockPos[0] < _blockAlign && !_stream->eos() && _stream->pos() < _endpos; samples += 2) {
+		for (; (samples + 2) <= numSamples && _blockPos[0] < _blockAlign && !_stream->eos() && _stream->pos() < _endpos; samples += 2) {
 			data = _stream->readByte();
 			_blockPos[0]++;
 			buffer[samples] = decodeMS(&_status.ch[0], (data >> 4) & 0x0f);
 			buffer[samples + 1] = decodeMS(&_status.ch[_channels - 1], data & 0x0f);
 		}
+
+		// Not enough room left for another pair of samples
+		if ((samples + 2) > numSamples)
+			break;
 	}
 
 	return samples;
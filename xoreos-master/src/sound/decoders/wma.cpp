@@ -566,7 +566,8 @@ Common::SeekableReadStream *WMACodec::decodeSuperFrame(Common::SeekableReadStrea
 	if (_blockAlign)
 		size = _blockAlign;
 
-	Common::BitStream8MSB bits(data);
+	Common::ScopedPtr<Common::MemoryReadStream> frameData(data.readStreamAt(data.pos(), data.size() - data.pos()));
+	Common::MemoryBitStream8MSB bits(*frameData);
 
 	int outputDataSize = 0;
 	Common::ScopedArray<int16> outputData;
@@ -625,8 +626,7 @@ Common::SeekableReadStream *WMACodec::decodeSuperFrame(Common::SeekableReadStrea
 				_lastSuperframeLen += 1;
 			}
 
-			Common::MemoryReadStream lastSuperframe(_lastSuperframe, _lastSuperframeLen);
-			Common::BitStream8MSB lastBits(lastSuperframe);
+			Common::MemoryBitStream8MSB lastBits(_lastSuperframe, _lastSuperframeLen);
 
 			lastBits.skip(_lastBitoffset);
 
@@ -689,7 +689,7 @@ Common::SeekableReadStream *WMACodec::decodeSuperFrame(Common::SeekableReadStrea
 	return new Common::MemoryReadStream(reinterpret_cast<byte *>(outputData.release()), outputDataSize * 2, true);
 }
 
-bool WMACodec::decodeFrame(Common::BitStream &bits, int16 *outputData) {
+bool WMACodec::decodeFrame(Common::MemoryBitStream8MSB &bits, int16 *outputData) {
 	_framePos = 0;
 	_curBlock = 0;
 
@@ -719,7 +719,7 @@ bool WMACodec::decodeFrame(Common::BitStream &bits, int16 *outputData) {
 	return true;
 }
 
-int WMACodec::decodeBlock(Common::BitStream &bits) {
+int WMACodec::decodeBlock(Common::MemoryBitStream8MSB &bits) {
 	// Computer new block length
 	if (!evalBlockLength(bits))
 		return -1;
@@ -772,7 +772,7 @@ int WMACodec::decodeBlock(Common::BitStream &bits) {
 	return 0;
 }
 
-bool WMACodec::decodeChannels(Common::BitStream &bits, int bSize,
+bool WMACodec::decodeChannels(Common::MemoryBitStream8MSB &bits, int bSize,
                               bool msStereo, bool *hasChannel) {
 
 	int totalGain    = readTotalGain(bits);
@@ -828,7 +828,7 @@ bool WMACodec::calculateIMDCT(int bSize, bool msStereo, bool *hasChannel) {
 	return true;
 }
 
-bool WMACodec::evalBlockLength(Common::BitStream &bits) {
+bool WMACodec::evalBlockLength(Common::MemoryBitStream8MSB &bits) {
 	if (_useVariableBlockLen) {
 		// Variable block lengths
 
@@ -904,7 +904,7 @@ void WMACodec::calculateCoefCount(int *coefCount, int bSize) const {
 		coefCount[i] = coefN;
 }
 
-bool WMACodec::decodeNoise(Common::BitStream &bits, int bSize,
+bool WMACodec::decodeNoise(Common::MemoryBitStream8MSB &bits, int bSize,
                            bool *hasChannel, int *coefCount) {
 	if (!_useNoiseCoding)
 		return true;
@@ -955,7 +955,7 @@ bool WMACodec::decodeNoise(Common::BitStream &bits, int bSize,
 	return true;
 }
 
-bool WMACodec::decodeExponents(Common::BitStream &bits, int bSize, bool *hasChannel) {
+bool WMACodec::decodeExponents(Common::MemoryBitStream8MSB &bits, int bSize, bool *hasChannel) {
 	// Exponents can be reused in short blocks
 	if (!((_blockLenBits == _frameLenBits) || bits.getBit()))
 		return true;
@@ -978,7 +978,7 @@ bool WMACodec::decodeExponents(Common::BitStream &bits, int bSize, bool *hasChan
 	return true;
 }
 
-bool WMACodec::decodeSpectralCoef(Common::BitStream &bits, bool msStereo, bool *hasChannel,
+bool WMACodec::decodeSpectralCoef(Common::MemoryBitStream8MSB &bits, bool msStereo, bool *hasChannel,
                                   int *coefCount, int coefBitCount) {
 	// Simple RLE encoding
 
@@ -1220,7 +1220,7 @@ static const float powTab[] = {
 	7.4989420933246e+05f, 8.6596432336007e+05f,
 };
 
-bool WMACodec::decodeExpHuffman(Common::BitStream &bits, int ch) {
+bool WMACodec::decodeExpHuffman(Common::MemoryBitStream8MSB &bits, int ch) {
 	const float  *ptab  = powTab + 60;
 	const uint32 *iptab = reinterpret_cast<const uint32 *>(ptab);
 
@@ -1318,7 +1318,7 @@ void WMACodec::lspToCurve(float *out, float *val_max_ptr, int n, float *lsp) {
 }
 
 // Decode exponents coded with LSP coefficients (same idea as Vorbis)
-bool WMACodec::decodeExpLSP(Common::BitStream &bits, int ch) {
+bool WMACodec::decodeExpLSP(Common::MemoryBitStream8MSB &bits, int ch) {
 	float lspCoefs[kLSPCoefCount];
 
 	for (int i = 0; i < kLSPCoefCount; i++) {
@@ -1336,7 +1336,7 @@ bool WMACodec::decodeExpLSP(Common::BitStream &bits, int ch) {
 	return true;
 }
 
-bool WMACodec::decodeRunLevel(Common::BitStream &bits, const Common::Huffman &huffman,
+bool WMACodec::decodeRunLevel(Common::MemoryBitStream8MSB &bits, const Common::Huffman &huffman,
 	const float *levelTable, const uint16 *runTable, int version, float *ptr,
 	int offset, int numCoefs, int blockLen, int frameLenBits, int coefNbBits) {
 
@@ -1478,7 +1478,7 @@ float WMACodec::pow_m1_4(float x) const {
 	return _lspPowETable[e] * (a + b * t.f);
 }
 
-int WMACodec::readTotalGain(Common::BitStream &bits) {
+int WMACodec::readTotalGain(Common::MemoryBitStream8MSB &bits) {
 	int totalGain = 1;
 
 	int v = 127;
@@ -1499,7 +1499,7 @@ int WMACodec::totalGainToBits(int totalGain) {
 	else                     return  9;
 }
 
-uint32 WMACodec::getLargeVal(Common::BitStream &bits) {
+uint32 WMACodec::getLargeVal(Common::MemoryBitStream8MSB &bits) {
 	// Consumes up to 34 bits
 
 	int count = 8;
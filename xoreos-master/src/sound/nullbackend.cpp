@@ -0,0 +1,304 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Headless audio output, only simulating the playback.
+ */
+
+#include <cstring>
+
+#include <SDL_timer.h>
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/strutil.h"
+
+#include "src/sound/nullbackend.h"
+
+namespace Sound {
+
+NullBackend::BufferData::BufferData() : channels(1), rate(0) {
+}
+
+NullBackend::SourceData::SourceData() : state(kSourceInitial), processed(0), offset(0),
+	gain(1.0f), pitch(1.0f) {
+
+	position[0] = position[1] = position[2] = 0.0f;
+}
+
+
+NullBackend::NullBackend(Mode mode, double speed, const Common::UString &dumpPrefix) :
+	_mode(mode), _speed(speed), _dumpPrefix(dumpPrefix), _lastName(0), _lastTicks(0),
+	_samplesPlayed(0) {
+
+	if ((_mode == kModeRealTime) && (_speed <= 0.0))
+		throw Common::Exception("Invalid null audio backend speed %f", _speed);
+}
+
+NullBackend::~NullBackend() {
+}
+
+void NullBackend::init() {
+	_lastTicks = SDL_GetTicks();
+}
+
+void NullBackend::deinit() {
+	_sources.clear();
+	_buffers.clear();
+}
+
+const char *NullBackend::getName() const {
+	return "null";
+}
+
+uint32 NullBackend::getUpdateInterval() const {
+	if (_mode == kModeFast)
+		return 1;
+
+	if (_mode == kModeRealTime)
+		return MAX<uint32>(100 / _speed, 1);
+
+	return 100;
+}
+
+bool NullBackend::hasChannelCount(int channels) const {
+	return (channels == 1) || (channels == 2) || (channels == 6);
+}
+
+void NullBackend::setListenerGain(float UNUSED(gain)) {
+}
+
+NullBackend::SourceData &NullBackend::getSource(Source source) {
+	Sources::iterator s = _sources.find(source);
+	if (s == _sources.end())
+		throw Common::Exception("Invalid null audio source %u", (uint) source);
+
+	return *s->second;
+}
+
+NullBackend::BufferData &NullBackend::getBuffer(Buffer buffer) {
+	Buffers::iterator b = _buffers.find(buffer);
+	if (b == _buffers.end())
+		throw Common::Exception("Invalid null audio buffer %u", (uint) buffer);
+
+	return *b->second;
+}
+
+AudioBackend::Source NullBackend::createSource() {
+	Common::ScopedPtr<SourceData> source(new SourceData);
+
+	const Source name = ++_lastName;
+
+	if (!_dumpPrefix.empty())
+		source->dump.reset(new Common::WriteFile(_dumpPrefix + Common::composeString(name) + ".raw"));
+
+	_sources.insert(std::make_pair(name, source.get()));
+	source.release();
+
+	return name;
+}
+
+void NullBackend::deleteSource(Source source) {
+	_sources.erase(source);
+}
+
+AudioBackend::Buffer NullBackend::createBuffer() {
+	const Buffer name = ++_lastName;
+
+	_buffers.insert(std::make_pair(name, new BufferData));
+
+	return name;
+}
+
+void NullBackend::deleteBuffer(Buffer buffer) {
+	_buffers.erase(buffer);
+}
+
+void NullBackend::bufferData(Buffer buffer, const int16 *data, size_t size, int channels, int rate) {
+	if (!hasChannelCount(channels) || (rate <= 0))
+		throw Common::Exception("Invalid null audio buffer format: %d channels, %dHz", channels, rate);
+
+	BufferData &b = getBuffer(buffer);
+
+	b.channels = channels;
+	b.rate     = rate;
+
+	b.samples.resize(size / 2);
+	if (!b.samples.empty())
+		std::memcpy(&b.samples[0], data, b.samples.size() * 2);
+}
+
+void NullBackend::queueBuffer(Source source, Buffer buffer) {
+	update();
+
+	getBuffer(buffer);
+	getSource(source).queue.push_back(buffer);
+}
+
+size_t NullBackend::unqueueBuffers(Source source, Buffer *buffers, size_t count) {
+	update();
+
+	SourceData &s = getSource(source);
+
+	count = MIN(count, s.processed);
+	for (size_t i = 0; i < count; i++) {
+		buffers[i] = s.queue.front();
+		s.queue.pop_front();
+	}
+
+	s.processed -= count;
+	return count;
+}
+
+size_t NullBackend::getQueuedBuffers(Source source) {
+	update();
+
+	return getSource(source).queue.size();
+}
+
+size_t NullBackend::getProcessedBuffers(Source source) {
+	update();
+
+	return getSource(source).processed;
+}
+
+AudioBackend::SourceState NullBackend::getSourceState(Source source) {
+	update();
+
+	return getSource(source).state;
+}
+
+size_t NullBackend::getSourceOffset(Source source) {
+	update();
+
+	return getSource(source).offset;
+}
+
+void NullBackend::playSource(Source source) {
+	update();
+
+	getSource(source).state = kSourcePlaying;
+}
+
+void NullBackend::pauseSource(Source source) {
+	update();
+
+	SourceData &s = getSource(source);
+	if (s.state == kSourcePlaying)
+		s.state = kSourcePaused;
+}
+
+void NullBackend::setSourceGain(Source source, float gain) {
+	getSource(source).gain = gain;
+}
+
+void NullBackend::setSourcePitch(Source source, float pitch) {
+	getSource(source).pitch = pitch;
+}
+
+void NullBackend::setSourcePosition(Source source, float x, float y, float z) {
+	SourceData &s = getSource(source);
+
+	s.position[0] = x;
+	s.position[1] = y;
+	s.position[2] = z;
+}
+
+void NullBackend::getSourcePosition(Source source, float &x, float &y, float &z) {
+	const SourceData &s = getSource(source);
+
+	x = s.position[0];
+	y = s.position[1];
+	z = s.position[2];
+}
+
+void NullBackend::advance(double ms) {
+	for (Sources::iterator s = _sources.begin(); s != _sources.end(); ++s)
+		if (s->second->state == kSourcePlaying)
+			play(*s->second, MAX(ms, 0.0));
+}
+
+uint64 NullBackend::getSamplesPlayed() const {
+	return _samplesPlayed;
+}
+
+void NullBackend::update() {
+	if (_mode == kModeFast) {
+		for (Sources::iterator s = _sources.begin(); s != _sources.end(); ++s)
+			if (s->second->state == kSourcePlaying)
+				play(*s->second, -1.0);
+
+		return;
+	}
+
+	if (_mode == kModeRealTime) {
+		const uint32 now = SDL_GetTicks();
+
+		advance((now - _lastTicks) * _speed);
+		_lastTicks = now;
+	}
+}
+
+void NullBackend::play(SourceData &source, double ms) {
+	while (source.processed < source.queue.size()) {
+		const BufferData &buffer = getBuffer(source.queue[source.processed]);
+
+		const size_t frameSize = buffer.channels * 2;
+		const size_t size      = buffer.samples.size() * 2;
+
+		size_t bytes = size - source.offset;
+
+		if ((ms >= 0.0) && (buffer.rate > 0)) {
+			const double bytesPerMs = (buffer.rate * frameSize * source.pitch) / 1000.0;
+
+			if ((bytes / bytesPerMs) > ms) {
+				// We can't finish this buffer yet
+				bytes  = (size_t) (ms * bytesPerMs);
+				bytes -= bytes % frameSize;
+
+				consume(source, buffer, bytes);
+				return;
+			}
+
+			ms -= bytes / bytesPerMs;
+		}
+
+		consume(source, buffer, bytes);
+
+		source.offset = 0;
+		source.processed++;
+	}
+
+	// Played all buffers
+	source.state = kSourceStopped;
+}
+
+void NullBackend::consume(SourceData &source, const BufferData &buffer, size_t bytes) {
+	if (bytes == 0)
+		return;
+
+	if (source.dump)
+		source.dump->write(reinterpret_cast<const byte *>(&buffer.samples[0]) + source.offset, bytes);
+
+	source.offset  += bytes;
+	_samplesPlayed += bytes / 2;
+}
+
+} // End of namespace Sound
@@ -0,0 +1,166 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Headless audio output, only simulating the playback.
+ */
+
+#ifndef SOUND_NULLBACKEND_H
+#define SOUND_NULLBACKEND_H
+
+#include <vector>
+#include <deque>
+
+#include "src/common/types.h"
+#include "src/common/scopedptr.h"
+#include "src/common/ptrmap.h"
+#include "src/common/ustring.h"
+#include "src/common/writefile.h"
+
+#include "src/sound/backend.h"
+
+namespace Sound {
+
+/** An audio output backend that doesn't need any audio device.
+ *
+ *  Sources are played by simply consuming their queued buffers, at a
+ *  simulated rate. This lets the whole channel pipeline run on headless
+ *  machines, for testing and benchmarking.
+ *
+ *  Optionally, the PCM data each source played is written into a raw file,
+ *  named after the dump prefix and the source's name.
+ *
+ *  Unlike OpenAL, a stopped source that's played again continues with the
+ *  buffers queued since, instead of replaying its processed buffers.
+ */
+class NullBackend : public AudioBackend {
+public:
+	/** How fast to play the sources. */
+	enum Mode {
+		kModeFast,     ///< Play everything queued right away.
+		kModeRealTime, ///< Play along with the wall clock, sped up by a factor.
+		kModeManual    ///< Only play when advance() is called.
+	};
+
+	NullBackend(Mode mode = kModeFast, double speed = 1.0, const Common::UString &dumpPrefix = "");
+	~NullBackend();
+
+	void init();
+	void deinit();
+
+	const char *getName() const;
+
+	uint32 getUpdateInterval() const;
+
+	bool hasChannelCount(int channels) const;
+
+	void setListenerGain(float gain);
+
+	Source createSource();
+	void deleteSource(Source source);
+
+	Buffer createBuffer();
+	void deleteBuffer(Buffer buffer);
+
+	void bufferData(Buffer buffer, const int16 *data, size_t size, int channels, int rate);
+
+	void queueBuffer(Source source, Buffer buffer);
+	size_t unqueueBuffers(Source source, Buffer *buffers, size_t count);
+
+	size_t getQueuedBuffers(Source source);
+	size_t getProcessedBuffers(Source source);
+
+	SourceState getSourceState(Source source);
+	size_t getSourceOffset(Source source);
+
+	void playSource(Source source);
+	void pauseSource(Source source);
+
+	void setSourceGain(Source source, float gain);
+	void setSourcePitch(Source source, float pitch);
+
+	void setSourcePosition(Source source, float x, float y, float z);
+	void getSourcePosition(Source source, float &x, float &y, float &z);
+
+	/** Play all playing sources for this many milliseconds of simulated time. */
+	void advance(double ms);
+
+	/** Return the number of samples all sources played so far. */
+	uint64 getSamplesPlayed() const;
+
+private:
+	/** A buffer of PCM data. */
+	struct BufferData {
+		std::vector<int16> samples;
+
+		int channels;
+		int rate;
+
+		BufferData();
+	};
+
+	/** A source playing a queue of buffers. */
+	struct SourceData {
+		SourceState state;
+
+		std::deque<Buffer> queue; ///< The queued buffers.
+		size_t processed;         ///< Number of buffers at the front of the queue that finished playing.
+		size_t offset;            ///< Offset in bytes into the currently playing buffer.
+
+		float gain;
+		float pitch;
+		float position[3];
+
+		Common::ScopedPtr<Common::WriteFile> dump; ///< File receiving the played data.
+
+		SourceData();
+	};
+
+	typedef Common::PtrMap<Source, SourceData> Sources;
+	typedef Common::PtrMap<Buffer, BufferData> Buffers;
+
+	Mode   _mode;
+	double _speed;
+
+	Common::UString _dumpPrefix;
+
+	Sources _sources;
+	Buffers _buffers;
+
+	uint32 _lastName;  ///< The last name given to a source or buffer.
+	uint32 _lastTicks; ///< Time of the last update in real time mode.
+
+	uint64 _samplesPlayed;
+
+	SourceData &getSource(Source source);
+	BufferData &getBuffer(Buffer buffer);
+
+	/** Play the sources as far as the mode says they should be by now. */
+	void update();
+
+	/** Play a source for this much time, or everything that's queued if negative. */
+	void play(SourceData &source, double ms);
+	/** Play this many bytes of the source's current buffer. */
+	void consume(SourceData &source, const BufferData &buffer, size_t bytes);
+};
+
+} // End of namespace Sound
+
+#endif // SOUND_NULLBACKEND_H
@@ -0,0 +1,227 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Audio output through OpenAL.
+ */
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+
+#include "src/sound/openal.h"
+
+namespace Sound {
+
+OpenALBackend::OpenALBackend() : _dev(0), _ctx(0), _hasMultiChannel(false), _format51(0) {
+}
+
+OpenALBackend::~OpenALBackend() {
+	deinit();
+}
+
+void OpenALBackend::init() {
+	deinit();
+
+	_dev = alcOpenDevice(0);
+	if (!_dev)
+		throw Common::Exception("Could not open OpenAL device");
+
+	_ctx = alcCreateContext(_dev, 0);
+	if (!_ctx)
+		throw Common::Exception("Could not create OpenAL context: 0x%X", (uint) alGetError());
+
+	alcMakeContextCurrent(_ctx);
+
+	ALenum error = alGetError();
+	if (error != AL_NO_ERROR)
+		throw Common::Exception("Could not use OpenAL context: 0x%X", (uint) error);
+
+	_hasMultiChannel = alIsExtensionPresent("AL_EXT_MCFORMATS") != 0;
+	_format51        = alGetEnumValue("AL_FORMAT_51CHN16");
+}
+
+void OpenALBackend::deinit() {
+	if (_ctx) {
+		alcMakeContextCurrent(0);
+		alcDestroyContext(_ctx);
+	}
+
+	if (_dev)
+		alcCloseDevice(_dev);
+
+	_ctx = 0;
+	_dev = 0;
+
+	_hasMultiChannel = false;
+	_format51        = 0;
+}
+
+const char *OpenALBackend::getName() const {
+	return "OpenAL";
+}
+
+uint32 OpenALBackend::getUpdateInterval() const {
+	return 100;
+}
+
+bool OpenALBackend::hasChannelCount(int channels) const {
+	if ((channels == 1) || (channels == 2))
+		return true;
+
+	return (channels == 6) && _hasMultiChannel;
+}
+
+void OpenALBackend::checkError(const char *action) const {
+	ALenum error = alGetError();
+	if (error != AL_NO_ERROR)
+		throw Common::Exception("OpenAL error while %s: 0x%X", action, (uint) error);
+}
+
+ALint OpenALBackend::getSourceInt(Source source, ALenum param, const char *action) const {
+	ALint value = 0;
+	alGetSourcei(source, param, &value);
+	checkError(action);
+
+	return value;
+}
+
+void OpenALBackend::setListenerGain(float gain) {
+	alListenerf(AL_GAIN, gain);
+}
+
+AudioBackend::Source OpenALBackend::createSource() {
+	ALuint source = 0;
+
+	alGenSources(1, &source);
+	checkError("generating sources");
+
+	return source;
+}
+
+void OpenALBackend::deleteSource(Source source) {
+	ALuint alSource = source;
+
+	alDeleteSources(1, &alSource);
+}
+
+AudioBackend::Buffer OpenALBackend::createBuffer() {
+	ALuint buffer = 0;
+
+	alGenBuffers(1, &buffer);
+	checkError("generating buffers");
+
+	return buffer;
+}
+
+void OpenALBackend::deleteBuffer(Buffer buffer) {
+	ALuint alBuffer = buffer;
+
+	alDeleteBuffers(1, &alBuffer);
+}
+
+void OpenALBackend::bufferData(Buffer buffer, const int16 *data, size_t size, int channels, int rate) {
+	ALenum format = AL_FORMAT_MONO16;
+	if      (channels == 2)
+		format = AL_FORMAT_STEREO16;
+	else if (channels == 6)
+		format = _format51;
+
+	alBufferData(buffer, format, data, size, rate);
+	checkError("filling buffer");
+}
+
+void OpenALBackend::queueBuffer(Source source, Buffer buffer) {
+	ALuint alBuffer = buffer;
+
+	alSourceQueueBuffers(source, 1, &alBuffer);
+	checkError("queueing buffers");
+}
+
+size_t OpenALBackend::unqueueBuffers(Source source, Buffer *buffers, size_t count) {
+	count = MIN(count, getProcessedBuffers(source));
+
+	for (size_t i = 0; i < count; i++) {
+		ALuint alBuffer = 0;
+
+		alSourceUnqueueBuffers(source, 1, &alBuffer);
+		checkError("unqueueing buffers");
+
+		buffers[i] = alBuffer;
+	}
+
+	return count;
+}
+
+size_t OpenALBackend::getQueuedBuffers(Source source) {
+	return MAX<ALint>(getSourceInt(source, AL_BUFFERS_QUEUED, "getting queued buffers"), 0);
+}
+
+size_t OpenALBackend::getProcessedBuffers(Source source) {
+	return MAX<ALint>(getSourceInt(source, AL_BUFFERS_PROCESSED, "getting processed buffers"), 0);
+}
+
+AudioBackend::SourceState OpenALBackend::getSourceState(Source source) {
+	switch (getSourceInt(source, AL_SOURCE_STATE, "getting source state")) {
+		case AL_PLAYING:
+			return kSourcePlaying;
+
+		case AL_PAUSED:
+			return kSourcePaused;
+
+		case AL_STOPPED:
+			return kSourceStopped;
+
+		default:
+			break;
+	}
+
+	return kSourceInitial;
+}
+
+size_t OpenALBackend::getSourceOffset(Source source) {
+	return MAX<ALint>(getSourceInt(source, AL_BYTE_OFFSET, "getting source offset"), 0);
+}
+
+void OpenALBackend::playSource(Source source) {
+	alSourcePlay(source);
+}
+
+void OpenALBackend::pauseSource(Source source) {
+	alSourcePause(source);
+	checkError("attempting to pause source");
+}
+
+void OpenALBackend::setSourceGain(Source source, float gain) {
+	alSourcef(source, AL_GAIN, gain);
+}
+
+void OpenALBackend::setSourcePitch(Source source, float pitch) {
+	alSourcef(source, AL_PITCH, pitch);
+}
+
+void OpenALBackend::setSourcePosition(Source source, float x, float y, float z) {
+	alSource3f(source, AL_POSITION, x, y, z);
+}
+
+void OpenALBackend::getSourcePosition(Source source, float &x, float &y, float &z) {
+	alGetSource3f(source, AL_POSITION, &x, &y, &z);
+}
+
+} // End of namespace Sound
@@ -0,0 +1,100 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Audio output through OpenAL.
+ */
+
+#ifndef SOUND_OPENAL_H
+#define SOUND_OPENAL_H
+
+// Mac OS X has to have this set up separately because of the include
+// path for the OpenAL framework.
+#ifdef MACOSX
+	#include <OpenAL/al.h>
+	#include <OpenAL/alc.h>
+#else
+	#include <AL/al.h>
+	#include <AL/alc.h>
+#endif
+
+#include "src/sound/backend.h"
+
+namespace Sound {
+
+/** An audio output backend playing sound through an OpenAL device. */
+class OpenALBackend : public AudioBackend {
+public:
+	OpenALBackend();
+	~OpenALBackend();
+
+	void init();
+	void deinit();
+
+	const char *getName() const;
+
+	uint32 getUpdateInterval() const;
+
+	bool hasChannelCount(int channels) const;
+
+	void setListenerGain(float gain);
+
+	Source createSource();
+	void deleteSource(Source source);
+
+	Buffer createBuffer();
+	void deleteBuffer(Buffer buffer);
+
+	void bufferData(Buffer buffer, const int16 *data, size_t size, int channels, int rate);
+
+	void queueBuffer(Source source, Buffer buffer);
+	size_t unqueueBuffers(Source source, Buffer *buffers, size_t count);
+
+	size_t getQueuedBuffers(Source source);
+	size_t getProcessedBuffers(Source source);
+
+	SourceState getSourceState(Source source);
+	size_t getSourceOffset(Source source);
+
+	void playSource(Source source);
+	void pauseSource(Source source);
+
+	void setSourceGain(Source source, float gain);
+	void setSourcePitch(Source source, float pitch);
+
+	void setSourcePosition(Source source, float x, float y, float z);
+	void getSourcePosition(Source source, float &x, float &y, float &z);
+
+private:
+	ALCdevice *_dev;
+	ALCcontext *_ctx;
+
+	bool _hasMultiChannel; ///< Do we have the multi-channel extension?
+	ALenum _format51; ///< The value for the 5.1 multi-channel format.
+
+	/** Throw an exception if the last OpenAL call failed. */
+	void checkError(const char *action) const;
+	/** Return the value of a source's integer property. */
+	ALint getSourceInt(Source source, ALenum param, const char *action) const;
+};
+
+} // End of namespace Sound
+
+#endif // SOUND_OPENAL_H
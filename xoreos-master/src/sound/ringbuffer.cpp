@@ -0,0 +1,99 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A lock-free ring buffer of PCM samples.
+ */
+
+#include <cstring>
+
+#include "src/common/util.h"
+
+#include "src/sound/ringbuffer.h"
+
+namespace Sound {
+
+RingBuffer::RingBuffer(size_t capacity) : _capacity(1), _readPos(0), _writePos(0) {
+	// A power of two lets the positions wrap around freely
+	while (_capacity < capacity)
+		_capacity <<= 1;
+
+	_samples.reset(new int16[_capacity]);
+}
+
+RingBuffer::~RingBuffer() {
+}
+
+size_t RingBuffer::getCapacity() const {
+	return _capacity;
+}
+
+size_t RingBuffer::getAvailable() const {
+	return _writePos.load(boost::memory_order_acquire) - _readPos.load(boost::memory_order_acquire);
+}
+
+size_t RingBuffer::getFree() const {
+	return _capacity - getAvailable();
+}
+
+void RingBuffer::copy(int16 *dest, const int16 *src, size_t count, size_t pos, bool toRing) {
+	const size_t offset = pos & (_capacity - 1);
+	const size_t first  = MIN(count, _capacity - offset);
+
+	if (toRing) {
+		std::memcpy(_samples.get() + offset, src, first * sizeof(int16));
+		std::memcpy(_samples.get(), src + first, (count - first) * sizeof(int16));
+	} else {
+		std::memcpy(dest, _samples.get() + offset, first * sizeof(int16));
+		std::memcpy(dest + first, _samples.get(), (count - first) * sizeof(int16));
+	}
+}
+
+size_t RingBuffer::write(const int16 *samples, size_t count) {
+	const size_t writePos = _writePos.load(boost::memory_order_relaxed);
+	const size_t readPos  = _readPos.load(boost::memory_order_acquire);
+
+	count = MIN(count, _capacity - (writePos - readPos));
+	if (count == 0)
+		return 0;
+
+	copy(0, samples, count, writePos, true);
+
+	// Publish the samples only after they have been copied
+	_writePos.store(writePos + count, boost::memory_order_release);
+	return count;
+}
+
+size_t RingBuffer::read(int16 *samples, size_t count) {
+	const size_t readPos  = _readPos.load(boost::memory_order_relaxed);
+	const size_t writePos = _writePos.load(boost::memory_order_acquire);
+
+	count = MIN(count, writePos - readPos);
+	if (count == 0)
+		return 0;
+
+	copy(samples, 0, count, readPos, false);
+
+	// Only hand the space back to the writer once we're done copying out of it
+	_readPos.store(readPos + count, boost::memory_order_release);
+	return count;
+}
+
+} // End of namespace Sound
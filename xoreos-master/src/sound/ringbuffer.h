@@ -0,0 +1,80 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A lock-free ring buffer of PCM samples.
+ */
+
+#ifndef SOUND_RINGBUFFER_H
+#define SOUND_RINGBUFFER_H
+
+#include "src/common/atomic.h"
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/types.h"
+#include "src/common/scopedptr.h"
+
+namespace Sound {
+
+/** A ring buffer of 16-bit PCM samples.
+ *
+ *  Exactly one thread may write into the ring buffer, and exactly one
+ *  other thread may read out of it. Both sides only ever share the read
+ *  and write positions, so neither of them ever has to wait for the other.
+ *
+ *  The memory is allocated once, on construction.
+ */
+class RingBuffer : boost::noncopyable {
+public:
+	/** Create a ring buffer that can hold at least this many samples. */
+	RingBuffer(size_t capacity);
+	~RingBuffer();
+
+	/** Return the number of samples the ring buffer can hold. */
+	size_t getCapacity() const;
+
+	/** Return the number of samples ready to be read. */
+	size_t getAvailable() const;
+	/** Return the number of samples that can be written. */
+	size_t getFree() const;
+
+	/** Write up to this many samples, returning the number of samples written. */
+	size_t write(const int16 *samples, size_t count);
+	/** Read up to this many samples, returning the number of samples read. */
+	size_t read(int16 *samples, size_t count);
+
+private:
+	Common::ScopedArray<int16> _samples; ///< The sample memory.
+
+	size_t _capacity; ///< Size of the sample memory, always a power of two.
+
+	/** Number of samples ever read. Only changed by the reading side. */
+	boost::atomic<size_t> _readPos;
+	/** Number of samples ever written. Only changed by the writing side. */
+	boost::atomic<size_t> _writePos;
+
+	/** Copy samples between a linear buffer and the ring, starting at a position. */
+	void copy(int16 *dest, const int16 *src, size_t count, size_t pos, bool toRing);
+};
+
+} // End of namespace Sound
+
+#endif // SOUND_RINGBUFFER_H
@@ -27,12 +27,23 @@ src_sound_libsound_la_SOURCES += \
     src/sound/sound.h \
     src/sound/audiostream.h \
     src/sound/interleaver.h \
+    src/sound/ringbuffer.h \
+    src/sound/decodepool.h \
+    src/sound/backend.h \
+    src/sound/openal.h \
+    src/sound/nullbackend.h \
+    src/sound/samplecache.h \
     $(EMPTY)
 
 src_sound_libsound_la_SOURCES += \
     src/sound/sound.cpp \
     src/sound/audiostream.cpp \
     src/sound/interleaver.cpp \
+    src/sound/ringbuffer.cpp \
+    src/sound/decodepool.cpp \
+    src/sound/openal.cpp \
+    src/sound/nullbackend.cpp \
+    src/sound/samplecache.cpp \
     $(EMPTY)
 
 src_sound_libsound_la_LIBADD = \
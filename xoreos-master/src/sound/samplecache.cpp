@@ -0,0 +1,325 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A cache of short, fully decoded sounds.
+ */
+
+#include <cstring>
+
+#include "src/common/scopedptr.h"
+#include "src/common/error.h"
+
+#include "src/sound/samplecache.h"
+#include "src/sound/audiostream.h"
+
+namespace Sound {
+
+/** Sounds that would take up more than this fraction of the cache
+ *  are never cached, so that one sound can't wipe the whole cache. */
+static const size_t kMaxCacheFraction = 4;
+
+/** Number of samples to decode in one go. */
+static const size_t kDecodeChunkSize = 4096;
+
+/** Maximum number of sounds remembered as too long to cache. */
+static const size_t kMaxTooLong = 1024;
+
+/** A stream playing a cached sound. */
+class SampleCache::SampleStream : public RewindableAudioStream {
+public:
+	SampleStream(const SamplePtr &sample) : _sample(sample), _pos(0) {
+	}
+
+	size_t readBuffer(int16 *buffer, const size_t numSamples) {
+		const size_t count = MIN(numSamples, _sample->samples.size() - _pos);
+		if (count > 0)
+			std::memcpy(buffer, &_sample->samples[_pos], count * sizeof(int16));
+
+		_pos += count;
+		return count;
+	}
+
+	int getChannels() const {
+		return _sample->channels;
+	}
+
+	int getRate() const {
+		return _sample->rate;
+	}
+
+	bool endOfData() const {
+		return _pos >= _sample->samples.size();
+	}
+
+	bool rewind() {
+		_pos = 0;
+		return true;
+	}
+
+	uint64 getLength() const {
+		return _sample->samples.size() / _sample->channels;
+	}
+
+private:
+	SamplePtr _sample; ///< The decoded sound.
+	size_t    _pos;    ///< The current position within the samples.
+};
+
+
+SampleCache::Stats::Stats() : budget(0), maxDuration(0), size(0), count(0), tooLong(0),
+	hits(0), misses(0), evictions(0) {
+
+}
+
+
+SampleCache::CachedSample::CachedSample(const Common::UString &n, const SamplePtr &s, size_t sz) :
+	name(n), sample(s), size(sz) {
+
+}
+
+
+SampleCache::SampleCache() : _changeCount(0), _generation(0) {
+}
+
+SampleCache::~SampleCache() {
+}
+
+void SampleCache::setSize(size_t size) {
+	Common::StackLock lock(_mutex);
+
+	_stats.budget = size;
+
+	// What's too long to cache depends on the budget
+	_tooLong.clear();
+	_stats.tooLong = 0;
+
+	evict();
+}
+
+void SampleCache::setMaxDuration(uint32 duration) {
+	Common::StackLock lock(_mutex);
+
+	_stats.maxDuration = duration;
+
+	_tooLong.clear();
+	_stats.tooLong = 0;
+}
+
+void SampleCache::getStats(Stats &stats) const {
+	Common::StackLock lock(_mutex);
+
+	stats = _stats;
+}
+
+void SampleCache::clear() {
+	Common::StackLock lock(_mutex);
+
+	flush();
+
+	_stats.hits      = 0;
+	_stats.misses    = 0;
+	_stats.evictions = 0;
+}
+
+void SampleCache::validate(uint32 changeCount) {
+	Common::StackLock lock(_mutex);
+
+	if (changeCount == _changeCount)
+		return;
+
+	_changeCount = changeCount;
+
+	flush();
+}
+
+void SampleCache::flush() {
+	// Needs to be called with _mutex locked
+
+	_cache.clear();
+	_cacheMap.clear();
+	_tooLong.clear();
+
+	_stats.size    = 0;
+	_stats.count   = 0;
+	_stats.tooLong = 0;
+
+	_generation++;
+}
+
+void SampleCache::evict() {
+	// Needs to be called with _mutex locked
+
+	while ((_stats.size > _stats.budget) && !_cache.empty()) {
+		const CachedSample &lru = _cache.back();
+
+		_stats.size -= lru.size;
+		_stats.count--;
+		_stats.evictions++;
+
+		_cacheMap.erase(lru.name);
+		_cache.pop_back();
+	}
+}
+
+RewindableAudioStream *SampleCache::get(const Common::UString &name) {
+	Common::StackLock lock(_mutex);
+
+	if (_stats.budget == 0)
+		return 0;
+
+	CacheMap::iterator cached = _cacheMap.find(name);
+	if (cached == _cacheMap.end()) {
+		_stats.misses++;
+		return 0;
+	}
+
+	// Move the sound to the front of the LRU list
+	_cache.splice(_cache.begin(), _cache, cached->second);
+
+	_stats.hits++;
+
+	return new SampleStream(cached->second->sample);
+}
+
+AudioStream *SampleCache::add(const Common::UString &name, AudioStream *stream) {
+	if (!stream)
+		throw Common::Exception("No stream");
+
+	Common::ScopedPtr<AudioStream> audioStream(stream);
+
+	size_t maxSize     = 0;
+	uint32 maxDuration = 0;
+	uint32 generation  = 0;
+
+	{
+		Common::StackLock lock(_mutex);
+
+		maxSize     = _stats.budget / kMaxCacheFraction;
+		maxDuration = _stats.maxDuration;
+		generation  = _generation;
+
+		// We already found out this one is too long
+		if (_tooLong.find(name) != _tooLong.end())
+			maxSize = 0;
+	}
+
+	// Only sounds we can go back to the start of can be tried
+	RewindableAudioStream *reAudioStream = dynamic_cast<RewindableAudioStream *>(stream);
+	if ((maxSize == 0) || (maxDuration == 0) || !reAudioStream)
+		return audioStream.release();
+
+	const int channels = stream->getChannels();
+	const int rate     = stream->getRate();
+	if ((channels <= 0) || (rate <= 0))
+		return audioStream.release();
+
+	// Don't even try to cache sounds that are obviously too long
+	const uint64 duration = reAudioStream->getDuration();
+	if ((duration != RewindableAudioStream::kInvalidLength) && (duration > maxDuration))
+		return audioStream.release();
+
+	const size_t maxSamples = (size_t) MIN<uint64>((((uint64) maxDuration) * rate / 1000) * channels,
+	                                               maxSize / sizeof(int16));
+
+	// Decode the whole sound outside the lock
+	bool tooLong = false;
+	Common::ScopedPtr<Sample> decoded(decode(*stream, maxSamples, tooLong));
+	if (!decoded) {
+		if (!reAudioStream->rewind())
+			throw Common::Exception("Failed to rewind sound \"%s\"", name.c_str());
+
+		if (tooLong) {
+			Common::StackLock lock(_mutex);
+
+			// Remember it, so that we don't decode it again next time
+			if (generation == _generation) {
+				if (_tooLong.size() >= kMaxTooLong)
+					_tooLong.clear();
+
+				_tooLong.insert(name);
+				_stats.tooLong = _tooLong.size();
+			}
+		}
+
+		return audioStream.release();
+	}
+
+	decoded->channels = channels;
+	decoded->rate     = rate;
+
+	audioStream.reset();
+
+	const SamplePtr sample(decoded.release());
+	const size_t size = sample->samples.size() * sizeof(int16);
+
+	Common::StackLock lock(_mutex);
+
+	/* Only add the sound if the cache hasn't been cleared in the meantime,
+	 * and no other thread has added the same sound already. */
+	if ((generation == _generation) && (_cacheMap.find(name) == _cacheMap.end())) {
+		_cache.push_front(CachedSample(name, sample, size));
+		_cacheMap.insert(std::make_pair(name, _cache.begin()));
+
+		_stats.size += size;
+		_stats.count++;
+
+		evict();
+	}
+
+	return new SampleStream(sample);
+}
+
+SampleCache::Sample *SampleCache::decode(AudioStream &stream, size_t maxSamples, bool &tooLong) {
+	tooLong = false;
+
+	Common::ScopedPtr<Sample> sample(new Sample);
+
+	while (!stream.endOfStream()) {
+		// Read one sample more than allowed, to find sounds that are too long
+		const size_t pos   = sample->samples.size();
+		const size_t count = MIN(kDecodeChunkSize, maxSamples + 1 - pos);
+
+		sample->samples.resize(pos + count);
+
+		const size_t read = stream.readBuffer(&sample->samples[pos], count);
+		if (read == AudioStream::kSizeInvalid)
+			return 0;
+
+		sample->samples.resize(pos + read);
+		if (sample->samples.size() > maxSamples) {
+			tooLong = true;
+			return 0;
+		}
+
+		if (read == 0)
+			break;
+	}
+
+	if (sample->samples.empty())
+		return 0;
+
+	// Don't keep the slack of the growing vector around
+	std::vector<int16>(sample->samples).swap(sample->samples);
+
+	return sample.release();
+}
+
+} // End of namespace Sound
@@ -0,0 +1,176 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A cache of short, fully decoded sounds.
+ */
+
+#ifndef SOUND_SAMPLECACHE_H
+#define SOUND_SAMPLECACHE_H
+
+#include <list>
+#include <map>
+#include <set>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "src/common/types.h"
+#include "src/common/ustring.h"
+#include "src/common/mutex.h"
+
+namespace Sound {
+
+class AudioStream;
+class RewindableAudioStream;
+
+/** A cache of short, fully decoded sounds.
+ *
+ *  Short sounds that are played over and over again, like footsteps or
+ *  weapon hits, are kept around as decoded PCM samples. Playing such a
+ *  sound again only creates a cheap stream reading out of the shared
+ *  samples, instead of reading and decoding the sound file again.
+ *
+ *  When the cache is full, the least recently used sounds are dropped.
+ *  Streams still playing a dropped sound keep its samples alive until
+ *  they are destroyed.
+ */
+class SampleCache : boost::noncopyable {
+public:
+	/** Statistics of the sample cache. */
+	struct Stats {
+		size_t budget;      ///< The maximum number of bytes the cache may hold.
+		uint32 maxDuration; ///< The maximum duration of a cached sound, in milliseconds.
+		size_t size;        ///< The number of bytes currently held.
+		size_t count;       ///< The number of sounds currently held.
+		size_t tooLong;     ///< The number of sounds known to be too long to cache.
+
+		uint64 hits;      ///< Number of requests served from the cache.
+		uint64 misses;    ///< Number of requests that had to decode the sound.
+		uint64 evictions; ///< Number of sounds dropped to stay within the budget.
+
+		Stats();
+	};
+
+	SampleCache();
+	~SampleCache();
+
+	/** Set the size of the cache, in bytes.
+	 *
+	 *  A size of 0 disables the cache. By default, the cache is disabled.
+	 */
+	void setSize(size_t size);
+
+	/** Set the maximum duration, in milliseconds, of sounds to keep in the cache. */
+	void setMaxDuration(uint32 duration);
+
+	/** Return the statistics of the cache. */
+	void getStats(Stats &stats) const;
+
+	/** Drop all sounds from the cache and reset its statistics. */
+	void clear();
+
+	/** Drop all sounds that were cached while their sources were different.
+	 *
+	 *  The change count is any counter that changes whenever the sources
+	 *  the sounds are read from change, like the resource manager's. When
+	 *  it differs from the one passed last time, all sounds are dropped.
+	 */
+	void validate(uint32 changeCount);
+
+	/** Return a new stream playing the cached sound of this name.
+	 *
+	 *  If no sound of this name is in the cache, 0 is returned instead.
+	 */
+	RewindableAudioStream *get(const Common::UString &name);
+
+	/** Decode this audio stream into the cache, if it's short enough.
+	 *
+	 *  The audio stream is taken over. If the sound was added to the cache,
+	 *  the audio stream is deleted and a new stream playing the cached sound
+	 *  is returned. Otherwise, the audio stream itself is returned, rewound
+	 *  to its start.
+	 *
+	 *  Sounds that had to be decoded to find out they're too long are
+	 *  remembered, and not decoded again the next time they're added.
+	 */
+	AudioStream *add(const Common::UString &name, AudioStream *stream);
+
+private:
+	/** The decoded samples of a sound, shared between the cache and all streams playing it. */
+	struct Sample {
+		std::vector<int16> samples; ///< The interleaved PCM samples.
+
+		int channels; ///< The number of channels.
+		int rate;     ///< The sample rate.
+	};
+
+	typedef boost::shared_ptr<const Sample> SamplePtr;
+
+	/** A sound held in the cache. */
+	struct CachedSample {
+		Common::UString name; ///< The name of the sound.
+
+		SamplePtr sample; ///< The decoded sound.
+		size_t    size;   ///< The size of the decoded sound in bytes.
+
+		CachedSample(const Common::UString &n, const SamplePtr &s, size_t sz);
+	};
+
+	/** List of cached sounds, most recently used first. */
+	typedef std::list<CachedSample> Cache;
+	/** Map over the cached sounds, indexed by their name. */
+	typedef std::map<Common::UString, Cache::iterator> CacheMap;
+	/** Set of sounds known to be too long to cache. */
+	typedef std::set<Common::UString> NameSet;
+
+	class SampleStream;
+
+	Cache    _cache;    ///< The cached sounds.
+	CacheMap _cacheMap; ///< The cached sounds, indexed by their name.
+	NameSet  _tooLong;  ///< The sounds known to be too long to cache.
+	Stats    _stats;    ///< Statistics of the cache.
+
+	/** The change count of the sounds' sources, see validate(). */
+	uint32 _changeCount;
+
+	/** Incremented every time the cache is cleared, to catch stale decodes. */
+	uint32 _generation;
+
+	/** Protects the cache. */
+	mutable Common::Mutex _mutex;
+
+	/** Drop the least recently used sounds until the cache is within its budget. Needs the mutex. */
+	void evict();
+	/** Drop all sounds, but keep the statistics. Needs the mutex. */
+	void flush();
+
+	/** Decode the whole audio stream into a sample, unless it's longer than this many samples.
+	 *
+	 *  If the stream couldn't be decoded, 0 is returned. tooLong is set when
+	 *  that's because the stream is longer than allowed.
+	 */
+	static Sample *decode(AudioStream &stream, size_t maxSamples, bool &tooLong);
+};
+
+} // End of namespace Sound
+
+#endif // SOUND_SAMPLECACHE_H
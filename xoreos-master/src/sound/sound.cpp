@@ -23,7 +23,8 @@
  */
 
 #include <cassert>
-#include <cstring>
+
+#include <SDL_cpuinfo.h>
 
 #include <boost/scope_exit.hpp>
 
@@ -36,74 +37,88 @@
 
 #include "src/sound/sound.h"
 #include "src/sound/audiostream.h"
+#include "src/sound/openal.h"
+#include "src/sound/nullbackend.h"
 #include "src/sound/decoders/asf.h"
 #include "src/sound/decoders/mp3.h"
 #include "src/sound/decoders/vorbis.h"
 #include "src/sound/decoders/wave.h"
 
-#include "src/events/events.h"
-
 DECLARE_SINGLETON(Sound::SoundManager)
 
-/** Control how many buffers per sound OpenAL will create.
+/** Control how many buffers per sound the audio backend will create.
  *
  *  @note clone2727 says: 5 is just a safe number. Mine only reached a max of 2.
  */
-static const size_t kOpenALBufferCount = 5;
+static const size_t kBufferCount = 5;
 
-/** Number of bytes per OpenAL buffer.
+/** Number of bytes per audio backend buffer.
  *
  *  @note Needs to be high enough to prevent stuttering, but low enough to
  *        prevent a noticeable lag. 32768 seems to work just fine.
  */
-static const size_t kOpenALBufferSize = 32768;
+static const size_t kBufferSize = 32768;
+
+/** Number of samples each channel is decoded ahead, on top of the backend buffers. */
+static const size_t kDecodeAheadSize = kBufferSize;
+
+/** Maximum number of threads decoding audio streams. */
+static const int kMaxDecodeThreads = 4;
 
 namespace Sound {
 
 SoundManager::Channel::Channel(uint32 i, size_t idx, SoundType t,
                                const TypeList::iterator &ti, AudioStream *s, bool d) :
-	id(i), index(idx), state(AL_PAUSED), stream(s, d), source(0),
-	type(t), typeIt(ti), finishedBuffers(0), gain(1.0f) {
+	id(i), index(idx), state(AudioBackend::kSourcePaused), stream(s, d), decoded(0), source(0),
+	type(t), typeIt(ti), finishedBuffers(0), gain(1.0f), underruns(0) {
 
 }
 
 
-SoundManager::SoundManager() : _ready(false), _hasSound(false), _hasMultiChannel(false), _format51(0) {
+SoundManager::SoundManager() : _ready(false), _hasSound(false) {
 }
 
 SoundManager::~SoundManager() {
 }
 
-void SoundManager::init() {
+AudioBackend *SoundManager::createBackend() {
+	const Common::UString backend = ConfigMan.getString("soundbackend", "openal");
+
+	if (backend.equalsIgnoreCase("openal"))
+		return new OpenALBackend;
+
+	if (backend.equalsIgnoreCase("null")) {
+		// A speed of 0 means as fast as possible
+		const double speed = ConfigMan.getDouble("soundspeed", 1.0);
+
+		return new NullBackend((speed > 0.0) ? NullBackend::kModeRealTime : NullBackend::kModeFast,
+		                       (speed > 0.0) ? speed : 1.0, ConfigMan.getString("sounddump"));
+	}
+
+	throw Common::Exception("Unknown sound backend \"%s\"", backend.c_str());
+}
+
+void SoundManager::init(AudioBackend *backend) {
+	Common::ScopedPtr<AudioBackend> newBackend(backend);
+
 	for (size_t i = 0; i < kSoundTypeMAX; i++)
 		_types[i].gain = 1.0f;
 
 	_curID = 1;
 
-	_ctx = 0;
-
 	_hasSound = false;
 
-	_hasMultiChannel = false;
-	_format51        = 0;
-
 	try {
-		_dev = alcOpenDevice(0);
-		if (!_dev)
-			throw Common::Exception("Could not open OpenAL device");
+		if (!newBackend)
+			newBackend.reset(createBackend());
 
-		_ctx = alcCreateContext(_dev, 0);
-		if (!_ctx)
-			throw Common::Exception("Could not create OpenAL context: 0x%X", (uint) alGetError());
+		newBackend->init();
+		_backend.reset(newBackend.release());
 
-		alcMakeContextCurrent(_ctx);
+		// Decode on all but one CPU, but always on at least one separate thread
+		_decodePool.init(CLIP(SDL_GetCPUCount() - 1, 1, kMaxDecodeThreads));
 
-		ALenum error = alGetError();
-		if (error != AL_NO_ERROR)
-			throw Common::Exception("Could not use OpenAL context: 0x%X", (uint) alGetError());
-
-		_hasMultiChannel = alIsExtensionPresent("AL_EXT_MCFORMATS") != 0;
-		_format51        = alGetEnumValue("AL_FORMAT_51CHN16");
+		_fillBuffer.reset(new int16[kBufferSize / 2]);
 
 		if (!createThread("SoundManager"))
 			throw Common::Exception("Failed to create sound thread: %s", SDL_GetError());
@@ -111,7 +126,10 @@ void SoundManager::init() {
 		_hasSound = true;
 
 	} catch (...) {
-		Common::exceptionDispatcherWarning("Failed to initialize OpenAL. Disabling sound output!");
+		Common::exceptionDispatcherWarning("Failed to initialize the sound output. Disabling sound output!");
+
+		_decodePool.deinit();
+		_backend.reset();
 	}
 
 	_ready = true;
@@ -125,6 +143,10 @@ void SoundManager::init() {
 	setTypeGain(kSoundTypeSFX  , ConfigMan.getDouble("volume_sfx"  , 1.0));
 	setTypeGain(kSoundTypeVoice, ConfigMan.getDouble("volume_voice", 1.0));
 	setTypeGain(kSoundTypeVideo, ConfigMan.getDouble("volume_video", 1.0));
+
+	const int cacheSize     = ConfigMan.getInt("soundcache", 0);
+	const int cacheDuration = ConfigMan.getInt("soundcacheduration", 0);
+	setSampleCache(((size_t) MAX(cacheSize, 0)) * 1024 * 1024, MAX(cacheDuration, 0));
 }
 
 void SoundManager::deinit() {
@@ -137,19 +159,27 @@ void SoundManager::deinit() {
 	for (size_t i = 0; i < kChannelCount; i++)
 		freeChannel(i);
 
-	if (_hasSound) {
-		alcMakeContextCurrent(0);
-		alcDestroyContext(_ctx);
-		alcCloseDevice(_dev);
-	}
+	_decodePool.deinit();
+
+	if (_backend)
+		_backend->deinit();
+
+	_backend.reset();
+
+	_sampleCache.clear();
 
-	_ready = false;
+	_hasSound = false;
+	_ready    = false;
 }
 
 bool SoundManager::ready() const {
 	return _ready;
 }
 
+AudioBackend *SoundManager::getBackend() {
+	return _hasSound ? _backend.get() : 0;
+}
+
 void SoundManager::triggerUpdate() {
 	checkReady();
 
@@ -178,7 +208,7 @@ bool SoundManager::isPlaying(const ChannelHandle &handle) {
 	return isPlaying(handle.channel);
 }
 
-bool SoundManager::isPlaying(size_t channel) const {
+bool SoundManager::isPlaying(size_t channel) {
 	if ((channel >= kChannelCount) || !_channels[channel])
 		return false;
 
@@ -189,36 +219,25 @@ bool SoundManager::isPlaying(size_t channel) const {
 	if (!_hasSound)
 		return true;
 
-	ALenum error = AL_NO_ERROR;
-
-	ALint val;
-	alGetSourcei(_channels[channel]->source, AL_SOURCE_STATE, &val);
-	if ((error = alGetError()) != AL_NO_ERROR)
-		throw Common::Exception("OpenAL error while getting source state in %s: 0x%X",
-		                        formatChannel(_channels[channel].get()).c_str(), error);
-
-	if (val != AL_PLAYING) {
-		if (!_channels[channel]->stream || _channels[channel]->stream->endOfStream()) {
-			ALint buffersQueued;
-			alGetSourcei(_channels[channel]->source, AL_BUFFERS_QUEUED, &buffersQueued);
-			if ((error = alGetError()) != AL_NO_ERROR)
-				throw Common::Exception("OpenAL error while getting queued buffers in %s: 0x%X",
-				                        formatChannel(_channels[channel].get()).c_str(), error);
-
-			ALint buffersProcessed;
-			alGetSourcei(_channels[channel]->source, AL_BUFFERS_PROCESSED, &buffersProcessed);
-			if ((error = alGetError()) != AL_NO_ERROR)
-				throw Common::Exception("OpenAL error while getting processed buffers in %s: 0x%X",
-				                        formatChannel(_channels[channel].get()).c_str(), error);
-
-			if (buffersQueued == buffersProcessed)
+	Channel &c = *_channels[channel];
+
+	const AudioBackend::SourceState state = _backend->getSourceState(c.source);
+	if (state != AudioBackend::kSourcePlaying) {
+		if (!c.decoded || c.decoded->endOfStream())
+			if (_backend->getQueuedBuffers(c.source) == _backend->getProcessedBuffers(c.source))
 				return false;
-		}
 
-		if (_channels[channel]->state != AL_PLAYING)
+		if (c.state != AudioBackend::kSourcePlaying)
 			return true;
 
-		alSourcePlay(_channels[channel]->source);
+		// The source played all its buffers before we could queue new ones
+		if (state == AudioBackend::kSourceStopped) {
+			c.underruns++;
+
+			debugC(Common::kDebugSound, 1, "Underrun in sound channel %s", formatChannel(&c).c_str());
+		}
+
+		_backend->playSource(c.source);
 	}
 
 	return true;
@@ -227,13 +246,13 @@ bool SoundManager::isPlaying(size_t channel) const {
 bool SoundManager::isPaused(const ChannelHandle &handle) {
 	Common::StackLock lock(_mutex);
 
-	if ((handle.channel == 0) || (handle.id == 0) || !_channels[handle.channel])
+	if ((handle.channel >= kChannelCount) || (handle.id == 0) || !_channels[handle.channel])
 		return false;
 
 	if (_channels[handle.channel]->id != handle.id)
 		return false;
 
-	return _channels[handle.channel]->state == AL_PAUSED;
+	return _channels[handle.channel]->state == AudioBackend::kSourcePaused;
 }
 
 AudioStream *SoundManager::makeAudioStream(Common::SeekableReadStream *stream) {
@@ -340,38 +359,33 @@ ChannelHandle SoundManager::playAudioStream(AudioStream *audStream, SoundType ty
 	if (!channel.stream)
 		throw Common::Exception("Could not detect stream type");
 
-	ALenum error = AL_NO_ERROR;
-
 	if (_hasSound) {
 		// Create the source
-		alGenSources(1, &channel.source);
-		if ((error = alGetError()) != AL_NO_ERROR)
-			throw Common::Exception("OpenAL error while generating sources: 0x%X", error);
+		channel.source = _backend->createSource();
 
-		// Create all needed buffers
-		for (size_t i = 0; i < kOpenALBufferCount; i++) {
-			ALuint buffer;
+		// Start decoding the stream, with the first part decoded right away
+		channel.decoded = _decodePool.add(*channel.stream, kDecodeAheadSize);
 
-			alGenBuffers(1, &buffer);
-			if ((error = alGetError()) != AL_NO_ERROR)
-				throw Common::Exception("OpenAL error while generating buffers: 0x%X", error);
+		// Create all needed buffers
+		for (size_t i = 0; i < kBufferCount; i++) {
+			const AudioBackend::Buffer buffer = _backend->createBuffer();
+			channel.buffers.push_back(buffer);
 
-			if (fillBuffer(channel, buffer, channel.stream.get(), channel.bufferSize[buffer])) {
+			if (fillBuffer(channel, buffer, channel.bufferSize[buffer])) {
 				// If we could fill the buffer with data, queue it
 
-				alSourceQueueBuffers(channel.source, 1, &buffer);
-				if ((error = alGetError()) != AL_NO_ERROR)
-					throw Common::Exception("OpenAL error while queueing buffers: 0x%X", error);
+				_backend->queueBuffer(channel.source, buffer);
 
 			} else
 				// If not, put it into our free list
 				channel.freeBuffers.push_back(buffer);
-
-			channel.buffers.push_back(buffer);
 		}
 
+		// We took data out of the ring buffer, so let the decode pool refill it
+		_decodePool.wake();
+
 		// Set the gain to the current sound type gain
-		alSourcef(channel.source, AL_GAIN, _types[channel.type].gain);
+		_backend->setSourceGain(channel.source, _types[channel.type].gain);
 	}
 
 	// Add the channel to the correct type list
@@ -390,8 +404,30 @@ ChannelHandle SoundManager::playSoundFile(Common::SeekableReadStream *wavStream,
 	if (!wavStream)
 		throw Common::Exception("No stream");
 
-	AudioStream *audioStream = makeAudioStream(wavStream);
+	return playSound(makeAudioStream(wavStream), type, loop);
+}
+
+ChannelHandle SoundManager::playSoundFile(const Common::UString &name, Common::SeekableReadStream *wavStream,
+                                          SoundType type, bool loop) {
+	checkReady();
+
+	if (!wavStream)
+		throw Common::Exception("No stream");
 
+	return playSound(_sampleCache.add(name, makeAudioStream(wavStream)), type, loop);
+}
+
+ChannelHandle SoundManager::playCachedSound(const Common::UString &name, SoundType type, bool loop) {
+	checkReady();
+
+	AudioStream *audioStream = _sampleCache.get(name);
+	if (!audioStream)
+		return ChannelHandle();
+
+	return playSound(audioStream, type, loop);
+}
+
+ChannelHandle SoundManager::playSound(AudioStream *audioStream, SoundType type, bool loop) {
 	if (loop) {
 		RewindableAudioStream *reAudStream = dynamic_cast<RewindableAudioStream *>(audioStream);
 		if (!reAudStream)
@@ -436,7 +472,7 @@ void SoundManager::startChannel(ChannelHandle &handle) {
 	if (!channel || !channel->stream)
 		throw Common::Exception("Invalid channel");
 
-	channel->state = AL_PLAYING;
+	channel->state = AudioBackend::kSourcePlaying;
 
 	debugC(Common::kDebugSound, 1, "Start sound channel %s", formatChannel(handle).c_str());
 
@@ -495,7 +531,7 @@ void SoundManager::setListenerGain(float gain) {
 	Common::StackLock lock(_mutex);
 
 	if (_hasSound)
-		alListenerf(AL_GAIN, gain);
+		_backend->setListenerGain(gain);
 }
 
 void SoundManager::setChannelPosition(const ChannelHandle &handle, float x, float y, float z) {
@@ -510,7 +546,7 @@ void SoundManager::setChannelPosition(const ChannelHandle &handle, float x, floa
 		                        formatChannel(handle).c_str());
 
 	if (_hasSound)
-		alSource3f(channel->source, AL_POSITION, x, y, z);
+		_backend->setSourcePosition(channel->source, x, y, z);
 }
 
 void SoundManager::getChannelPosition(const ChannelHandle &handle, float &x, float &y, float &z) {
@@ -525,7 +561,7 @@ void SoundManager::getChannelPosition(const ChannelHandle &handle, float &x, flo
 		                        formatChannel(handle).c_str());
 
 	if (_hasSound)
-		alGetSource3f(channel->source, AL_POSITION, &x, &y, &z);
+		_backend->getSourcePosition(channel->source, x, y, z);
 }
 
 void SoundManager::setChannelGain(const ChannelHandle &handle, float gain) {
@@ -538,7 +574,7 @@ void SoundManager::setChannelGain(const ChannelHandle &handle, float gain) {
 	channel->gain = gain;
 
 	if (_hasSound)
-		alSourcef(channel->source, AL_GAIN, _types[channel->type].gain * gain);
+		_backend->setSourceGain(channel->source, _types[channel->type].gain * gain);
 }
 
 void SoundManager::setChannelPitch(const ChannelHandle &handle, float pitch) {
@@ -549,7 +585,7 @@ void SoundManager::setChannelPitch(const ChannelHandle &handle, float pitch) {
 		throw Common::Exception("Invalid channel");
 
 	if (_hasSound)
-		alSourcef(channel->source, AL_PITCH, pitch);
+		_backend->setSourcePitch(channel->source, pitch);
 }
 
 uint64 SoundManager::getChannelSamplesPlayed(const ChannelHandle &handle) {
@@ -563,8 +599,7 @@ uint64 SoundManager::getChannelSamplesPlayed(const ChannelHandle &handle) {
 	bufferData(*channel);
 
 	// The position within the currently playing buffer
-	ALint currentPosition;
-	alGetSourcei(channel->source, AL_BYTE_OFFSET, &currentPosition);
+	const size_t currentPosition = _hasSound ? _backend->getSourceOffset(channel->source) : 0;
 
 	// Total number of bytes processed
 	uint64 byteCount = channel->finishedBuffers + currentPosition;
@@ -573,6 +608,16 @@ uint64 SoundManager::getChannelSamplesPlayed(const ChannelHandle &handle) {
 	return byteCount / channel->stream->getChannels() / 2;
 }
 
+uint32 SoundManager::getChannelUnderruns(const ChannelHandle &handle) {
+	Common::StackLock lock(_mutex);
+
+	Channel *channel = getChannel(handle);
+	if (!channel)
+		return 0;
+
+	return channel->underruns;
+}
+
 uint64 SoundManager::getChannelDurationPlayed(const ChannelHandle &handle) {
 	Common::StackLock lock(_mutex);
 
@@ -596,67 +641,63 @@ void SoundManager::setTypeGain(SoundType type, float gain) {
 		assert(*t);
 
 		if (_hasSound)
-			alSourcef((*t)->source, AL_GAIN, (*t)->gain * gain);
+			_backend->setSourceGain((*t)->source, (*t)->gain * gain);
 	}
 }
 
-bool SoundManager::fillBuffer(const Channel &channel, ALuint alBuffer,
-                              AudioStream *stream, ALsizei &bufferedSize) const {
+void SoundManager::setSampleCache(size_t size, uint32 maxDuration) {
+	_sampleCache.setSize(size);
+	_sampleCache.setMaxDuration(maxDuration);
+}
+
+void SoundManager::getSampleCacheStats(SampleCache::Stats &stats) const {
+	_sampleCache.getStats(stats);
+}
+
+void SoundManager::clearSampleCache() {
+	_sampleCache.clear();
+}
+
+void SoundManager::validateSampleCache(uint32 changeCount) {
+	_sampleCache.validate(changeCount);
+}
 
+bool SoundManager::fillBuffer(Channel &channel, AudioBackend::Buffer buffer, size_t &bufferedSize) {
 	bufferedSize = 0;
 
-	if (!stream)
+	if (!channel.stream)
 		throw Common::Exception("No stream in %s", formatChannel(&channel).c_str());
 
 	if (!_hasSound)
 		return true;
 
-	if (stream->endOfData())
-		return false;
-
-	ALenum format;
-
-	const int channelCount = stream->getChannels();
-	if        (channelCount == 1) {
-		format = AL_FORMAT_MONO16;
-	} else if (channelCount == 2) {
-		format = AL_FORMAT_STEREO16;
-	} else if (channelCount == 6) {
-		if (!_hasMultiChannel) {
-			warning("SoundManager::fillBuffer(): TODO: !_hasMultiChannel in %s",
-			        formatChannel(&channel).c_str());
-			return false;
-		}
-
-		format = _format51;
+	if (!channel.decoded)
+		throw Common::Exception("Stream not being decoded in %s", formatChannel(&channel).c_str());
 
-	} else {
+	const int channelCount = channel.stream->getChannels();
+	if (!_backend->hasChannelCount(channelCount)) {
 		warning("SoundManager::fillBuffer(): Unsupported channel count in %s: %d",
 		        formatChannel(&channel).c_str(), channelCount);
 		return false;
 	}
 
-	// Read in the required amount of samples
-	size_t numSamples = kOpenALBufferSize / 2;
-
-	Common::ScopedArray<byte> buffer(new byte[kOpenALBufferSize]);
-	std::memset(buffer.get(), 0, kOpenALBufferSize);
+	// Take whatever the decode pool has ready. We never wait for the decoder here
+	const size_t numSamples = channel.decoded->read(_fillBuffer.get(), kBufferSize / 2);
+	if (numSamples == 0) {
+		if (channel.decoded->hasFailed() && channel.decoded->endOfStream())
+			warning("Failed reading from stream while filling buffer in %s", formatChannel(&channel).c_str());
 
-	numSamples = stream->readBuffer(reinterpret_cast<int16 *>(buffer.get()), numSamples);
-	if (numSamples == AudioStream::kSizeInvalid) {
-		warning("Failed reading from stream while filling buffer in %s", formatChannel(&channel).c_str());
 		return false;
 	}
 
-	bufferedSize = numSamples * 2;
-	alBufferData(alBuffer, format, buffer.get(), bufferedSize, stream->getRate());
-
-	ALenum error = alGetError();
-	if (error != AL_NO_ERROR) {
-		warning("OpenAL error while filling buffer in %s: 0x%X", formatChannel(&channel).c_str(), error);
+	try {
+		_backend->bufferData(buffer, _fillBuffer.get(), numSamples * 2, channelCount, channel.stream->getRate());
+	} catch (...) {
+		Common::exceptionDispatcherWarning("Failed filling buffer in %s", formatChannel(&channel).c_str());
 		return false;
 	}
 
+	bufferedSize = numSamples * 2;
 	return true;
 }
 
@@ -668,54 +709,41 @@ void SoundManager::bufferData(size_t channel) {
 }
 
 void SoundManager::bufferData(Channel &channel) {
-	if (!channel.stream)
+	if (!channel.stream || !channel.decoded)
 		return;
 
 	if (!_hasSound)
 		return;
 
-	ALenum error = AL_NO_ERROR;
-
-	// Get the number of buffers that have been processed
-	ALint buffersProcessed = -1;
-	alGetSourcei(channel.source, AL_BUFFERS_PROCESSED, &buffersProcessed);
-	if ((error = alGetError()) != AL_NO_ERROR)
-		throw Common::Exception("OpenAL error while getting processed buffers in %s: 0x%X",
-		                        formatChannel(&channel).c_str(), error);
-
-	assert(buffersProcessed >= 0);
-
-	if ((size_t)buffersProcessed > kOpenALBufferCount)
-		throw Common::Exception("Got more processed buffers than total source buffers in %s?!?",
-		                        formatChannel(&channel).c_str());
-
-	// Unqueue the processed buffers
-	ALuint freeBuffers[kOpenALBufferCount];
-	alSourceUnqueueBuffers(channel.source, buffersProcessed, freeBuffers);
-	if ((error = alGetError()) != AL_NO_ERROR)
-		throw Common::Exception("OpenAL error while unqueueing buffers in %s: 0x%X",
-		                        formatChannel(&channel).c_str(), error);
+	// Unqueue the buffers that have been processed
+	AudioBackend::Buffer freeBuffers[kBufferCount];
+	const size_t buffersProcessed = _backend->unqueueBuffers(channel.source, freeBuffers, kBufferCount);
 
 	// Put them into the free buffers list
-	for (size_t i = 0; i < (size_t)buffersProcessed; i++) {
+	for (size_t i = 0; i < buffersProcessed; i++) {
 		channel.freeBuffers.push_back(freeBuffers[i]);
 
 		channel.finishedBuffers += channel.bufferSize[freeBuffers[i]];
 	}
 
 	// Buffer as long as we still have data and free buffers
-	std::list<ALuint>::iterator buffer = channel.freeBuffers.begin();
+	bool filled = false;
+
+	std::list<AudioBackend::Buffer>::iterator buffer = channel.freeBuffers.begin();
 	while (buffer != channel.freeBuffers.end()) {
-		if (!fillBuffer(channel, *buffer, channel.stream.get(), channel.bufferSize[*buffer]))
+		if (!fillBuffer(channel, *buffer, channel.bufferSize[*buffer]))
 			break;
 
-		alSourceQueueBuffers(channel.source, 1, &*buffer);
-		if ((error = alGetError()) != AL_NO_ERROR)
-			throw Common::Exception("OpenAL error while queueing buffers in %s: 0x%X",
-			                        formatChannel(&channel).c_str(), error);
+		filled = true;
+
+		_backend->queueBuffer(channel.source, *buffer);
 
 		buffer = channel.freeBuffers.erase(buffer);
 	}
+
+	// We made room in the ring buffer, so let the decode pool refill it
+	if (filled)
+		_decodePool.wake();
 }
 
 void SoundManager::checkReady() {
@@ -772,18 +800,18 @@ void SoundManager::pauseChannel(Channel *channel, bool pause) {
 	if (!channel || channel->id == 0)
 		return;
 
-	ALenum error = AL_NO_ERROR;
 	if (pause) {
 		if (_hasSound) {
-			alSourcePause(channel->source);
-			if ((error = alGetError()) != AL_NO_ERROR)
-				warning("OpenAL error while attempting to pause channel %s: 0x%X",
-				        formatChannel(channel).c_str(), error);
+			try {
+				_backend->pauseSource(channel->source);
+			} catch (...) {
+				Common::exceptionDispatcherWarning("Failed to pause channel %s", formatChannel(channel).c_str());
+			}
 		}
 
-		channel->state = AL_PAUSED;
+		channel->state = AudioBackend::kSourcePaused;
 	} else
-		channel->state = AL_PLAYING;
+		channel->state = AudioBackend::kSourcePlaying;
 
 	triggerUpdate();
 }
@@ -792,9 +820,9 @@ void SoundManager::pauseChannel(Channel *channel) {
 	if (!channel)
 		return;
 
-	if      (channel->state == AL_PAUSED)
+	if      (channel->state == AudioBackend::kSourcePaused)
 		pauseChannel(channel, false);
-	else if (channel->state == AL_PLAYING)
+	else if (channel->state == AudioBackend::kSourcePlaying)
 		pauseChannel(channel, true);
 }
 
@@ -818,17 +846,20 @@ void SoundManager::freeChannel(size_t channel) {
 		// Nothing to do
 		return;
 
-	// Discard the stream
+	// Stop decoding and discard the stream
+	_decodePool.remove(c->decoded);
+	c->decoded = 0;
+
 	c->stream.reset();
 
 	if (_hasSound) {
-		// Delete the channel's OpenAL source
+		// Delete the channel's backend source
 		if (c->source)
-			alDeleteSources(1, &c->source);
+			_backend->deleteSource(c->source);
 
-		// Delete the OpenAL buffers
-		for (std::list<ALuint>::iterator buffer = c->buffers.begin(); buffer != c->buffers.end(); ++buffer)
-			alDeleteBuffers(1, &*buffer);
+		// Delete the backend buffers
+		for (std::list<AudioBackend::Buffer>::iterator buffer = c->buffers.begin(); buffer != c->buffers.end(); ++buffer)
+			_backend->deleteBuffer(*buffer);
 	}
 
 	// Remove the channel from the type list
@@ -840,9 +871,11 @@ void SoundManager::freeChannel(size_t channel) {
 }
 
 void SoundManager::threadMethod() {
+	const uint32 interval = _backend->getUpdateInterval();
+
 	while (!_killThread) {
 		update();
-		_needUpdate.wait(100);
+		_needUpdate.wait(interval);
 	}
 }
 
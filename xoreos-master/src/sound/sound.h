@@ -25,16 +25,6 @@
 #ifndef SOUND_SOUND_H
 #define SOUND_SOUND_H
 
-// Mac OS X has to have this set up separately because of the include
-// path for the OpenAL framework.
-#ifdef MACOSX
-	#include <OpenAL/al.h>
-	#include <OpenAL/alc.h>
-#else
-	#include <AL/al.h>
-	#include <AL/alc.h>
-#endif
-
 #include <list>
 #include <map>
 
@@ -47,6 +37,9 @@
 #include "src/common/ustring.h"
 
 #include "src/sound/types.h"
+#include "src/sound/decodepool.h"
+#include "src/sound/backend.h"
+#include "src/sound/samplecache.h"
 
 namespace Common {
 	class SeekableReadStream;
@@ -62,14 +55,21 @@ public:
 	SoundManager();
 	~SoundManager();
 
-	/** Initialize the sound subsystem. */
-	void init();
+	/** Initialize the sound subsystem.
+	 *
+	 *  @param backend The audio output backend to use, which will be taken over.
+	 *                 If 0, the backend is chosen by the configuration.
+	 */
+	void init(AudioBackend *backend = 0);
 	/** Deinitialize the sound subsystem. */
 	void deinit();
 
 	/** Was the sound subsystem successfully initialized? */
 	bool ready() const;
 
+	/** Return the audio output backend, or 0 if there's no sound output. */
+	AudioBackend *getBackend();
+
 
 	/** Signal that one of streams currently being played has changed and should be updated immediately. */
 	void triggerUpdate();
@@ -88,6 +88,9 @@ public:
 	uint64 getChannelSamplesPlayed(const ChannelHandle &handle);
 	/** Return the time this channel has already played in milliseconds. */
 	uint64 getChannelDurationPlayed(const ChannelHandle &handle);
+
+	/** Return the number of times this channel ran out of decoded data while playing. */
+	uint32 getChannelUnderruns(const ChannelHandle &handle);
 	// '---
 
 	// .--- Playing sounds
@@ -104,6 +107,33 @@ public:
 	ChannelHandle playSoundFile(Common::SeekableReadStream *wavStream,
 	                            SoundType type, bool loop = false);
 
+	/** Play a sound file, and keep it in the sample cache if it's short enough.
+	 *
+	 *  This only allocate a channel for the sound, to actually start playing it,
+	 *  call startChannel().
+	 *
+	 *  @param  name The name to cache the sound under.
+	 *  @param  wavStream The stream to play. Will be taken over.
+	 *  @param  type The type of the sound.
+	 *  @param  loop Should the sound loop?
+	 *  @return The channel the sound has been assigned to, or -1 on error.
+	 */
+	ChannelHandle playSoundFile(const Common::UString &name, Common::SeekableReadStream *wavStream,
+	                            SoundType type, bool loop = false);
+
+	/** Play a sound out of the sample cache.
+	 *
+	 *  This only allocate a channel for the sound, to actually start playing it,
+	 *  call startChannel().
+	 *
+	 *  @param  name The name the sound was cached under.
+	 *  @param  type The type of the sound.
+	 *  @param  loop Should the sound loop?
+	 *  @return The channel the sound has been assigned to, or an invalid channel
+	 *          handle if the sound is not in the sample cache.
+	 */
+	ChannelHandle playCachedSound(const Common::UString &name, SoundType type, bool loop = false);
+
 	/** Play an audio stream.
 	 *
 	 *  This only allocate a channel for the sound, to actually start playing it,
@@ -164,6 +194,28 @@ public:
 	void setTypeGain(SoundType type, float gain);
 	// '---
 
+	// .--- Sample cache
+	/** Set the size of the sample cache, in bytes, and the maximum duration
+	 *  of the sounds it holds, in milliseconds.
+	 *
+	 *  The sample cache keeps short sounds fully decoded, so that playing them
+	 *  again doesn't need to read and decode them again. A size of 0 disables
+	 *  the cache. By default, the cache is disabled.
+	 */
+	void setSampleCache(size_t size, uint32 maxDuration);
+
+	/** Return the statistics of the sample cache. */
+	void getSampleCacheStats(SampleCache::Stats &stats) const;
+
+	/** Drop all sounds from the sample cache and reset its statistics. */
+	void clearSampleCache();
+
+	/** Drop all sounds from the sample cache if the sources they were read
+	 *  from changed, as signaled by a change in this counter.
+	 */
+	void validateSampleCache(uint32 changeCount);
+	// '---
+
 	// .--- Utility methods
 	/** Create an audio stream from this data stream.
 	 *
@@ -193,16 +245,17 @@ private:
 		uint32 id;    ///< The channel's ID.
 		size_t index; ///< The channel's index.
 
-		ALint state; ///< The sound's state.
+		AudioBackend::SourceState state; ///< The sound's state.
 
 		Common::DisposablePtr<AudioStream> stream;  ///< The actual audio stream.
+		DecodedStream *decoded; ///< The audio stream, decoded ahead by the decode pool.
 
-		ALuint source; ///< OpenAL source for this channel.
+		AudioBackend::Source source; ///< Backend source for this channel.
 
-		std::list<ALuint> buffers;     ///< List of buffers for that channel.
-		std::list<ALuint> freeBuffers; ///< List of free buffers not filled with data.
+		std::list<AudioBackend::Buffer> buffers;     ///< List of buffers for that channel.
+		std::list<AudioBackend::Buffer> freeBuffers; ///< List of free buffers not filled with data.
 
-		std::map<ALuint, ALsizei> bufferSize; ///< Size of a buffer in bytes.
+		std::map<AudioBackend::Buffer, size_t> bufferSize; ///< Size of a buffer in bytes.
 
 		SoundType type;            ///< The channel's sound type.
 		TypeList::iterator typeIt; ///< Iterator into the type list.
@@ -212,6 +265,8 @@ private:
 
 		float gain; ///< The channel's gain.
 
+		uint32 underruns; ///< Number of times the channel ran dry while playing.
+
 		Channel(uint32 i, size_t idx, SoundType t, const TypeList::iterator &ti, AudioStream *s, bool d);
 	};
 
@@ -219,9 +274,6 @@ private:
 
 	bool _hasSound; ///< Do we have working sound output?
 
-	bool _hasMultiChannel; ///< Do we have the multi-channel extension?
-	ALenum _format51; ///< The value for the 5.1 multi-channel format.
-
 	Common::ScopedPtr<Channel> _channels[kChannelCount]; ///< The sound channels.
 	Type _types[kSoundTypeMAX]; ///< The sound types.
 
@@ -232,8 +284,14 @@ private:
 	/** Condition to signal that an update is needed. */
 	Common::Condition _needUpdate;
 
-	ALCdevice *_dev;
-	ALCcontext *_ctx;
+	DecodePool _decodePool; ///< The workers decoding all channels' audio streams.
+
+	/** Scratch buffer for filling the backend buffers. */
+	Common::ScopedArray<int16> _fillBuffer;
+
+	Common::ScopedPtr<AudioBackend> _backend; ///< The audio output backend.
+
+	SampleCache _sampleCache; ///< Short sounds, kept fully decoded.
 
 	/** Check that the SoundManager was properly initialized. */
 	void checkReady();
@@ -241,16 +299,19 @@ private:
 	/** Update the sound information. Called regularly from within the thread method. */
 	void update();
 
+	/** Play an audio stream, looping it if requested. */
+	ChannelHandle playSound(AudioStream *audioStream, SoundType type, bool loop);
+
 	/** Look for a free place in the channel vector. */
 	ChannelHandle newChannel();
 
-	/** Buffer more sound from the channel to the OpenAL buffers. */
+	/** Buffer more sound from the channel to the backend buffers. */
 	void bufferData(Channel &channel);
-	/** Buffer more sound from the channel to the OpenAL buffers. */
+	/** Buffer more sound from the channel to the backend buffers. */
 	void bufferData(size_t channel);
 
 	/** Is that channel currently playing a sound? */
-	bool isPlaying(size_t channel) const;
+	bool isPlaying(size_t channel);
 
 	/** Pause/Unpause a channel. */
 	void pauseChannel(Channel *channel, bool pause);
@@ -269,9 +330,11 @@ private:
 
 	void threadMethod();
 
-	/** Fill the buffer with data from the audio stream. */
-	bool fillBuffer(const Channel &channel, ALuint alBuffer,
-	                AudioStream *stream, ALsizei &bufferedSize) const;
+	/** Create the audio output backend the configuration asks for. */
+	static AudioBackend *createBackend();
+
+	/** Fill the buffer with data already decoded from the channel's audio stream. */
+	bool fillBuffer(Channel &channel, AudioBackend::Buffer buffer, size_t &bufferedSize);
 
 	/** Return a string representing this channel. */
 	Common::UString formatChannel(const Channel *channel) const;
@@ -209,8 +209,8 @@ void Bink::processData() {
 				audio.sampleCount = _bink->readUint32LE() / (2 * audio.channels);
 
 				audio.bits =
-					new Common::BitStream32LELSB(new Common::SeekableSubReadStream(_bink.get(),
-					    audioPacketStart + 4, audioPacketEnd), true);
+					new Common::MemoryBitStream32LELSB(_bink->readStreamAt(audioPacketStart + 4,
+					    audioPacketLength - 4), true);
 
 				audioPacket(audio);
 
@@ -225,11 +225,9 @@ void Bink::processData() {
 	}
 
 	size_t videoPacketStart = _bink->pos();
-	size_t videoPacketEnd   = _bink->pos() + frameSize;
 
 	frame.bits =
-		new Common::BitStream32LELSB(new Common::SeekableSubReadStream(_bink.get(),
-		    videoPacketStart, videoPacketEnd), true);
+		new Common::MemoryBitStream32LELSB(_bink->readStreamAt(videoPacketStart, frameSize), true);
 
 	videoPacket(frame);
 
@@ -75,12 +75,12 @@
 
 #include "src/common/types.h"
 #include "src/common/scopedptr.h"
+#include "src/common/bitstream.h"
 
 #include "src/video/decoder.h"
 
 namespace Common {
 	class SeekableReadStream;
-	class BitStream;
 	class Huffman;
 
 	class RDFT;
@@ -177,7 +177,7 @@ private:
 
 		uint32 sampleCount;
 
-		Common::BitStream *bits;
+		Common::MemoryBitStream32LELSB *bits;
 
 		bool first;
 
@@ -210,7 +210,7 @@ private:
 		uint32 offset;
 		uint32 size;
 
-		Common::BitStream *bits;
+		Common::MemoryBitStream32LELSB *bits;
 
 		VideoFrame();
 		~VideoFrame();
@@ -48,6 +48,9 @@
 #include "src/aurora/talkman.h"
 #include "src/aurora/util.h"
 
+#include "src/aurora/nwscript/ncscache.h"
+#include "src/aurora/nwscript/profiler.h"
+
 #include "src/graphics/queueman.h"
 #include "src/graphics/graphics.h"
 
@@ -252,10 +255,16 @@ static void initConfig() {
 	ConfigMan.setDouble(Common::kConfigRealmDefault, "volume_voice", 1.0);
 	ConfigMan.setDouble(Common::kConfigRealmDefault, "volume_video", 1.0);
 
+	ConfigMan.setInt(Common::kConfigRealmDefault, "soundcache"        , 8);
+	ConfigMan.setInt(Common::kConfigRealmDefault, "soundcacheduration", 2000);
+
 	ConfigMan.setBool(Common::kConfigRealmDefault, "showfps", false);
 
 	ConfigMan.setBool(Common::kConfigRealmDefault, "skipvideos", false);
 
+	ConfigMan.setInt(Common::kConfigRealmDefault, "resourcecache", 32);
+	ConfigMan.setBool(Common::kConfigRealmDefault, "indexcache", true);
+
 	ConfigMan.setBool(Common::kConfigRealmDefault, "saveconf", true);
 
 	// Populate the new config with the defaults
@@ -319,6 +328,8 @@ static void deinit() {
 	Aurora::LanguageManager::destroy();
 	Aurora::TalkManager::destroy();
 	Aurora::TwoDARegistry::destroy();
+	Aurora::NWScript::NCSProgramCache::destroy();
+	Aurora::NWScript::NCSProfiler::destroy();
 	Aurora::ResourceManager::destroy();
 	Aurora::FileTypeManager::destroy();
 